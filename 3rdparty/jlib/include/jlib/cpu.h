@@ -21,8 +21,9 @@
 #define JX_CPU_FEATURE_F16C     (1ull << 13) // CPU supports 16-bit floating point conversion instructions
 #define JX_CPU_FEATURE_FMA      (1ull << 14)
 #define JX_CPU_FEATURE_ERMSB    (1ull << 15) // Enhanced REP MOVSB
+#define JX_CPU_FEATURE_LZCNT    (1ull << 16) // AMD ABM / Intel LZCNT
 
-#define JX_CPU_NUM_FEATURES     16
+#define JX_CPU_NUM_FEATURES     17
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,7 +45,8 @@ static const char* jx_cpu_kFeatureName[] = {
 	"POPCNT",
 	"F16C",
 	"FMA",
-	"ERMSB"
+	"ERMSB",
+	"LZCNT"
 };
 JX_STATIC_ASSERT(JX_COUNTOF(jx_cpu_kFeatureName) == JX_CPU_NUM_FEATURES, "Missing CPU feature name");
 
@@ -396,6 +396,31 @@ static inline bool jx_os_vmemProtect(void* addr, size_t sz, uint32_t protectFlag
 	return os_api->vmemProtect(addr, sz, protectFlags);
 }
 
+static inline size_t jx_os_vmemGetLargePageSize(void)
+{
+	return os_api->vmemGetLargePageSize();
+}
+
+static inline void* jx_os_vmemAllocLargePages(void* desiredAddr, size_t sz, uint32_t protectFlags)
+{
+	return os_api->vmemAllocLargePages(desiredAddr, sz, protectFlags);
+}
+
+static inline void* jx_os_vmemAllocAliased(void* desiredAddr, size_t sz, uint32_t protectFlags, void** writableAlias)
+{
+	return os_api->vmemAllocAliased(desiredAddr, sz, protectFlags, writableAlias);
+}
+
+static inline void jx_os_vmemFreeAliased(void* addr, void* writableAlias, size_t sz)
+{
+	os_api->vmemFreeAliased(addr, writableAlias, sz);
+}
+
+static inline void jx_os_vmemFlushInstructionCache(const void* addr, size_t sz)
+{
+	os_api->vmemFlushInstructionCache(addr, sz);
+}
+
 #ifdef __cplusplus
 }
 #endif
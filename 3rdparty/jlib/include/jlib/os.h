@@ -398,6 +398,11 @@ typedef struct jx_os_api
 	void*           (*vmemAlloc)(void* desiredAddr, size_t sz, uint32_t protectFlags);
 	void            (*vmemFree)(void* addr, size_t sz);
 	bool            (*vmemProtect)(void* addr, size_t sz, uint32_t protectFlags);
+	size_t          (*vmemGetLargePageSize)(void); // 0 if large pages are not available
+	void*           (*vmemAllocLargePages)(void* desiredAddr, size_t sz, uint32_t protectFlags); // sz must be a multiple of the large page size
+	void*           (*vmemAllocAliased)(void* desiredAddr, size_t sz, uint32_t protectFlags, void** writableAlias); // Maps the same memory twice; once with protectFlags and once read/write
+	void            (*vmemFreeAliased)(void* addr, void* writableAlias, size_t sz);
+	void            (*vmemFlushInstructionCache)(const void* addr, size_t sz);
 } jx_os_api;
 
 extern jx_os_api* os_api;
@@ -488,6 +493,11 @@ static uint32_t jx_os_vmemGetPageSize(void);
 static void* jx_os_vmemAlloc(void* desiredAddr, size_t sz, uint32_t protectFlags);
 static void jx_os_vmemFree(void* addr, size_t sz);
 static bool jx_os_vmemProtect(void* addr, size_t sz, uint32_t protectFlags);
+static size_t jx_os_vmemGetLargePageSize(void);
+static void* jx_os_vmemAllocLargePages(void* desiredAddr, size_t sz, uint32_t protectFlags);
+static void* jx_os_vmemAllocAliased(void* desiredAddr, size_t sz, uint32_t protectFlags, void** writableAlias);
+static void jx_os_vmemFreeAliased(void* addr, void* writableAlias, size_t sz);
+static void jx_os_vmemFlushInstructionCache(const void* addr, size_t sz);
 
 #ifdef __cplusplus
 }
@@ -159,6 +159,7 @@
 #define JCPUINFO_BASIC_BUS_FREQ                 JCPUINFO_MAKE_ID(JCPUINFO_BASIC, 0x16, 0x00, JCPUINFO_ECX, 0, 16)
 
 #define JCPUINFO_EXT_MAX_EXTENDED_FUNC_ID       JCPUINFO_MAKE_ID(JCPUINFO_EXTENDED, 0x00, 0x00, JCPUINFO_EAX, 0, 32)
+#define JCPUINFO_EXT_LZCNT                      JCPUINFO_MAKE_ID(JCPUINFO_EXTENDED, 0x01, 0x00, JCPUINFO_ECX, 5, 1)
 #define JCPUINFO_EXT_PROCESSOR_BRAND_STRING_0   JCPUINFO_MAKE_ID(JCPUINFO_EXTENDED, 0x02, 0x00, JCPUINFO_EAX, 0, 32)
 #define JCPUINFO_EXT_PROCESSOR_BRAND_STRING_1   JCPUINFO_MAKE_ID(JCPUINFO_EXTENDED, 0x02, 0x00, JCPUINFO_EBX, 0, 32)
 #define JCPUINFO_EXT_PROCESSOR_BRAND_STRING_2   JCPUINFO_MAKE_ID(JCPUINFO_EXTENDED, 0x02, 0x00, JCPUINFO_ECX, 0, 32)
@@ -310,6 +311,9 @@ bool jx_cpu_initAPI(void)
 		features |= (_jx_cpu_readInfo(JCPUINFO_BASIC_F16C) != 0) ? JX_CPU_FEATURE_F16C : 0ull;
 		features |= (_jx_cpu_readInfo(JCPUINFO_BASIC_FMA) != 0) ? JX_CPU_FEATURE_FMA : 0ull;
 		features |= (_jx_cpu_readInfo(JCPUINFO_BASIC_ENHANCED_REPMOVSB) != 0) ? JX_CPU_FEATURE_ERMSB : 0ull;
+		if (_jx_cpu_readInfo(JCPUINFO_EXT_MAX_EXTENDED_FUNC_ID) >= 0x80000001) {
+			features |= (_jx_cpu_readInfo(JCPUINFO_EXT_LZCNT) != 0) ? JX_CPU_FEATURE_LZCNT : 0ull;
+		}
 		info->m_Features = features;
 	}
 
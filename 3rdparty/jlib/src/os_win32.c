@@ -99,6 +99,11 @@ static uint32_t _jx_os_vmemGetPageSize(void);
 static void* _jx_os_vmemAlloc(void* desiredAddr, size_t sz, uint32_t protectFlags);
 static void _jx_os_vmemFree(void* addr, size_t sz);
 static bool _jx_os_vmemProtect(void* addr, size_t sz, uint32_t protectFlags);
+static size_t _jx_os_vmemGetLargePageSize(void);
+static void* _jx_os_vmemAllocLargePages(void* desiredAddr, size_t sz, uint32_t protectFlags);
+static void* _jx_os_vmemAllocAliased(void* desiredAddr, size_t sz, uint32_t protectFlags, void** writableAlias);
+static void _jx_os_vmemFreeAliased(void* addr, void* writableAlias, size_t sz);
+static void _jx_os_vmemFlushInstructionCache(const void* addr, size_t sz);
 
 jx_os_api* os_api = &(jx_os_api){
 	.moduleOpen = _jx_os_moduleOpen,
@@ -175,6 +180,11 @@ jx_os_api* os_api = &(jx_os_api){
 	.vmemAlloc = _jx_os_vmemAlloc,
 	.vmemFree = _jx_os_vmemFree,
 	.vmemProtect = _jx_os_vmemProtect,
+	.vmemGetLargePageSize = _jx_os_vmemGetLargePageSize,
+	.vmemAllocLargePages = _jx_os_vmemAllocLargePages,
+	.vmemAllocAliased = _jx_os_vmemAllocAliased,
+	.vmemFreeAliased = _jx_os_vmemFreeAliased,
+	.vmemFlushInstructionCache = _jx_os_vmemFlushInstructionCache,
 };
 
 typedef void (*pfnGetSystemTimePreciseAsFileTime)(LPFILETIME lpSystemTimeAsFileTime);
@@ -2317,4 +2327,107 @@ static bool _jx_os_vmemProtect(void* addr, size_t sz, uint32_t protectFlags)
 	return VirtualProtect(addr, sz, win32Protect, &oldProtect) != 0;
 }
 
+// Large pages require SeLockMemoryPrivilege. It has to be granted to the user (Local Security 
+// Policy -> "Lock pages in memory") and enabled for the process before allocating.
+static bool _vmemEnableLockMemoryPrivilege(void)
+{
+	HANDLE token = NULL;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+		return false;
+	}
+
+	TOKEN_PRIVILEGES tp = { 0 };
+	tp.PrivilegeCount = 1;
+	tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+	bool res = true
+		&& LookupPrivilegeValueW(NULL, SE_LOCK_MEMORY_NAME, &tp.Privileges[0].Luid)
+		&& AdjustTokenPrivileges(token, FALSE, &tp, 0, NULL, NULL)
+		&& GetLastError() == ERROR_SUCCESS // NOTE: ERROR_NOT_ALL_ASSIGNED if the privilege hasn't been granted.
+		;
+
+	CloseHandle(token);
+
+	return res;
+}
+
+static size_t _jx_os_vmemGetLargePageSize(void)
+{
+	static size_t s_LargePageSize = (size_t)-1;
+	if (s_LargePageSize == (size_t)-1) {
+		s_LargePageSize = _vmemEnableLockMemoryPrivilege()
+			? GetLargePageMinimum()
+			: 0
+			;
+	}
+
+	return s_LargePageSize;
+}
+
+static void* _jx_os_vmemAllocLargePages(void* desiredAddr, size_t sz, uint32_t protectFlags)
+{
+	const size_t largePageSize = _jx_os_vmemGetLargePageSize();
+	if (!largePageSize || (sz % largePageSize) != 0) {
+		return NULL;
+	}
+
+	// NOTE: Large pages are always committed and cannot be paged out.
+	const uint32_t win32Protect = _vmemProtectToWin32(protectFlags);
+	return VirtualAlloc(desiredAddr, sz, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, win32Protect);
+}
+
+// Both views share the same pagefile-backed section so writes through the alias are 
+// immediately visible through the other view without ever changing its protection.
+// NOTE: desiredAddr must be a multiple of the allocation granularity.
+static void* _jx_os_vmemAllocAliased(void* desiredAddr, size_t sz, uint32_t protectFlags, void** writableAlias)
+{
+	const uint64_t sz64 = (uint64_t)sz;
+	HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_EXECUTE_READWRITE | SEC_COMMIT, (DWORD)(sz64 >> 32), (DWORD)(sz64 & 0xFFFFFFFFull), NULL);
+	if (!mapping) {
+		return NULL;
+	}
+
+	DWORD access = 0;
+	if ((protectFlags & JX_VMEM_PROTECT_READ_Msk) != 0) {
+		access |= FILE_MAP_READ;
+	}
+	if ((protectFlags & JX_VMEM_PROTECT_WRITE_Msk) != 0) {
+		access |= FILE_MAP_WRITE;
+	}
+	if ((protectFlags & JX_VMEM_PROTECT_EXEC_Msk) != 0) {
+		access |= FILE_MAP_EXECUTE;
+	}
+
+	void* view = MapViewOfFileEx(mapping, access, 0, 0, sz, desiredAddr);
+	void* alias = view
+		? MapViewOfFileEx(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, sz, NULL)
+		: NULL
+		;
+
+	// NOTE: The views keep the section alive.
+	CloseHandle(mapping);
+
+	if (!alias) {
+		if (view) {
+			UnmapViewOfFile(view);
+		}
+		return NULL;
+	}
+
+	*writableAlias = alias;
+
+	return view;
+}
+
+static void _jx_os_vmemFreeAliased(void* addr, void* writableAlias, size_t sz)
+{
+	JX_UNUSED(sz);
+	UnmapViewOfFile(writableAlias);
+	UnmapViewOfFile(addr);
+}
+
+static void _jx_os_vmemFlushInstructionCache(const void* addr, size_t sz)
+{
+	FlushInstructionCache(GetCurrentProcess(), addr, sz);
+}
+
 #endif // JX_PLATFORM_WINDOWS
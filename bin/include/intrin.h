@@ -0,0 +1,47 @@
+#ifndef _INTRIN
+#define _INTRIN
+
+// NOTE: All of these are lowered to IR instructions by the compiler.
+int __builtin_popcount(unsigned int x);
+int __builtin_popcountl(unsigned long x);
+int __builtin_popcountll(unsigned long long x);
+int __builtin_clz(unsigned int x);
+int __builtin_clzl(unsigned long x);
+int __builtin_clzll(unsigned long long x);
+int __builtin_ctz(unsigned int x);
+int __builtin_ctzl(unsigned long x);
+int __builtin_ctzll(unsigned long long x);
+unsigned short __builtin_bswap16(unsigned short x);
+unsigned int __builtin_bswap32(unsigned int x);
+unsigned long long __builtin_bswap64(unsigned long long x);
+
+unsigned short __popcnt16(unsigned short value);
+unsigned int __popcnt(unsigned int value);
+unsigned long long __popcnt64(unsigned long long value);
+unsigned short __lzcnt16(unsigned short value);
+unsigned int __lzcnt(unsigned int value);
+unsigned long long __lzcnt64(unsigned long long value);
+unsigned int _tzcnt_u32(unsigned int value);
+unsigned long long _tzcnt_u64(unsigned long long value);
+
+unsigned short _byteswap_ushort(unsigned short value);
+unsigned long _byteswap_ulong(unsigned long value);
+unsigned long long _byteswap_uint64(unsigned long long value);
+
+unsigned char _rotl8(unsigned char value, unsigned char shift);
+unsigned short _rotl16(unsigned short value, unsigned char shift);
+unsigned int _rotl(unsigned int value, int shift);
+unsigned long _lrotl(unsigned long value, int shift);
+unsigned long long _rotl64(unsigned long long value, int shift);
+unsigned char _rotr8(unsigned char value, unsigned char shift);
+unsigned short _rotr16(unsigned short value, unsigned char shift);
+unsigned int _rotr(unsigned int value, int shift);
+unsigned long _lrotr(unsigned long value, int shift);
+unsigned long long _rotr64(unsigned long long value, int shift);
+
+unsigned char _BitScanForward(unsigned long* index, unsigned long mask);
+unsigned char _BitScanForward64(unsigned long* index, unsigned long long mask);
+unsigned char _BitScanReverse(unsigned long* index, unsigned long mask);
+unsigned char _BitScanReverse64(unsigned long* index, unsigned long long mask);
+
+#endif // _INTRIN
@@ -0,0 +1,42 @@
+#include <intrin.h>
+
+int main(void)
+{
+	unsigned int x = 0x00f0ff00u;
+	unsigned long long y = 0x0000010000000000ull;
+
+	if (__builtin_popcount(x) != 12) {
+		return 1;
+	}
+	if (__builtin_popcountll(y) != 1) {
+		return 2;
+	}
+	if (__builtin_clz(x) != 8) {
+		return 3;
+	}
+	if (__builtin_clzll(y) != 23) {
+		return 4;
+	}
+	if (__builtin_ctz(x) != 8) {
+		return 5;
+	}
+	if (__builtin_ctzll(y) != 40) {
+		return 6;
+	}
+	if (__builtin_bswap32(0x11223344u) != 0x44332211u) {
+		return 7;
+	}
+	if (__builtin_bswap64(0x1122334455667788ull) != 0x8877665544332211ull) {
+		return 8;
+	}
+	if (_rotl(x, 8) != 0xf0ff0000u) {
+		return 9;
+	}
+
+	unsigned long idx = 0;
+	if (!_BitScanReverse(&idx, x) || idx != 23) {
+		return 10;
+	}
+
+	return 0;
+}
@@ -38,6 +38,8 @@
 #define JCC_SOURCE_LOCATION_CUR() &(jx_cc_source_loc_t){ .m_Filename = __FILE__, .m_LineNum = __LINE__ }
 #define JCC_SOURCE_LOCATION_MAKE(file, line) &(jx_cc_source_loc_t){ .m_Filename = (file), .m_LineNum = (line) }
 
+#define JCC_FINGERPRINT_SEED 0xCBF29CE484222325ull // FNV-1a offset basis
+
 static jx_cc_type_t* kType_void    = &(jx_cc_type_t){ .m_Kind = JCC_TYPE_VOID,    .m_Size = 1,  .m_Alignment = 1 };
 static jx_cc_type_t* kType_bool    = &(jx_cc_type_t){ .m_Kind = JCC_TYPE_BOOL,    .m_Size = 1,  .m_Alignment = 1 };
 static jx_cc_type_t* kType_char    = &(jx_cc_type_t){ .m_Kind = JCC_TYPE_CHAR,    .m_Size = 1,  .m_Alignment = 1 };
@@ -298,6 +300,10 @@ typedef struct jcc_translation_unit_t
 	// Points to the function object the parser is currently parsing.
 	jx_cc_object_t* m_CurFunction;
 
+	// Fingerprint of the function definition being parsed or NULL outside function 
+	// definitions. Everything the function's code depends on is mixed into it.
+	uint64_t* m_CurFuncFingerprint;
+
 	// Lists of all goto statements and labels in the curent function.
 	jx_cc_ast_stmt_goto_t* m_CurFuncGotos;
 	jx_cc_ast_stmt_label_t* m_CurFuncLabels;
@@ -326,6 +332,7 @@ typedef struct jcc_translation_unit_t
 	uint32_t m_NextLabelID;
 	uint32_t m_NextLocalVarID;
 	uint32_t m_NextGlobalVarID;
+	uint32_t m_CurFuncGlobalVarID;
 } jcc_translation_unit_t;
 
 typedef struct jx_cc_context_t
@@ -337,6 +344,8 @@ typedef struct jx_cc_context_t
 	jx_hashmap_t* m_IncludeFilePathMap;
 	jx_logger_i* m_Logger;
 	const char** m_IncludePathsArr;
+	jx_cc_stageCallback m_StageCallback;
+	void* m_StageCallbackUserData;
 	uint32_t m_NumErrors;
 	uint32_t m_NumWarnings;
 } jx_cc_context_t;
@@ -346,6 +355,8 @@ static jx_cc_token_t* jcc_concatAdjacentStringLiterals(jx_cc_context_t* ctx, jcc
 static bool jcc_convertPreprocessorNumber(jx_cc_token_t* tok);
 static bool jcc_convertPreprocessorNumbers(jx_cc_context_t* ctx, jx_cc_token_t* tok);
 static bool jcc_parse(jx_cc_context_t* ctx, jcc_translation_unit_t* tu, jx_cc_token_t* tok);
+static void jcc_stageBegin(jx_cc_context_t* ctx, const char* stageName);
+static void jcc_stageEnd(jx_cc_context_t* ctx, const char* stageName);
 
 static bool jcc_tokIs(jx_cc_token_t* tok, jx_cc_token_kind kind);
 static bool jcc_tokExpect(jx_cc_token_t** tok, jx_cc_token_kind kind);
@@ -413,6 +424,12 @@ static bool jcc_parseTypedef(jx_cc_context_t* ctx, jcc_translation_unit_t* tu, j
 static bool jcc_isFunction(jx_cc_context_t* ctx, jcc_translation_unit_t* tu, jx_cc_token_t* tok);
 static bool jcc_parseFunction(jx_cc_context_t* ctx, jcc_translation_unit_t* tu, jx_cc_token_t** tokenListPtr, jx_cc_type_t* basety, jcc_var_attr_t* attr);
 static bool jcc_parseGlobalVariable(jx_cc_context_t* ctx, jcc_translation_unit_t* tu, jx_cc_token_t** tokenListPtr, jx_cc_type_t* basety, jcc_var_attr_t* attr);
+static uint64_t jcc_fingerprintMixBytes(uint64_t hash, const void* data, size_t size);
+static uint64_t jcc_fingerprintMixType(uint64_t hash, const jx_cc_type_t* ty, bool withMembers);
+static uint64_t jcc_fingerprintMixTokens(uint64_t hash, const jx_cc_token_t* tok, const jx_cc_token_t* end);
+static void jcc_tuFingerprintType(jcc_translation_unit_t* tu, const jx_cc_type_t* ty, bool withMembers);
+static void jcc_tuFingerprintVarScope(jcc_translation_unit_t* tu, const jcc_var_scope_t* sc);
+static bool jcc_tuUpdateFunctionFingerprints(jx_cc_context_t* ctx, jcc_translation_unit_t* tu);
 static jx_cc_type_t* jcc_typeAlloc(jx_cc_context_t* ctx, jx_cc_type_kind kind, int size, uint32_t align);
 static jx_cc_type_t* jcc_typeCopy(jx_cc_context_t* ctx, const jx_cc_type_t* ty);
 static jx_cc_type_t* jcc_typeAllocPointerTo(jx_cc_context_t* ctx, jx_cc_type_t* base);
@@ -545,6 +562,12 @@ void jx_cc_addIncludePath(jx_cc_context_t* ctx, jx_file_base_dir baseDir, const
 	jx_array_push_back(ctx->m_IncludePathsArr, fullPathInterned);
 }
 
+void jx_cc_setStageCallback(jx_cc_context_t* ctx, jx_cc_stageCallback callback, void* userData)
+{
+	ctx->m_StageCallback = callback;
+	ctx->m_StageCallbackUserData = userData;
+}
+
 jx_cc_translation_unit_t* jx_cc_compileFile(jx_cc_context_t* ctx, jx_file_base_dir baseDir, const char* filename)
 {
 	jx_cc_translation_unit_t* unit = (jx_cc_translation_unit_t*)JX_ALLOC(ctx->m_Allocator, sizeof(jx_cc_translation_unit_t));
@@ -622,17 +645,21 @@ jx_cc_translation_unit_t* jx_cc_compileFile(jx_cc_context_t* ctx, jx_file_base_d
 		jcc_ppDefineMacro(ctx, tu, "SQLITE_MUTEX_NOOP", "1");
 	}
 
+	jcc_stageBegin(ctx, "preprocess");
+
 	jx_cc_token_t* tok = jcc_tokenizeString(ctx, tu, source, sourceLen);
 
 	JX_FREE(ctx->m_Allocator, source);
 
 	if (!tok) {
+		jcc_stageEnd(ctx, "preprocess");
 		jcc_tuLeaveScope(ctx, tu);
 		goto end;
 	}
 
 	tok = jcc_preprocess(ctx, tu, tok);
 	if (!tok) {
+		jcc_stageEnd(ctx, "preprocess");
 		jcc_tuLeaveScope(ctx, tu);
 		goto end;
 	}
@@ -640,12 +667,16 @@ jx_cc_translation_unit_t* jx_cc_compileFile(jx_cc_context_t* ctx, jx_file_base_d
 	tok = jcc_concatAdjacentStringLiterals(ctx, tu, tok);
 
 	// Convert preprocessor numbers
-	if (!jcc_convertPreprocessorNumbers(ctx, tok)) {
+	const bool numbersConverted = jcc_convertPreprocessorNumbers(ctx, tok);
+	jcc_stageEnd(ctx, "preprocess");
+	if (!numbersConverted) {
 		jcc_tuLeaveScope(ctx, tu);
 		goto end;
 	}
 
+	jcc_stageBegin(ctx, "parse");
 	bool res = jcc_parse(ctx, tu, tok);
+	jcc_stageEnd(ctx, "parse");
 	if (!res) {
 		jcc_tuLeaveScope(ctx, tu);
 		goto end;
@@ -678,6 +709,20 @@ end:
 	return unit;
 }
 
+static void jcc_stageBegin(jx_cc_context_t* ctx, const char* stageName)
+{
+	if (ctx->m_StageCallback) {
+		ctx->m_StageCallback(stageName, false, ctx->m_StageCallbackUserData);
+	}
+}
+
+static void jcc_stageEnd(jx_cc_context_t* ctx, const char* stageName)
+{
+	if (ctx->m_StageCallback) {
+		ctx->m_StageCallback(stageName, true, ctx->m_StageCallbackUserData);
+	}
+}
+
 // Round up `n` to the nearest multiple of `align`. For instance,
 // jcc_alignTo(5, 8) returns 8 and jcc_alignTo(11, 8) returns 16.
 static int jcc_alignTo(int n, int align)
@@ -757,7 +802,9 @@ static jcc_var_scope_t* jcc_tuFindVariable(jcc_translation_unit_t* tu, jx_cc_tok
 	for (jcc_scope_t* sc = tu->m_Scope; sc; sc = sc->m_Next) {
 		jcc_scope_entry_t* entry = jx_hashmapGet(sc->m_Vars, key);
 		if (entry) {
-			return (jcc_var_scope_t*)entry->m_Value;
+			jcc_var_scope_t* varScope = (jcc_var_scope_t*)entry->m_Value;
+			jcc_tuFingerprintVarScope(tu, varScope);
+			return varScope;
 		}
 	}
 	
@@ -775,7 +822,9 @@ static jx_cc_type_t* jcc_tuFindTag(jcc_translation_unit_t* tu, jx_cc_token_t* to
 	for (jcc_scope_t* sc = tu->m_Scope; sc; sc = sc->m_Next) {
 		jcc_scope_entry_t* entry = jx_hashmapGet(sc->m_Tags, key);
 		if (entry) {
-			return (jx_cc_type_t*)entry->m_Value;
+			jx_cc_type_t* ty = (jx_cc_type_t*)entry->m_Value;
+			jcc_tuFingerprintType(tu, ty, true);
+			return ty;
 		}
 	}
 
@@ -1643,7 +1692,13 @@ static jx_cc_object_t* jcc_tuVarAllocGlobal(jx_cc_context_t* ctx, jcc_translatio
 static jx_cc_object_t* jcc_tuVarAllocAnonGlobal(jx_cc_context_t* ctx, jcc_translation_unit_t* tu, jx_cc_type_t* ty)
 {
 	char name[256];
-	jx_snprintf(name, JX_COUNTOF(name), "$gvar_%u", ++tu->m_NextGlobalVarID);
+	if (tu->m_CurFuncFingerprint) {
+		// NOTE: Anonymous globals owned by a function (string literals, static locals) are named after
+		// the function so unchanged functions keep referring to the same symbols across compilations.
+		jx_snprintf(name, JX_COUNTOF(name), "$gvar_%s_%u", tu->m_CurFunction->m_Name, ++tu->m_CurFuncGlobalVarID);
+	} else {
+		jx_snprintf(name, JX_COUNTOF(name), "$gvar_%u", ++tu->m_NextGlobalVarID);
+	}
 	return jcc_tuVarAllocGlobal(ctx, tu, name, ty);
 }
 
@@ -1677,7 +1732,9 @@ static jx_cc_object_t* jcc_tuVarAllocStringLiteral(jx_cc_context_t* ctx, jcc_tra
 		return NULL;
 	}
 
+	// NOTE: Modifying a string literal is UB so they can be placed in read-only memory.
 	var->m_GlobalInitData = p;
+	var->m_Flags |= JCC_OBJECT_FLAGS_IS_READ_ONLY_Msk;
 
 	jcc_tuAppendGlobal(ctx, tu, var);
 	
@@ -5945,6 +6002,10 @@ static jx_cc_ast_expr_t* jcc_astAllocStructMemberNode(jx_cc_context_t* ctx, jcc_
 			return NULL; // ERROR: no such member
 		}
 
+		// NOTE: The struct might have been reached through pointers whose base type 
+		// layout isn't part of the fingerprint.
+		jcc_tuFingerprintType(tu, ty, true);
+
 		node = jcc_astAllocExprMember(ctx, node, mem, tok);
 		if (!node) {
 			return NULL;
@@ -6682,6 +6743,202 @@ static void jcc_tuFunctionMarkLive(jcc_translation_unit_t* tu, jx_cc_object_t* v
 	}
 }
 
+static uint64_t jcc_fingerprintMixBytes(uint64_t hash, const void* data, size_t size)
+{
+	return jx_hashFNV1a(data, size, hash, 0);
+}
+
+// Mixes the parts of a type which affect the generated code. Members of structs/unions are only 
+// included if withMembers is true and for structs embedded in them (directly or as arrays). Types 
+// behind pointers only contribute their size; their members are mixed in when they are accessed
+// (see jcc_astAllocStructMemberNode()). This also guarantees that the recursion terminates.
+static uint64_t jcc_fingerprintMixType(uint64_t hash, const jx_cc_type_t* ty, bool withMembers)
+{
+	if (!ty) {
+		return jcc_fingerprintMixBytes(hash, &(uint32_t){ UINT32_MAX }, sizeof(uint32_t));
+	}
+
+	hash = jcc_fingerprintMixBytes(hash, &ty->m_Kind, sizeof(jx_cc_type_kind));
+	hash = jcc_fingerprintMixBytes(hash, &ty->m_Size, sizeof(int32_t));
+	hash = jcc_fingerprintMixBytes(hash, &ty->m_Alignment, sizeof(uint32_t));
+	hash = jcc_fingerprintMixBytes(hash, &ty->m_ArrayLen, sizeof(int32_t));
+	hash = jcc_fingerprintMixBytes(hash, &ty->m_Flags, sizeof(uint32_t));
+
+	switch (ty->m_Kind) {
+	case JCC_TYPE_PTR: {
+		hash = jcc_fingerprintMixType(hash, ty->m_BaseType, false);
+	} break;
+	case JCC_TYPE_ARRAY: {
+		hash = jcc_fingerprintMixType(hash, ty->m_BaseType, withMembers);
+	} break;
+	case JCC_TYPE_FUNC: {
+		hash = jcc_fingerprintMixType(hash, ty->m_FuncRetType, false);
+		for (const jx_cc_type_t* param = ty->m_FuncParams; param; param = param->m_Next) {
+			hash = jcc_fingerprintMixType(hash, param, false);
+		}
+	} break;
+	case JCC_TYPE_STRUCT:
+	case JCC_TYPE_UNION: {
+		if (withMembers) {
+			for (const jx_cc_struct_member_t* mem = ty->m_StructMembers; mem; mem = mem->m_Next) {
+				if (mem->m_Name) {
+					hash = jcc_fingerprintMixBytes(hash, mem->m_Name->m_String, mem->m_Name->m_Length);
+				}
+				hash = jcc_fingerprintMixBytes(hash, &mem->m_Offset, sizeof(uint32_t));
+				hash = jcc_fingerprintMixBytes(hash, &mem->m_BitOffset, sizeof(uint32_t));
+				hash = jcc_fingerprintMixBytes(hash, &mem->m_BitWidth, sizeof(uint32_t));
+				hash = jcc_fingerprintMixBytes(hash, &mem->m_IsBitfield, sizeof(bool));
+				hash = jcc_fingerprintMixType(hash, mem->m_Type, true);
+			}
+		}
+	} break;
+	default:
+		break;
+	}
+
+	return hash;
+}
+
+static uint64_t jcc_fingerprintMixTokens(uint64_t hash, const jx_cc_token_t* tok, const jx_cc_token_t* end)
+{
+	for (; tok && tok != end; tok = tok->m_Next) {
+		hash = jcc_fingerprintMixBytes(hash, &tok->m_Kind, sizeof(jx_cc_token_kind));
+		if (tok->m_Kind == JCC_TOKEN_STRING_LITERAL) {
+			// NOTE: Adjacent string literals have been merged so the token's text is only part of the value.
+			hash = jcc_fingerprintMixType(hash, tok->m_Type, false);
+			hash = jcc_fingerprintMixBytes(hash, tok->m_Val_string, tok->m_Type->m_Size);
+		} else if (tok->m_Kind == JCC_TOKEN_NUMBER) {
+			hash = jcc_fingerprintMixType(hash, tok->m_Type, false);
+			hash = jcc_fingerprintMixBytes(hash, &tok->m_Val_int, sizeof(int64_t));
+			hash = jcc_fingerprintMixBytes(hash, &tok->m_Val_float, sizeof(double));
+		} else {
+			hash = jcc_fingerprintMixBytes(hash, tok->m_String, tok->m_Length);
+		}
+	}
+
+	return hash;
+}
+
+static void jcc_tuFingerprintType(jcc_translation_unit_t* tu, const jx_cc_type_t* ty, bool withMembers)
+{
+	uint64_t* fingerprint = tu->m_CurFuncFingerprint;
+	if (fingerprint) {
+		*fingerprint = jcc_fingerprintMixType(*fingerprint, ty, withMembers);
+	}
+}
+
+static void jcc_tuFingerprintVarScope(jcc_translation_unit_t* tu, const jcc_var_scope_t* sc)
+{
+	uint64_t* fingerprint = tu->m_CurFuncFingerprint;
+	if (!fingerprint || !sc) {
+		return;
+	}
+
+	if (sc->m_Typedef) {
+		*fingerprint = jcc_fingerprintMixType(*fingerprint, sc->m_Typedef, true);
+	} else if (sc->m_Var) {
+		// NOTE: Locals are declared inside the function; their declarations are already part of its tokens.
+		const jx_cc_object_t* var = sc->m_Var;
+		if ((var->m_Flags & JCC_OBJECT_FLAGS_IS_LOCAL_Msk) == 0) {
+			const uint32_t varFlags = var->m_Flags & (JCC_OBJECT_FLAGS_IS_FUNCTION_Msk | JCC_OBJECT_FLAGS_IS_STATIC_Msk);
+			*fingerprint = jcc_fingerprintMixBytes(*fingerprint, var->m_Name, jx_strlen(var->m_Name));
+			*fingerprint = jcc_fingerprintMixBytes(*fingerprint, &varFlags, sizeof(uint32_t));
+			*fingerprint = jcc_fingerprintMixType(*fingerprint, var->m_Type, false);
+		}
+	} else if (sc->m_Enum) {
+		*fingerprint = jcc_fingerprintMixBytes(*fingerprint, &sc->m_EnumValue, sizeof(int32_t));
+	}
+}
+
+// The code of inline functions might end up in their callers. Mix the fingerprints of all inline
+// functions reachable from each function definition into its own fingerprint so callers are
+// considered changed whenever one of them does.
+static bool jcc_tuUpdateFunctionFingerprints(jx_cc_context_t* ctx, jcc_translation_unit_t* tu)
+{
+	bool res = false;
+	jx_hashmap_t* inlineFuncMap = jx_hashmapCreate(ctx->m_Allocator, sizeof(jcc_scope_entry_t), 64, 0, 0, jcc_scopeEntryHashCallback, jcc_scopeEntryCompareCallback, NULL, ctx);
+	jx_cc_object_t** visitedArr = (jx_cc_object_t**)jx_array_create(ctx->m_Allocator);
+	uint64_t* fingerprintArr = (uint64_t*)jx_array_create(ctx->m_Allocator);
+	if (!inlineFuncMap || !visitedArr || !fingerprintArr) {
+		goto end;
+	}
+
+	for (jx_cc_object_t* var = tu->m_GlobalsHead; var; var = var->m_Next) {
+		const bool isInlineDefinition = true
+			&& (var->m_Flags & JCC_OBJECT_FLAGS_IS_FUNCTION_Msk) != 0
+			&& (var->m_Flags & JCC_OBJECT_FLAGS_IS_DEFINITION_Msk) != 0
+			&& (var->m_Flags & JCC_OBJECT_FLAGS_IS_INLINE_Msk) != 0
+			;
+		if (isInlineDefinition) {
+			jx_hashmapSet(inlineFuncMap, &(jcc_scope_entry_t){.m_Key = var->m_Name, .m_KeyLen = jx_strlen(var->m_Name), .m_Value = var});
+		}
+	}
+
+	for (jx_cc_object_t* var = tu->m_GlobalsHead; var; var = var->m_Next) {
+		const bool isDefinition = true
+			&& (var->m_Flags & JCC_OBJECT_FLAGS_IS_FUNCTION_Msk) != 0
+			&& (var->m_Flags & JCC_OBJECT_FLAGS_IS_DEFINITION_Msk) != 0
+			;
+		if (!isDefinition) {
+			continue;
+		}
+
+		// Depth-first walk over the inline functions referenced by this function. visitedArr doubles
+		// as the work list; items before iNext have already been expanded.
+		uint64_t fingerprint = var->m_Fingerprint;
+		jx_array_resize(visitedArr, 0);
+		jx_array_push_back(visitedArr, var);
+		for (uint32_t iNext = 0; iNext < (uint32_t)jx_array_sizeu(visitedArr); ++iNext) {
+			const jx_cc_object_t* func = visitedArr[iNext];
+			const uint32_t numRefs = (uint32_t)jx_array_sizeu(func->m_FuncRefsArr);
+			for (uint32_t iRef = 0; iRef < numRefs; ++iRef) {
+				const char* refName = func->m_FuncRefsArr[iRef];
+				jcc_scope_entry_t* entry = jx_hashmapGet(inlineFuncMap, &(jcc_scope_entry_t){.m_Key = refName, .m_KeyLen = jx_strlen(refName)});
+				if (!entry) {
+					continue;
+				}
+
+				jx_cc_object_t* callee = (jx_cc_object_t*)entry->m_Value;
+				bool visited = false;
+				const uint32_t numVisited = (uint32_t)jx_array_sizeu(visitedArr);
+				for (uint32_t iVisited = 0; iVisited < numVisited && !visited; ++iVisited) {
+					visited = visitedArr[iVisited] == callee;
+				}
+
+				if (!visited) {
+					fingerprint = jcc_fingerprintMixBytes(fingerprint, &callee->m_Fingerprint, sizeof(uint64_t));
+					jx_array_push_back(visitedArr, callee);
+				}
+			}
+		}
+
+		jx_array_push_back(fingerprintArr, fingerprint);
+	}
+
+	// NOTE: Update all fingerprints at the end because the walks above need the original values.
+	uint32_t iFunc = 0;
+	for (jx_cc_object_t* var = tu->m_GlobalsHead; var; var = var->m_Next) {
+		const bool isDefinition = true
+			&& (var->m_Flags & JCC_OBJECT_FLAGS_IS_FUNCTION_Msk) != 0
+			&& (var->m_Flags & JCC_OBJECT_FLAGS_IS_DEFINITION_Msk) != 0
+			;
+		if (isDefinition) {
+			var->m_Fingerprint = fingerprintArr[iFunc++];
+		}
+	}
+
+	res = true;
+
+end:
+	jx_array_free(fingerprintArr);
+	jx_array_free(visitedArr);
+	if (inlineFuncMap) {
+		jx_hashmapDestroy(inlineFuncMap);
+	}
+
+	return res;
+}
+
 static bool jcc_parseFunction(jx_cc_context_t* ctx, jcc_translation_unit_t* tu, jx_cc_token_t** tokenListPtr, jx_cc_type_t* basety, jcc_var_attr_t* attr)
 {
 	jx_cc_token_t* tok = *tokenListPtr;
@@ -6762,6 +7019,13 @@ static bool jcc_parseFunction(jx_cc_context_t* ctx, jcc_translation_unit_t* tu,
 	if (!jcc_tokExpect(&tok, JCC_TOKEN_SEMICOLON)) {
 		tu->m_CurFunction = fn;
 
+		// NOTE: Types, globals and enum constants looked up while parsing the function are
+		// mixed into the fingerprint as they are found. The tokens are added at the end.
+		fn->m_Fingerprint = jcc_fingerprintMixBytes(JCC_FINGERPRINT_SEED, fn->m_Name, jx_strlen(fn->m_Name));
+		fn->m_Fingerprint = jcc_fingerprintMixType(fn->m_Fingerprint, ty, false);
+		tu->m_CurFuncFingerprint = &fn->m_Fingerprint;
+		tu->m_CurFuncGlobalVarID = 0;
+
 		jx_cc_object_t* funcPtr = tu->m_GlobalsTail;
 
 		if (!jcc_tuEnterScope(ctx, tu)) {
@@ -6849,6 +7113,11 @@ static bool jcc_parseFunction(jx_cc_context_t* ctx, jcc_translation_unit_t* tu,
 		jcc_tuLeaveScope(ctx, tu);
 
 		jcc_resolveGotoLabels(tu);
+
+		const uint32_t funcFlags = fn->m_Flags & (JCC_OBJECT_FLAGS_IS_STATIC_Msk | JCC_OBJECT_FLAGS_IS_INLINE_Msk);
+		fn->m_Fingerprint = jcc_fingerprintMixBytes(fn->m_Fingerprint, &funcFlags, sizeof(uint32_t));
+		fn->m_Fingerprint = jcc_fingerprintMixTokens(fn->m_Fingerprint, *tokenListPtr, tok);
+		tu->m_CurFuncFingerprint = NULL;
 	}
 
 	*tokenListPtr = tok;
@@ -7002,6 +7271,11 @@ static bool jcc_parse(jx_cc_context_t* ctx, jcc_translation_unit_t* tu, jx_cc_to
 			jcc_tuFunctionMarkLive(tu, var);
 		}
 	}
+
+	if (!jcc_tuUpdateFunctionFingerprints(ctx, tu)) {
+		jcc_logError(ctx, JCC_SOURCE_LOCATION_CUR(), "Internal Error: Memory allocation failed.");
+		return false;
+	}
 	
 	// Remove redundant tentative definitions.
 	jcc_scanGlobals(tu);
@@ -215,6 +215,8 @@ typedef struct jx_cc_token_t
 #define JCC_OBJECT_FLAGS_IS_LIVE_Msk       (1u << JCC_OBJECT_FLAGS_IS_LIVE_Pos)
 #define JCC_OBJECT_FLAGS_IS_ROOT_Pos       8
 #define JCC_OBJECT_FLAGS_IS_ROOT_Msk       (1u << JCC_OBJECT_FLAGS_IS_ROOT_Pos)
+#define JCC_OBJECT_FLAGS_IS_READ_ONLY_Pos  9
+#define JCC_OBJECT_FLAGS_IS_READ_ONLY_Msk  (1u << JCC_OBJECT_FLAGS_IS_READ_ONLY_Pos)
 
 typedef struct jx_cc_object_t 
 {
@@ -229,6 +231,7 @@ typedef struct jx_cc_object_t
 	jx_cc_object_t* m_FuncLocals;
 	jx_cc_object_t* m_FuncVarArgArea;
 	const char** m_FuncRefsArr;
+	uint64_t m_Fingerprint; // Function definitions only: hash of everything the generated code depends on.
 	uint32_t m_Alignment;
 	uint32_t m_Flags; // JCC_OBJECT_FLAGS_xxx
 } jx_cc_object_t;
@@ -566,9 +569,13 @@ typedef struct jx_cc_translation_unit_t
 
 typedef struct jx_cc_context_t jx_cc_context_t;
 
+// Called at the beginning and at the end of each frontend stage ("preprocess", "parse").
+typedef void (*jx_cc_stageCallback)(const char* stageName, bool isEnd, void* userData);
+
 jx_cc_context_t* jx_cc_createContext(jx_allocator_i* allocator, jx_logger_i* logger);
 void jx_cc_destroyContext(jx_cc_context_t* ctx);
 void jx_cc_addIncludePath(jx_cc_context_t* ctx, jx_file_base_dir baseDir, const char* relPath);
+void jx_cc_setStageCallback(jx_cc_context_t* ctx, jx_cc_stageCallback callback, void* userData);
 jx_cc_translation_unit_t* jx_cc_compileFile(jx_cc_context_t* ctx, jx_file_base_dir baseDir, const char* filename);
 
 static inline bool jx_cc_typeIsFloat(const jx_cc_type_t* ty)
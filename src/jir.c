@@ -35,27 +35,54 @@ typedef struct jx_ir_context_t
 	jx_ir_constant_t* m_ConstBool[2]; // { false, true }
 	jx_ir_module_t* m_ModuleListHead;
 
-	jx_ir_function_pass_t* m_FuncPass_canonicalizeOperands;
-	jx_ir_function_pass_t* m_FuncPass_simplifyCFG;
-	jx_ir_function_pass_t* m_FuncPass_singleRetBlock;
-	jx_ir_function_pass_t* m_FuncPass_simpleSSA;
-	jx_ir_function_pass_t* m_FuncPass_constantFolding;
-	jx_ir_function_pass_t* m_FuncPass_peephole;
-	jx_ir_function_pass_t* m_FuncPass_removeRedundantPhis;
-	jx_ir_function_pass_t* m_FuncPass_reorderBasicBlocks;
-	jx_ir_function_pass_t* m_FuncPass_deadCodeElimination;
-	jx_ir_function_pass_t* m_FuncPass_localValueNumbering;
-	jx_ir_module_pass_t* m_ModulePass_inlineFuncs;
+	jx_ir_pipeline_t* m_DefaultPipeline; // Owned by the context; one of the opt level presets
+	jx_ir_pipeline_t* m_Pipeline;
+
+	jx_ir_passCallback m_PassCallback;
+	void* m_PassCallbackUserData;
+	jx_ir_funcPipelineCallback m_FuncPipelineCallback;
+	void* m_FuncPipelineCallbackUserData;
 } jx_ir_context_t;
 
+typedef enum jir_pipeline_step_kind
+{
+	JIR_PIPELINE_STEP_PASS = 0,
+	JIR_PIPELINE_STEP_LOOP_BEGIN,
+	JIR_PIPELINE_STEP_LOOP_END,
+} jir_pipeline_step_kind;
+
+typedef struct jir_pipeline_step_t
+{
+	jx_ir_function_pass_t* m_FuncPass;
+	jx_ir_module_pass_t* m_ModulePass;
+	jir_pipeline_step_kind m_Kind;
+	jx_ir_pass_kind m_PassKind;
+	uint32_t m_Flags;
+	uint32_t m_MaxIterations;
+	uint64_t m_OptionsHash; // All options set on the pass, in order
+} jir_pipeline_step_t;
+
+typedef struct jx_ir_pipeline_t
+{
+	jir_pipeline_step_t* m_StepArr;
+} jx_ir_pipeline_t;
+
 static jx_ir_instruction_t* jir_instrAlloc(jx_ir_context_t* ctx, jx_ir_type_t* type, uint32_t opcode, uint32_t numOperands);
 
 static bool jir_moduleCtor(jx_ir_context_t* ctx, jx_ir_module_t* mod, const char* name);
 static void jir_moduleDtor(jx_ir_context_t* ctx, jx_ir_module_t* mod);
-static jx_ir_module_pass_t* jir_modulePassCreate(jx_ir_context_t* ctx, jirModulePassCtorFunc ctorFunc, void* passConfig);
+static jx_ir_module_pass_t* jir_modulePassCreate(jx_ir_context_t* ctx, const char* name, jirModulePassCtorFunc ctorFunc, void* passConfig);
 static void jir_modulePassDestroy(jx_ir_context_t* ctx, jx_ir_module_pass_t* pass);
 static bool jir_modulePassApply(jx_ir_context_t* ctx, jx_ir_module_pass_t* pass, jx_ir_module_t* mod);
 
+static void jir_pipelineStepDestroy(jx_ir_context_t* ctx, jir_pipeline_step_t* step);
+static bool jir_pipelineInsertStep(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos, const jir_pipeline_step_t* step);
+static uint32_t jir_pipelineFindLoopEnd(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t loopBegin);
+static bool jir_pipelineGetSegment(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t segmentID, uint32_t* begin, uint32_t* end);
+static jx_ir_pipeline_t* jir_getPipeline(jx_ir_context_t* ctx);
+static jx_ir_pipeline_t* jir_getFuncPipeline(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, const char* funcName);
+static bool jir_pipelineRunSteps(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t begin, uint32_t end, jx_ir_function_t* func);
+
 static bool jir_valueCtor(jx_ir_context_t* ctx, jx_ir_value_t* val, jx_ir_type_t* type, jx_ir_value_kind kind, const char* name);
 static void jir_valueDtor(jx_ir_context_t* ctx, jx_ir_value_t* val);
 
@@ -99,7 +126,7 @@ static void jir_funcDtor(jx_ir_context_t* ctx, jx_ir_function_t* func);
 static const char* jir_funcGenTempName(jx_ir_context_t* ctx, jx_ir_function_t* func);
 static bool jir_funcIsExternal(jx_ir_context_t* ctx, jx_ir_function_t* func);
 static void jir_funcInvalidateDomTree(jx_ir_context_t* ctx, jx_ir_function_t* func);
-static jx_ir_function_pass_t* jir_funcPassCreate(jx_ir_context_t* ctx, jirFuncPassCtorFunc ctorFunc, void* passConfig);
+static jx_ir_function_pass_t* jir_funcPassCreate(jx_ir_context_t* ctx, const char* name, jirFuncPassCtorFunc ctorFunc, void* passConfig);
 static void jir_funcPassDestroy(jx_ir_context_t* ctx, jx_ir_function_pass_t* pass);
 static bool jir_funcPassApply(jx_ir_context_t* ctx, jx_ir_function_pass_t* pass, jx_ir_function_t* func);
 
@@ -142,6 +169,149 @@ static const jir_buildin_type_desc_t kBuildinTypeDesc[] = {
 };
 JX_STATIC_ASSERT(JX_COUNTOF(kBuildinTypeDesc) == JIR_TYPE_NUM_PRIMITIVE_TYPES, "Missing primitive type descriptor?");
 
+#define JIR_PASS_DESC_FLAGS_REQUIRED_Pos 0 // Must be part of every pipeline
+#define JIR_PASS_DESC_FLAGS_REQUIRED_Msk (1u << JIR_PASS_DESC_FLAGS_REQUIRED_Pos)
+
+typedef struct jir_pass_desc_t
+{
+	const char* m_Name;
+	jirFuncPassCtorFunc m_FuncPassCtor;
+	jirModulePassCtorFunc m_ModulePassCtor;
+	uint32_t m_Flags; // JIR_PASS_DESC_FLAGS_xxx
+} jir_pass_desc_t;
+
+static const jir_pass_desc_t kPassDesc[] = {
+	[JIR_PASS_CANONICALIZE_OPERANDS]  = { .m_Name = "canonicalizeOperands", .m_FuncPassCtor = jx_ir_funcPassCreate_canonicalizeOperands },
+	[JIR_PASS_SIMPLIFY_CFG]           = { .m_Name = "simplifyCFG",          .m_FuncPassCtor = jx_ir_funcPassCreate_simplifyCFG },
+	[JIR_PASS_SINGLE_RET_BLOCK]       = { .m_Name = "singleRetBlock",       .m_FuncPassCtor = jx_ir_funcPassCreate_singleRetBlock },
+	[JIR_PASS_SIMPLE_SSA]             = { .m_Name = "simpleSSA",            .m_FuncPassCtor = jx_ir_funcPassCreate_simpleSSA },
+	[JIR_PASS_CONSTANT_FOLDING]       = { .m_Name = "constantFolding",      .m_FuncPassCtor = jx_ir_funcPassCreate_constantFolding },
+	[JIR_PASS_PEEPHOLE]               = { .m_Name = "peephole",             .m_FuncPassCtor = jx_ir_funcPassCreate_peephole },
+	[JIR_PASS_REMOVE_REDUNDANT_PHIS]  = { .m_Name = "removeRedundantPhis",  .m_FuncPassCtor = jx_ir_funcPassCreate_removeRedundantPhis },
+	[JIR_PASS_REORDER_BASIC_BLOCKS]   = { .m_Name = "reorderBasicBlocks",   .m_FuncPassCtor = jx_ir_funcPassCreate_reorderBasicBlocks },
+	[JIR_PASS_DEAD_CODE_ELIMINATION]  = { .m_Name = "deadCodeElimination",  .m_FuncPassCtor = jx_ir_funcPassCreate_deadCodeElimination },
+	[JIR_PASS_LOCAL_VALUE_NUMBERING]  = { .m_Name = "localValueNumbering",  .m_FuncPassCtor = jx_ir_funcPassCreate_localValueNumbering },
+	[JIR_PASS_IF_CONVERSION]          = { .m_Name = "ifConversion",         .m_FuncPassCtor = jx_ir_funcPassCreate_ifConversion },
+	[JIR_PASS_BIT_IDIOMS]             = { .m_Name = "bitIdioms",            .m_FuncPassCtor = jx_ir_funcPassCreate_bitIdioms, .m_Flags = JIR_PASS_DESC_FLAGS_REQUIRED_Msk },
+	[JIR_PASS_TAIL_CALLS]             = { .m_Name = "tailCalls",            .m_FuncPassCtor = jx_ir_funcPassCreate_tailCalls },
+	[JIR_PASS_INLINE_FUNCS]           = { .m_Name = "inlineFuncs",          .m_ModulePassCtor = jx_ir_modulePassCreate_inlineFuncs },
+};
+JX_STATIC_ASSERT(JX_COUNTOF(kPassDesc) == JIR_PASS_COUNT, "Missing pass descriptor?");
+
+typedef struct jir_pipeline_preset_step_t
+{
+	jir_pipeline_step_kind m_Kind;
+	jx_ir_pass_kind m_PassKind;
+	uint32_t m_Arg; // Step flags for passes, max iterations for loops
+} jir_pipeline_preset_step_t;
+
+#define PASS(kind)  { JIR_PIPELINE_STEP_PASS, JIR_PASS_##kind, 0 }
+#define LOOP(n)     { JIR_PIPELINE_STEP_LOOP_BEGIN, JIR_PASS_COUNT, n }
+#define END_LOOP()  { JIR_PIPELINE_STEP_LOOP_END, JIR_PASS_COUNT, 0 }
+
+static const jir_pipeline_preset_step_t kPipelinePresetO0[] = {
+	PASS(CANONICALIZE_OPERANDS),
+	PASS(SINGLE_RET_BLOCK),
+	PASS(BIT_IDIOMS),
+};
+
+static const jir_pipeline_preset_step_t kPipelinePresetO1[] = {
+	PASS(CANONICALIZE_OPERANDS),
+	PASS(SINGLE_RET_BLOCK),
+	PASS(SIMPLE_SSA),
+	PASS(CONSTANT_FOLDING),
+	PASS(BIT_IDIOMS),
+	PASS(PEEPHOLE),
+	PASS(SIMPLIFY_CFG),
+	PASS(DEAD_CODE_ELIMINATION),
+	PASS(REORDER_BASIC_BLOCKS),
+};
+
+static const jir_pipeline_preset_step_t kPipelinePresetO2[] = {
+	PASS(CANONICALIZE_OPERANDS),
+	PASS(SINGLE_RET_BLOCK),
+	PASS(SIMPLE_SSA),
+	PASS(CONSTANT_FOLDING),
+	PASS(BIT_IDIOMS),
+	PASS(DEAD_CODE_ELIMINATION),
+	PASS(REMOVE_REDUNDANT_PHIS),
+	PASS(CONSTANT_FOLDING),
+	PASS(LOCAL_VALUE_NUMBERING),
+	LOOP(10),
+		PASS(CONSTANT_FOLDING),
+		PASS(CANONICALIZE_OPERANDS),
+		PASS(PEEPHOLE),
+		PASS(REMOVE_REDUNDANT_PHIS),
+		PASS(SIMPLIFY_CFG),
+		PASS(DEAD_CODE_ELIMINATION),
+	END_LOOP(),
+	PASS(INLINE_FUNCS),
+	PASS(TAIL_CALLS),
+	PASS(REORDER_BASIC_BLOCKS),
+	LOOP(10),
+		PASS(CONSTANT_FOLDING),
+		PASS(CANONICALIZE_OPERANDS),
+		PASS(PEEPHOLE),
+		PASS(REMOVE_REDUNDANT_PHIS),
+		PASS(SIMPLIFY_CFG),
+		PASS(BIT_IDIOMS),
+		PASS(DEAD_CODE_ELIMINATION),
+		PASS(IF_CONVERSION),
+	END_LOOP(),
+	PASS(REORDER_BASIC_BLOCKS),
+};
+
+// NOTE: Same as O2 without inlining.
+static const jir_pipeline_preset_step_t kPipelinePresetOs[] = {
+	PASS(CANONICALIZE_OPERANDS),
+	PASS(SINGLE_RET_BLOCK),
+	PASS(SIMPLE_SSA),
+	PASS(CONSTANT_FOLDING),
+	PASS(BIT_IDIOMS),
+	PASS(DEAD_CODE_ELIMINATION),
+	PASS(REMOVE_REDUNDANT_PHIS),
+	PASS(CONSTANT_FOLDING),
+	PASS(LOCAL_VALUE_NUMBERING),
+	LOOP(10),
+		PASS(CONSTANT_FOLDING),
+		PASS(CANONICALIZE_OPERANDS),
+		PASS(PEEPHOLE),
+		PASS(REMOVE_REDUNDANT_PHIS),
+		PASS(SIMPLIFY_CFG),
+		PASS(DEAD_CODE_ELIMINATION),
+	END_LOOP(),
+	PASS(TAIL_CALLS),
+	PASS(REORDER_BASIC_BLOCKS),
+	LOOP(10),
+		PASS(CONSTANT_FOLDING),
+		PASS(CANONICALIZE_OPERANDS),
+		PASS(PEEPHOLE),
+		PASS(REMOVE_REDUNDANT_PHIS),
+		PASS(SIMPLIFY_CFG),
+		PASS(BIT_IDIOMS),
+		PASS(DEAD_CODE_ELIMINATION),
+		PASS(IF_CONVERSION),
+	END_LOOP(),
+	PASS(REORDER_BASIC_BLOCKS),
+};
+
+#undef PASS
+#undef LOOP
+#undef END_LOOP
+
+typedef struct jir_pipeline_preset_t
+{
+	const jir_pipeline_preset_step_t* m_Steps;
+	uint32_t m_NumSteps;
+} jir_pipeline_preset_t;
+
+static const jir_pipeline_preset_t kPipelinePreset[] = {
+	[JIR_OPT_LEVEL_O0] = { kPipelinePresetO0, JX_COUNTOF(kPipelinePresetO0) },
+	[JIR_OPT_LEVEL_O1] = { kPipelinePresetO1, JX_COUNTOF(kPipelinePresetO1) },
+	[JIR_OPT_LEVEL_O2] = { kPipelinePresetO2, JX_COUNTOF(kPipelinePresetO2) },
+	[JIR_OPT_LEVEL_Os] = { kPipelinePresetOs, JX_COUNTOF(kPipelinePresetOs) },
+};
+
 jx_ir_context_t* jx_ir_createContext(jx_allocator_i* allocator)
 {
 	jx_ir_context_t* ctx = (jx_ir_context_t*)JX_ALLOC(allocator, sizeof(jx_ir_context_t));
@@ -204,24 +374,13 @@ jx_ir_context_t* jx_ir_createContext(jx_allocator_i* allocator)
 		ctx->m_ConstBool[iConst] = cb;
 	}
 
-	// Initialize function passes
-	{
-		ctx->m_FuncPass_canonicalizeOperands = jir_funcPassCreate(ctx, jx_ir_funcPassCreate_canonicalizeOperands, NULL);
-		ctx->m_FuncPass_simplifyCFG = jir_funcPassCreate(ctx, jx_ir_funcPassCreate_simplifyCFG, NULL);
-		ctx->m_FuncPass_singleRetBlock = jir_funcPassCreate(ctx, jx_ir_funcPassCreate_singleRetBlock, NULL);
-		ctx->m_FuncPass_simpleSSA = jir_funcPassCreate(ctx, jx_ir_funcPassCreate_simpleSSA, NULL);
-		ctx->m_FuncPass_constantFolding = jir_funcPassCreate(ctx, jx_ir_funcPassCreate_constantFolding, NULL);
-		ctx->m_FuncPass_peephole = jir_funcPassCreate(ctx, jx_ir_funcPassCreate_peephole, NULL);
-		ctx->m_FuncPass_removeRedundantPhis = jir_funcPassCreate(ctx, jx_ir_funcPassCreate_removeRedundantPhis, NULL);
-		ctx->m_FuncPass_reorderBasicBlocks = jir_funcPassCreate(ctx, jx_ir_funcPassCreate_reorderBasicBlocks, NULL);
-		ctx->m_FuncPass_deadCodeElimination = jir_funcPassCreate(ctx, jx_ir_funcPassCreate_deadCodeElimination, NULL);
-		ctx->m_FuncPass_localValueNumbering = jir_funcPassCreate(ctx, jx_ir_funcPassCreate_localValueNumbering, NULL);
-	}
-
-	// Initialize module passes
-	{
-		ctx->m_ModulePass_inlineFuncs = jir_modulePassCreate(ctx, jx_ir_modulePassCreate_inlineFuncs, NULL);
+	// Initialize the default pipeline
+	ctx->m_DefaultPipeline = jx_ir_pipelineCreatePreset(ctx, JIR_OPT_LEVEL_O2);
+	if (!ctx->m_DefaultPipeline) {
+		jx_ir_destroyContext(ctx);
+		return NULL;
 	}
+	ctx->m_Pipeline = ctx->m_DefaultPipeline;
 
 	return ctx;
 }
@@ -288,66 +447,12 @@ void jx_ir_destroyContext(jx_ir_context_t* ctx)
 		}
 	}
 
-	// Free function passes
-	{
-		if (ctx->m_FuncPass_canonicalizeOperands) {
-			jir_funcPassDestroy(ctx, ctx->m_FuncPass_canonicalizeOperands);
-			ctx->m_FuncPass_canonicalizeOperands = NULL;
-		}
-
-		if (ctx->m_FuncPass_simplifyCFG) {
-			jir_funcPassDestroy(ctx, ctx->m_FuncPass_simplifyCFG);
-			ctx->m_FuncPass_simplifyCFG = NULL;
-		}
-
-		if (ctx->m_FuncPass_singleRetBlock) {
-			jir_funcPassDestroy(ctx, ctx->m_FuncPass_singleRetBlock);
-			ctx->m_FuncPass_singleRetBlock = NULL;
-		}
-
-		if (ctx->m_FuncPass_simpleSSA) {
-			jir_funcPassDestroy(ctx, ctx->m_FuncPass_simpleSSA);
-			ctx->m_FuncPass_simpleSSA = NULL;
-		}
-
-		if (ctx->m_FuncPass_constantFolding) {
-			jir_funcPassDestroy(ctx, ctx->m_FuncPass_constantFolding);
-			ctx->m_FuncPass_constantFolding = NULL;
-		}
-
-		if (ctx->m_FuncPass_peephole) {
-			jir_funcPassDestroy(ctx, ctx->m_FuncPass_peephole);
-			ctx->m_FuncPass_peephole = NULL;
-		}
-
-		if (ctx->m_FuncPass_removeRedundantPhis) {
-			jir_funcPassDestroy(ctx, ctx->m_FuncPass_removeRedundantPhis);
-			ctx->m_FuncPass_removeRedundantPhis = NULL;
-		}
-
-		if (ctx->m_FuncPass_reorderBasicBlocks) {
-			jir_funcPassDestroy(ctx, ctx->m_FuncPass_reorderBasicBlocks);
-			ctx->m_FuncPass_reorderBasicBlocks = NULL;
-		}
-
-		if (ctx->m_FuncPass_deadCodeElimination) {
-			jir_funcPassDestroy(ctx, ctx->m_FuncPass_deadCodeElimination);
-			ctx->m_FuncPass_deadCodeElimination = NULL;
-		}
-
-		if (ctx->m_FuncPass_localValueNumbering) {
-			jir_funcPassDestroy(ctx, ctx->m_FuncPass_localValueNumbering);
-			ctx->m_FuncPass_localValueNumbering = NULL;
-		}
-	}
-
-	// Free module passes
-	{
-		if (ctx->m_ModulePass_inlineFuncs) {
-			jir_modulePassDestroy(ctx, ctx->m_ModulePass_inlineFuncs);
-			ctx->m_ModulePass_inlineFuncs = NULL;
-		}
+	// Free pipelines
+	if (ctx->m_DefaultPipeline) {
+		jx_ir_pipelineDestroy(ctx, ctx->m_DefaultPipeline);
+		ctx->m_DefaultPipeline = NULL;
 	}
+	ctx->m_Pipeline = NULL;
 
 	// Free string table
 	if (ctx->m_StringTable) {
@@ -365,6 +470,51 @@ void jx_ir_destroyContext(jx_ir_context_t* ctx)
 	JX_FREE(allocator, ctx);
 }
 
+void jx_ir_setPassCallback(jx_ir_context_t* ctx, jx_ir_passCallback callback, void* userData)
+{
+	ctx->m_PassCallback = callback;
+	ctx->m_PassCallbackUserData = userData;
+}
+
+bool jx_ir_setOptLevel(jx_ir_context_t* ctx, jx_ir_opt_level level)
+{
+	jx_ir_pipeline_t* pipeline = jx_ir_pipelineCreatePreset(ctx, level);
+	if (!pipeline) {
+		return false;
+	}
+
+	if (ctx->m_Pipeline == ctx->m_DefaultPipeline) {
+		ctx->m_Pipeline = pipeline;
+	}
+
+	jx_ir_pipelineDestroy(ctx, ctx->m_DefaultPipeline);
+	ctx->m_DefaultPipeline = pipeline;
+
+	return true;
+}
+
+bool jx_ir_setPipeline(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline)
+{
+	if (!pipeline) {
+		ctx->m_Pipeline = ctx->m_DefaultPipeline;
+		return true;
+	}
+
+	if (!jx_ir_pipelineIsValid(ctx, pipeline)) {
+		return false;
+	}
+
+	ctx->m_Pipeline = pipeline;
+
+	return true;
+}
+
+void jx_ir_setFuncPipelineCallback(jx_ir_context_t* ctx, jx_ir_funcPipelineCallback callback, void* userData)
+{
+	ctx->m_FuncPipelineCallback = callback;
+	ctx->m_FuncPipelineCallbackUserData = userData;
+}
+
 void jx_ir_print(jx_ir_context_t* ctx, jx_string_buffer_t* sb)
 {
 	TracyCZoneN(tracyCtx, "IR: Print", 1);
@@ -394,6 +544,328 @@ jx_ir_module_t* jx_ir_getModule(jx_ir_context_t* ctx, uint32_t id)
 	return NULL;
 }
 
+jx_ir_pipeline_t* jx_ir_pipelineCreate(jx_ir_context_t* ctx)
+{
+	jx_ir_pipeline_t* pipeline = (jx_ir_pipeline_t*)JX_ALLOC(ctx->m_Allocator, sizeof(jx_ir_pipeline_t));
+	if (!pipeline) {
+		return NULL;
+	}
+
+	jx_memset(pipeline, 0, sizeof(jx_ir_pipeline_t));
+	pipeline->m_StepArr = (jir_pipeline_step_t*)jx_array_create(ctx->m_Allocator);
+	if (!pipeline->m_StepArr) {
+		JX_FREE(ctx->m_Allocator, pipeline);
+		return NULL;
+	}
+
+	return pipeline;
+}
+
+jx_ir_pipeline_t* jx_ir_pipelineCreatePreset(jx_ir_context_t* ctx, jx_ir_opt_level level)
+{
+	if ((uint32_t)level >= JX_COUNTOF(kPipelinePreset)) {
+		return NULL;
+	}
+
+	jx_ir_pipeline_t* pipeline = jx_ir_pipelineCreate(ctx);
+	if (!pipeline) {
+		return NULL;
+	}
+
+	const jir_pipeline_preset_t* preset = &kPipelinePreset[level];
+	for (uint32_t iStep = 0; iStep < preset->m_NumSteps; ++iStep) {
+		const jir_pipeline_preset_step_t* presetStep = &preset->m_Steps[iStep];
+
+		bool res = false;
+		switch (presetStep->m_Kind) {
+		case JIR_PIPELINE_STEP_PASS: {
+			res = jx_ir_pipelineInsertPass(ctx, pipeline, JIR_PIPELINE_POS_END, presetStep->m_PassKind, presetStep->m_Arg);
+		} break;
+		case JIR_PIPELINE_STEP_LOOP_BEGIN: {
+			res = jx_ir_pipelineInsertLoopBegin(ctx, pipeline, JIR_PIPELINE_POS_END, presetStep->m_Arg);
+		} break;
+		case JIR_PIPELINE_STEP_LOOP_END: {
+			res = jx_ir_pipelineInsertLoopEnd(ctx, pipeline, JIR_PIPELINE_POS_END);
+		} break;
+		default:
+			JX_CHECK(false, "Unknown pipeline step kind");
+			break;
+		}
+
+		if (!res) {
+			jx_ir_pipelineDestroy(ctx, pipeline);
+			return NULL;
+		}
+	}
+
+	JX_CHECK(jx_ir_pipelineIsValid(ctx, pipeline), "Invalid pipeline preset!");
+
+	return pipeline;
+}
+
+void jx_ir_pipelineDestroy(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline)
+{
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = 0; iStep < numSteps; ++iStep) {
+		jir_pipelineStepDestroy(ctx, &pipeline->m_StepArr[iStep]);
+	}
+	jx_array_free(pipeline->m_StepArr);
+
+	JX_FREE(ctx->m_Allocator, pipeline);
+}
+
+uint32_t jx_ir_pipelineGetNumSteps(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline)
+{
+	return (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+}
+
+bool jx_ir_pipelineInsertPass(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos, jx_ir_pass_kind kind, uint32_t flags)
+{
+	if ((uint32_t)kind >= JIR_PASS_COUNT) {
+		return false;
+	}
+
+	const jir_pass_desc_t* desc = &kPassDesc[kind];
+
+	jir_pipeline_step_t step = {
+		.m_Kind = JIR_PIPELINE_STEP_PASS,
+		.m_PassKind = kind,
+		.m_Flags = flags,
+		.m_MaxIterations = 1,
+	};
+
+	if (desc->m_FuncPassCtor) {
+		step.m_FuncPass = jir_funcPassCreate(ctx, desc->m_Name, desc->m_FuncPassCtor, NULL);
+		if (!step.m_FuncPass) {
+			return false;
+		}
+	} else {
+		step.m_ModulePass = jir_modulePassCreate(ctx, desc->m_Name, desc->m_ModulePassCtor, NULL);
+		if (!step.m_ModulePass) {
+			return false;
+		}
+	}
+
+	if (!jir_pipelineInsertStep(ctx, pipeline, pos, &step)) {
+		jir_pipelineStepDestroy(ctx, &step);
+		return false;
+	}
+
+	return true;
+}
+
+bool jx_ir_pipelineInsertLoopBegin(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos, uint32_t maxIterations)
+{
+	if (maxIterations == 0) {
+		return false;
+	}
+
+	jir_pipeline_step_t step = {
+		.m_Kind = JIR_PIPELINE_STEP_LOOP_BEGIN,
+		.m_PassKind = JIR_PASS_COUNT,
+		.m_MaxIterations = maxIterations,
+	};
+
+	return jir_pipelineInsertStep(ctx, pipeline, pos, &step);
+}
+
+bool jx_ir_pipelineInsertLoopEnd(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos)
+{
+	jir_pipeline_step_t step = {
+		.m_Kind = JIR_PIPELINE_STEP_LOOP_END,
+		.m_PassKind = JIR_PASS_COUNT,
+	};
+
+	return jir_pipelineInsertStep(ctx, pipeline, pos, &step);
+}
+
+void jx_ir_pipelineRemoveStep(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos)
+{
+	if (pos >= (uint32_t)jx_array_sizeu(pipeline->m_StepArr)) {
+		return;
+	}
+
+	jir_pipelineStepDestroy(ctx, &pipeline->m_StepArr[pos]);
+	jx_array_del(pipeline->m_StepArr, pos);
+}
+
+void jx_ir_pipelineMoveStep(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t from, uint32_t to)
+{
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	if (from >= numSteps || to >= numSteps || from == to) {
+		return;
+	}
+
+	jir_pipeline_step_t step = pipeline->m_StepArr[from];
+	jx_array_del(pipeline->m_StepArr, from);
+	jx_array_insert(pipeline->m_StepArr, to, step);
+}
+
+bool jx_ir_pipelineSetMaxIterations(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos, uint32_t maxIterations)
+{
+	if (pos >= (uint32_t)jx_array_sizeu(pipeline->m_StepArr) || maxIterations == 0) {
+		return false;
+	}
+
+	jir_pipeline_step_t* step = &pipeline->m_StepArr[pos];
+	if (step->m_Kind != JIR_PIPELINE_STEP_LOOP_BEGIN) {
+		return false;
+	}
+
+	step->m_MaxIterations = maxIterations;
+
+	return true;
+}
+
+bool jx_ir_pipelineSetPassOption(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos, const char* name, int64_t value)
+{
+	if (pos >= (uint32_t)jx_array_sizeu(pipeline->m_StepArr)) {
+		return false;
+	}
+
+	jir_pipeline_step_t* step = &pipeline->m_StepArr[pos];
+	jx_ir_function_pass_t* pass = step->m_FuncPass;
+	if (!pass || !pass->setOption) {
+		return false;
+	}
+
+	if (!pass->setOption(pass->m_Inst, name, value)) {
+		return false;
+	}
+
+	step->m_OptionsHash = jx_hashFNV1a(name, jx_strlen(name), step->m_OptionsHash, 0);
+	step->m_OptionsHash = jx_hashFNV1a(&value, sizeof(int64_t), step->m_OptionsHash, 0);
+
+	return true;
+}
+
+bool jx_ir_pipelineIsValid(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline)
+{
+	uint32_t depth = 0;
+	uint32_t passCount[JIR_PASS_COUNT] = { 0 };
+
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = 0; iStep < numSteps; ++iStep) {
+		const jir_pipeline_step_t* step = &pipeline->m_StepArr[iStep];
+		switch (step->m_Kind) {
+		case JIR_PIPELINE_STEP_PASS: {
+			if (step->m_ModulePass && depth != 0) {
+				return false;
+			}
+
+			++passCount[step->m_PassKind];
+		} break;
+		case JIR_PIPELINE_STEP_LOOP_BEGIN: {
+			if (step->m_MaxIterations == 0) {
+				return false;
+			}
+			++depth;
+		} break;
+		case JIR_PIPELINE_STEP_LOOP_END: {
+			if (depth == 0) {
+				return false;
+			}
+			--depth;
+		} break;
+		default:
+			return false;
+		}
+	}
+
+	if (depth != 0) {
+		return false;
+	}
+
+	for (uint32_t iPass = 0; iPass < JIR_PASS_COUNT; ++iPass) {
+		if ((kPassDesc[iPass].m_Flags & JIR_PASS_DESC_FLAGS_REQUIRED_Msk) != 0 && passCount[iPass] == 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint64_t jx_ir_pipelineHash(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline)
+{
+	uint64_t hash = 0;
+
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = 0; iStep < numSteps; ++iStep) {
+		const jir_pipeline_step_t* step = &pipeline->m_StepArr[iStep];
+		const uint64_t stepData[] = {
+			(uint64_t)step->m_Kind,
+			(uint64_t)step->m_PassKind,
+			(uint64_t)step->m_Flags,
+			(uint64_t)step->m_MaxIterations,
+			step->m_OptionsHash,
+		};
+		hash = jx_hashFNV1a(stepData, sizeof(stepData), hash, 0);
+	}
+
+	return hash;
+}
+
+void jx_ir_pipelinePrint(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, jx_string_buffer_t* sb)
+{
+	uint32_t depth = 0;
+
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = 0; iStep < numSteps; ++iStep) {
+		const jir_pipeline_step_t* step = &pipeline->m_StepArr[iStep];
+		if (step->m_Kind == JIR_PIPELINE_STEP_LOOP_END && depth != 0) {
+			--depth;
+		}
+
+		jx_strbuf_printf(sb, "%3u: ", iStep);
+		for (uint32_t i = 0; i < depth; ++i) {
+			jx_strbuf_printf(sb, "  ");
+		}
+
+		switch (step->m_Kind) {
+		case JIR_PIPELINE_STEP_PASS: {
+			jx_strbuf_printf(sb, "%s%s%s\n"
+				, kPassDesc[step->m_PassKind].m_Name
+				, step->m_ModulePass ? " (module)" : ""
+				, (step->m_Flags & JIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Msk) != 0 ? " [if changed]" : ""
+			);
+		} break;
+		case JIR_PIPELINE_STEP_LOOP_BEGIN: {
+			jx_strbuf_printf(sb, "loop (max %u iterations) {\n", step->m_MaxIterations);
+			++depth;
+		} break;
+		case JIR_PIPELINE_STEP_LOOP_END: {
+			jx_strbuf_printf(sb, "}\n");
+		} break;
+		default:
+			JX_CHECK(false, "Unknown pipeline step kind");
+			break;
+		}
+	}
+}
+
+uint64_t jx_ir_funcGetFingerprint(jx_ir_context_t* ctx, const char* funcName, uint64_t srcFingerprint)
+{
+	if (srcFingerprint == 0) {
+		return 0;
+	}
+
+	// NOTE: Module passes always come from the context's pipeline so it is part of the
+	// fingerprint even if the function has its own pipeline.
+	jx_ir_pipeline_t* pipeline = jir_getPipeline(ctx);
+	uint64_t fingerprint = jx_hashFNV1a(&(uint64_t){ jx_ir_pipelineHash(ctx, pipeline) }, sizeof(uint64_t), srcFingerprint, 0);
+
+	jx_ir_pipeline_t* funcPipeline = jir_getFuncPipeline(ctx, pipeline, funcName);
+	if (funcPipeline) {
+		fingerprint = jx_hashFNV1a(&(uint64_t){ jx_ir_pipelineHash(ctx, funcPipeline) }, sizeof(uint64_t), fingerprint, 0);
+	}
+
+	// NOTE: 0 means unknown.
+	return fingerprint != 0
+		? fingerprint
+		: 1
+		;
+}
+
 jx_ir_module_t* jx_ir_moduleBegin(jx_ir_context_t* ctx, const char* name)
 {
 	jx_ir_module_t* mod = (jx_ir_module_t*)JX_ALLOC(ctx->m_LinearAllocator, sizeof(jx_ir_module_t));
@@ -481,94 +953,51 @@ jx_ir_module_t* jx_ir_moduleBegin(jx_ir_context_t* ctx, const char* name)
 
 void jx_ir_moduleEnd(jx_ir_context_t* ctx, jx_ir_module_t* mod)
 {
-	// Apply pre func passes
-	{
-		jx_ir_function_t* func = mod->m_FunctionListHead;
-		while (func) {
-			if (!jir_funcIsExternal(ctx, func)) {
-				jir_funcPassApply(ctx, ctx->m_FuncPass_canonicalizeOperands, func);
-				jir_funcPassApply(ctx, ctx->m_FuncPass_singleRetBlock, func);
-				jir_funcPassApply(ctx, ctx->m_FuncPass_simpleSSA, func);
-				jir_funcPassApply(ctx, ctx->m_FuncPass_constantFolding, func);
-				jir_funcPassApply(ctx, ctx->m_FuncPass_deadCodeElimination, func);
-				jir_funcPassApply(ctx, ctx->m_FuncPass_removeRedundantPhis, func);
-				jir_funcPassApply(ctx, ctx->m_FuncPass_constantFolding, func);
-				jir_funcPassApply(ctx, ctx->m_FuncPass_localValueNumbering, func);
-
-				uint32_t iter = 0;
-				bool changed = true;
-				while (changed && iter < 10) {
-					changed = false;
-
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_constantFolding, func);
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_canonicalizeOperands, func) || changed;
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_peephole, func) || changed;
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_removeRedundantPhis, func) || changed;
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_simplifyCFG, func) || changed;
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_deadCodeElimination, func) || changed;
-
-					++iter;
-				}
-			}
-
-			func = func->m_Next;
+	// NOTE: Module passes split the pipeline into segments. Each segment is applied to
+	// all functions before the module pass which follows it.
+	jx_ir_pipeline_t* pipeline = jir_getPipeline(ctx);
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	uint32_t segmentBegin = 0;
+	uint32_t segmentID = 0;
+	for (uint32_t iStep = 0; iStep <= numSteps; ++iStep) {
+		jx_ir_module_pass_t* modulePass = iStep != numSteps
+			? pipeline->m_StepArr[iStep].m_ModulePass
+			: NULL
+			;
+		if (iStep != numSteps && !modulePass) {
+			continue;
 		}
-	}
-
-#if 0
-	{
-		jx_string_buffer_t* sb = jx_strbuf_create(ctx->m_Allocator);
-		jx_strbuf_printf(sb, "Pre-inlining\n");
-		jx_ir_modulePrint(ctx, mod, sb);
-		jx_strbuf_nullTerminate(sb);
-		JX_SYS_LOG_INFO(NULL, "%s", jx_strbuf_getString(sb, NULL));
-		jx_strbuf_destroy(sb);
-	}
-#endif
-
-	// Apply whole module passes
-	{
-		jir_modulePassApply(ctx, ctx->m_ModulePass_inlineFuncs, mod);
-	}
 
-#if 0
-	{
-		jx_string_buffer_t* sb = jx_strbuf_create(ctx->m_Allocator);
-		jx_strbuf_printf(sb, "Post-inlining\n");
-		jx_ir_modulePrint(ctx, mod, sb);
-		jx_strbuf_nullTerminate(sb);
-		JX_SYS_LOG_INFO(NULL, "%s", jx_strbuf_getString(sb, NULL));
-		jx_strbuf_destroy(sb);
-	}
-#endif
-
-	// Apply post func passes
-	{
 		jx_ir_function_t* func = mod->m_FunctionListHead;
 		while (func) {
 			if (!jir_funcIsExternal(ctx, func)) {
-				jir_funcPassApply(ctx, ctx->m_FuncPass_reorderBasicBlocks, func);
-
-				uint32_t iter = 0;
-				bool changed = true;
-				while (changed && iter < 10) {
-					changed = false;
-
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_constantFolding, func);
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_canonicalizeOperands, func) || changed;
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_peephole, func) || changed;
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_removeRedundantPhis, func) || changed;
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_simplifyCFG, func) || changed;
-					changed = jir_funcPassApply(ctx, ctx->m_FuncPass_deadCodeElimination, func) || changed;
+				jx_ir_pipeline_t* funcPipeline = jir_getFuncPipeline(ctx, pipeline, jx_ir_funcToValue(func)->m_Name);
+				if (funcPipeline) {
+					uint32_t funcSegmentBegin = 0;
+					uint32_t funcSegmentEnd = 0;
+					if (jir_pipelineGetSegment(ctx, funcPipeline, segmentID, &funcSegmentBegin, &funcSegmentEnd)) {
+						// NOTE: Segments of the function's pipeline past the last segment of the context's
+						// pipeline run along with it, so that all of the function's passes are applied.
+						if (iStep == numSteps) {
+							funcSegmentEnd = (uint32_t)jx_array_sizeu(funcPipeline->m_StepArr);
+						}
 
-					++iter;
+						jir_pipelineRunSteps(ctx, funcPipeline, funcSegmentBegin, funcSegmentEnd, func);
+					}
+				} else {
+					jir_pipelineRunSteps(ctx, pipeline, segmentBegin, iStep, func);
 				}
-
-				jir_funcPassApply(ctx, ctx->m_FuncPass_reorderBasicBlocks, func);
 			}
 
 			func = func->m_Next;
 		}
+
+		if (modulePass) {
+			jir_modulePassApply(ctx, modulePass, mod);
+		}
+
+		segmentBegin = iStep + 1;
+		++segmentID;
 	}
 }
 
@@ -1738,6 +2167,13 @@ jx_ir_instruction_t* jx_ir_instrMul(jx_ir_context_t* ctx, jx_ir_value_t* op1, jx
 	return jir_instrBinaryOp(ctx, JIR_OP_MUL, op1, op2);
 }
 
+// NOTE: Returns the upper half of the double-width product. The multiplication is 
+// signed or unsigned depending on the type of the operands.
+jx_ir_instruction_t* jx_ir_instrMulHi(jx_ir_context_t* ctx, jx_ir_value_t* op1, jx_ir_value_t* op2)
+{
+	return jir_instrBinaryOp(ctx, JIR_OP_MULHI, op1, op2);
+}
+
 jx_ir_instruction_t* jx_ir_instrDiv(jx_ir_context_t* ctx, jx_ir_value_t* op1, jx_ir_value_t* op2)
 {
 	return jir_instrBinaryOp(ctx, JIR_OP_DIV, op1, op2);
@@ -1791,6 +2227,79 @@ jx_ir_instruction_t* jx_ir_instrShr(jx_ir_context_t* ctx, jx_ir_value_t* val, jx
 	return instr;
 }
 
+static jx_ir_instruction_t* jir_instrRotate(jx_ir_context_t* ctx, uint32_t opcode, jx_ir_value_t* val, jx_ir_value_t* shiftAmount)
+{
+	if (!jx_ir_typeIsInteger(val->m_Type) || !jx_ir_typeIsInteger(shiftAmount->m_Type)) {
+		JX_CHECK(false, "Rotates can only be applied to integers.");
+		return NULL;
+	}
+
+	// NOTE: Same as shifts, shiftAmount might be a different type than val.
+	jx_ir_instruction_t* instr = jir_instrAlloc(ctx, val->m_Type, opcode, 2);
+	if (!instr) {
+		return NULL;
+	}
+
+	jir_instrAddOperand(ctx, instr, val);
+	jir_instrAddOperand(ctx, instr, shiftAmount);
+
+	return instr;
+}
+
+static jx_ir_instruction_t* jir_instrBitCount(jx_ir_context_t* ctx, uint32_t opcode, jx_ir_value_t* val)
+{
+	if (!jx_ir_typeIsInteger(val->m_Type)) {
+		JX_CHECK(false, "Bit manipulation instructions can only be applied to integers.");
+		return NULL;
+	}
+
+	jx_ir_instruction_t* instr = jir_instrAlloc(ctx, val->m_Type, opcode, 1);
+	if (!instr) {
+		return NULL;
+	}
+
+	jir_instrAddOperand(ctx, instr, val);
+
+	return instr;
+}
+
+jx_ir_instruction_t* jx_ir_instrRol(jx_ir_context_t* ctx, jx_ir_value_t* val, jx_ir_value_t* shiftAmount)
+{
+	return jir_instrRotate(ctx, JIR_OP_ROL, val, shiftAmount);
+}
+
+jx_ir_instruction_t* jx_ir_instrRor(jx_ir_context_t* ctx, jx_ir_value_t* val, jx_ir_value_t* shiftAmount)
+{
+	return jir_instrRotate(ctx, JIR_OP_ROR, val, shiftAmount);
+}
+
+jx_ir_instruction_t* jx_ir_instrBSwap(jx_ir_context_t* ctx, jx_ir_value_t* val)
+{
+	if (jx_ir_typeGetSize(val->m_Type) < 2) {
+		JX_CHECK(false, "bswap requires at least a 16-bit integer.");
+		return NULL;
+	}
+
+	return jir_instrBitCount(ctx, JIR_OP_BSWAP, val);
+}
+
+jx_ir_instruction_t* jx_ir_instrPopCnt(jx_ir_context_t* ctx, jx_ir_value_t* val)
+{
+	return jir_instrBitCount(ctx, JIR_OP_POPCNT, val);
+}
+
+// NOTE: ctlz/cttz follow lzcnt/tzcnt semantics, i.e. a zero input returns 
+// the bit width of the type.
+jx_ir_instruction_t* jx_ir_instrCtlz(jx_ir_context_t* ctx, jx_ir_value_t* val)
+{
+	return jir_instrBitCount(ctx, JIR_OP_CTLZ, val);
+}
+
+jx_ir_instruction_t* jx_ir_instrCttz(jx_ir_context_t* ctx, jx_ir_value_t* val)
+{
+	return jir_instrBitCount(ctx, JIR_OP_CTTZ, val);
+}
+
 jx_ir_instruction_t* jx_ir_instrNeg(jx_ir_context_t* ctx, jx_ir_value_t* val)
 {
 	jx_ir_constant_t* zero = jx_ir_constGetZero(ctx, val->m_Type);
@@ -2057,6 +2566,30 @@ jx_ir_instruction_t* jx_ir_instrSI2FP(jx_ir_context_t* ctx, jx_ir_value_t* val,
 	return instr;
 }
 
+jx_ir_instruction_t* jx_ir_instrSelect(jx_ir_context_t* ctx, jx_ir_value_t* cond, jx_ir_value_t* trueVal, jx_ir_value_t* falseVal)
+{
+	if (cond->m_Type->m_Kind != JIR_TYPE_BOOL) {
+		JX_CHECK(false, "select condition must be a boolean.");
+		return NULL;
+	}
+
+	if (trueVal->m_Type != falseVal->m_Type || !jx_ir_typeIsFirstClass(trueVal->m_Type)) {
+		JX_CHECK(false, "select values must be of the same first class type.");
+		return NULL;
+	}
+
+	jx_ir_instruction_t* instr = jir_instrAlloc(ctx, trueVal->m_Type, JIR_OP_SELECT, 3);
+	if (!instr) {
+		return NULL;
+	}
+
+	jir_instrAddOperand(ctx, instr, cond);
+	jir_instrAddOperand(ctx, instr, trueVal);
+	jir_instrAddOperand(ctx, instr, falseVal);
+
+	return instr;
+}
+
 
 jx_ir_instruction_t* jx_ir_instrCall(jx_ir_context_t* ctx, jx_ir_value_t* funcVal, uint32_t numArgs, jx_ir_value_t** argValues)
 {
@@ -2462,6 +2995,10 @@ void jx_ir_instrPrint(jx_ir_context_t* ctx, jx_ir_instruction_t* instr, jx_strin
 		jx_strbuf_printf(sb, "%%%s = ", instrVal->m_Name);
 	}
 
+	if (instr->m_OpCode == JIR_OP_CALL && (instrVal->m_Flags & JIR_VALUE_FLAGS_TAIL_CALL_Msk) != 0) {
+		jx_strbuf_pushCStr(sb, "tail ");
+	}
+
 	jx_strbuf_printf(sb, "%s ", kOpcodeMnemonic[instr->m_OpCode]);
 
 	jx_ir_user_t* instrUser = jx_ir_instrToUser(instr);
@@ -4828,6 +5365,10 @@ static jx_ir_instruction_t* jir_instrBinaryOpTyped(jx_ir_context_t* ctx, uint32_
 		JX_CHECK(type == operand1->m_Type, "Arithmetic operation should return the same type as operands.");
 		JX_CHECK(jx_ir_typeIsInteger(type) || jx_ir_typeIsFloatingPoint(type), "Tried to create arithmetic operation on non-arithmetic type.");
 	} break;
+	case JIR_OP_MULHI: {
+		JX_CHECK(type == operand1->m_Type, "Arithmetic operation should return the same type as operands.");
+		JX_CHECK(jx_ir_typeIsInteger(type), "mulhi is only valid for integer types.");
+	} break;
 	case JIR_OP_AND:
 	case JIR_OP_OR:
 	case JIR_OP_XOR: {
@@ -4875,7 +5416,7 @@ static void jir_funcInvalidateDomTree(jx_ir_context_t* ctx, jx_ir_function_t* fu
 	func->m_Flags &= ~JIR_FUNC_FLAGS_DOM_TREE_VALID_Msk;
 }
 
-static jx_ir_function_pass_t* jir_funcPassCreate(jx_ir_context_t* ctx, jirFuncPassCtorFunc ctorFunc, void* passConfig)
+static jx_ir_function_pass_t* jir_funcPassCreate(jx_ir_context_t* ctx, const char* name, jirFuncPassCtorFunc ctorFunc, void* passConfig)
 {
 	jx_ir_function_pass_t* pass = (jx_ir_function_pass_t*)JX_ALLOC(ctx->m_Allocator, sizeof(jx_ir_function_pass_t));
 	if (!pass) {
@@ -4888,6 +5429,8 @@ static jx_ir_function_pass_t* jir_funcPassCreate(jx_ir_context_t* ctx, jirFuncPa
 		return NULL;
 	}
 
+	pass->m_Name = name;
+
 	return pass;
 }
 
@@ -4899,10 +5442,18 @@ static void jir_funcPassDestroy(jx_ir_context_t* ctx, jx_ir_function_pass_t* pas
 
 static bool jir_funcPassApply(jx_ir_context_t* ctx, jx_ir_function_pass_t* pass, jx_ir_function_t* func)
 {
-	return pass->run(pass->m_Inst, ctx, func);
+	if (!ctx->m_PassCallback) {
+		return pass->run(pass->m_Inst, ctx, func);
+	}
+
+	ctx->m_PassCallback(pass->m_Name, false, ctx->m_PassCallbackUserData);
+	const bool changed = pass->run(pass->m_Inst, ctx, func);
+	ctx->m_PassCallback(pass->m_Name, true, ctx->m_PassCallbackUserData);
+
+	return changed;
 }
 
-static jx_ir_module_pass_t* jir_modulePassCreate(jx_ir_context_t* ctx, jirModulePassCtorFunc ctorFunc, void* passConfig)
+static jx_ir_module_pass_t* jir_modulePassCreate(jx_ir_context_t* ctx, const char* name, jirModulePassCtorFunc ctorFunc, void* passConfig)
 {
 	jx_ir_module_pass_t* pass = (jx_ir_module_pass_t*)JX_ALLOC(ctx->m_Allocator, sizeof(jx_ir_module_pass_t));
 	if (!pass) {
@@ -4915,6 +5466,8 @@ static jx_ir_module_pass_t* jir_modulePassCreate(jx_ir_context_t* ctx, jirModule
 		return NULL;
 	}
 
+	pass->m_Name = name;
+
 	return pass;
 }
 
@@ -4926,5 +5479,153 @@ static void jir_modulePassDestroy(jx_ir_context_t* ctx, jx_ir_module_pass_t* pas
 
 static bool jir_modulePassApply(jx_ir_context_t* ctx, jx_ir_module_pass_t* pass, jx_ir_module_t* mod)
 {
-	return pass->run(pass->m_Inst, ctx, mod);
+	if (!ctx->m_PassCallback) {
+		return pass->run(pass->m_Inst, ctx, mod);
+	}
+
+	ctx->m_PassCallback(pass->m_Name, false, ctx->m_PassCallbackUserData);
+	const bool changed = pass->run(pass->m_Inst, ctx, mod);
+	ctx->m_PassCallback(pass->m_Name, true, ctx->m_PassCallbackUserData);
+
+	return changed;
+}
+
+static void jir_pipelineStepDestroy(jx_ir_context_t* ctx, jir_pipeline_step_t* step)
+{
+	if (step->m_FuncPass) {
+		jir_funcPassDestroy(ctx, step->m_FuncPass);
+		step->m_FuncPass = NULL;
+	}
+
+	if (step->m_ModulePass) {
+		jir_modulePassDestroy(ctx, step->m_ModulePass);
+		step->m_ModulePass = NULL;
+	}
+}
+
+static bool jir_pipelineInsertStep(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos, const jir_pipeline_step_t* step)
+{
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	if (pos == JIR_PIPELINE_POS_END) {
+		pos = numSteps;
+	} else if (pos > numSteps) {
+		return false;
+	}
+
+	jx_array_insert(pipeline->m_StepArr, pos, *step);
+
+	return true;
+}
+
+// Returns the index of the LOOP_END step which matches the LOOP_BEGIN step at loopBegin.
+static uint32_t jir_pipelineFindLoopEnd(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t loopBegin)
+{
+	JX_CHECK(pipeline->m_StepArr[loopBegin].m_Kind == JIR_PIPELINE_STEP_LOOP_BEGIN, "Expected loop begin step");
+
+	uint32_t depth = 0;
+
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = loopBegin; iStep < numSteps; ++iStep) {
+		const jir_pipeline_step_kind kind = pipeline->m_StepArr[iStep].m_Kind;
+		if (kind == JIR_PIPELINE_STEP_LOOP_BEGIN) {
+			++depth;
+		} else if (kind == JIR_PIPELINE_STEP_LOOP_END) {
+			--depth;
+			if (depth == 0) {
+				return iStep;
+			}
+		}
+	}
+
+	JX_CHECK(false, "Unbalanced pipeline loop");
+	return numSteps;
+}
+
+// Segments are the step ranges between module passes.
+static bool jir_pipelineGetSegment(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t segmentID, uint32_t* begin, uint32_t* end)
+{
+	uint32_t curSegmentID = 0;
+	uint32_t segmentBegin = 0;
+
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = 0; iStep <= numSteps; ++iStep) {
+		if (iStep != numSteps && !pipeline->m_StepArr[iStep].m_ModulePass) {
+			continue;
+		}
+
+		if (curSegmentID == segmentID) {
+			*begin = segmentBegin;
+			*end = iStep;
+			return true;
+		}
+
+		segmentBegin = iStep + 1;
+		++curSegmentID;
+	}
+
+	return false;
+}
+
+// NOTE: Pipelines are only validated when installed but the caller can still edit them
+// afterwards. Fall back to the opt level pipeline if the installed one became invalid.
+static jx_ir_pipeline_t* jir_getPipeline(jx_ir_context_t* ctx)
+{
+	return jx_ir_pipelineIsValid(ctx, ctx->m_Pipeline)
+		? ctx->m_Pipeline
+		: ctx->m_DefaultPipeline
+		;
+}
+
+// Returns NULL if the function should use the context's pipeline.
+static jx_ir_pipeline_t* jir_getFuncPipeline(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, const char* funcName)
+{
+	jx_ir_pipeline_t* funcPipeline = ctx->m_FuncPipelineCallback
+		? ctx->m_FuncPipelineCallback(funcName, ctx->m_FuncPipelineCallbackUserData)
+		: NULL
+		;
+	return (funcPipeline && funcPipeline != pipeline && jx_ir_pipelineIsValid(ctx, funcPipeline))
+		? funcPipeline
+		: NULL
+		;
+}
+
+static bool jir_pipelineRunSteps(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t begin, uint32_t end, jx_ir_function_t* func)
+{
+	bool changed = false;
+	bool prevChanged = true;
+
+	uint32_t iStep = begin;
+	while (iStep < end) {
+		const jir_pipeline_step_t* step = &pipeline->m_StepArr[iStep];
+		if (step->m_Kind == JIR_PIPELINE_STEP_LOOP_BEGIN) {
+			const uint32_t loopEnd = jir_pipelineFindLoopEnd(ctx, pipeline, iStep);
+			JX_CHECK(loopEnd < end, "Pipeline loop crosses segment boundary");
+
+			bool loopChanged = false;
+			bool iterChanged = true;
+			uint32_t iter = 0;
+			while (iterChanged && iter < step->m_MaxIterations) {
+				iterChanged = jir_pipelineRunSteps(ctx, pipeline, iStep + 1, loopEnd, func);
+				loopChanged = loopChanged || iterChanged;
+				++iter;
+			}
+
+			prevChanged = loopChanged;
+			changed = changed || loopChanged;
+			iStep = loopEnd + 1;
+		} else {
+			const bool skip = true
+				&& (step->m_Flags & JIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Msk) != 0
+				&& !prevChanged
+				;
+			if (step->m_FuncPass && !skip) {
+				prevChanged = jir_funcPassApply(ctx, step->m_FuncPass, func);
+				changed = changed || prevChanged;
+			}
+
+			++iStep;
+		}
+	}
+
+	return changed;
 }
@@ -26,6 +26,7 @@ typedef struct jx_ir_basic_block_t jx_ir_basic_block_t;
 typedef struct jx_ir_instruction_t jx_ir_instruction_t;
 typedef struct jx_ir_function_pass_t jx_ir_function_pass_t;
 typedef struct jx_ir_module_pass_t jx_ir_module_pass_t;
+typedef struct jx_ir_pipeline_t jx_ir_pipeline_t;
 
 typedef enum jx_ir_value_kind
 {
@@ -114,6 +115,14 @@ typedef enum jx_ir_opcode
 	JIR_OP_FP2SI,           // OK
 	JIR_OP_UI2FP,           // OK
 	JIR_OP_SI2FP,           // OK
+	JIR_OP_SELECT,          // OK
+	JIR_OP_ROL,             // OK
+	JIR_OP_ROR,             // OK
+	JIR_OP_BSWAP,           // OK
+	JIR_OP_POPCNT,          // OK
+	JIR_OP_CTLZ,            // OK
+	JIR_OP_CTTZ,            // OK
+	JIR_OP_MULHI,           // OK
 
 	JIR_OP_SET_CC_BASE = JIR_OP_SET_LE
 } jx_ir_opcode;
@@ -160,6 +169,14 @@ static const char* kOpcodeMnemonic[] = {
 	[JIR_OP_FP2SI]           = "fp2si",
 	[JIR_OP_UI2FP]           = "ui2fp",
 	[JIR_OP_SI2FP]           = "si2fp",
+	[JIR_OP_SELECT]          = "select",
+	[JIR_OP_ROL]             = "rol",
+	[JIR_OP_ROR]             = "ror",
+	[JIR_OP_BSWAP]           = "bswap",
+	[JIR_OP_POPCNT]          = "popcnt",
+	[JIR_OP_CTLZ]            = "ctlz",
+	[JIR_OP_CTTZ]            = "cttz",
+	[JIR_OP_MULHI]           = "mulhi",
 };
 
 // NOTE: Order must match the order of JIR_OP_SET_cc opcodes above
@@ -197,6 +214,8 @@ typedef enum jx_ir_intrinsic_func
 
 #define JIR_VALUE_FLAGS_CONST_GLOBAL_VAL_PTR_Pos 0
 #define JIR_VALUE_FLAGS_CONST_GLOBAL_VAL_PTR_Msk (1u << JIR_VALUE_FLAGS_CONST_GLOBAL_VAL_PTR_Pos)
+#define JIR_VALUE_FLAGS_TAIL_CALL_Pos            1
+#define JIR_VALUE_FLAGS_TAIL_CALL_Msk            (1u << JIR_VALUE_FLAGS_TAIL_CALL_Pos)
 
 typedef struct jx_ir_module_t
 {
@@ -355,6 +374,7 @@ typedef struct jx_ir_function_t
 	jx_ir_argument_t* m_ArgListHead;
 	uint32_t m_NextTempID;
 	uint32_t m_Flags; // JIR_FUNC_FLAGS_xxx
+	uint64_t m_Fingerprint; // Source fingerprint mixed with the IR pipeline (see jx_ir_funcGetFingerprint()); 0 if unknown.
 } jx_ir_function_t;
 
 typedef struct jx_ir_instruction_t
@@ -372,9 +392,11 @@ typedef struct jx_ir_function_pass_t
 {
 	jx_ir_function_pass_o* m_Inst;
 	jx_ir_function_pass_t* m_Next;
+	const char* m_Name;
 
 	bool (*run)(jx_ir_function_pass_o* pass, jx_ir_context_t* ctx, jx_ir_function_t* func);
 	void (*destroy)(jx_ir_function_pass_o* pass, jx_allocator_i* allocator);
+	bool (*setOption)(jx_ir_function_pass_o* pass, const char* name, int64_t value); // Optional
 } jx_ir_function_pass_t;
 
 typedef struct jx_ir_module_pass_o jx_ir_module_pass_o;
@@ -382,13 +404,58 @@ typedef struct jx_ir_module_pass_t
 {
 	jx_ir_module_pass_o* m_Inst;
 	jx_ir_module_pass_t* m_Next;
+	const char* m_Name;
 
 	bool (*run)(jx_ir_module_pass_o* pass, jx_ir_context_t* ctx, jx_ir_module_t* mod);
 	void (*destroy)(jx_ir_module_pass_o* pass, jx_allocator_i* allocator);
 } jx_ir_module_pass_t;
 
+typedef enum jx_ir_pass_kind
+{
+	JIR_PASS_CANONICALIZE_OPERANDS = 0,
+	JIR_PASS_SIMPLIFY_CFG,
+	JIR_PASS_SINGLE_RET_BLOCK,
+	JIR_PASS_SIMPLE_SSA,
+	JIR_PASS_CONSTANT_FOLDING,
+	JIR_PASS_PEEPHOLE,
+	JIR_PASS_REMOVE_REDUNDANT_PHIS,
+	JIR_PASS_REORDER_BASIC_BLOCKS,
+	JIR_PASS_DEAD_CODE_ELIMINATION,
+	JIR_PASS_LOCAL_VALUE_NUMBERING,
+	JIR_PASS_IF_CONVERSION,       // Options: maxInstrsPerBlock, maxPhis
+	JIR_PASS_BIT_IDIOMS,          // Required (lowers __builtin_xxx calls)
+	JIR_PASS_TAIL_CALLS,
+	JIR_PASS_INLINE_FUNCS,        // Module pass
+
+	JIR_PASS_COUNT
+} jx_ir_pass_kind;
+
+typedef enum jx_ir_opt_level
+{
+	JIR_OPT_LEVEL_O0 = 0, // Only normalize the IR and lower builtins
+	JIR_OPT_LEVEL_O1,     // Cheap scalar optimizations, no inlining
+	JIR_OPT_LEVEL_O2,     // Default
+	JIR_OPT_LEVEL_Os,     // O2 without transformations which increase code size
+} jx_ir_opt_level;
+
+#define JIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Pos 0 // Run the pass only if the previous step changed the function
+#define JIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Msk (1u << JIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Pos)
+
+#define JIR_PIPELINE_POS_END UINT32_MAX
+
+// Called before and after each pass executed by jx_ir_moduleEnd().
+typedef void (*jx_ir_passCallback)(const char* passName, bool isEnd, void* userData);
+
+// Returns the pipeline which should be used for the specified function or NULL to use 
+// the context's pipeline.
+typedef jx_ir_pipeline_t* (*jx_ir_funcPipelineCallback)(const char* funcName, void* userData);
+
 jx_ir_context_t* jx_ir_createContext(jx_allocator_i* allocator);
 void jx_ir_destroyContext(jx_ir_context_t* ctx);
+void jx_ir_setPassCallback(jx_ir_context_t* ctx, jx_ir_passCallback callback, void* userData);
+bool jx_ir_setOptLevel(jx_ir_context_t* ctx, jx_ir_opt_level level);
+bool jx_ir_setPipeline(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline); // NULL to restore the opt level pipeline
+void jx_ir_setFuncPipelineCallback(jx_ir_context_t* ctx, jx_ir_funcPipelineCallback callback, void* userData);
 void jx_ir_print(jx_ir_context_t* ctx, jx_string_buffer_t* sb);
 jx_ir_module_t* jx_ir_getModule(jx_ir_context_t* ctx, uint32_t id);
 
@@ -401,6 +468,39 @@ jx_ir_function_t* jx_ir_moduleGetFunc(jx_ir_context_t* ctx, jx_ir_module_t* mod,
 jx_ir_global_variable_t* jx_ir_moduleGetGlobalVar(jx_ir_context_t* ctx, jx_ir_module_t* mod, const char* name);
 void jx_ir_modulePrint(jx_ir_context_t* ctx, jx_ir_module_t* mod, jx_string_buffer_t* sb);
 
+// Pass pipelines
+// 
+// A pipeline is a list of steps executed by jx_ir_moduleEnd(). Each pass step owns its own 
+// instance of the pass, so options are per step. Loops repeat their steps until none of them
+// changes the function or the max number of iterations is reached. Module passes cannot be
+// inside loops; they split the pipeline into segments and each segment is applied to all 
+// functions before the next module pass. A per-function pipeline replaces the segments of
+// the context's pipeline with its own (module passes in it only separate segments); its 
+// extra segments, if any, are applied in the last segment of the context's pipeline.
+// Every pipeline must contain all required passes.
+// 
+// Pipelines are owned by the caller and must outlive their use by the context.
+// They are validated again by jx_ir_moduleEnd() since they can be edited after being installed; 
+// an invalid pipeline is replaced by the opt level pipeline.
+jx_ir_pipeline_t* jx_ir_pipelineCreate(jx_ir_context_t* ctx);
+jx_ir_pipeline_t* jx_ir_pipelineCreatePreset(jx_ir_context_t* ctx, jx_ir_opt_level level);
+void jx_ir_pipelineDestroy(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline);
+uint32_t jx_ir_pipelineGetNumSteps(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline);
+bool jx_ir_pipelineInsertPass(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos, jx_ir_pass_kind kind, uint32_t flags);
+bool jx_ir_pipelineInsertLoopBegin(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos, uint32_t maxIterations);
+bool jx_ir_pipelineInsertLoopEnd(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos);
+void jx_ir_pipelineRemoveStep(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos);
+void jx_ir_pipelineMoveStep(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t from, uint32_t to);
+bool jx_ir_pipelineSetMaxIterations(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos, uint32_t maxIterations);
+bool jx_ir_pipelineSetPassOption(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, uint32_t pos, const char* name, int64_t value);
+bool jx_ir_pipelineIsValid(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline);
+uint64_t jx_ir_pipelineHash(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline);
+void jx_ir_pipelinePrint(jx_ir_context_t* ctx, jx_ir_pipeline_t* pipeline, jx_string_buffer_t* sb);
+
+// Mixes the pipeline which jx_ir_moduleEnd() will apply to the function into its source 
+// fingerprint (see jx_ir_function_t::m_Fingerprint). Returns 0 if srcFingerprint is 0.
+uint64_t jx_ir_funcGetFingerprint(jx_ir_context_t* ctx, const char* funcName, uint64_t srcFingerprint);
+
 bool jx_ir_funcBegin(jx_ir_context_t* ctx, jx_ir_function_t* func, uint32_t flags);
 void jx_ir_funcEnd(jx_ir_context_t* ctx, jx_ir_function_t* func);
 jx_ir_argument_t* jx_ir_funcGetArgument(jx_ir_context_t* ctx, jx_ir_function_t* func, uint32_t argID);
@@ -435,6 +535,7 @@ jx_ir_instruction_t* jx_ir_instrBranchIf(jx_ir_context_t* ctx, jx_ir_value_t* co
 jx_ir_instruction_t* jx_ir_instrAdd(jx_ir_context_t* ctx, jx_ir_value_t* val1, jx_ir_value_t* val2);
 jx_ir_instruction_t* jx_ir_instrSub(jx_ir_context_t* ctx, jx_ir_value_t* val1, jx_ir_value_t* val2);
 jx_ir_instruction_t* jx_ir_instrMul(jx_ir_context_t* ctx, jx_ir_value_t* val1, jx_ir_value_t* val2);
+jx_ir_instruction_t* jx_ir_instrMulHi(jx_ir_context_t* ctx, jx_ir_value_t* val1, jx_ir_value_t* val2);
 jx_ir_instruction_t* jx_ir_instrDiv(jx_ir_context_t* ctx, jx_ir_value_t* val1, jx_ir_value_t* val2);
 jx_ir_instruction_t* jx_ir_instrRem(jx_ir_context_t* ctx, jx_ir_value_t* val1, jx_ir_value_t* val2);
 jx_ir_instruction_t* jx_ir_instrAnd(jx_ir_context_t* ctx, jx_ir_value_t* val1, jx_ir_value_t* val2);
@@ -442,6 +543,12 @@ jx_ir_instruction_t* jx_ir_instrOr(jx_ir_context_t* ctx, jx_ir_value_t* val1, jx
 jx_ir_instruction_t* jx_ir_instrXor(jx_ir_context_t* ctx, jx_ir_value_t* val1, jx_ir_value_t* val2);
 jx_ir_instruction_t* jx_ir_instrShl(jx_ir_context_t* ctx, jx_ir_value_t* val, jx_ir_value_t* shiftAmount);
 jx_ir_instruction_t* jx_ir_instrShr(jx_ir_context_t* ctx, jx_ir_value_t* val, jx_ir_value_t* shiftAmount);
+jx_ir_instruction_t* jx_ir_instrRol(jx_ir_context_t* ctx, jx_ir_value_t* val, jx_ir_value_t* shiftAmount);
+jx_ir_instruction_t* jx_ir_instrRor(jx_ir_context_t* ctx, jx_ir_value_t* val, jx_ir_value_t* shiftAmount);
+jx_ir_instruction_t* jx_ir_instrBSwap(jx_ir_context_t* ctx, jx_ir_value_t* val);
+jx_ir_instruction_t* jx_ir_instrPopCnt(jx_ir_context_t* ctx, jx_ir_value_t* val);
+jx_ir_instruction_t* jx_ir_instrCtlz(jx_ir_context_t* ctx, jx_ir_value_t* val);
+jx_ir_instruction_t* jx_ir_instrCttz(jx_ir_context_t* ctx, jx_ir_value_t* val);
 jx_ir_instruction_t* jx_ir_instrNeg(jx_ir_context_t* ctx, jx_ir_value_t* val);
 jx_ir_instruction_t* jx_ir_instrNot(jx_ir_context_t* ctx, jx_ir_value_t* val);
 jx_ir_instruction_t* jx_ir_instrSetCC(jx_ir_context_t* ctx, jx_ir_condition_code cc, jx_ir_value_t* val1, jx_ir_value_t* val2);
@@ -463,6 +570,7 @@ jx_ir_instruction_t* jx_ir_instrFP2UI(jx_ir_context_t* ctx, jx_ir_value_t* val,
 jx_ir_instruction_t* jx_ir_instrFP2SI(jx_ir_context_t* ctx, jx_ir_value_t* val, jx_ir_type_t* targetType);
 jx_ir_instruction_t* jx_ir_instrUI2FP(jx_ir_context_t* ctx, jx_ir_value_t* val, jx_ir_type_t* targetType);
 jx_ir_instruction_t* jx_ir_instrSI2FP(jx_ir_context_t* ctx, jx_ir_value_t* val, jx_ir_type_t* targetType);
+jx_ir_instruction_t* jx_ir_instrSelect(jx_ir_context_t* ctx, jx_ir_value_t* cond, jx_ir_value_t* trueVal, jx_ir_value_t* falseVal);
 jx_ir_instruction_t* jx_ir_instrCall(jx_ir_context_t* ctx, jx_ir_value_t* func, uint32_t numParams, jx_ir_value_t** params);
 jx_ir_instruction_t* jx_ir_instrAlloca(jx_ir_context_t* ctx, jx_ir_type_t* type, jx_ir_value_t* arraySize);
 jx_ir_instruction_t* jx_ir_instrLoad(jx_ir_context_t* ctx, jx_ir_type_t* type, jx_ir_value_t* ptr);
@@ -584,6 +692,7 @@ static inline bool jx_ir_opcodeIsCommutative(jx_ir_opcode opcode)
 	return (false
 		|| opcode == JIR_OP_ADD
 		|| opcode == JIR_OP_MUL
+		|| opcode == JIR_OP_MULHI
 		|| opcode == JIR_OP_AND
 		|| opcode == JIR_OP_OR
 		|| opcode == JIR_OP_XOR
@@ -33,6 +33,8 @@ typedef struct jx_irgen_context_t
 	jx_ir_basic_block_t* m_BasicBlock;
 	jx_hashmap_t* m_LocalVarMap;
 	jx_hashmap_t* m_LabeledBBMap;
+	jx_irgen_isFuncCachedCallback m_IsFuncCachedCallback;
+	void* m_IsFuncCachedUserData;
 } jx_irgen_context_t;
 
 typedef jx_ir_instruction_t* (*irUnaryOpFunc)(jx_ir_context_t* ctx, jx_ir_value_t* op);
@@ -105,6 +107,12 @@ void jx_irgen_destroyContext(jx_irgen_context_t* ctx)
 	JX_FREE(allocator, ctx);
 }
 
+void jx_irgen_setFuncCacheCallback(jx_irgen_context_t* ctx, jx_irgen_isFuncCachedCallback callback, void* userData)
+{
+	ctx->m_IsFuncCachedCallback = callback;
+	ctx->m_IsFuncCachedUserData = userData;
+}
+
 bool jx_irgen_moduleGen(jx_irgen_context_t* ctx, const char* moduleName, jx_cc_translation_unit_t* tu)
 {
 	jx_ir_context_t* irctx = ctx->m_IRCtx;
@@ -153,6 +161,20 @@ bool jx_irgen_moduleGen(jx_irgen_context_t* ctx, const char* moduleName, jx_cc_t
 
 					const bool funcIsInline = (global->m_Flags & JCC_OBJECT_FLAGS_IS_INLINE_Msk) != 0;
 
+					func->m_Fingerprint = jx_ir_funcGetFingerprint(irctx, global->m_Name, global->m_Fingerprint);
+
+					// NOTE: Inline functions are always generated because their body might be needed
+					// for inlining into callers which have changed.
+					const bool funcIsCached = true
+						&& !funcIsInline
+						&& ctx->m_IsFuncCachedCallback
+						&& ctx->m_IsFuncCachedCallback(global->m_Name, func->m_Fingerprint, ctx->m_IsFuncCachedUserData)
+						;
+					if (funcIsCached) {
+						global = global->m_Next;
+						continue;
+					}
+
 					const uint32_t funcFlags = 0
 						| (funcIsInline ? JIR_FUNC_FLAGS_INLINE_Msk : 0)
 						;
@@ -284,7 +306,7 @@ bool jx_irgen_moduleGen(jx_irgen_context_t* ctx, const char* moduleName, jx_cc_t
 
 						JX_FREE(ctx->m_Allocator, initData);
 
-						const bool isConst = false; // TODO: 
+						const bool isConst = (global->m_Flags & JCC_OBJECT_FLAGS_IS_READ_ONLY_Msk) != 0;
 						jx_ir_globalVarDefine(irctx, gv, isConst, gvInitializer);
 					} else {
 						goto error;
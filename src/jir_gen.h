@@ -10,8 +10,16 @@ typedef struct jx_ir_context_t jx_ir_context_t;
 
 typedef struct jx_irgen_context_t jx_irgen_context_t;
 
+// Returns true if compiled code for the function with the specified fingerprint is already
+// available (e.g. jx64_codeCacheContains()). Such functions are only declared; their body
+// is not generated. The fingerprint includes the IR pipeline (see jx_ir_funcGetFingerprint()) 
+// but not the MIR one; mix it in with jx_mir_funcGetFingerprint() before looking up code 
+// generated from MIR.
+typedef bool (*jx_irgen_isFuncCachedCallback)(const char* funcName, uint64_t fingerprint, void* userData);
+
 jx_irgen_context_t* jx_irgen_createContext(jx_ir_context_t* irCtx, jx_allocator_i* allocator);
 void jx_irgen_destroyContext(jx_irgen_context_t* ctx);
+void jx_irgen_setFuncCacheCallback(jx_irgen_context_t* ctx, jx_irgen_isFuncCachedCallback callback, void* userData);
 
 bool jx_irgen_moduleGen(jx_irgen_context_t* ctx, const char* moduleName, jx_cc_translation_unit_t* tu);
 
@@ -980,6 +980,7 @@ static jx_ir_constant_t* jir_constFold_cmpConst(jx_ir_context_t* ctx, jx_ir_cons
 static jx_ir_constant_t* jir_constFold_addConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs);
 static jx_ir_constant_t* jir_constFold_subConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs);
 static jx_ir_constant_t* jir_constFold_mulConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs);
+static jx_ir_constant_t* jir_constFold_mulHiConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs);
 static jx_ir_constant_t* jir_constFold_divConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs);
 static jx_ir_constant_t* jir_constFold_remConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs);
 static jx_ir_constant_t* jir_constFold_andConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs);
@@ -987,6 +988,7 @@ static jx_ir_constant_t* jir_constFold_orConst(jx_ir_context_t* ctx, jx_ir_const
 static jx_ir_constant_t* jir_constFold_xorConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs);
 static jx_ir_constant_t* jir_constFold_shlConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs);
 static jx_ir_constant_t* jir_constFold_shrConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs);
+static jx_ir_constant_t* jir_constFold_bitManip(jx_ir_context_t* ctx, uint32_t opcode, jx_ir_constant_t* op, jx_ir_constant_t* shiftAmount);
 static jx_ir_constant_t* jir_constFold_truncConst(jx_ir_context_t* ctx, jx_ir_constant_t* op, jx_ir_type_t* type);
 static jx_ir_constant_t* jir_constFold_zextConst(jx_ir_context_t* ctx, jx_ir_constant_t* op, jx_ir_type_t* type);
 static jx_ir_constant_t* jir_constFold_sextConst(jx_ir_context_t* ctx, jx_ir_constant_t* op, jx_ir_type_t* type);
@@ -1081,6 +1083,13 @@ static bool jir_funcPass_constantFoldingRun(jx_ir_function_pass_o* inst, jx_ir_c
 						resConst = jir_constFold_mulConst(ctx, lhs, rhs);
 					}
 				} break;
+				case JIR_OP_MULHI: {
+					jx_ir_constant_t* lhs = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 0));
+					jx_ir_constant_t* rhs = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 1));
+					if (lhs && rhs) {
+						resConst = jir_constFold_mulHiConst(ctx, lhs, rhs);
+					}
+				} break;
 				case JIR_OP_DIV: {
 					jx_ir_constant_t* lhs = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 0));
 					jx_ir_constant_t* rhs = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 1));
@@ -1142,6 +1151,23 @@ static bool jir_funcPass_constantFoldingRun(jx_ir_function_pass_o* inst, jx_ir_c
 						resConst = jir_constFold_shrConst(ctx, lhs, rhs);
 					}
 				} break;
+				case JIR_OP_ROL:
+				case JIR_OP_ROR: {
+					jx_ir_constant_t* lhs = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 0));
+					jx_ir_constant_t* rhs = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 1));
+					if (lhs && rhs) {
+						resConst = jir_constFold_bitManip(ctx, instr->m_OpCode, lhs, rhs);
+					}
+				} break;
+				case JIR_OP_BSWAP:
+				case JIR_OP_POPCNT:
+				case JIR_OP_CTLZ:
+				case JIR_OP_CTTZ: {
+					jx_ir_constant_t* op = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 0));
+					if (op) {
+						resConst = jir_constFold_bitManip(ctx, instr->m_OpCode, op, NULL);
+					}
+				} break;
 				case JIR_OP_TRUNC: {
 					jx_ir_constant_t* op = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 0));
 					if (op) {
@@ -1207,6 +1233,28 @@ static bool jir_funcPass_constantFoldingRun(jx_ir_function_pass_o* inst, jx_ir_c
 				case JIR_OP_GET_ELEMENT_PTR: {
 					resConst = jir_constFold_gep(ctx, instr);
 				} break;
+				case JIR_OP_SELECT: {
+					jx_ir_value_t* condVal = jx_ir_instrGetOperandVal(instr, 0);
+					jx_ir_value_t* trueVal = jx_ir_instrGetOperandVal(instr, 1);
+					jx_ir_value_t* falseVal = jx_ir_instrGetOperandVal(instr, 2);
+					jx_ir_constant_t* cond = jx_ir_valueToConst(condVal);
+
+					jx_ir_value_t* resVal = NULL;
+					if (cond) {
+						resVal = cond->u.m_Bool ? trueVal : falseVal;
+					} else if (trueVal == falseVal) {
+						resVal = trueVal;
+					}
+
+					// NOTE: The selected value might not be a constant so the replacement 
+					// is performed here instead of below.
+					if (resVal) {
+						jx_ir_valueReplaceAllUsesWith(ctx, jx_ir_instrToValue(instr), resVal);
+						jx_ir_bbRemoveInstr(ctx, bb, instr);
+						jx_ir_instrFree(ctx, instr);
+						++numFolds;
+					}
+				} break;
 				case JIR_OP_PHI:
 				case JIR_OP_CALL:
 				case JIR_OP_RET:
@@ -1440,6 +1488,53 @@ static jx_ir_constant_t* jir_constFold_mulConst(jx_ir_context_t* ctx, jx_ir_cons
 	return res;
 }
 
+static jx_ir_constant_t* jir_constFold_mulHiConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs)
+{
+	JX_CHECK(jx_ir_constToValue(lhs)->m_Type == jx_ir_constToValue(rhs)->m_Type, "Expected operands of the same type");
+	jx_ir_type_t* operandType = jx_ir_constToValue(lhs)->m_Type;
+	if (!jx_ir_typeIsInteger(operandType)) {
+		JX_CHECK(false, "Invalid types?");
+		return NULL;
+	}
+
+	const bool isSigned = jx_ir_typeIsSigned(operandType);
+	const uint32_t numBits = (uint32_t)jx_ir_typeGetSize(operandType) * 8;
+
+	int64_t res = 0;
+	if (numBits < 64) {
+		// NOTE: Signed constants are stored sign extended so the full product fits in 64 bits.
+		const uint64_t mask = (1ull << numBits) - 1;
+		res = isSigned
+			? ((lhs->u.m_I64 * rhs->u.m_I64) >> numBits)
+			: (int64_t)(((lhs->u.m_U64 & mask) * (rhs->u.m_U64 & mask)) >> numBits)
+			;
+	} else {
+		const uint64_t a = lhs->u.m_U64;
+		const uint64_t b = rhs->u.m_U64;
+		const uint64_t aLo = a & 0xFFFFFFFFull;
+		const uint64_t aHi = a >> 32;
+		const uint64_t bLo = b & 0xFFFFFFFFull;
+		const uint64_t bHi = b >> 32;
+		const uint64_t loLo = aLo * bLo;
+		const uint64_t hiLo = aHi * bLo;
+		const uint64_t loHi = aLo * bHi;
+		const uint64_t hiHi = aHi * bHi;
+		const uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFFull) + loHi;
+		uint64_t hi = hiHi + (hiLo >> 32) + (cross >> 32);
+		if (isSigned) {
+			hi -= (lhs->u.m_I64 < 0) ? b : 0;
+			hi -= (rhs->u.m_I64 < 0) ? a : 0;
+		}
+		res = (int64_t)hi;
+	}
+
+	if (!isSigned && numBits != 64) {
+		res &= (int64_t)((1ull << numBits) - 1);
+	}
+
+	return jx_ir_constGetInteger(ctx, operandType->m_Kind, res);
+}
+
 static jx_ir_constant_t* jir_constFold_divConst(jx_ir_context_t* ctx, jx_ir_constant_t* lhs, jx_ir_constant_t* rhs)
 {
 	JX_CHECK(jx_ir_constToValue(lhs)->m_Type == jx_ir_constToValue(rhs)->m_Type, "Expected operands of the same type");
@@ -1606,6 +1701,74 @@ static jx_ir_constant_t* jir_constFold_shrConst(jx_ir_context_t* ctx, jx_ir_cons
 	return res;
 }
 
+static jx_ir_constant_t* jir_constFold_bitManip(jx_ir_context_t* ctx, uint32_t opcode, jx_ir_constant_t* op, jx_ir_constant_t* shiftAmount)
+{
+	jx_ir_type_t* operandType = jx_ir_constToValue(op)->m_Type;
+	if (!jx_ir_typeIsInteger(operandType)) {
+		JX_CHECK(false, "Invalid types?");
+		return NULL;
+	}
+
+	const uint32_t numBits = (uint32_t)jx_ir_typeGetSize(operandType) * 8;
+	const uint64_t mask = numBits == 64 
+		? ~0ull 
+		: ((1ull << numBits) - 1)
+		;
+	const uint64_t val = op->u.m_U64 & mask;
+
+	uint64_t res = 0;
+	switch (opcode) {
+	case JIR_OP_ROL:
+	case JIR_OP_ROR: {
+		uint32_t amount = (uint32_t)(shiftAmount->u.m_U64 & (numBits - 1));
+		if (opcode == JIR_OP_ROR) {
+			amount = (numBits - amount) & (numBits - 1);
+		}
+		res = amount == 0
+			? val
+			: ((val << amount) | (val >> (numBits - amount)))
+			;
+	} break;
+	case JIR_OP_BSWAP: {
+		const uint32_t numBytes = numBits / 8;
+		for (uint32_t i = 0; i < numBytes; ++i) {
+			res |= ((val >> (i * 8)) & 0xFF) << ((numBytes - 1 - i) * 8);
+		}
+	} break;
+	case JIR_OP_POPCNT: {
+		res = jx_bitcount_u64(val);
+	} break;
+	case JIR_OP_CTLZ: {
+		res = numBits;
+		for (uint32_t i = 0; i < numBits; ++i) {
+			if ((val & (1ull << (numBits - 1 - i))) != 0) {
+				res = i;
+				break;
+			}
+		}
+	} break;
+	case JIR_OP_CTTZ: {
+		res = numBits;
+		for (uint32_t i = 0; i < numBits; ++i) {
+			if ((val & (1ull << i)) != 0) {
+				res = i;
+				break;
+			}
+		}
+	} break;
+	default:
+		JX_CHECK(false, "Unknown bit manipulation op");
+		return NULL;
+	}
+
+	res &= mask;
+	if (jx_ir_typeIsSigned(operandType) && numBits != 64) {
+		res = (uint64_t)((int64_t)(res << (64 - numBits)) >> (64 - numBits));
+	}
+
+	return jx_ir_constGetInteger(ctx, operandType->m_Kind, (int64_t)res);
+}
+
 static jx_ir_constant_t* jir_constFold_truncConst(jx_ir_context_t* ctx, jx_ir_constant_t* op, jx_ir_type_t* type)
 {
 	jx_ir_type_t* operandType = jx_ir_constToValue(op)->m_Type;
@@ -1864,6 +2027,11 @@ static bool jir_funcPass_peepholeRun(jx_ir_function_pass_o* inst, jx_ir_context_
 
 static bool jir_peephole_setcc(jir_func_pass_peephole_t* pass, jx_ir_instruction_t* instr);
 static bool jir_peephole_div(jir_func_pass_peephole_t* pass, jx_ir_instruction_t* instr);
+static bool jir_peephole_rem(jir_func_pass_peephole_t* pass, jx_ir_instruction_t* instr);
+static jx_ir_value_t* jir_peephole_genDivByConst(jx_ir_context_t* ctx, jx_ir_instruction_t* anchor, jx_ir_value_t* val, jx_ir_constant_t* divisor);
+static jx_ir_value_t* jir_peephole_insertInstr(jx_ir_context_t* ctx, jx_ir_instruction_t* anchor, jx_ir_instruction_t* instr);
+static void jir_divMagicUnsigned(uint64_t d, uint32_t numBits, uint64_t* magic, uint32_t* shift, bool* add);
+static void jir_divMagicSigned(int64_t d, uint32_t numBits, uint64_t* magic, uint32_t* shift);
 static bool jir_peephole_mul(jir_func_pass_peephole_t* pass, jx_ir_instruction_t* instr);
 static bool jir_peephole_add(jir_func_pass_peephole_t* pass, jx_ir_instruction_t* instr);
 static bool jir_peephole_sub(jir_func_pass_peephole_t* pass, jx_ir_instruction_t* instr);
@@ -1923,6 +2091,8 @@ static bool jir_funcPass_peepholeRun(jx_ir_function_pass_o* inst, jx_ir_context_
 					numOpts += jir_peephole_setcc(pass, instr) ? 1 : 0;
 				} else if (instr->m_OpCode == JIR_OP_DIV) {
 					numOpts += jir_peephole_div(pass, instr) ? 1 : 0;
+				} else if (instr->m_OpCode == JIR_OP_REM) {
+					numOpts += jir_peephole_rem(pass, instr) ? 1 : 0;
 				} else if (instr->m_OpCode == JIR_OP_MUL) {
 					numOpts += jir_peephole_mul(pass, instr) ? 1 : 0;
 				} else if (instr->m_OpCode == JIR_OP_ADD) {
@@ -2089,24 +2259,308 @@ static bool jir_peephole_div(jir_func_pass_peephole_t* pass, jx_ir_instruction_t
 			jx_ir_instrFree(ctx, instr);
 
 			res = true;
-		} else if (isInteger && constOp1->u.m_I64 > 0 && jx_isPow2_u32((uint32_t)constOp1->u.m_I64)) {
-			// %res = div %val, imm_pow2
+		} else if (isInteger) {
+			// %res = div %val, imm
 			//  =>
-			// %res = shr %val, log2(imm_pow2)
-			jx_ir_constant_t* constI8 = jx_ir_constGetI8(ctx, jx_log2_u32((uint32_t)constOp1->u.m_I64));
-			jx_ir_instruction_t* shrInstr = jx_ir_instrShr(ctx, jx_ir_instrGetOperandVal(instr, 0), jx_ir_constToValue(constI8));
-			jx_ir_bbInsertInstrBefore(ctx, bb, instr, shrInstr);
-			jx_ir_valueReplaceAllUsesWith(ctx, jx_ir_instrToValue(instr), jx_ir_instrToValue(shrInstr));
-			jx_ir_bbRemoveInstr(ctx, bb, instr);
-			jx_ir_instrFree(ctx, instr);
+			// shifts and/or multiply-high by a magic number (see jir_peephole_genDivByConst)
+			jx_ir_value_t* quotient = jir_peephole_genDivByConst(ctx, instr, jx_ir_instrGetOperandVal(instr, 0), constOp1);
+			if (quotient) {
+				jx_ir_valueReplaceAllUsesWith(ctx, jx_ir_instrToValue(instr), quotient);
+				jx_ir_bbRemoveInstr(ctx, bb, instr);
+				jx_ir_instrFree(ctx, instr);
 
-			res = true;
+				res = true;
+			}
 		}
 	}
 
 	return res;
 }
 
+static bool jir_peephole_rem(jir_func_pass_peephole_t* pass, jx_ir_instruction_t* instr)
+{
+	jx_ir_context_t* ctx = pass->m_Ctx;
+	jx_ir_basic_block_t* bb = instr->m_ParentBB;
+
+	jx_ir_value_t* valOp0 = jx_ir_instrGetOperandVal(instr, 0);
+	jx_ir_value_t* valOp1 = jx_ir_instrGetOperandVal(instr, 1);
+	jx_ir_constant_t* constOp1 = jx_ir_valueToConst(valOp1);
+	if (!constOp1 || !jx_ir_typeIsInteger(valOp1->m_Type)) {
+		return false;
+	}
+
+	jx_ir_type_t* type = valOp1->m_Type;
+	const uint32_t numBits = jx_ir_typeGetSize(type) * 8;
+	const uint64_t mask = numBits == 64
+		? ~0ull
+		: ((1ull << numBits) - 1)
+		;
+	const uint64_t divisor = constOp1->u.m_U64 & mask;
+
+	jx_ir_value_t* remainder = NULL;
+	if (divisor == 1 || (jx_ir_typeIsSigned(type) && divisor == mask)) {
+		// %res = rem %val, 1 (or -1)
+		//  =>
+		// replace %res with 0
+		remainder = jx_ir_constToValue(jx_ir_constGetZero(ctx, type));
+	} else if (!jx_ir_typeIsSigned(type) && divisor != 0 && (divisor & (divisor - 1)) == 0) {
+		// %res = rem %val, imm_pow2
+		//  =>
+		// %res = and %val, imm_pow2 - 1
+		jx_ir_value_t* maskVal = jx_ir_constToValue(jx_ir_constGetInteger(ctx, type->m_Kind, (int64_t)(divisor - 1)));
+		remainder = jir_peephole_insertInstr(ctx, instr, jx_ir_instrAnd(ctx, valOp0, maskVal));
+	} else {
+		// %res = rem %val, imm
+		//  =>
+		// %q = div %val, imm (expanded using jir_peephole_genDivByConst)
+		// %qm = mul %q, imm
+		// %res = sub %val, %qm
+		jx_ir_value_t* quotient = jir_peephole_genDivByConst(ctx, instr, valOp0, constOp1);
+		if (quotient) {
+			jx_ir_value_t* product = jir_peephole_insertInstr(ctx, instr, jx_ir_instrMul(ctx, quotient, valOp1));
+			remainder = jir_peephole_insertInstr(ctx, instr, jx_ir_instrSub(ctx, valOp0, product));
+		}
+	}
+
+	if (!remainder) {
+		return false;
+	}
+
+	jx_ir_valueReplaceAllUsesWith(ctx, jx_ir_instrToValue(instr), remainder);
+	jx_ir_bbRemoveInstr(ctx, bb, instr);
+	jx_ir_instrFree(ctx, instr);
+
+	return true;
+}
+
+// Division by a constant (other than 0 and 1). Returns NULL if the division
+// should be left as is.
+// 
+// Unsigned, d = 2^k:
+//   %q = shr %val, k
+// Signed, d = 2^k (round towards zero):
+//   %sign = shr %val, W - 1
+//   %bias = and %sign, 2^k - 1
+//   %tmp = add %val, %bias
+//   %q = shr %tmp, k
+// 32/64-bit unsigned (Hacker's Delight, 10-8):
+//   %t = mulhi %val, M
+//   %q = shr %t, s
+//  or, if M doesn't fit in W bits:
+//   %t = mulhi %val, M
+//   %q = shr (add (shr (sub %val, %t), 1), %t), s - 1
+// 32/64-bit signed (Hacker's Delight, 10-4):
+//   %t = mulhi %val, M
+//   %t = add %t, %val (if d > 0 and M < 0) or sub %t, %val (if d < 0 and M > 0)
+//   %t = shr %t, s
+//   %q = sub %t, (shr %t, W - 1)
+// 
+// NOTE: shr on signed types is an arithmetic shift.
+static jx_ir_value_t* jir_peephole_genDivByConst(jx_ir_context_t* ctx, jx_ir_instruction_t* anchor, jx_ir_value_t* val, jx_ir_constant_t* divisor)
+{
+	jx_ir_type_t* type = val->m_Type;
+	if (!jx_ir_typeIsInteger(type) || jx_ir_constToValue(divisor)->m_Type != type) {
+		return NULL;
+	}
+
+	const bool isSigned = jx_ir_typeIsSigned(type);
+	const uint32_t numBits = jx_ir_typeGetSize(type) * 8;
+	const uint64_t mask = numBits == 64
+		? ~0ull
+		: ((1ull << numBits) - 1)
+		;
+	const uint64_t signBit = 1ull << (numBits - 1);
+	const uint64_t d = divisor->u.m_U64 & mask;
+	if (d == 0 || d == 1) {
+		return NULL;
+	}
+
+	const bool isPow2 = (d & (d - 1)) == 0;
+	if (isPow2 && (!isSigned || d != signBit)) {
+		jx_ir_value_t* shiftAmount = jx_ir_constToValue(jx_ir_constGetI8(ctx, (int8_t)jx_bitcount_u64(d - 1)));
+		if (!isSigned) {
+			return jir_peephole_insertInstr(ctx, anchor, jx_ir_instrShr(ctx, val, shiftAmount));
+		}
+
+		jx_ir_value_t* sign = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrShr(ctx, val, jx_ir_constToValue(jx_ir_constGetI8(ctx, (int8_t)(numBits - 1)))));
+		jx_ir_value_t* bias = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrAnd(ctx, sign, jx_ir_constToValue(jx_ir_constGetInteger(ctx, type->m_Kind, (int64_t)(d - 1)))));
+		jx_ir_value_t* biased = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrAdd(ctx, val, bias));
+		return jir_peephole_insertInstr(ctx, anchor, jx_ir_instrShr(ctx, biased, shiftAmount));
+	}
+
+	// NOTE: 8/16-bit divisions are rare because of integer promotion. Leave them alone.
+	if (numBits != 32 && numBits != 64) {
+		return NULL;
+	}
+
+	if (!isSigned) {
+		uint64_t magic = 0;
+		uint32_t shift = 0;
+		bool add = false;
+		jir_divMagicUnsigned(d, numBits, &magic, &shift, &add);
+
+		jx_ir_value_t* magicVal = jx_ir_constToValue(jx_ir_constGetInteger(ctx, type->m_Kind, (int64_t)magic));
+		jx_ir_value_t* t = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrMulHi(ctx, val, magicVal));
+		if (!add) {
+			return shift != 0
+				? jir_peephole_insertInstr(ctx, anchor, jx_ir_instrShr(ctx, t, jx_ir_constToValue(jx_ir_constGetI8(ctx, (int8_t)shift))))
+				: t
+				;
+		}
+
+		JX_CHECK(shift >= 1, "Expected non-zero shift amount when magic number overflows.");
+		jx_ir_value_t* diff = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrSub(ctx, val, t));
+		diff = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrShr(ctx, diff, jx_ir_constToValue(jx_ir_constGetI8(ctx, 1))));
+		jx_ir_value_t* sum = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrAdd(ctx, diff, t));
+		return shift > 1
+			? jir_peephole_insertInstr(ctx, anchor, jx_ir_instrShr(ctx, sum, jx_ir_constToValue(jx_ir_constGetI8(ctx, (int8_t)(shift - 1)))))
+			: sum
+			;
+	}
+
+	// d == -1 is better left to idiv (or a neg) and the minimum signed value isn't
+	// handled by the magic number calculation.
+	if (d == mask || d == signBit) {
+		return NULL;
+	}
+
+	const int64_t sd = divisor->u.m_I64;
+
+	uint64_t magic = 0;
+	uint32_t shift = 0;
+	jir_divMagicSigned(sd, numBits, &magic, &shift);
+
+	const bool isMagicNegative = (magic & signBit) != 0;
+	const int64_t magicI64 = isMagicNegative
+		? (int64_t)(magic | ~mask)
+		: (int64_t)magic
+		;
+
+	jx_ir_value_t* magicVal = jx_ir_constToValue(jx_ir_constGetInteger(ctx, type->m_Kind, magicI64));
+	jx_ir_value_t* t = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrMulHi(ctx, val, magicVal));
+	if (sd > 0 && isMagicNegative) {
+		t = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrAdd(ctx, t, val));
+	} else if (sd < 0 && !isMagicNegative) {
+		t = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrSub(ctx, t, val));
+	}
+
+	if (shift != 0) {
+		t = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrShr(ctx, t, jx_ir_constToValue(jx_ir_constGetI8(ctx, (int8_t)shift))));
+	}
+
+	jx_ir_value_t* sign = jir_peephole_insertInstr(ctx, anchor, jx_ir_instrShr(ctx, t, jx_ir_constToValue(jx_ir_constGetI8(ctx, (int8_t)(numBits - 1)))));
+	return jir_peephole_insertInstr(ctx, anchor, jx_ir_instrSub(ctx, t, sign));
+}
+
+static jx_ir_value_t* jir_peephole_insertInstr(jx_ir_context_t* ctx, jx_ir_instruction_t* anchor, jx_ir_instruction_t* instr)
+{
+	JX_CHECK(instr, "Failed to create instruction");
+	jx_ir_bbInsertInstrBefore(ctx, anchor->m_ParentBB, anchor, instr);
+	return jx_ir_instrToValue(instr);
+}
+
+// Hacker's Delight, 2nd edition, Figure 10-2 (magicu), generalized to numBits.
+// d must not be 0 or a power of 2.
+static void jir_divMagicUnsigned(uint64_t d, uint32_t numBits, uint64_t* magic, uint32_t* shift, bool* add)
+{
+	const uint64_t mask = numBits == 64
+		? ~0ull
+		: ((1ull << numBits) - 1)
+		;
+	const uint64_t signBit = 1ull << (numBits - 1);
+
+	*add = false;
+
+	const uint64_t nc = (mask - ((0 - d) & mask) % d) & mask;
+	uint32_t p = numBits - 1;
+	uint64_t q1 = signBit / nc;
+	uint64_t r1 = (signBit - q1 * nc) & mask;
+	uint64_t q2 = (signBit - 1) / d;
+	uint64_t r2 = ((signBit - 1) - q2 * d) & mask;
+	uint64_t delta = 0;
+	do {
+		++p;
+		if (r1 >= ((nc - r1) & mask)) {
+			q1 = (2 * q1 + 1) & mask;
+			r1 = (2 * r1 - nc) & mask;
+		} else {
+			q1 = (2 * q1) & mask;
+			r1 = (2 * r1) & mask;
+		}
+
+		if (((r2 + 1) & mask) >= ((d - r2) & mask)) {
+			if (q2 >= signBit - 1) {
+				*add = true;
+			}
+			q2 = (2 * q2 + 1) & mask;
+			r2 = (2 * r2 + 1 - d) & mask;
+		} else {
+			if (q2 >= signBit) {
+				*add = true;
+			}
+			q2 = (2 * q2) & mask;
+			r2 = (2 * r2 + 1) & mask;
+		}
+
+		delta = (d - 1 - r2) & mask;
+	} while (p < 2 * numBits && (q1 < delta || (q1 == delta && r1 == 0)));
+
+	*magic = (q2 + 1) & mask;
+	*shift = p - numBits;
+}
+
+// Hacker's Delight, 2nd edition, Figure 10-1 (magic), generalized to numBits.
+// Must have 2 <= |d| < 2^(numBits-1). The magic number is returned as a numBits 
+// wide two's complement value.
+static void jir_divMagicSigned(int64_t d, uint32_t numBits, uint64_t* magic, uint32_t* shift)
+{
+	const uint64_t mask = numBits == 64
+		? ~0ull
+		: ((1ull << numBits) - 1)
+		;
+	const uint64_t signBit = 1ull << (numBits - 1);
+
+	const uint64_t ud = (uint64_t)d & mask;
+	const uint64_t ad = d < 0
+		? ((0 - ud) & mask)
+		: ud
+		;
+	const uint64_t t = signBit + (ud >> (numBits - 1));
+	const uint64_t anc = t - 1 - t % ad;
+	uint32_t p = numBits - 1;
+	uint64_t q1 = signBit / anc;
+	uint64_t r1 = (signBit - q1 * anc) & mask;
+	uint64_t q2 = signBit / ad;
+	uint64_t r2 = (signBit - q2 * ad) & mask;
+	uint64_t delta = 0;
+	do {
+		++p;
+		q1 = (2 * q1) & mask;
+		r1 = (2 * r1) & mask;
+		if (r1 >= anc) {
+			q1 = (q1 + 1) & mask;
+			r1 = (r1 - anc) & mask;
+		}
+
+		q2 = (2 * q2) & mask;
+		r2 = (2 * r2) & mask;
+		if (r2 >= ad) {
+			q2 = (q2 + 1) & mask;
+			r2 = (r2 - ad) & mask;
+		}
+
+		delta = (ad - r2) & mask;
+	} while (q1 < delta || (q1 == delta && r1 == 0));
+
+	uint64_t m = (q2 + 1) & mask;
+	if (d < 0) {
+		m = (0 - m) & mask;
+	}
+
+	*magic = m;
+	*shift = p - numBits;
+}
+
 static bool jir_peephole_mul(jir_func_pass_peephole_t* pass, jx_ir_instruction_t* instr)
 {
 	jx_ir_context_t* ctx = pass->m_Ctx;
@@ -2757,6 +3211,7 @@ static bool jir_funcPass_canonicalizeOperandsRun(jx_ir_function_pass_o* inst, jx
 			const bool isCommutativeBinaryOp = false
 				|| instr->m_OpCode == JIR_OP_ADD
 				|| instr->m_OpCode == JIR_OP_MUL
+				|| instr->m_OpCode == JIR_OP_MULHI
 				|| instr->m_OpCode == JIR_OP_AND
 				|| instr->m_OpCode == JIR_OP_OR
 				|| instr->m_OpCode == JIR_OP_XOR
@@ -3515,6 +3970,1347 @@ static bool jir_funcPass_removeRedundantPhisRun(jx_ir_function_pass_o* inst, jx_
 	return numRemovals != 0;
 }
 
+//////////////////////////////////////////////////////////////////////////
+// If Conversion
+//
+// Converts small diamonds and triangles, whose side blocks include only
+// instructions which can be safely executed speculatively, into straight-line
+// code by hoisting the side blocks' instructions into the branching block and
+// replacing the join block's phis with select instructions.
+//
+#define JIR_IFCONV_CONFIG_MAX_INSTRS_PER_BLOCK 2
+#define JIR_IFCONV_CONFIG_MAX_PHIS             4
+
+typedef struct jir_func_pass_if_conversion_t
+{
+	jx_allocator_i* m_Allocator;
+	uint32_t m_MaxInstrsPerBlock;
+	uint32_t m_MaxPhis;
+} jir_func_pass_if_conversion_t;
+
+static void jir_funcPass_ifConversionDestroy(jx_ir_function_pass_o* inst, jx_allocator_i* allocator);
+static bool jir_funcPass_ifConversionRun(jx_ir_function_pass_o* inst, jx_ir_context_t* ctx, jx_ir_function_t* func);
+static bool jir_funcPass_ifConversionSetOption(jx_ir_function_pass_o* inst, const char* name, int64_t value);
+static bool jir_ifConv_convertBlock(jir_func_pass_if_conversion_t* pass, jx_ir_context_t* ctx, jx_ir_function_t* func, jx_ir_basic_block_t* bb);
+static jx_ir_basic_block_t* jir_ifConv_getSideBlockSucc(jir_func_pass_if_conversion_t* pass, jx_ir_context_t* ctx, jx_ir_basic_block_t* sideBB, jx_ir_basic_block_t* bb);
+static bool jir_ifConv_isSpeculatable(jx_ir_instruction_t* instr);
+static bool jir_ifConv_canSelect(jx_ir_value_t* cond, jx_ir_value_t* trueVal, jx_ir_value_t* falseVal);
+static void jir_ifConv_hoistInstructions(jx_ir_context_t* ctx, jx_ir_basic_block_t* sideBB, jx_ir_basic_block_t* bb, jx_ir_instruction_t* anchor);
+
+bool jx_ir_funcPassCreate_ifConversion(jx_ir_function_pass_t* pass, jx_allocator_i* allocator)
+{
+	jir_func_pass_if_conversion_t* inst = (jir_func_pass_if_conversion_t*)JX_ALLOC(allocator, sizeof(jir_func_pass_if_conversion_t));
+	if (!inst) {
+		return false;
+	}
+
+	jx_memset(inst, 0, sizeof(jir_func_pass_if_conversion_t));
+	inst->m_Allocator = allocator;
+	inst->m_MaxInstrsPerBlock = JIR_IFCONV_CONFIG_MAX_INSTRS_PER_BLOCK;
+	inst->m_MaxPhis = JIR_IFCONV_CONFIG_MAX_PHIS;
+
+	pass->m_Inst = (jx_ir_function_pass_o*)inst;
+	pass->run = jir_funcPass_ifConversionRun;
+	pass->destroy = jir_funcPass_ifConversionDestroy;
+	pass->setOption = jir_funcPass_ifConversionSetOption;
+
+	return true;
+}
+
+static void jir_funcPass_ifConversionDestroy(jx_ir_function_pass_o* inst, jx_allocator_i* allocator)
+{
+	jir_func_pass_if_conversion_t* pass = (jir_func_pass_if_conversion_t*)inst;
+	JX_FREE(allocator, pass);
+}
+
+static bool jir_funcPass_ifConversionRun(jx_ir_function_pass_o* inst, jx_ir_context_t* ctx, jx_ir_function_t* func)
+{
+	TracyCZoneN(tracyCtx, "ir: If Conversion", 1);
+
+	jir_func_pass_if_conversion_t* pass = (jir_func_pass_if_conversion_t*)inst;
+
+	JX_CHECK(jx_ir_funcCheck(ctx, func), "Func is in invalid state!");
+
+	uint32_t numConversions = 0;
+
+	jx_ir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		// NOTE: Converting a block only removes blocks which are its successors 
+		// and have no other predecessors, so it's safe to continue from the same block.
+		if (jir_ifConv_convertBlock(pass, ctx, func, bb)) {
+			++numConversions;
+			continue;
+		}
+
+		bb = bb->m_Next;
+	}
+
+	TracyCZoneEnd(tracyCtx);
+
+	return numConversions != 0;
+}
+
+static bool jir_funcPass_ifConversionSetOption(jx_ir_function_pass_o* inst, const char* name, int64_t value)
+{
+	jir_func_pass_if_conversion_t* pass = (jir_func_pass_if_conversion_t*)inst;
+
+	if (value < 0 || value > UINT32_MAX) {
+		return false;
+	}
+
+	if (!jx_strcmp(name, "maxInstrsPerBlock")) {
+		pass->m_MaxInstrsPerBlock = (uint32_t)value;
+	} else if (!jx_strcmp(name, "maxPhis")) {
+		pass->m_MaxPhis = (uint32_t)value;
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+// bb:
+//   ...
+//   br bool %cond, label %bbTrue, label %bbFalse
+// bbTrue:
+//   <speculatable instructions>
+//   br label %bbJoin
+// bbFalse:
+//   <speculatable instructions>
+//   br label %bbJoin
+// bbJoin:
+//   %res = phi [%valTrue, %bbTrue], [%valFalse, %bbFalse]
+// 
+//  =>
+// 
+// bb:
+//   ...
+//   <speculatable instructions from bbTrue and bbFalse>
+//   %sel = select %cond, %valTrue, %valFalse
+//   br label %bbJoin
+// bbJoin:
+//   %res = phi [%sel, %bb]
+// 
+// Triangles (i.e. one of bbTrue/bbFalse is bbJoin) are handled the same way.
+// 
+static bool jir_ifConv_convertBlock(jir_func_pass_if_conversion_t* pass, jx_ir_context_t* ctx, jx_ir_function_t* func, jx_ir_basic_block_t* bb)
+{
+	jx_ir_instruction_t* termInstr = jx_ir_bbGetLastInstr(ctx, bb);
+	if (!termInstr || !jx_ir_instrIsCondBranch(termInstr)) {
+		return false;
+	}
+
+	jx_ir_value_t* cond = jx_ir_instrGetOperandVal(termInstr, 0);
+	jx_ir_basic_block_t* bbTrue = jx_ir_valueToBasicBlock(jx_ir_instrGetOperandVal(termInstr, 1));
+	jx_ir_basic_block_t* bbFalse = jx_ir_valueToBasicBlock(jx_ir_instrGetOperandVal(termInstr, 2));
+	if (bbTrue == bbFalse || jx_ir_valueToConst(cond)) {
+		return false;
+	}
+
+	jx_ir_basic_block_t* bbTrueSucc = jir_ifConv_getSideBlockSucc(pass, ctx, bbTrue, bb);
+	jx_ir_basic_block_t* bbFalseSucc = jir_ifConv_getSideBlockSucc(pass, ctx, bbFalse, bb);
+
+	jx_ir_basic_block_t* bbJoin = NULL;
+	if (bbTrueSucc && bbFalseSucc && bbTrueSucc == bbFalseSucc) {
+		// Diamond
+		bbJoin = bbTrueSucc;
+	} else if (bbTrueSucc && bbTrueSucc == bbFalse) {
+		// Triangle on the true side
+		bbJoin = bbFalse;
+		bbFalse = NULL;
+	} else if (bbFalseSucc && bbFalseSucc == bbTrue) {
+		// Triangle on the false side
+		bbJoin = bbTrue;
+		bbTrue = NULL;
+	} else {
+		return false;
+	}
+
+	if (bbJoin == bb) {
+		return false;
+	}
+
+	jx_ir_basic_block_t* bbTrueSrc = bbTrue ? bbTrue : bb;
+	jx_ir_basic_block_t* bbFalseSrc = bbFalse ? bbFalse : bb;
+
+	// Make sure all phis can be converted to selects.
+	uint32_t numPhis = 0;
+	jx_ir_instruction_t* phiInstr = bbJoin->m_InstrListHead;
+	while (phiInstr && phiInstr->m_OpCode == JIR_OP_PHI) {
+		jx_ir_value_t* trueVal = jx_ir_instrPhiHasValue(ctx, phiInstr, bbTrueSrc);
+		jx_ir_value_t* falseVal = jx_ir_instrPhiHasValue(ctx, phiInstr, bbFalseSrc);
+		JX_CHECK(trueVal && falseVal, "Phi is missing values from its predecessors!");
+		if (trueVal != falseVal && !jir_ifConv_canSelect(cond, trueVal, falseVal)) {
+			return false;
+		}
+
+		++numPhis;
+		if (numPhis > pass->m_MaxPhis) {
+			return false;
+		}
+
+		phiInstr = phiInstr->m_Next;
+	}
+
+	if (bbTrue) {
+		jir_ifConv_hoistInstructions(ctx, bbTrue, bb, termInstr);
+	}
+	if (bbFalse) {
+		jir_ifConv_hoistInstructions(ctx, bbFalse, bb, termInstr);
+	}
+
+	// If the branch is the only user of the condition, move the condition right 
+	// before the selects so the backend can fuse the comparison with the cmovs.
+	jx_ir_instruction_t* condInstr = jx_ir_valueToInstr(cond);
+	if (condInstr && condInstr->m_ParentBB == bb && condInstr->m_OpCode != JIR_OP_PHI) {
+		jx_ir_use_t* condUse = cond->m_UsesListHead;
+		if (condUse && !condUse->m_Next) {
+			jx_ir_bbRemoveInstr(ctx, bb, condInstr);
+			jx_ir_bbInsertInstrBefore(ctx, bb, termInstr, condInstr);
+		}
+	}
+
+	// Replace phi values with selects
+	phiInstr = bbJoin->m_InstrListHead;
+	while (phiInstr && phiInstr->m_OpCode == JIR_OP_PHI) {
+		jx_ir_value_t* trueVal = bbTrue 
+			? jx_ir_instrPhiRemoveValue(ctx, phiInstr, bbTrue) 
+			: jx_ir_instrPhiHasValue(ctx, phiInstr, bb)
+			;
+		jx_ir_value_t* falseVal = bbFalse 
+			? jx_ir_instrPhiRemoveValue(ctx, phiInstr, bbFalse)
+			: jx_ir_instrPhiHasValue(ctx, phiInstr, bb)
+			;
+		if (!bbTrue || !bbFalse) {
+			jx_ir_instrPhiRemoveValue(ctx, phiInstr, bb);
+		}
+
+		jx_ir_value_t* newVal = trueVal;
+		if (trueVal != falseVal) {
+			jx_ir_instruction_t* selectInstr = jx_ir_instrSelect(ctx, cond, trueVal, falseVal);
+			jx_ir_bbInsertInstrBefore(ctx, bb, termInstr, selectInstr);
+			newVal = jx_ir_instrToValue(selectInstr);
+		}
+
+		jx_ir_instrPhiAddValue(ctx, phiInstr, bb, newVal);
+
+		phiInstr = phiInstr->m_Next;
+	}
+
+	// Replace the conditional branch with an unconditional branch to the join block.
+	jx_ir_bbRemoveInstr(ctx, bb, termInstr);
+	jx_ir_instrFree(ctx, termInstr);
+	jx_ir_bbAppendInstr(ctx, bb, jx_ir_instrBranch(ctx, bbJoin));
+
+	// Remove side blocks in order to update the CFG
+	if (bbTrue) {
+		JX_CHECK(!bbTrue->super.m_UsesListHead, "Side block still in use!");
+		jx_ir_funcRemoveBasicBlock(ctx, func, bbTrue);
+		jx_ir_bbFree(ctx, bbTrue);
+	}
+	if (bbFalse) {
+		JX_CHECK(!bbFalse->super.m_UsesListHead, "Side block still in use!");
+		jx_ir_funcRemoveBasicBlock(ctx, func, bbFalse);
+		jx_ir_bbFree(ctx, bbFalse);
+	}
+
+	return true;
+}
+
+// Returns the single successor of the side block if the side block can be 
+// speculatively executed as part of bb, or NULL otherwise.
+static jx_ir_basic_block_t* jir_ifConv_getSideBlockSucc(jir_func_pass_if_conversion_t* pass, jx_ir_context_t* ctx, jx_ir_basic_block_t* sideBB, jx_ir_basic_block_t* bb)
+{
+	if (sideBB == bb || jx_array_sizeu(sideBB->m_PredArr) != 1 || sideBB->m_PredArr[0] != bb) {
+		return NULL;
+	}
+
+	jx_ir_instruction_t* termInstr = jx_ir_bbGetLastInstr(ctx, sideBB);
+	if (!termInstr || !jx_ir_instrIsUncondBranch(termInstr)) {
+		return NULL;
+	}
+
+	uint32_t numInstrs = 0;
+	jx_ir_instruction_t* instr = sideBB->m_InstrListHead;
+	while (instr != termInstr) {
+		if (!jir_ifConv_isSpeculatable(instr)) {
+			return NULL;
+		}
+
+		++numInstrs;
+		if (numInstrs > pass->m_MaxInstrsPerBlock) {
+			return NULL;
+		}
+
+		instr = instr->m_Next;
+	}
+
+	return jx_ir_valueToBasicBlock(jx_ir_instrGetOperandVal(termInstr, 0));
+}
+
+// NOTE: Divisions/remainders can trap and memory accesses might be invalid 
+// on the path not taken so they are never executed speculatively.
+static bool jir_ifConv_isSpeculatable(jx_ir_instruction_t* instr)
+{
+	switch (instr->m_OpCode) {
+	case JIR_OP_ADD:
+	case JIR_OP_SUB:
+	case JIR_OP_MUL:
+	case JIR_OP_AND:
+	case JIR_OP_OR:
+	case JIR_OP_XOR:
+	case JIR_OP_SHL:
+	case JIR_OP_SHR:
+	case JIR_OP_SET_LE:
+	case JIR_OP_SET_GE:
+	case JIR_OP_SET_LT:
+	case JIR_OP_SET_GT:
+	case JIR_OP_SET_EQ:
+	case JIR_OP_SET_NE:
+	case JIR_OP_GET_ELEMENT_PTR:
+	case JIR_OP_TRUNC:
+	case JIR_OP_ZEXT:
+	case JIR_OP_SEXT:
+	case JIR_OP_PTR_TO_INT:
+	case JIR_OP_INT_TO_PTR:
+	case JIR_OP_BITCAST:
+	case JIR_OP_FPEXT:
+	case JIR_OP_FPTRUNC:
+	case JIR_OP_SELECT:
+	case JIR_OP_ROL:
+	case JIR_OP_ROR:
+	case JIR_OP_BSWAP:
+	case JIR_OP_POPCNT:
+	case JIR_OP_CTLZ:
+	case JIR_OP_CTTZ:
+	case JIR_OP_MULHI:
+		return true;
+	default:
+		break;
+	}
+
+	return false;
+}
+
+// Integer and pointer selects are lowered to cmovs. Boolean phis are left 
+// alone because the peephole pass handles them better. Floating point selects
+// are only allowed when they match one of the min/max patterns (SSE minss/maxss
+// semantics).
+static bool jir_ifConv_canSelect(jx_ir_value_t* cond, jx_ir_value_t* trueVal, jx_ir_value_t* falseVal)
+{
+	jx_ir_type_t* type = trueVal->m_Type;
+	if (type->m_Kind == JIR_TYPE_BOOL) {
+		return false;
+	} else if (jx_ir_typeIsInteger(type) || type->m_Kind == JIR_TYPE_POINTER) {
+		return true;
+	} else if (jx_ir_typeIsFloatingPoint(type)) {
+		jx_ir_instruction_t* cmpInstr = jx_ir_valueToInstr(cond);
+		if (!cmpInstr || (cmpInstr->m_OpCode != JIR_OP_SET_LT && cmpInstr->m_OpCode != JIR_OP_SET_GT)) {
+			return false;
+		}
+
+		jx_ir_value_t* cmpLhs = jx_ir_instrGetOperandVal(cmpInstr, 0);
+		jx_ir_value_t* cmpRhs = jx_ir_instrGetOperandVal(cmpInstr, 1);
+		return false
+			|| (trueVal == cmpLhs && falseVal == cmpRhs)
+			|| (trueVal == cmpRhs && falseVal == cmpLhs)
+			;
+	}
+
+	return false;
+}
+
+static void jir_ifConv_hoistInstructions(jx_ir_context_t* ctx, jx_ir_basic_block_t* sideBB, jx_ir_basic_block_t* bb, jx_ir_instruction_t* anchor)
+{
+	jx_ir_instruction_t* termInstr = jx_ir_bbGetLastInstr(ctx, sideBB);
+	jx_ir_instruction_t* instr = sideBB->m_InstrListHead;
+	while (instr != termInstr) {
+		jx_ir_instruction_t* instrNext = instr->m_Next;
+
+		jx_ir_bbRemoveInstr(ctx, sideBB, instr);
+		jx_ir_bbInsertInstrBefore(ctx, bb, anchor, instr);
+
+		instr = instrNext;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Bit Manipulation Idioms
+//
+// Lowers calls to bit manipulation builtins/intrinsics (popcount, clz, ctz, 
+// bswap, rotates and bit scans) to the corresponding IR instructions and 
+// recognizes rotate and byte swap idioms written with shifts, ands and ors.
+//
+#define JIR_BITIDIOMS_CONFIG_MAX_DEPTH 16
+
+#define JIR_BITIDIOMS_BYTE_ZERO        0xFE
+
+typedef enum jir_bit_intrinsic_kind
+{
+	JIR_BIT_INTRINSIC_UNARY = 0,
+	JIR_BIT_INTRINSIC_ROTATE,
+	JIR_BIT_INTRINSIC_BIT_SCAN_FORWARD,
+	JIR_BIT_INTRINSIC_BIT_SCAN_REVERSE,
+} jir_bit_intrinsic_kind;
+
+typedef struct jir_bit_intrinsic_t
+{
+	const char* m_Name;
+	jir_bit_intrinsic_kind m_Kind;
+	uint32_t m_OpCode;
+} jir_bit_intrinsic_t;
+
+static const jir_bit_intrinsic_t kBitIntrinsics[] = {
+	{ "__builtin_popcount",   JIR_BIT_INTRINSIC_UNARY,             JIR_OP_POPCNT },
+	{ "__builtin_popcountl",  JIR_BIT_INTRINSIC_UNARY,             JIR_OP_POPCNT },
+	{ "__builtin_popcountll", JIR_BIT_INTRINSIC_UNARY,             JIR_OP_POPCNT },
+	{ "__popcnt16",           JIR_BIT_INTRINSIC_UNARY,             JIR_OP_POPCNT },
+	{ "__popcnt",             JIR_BIT_INTRINSIC_UNARY,             JIR_OP_POPCNT },
+	{ "__popcnt64",           JIR_BIT_INTRINSIC_UNARY,             JIR_OP_POPCNT },
+	{ "__builtin_clz",        JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTLZ },
+	{ "__builtin_clzl",       JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTLZ },
+	{ "__builtin_clzll",      JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTLZ },
+	{ "__lzcnt16",            JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTLZ },
+	{ "__lzcnt",              JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTLZ },
+	{ "__lzcnt64",            JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTLZ },
+	{ "__builtin_ctz",        JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTTZ },
+	{ "__builtin_ctzl",       JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTTZ },
+	{ "__builtin_ctzll",      JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTTZ },
+	{ "_tzcnt_u32",           JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTTZ },
+	{ "_tzcnt_u64",           JIR_BIT_INTRINSIC_UNARY,             JIR_OP_CTTZ },
+	{ "__builtin_bswap16",    JIR_BIT_INTRINSIC_UNARY,             JIR_OP_BSWAP },
+	{ "__builtin_bswap32",    JIR_BIT_INTRINSIC_UNARY,             JIR_OP_BSWAP },
+	{ "__builtin_bswap64",    JIR_BIT_INTRINSIC_UNARY,             JIR_OP_BSWAP },
+	{ "_byteswap_ushort",     JIR_BIT_INTRINSIC_UNARY,             JIR_OP_BSWAP },
+	{ "_byteswap_ulong",      JIR_BIT_INTRINSIC_UNARY,             JIR_OP_BSWAP },
+	{ "_byteswap_uint64",     JIR_BIT_INTRINSIC_UNARY,             JIR_OP_BSWAP },
+	{ "_rotl8",               JIR_BIT_INTRINSIC_ROTATE,            JIR_OP_ROL },
+	{ "_rotl16",              JIR_BIT_INTRINSIC_ROTATE,            JIR_OP_ROL },
+	{ "_rotl",                JIR_BIT_INTRINSIC_ROTATE,            JIR_OP_ROL },
+	{ "_lrotl",               JIR_BIT_INTRINSIC_ROTATE,            JIR_OP_ROL },
+	{ "_rotl64",              JIR_BIT_INTRINSIC_ROTATE,            JIR_OP_ROL },
+	{ "_rotr8",               JIR_BIT_INTRINSIC_ROTATE,            JIR_OP_ROR },
+	{ "_rotr16",              JIR_BIT_INTRINSIC_ROTATE,            JIR_OP_ROR },
+	{ "_rotr",                JIR_BIT_INTRINSIC_ROTATE,            JIR_OP_ROR },
+	{ "_lrotr",               JIR_BIT_INTRINSIC_ROTATE,            JIR_OP_ROR },
+	{ "_rotr64",              JIR_BIT_INTRINSIC_ROTATE,            JIR_OP_ROR },
+	{ "_BitScanForward",      JIR_BIT_INTRINSIC_BIT_SCAN_FORWARD,  JIR_OP_CTTZ },
+	{ "_BitScanForward64",    JIR_BIT_INTRINSIC_BIT_SCAN_FORWARD,  JIR_OP_CTTZ },
+	{ "_BitScanReverse",      JIR_BIT_INTRINSIC_BIT_SCAN_REVERSE,  JIR_OP_CTLZ },
+	{ "_BitScanReverse64",    JIR_BIT_INTRINSIC_BIT_SCAN_REVERSE,  JIR_OP_CTLZ },
+};
+
+// For each byte of a value, the index of the byte of m_Src which ends up 
+// in it or JIR_BITIDIOMS_BYTE_ZERO if the byte is known to be 0.
+typedef struct jir_byte_providers_t
+{
+	jx_ir_value_t* m_Src;
+	uint8_t m_Bytes[8];
+} jir_byte_providers_t;
+
+typedef struct jir_func_pass_bit_idioms_t
+{
+	jx_allocator_i* m_Allocator;
+} jir_func_pass_bit_idioms_t;
+
+static void jir_funcPass_bitIdiomsDestroy(jx_ir_function_pass_o* inst, jx_allocator_i* allocator);
+static bool jir_funcPass_bitIdiomsRun(jx_ir_function_pass_o* inst, jx_ir_context_t* ctx, jx_ir_function_t* func);
+static jx_ir_value_t* jir_bitIdioms_lowerIntrinsicCall(jx_ir_context_t* ctx, jx_ir_instruction_t* callInstr);
+static jx_ir_value_t* jir_bitIdioms_matchRotate(jx_ir_context_t* ctx, jx_ir_instruction_t* orInstr);
+static jx_ir_value_t* jir_bitIdioms_matchByteSwap(jx_ir_context_t* ctx, jx_ir_instruction_t* instr);
+static bool jir_bitIdioms_getByteProviders(jx_ir_value_t* val, jir_byte_providers_t* res, uint32_t depth);
+static bool jir_bitIdioms_isNegatedShiftAmount(jx_ir_value_t* shiftAmount, jx_ir_value_t* val, uint32_t width);
+static jx_ir_value_t* jir_bitIdioms_insertInstr(jx_ir_context_t* ctx, jx_ir_instruction_t* anchor, jx_ir_instruction_t* instr);
+static jx_ir_value_t* jir_bitIdioms_convert(jx_ir_context_t* ctx, jx_ir_instruction_t* anchor, jx_ir_value_t* val, jx_ir_type_t* targetType);
+
+bool jx_ir_funcPassCreate_bitIdioms(jx_ir_function_pass_t* pass, jx_allocator_i* allocator)
+{
+	jir_func_pass_bit_idioms_t* inst = (jir_func_pass_bit_idioms_t*)JX_ALLOC(allocator, sizeof(jir_func_pass_bit_idioms_t));
+	if (!inst) {
+		return false;
+	}
+
+	jx_memset(inst, 0, sizeof(jir_func_pass_bit_idioms_t));
+	inst->m_Allocator = allocator;
+
+	pass->m_Inst = (jx_ir_function_pass_o*)inst;
+	pass->run = jir_funcPass_bitIdiomsRun;
+	pass->destroy = jir_funcPass_bitIdiomsDestroy;
+
+	return true;
+}
+
+static void jir_funcPass_bitIdiomsDestroy(jx_ir_function_pass_o* inst, jx_allocator_i* allocator)
+{
+	jir_func_pass_bit_idioms_t* pass = (jir_func_pass_bit_idioms_t*)inst;
+	JX_FREE(allocator, pass);
+}
+
+static bool jir_funcPass_bitIdiomsRun(jx_ir_function_pass_o* inst, jx_ir_context_t* ctx, jx_ir_function_t* func)
+{
+	TracyCZoneN(tracyCtx, "ir: Bit Idioms", 1);
+
+	uint32_t numReplacements = 0;
+
+	jx_ir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		jx_ir_instruction_t* instr = bb->m_InstrListHead;
+		while (instr) {
+			jx_ir_instruction_t* instrNext = instr->m_Next;
+
+			// NOTE: Values which have already been replaced are left for DCE. Skip them
+			// in order to avoid matching the same idiom again.
+			const bool isDead = true
+				&& instr->m_OpCode != JIR_OP_CALL
+				&& !jx_ir_instrToValue(instr)->m_UsesListHead
+				;
+
+			jx_ir_value_t* newVal = NULL;
+			if (!isDead) {
+				switch (instr->m_OpCode) {
+				case JIR_OP_CALL: {
+					newVal = jir_bitIdioms_lowerIntrinsicCall(ctx, instr);
+				} break;
+				case JIR_OP_OR: {
+					newVal = jir_bitIdioms_matchRotate(ctx, instr);
+					if (!newVal) {
+						newVal = jir_bitIdioms_matchByteSwap(ctx, instr);
+					}
+				} break;
+				case JIR_OP_TRUNC: {
+					newVal = jir_bitIdioms_matchByteSwap(ctx, instr);
+				} break;
+				default:
+					break;
+				}
+			}
+
+			if (newVal) {
+				jx_ir_valueReplaceAllUsesWith(ctx, jx_ir_instrToValue(instr), newVal);
+
+				// NOTE: Calls aren't removed by DCE. Dead shifts/ands/ors are left for DCE.
+				if (instr->m_OpCode == JIR_OP_CALL) {
+					jx_ir_bbRemoveInstr(ctx, bb, instr);
+					jx_ir_instrFree(ctx, instr);
+				}
+
+				++numReplacements;
+			}
+
+			instr = instrNext;
+		}
+
+		bb = bb->m_Next;
+	}
+
+	TracyCZoneEnd(tracyCtx);
+
+	return numReplacements != 0;
+}
+
+static jx_ir_value_t* jir_bitIdioms_lowerIntrinsicCall(jx_ir_context_t* ctx, jx_ir_instruction_t* callInstr)
+{
+	jx_ir_function_t* calleeFunc = jx_ir_valueToFunc(jx_ir_instrGetOperandVal(callInstr, 0));
+	if (!calleeFunc || calleeFunc->m_BasicBlockListHead) {
+		return NULL;
+	}
+
+	const char* calleeName = jx_ir_funcToValue(calleeFunc)->m_Name;
+	const jir_bit_intrinsic_t* intrinsic = NULL;
+	const uint32_t numIntrinsics = JX_COUNTOF(kBitIntrinsics);
+	for (uint32_t iIntrinsic = 0; iIntrinsic < numIntrinsics; ++iIntrinsic) {
+		if (!jx_strcmp(calleeName, kBitIntrinsics[iIntrinsic].m_Name)) {
+			intrinsic = &kBitIntrinsics[iIntrinsic];
+			break;
+		}
+	}
+
+	if (!intrinsic) {
+		return NULL;
+	}
+
+	const uint32_t numArgs = jx_array_sizeu(callInstr->super.m_OperandArr) - 1;
+	jx_ir_type_t* retType = jx_ir_instrToValue(callInstr)->m_Type;
+
+	jx_ir_value_t* res = NULL;
+	switch (intrinsic->m_Kind) {
+	case JIR_BIT_INTRINSIC_UNARY: {
+		jx_ir_value_t* val = numArgs == 1 ? jx_ir_instrGetOperandVal(callInstr, 1) : NULL;
+		if (!val || !jx_ir_typeIsInteger(val->m_Type)) {
+			return NULL;
+		}
+
+		jx_ir_instruction_t* instr = NULL;
+		switch (intrinsic->m_OpCode) {
+		case JIR_OP_POPCNT: {
+			instr = jx_ir_instrPopCnt(ctx, val);
+		} break;
+		case JIR_OP_CTLZ: {
+			instr = jx_ir_instrCtlz(ctx, val);
+		} break;
+		case JIR_OP_CTTZ: {
+			instr = jx_ir_instrCttz(ctx, val);
+		} break;
+		case JIR_OP_BSWAP: {
+			instr = jx_ir_typeGetSize(val->m_Type) >= 2
+				? jx_ir_instrBSwap(ctx, val)
+				: NULL
+				;
+		} break;
+		default:
+			JX_CHECK(false, "Unknown bit intrinsic opcode");
+			break;
+		}
+
+		res = jir_bitIdioms_insertInstr(ctx, callInstr, instr);
+		res = res ? jir_bitIdioms_convert(ctx, callInstr, res, retType) : NULL;
+	} break;
+	case JIR_BIT_INTRINSIC_ROTATE: {
+		jx_ir_value_t* val = numArgs == 2 ? jx_ir_instrGetOperandVal(callInstr, 1) : NULL;
+		jx_ir_value_t* shiftAmount = numArgs == 2 ? jx_ir_instrGetOperandVal(callInstr, 2) : NULL;
+		if (!val || !jx_ir_typeIsInteger(val->m_Type) || !jx_ir_typeIsInteger(shiftAmount->m_Type)) {
+			return NULL;
+		}
+
+		res = jir_bitIdioms_insertInstr(ctx, callInstr, intrinsic->m_OpCode == JIR_OP_ROL
+			? jx_ir_instrRol(ctx, val, shiftAmount)
+			: jx_ir_instrRor(ctx, val, shiftAmount));
+		res = res ? jir_bitIdioms_convert(ctx, callInstr, res, retType) : NULL;
+	} break;
+	case JIR_BIT_INTRINSIC_BIT_SCAN_FORWARD:
+	case JIR_BIT_INTRINSIC_BIT_SCAN_REVERSE: {
+		// unsigned char _BitScanForward(unsigned long* index, unsigned long mask)
+		// => 
+		// store cttz(mask), index
+		// ret zext(setne mask, 0)
+		// 
+		// _BitScanReverse stores (width - 1) - ctlz(mask) instead.
+		// 
+		// NOTE: *index is undefined when mask is 0 so it's always stored.
+		jx_ir_value_t* indexPtr = numArgs == 2 ? jx_ir_instrGetOperandVal(callInstr, 1) : NULL;
+		jx_ir_value_t* mask = numArgs == 2 ? jx_ir_instrGetOperandVal(callInstr, 2) : NULL;
+		if (!indexPtr || indexPtr->m_Type->m_Kind != JIR_TYPE_POINTER || !jx_ir_typeIsInteger(mask->m_Type)) {
+			return NULL;
+		}
+
+		jx_ir_type_t* indexType = jx_ir_typeToPointer(indexPtr->m_Type)->m_BaseType;
+		if (!jx_ir_typeIsInteger(indexType) || !jx_ir_typeIsInteger(retType)) {
+			return NULL;
+		}
+
+		jx_ir_value_t* index = NULL;
+		if (intrinsic->m_Kind == JIR_BIT_INTRINSIC_BIT_SCAN_FORWARD) {
+			index = jir_bitIdioms_insertInstr(ctx, callInstr, jx_ir_instrCttz(ctx, mask));
+		} else {
+			jx_ir_value_t* lz = jir_bitIdioms_insertInstr(ctx, callInstr, jx_ir_instrCtlz(ctx, mask));
+			if (lz) {
+				const int64_t width = (int64_t)jx_ir_typeGetSize(mask->m_Type) * 8;
+				jx_ir_value_t* widthMinusOne = jx_ir_constToValue(jx_ir_constGetInteger(ctx, mask->m_Type->m_Kind, width - 1));
+				index = jir_bitIdioms_insertInstr(ctx, callInstr, jx_ir_instrSub(ctx, widthMinusOne, lz));
+			}
+		}
+
+		index = index ? jir_bitIdioms_convert(ctx, callInstr, index, indexType) : NULL;
+		if (!index || !jir_bitIdioms_insertInstr(ctx, callInstr, jx_ir_instrStore(ctx, indexPtr, index))) {
+			return NULL;
+		}
+
+		jx_ir_value_t* nonZero = jir_bitIdioms_insertInstr(ctx, callInstr, jx_ir_instrSetNE(ctx, mask, jx_ir_constToValue(jx_ir_constGetZero(ctx, mask->m_Type))));
+		res = nonZero ? jir_bitIdioms_convert(ctx, callInstr, nonZero, retType) : NULL;
+	} break;
+	default:
+		JX_CHECK(false, "Unknown bit intrinsic kind");
+		break;
+	}
+
+	return res;
+}
+
+// or(shl(x, a), shr(x, b)) with unsigned x of width W and
+// - a + b == W (constants) => rol(x, a)
+// - b == W - a             => rol(x, a)
+// - b == (0 - a) & (W - 1) => rol(x, a)
+// - a == W - b             => ror(x, b)
+// - a == (0 - b) & (W - 1) => ror(x, b)
+static jx_ir_value_t* jir_bitIdioms_matchRotate(jx_ir_context_t* ctx, jx_ir_instruction_t* orInstr)
+{
+	JX_CHECK(orInstr->m_OpCode == JIR_OP_OR, "Expected or instruction");
+
+	jx_ir_type_t* type = jx_ir_instrToValue(orInstr)->m_Type;
+	if (!jx_ir_typeIsUnsigned(type)) {
+		return NULL;
+	}
+
+	jx_ir_instruction_t* shlInstr = jx_ir_valueToInstr(jx_ir_instrGetOperandVal(orInstr, 0));
+	jx_ir_instruction_t* shrInstr = jx_ir_valueToInstr(jx_ir_instrGetOperandVal(orInstr, 1));
+	if (!shlInstr || !shrInstr) {
+		return NULL;
+	}
+
+	if (shlInstr->m_OpCode == JIR_OP_SHR && shrInstr->m_OpCode == JIR_OP_SHL) {
+		jx_ir_instruction_t* tmp = shlInstr;
+		shlInstr = shrInstr;
+		shrInstr = tmp;
+	}
+
+	if (shlInstr->m_OpCode != JIR_OP_SHL || shrInstr->m_OpCode != JIR_OP_SHR) {
+		return NULL;
+	}
+
+	jx_ir_value_t* val = jx_ir_instrGetOperandVal(shlInstr, 0);
+	if (val != jx_ir_instrGetOperandVal(shrInstr, 0) || val->m_Type != type) {
+		return NULL;
+	}
+
+	const uint32_t width = jx_ir_typeGetSize(type) * 8;
+	jx_ir_value_t* shlAmount = jx_ir_instrGetOperandVal(shlInstr, 1);
+	jx_ir_value_t* shrAmount = jx_ir_instrGetOperandVal(shrInstr, 1);
+
+	jx_ir_instruction_t* rotInstr = NULL;
+	jx_ir_constant_t* shlConst = jx_ir_valueToConst(shlAmount);
+	jx_ir_constant_t* shrConst = jx_ir_valueToConst(shrAmount);
+	if (shlConst && shrConst) {
+		const bool isRotate = true
+			&& shlConst->u.m_I64 > 0
+			&& shrConst->u.m_I64 > 0
+			&& shlConst->u.m_I64 + shrConst->u.m_I64 == (int64_t)width
+			;
+		if (isRotate) {
+			rotInstr = jx_ir_instrRol(ctx, val, shlAmount);
+		}
+	} else if (jir_bitIdioms_isNegatedShiftAmount(shrAmount, shlAmount, width)) {
+		rotInstr = jx_ir_instrRol(ctx, val, shlAmount);
+	} else if (jir_bitIdioms_isNegatedShiftAmount(shlAmount, shrAmount, width)) {
+		rotInstr = jx_ir_instrRor(ctx, val, shrAmount);
+	}
+
+	return rotInstr
+		? jir_bitIdioms_insertInstr(ctx, orInstr, rotInstr)
+		: NULL
+		;
+}
+
+// Checks if shiftAmount is (W - val) or ((0 - val) & (W - 1))
+static bool jir_bitIdioms_isNegatedShiftAmount(jx_ir_value_t* shiftAmount, jx_ir_value_t* val, uint32_t width)
+{
+	jx_ir_instruction_t* instr = jx_ir_valueToInstr(shiftAmount);
+	if (!instr) {
+		return false;
+	}
+
+	if (instr->m_OpCode == JIR_OP_AND) {
+		jx_ir_constant_t* mask = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 1));
+		if (!mask || mask->u.m_I64 != (int64_t)(width - 1)) {
+			return false;
+		}
+
+		jx_ir_instruction_t* subInstr = jx_ir_valueToInstr(jx_ir_instrGetOperandVal(instr, 0));
+		if (!subInstr || subInstr->m_OpCode != JIR_OP_SUB || jx_ir_instrGetOperandVal(subInstr, 1) != val) {
+			return false;
+		}
+
+		jx_ir_constant_t* lhs = jx_ir_valueToConst(jx_ir_instrGetOperandVal(subInstr, 0));
+		return lhs && (lhs->u.m_I64 == 0 || lhs->u.m_I64 == (int64_t)width);
+	} else if (instr->m_OpCode == JIR_OP_SUB) {
+		jx_ir_constant_t* lhs = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 0));
+		return true
+			&& lhs
+			&& lhs->u.m_I64 == (int64_t)width
+			&& jx_ir_instrGetOperandVal(instr, 1) == val
+			;
+	}
+
+	return false;
+}
+
+// Tracks where each byte of the value comes from and checks if the bytes of a
+// single source value of the same size end up in reverse order, e.g.
+// (x >> 24) | ((x >> 8) & 0xFF00) | ((x << 8) & 0xFF0000) | (x << 24) => bswap(x)
+static jx_ir_value_t* jir_bitIdioms_matchByteSwap(jx_ir_context_t* ctx, jx_ir_instruction_t* instr)
+{
+	jx_ir_value_t* instrVal = jx_ir_instrToValue(instr);
+	if (!jx_ir_typeIsInteger(instrVal->m_Type)) {
+		return NULL;
+	}
+
+	const uint32_t size = jx_ir_typeGetSize(instrVal->m_Type);
+	if (size != 2 && size != 4 && size != 8) {
+		return NULL;
+	}
+
+	jir_byte_providers_t providers;
+	if (!jir_bitIdioms_getByteProviders(instrVal, &providers, 0)) {
+		return NULL;
+	}
+
+	jx_ir_value_t* src = providers.m_Src;
+	if (!src || src == instrVal || jx_ir_typeGetSize(src->m_Type) != size) {
+		return NULL;
+	}
+
+	for (uint32_t iByte = 0; iByte < size; ++iByte) {
+		if (providers.m_Bytes[iByte] != size - 1 - iByte) {
+			return NULL;
+		}
+	}
+
+	jx_ir_value_t* res = jir_bitIdioms_insertInstr(ctx, instr, jx_ir_instrBSwap(ctx, src));
+	return res
+		? jir_bitIdioms_convert(ctx, instr, res, instrVal->m_Type)
+		: NULL
+		;
+}
+
+static bool jir_bitIdioms_getByteProviders(jx_ir_value_t* val, jir_byte_providers_t* res, uint32_t depth)
+{
+	const uint32_t size = jx_ir_typeGetSize(val->m_Type);
+	if (size > 8) {
+		return false;
+	}
+
+	jx_ir_instruction_t* instr = jx_ir_valueToInstr(val);
+
+	bool isLeaf = false
+		|| !instr
+		|| depth >= JIR_BITIDIOMS_CONFIG_MAX_DEPTH
+		|| !jx_ir_typeIsInteger(val->m_Type)
+		;
+	if (!isLeaf) {
+		switch (instr->m_OpCode) {
+		case JIR_OP_OR: {
+			jir_byte_providers_t lhs, rhs;
+			if (!jir_bitIdioms_getByteProviders(jx_ir_instrGetOperandVal(instr, 0), &lhs, depth + 1)) {
+				return false;
+			}
+			if (!jir_bitIdioms_getByteProviders(jx_ir_instrGetOperandVal(instr, 1), &rhs, depth + 1)) {
+				return false;
+			}
+
+			res->m_Src = NULL;
+			for (uint32_t iByte = 0; iByte < size; ++iByte) {
+				jir_byte_providers_t* provider = NULL;
+				if (lhs.m_Bytes[iByte] == JIR_BITIDIOMS_BYTE_ZERO) {
+					provider = &rhs;
+				} else if (rhs.m_Bytes[iByte] == JIR_BITIDIOMS_BYTE_ZERO) {
+					provider = &lhs;
+				} else {
+					return false;
+				}
+
+				res->m_Bytes[iByte] = provider->m_Bytes[iByte];
+				if (provider->m_Bytes[iByte] != JIR_BITIDIOMS_BYTE_ZERO) {
+					if (res->m_Src && res->m_Src != provider->m_Src) {
+						return false;
+					}
+					res->m_Src = provider->m_Src;
+				}
+			}
+
+			return true;
+		} break;
+		case JIR_OP_AND: {
+			jx_ir_constant_t* mask = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 1));
+			if (!mask) {
+				isLeaf = true;
+				break;
+			}
+
+			if (!jir_bitIdioms_getByteProviders(jx_ir_instrGetOperandVal(instr, 0), res, depth + 1)) {
+				return false;
+			}
+
+			for (uint32_t iByte = 0; iByte < size; ++iByte) {
+				const uint8_t maskByte = (uint8_t)((mask->u.m_U64 >> (iByte * 8)) & 0xFF);
+				if (maskByte == 0x00) {
+					res->m_Bytes[iByte] = JIR_BITIDIOMS_BYTE_ZERO;
+				} else if (maskByte != 0xFF) {
+					return false;
+				}
+			}
+
+			return true;
+		} break;
+		case JIR_OP_SHL:
+		case JIR_OP_SHR: {
+			jx_ir_constant_t* shiftAmount = jx_ir_valueToConst(jx_ir_instrGetOperandVal(instr, 1));
+			if (!shiftAmount || (shiftAmount->u.m_I64 & 7) != 0 || shiftAmount->u.m_I64 <= 0 || shiftAmount->u.m_I64 >= (int64_t)size * 8) {
+				isLeaf = true;
+				break;
+			}
+
+			jir_byte_providers_t op;
+			if (!jir_bitIdioms_getByteProviders(jx_ir_instrGetOperandVal(instr, 0), &op, depth + 1)) {
+				return false;
+			}
+
+			// NOTE: Arithmetic shift right is fine as long as the sign byte is known to be 0.
+			if (instr->m_OpCode == JIR_OP_SHR && jx_ir_typeIsSigned(val->m_Type) && op.m_Bytes[size - 1] != JIR_BITIDIOMS_BYTE_ZERO) {
+				return false;
+			}
+
+			const uint32_t numBytes = (uint32_t)(shiftAmount->u.m_I64 / 8);
+			res->m_Src = op.m_Src;
+			for (uint32_t iByte = 0; iByte < size; ++iByte) {
+				if (instr->m_OpCode == JIR_OP_SHL) {
+					res->m_Bytes[iByte] = iByte >= numBytes
+						? op.m_Bytes[iByte - numBytes]
+						: JIR_BITIDIOMS_BYTE_ZERO
+						;
+				} else {
+					res->m_Bytes[iByte] = iByte + numBytes < size
+						? op.m_Bytes[iByte + numBytes]
+						: JIR_BITIDIOMS_BYTE_ZERO
+						;
+				}
+			}
+
+			return true;
+		} break;
+		case JIR_OP_ZEXT:
+		case JIR_OP_TRUNC:
+		case JIR_OP_BITCAST: {
+			jx_ir_value_t* operand = jx_ir_instrGetOperandVal(instr, 0);
+			if (!jx_ir_typeIsInteger(operand->m_Type)) {
+				isLeaf = true;
+				break;
+			}
+
+			jir_byte_providers_t op;
+			if (!jir_bitIdioms_getByteProviders(operand, &op, depth + 1)) {
+				return false;
+			}
+
+			const uint32_t operandSize = jx_ir_typeGetSize(operand->m_Type);
+			res->m_Src = op.m_Src;
+			for (uint32_t iByte = 0; iByte < size; ++iByte) {
+				res->m_Bytes[iByte] = iByte < operandSize
+					? op.m_Bytes[iByte]
+					: JIR_BITIDIOMS_BYTE_ZERO
+					;
+			}
+
+			return true;
+		} break;
+		default: {
+			isLeaf = true;
+		} break;
+		}
+	}
+
+	JX_CHECK(isLeaf, "Expected leaf value");
+	res->m_Src = val;
+	for (uint32_t iByte = 0; iByte < size; ++iByte) {
+		res->m_Bytes[iByte] = (uint8_t)iByte;
+	}
+
+	return true;
+}
+
+static jx_ir_value_t* jir_bitIdioms_insertInstr(jx_ir_context_t* ctx, jx_ir_instruction_t* anchor, jx_ir_instruction_t* instr)
+{
+	if (!instr) {
+		return NULL;
+	}
+
+	jx_ir_bbInsertInstrBefore(ctx, anchor->m_ParentBB, anchor, instr);
+
+	return jx_ir_instrToValue(instr);
+}
+
+static jx_ir_value_t* jir_bitIdioms_convert(jx_ir_context_t* ctx, jx_ir_instruction_t* anchor, jx_ir_value_t* val, jx_ir_type_t* targetType)
+{
+	if (val->m_Type == targetType) {
+		return val;
+	}
+
+	const uint32_t valSize = jx_ir_typeGetSize(val->m_Type);
+	const uint32_t targetSize = jx_ir_typeGetSize(targetType);
+
+	jx_ir_instruction_t* castInstr = NULL;
+	if (valSize == targetSize) {
+		castInstr = jx_ir_instrBitcast(ctx, val, targetType);
+	} else if (valSize > targetSize) {
+		castInstr = jx_ir_instrTrunc(ctx, val, targetType);
+	} else {
+		castInstr = jx_ir_instrZeroExt(ctx, val, targetType);
+	}
+
+	return jir_bitIdioms_insertInstr(ctx, anchor, castInstr);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Tail Calls
+//
+// Finds calls in tail position, i.e. calls which are immediately followed by 
+// a ret of their result (or by a ret void) and:
+// - converts self-recursive tail calls into loops by jumping back to the top
+//   of the function with the call's arguments as the new argument values.
+// - marks all other direct tail calls with JIR_VALUE_FLAGS_TAIL_CALL so the 
+//   backend can tear down the frame and jump to the callee.
+// 
+// Calls which jump to the (single) return block are also considered, by 
+// duplicating the ret into the calling block:
+// 
+// bb:
+//   %res = call %func, ...
+//   br label %exit
+// exit:
+//   %ret = phi [%res, %bb], ...
+//   ret %ret
+// 
+//  =>
+// 
+// bb:
+//   %res = call %func, ...
+//   ret %res
+// 
+// Nothing is done if the function is variadic or if the address of any of its 
+// allocas might escape (e.g. passed to a call or stored to memory) because the 
+// callee might then access the caller's stack frame which no longer exists.
+//
+typedef struct jir_func_pass_tail_calls_t
+{
+	jx_allocator_i* m_Allocator;
+	jx_ir_instruction_t** m_SelfCallArr;
+	jx_ir_instruction_t** m_ArgPhiArr;
+} jir_func_pass_tail_calls_t;
+
+static void jir_funcPass_tailCallsDestroy(jx_ir_function_pass_o* inst, jx_allocator_i* allocator);
+static bool jir_funcPass_tailCallsRun(jx_ir_function_pass_o* inst, jx_ir_context_t* ctx, jx_ir_function_t* func);
+static jx_ir_instruction_t* jir_tailCalls_getTailCall(jx_ir_context_t* ctx, jx_ir_basic_block_t* bb);
+static bool jir_tailCalls_isCandidate(jx_ir_function_t* func, jx_ir_instruction_t* callInstr);
+static void jir_tailCalls_duplicateRet(jx_ir_context_t* ctx, jx_ir_basic_block_t* bb);
+static bool jir_tailCalls_ptrMightEscape(jx_ir_value_t* ptr);
+static void jir_tailCalls_convertToLoop(jir_func_pass_tail_calls_t* pass, jx_ir_context_t* ctx, jx_ir_function_t* func);
+
+bool jx_ir_funcPassCreate_tailCalls(jx_ir_function_pass_t* pass, jx_allocator_i* allocator)
+{
+	jir_func_pass_tail_calls_t* inst = (jir_func_pass_tail_calls_t*)JX_ALLOC(allocator, sizeof(jir_func_pass_tail_calls_t));
+	if (!inst) {
+		return false;
+	}
+
+	jx_memset(inst, 0, sizeof(jir_func_pass_tail_calls_t));
+	inst->m_Allocator = allocator;
+
+	inst->m_SelfCallArr = (jx_ir_instruction_t**)jx_array_create(allocator);
+	if (!inst->m_SelfCallArr) {
+		jir_funcPass_tailCallsDestroy((jx_ir_function_pass_o*)inst, allocator);
+		return false;
+	}
+
+	inst->m_ArgPhiArr = (jx_ir_instruction_t**)jx_array_create(allocator);
+	if (!inst->m_ArgPhiArr) {
+		jir_funcPass_tailCallsDestroy((jx_ir_function_pass_o*)inst, allocator);
+		return false;
+	}
+
+	pass->m_Inst = (jx_ir_function_pass_o*)inst;
+	pass->run = jir_funcPass_tailCallsRun;
+	pass->destroy = jir_funcPass_tailCallsDestroy;
+
+	return true;
+}
+
+static void jir_funcPass_tailCallsDestroy(jx_ir_function_pass_o* inst, jx_allocator_i* allocator)
+{
+	jir_func_pass_tail_calls_t* pass = (jir_func_pass_tail_calls_t*)inst;
+	jx_array_free(pass->m_ArgPhiArr);
+	jx_array_free(pass->m_SelfCallArr);
+	JX_FREE(allocator, pass);
+}
+
+static bool jir_funcPass_tailCallsRun(jx_ir_function_pass_o* inst, jx_ir_context_t* ctx, jx_ir_function_t* func)
+{
+	TracyCZoneN(tracyCtx, "ir: Tail Calls", 1);
+
+	jir_func_pass_tail_calls_t* pass = (jir_func_pass_tail_calls_t*)inst;
+
+	jx_ir_type_function_t* funcType = jx_ir_funcGetType(ctx, func);
+	if (funcType->m_IsVarArg) {
+		TracyCZoneEnd(tracyCtx);
+		return false;
+	}
+
+	// Make sure the callee cannot access any of the function's stack objects.
+	{
+		jx_ir_basic_block_t* bb = func->m_BasicBlockListHead;
+		while (bb) {
+			jx_ir_instruction_t* instr = bb->m_InstrListHead;
+			while (instr) {
+				if (instr->m_OpCode == JIR_OP_ALLOCA && jir_tailCalls_ptrMightEscape(jx_ir_instrToValue(instr))) {
+					TracyCZoneEnd(tracyCtx);
+					return false;
+				}
+
+				instr = instr->m_Next;
+			}
+
+			bb = bb->m_Next;
+		}
+	}
+
+	jx_array_resize(pass->m_SelfCallArr, 0);
+
+	uint32_t numTailCalls = 0;
+
+	jx_ir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		jx_ir_instruction_t* callInstr = jir_tailCalls_getTailCall(ctx, bb);
+		if (callInstr && jir_tailCalls_isCandidate(func, callInstr)) {
+			jir_tailCalls_duplicateRet(ctx, bb);
+
+			jx_ir_function_t* callee = jx_ir_valueToFunc(callInstr->super.m_OperandArr[0]->m_Value);
+			if (callee == func) {
+				jx_array_push_back(pass->m_SelfCallArr, callInstr);
+			} else {
+				jx_ir_instrToValue(callInstr)->m_Flags |= JIR_VALUE_FLAGS_TAIL_CALL_Msk;
+			}
+
+			++numTailCalls;
+		}
+
+		bb = bb->m_Next;
+	}
+
+	if (jx_array_sizeu(pass->m_SelfCallArr) != 0) {
+		jir_tailCalls_convertToLoop(pass, ctx, func);
+	}
+
+	TracyCZoneEnd(tracyCtx);
+
+	return numTailCalls != 0;
+}
+
+// Returns the call instruction if the basic block ends with a call followed
+// by a ret of its result, either directly or through an unconditional jump to 
+// a block which includes only the ret (and, optionally, a phi of the returned 
+// value).
+static jx_ir_instruction_t* jir_tailCalls_getTailCall(jx_ir_context_t* ctx, jx_ir_basic_block_t* bb)
+{
+	jx_ir_instruction_t* termInstr = jx_ir_bbGetLastInstr(ctx, bb);
+	jx_ir_instruction_t* callInstr = termInstr->m_Prev;
+	if (!callInstr || callInstr->m_OpCode != JIR_OP_CALL) {
+		return NULL;
+	}
+
+	jx_ir_value_t* callVal = jx_ir_instrToValue(callInstr);
+	if ((callVal->m_Flags & JIR_VALUE_FLAGS_TAIL_CALL_Msk) != 0) {
+		return NULL;
+	}
+
+	if (termInstr->m_OpCode == JIR_OP_RET) {
+		jx_ir_value_t* retVal = jx_array_sizeu(termInstr->super.m_OperandArr) != 0
+			? termInstr->super.m_OperandArr[0]->m_Value
+			: NULL
+			;
+		return (!retVal || retVal == callVal)
+			? callInstr
+			: NULL
+			;
+	}
+
+	if (!jx_ir_instrIsUncondBranch(termInstr)) {
+		return NULL;
+	}
+
+	jx_ir_basic_block_t* exitBB = jx_ir_valueToBasicBlock(termInstr->super.m_OperandArr[0]->m_Value);
+	jx_ir_instruction_t* retInstr = jx_ir_bbGetLastInstr(ctx, exitBB);
+	if (retInstr->m_OpCode != JIR_OP_RET) {
+		return NULL;
+	}
+
+	jx_ir_value_t* retVal = jx_array_sizeu(retInstr->super.m_OperandArr) != 0
+		? retInstr->super.m_OperandArr[0]->m_Value
+		: NULL
+		;
+
+	jx_ir_instruction_t* phiInstr = retInstr->m_Prev;
+	if (!phiInstr) {
+		return (!retVal || retVal == callVal)
+			? callInstr
+			: NULL
+			;
+	}
+
+	jx_ir_value_t* phiVal = jx_ir_instrToValue(phiInstr);
+	const bool isRetPhi = true
+		&& phiInstr->m_OpCode == JIR_OP_PHI
+		&& !phiInstr->m_Prev
+		&& retVal == phiVal
+		&& phiVal->m_UsesListHead == phiVal->m_UsesListTail
+		;
+	if (!isRetPhi) {
+		return NULL;
+	}
+
+	return jx_ir_instrPhiHasValue(ctx, phiInstr, bb) == callVal
+		? callInstr
+		: NULL
+		;
+}
+
+static bool jir_tailCalls_isCandidate(jx_ir_function_t* func, jx_ir_instruction_t* callInstr)
+{
+	jx_ir_function_t* callee = jx_ir_valueToFunc(callInstr->super.m_OperandArr[0]->m_Value);
+	if (!callee) {
+		// TODO: Indirect tail calls. The function pointer must end up in a register 
+		// which isn't restored by the epilogue.
+		return false;
+	}
+
+	if (callee == func) {
+		return true;
+	}
+
+	// NOTE: Win64 ABI: The first 4 arguments are passed in registers. Calls with
+	// stack arguments would have to overwrite the caller's incoming argument area
+	// which might be smaller than what the callee expects.
+	const uint32_t numArgs = (uint32_t)jx_array_sizeu(callInstr->super.m_OperandArr) - 1;
+	return numArgs <= 4;
+}
+
+// Makes sure the ret is in the same basic block as the tail call.
+static void jir_tailCalls_duplicateRet(jx_ir_context_t* ctx, jx_ir_basic_block_t* bb)
+{
+	jx_ir_instruction_t* termInstr = jx_ir_bbGetLastInstr(ctx, bb);
+	if (termInstr->m_OpCode == JIR_OP_RET) {
+		return;
+	}
+
+	jx_ir_instruction_t* callInstr = termInstr->m_Prev;
+	jx_ir_basic_block_t* exitBB = jx_ir_valueToBasicBlock(termInstr->super.m_OperandArr[0]->m_Value);
+	jx_ir_instruction_t* retInstr = jx_ir_bbGetLastInstr(ctx, exitBB);
+
+	const bool retHasValue = jx_array_sizeu(retInstr->super.m_OperandArr) != 0;
+	if (retInstr->m_Prev) {
+		jx_ir_instrPhiRemoveValue(ctx, retInstr->m_Prev, bb);
+	}
+
+	jx_ir_bbRemoveInstr(ctx, bb, termInstr);
+	jx_ir_instrFree(ctx, termInstr);
+	jx_ir_bbAppendInstr(ctx, bb, jx_ir_instrRet(ctx, retHasValue ? jx_ir_instrToValue(callInstr) : NULL));
+}
+
+// Conservatively checks whether the pointer is only used to load from or
+// store to memory.
+static bool jir_tailCalls_ptrMightEscape(jx_ir_value_t* ptr)
+{
+	jx_ir_use_t* use = ptr->m_UsesListHead;
+	while (use) {
+		jx_ir_instruction_t* userInstr = jx_ir_valueToInstr(jx_ir_userToValue(use->m_User));
+		if (!userInstr) {
+			return true;
+		}
+
+		switch (userInstr->m_OpCode) {
+		case JIR_OP_LOAD: {
+			// Loading from the pointer is fine.
+		} break;
+		case JIR_OP_STORE: {
+			// Storing to the pointer is fine. Storing the pointer isn't.
+			if (userInstr->super.m_OperandArr[1]->m_Value == ptr) {
+				return true;
+			}
+		} break;
+		case JIR_OP_GET_ELEMENT_PTR:
+		case JIR_OP_BITCAST: {
+			if (jir_tailCalls_ptrMightEscape(jx_ir_instrToValue(userInstr))) {
+				return true;
+			}
+		} break;
+		default:
+			return true;
+		}
+
+		use = use->m_Next;
+	}
+
+	return false;
+}
+
+// entry:
+//   <allocas>
+//   <code>
+//   %res = call %func, %a, %b
+//   ret %res
+// 
+//  =>
+// 
+// entry.tr:
+//   <allocas>
+//   br label %entry
+// entry:
+//   %arg0 = phi [%0, %entry.tr], [%a, %entry]
+//   %arg1 = phi [%1, %entry.tr], [%b, %entry]
+//   <code with args replaced by phis>
+//   br label %entry
+static void jir_tailCalls_convertToLoop(jir_func_pass_tail_calls_t* pass, jx_ir_context_t* ctx, jx_ir_function_t* func)
+{
+	// NOTE: The entry block doesn't have any predecessors so it doesn't have any phis.
+	jx_ir_basic_block_t* headerBB = func->m_BasicBlockListHead;
+	JX_CHECK(jx_array_sizeu(headerBB->m_PredArr) == 0, "Entry block has predecessors!");
+
+	// Create a new entry block and move all allocas in it.
+	jx_ir_basic_block_t* entryBB = jx_ir_bbAlloc(ctx, "entry.tr");
+	{
+		entryBB->m_ParentFunc = func;
+		entryBB->m_Next = headerBB;
+		headerBB->m_Prev = entryBB;
+		func->m_BasicBlockListHead = entryBB;
+
+		jx_ir_instruction_t* instr = headerBB->m_InstrListHead;
+		while (instr) {
+			jx_ir_instruction_t* instrNext = instr->m_Next;
+
+			if (instr->m_OpCode == JIR_OP_ALLOCA) {
+				jx_ir_bbRemoveInstr(ctx, headerBB, instr);
+				jx_ir_bbAppendInstr(ctx, entryBB, instr);
+			}
+
+			instr = instrNext;
+		}
+
+		jx_ir_bbAppendInstr(ctx, entryBB, jx_ir_instrBranch(ctx, headerBB));
+	}
+
+	// Replace all arguments with phis
+	jx_array_resize(pass->m_ArgPhiArr, 0);
+	jx_ir_argument_t* arg = func->m_ArgListHead;
+	while (arg) {
+		jx_ir_value_t* argVal = jx_ir_argToValue(arg);
+
+		jx_ir_instruction_t* phiInstr = jx_ir_instrPhi(ctx, argVal->m_Type);
+		jx_ir_bbPrependInstr(ctx, headerBB, phiInstr);
+		jx_ir_valueReplaceAllUsesWith(ctx, argVal, jx_ir_instrToValue(phiInstr));
+		jx_ir_instrPhiAddValue(ctx, phiInstr, entryBB, argVal);
+		jx_array_push_back(pass->m_ArgPhiArr, phiInstr);
+
+		arg = arg->m_Next;
+	}
+
+	// Replace all calls with jumps to the header.
+	const uint32_t numArgs = (uint32_t)jx_array_sizeu(pass->m_ArgPhiArr);
+	const uint32_t numCalls = (uint32_t)jx_array_sizeu(pass->m_SelfCallArr);
+	for (uint32_t iCall = 0; iCall < numCalls; ++iCall) {
+		jx_ir_instruction_t* callInstr = pass->m_SelfCallArr[iCall];
+		jx_ir_instruction_t* retInstr = callInstr->m_Next;
+		jx_ir_basic_block_t* bb = callInstr->m_ParentBB;
+		JX_CHECK(retInstr && retInstr->m_OpCode == JIR_OP_RET, "Expected ret after tail call.");
+		JX_CHECK(jx_array_sizeu(callInstr->super.m_OperandArr) == numArgs + 1, "Argument count mismatch.");
+
+		for (uint32_t iArg = 0; iArg < numArgs; ++iArg) {
+			jx_ir_instrPhiAddValue(ctx, pass->m_ArgPhiArr[iArg], bb, callInstr->super.m_OperandArr[iArg + 1]->m_Value);
+		}
+
+		jx_ir_bbRemoveInstr(ctx, bb, retInstr);
+		jx_ir_instrFree(ctx, retInstr);
+		jx_ir_bbRemoveInstr(ctx, bb, callInstr);
+		jx_ir_instrFree(ctx, callInstr);
+		jx_ir_bbAppendInstr(ctx, bb, jx_ir_instrBranch(ctx, headerBB));
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Dead Code Elimination
 //
@@ -3804,6 +5600,7 @@ static bool jir_lvn_instrCalcHash(jir_func_pass_lvn_t* pass, jx_ir_instruction_t
 	switch (instr->m_OpCode) {
 	case JIR_OP_ADD:
 	case JIR_OP_MUL:
+	case JIR_OP_MULHI:
 	case JIR_OP_AND:
 	case JIR_OP_OR:
 	case JIR_OP_XOR: 
@@ -3830,7 +5627,9 @@ static bool jir_lvn_instrCalcHash(jir_func_pass_lvn_t* pass, jx_ir_instruction_t
 	case JIR_OP_SET_LT:
 	case JIR_OP_SET_GT: 
 	case JIR_OP_SHL:
-	case JIR_OP_SHR: {
+	case JIR_OP_SHR:
+	case JIR_OP_ROL:
+	case JIR_OP_ROR: {
 		jx_ir_value_t* op0 = jx_ir_instrGetOperandVal(instr, 0);
 		jx_ir_value_t* op1 = jx_ir_instrGetOperandVal(instr, 1);
 		hash = jx_hashFNV1a(&op0, sizeof(jx_ir_value_t**), hash, 0);
@@ -3838,7 +5637,8 @@ static bool jir_lvn_instrCalcHash(jir_func_pass_lvn_t* pass, jx_ir_instruction_t
 		res = true;
 	} break;
 	case JIR_OP_GET_ELEMENT_PTR:
-	case JIR_OP_PHI: {
+	case JIR_OP_PHI:
+	case JIR_OP_SELECT: {
 		const uint32_t numOperands = (uint32_t)jx_array_sizeu(instr->super.m_OperandArr);
 		hash = jx_hashFNV1a(&numOperands, sizeof(uint32_t), hash, 0);
 		for (uint32_t iOperand = 0; iOperand < numOperands; ++iOperand) {
@@ -3858,7 +5658,11 @@ static bool jir_lvn_instrCalcHash(jir_func_pass_lvn_t* pass, jx_ir_instruction_t
 	case JIR_OP_FP2UI:
 	case JIR_OP_FP2SI:
 	case JIR_OP_UI2FP:
-	case JIR_OP_SI2FP: {
+	case JIR_OP_SI2FP:
+	case JIR_OP_BSWAP:
+	case JIR_OP_POPCNT:
+	case JIR_OP_CTLZ:
+	case JIR_OP_CTTZ: {
 		jx_ir_value_t* op0 = jx_ir_instrGetOperandVal(instr, 0);
 		hash = jx_hashFNV1a(&op0, sizeof(jx_ir_value_t**), hash, 0);
 		res = true;
@@ -21,6 +21,9 @@ bool jx_ir_funcPassCreate_reorderBasicBlocks(jx_ir_function_pass_t* pass, jx_all
 bool jx_ir_funcPassCreate_removeRedundantPhis(jx_ir_function_pass_t* pass, jx_allocator_i* allocator);
 bool jx_ir_funcPassCreate_deadCodeElimination(jx_ir_function_pass_t* pass, jx_allocator_i* allocator);
 bool jx_ir_funcPassCreate_localValueNumbering(jx_ir_function_pass_t* pass, jx_allocator_i* allocator);
+bool jx_ir_funcPassCreate_ifConversion(jx_ir_function_pass_t* pass, jx_allocator_i* allocator);
+bool jx_ir_funcPassCreate_bitIdioms(jx_ir_function_pass_t* pass, jx_allocator_i* allocator);
+bool jx_ir_funcPassCreate_tailCalls(jx_ir_function_pass_t* pass, jx_allocator_i* allocator);
 
 bool jx_ir_modulePassCreate_inlineFuncs(jx_ir_module_pass_t* pass, jx_allocator_i* allocator);
 
@@ -2,8 +2,12 @@
 // - Bit test instructions
 // - Convert 32-bit jumps to 8-bit jumps at function end
 #include "jit.h"
+#include "jit_debug.h"
+#include "jit_disasm.h"
+#include "jit_elf.h"
 #include <jlib/allocator.h>
 #include <jlib/array.h>
+#include <jlib/atomic.h>
 #include <jlib/dbg.h>
 #include <jlib/logger.h>
 #include <jlib/math.h>
@@ -15,6 +19,11 @@
 #define JX64_MODRM(mod, reg, rm)     (((mod) & 0b11) << 6) | (((reg) & 0b111) << 3) | (((rm) & 0b111) << 0)
 #define JX64_SIB(scale, index, base) (((scale) & 0b11) << 6) | (((index) & 0b111) << 3) | (((base) & 0b111) << 0)
 
+// NOTE: R, X, B and vvvv are stored inverted in the VEX prefix.
+#define JX64_VEX2_BYTE1(R, vvvv, L, pp)     ((((~(R)) & 0b1) << 7) | (((~(vvvv)) & 0b1111) << 3) | (((L) & 0b1) << 2) | (((pp) & 0b11) << 0))
+#define JX64_VEX3_BYTE1(R, X, B, mmmmm)     ((((~(R)) & 0b1) << 7) | (((~(X)) & 0b1) << 6) | (((~(B)) & 0b1) << 5) | (((mmmmm) & 0b11111) << 0))
+#define JX64_VEX3_BYTE2(W, vvvv, L, pp)     ((((W) & 0b1) << 7) | (((~(vvvv)) & 0b1111) << 3) | (((L) & 0b1) << 2) | (((pp) & 0b11) << 0))
+
 #define JX64_REG_LO(reg)         ((JX64_REG_GET_ID(reg) & 0b0111) >> 0)
 #define JX64_REG_HI(reg)         ((JX64_REG_GET_ID(reg) & 0b1000) >> 3)
 #define JX64_REG_IS_RBP_R13(reg) ((JX64_REG_GET_FLAG(reg) == 0) && (JX64_REG_LO(reg) == 5))
@@ -28,6 +37,27 @@
 
 #define JX64_LABEL_OFFSET_UNBOUND 0x7FFFFFFFFFFFFFFF
 
+#define JX64_EXTERNAL_STUB_SIZE     6          // jmp qword ptr [rip + disp32]
+#define JX64_VMEM_ALLOC_GRANULARITY (64u << 10) // VirtualAlloc() rounds desired addresses down to 64KB
+#define JX64_VMEM_NEAR_ALLOC_STEP   (16u << 20)
+#define JX64_VMEM_NEAR_ALLOC_TRIES  64
+#define JX64_HOT_PATCH_ENTRY_SIZE   8          // nop which can be replaced by a single 8-byte store
+#define JX64_CODE_CACHE_MAX_CONST_SIZE 16
+#define JX64_CODE_HEAP_BLOCK_SIZE   64         // Allocation granularity (one cache line)
+#define JX64_CODE_HEAP_NUM_SIZE_CLASSES 12     // Free lists for blocks of [64 << i, 64 << (i + 1)) bytes; the last one holds all larger blocks
+
+// Win64 unwind information (UNWIND_INFO/RUNTIME_FUNCTION, see "x64 exception handling" in the MSVC docs)
+#define JX64_UNWIND_INFO_VERSION    1
+#define JX64_UNWIND_FLAG_CHAININFO  0x04
+#define JX64_UWOP_PUSH_NONVOL       0
+#define JX64_UWOP_ALLOC_LARGE       1
+#define JX64_UWOP_ALLOC_SMALL       2
+#define JX64_UWOP_SAVE_NONVOL       4
+#define JX64_UWOP_SAVE_NONVOL_FAR   5
+#define JX64_UWOP_SAVE_XMM128       8
+#define JX64_UWOP_SAVE_XMM128_FAR   9
+#define JX64_UNWIND_CODE(codeOffset, op, info) (uint16_t)(((codeOffset) & 0xFF) | (((op) & 0x0F) << 8) | (((info) & 0x0F) << 12))
+
 typedef enum jx_x64_segment_prefix
 {
 	JX64_SEGMENT_NONE  = 0,
@@ -55,6 +85,13 @@ typedef enum jx_x64_sse_mandatory_prefix
 	JX64_SSE_PREFIX_F3   = 3,
 } jx_x64_sse_mandatory_prefix;
 
+typedef enum jx_x64_opcode_map
+{
+	JX64_OPCODE_MAP_0F   = 1,
+	JX64_OPCODE_MAP_0F38 = 2,
+	JX64_OPCODE_MAP_0F3A = 3,
+} jx_x64_opcode_map;
+
 typedef struct jx_x64_instr_encoding_t
 {
 	uint8_t m_SegmentOverride     : 3; // jx_x64_segment_prefix
@@ -86,6 +123,14 @@ typedef struct jx_x64_instr_encoding_t
 	uint8_t m_SIB_Index           : 3;
 	uint8_t m_SIB_Base            : 3;
 
+	uint8_t m_HasVEX              : 1; // NOTE: If set, REX is encoded in the VEX prefix and m_HasREX is ignored
+	uint8_t m_VEX_L               : 1;
+	uint8_t m_VEX_pp              : 2;
+	uint8_t m_VEX_vvvv            : 4;
+
+	uint8_t m_VEX_Map             : 5; // jx_x64_opcode_map
+	JX_PAD_BITFIELD(uint8_t, 3);
+
 	uint8_t m_Opcode[3];
 	
 	int32_t m_Disp;
@@ -119,17 +164,96 @@ typedef struct jx_x64_section_t
 	uint8_t* m_Buffer;
 	uint32_t m_Size;
 	uint32_t m_Capacity;
-	uint32_t m_CodeBufferOffset;
+	uint8_t* m_FinalAddr; // Address of the section's contents after jx64_finalize()
+	uint32_t m_Alignment; // Largest alignment requested by the section's contents (0 if none)
 	JX_PAD(4);
 } jx_x64_section_t;
 
 typedef struct jx_x64_code_buffer_t
 {
-	uint8_t* m_Buffer;
+	uint8_t* m_Buffer;          // The whole image or, if allocated from a code heap, the text section.
+	const uint8_t* m_ImageBase; // Base address for image relative (ADDR32NB) relocations.
+	uint64_t m_ImageSize;       // Range starting at m_ImageBase which contains all sections.
 	uint32_t m_Size;
 	JX_PAD(4);
 } jx_x64_code_buffer_t;
 
+typedef struct jx_x64_code_cache_reloc_t
+{
+	jx_x64_relocation_t m_Reloc;
+	jx_x64_symbol_kind m_SymbolKind;
+	uint32_t m_ConstSize;      // Non-zero if the target is a constant in read-only data which can be recreated.
+	uint32_t m_ConstAlignment;
+	uint8_t m_ConstData[JX64_CODE_CACHE_MAX_CONST_SIZE];
+	JX_PAD(4);
+} jx_x64_code_cache_reloc_t;
+
+typedef struct jx_x64_code_cache_entry_t
+{
+	char* m_Name;
+	uint64_t m_Fingerprint;
+	uint8_t* m_Code;
+	jx_x64_code_cache_reloc_t* m_RelocArr;
+	jx_x64_unwind_region_t* m_UnwindRegionArr;
+	jx_x64_unwind_op_t* m_UnwindOpArr;
+	uint32_t m_Size;
+	JX_PAD(4);
+} jx_x64_code_cache_entry_t;
+
+typedef struct jx_x64_code_cache_t
+{
+	jx_allocator_i* m_Allocator;
+	jx_x64_code_cache_entry_t* m_EntryArr;
+	uint32_t m_ContextFlags; // Context flags which affect the code (JX64_CONTEXT_FLAGS_HOT_PATCH)
+	JX_PAD(4);
+} jx_x64_code_cache_t;
+
+typedef struct jx_x64_code_heap_block_t
+{
+	uint32_t m_Offset; // Relative to the start of the arena
+	uint32_t m_Size;
+} jx_x64_code_heap_block_t;
+
+// A contiguous range of the heap with the same protection. Hot allocations are carved from 
+// the bottom and cold ones from the top so code which runs together shares pages.
+typedef struct jx_x64_code_heap_arena_t
+{
+	uint8_t* m_Base;
+	uint32_t m_Size;
+	uint32_t m_HotTop;     // Everything below this offset has been handed out at least once.
+	uint32_t m_ColdBottom; // Everything above this offset has been handed out at least once.
+	uint32_t m_ProtectFlags;
+	jx_x64_code_heap_block_t* m_FreeListArr[JX64_CODE_HEAP_NUM_SIZE_CLASSES];
+	jx_x64_code_heap_block_t* m_AllocArr;
+	uint64_t m_UsedSize;
+	uint64_t m_NumAllocs;
+	uint64_t m_NumFailedAllocs;
+	uint8_t* m_WriteBase; // Writable view of m_Base (same address for RW/RWX arenas, an alias for RX text) or NULL if pages are unprotected on write.
+} jx_x64_code_heap_arena_t;
+
+typedef struct jx_x64_code_heap_t
+{
+	jx_allocator_i* m_Allocator;
+	uint8_t* m_CodeMem;
+	uint8_t* m_CodeMemAlias; // Read/write view of m_CodeMem (NULL for large pages)
+	uint8_t* m_DataMem;
+	uint64_t m_CodeMemSize;
+	uint64_t m_DataMemSize;
+	jx_x64_code_heap_arena_t m_Arena[JX64_SECTION_COUNT];
+	const uint8_t* m_ImageBase; // Lowest address of all arenas
+	uint64_t m_ImageSize;
+	uint32_t m_PageSize;
+	bool m_LargePages;
+	JX_PAD(3);
+} jx_x64_code_heap_t;
+
+typedef struct jx_x64_runtime_function_t
+{
+	uint32_t m_BeginAddress;
+	uint32_t m_EndAddress;
+	uint32_t m_UnwindInfoAddress;
+} jx_x64_runtime_function_t;
+
 typedef struct jx_x64_context_t
 {
 	jx_allocator_i* m_Allocator;
@@ -137,10 +261,56 @@ typedef struct jx_x64_context_t
 	jx_x64_symbol_t* m_CurFunc;
 	jx_x64_section_t m_Section[JX64_SECTION_COUNT];
 	jx_x64_code_buffer_t m_CodeBuffer;
+	jx_x64_gdb_image_t* m_GDBImage;
+	jx_x64_symbol_t* m_FunctionTableSym;   // Win64 RUNTIME_FUNCTION entries for all functions with unwind info.
+	const uint8_t* m_RegisteredFunctionTable;
+	jx_x64_code_cache_t* m_CodeCache;
+	jx_x64_code_heap_t* m_CodeHeap;
+	jx_os_mutex_t* m_HotPatchMutex;        // Serializes code page reprotection in jx64_funcHotPatch()
+	uint32_t m_Flags;
+	bool m_UpperYMMDirty;
+	JX_PAD(3);
 } jx_x64_context_t;
 
+typedef enum jx_x64_elf_object_section
+{
+	JX64_ELF_OBJECT_SECTION_NULL = 0,
+	JX64_ELF_OBJECT_SECTION_TEXT,
+	JX64_ELF_OBJECT_SECTION_RODATA,
+	JX64_ELF_OBJECT_SECTION_DATA,
+	JX64_ELF_OBJECT_SECTION_RELA_TEXT,
+	JX64_ELF_OBJECT_SECTION_RELA_RODATA,
+	JX64_ELF_OBJECT_SECTION_RELA_DATA,
+	JX64_ELF_OBJECT_SECTION_SYMTAB,
+	JX64_ELF_OBJECT_SECTION_STRTAB,
+	JX64_ELF_OBJECT_SECTION_NOTE_GNU_STACK,
+	JX64_ELF_OBJECT_SECTION_SHSTRTAB,
+
+	JX64_ELF_OBJECT_SECTION_COUNT
+} jx_x64_elf_object_section;
+
 static jx_x64_symbol_t* jx64_symbolAlloc(jx_x64_context_t* ctx, jx_x64_symbol_kind kind, const char* name);
+static void jx64_registerDebugInfo(jx_x64_context_t* ctx);
+static uint32_t jx64_symbolGetIndex(jx_x64_context_t* ctx, const char* name);
+static bool jx64_elfSymbolIsLocal(const jx_x64_symbol_t* sym);
+static bool jx64_unwindInitFunc(jx_x64_context_t* ctx, jx_x64_symbol_t* func);
+static bool jx64_unwindEmitTables(jx_x64_context_t* ctx);
+static bool jx64_unwindFuncFitsInfo(const jx_x64_symbol_t* func);
+static uint8_t* jx64_codeBufferAllocNear(uint64_t sz, uintptr_t targetAddrMin, uintptr_t targetAddrMax, uint8_t** writableAlias);
+static uint8_t* jx64_codeBufferAllocAt(uint8_t* desiredAddr, uint64_t sz, uint8_t** writableAlias);
+static bool jx64_isRel32Reachable(const uint8_t* buffer, uint64_t sz, const void* targetAddr);
 static void jx64_symbolFree(jx_x64_context_t* ctx, jx_x64_symbol_t* sym);
+static jx_x64_code_cache_entry_t* jx64_codeCacheFind(jx_x64_code_cache_t* cache, const char* funcName);
+static void jx64_codeCacheStore(jx_x64_context_t* ctx, jx_x64_symbol_t* func);
+static void jx64_codeCacheEntryFree(jx_x64_code_cache_t* cache, jx_x64_code_cache_entry_t* entry);
+static bool jx64_codeHeapAllocSections(jx_x64_context_t* ctx, const uint32_t* sectionSize);
+static jx_x64_code_heap_arena_t* jx64_codeHeapFindArena(jx_x64_code_heap_t* heap, const uint8_t* ptr);
+static void jx64_codeHeapArenaInit(jx_x64_code_heap_arena_t* arena, uint8_t* base, uint32_t size, uint32_t protectFlags, uint8_t* writeBase);
+static uint8_t* jx64_codeHeapArenaBeginWrite(jx_x64_code_heap_arena_t* arena, uint8_t* addr, uint32_t size);
+static bool jx64_codeHeapArenaEndWrite(jx_x64_code_heap_arena_t* arena, uint8_t* addr, uint32_t size);
+static void jx64_codeHeapArenaAddFreeBlock(jx_x64_code_heap_arena_t* arena, uint32_t offset, uint32_t size);
+static bool jx64_codeHeapArenaMergeAdjacentFreeBlock(jx_x64_code_heap_arena_t* arena, jx_x64_code_heap_block_t* block);
+static uint32_t jx64_codeHeapGetSizeClass(uint32_t size);
 
 static bool jx64_stack_op_mem(jx_x64_instr_encoding_t* enc, uint8_t opcode, uint8_t modrm_reg, const jx_x64_mem_t* mem, jx_x64_size sz);
 static bool jx64_stack_op_reg(jx_x64_instr_encoding_t* enc, uint8_t baseOpcode, jx_x64_reg reg);
@@ -163,6 +333,14 @@ static bool jx64_mov_mem_imm(jx_x64_instr_encoding_t* enc, const jx_x64_mem_t* d
 static bool jx64_movsx_reg_reg(jx_x64_instr_encoding_t* enc, jx_x64_reg dst_r, jx_x64_reg src_r);
 static bool jx64_movzx_reg_reg(jx_x64_instr_encoding_t* enc, jx_x64_reg dst_r, jx_x64_reg src_r);
 static bool jx64_sse_binary_op(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefix prefix, uint8_t opcode1, bool forceREXW, jx_x64_operand_t dst, jx_x64_operand_t src);
+static bool jx64_movd_movq(jx_x64_context_t* ctx, bool isQWord, jx_x64_operand_t dst, jx_x64_operand_t src);
+static bool jx64_bit_scan_op(jx_x64_context_t* ctx, bool repPrefix, uint8_t opcode1, jx_x64_operand_t dst, jx_x64_operand_t src);
+static bool jx64_bit_test_op(jx_x64_context_t* ctx, uint8_t opcode_rm, uint8_t modrm_reg, jx_x64_operand_t dst, jx_x64_operand_t src);
+static bool jx64_sse_binary_op_imm8(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefix prefix, uint8_t opcode1, bool forceREXW, jx_x64_operand_t dst, jx_x64_operand_t src, bool hasImm8, uint8_t imm8);
+static bool jx64_vex_op(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefix prefix, jx_x64_opcode_map map, uint8_t opcode, bool vexW, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+static bool jx64_vex_op_imm8(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefix prefix, jx_x64_opcode_map map, uint8_t opcode, bool vexW, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, bool hasImm8, uint8_t imm8);
+static bool jx64_vex_mov_op(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefix prefix, uint8_t opcodeLoad, uint8_t opcodeStore, bool isScalar, jx_x64_operand_t dst, jx_x64_operand_t src);
+static bool jx64_sse_op(jx_x64_context_t* ctx, bool isVEX, jx_x64_sse_mandatory_prefix prefix, jx_x64_opcode_map map, uint8_t opcode1, bool forceREXW, jx_x64_reg vexSrc1, jx_x64_operand_t dst, jx_x64_operand_t src, bool hasImm8, uint8_t imm8);
 static bool jx64_instrBuf_push8(jx_x64_instr_buffer_t* ib, uint8_t b);
 static bool jx64_instrBuf_push16(jx_x64_instr_buffer_t* ib, uint16_t w);
 static bool jx64_instrBuf_push32(jx_x64_instr_buffer_t* ib, uint32_t dw);
@@ -181,6 +359,8 @@ static void jx64_instrEnc_segment(jx_x64_instr_encoding_t* enc, jx_x64_segment_p
 static void jx64_instrEnc_lock_rep(jx_x64_instr_encoding_t* enc, jx_x64_lock_repeat_prefix lockRepeat);
 static void jx64_instrEnc_addrSize(jx_x64_instr_encoding_t* enc, bool override);
 static void jx64_instrEnc_operandSize(jx_x64_instr_encoding_t* enc, bool override);
+static void jx64_instrEnc_vex(jx_x64_instr_encoding_t* enc, jx_x64_opcode_map map, jx_x64_sse_mandatory_prefix prefix, uint8_t l, uint8_t vvvv);
+static uint32_t jx64_instrEnc_calcVEXSize(const jx_x64_instr_encoding_t* enc);
 static uint32_t jx64_instrEnc_calcInstrSize(const jx_x64_instr_encoding_t* encoding);
 static uint32_t jx64_instrEnc_calcDispOffset(const jx_x64_instr_encoding_t* enc);
 static bool jx64_encodeInstr(jx_x64_instr_buffer_t* instr, const jx_x64_instr_encoding_t* encoding);
@@ -201,6 +381,12 @@ jx_x64_context_t* jx_x64_createContext(jx_allocator_i* allocator)
 		return NULL;
 	}
 
+	ctx->m_HotPatchMutex = jx_os_mutexCreate();
+	if (!ctx->m_HotPatchMutex) {
+		jx_x64_destroyContext(ctx);
+		return NULL;
+	}
+
 	return ctx;
 }
 
@@ -208,9 +394,24 @@ void jx_x64_destroyContext(jx_x64_context_t* ctx)
 {
 	jx_allocator_i* allocator = ctx->m_Allocator;
 
+	if (ctx->m_GDBImage) {
+		jx64_debugUnregisterGDBImage(ctx->m_GDBImage);
+		ctx->m_GDBImage = NULL;
+	}
+
+	if (ctx->m_RegisteredFunctionTable) {
+		jx64_debugUnregisterFunctionTable(ctx->m_RegisteredFunctionTable);
+		ctx->m_RegisteredFunctionTable = NULL;
+	}
+
 	for (uint32_t iSec = 0; iSec < JX64_SECTION_COUNT; ++iSec) {
 		jx_x64_section_t* sec = &ctx->m_Section[iSec];
 		JX_FREE(allocator, sec->m_Buffer);
+
+		// NOTE: Code heap allocations are returned to the heap. Stand-alone code buffers stay mapped.
+		if (ctx->m_CodeHeap && sec->m_FinalAddr) {
+			jx64_codeHeapFree(ctx->m_CodeHeap, sec->m_FinalAddr);
+		}
 	}
 
 	const uint32_t numSymbols = (uint32_t)jx_array_sizeu(ctx->m_SymbolArr);
@@ -219,9 +420,25 @@ void jx_x64_destroyContext(jx_x64_context_t* ctx)
 		jx64_symbolFree(ctx, sym);
 	}
 	jx_array_free(ctx->m_SymbolArr);
+
+	if (ctx->m_HotPatchMutex) {
+		jx_os_mutexDestroy(ctx->m_HotPatchMutex);
+		ctx->m_HotPatchMutex = NULL;
+	}
+
 	JX_FREE(allocator, ctx);
 }
 
+void jx64_setFlags(jx_x64_context_t* ctx, uint32_t flags)
+{
+	ctx->m_Flags = flags;
+}
+
+uint32_t jx64_getFlags(jx_x64_context_t* ctx)
+{
+	return ctx->m_Flags;
+}
+
 void jx64_resetBuffer(jx_x64_context_t* ctx)
 {
 }
@@ -234,52 +451,122 @@ const uint8_t* jx64_getBuffer(jx_x64_context_t* ctx, uint32_t* sz)
 
 bool jx64_finalize(jx_x64_context_t* ctx, jx64GetExternalSymbolAddrCallback externalSymCb, void* userData)
 {
+	// NOTE: Unwind tables don't depend on the final address of the code and they must be 
+	// declared before counting the symbols in order for their relocations to be applied.
+	if (!jx64_unwindEmitTables(ctx)) {
+		return false;
+	}
+
 	const uint32_t numSymbols = (uint32_t)jx_array_sizeu(ctx->m_SymbolArr);
 
-	// Emit stubs for all external functions
+	// Resolve all external symbols. External variables get a slot holding their address.
+	// External functions are either called directly or through an import stub, depending
+	// on where the code buffer ends up (see below).
+	uint32_t numExternalFuncs = 0;
+	uintptr_t externalAddrMin = UINTPTR_MAX;
+	uintptr_t externalAddrMax = 0;
 	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
 		jx_x64_symbol_t* sym = ctx->m_SymbolArr[iSym];
-		if (sym->m_Size == 0) {
+		if (sym->m_Size == 0 && !sym->m_ExternalAddr) {
 			void* symAddr = externalSymCb(sym->m_Name, userData);
 
 			if (sym->m_Kind == JX64_SYMBOL_FUNCTION) {
-				char iatEntryName[256];
-				jx_snprintf(iatEntryName, JX_COUNTOF(iatEntryName), "__iat_%s", sym->m_Name);
-				jx_x64_symbol_t* iatEntry = jx64_globalVarDeclare(ctx, iatEntryName);
-				jx64_globalVarDefine(ctx, iatEntry, (const uint8_t*)&symAddr, sizeof(void*), 8);
-
-				jx64_funcBegin(ctx, sym);
-				jx64_jmp(ctx, jx64_opMemSymbol(JX64_SIZE_64, iatEntry, 0));
-				jx64_funcEnd(ctx);
+				sym->m_ExternalAddr = symAddr;
+				if (symAddr) {
+					externalAddrMin = (uintptr_t)symAddr < externalAddrMin ? (uintptr_t)symAddr : externalAddrMin;
+					externalAddrMax = (uintptr_t)symAddr > externalAddrMax ? (uintptr_t)symAddr : externalAddrMax;
+				}
+				++numExternalFuncs;
 			} else {
-				jx64_globalVarDefine(ctx, sym, (const uint8_t*)&symAddr, sizeof(void*), 8);
+				jx64_globalVarDefine(ctx, sym, JX64_SECTION_DATA, (const uint8_t*)&symAddr, sizeof(void*), 8);
 			}
 		}
 	}
 
-	// Combine all sections into a continuous buffer
+	// Reserve enough space for the worst case where every external function needs
+	// an import stub and an address table entry.
 	const uint32_t pageSize = jx_os_vmemGetPageSize();
-	uint32_t totalSize = 0;
+	const uint32_t maxStubsSize = numExternalFuncs * JX64_EXTERNAL_STUB_SIZE;
+	const uint32_t maxIATSize = numExternalFuncs * sizeof(void*) + (sizeof(void*) - 1);
+	uint32_t maxSectionSize[JX64_SECTION_COUNT];
+	uint64_t maxTotalSize = 0;
 	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
-		jx_x64_section_t* sec = &ctx->m_Section[iSection];
-		sec->m_CodeBufferOffset = totalSize;
-		totalSize += jx_roundup_u32(sec->m_Size, pageSize);
+		const uint32_t extraSize = iSection == JX64_SECTION_TEXT
+			? maxStubsSize
+			: (iSection == JX64_SECTION_RODATA ? maxIATSize : 0)
+			;
+		maxSectionSize[iSection] = ctx->m_Section[iSection].m_Size + extraSize;
+		maxTotalSize += jx_roundup_u32(maxSectionSize[iSection], pageSize);
 	}
 
-	jx_x64_code_buffer_t* cb = &ctx->m_CodeBuffer;
-	cb->m_Buffer = jx_os_vmemAlloc(NULL, totalSize, JX_VMEM_PROTECT_READ_Msk | JX_VMEM_PROTECT_WRITE_Msk);
-	if (!cb->m_Buffer) {
+	if (maxTotalSize > INT32_MAX) {
+		JX_CHECK(false, "Code buffer too large for rel32 relocations.");
 		return false;
 	}
-	cb->m_Size = totalSize;
 
-	jx_memset(cb->m_Buffer, 0, totalSize);
+	// NOTE: Sections allocated from a code heap get their final address right away. A stand-alone
+	// buffer is only split into sections after the import stubs have been emitted (see below).
+	jx_x64_code_buffer_t* cb = &ctx->m_CodeBuffer;
+	if (ctx->m_CodeHeap) {
+		if (!jx64_codeHeapAllocSections(ctx, maxSectionSize)) {
+			return false;
+		}
+	} else {
+		cb->m_Buffer = jx64_codeBufferAllocNear(maxTotalSize, externalAddrMin, externalAddrMax, NULL);
+		if (!cb->m_Buffer) {
+			return false;
+		}
+		cb->m_Size = (uint32_t)maxTotalSize;
+		cb->m_ImageBase = cb->m_Buffer;
+		cb->m_ImageSize = maxTotalSize;
+	}
+
+	// External functions within rel32 range of the whole buffer are referenced directly
+	// (e.g. call rel32). The rest go through an indirect jump via an address table entry.
+	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
+		jx_x64_symbol_t* sym = ctx->m_SymbolArr[iSym];
+		if (sym->m_Kind != JX64_SYMBOL_FUNCTION || sym->m_Size != 0) {
+			continue;
+		}
+
+		void* symAddr = sym->m_ExternalAddr;
+		if (symAddr && jx64_isRel32Reachable(cb->m_ImageBase, cb->m_ImageSize, symAddr)) {
+			continue;
+		}
+
+		sym->m_ExternalAddr = NULL;
+
+		char iatEntryName[256];
+		jx_snprintf(iatEntryName, JX_COUNTOF(iatEntryName), "__iat_%s", sym->m_Name);
+		jx_x64_symbol_t* iatEntry = jx64_globalVarDeclare(ctx, iatEntryName);
+		jx64_globalVarDefine(ctx, iatEntry, JX64_SECTION_RODATA, (const uint8_t*)&symAddr, sizeof(void*), 8);
+
+		jx64_funcBegin(ctx, sym);
+		jx64_jmp(ctx, jx64_opMemSymbol(JX64_SIZE_64, iatEntry, 0));
+		jx64_funcEnd(ctx);
+	}
+
+	// Combine all sections into the code buffer. Each section starts on its own page
+	// so it can be given its own protection flags. Keeping all of them in a single 
+	// allocation guarantees that rel32 relocations between sections are always in range.
+	// Code heap arenas provide the same guarantees.
+	if (!ctx->m_CodeHeap) {
+		uint64_t totalSize = 0;
+		for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+			jx_x64_section_t* sec = &ctx->m_Section[iSection];
+			sec->m_FinalAddr = &cb->m_Buffer[totalSize];
+			totalSize += jx_roundup_u32(sec->m_Size, pageSize);
+		}
+		JX_CHECK(totalSize <= maxTotalSize, "Import stubs larger than expected.");
+	}
 
 	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
-		jx_x64_section_t* sec = &ctx->m_Section[iSection];
-		jx_memcpy(&cb->m_Buffer[sec->m_CodeBufferOffset], sec->m_Buffer, sec->m_Size);
+		JX_CHECK(ctx->m_Section[iSection].m_Size <= maxSectionSize[iSection], "Import stubs larger than expected.");
 	}
 
+	// NOTE: Relocations are applied to the section buffers which are copied to their final 
+	// location at the end. Code heap memory is only writable while being copied to.
+
 	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
 		jx_x64_symbol_t* sym = ctx->m_SymbolArr[iSym];
 
@@ -295,42 +582,47 @@ bool jx64_finalize(jx_x64_context_t* ctx, jx64GetExternalSymbolAddrCallback exte
 		for (uint32_t iReloc = 0; iReloc < numRelocs; ++iReloc) {
 			jx_x64_relocation_t* reloc = &sym->m_RelocArr[iReloc];
 			jx_x64_symbol_t* refSym = jx64_symbolGetByName(ctx, reloc->m_SymbolName);
-			if (!refSym || refSym->m_Label->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
+			if (!refSym || (!refSym->m_ExternalAddr && refSym->m_Label->m_Offset == JX64_LABEL_OFFSET_UNBOUND)) {
 				// Unresolved external symbol
 				return false;
 			}
 
-			jx_x64_section_t* refSymSection = &ctx->m_Section[refSym->m_Label->m_Section];
-			const uint32_t refSymOffset = refSymSection->m_CodeBufferOffset + (uint32_t)refSym->m_Label->m_Offset;
+			const uint8_t* refSymAddr = NULL;
+			if (refSym->m_ExternalAddr) {
+				refSymAddr = (const uint8_t*)refSym->m_ExternalAddr;
+			} else {
+				jx_x64_section_t* refSymSection = &ctx->m_Section[refSym->m_Label->m_Section];
+				refSymAddr = &refSymSection->m_FinalAddr[refSym->m_Label->m_Offset];
+			}
 
 			jx_x64_section_t* symSection = &ctx->m_Section[sym->m_Label->m_Section];
-			const uint32_t patchOffset = symSection->m_CodeBufferOffset + (uint32_t)sym->m_Label->m_Offset + reloc->m_Offset;
-			uint8_t* patchAddr = &cb->m_Buffer[patchOffset];
+			const uint32_t patchOffset = (uint32_t)sym->m_Label->m_Offset + reloc->m_Offset;
+			uint8_t* patchAddr = &symSection->m_Buffer[patchOffset];
+			const uint8_t* finalPatchAddr = &symSection->m_FinalAddr[patchOffset];
 
 			switch (reloc->m_Kind) {
 			case JX64_RELOC_ABSOLUTE: {
 				JX_NOT_IMPLEMENTED();
 			} break;
 			case JX64_RELOC_ADDR64: {
-				*(uintptr_t*)patchAddr += (uintptr_t)&cb->m_Buffer[refSymOffset];
-			} break;
-			case JX64_RELOC_REL32: {
-				*(int32_t*)patchAddr += (int32_t)refSymOffset - (int32_t)(patchOffset + 4);
+				*(uintptr_t*)patchAddr += (uintptr_t)refSymAddr;
 			} break;
-			case JX64_RELOC_REL32_1: {
-				*(int32_t*)patchAddr += (int32_t)refSymOffset - (int32_t)(patchOffset + 5);
-			} break;
-			case JX64_RELOC_REL32_2: {
-				*(int32_t*)patchAddr += (int32_t)refSymOffset - (int32_t)(patchOffset + 6);
-			} break;
-			case JX64_RELOC_REL32_3: {
-				*(int32_t*)patchAddr += (int32_t)refSymOffset - (int32_t)(patchOffset + 7);
-			} break;
-			case JX64_RELOC_REL32_4: {
-				*(int32_t*)patchAddr += (int32_t)refSymOffset - (int32_t)(patchOffset + 8);
+			case JX64_RELOC_ADDR32NB: {
+				JX_CHECK(!refSym->m_ExternalAddr, "Image relative relocations must target symbols inside the code buffer.");
+				*(uint32_t*)patchAddr += (uint32_t)(refSymAddr - cb->m_ImageBase);
 			} break;
+			case JX64_RELOC_REL32:
+			case JX64_RELOC_REL32_1:
+			case JX64_RELOC_REL32_2:
+			case JX64_RELOC_REL32_3:
+			case JX64_RELOC_REL32_4:
 			case JX64_RELOC_REL32_5: {
-				*(int32_t*)patchAddr += (int32_t)refSymOffset - (int32_t)(patchOffset + 9);
+				// NOTE: The displacement is relative to the end of the instruction. REL32_n 
+				// relocations are followed by an n-byte immediate.
+				const uint32_t nextInstrOffset = 4 + (uint32_t)(reloc->m_Kind - JX64_RELOC_REL32);
+				const int64_t disp = (int64_t)((intptr_t)refSymAddr - (intptr_t)(finalPatchAddr + nextInstrOffset));
+				JX_CHECK(disp >= INT32_MIN && disp <= INT32_MAX, "Relocation target out of rel32 range.");
+				*(int32_t*)patchAddr += (int32_t)disp;
 			} break;
 			default:
 				JX_CHECK(false, "Unknown relocation kind.");
@@ -348,14 +640,338 @@ bool jx64_finalize(jx_x64_context_t* ctx, jx64GetExternalSymbolAddrCallback exte
 	}
 #endif
 
-	// TODO: Mark .text section as execute/read and data sections as read/write or read-only once I add a .rodata section
-	if (!jx_os_vmemProtect(cb->m_Buffer, cb->m_Size, JX_VMEM_PROTECT_EXEC_Msk | JX_VMEM_PROTECT_READ_Msk | JX_VMEM_PROTECT_WRITE_Msk)) {
-		JX_CHECK(false, "Failed to change code buffer protect flags!");
+	if (ctx->m_CodeHeap) {
+		for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+			jx_x64_section_t* sec = &ctx->m_Section[iSection];
+			if (sec->m_Size != 0 && !jx64_codeHeapWrite(ctx->m_CodeHeap, sec->m_FinalAddr, sec->m_Buffer, sec->m_Size)) {
+				JX_CHECK(false, "Failed to write to the code heap!");
+				return false;
+			}
+		}
+	} else {
+		for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+			jx_x64_section_t* sec = &ctx->m_Section[iSection];
+			jx_memset(sec->m_FinalAddr, 0, jx_roundup_u32(sec->m_Size, pageSize));
+			jx_memcpy(sec->m_FinalAddr, sec->m_Buffer, sec->m_Size);
+		}
+
+		// NOTE: No page is ever both writable and executable (W^X). The whole buffer
+		// stays read/write until all sections have been copied.
+		static const uint32_t kSectionProtectFlags[JX64_SECTION_COUNT] = {
+			JX_VMEM_PROTECT_READ_Msk | JX_VMEM_PROTECT_EXEC_Msk,  // JX64_SECTION_TEXT
+			JX_VMEM_PROTECT_READ_Msk,                             // JX64_SECTION_RODATA
+			JX_VMEM_PROTECT_READ_Msk | JX_VMEM_PROTECT_WRITE_Msk, // JX64_SECTION_DATA
+		};
+
+		for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+			jx_x64_section_t* sec = &ctx->m_Section[iSection];
+			const uint32_t secSize = jx_roundup_u32(sec->m_Size, pageSize);
+			if (secSize == 0) {
+				continue;
+			}
+
+			if (!jx_os_vmemProtect(sec->m_FinalAddr, secSize, kSectionProtectFlags[iSection])) {
+				JX_CHECK(false, "Failed to change code buffer protect flags!");
+				return false;
+			}
+		}
+	}
+
+	// NOTE: Failing to register the unwind tables is not fatal; only unwinding through
+	// JIT frames (exceptions, stack walks) is affected.
+	if (ctx->m_FunctionTableSym && !ctx->m_RegisteredFunctionTable) {
+		jx_x64_symbol_t* funcTableSym = ctx->m_FunctionTableSym;
+		const uint8_t* funcTable = &ctx->m_Section[funcTableSym->m_Label->m_Section].m_FinalAddr[funcTableSym->m_Label->m_Offset];
+		const uint32_t numEntries = funcTableSym->m_Size / sizeof(jx_x64_runtime_function_t);
+		if (jx64_debugRegisterFunctionTable(cb->m_ImageBase, funcTable, numEntries)) {
+			ctx->m_RegisteredFunctionTable = funcTable;
+		}
+	}
+
+	if ((ctx->m_Flags & (JX64_CONTEXT_FLAGS_PERF_MAP_Msk | JX64_CONTEXT_FLAGS_GDB_JIT_Msk)) != 0) {
+		jx64_registerDebugInfo(ctx);
 	}
 
 	return true;
 }
 
+uint8_t* jx64_emitELFObject(jx_x64_context_t* ctx, jx_allocator_i* allocator, uint32_t* sz)
+{
+	// NOTE: jx64_finalize() applies the relocations to the section buffers.
+	if (ctx->m_Section[JX64_SECTION_TEXT].m_FinalAddr) {
+		JX_CHECK(false, "Object files must be emitted before finalizing the context.");
+		return NULL;
+	}
+
+	static const char kSectionNames[] = "\0.text\0.rodata\0.data\0.rela.text\0.rela.rodata\0.rela.data\0.symtab\0.strtab\0.note.GNU-stack\0.shstrtab";
+	static const uint32_t kSectionNameOffset[JX64_ELF_OBJECT_SECTION_COUNT] = { 0, 1, 7, 15, 21, 32, 45, 56, 64, 72, 88 };
+	static const uint64_t kSectionFlags[JX64_SECTION_COUNT] = {
+		JX_ELF_SHF_ALLOC | JX_ELF_SHF_EXECINSTR, // JX64_SECTION_TEXT
+		JX_ELF_SHF_ALLOC,                        // JX64_SECTION_RODATA
+		JX_ELF_SHF_ALLOC | JX_ELF_SHF_WRITE,     // JX64_SECTION_DATA
+	};
+
+	// Calculate the layout: header, section contents, relocations, symbol table, 
+	// string tables and section headers.
+	const uint32_t numSymbols = (uint32_t)jx_array_sizeu(ctx->m_SymbolArr);
+	uint32_t numRelocs[JX64_SECTION_COUNT] = { 0 };
+	uint32_t strTabSize = 1;
+	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
+		const jx_x64_symbol_t* sym = ctx->m_SymbolArr[iSym];
+		strTabSize += jx_strlen(sym->m_Name) + 1;
+		if (sym->m_Label->m_Offset != JX64_LABEL_OFFSET_UNBOUND) {
+			numRelocs[sym->m_Label->m_Section] += (uint32_t)jx_array_sizeu(sym->m_RelocArr);
+		}
+	}
+
+	uint32_t sectionOffset[JX64_SECTION_COUNT];
+	uint32_t relaOffset[JX64_SECTION_COUNT];
+	uint32_t imageSize = sizeof(jx_elf64_header_t);
+	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+		imageSize = jx_roundup_u32(imageSize, jx_max_u32(ctx->m_Section[iSection].m_Alignment, 1));
+		sectionOffset[iSection] = imageSize;
+		imageSize += ctx->m_Section[iSection].m_Size;
+	}
+	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+		imageSize = jx_roundup_u32(imageSize, 8);
+		relaOffset[iSection] = imageSize;
+		imageSize += numRelocs[iSection] * sizeof(jx_elf64_rela_t);
+	}
+	const uint32_t symtabOffset = jx_roundup_u32(imageSize, 8);
+	const uint32_t strtabOffset = symtabOffset + (numSymbols + 1) * sizeof(jx_elf64_symbol_t);
+	const uint32_t shstrtabOffset = strtabOffset + strTabSize;
+	const uint32_t shdrOffset = jx_roundup_u32(shstrtabOffset + sizeof(kSectionNames), 8);
+	imageSize = shdrOffset + JX64_ELF_OBJECT_SECTION_COUNT * sizeof(jx_elf64_section_header_t);
+
+	// ELF requires all local symbols to come before the global ones. elfSymIndex maps each 
+	// symbol of the context to its symbol table entry.
+	uint32_t* elfSymIndex = (uint32_t*)JX_ALLOC(allocator, sizeof(uint32_t) * (numSymbols + 1));
+	if (!elfSymIndex) {
+		return NULL;
+	}
+
+	uint32_t numLocalSymbols = 0;
+	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
+		if (jx64_elfSymbolIsLocal(ctx->m_SymbolArr[iSym])) {
+			elfSymIndex[iSym] = ++numLocalSymbols;
+		}
+	}
+
+	const uint32_t firstGlobalSymbol = numLocalSymbols + 1;
+	uint32_t nextGlobalSymbol = firstGlobalSymbol;
+	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
+		if (!jx64_elfSymbolIsLocal(ctx->m_SymbolArr[iSym])) {
+			elfSymIndex[iSym] = nextGlobalSymbol++;
+		}
+	}
+
+	uint8_t* elf = (uint8_t*)JX_ALLOC(allocator, imageSize);
+	if (!elf) {
+		JX_FREE(allocator, elfSymIndex);
+		return NULL;
+	}
+
+	jx_memset(elf, 0, imageSize);
+
+	jx_elf64_header_t* hdr = (jx_elf64_header_t*)elf;
+	hdr->m_Ident[0] = 0x7F;
+	hdr->m_Ident[1] = 'E';
+	hdr->m_Ident[2] = 'L';
+	hdr->m_Ident[3] = 'F';
+	hdr->m_Ident[4] = JX_ELF_CLASS64;
+	hdr->m_Ident[5] = JX_ELF_DATA2LSB;
+	hdr->m_Ident[6] = JX_ELF_VERSION;
+	hdr->m_Type = JX_ELF_ET_REL;
+	hdr->m_Machine = JX_ELF_EM_X86_64;
+	hdr->m_Version = JX_ELF_VERSION;
+	hdr->m_SectionHeaderOffset = shdrOffset;
+	hdr->m_HeaderSize = sizeof(jx_elf64_header_t);
+	hdr->m_SectionHeaderEntrySize = sizeof(jx_elf64_section_header_t);
+	hdr->m_NumSectionHeaders = JX64_ELF_OBJECT_SECTION_COUNT;
+	hdr->m_SectionNameStringTableIndex = JX64_ELF_OBJECT_SECTION_SHSTRTAB;
+
+	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+		const jx_x64_section_t* sec = &ctx->m_Section[iSection];
+		if (sec->m_Size != 0) {
+			jx_memcpy(&elf[sectionOffset[iSection]], sec->m_Buffer, sec->m_Size);
+		}
+	}
+
+	// NOTE: Symbols without code or data (incl. the ones resolved through the external 
+	// symbol callback) are undefined and left for the linker to resolve.
+	char* strTab = (char*)&elf[strtabOffset];
+	strTabSize = 1;
+
+	jx_elf64_symbol_t* symTab = (jx_elf64_symbol_t*)&elf[symtabOffset];
+	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
+		const jx_x64_symbol_t* sym = ctx->m_SymbolArr[iSym];
+		const bool isDefined = true
+			&& !sym->m_ExternalAddr
+			&& sym->m_Label->m_Offset != JX64_LABEL_OFFSET_UNBOUND
+			;
+		const uint8_t type = !isDefined
+			? JX_ELF_STT_NOTYPE
+			: (sym->m_Kind == JX64_SYMBOL_FUNCTION ? JX_ELF_STT_FUNC : JX_ELF_STT_OBJECT)
+			;
+
+		const uint8_t binding = jx64_elfSymbolIsLocal(sym)
+			? JX_ELF_STB_LOCAL
+			: JX_ELF_STB_GLOBAL
+			;
+
+		jx_elf64_symbol_t* elfSym = &symTab[elfSymIndex[iSym]];
+		elfSym->m_Name = strTabSize;
+		elfSym->m_Info = JX_ELF_ST_INFO(binding, type);
+		if (isDefined) {
+			elfSym->m_SectionIndex = (uint16_t)(JX64_ELF_OBJECT_SECTION_TEXT + sym->m_Label->m_Section);
+			elfSym->m_Value = sym->m_Label->m_Offset;
+			elfSym->m_Size = sym->m_Size;
+		} else {
+			elfSym->m_SectionIndex = JX_ELF_SHN_UNDEF;
+		}
+
+		const uint32_t nameLen = jx_strlen(sym->m_Name);
+		jx_memcpy(&strTab[strTabSize], sym->m_Name, nameLen + 1);
+		strTabSize += nameLen + 1;
+	}
+
+	// NOTE: The addend of each relocation is the value stored in place (see jx64_finalize()),
+	// adjusted for the PC being the address of the relocated field instead of the end of the 
+	// instruction. The field itself is cleared, like in the output of other compilers.
+	uint32_t numEmittedRelocs[JX64_SECTION_COUNT] = { 0 };
+	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
+		const jx_x64_symbol_t* sym = ctx->m_SymbolArr[iSym];
+		if (sym->m_Label->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
+			continue;
+		}
+
+		const jx_x64_section_kind section = sym->m_Label->m_Section;
+		jx_elf64_rela_t* relaArr = (jx_elf64_rela_t*)&elf[relaOffset[section]];
+
+		const uint32_t numSymRelocs = (uint32_t)jx_array_sizeu(sym->m_RelocArr);
+		for (uint32_t iReloc = 0; iReloc < numSymRelocs; ++iReloc) {
+			const jx_x64_relocation_t* reloc = &sym->m_RelocArr[iReloc];
+			const uint32_t refSymIndex = jx64_symbolGetIndex(ctx, reloc->m_SymbolName);
+			if (refSymIndex == UINT32_MAX) {
+				JX_CHECK(false, "Relocation against an undeclared symbol.");
+				JX_FREE(allocator, elfSymIndex);
+				JX_FREE(allocator, elf);
+				return NULL;
+			}
+
+			const uint32_t patchOffset = (uint32_t)sym->m_Label->m_Offset + reloc->m_Offset;
+			uint8_t* patchAddr = &elf[sectionOffset[section] + patchOffset];
+
+			jx_elf64_rela_t* rela = &relaArr[numEmittedRelocs[section]++];
+			rela->m_Offset = patchOffset;
+
+			switch (reloc->m_Kind) {
+			case JX64_RELOC_ADDR64: {
+				int64_t inPlace;
+				jx_memcpy(&inPlace, patchAddr, sizeof(int64_t));
+				jx_memset(patchAddr, 0, sizeof(int64_t));
+
+				rela->m_Info = JX_ELF_R_INFO(elfSymIndex[refSymIndex], JX_ELF_R_X86_64_64);
+				rela->m_Addend = inPlace;
+			} break;
+			case JX64_RELOC_REL32:
+			case JX64_RELOC_REL32_1:
+			case JX64_RELOC_REL32_2:
+			case JX64_RELOC_REL32_3:
+			case JX64_RELOC_REL32_4:
+			case JX64_RELOC_REL32_5: {
+				int32_t inPlace;
+				jx_memcpy(&inPlace, patchAddr, sizeof(int32_t));
+				jx_memset(patchAddr, 0, sizeof(int32_t));
+
+				// NOTE: Branches to functions go through the PLT if the linker needs one, which is
+				// what compilers emit for calls. Code loads the address of undefined variables from 
+				// a slot (see jx64_finalize()); the GOT entry plays the role of that slot. Anything 
+				// else is a plain PC-relative reference.
+				const jx_x64_symbol_t* refSym = ctx->m_SymbolArr[refSymIndex];
+				const bool refSymIsUndefinedVar = true
+					&& refSym->m_Kind == JX64_SYMBOL_GLOBAL_VARIABLE
+					&& (refSym->m_ExternalAddr || refSym->m_Label->m_Offset == JX64_LABEL_OFFSET_UNBOUND)
+					;
+				const uint32_t type = refSym->m_Kind == JX64_SYMBOL_FUNCTION
+					? JX_ELF_R_X86_64_PLT32
+					: (refSymIsUndefinedVar ? JX_ELF_R_X86_64_GOTPCREL : JX_ELF_R_X86_64_PC32)
+					;
+				const uint32_t nextInstrOffset = 4 + (uint32_t)(reloc->m_Kind - JX64_RELOC_REL32);
+				rela->m_Info = JX_ELF_R_INFO(elfSymIndex[refSymIndex], type);
+				rela->m_Addend = (int64_t)inPlace - (int64_t)nextInstrOffset;
+			} break;
+			default:
+				// NOTE: Image relative (ADDR32NB) relocations are only used by Win64 unwind tables
+				// which are generated by jx64_finalize().
+				JX_CHECK(false, "Relocation kind not supported by ELF objects.");
+				JX_FREE(allocator, elfSymIndex);
+				JX_FREE(allocator, elf);
+				return NULL;
+			}
+		}
+	}
+
+	JX_FREE(allocator, elfSymIndex);
+
+	jx_memcpy(&elf[shstrtabOffset], kSectionNames, sizeof(kSectionNames));
+
+	jx_elf64_section_header_t* shdr = (jx_elf64_section_header_t*)&elf[shdrOffset];
+	for (uint32_t iSection = 0; iSection < JX64_ELF_OBJECT_SECTION_COUNT; ++iSection) {
+		shdr[iSection].m_Name = kSectionNameOffset[iSection];
+	}
+
+	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+		jx_elf64_section_header_t* secHdr = &shdr[JX64_ELF_OBJECT_SECTION_TEXT + iSection];
+		secHdr->m_Type = JX_ELF_SHT_PROGBITS;
+		secHdr->m_Flags = kSectionFlags[iSection];
+		secHdr->m_Offset = sectionOffset[iSection];
+		secHdr->m_Size = ctx->m_Section[iSection].m_Size;
+		secHdr->m_AddrAlign = jx_max_u32(ctx->m_Section[iSection].m_Alignment, 1);
+
+		jx_elf64_section_header_t* relaHdr = &shdr[JX64_ELF_OBJECT_SECTION_RELA_TEXT + iSection];
+		relaHdr->m_Type = JX_ELF_SHT_RELA;
+		relaHdr->m_Flags = JX_ELF_SHF_INFO_LINK;
+		relaHdr->m_Offset = relaOffset[iSection];
+		relaHdr->m_Size = numRelocs[iSection] * sizeof(jx_elf64_rela_t);
+		relaHdr->m_Link = JX64_ELF_OBJECT_SECTION_SYMTAB;
+		relaHdr->m_Info = JX64_ELF_OBJECT_SECTION_TEXT + iSection;
+		relaHdr->m_AddrAlign = 8;
+		relaHdr->m_EntrySize = sizeof(jx_elf64_rela_t);
+	}
+
+	jx_elf64_section_header_t* symtab = &shdr[JX64_ELF_OBJECT_SECTION_SYMTAB];
+	symtab->m_Type = JX_ELF_SHT_SYMTAB;
+	symtab->m_Offset = symtabOffset;
+	symtab->m_Size = (numSymbols + 1) * sizeof(jx_elf64_symbol_t);
+	symtab->m_Link = JX64_ELF_OBJECT_SECTION_STRTAB;
+	symtab->m_Info = firstGlobalSymbol; // Index of the first non-local symbol
+	symtab->m_AddrAlign = 8;
+	symtab->m_EntrySize = sizeof(jx_elf64_symbol_t);
+
+	jx_elf64_section_header_t* strtab = &shdr[JX64_ELF_OBJECT_SECTION_STRTAB];
+	strtab->m_Type = JX_ELF_SHT_STRTAB;
+	strtab->m_Offset = strtabOffset;
+	strtab->m_Size = strTabSize;
+	strtab->m_AddrAlign = 1;
+
+	jx_elf64_section_header_t* shstrtab = &shdr[JX64_ELF_OBJECT_SECTION_SHSTRTAB];
+	shstrtab->m_Type = JX_ELF_SHT_STRTAB;
+	shstrtab->m_Offset = shstrtabOffset;
+	shstrtab->m_Size = sizeof(kSectionNames);
+	shstrtab->m_AddrAlign = 1;
+
+	// NOTE: An empty .note.GNU-stack section marks the stack as non-executable.
+	jx_elf64_section_header_t* noteGNUStack = &shdr[JX64_ELF_OBJECT_SECTION_NOTE_GNU_STACK];
+	noteGNUStack->m_Type = JX_ELF_SHT_PROGBITS;
+	noteGNUStack->m_Offset = shstrtabOffset;
+	noteGNUStack->m_AddrAlign = 1;
+
+	*sz = imageSize;
+
+	return elf;
+}
+
 jx_x64_label_t* jx64_labelAlloc(jx_x64_context_t* ctx, jx_x64_section_kind section)
 {
 	jx_x64_label_t* lbl = (jx_x64_label_t*)JX_ALLOC(ctx->m_Allocator, sizeof(jx_x64_label_t));
@@ -398,6 +1014,16 @@ uint32_t jx64_labelGetOffset(jx_x64_context_t* ctx, jx_x64_label_t* lbl)
 	return (uint32_t)lbl->m_Offset;
 }
 
+uint32_t jx64_sectionGetSize(jx_x64_context_t* ctx, jx_x64_section_kind section)
+{
+	return ctx->m_Section[section].m_Size;
+}
+
+const uint8_t* jx64_sectionGetBuffer(jx_x64_context_t* ctx, jx_x64_section_kind section)
+{
+	return ctx->m_Section[section].m_Buffer;
+}
+
 jx_x64_symbol_t* jx64_globalVarDeclare(jx_x64_context_t* ctx, const char* name)
 {
 	jx_x64_symbol_t* gv = jx64_symbolAlloc(ctx, JX64_SYMBOL_GLOBAL_VARIABLE, name);
@@ -410,30 +1036,36 @@ jx_x64_symbol_t* jx64_globalVarDeclare(jx_x64_context_t* ctx, const char* name)
 	return gv;
 }
 
-bool jx64_globalVarDefine(jx_x64_context_t* ctx, jx_x64_symbol_t* gv, const uint8_t* data, uint32_t sz, uint32_t alignment)
+bool jx64_globalVarDefine(jx_x64_context_t* ctx, jx_x64_symbol_t* gv, jx_x64_section_kind section, const uint8_t* data, uint32_t sz, uint32_t alignment)
 {
 	if (gv->m_Kind != JX64_SYMBOL_GLOBAL_VARIABLE) {
 		JX_CHECK(false, "Expected global variable symbol.");
 		return false;
 	}
 
+	JX_CHECK(section == JX64_SECTION_RODATA || section == JX64_SECTION_DATA, "Global variables must be placed in a data section.");
 	JX_CHECK(jx_isPow2_u32(alignment), "Alignment expected to be a power of 2.");
 
-	const uint32_t curPos = ctx->m_Section[JX64_SECTION_DATA].m_Size;
+	ctx->m_Section[section].m_Alignment = jx_max_u32(ctx->m_Section[section].m_Alignment, alignment);
+
+	const uint32_t curPos = ctx->m_Section[section].m_Size;
 	const uint32_t alignedPos = ((curPos + (alignment - 1)) / alignment) * alignment;
 	const uint32_t alignmentSize = alignedPos - curPos;
 
 	if (alignmentSize) {
 		const uint8_t zeros[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 		JX_CHECK(alignmentSize <= JX_COUNTOF(zeros), "Need more zeroes!");
-		jx64_emitBytes(ctx, JX64_SECTION_DATA, zeros, alignmentSize);
+		jx64_emitBytes(ctx, section, zeros, alignmentSize);
 	}
 
+	// NOTE: Symbols are only referenced through relocations so the section of the 
+	// (still unbound) label can be changed.
+	gv->m_Label->m_Section = section;
 	jx64_labelBind(ctx, gv->m_Label);
 
 	gv->m_Size = sz;
 
-	return jx64_emitBytes(ctx, JX64_SECTION_DATA, data, sz);
+	return jx64_emitBytes(ctx, section, data, sz);
 }
 
 jx_x64_symbol_t* jx64_funcDeclare(jx_x64_context_t* ctx, const char* name)
@@ -459,9 +1091,24 @@ bool jx64_funcBegin(jx_x64_context_t* ctx, jx_x64_symbol_t* func)
 		return false;
 	}
 
+	// NOTE: Import stubs are emitted by jx64_finalize() after allocating the code buffer
+	// and are never patched.
+	const bool isPatchable = true
+		&& (ctx->m_Flags & JX64_CONTEXT_FLAGS_HOT_PATCH_Msk) != 0
+		&& !ctx->m_CodeBuffer.m_Buffer
+		;
+	if (isPatchable) {
+		jx64_alignText(ctx, JX64_HOT_PATCH_ENTRY_SIZE);
+	}
+
 	jx64_labelBind(ctx, func->m_Label);
 
 	ctx->m_CurFunc = func;
+	ctx->m_UpperYMMDirty = false; // NOTE: Callers are expected to enter functions with clean upper YMM state.
+
+	if (isPatchable) {
+		jx64_nop(ctx, JX64_HOT_PATCH_ENTRY_SIZE);
+	}
 
 	return true;
 }
@@ -477,6 +1124,11 @@ void jx64_funcEnd(jx_x64_context_t* ctx)
 
 	ctx->m_CurFunc = NULL;
 
+	// NOTE: Import stubs are emitted after the code buffer has been allocated; they are never cached.
+	if (ctx->m_CodeCache && func->m_Fingerprint != 0 && !ctx->m_CodeBuffer.m_Buffer) {
+		jx64_codeCacheStore(ctx, func);
+	}
+
 	// TODO: Patch all jumps inside the function body in order to turn them into 1-byte rel jumps
 	// and pad the rest of the function with nops in order to keep the other function addresses 
 	// intact.
@@ -484,515 +1136,757 @@ void jx64_funcEnd(jx_x64_context_t* ctx)
 	// their displacements if at least 1 of them changes
 }
 
-jx_x64_symbol_t* jx64_symbolGetByName(jx_x64_context_t* ctx, const char* name)
+void jx64_funcPrint(jx_x64_context_t* ctx, jx_x64_symbol_t* func, jx_string_buffer_t* sb)
 {
-	const uint32_t numSymbols = (uint32_t)jx_array_sizeu(ctx->m_SymbolArr);
-	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
-		jx_x64_symbol_t* sym = ctx->m_SymbolArr[iSym];
-		if (!jx_strcmp(sym->m_Name, name)) {
-			return sym;
-		}
+	const bool hasCode = true
+		&& func->m_Kind == JX64_SYMBOL_FUNCTION
+		&& !func->m_ExternalAddr
+		&& func->m_Label->m_Offset != JX64_LABEL_OFFSET_UNBOUND
+		&& func->m_Size != 0
+		;
+	if (!hasCode) {
+		return;
 	}
 
-	return NULL;
+	const uint8_t* code = &ctx->m_Section[JX64_SECTION_TEXT].m_Buffer[func->m_Label->m_Offset];
+	jx_strbuf_printf(sb, "%s:\n", func->m_Name);
+	jx64_disasmPrint(ctx->m_Allocator, code, func->m_Size, func->m_RelocArr, (uint32_t)jx_array_sizeu(func->m_RelocArr), sb);
+	jx_strbuf_pushCStr(sb, "\n");
 }
 
-void jx64_symbolAddRelocation(jx_x64_context_t* ctx, jx_x64_symbol_t* sym, jx_x64_relocation_kind kind, uint32_t offset, const char* symbolName)
+void jx64_print(jx_x64_context_t* ctx, jx_string_buffer_t* sb)
 {
-	jx_array_push_back(sym->m_RelocArr, (jx_x64_relocation_t){
-		.m_Kind = kind,
-		.m_Offset = offset,
-		.m_SymbolName = jx_strdup(symbolName, ctx->m_Allocator)
-	});
+	const uint32_t numSymbols = (uint32_t)jx_array_sizeu(ctx->m_SymbolArr);
+	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
+		jx64_funcPrint(ctx, ctx->m_SymbolArr[iSym], sb);
+	}
 }
 
-bool jx64_symbolSetExternalAddress(jx_x64_context_t* ctx, jx_x64_symbol_t* sym, void* ptr)
+bool jx64_funcHotPatch(jx_x64_context_t* ctx, jx_x64_symbol_t* func, const void* newAddr)
 {
-	sym->m_Label->m_Offset = (uint64_t)ptr;
-	return true;
-}
+	const bool isPatchable = true
+		&& (ctx->m_Flags & JX64_CONTEXT_FLAGS_HOT_PATCH_Msk) != 0
+		&& func->m_Kind == JX64_SYMBOL_FUNCTION
+		&& !func->m_ExternalAddr
+		&& func->m_Size >= JX64_HOT_PATCH_ENTRY_SIZE
+		;
+	uint8_t* entry = isPatchable
+		? (uint8_t*)jx64_symbolGetAddress(ctx, func)
+		: NULL
+		;
+	if (!entry) {
+		return false;
+	}
 
-bool jx64_emitBytes(jx_x64_context_t* ctx, jx_x64_section_kind section, const uint8_t* bytes, uint32_t n)
-{
-	jx_x64_section_t* sec = &ctx->m_Section[section];
-	if (sec->m_Size + n > sec->m_Capacity) {
-		const uint32_t oldCapacity = sec->m_Capacity;
-		const uint32_t newCapacity = oldCapacity + jx_max_u32(n, 256);
+	JX_CHECK(((uintptr_t)entry & (JX64_HOT_PATCH_ENTRY_SIZE - 1)) == 0, "Patchable entry must be aligned.");
 
-		uint8_t* newBuffer = (uint8_t*)JX_ALLOC(ctx->m_Allocator, newCapacity);
-		if (!newBuffer) {
+	// Either the original nop or a jmp rel32 padded with a nop.
+	uint8_t patch[JX64_HOT_PATCH_ENTRY_SIZE] = { 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 };
+	if (newAddr) {
+		const int64_t disp = (int64_t)((intptr_t)newAddr - (intptr_t)(entry + 5));
+		if (disp < INT32_MIN || disp > INT32_MAX) {
 			return false;
 		}
 
-		jx_memcpy(newBuffer, sec->m_Buffer, oldCapacity);
-		jx_memset(&newBuffer[oldCapacity], 0, newCapacity - oldCapacity);
+		const int32_t disp32 = (int32_t)disp;
+		patch[0] = 0xE9;
+		jx_memcpy(&patch[1], &disp32, sizeof(int32_t));
+		patch[5] = 0x0F;
+		patch[6] = 0x1F;
+		patch[7] = 0x00;
+	}
+
+	// NOTE: Code heap pages are patched through their read/write alias and never change 
+	// protection. A stand-alone buffer's page must stay executable because other threads 
+	// might be running code in it. It's writable only for the duration of the store. 
+	// Concurrent patches of functions in the same page would otherwise restore RX while 
+	// another thread is still writing, so the whole unprotect/store/protect sequence is 
+	// serialized.
+	jx_os_mutexLock(ctx->m_HotPatchMutex);
+
+	jx_x64_code_heap_arena_t* arena = ctx->m_CodeHeap
+		? jx64_codeHeapFindArena(ctx->m_CodeHeap, entry)
+		: NULL
+		;
+	const uint32_t pageSize = jx_os_vmemGetPageSize();
+	uint8_t* page = (uint8_t*)((uintptr_t)entry & ~((uintptr_t)pageSize - 1));
+	uint8_t* entryWrite = NULL;
+	if (arena) {
+		entryWrite = jx64_codeHeapArenaBeginWrite(arena, entry, JX64_HOT_PATCH_ENTRY_SIZE);
+	} else if (jx_os_vmemProtect(page, pageSize, JX_VMEM_PROTECT_READ_Msk | JX_VMEM_PROTECT_WRITE_Msk | JX_VMEM_PROTECT_EXEC_Msk)) {
+		entryWrite = entry;
+	}
 
-		JX_FREE(ctx->m_Allocator, sec->m_Buffer);
-		sec->m_Buffer = newBuffer;
-		sec->m_Capacity = newCapacity;
+	if (!entryWrite) {
+		jx_os_mutexUnlock(ctx->m_HotPatchMutex);
+		return false;
 	}
 
-	jx_memcpy(&sec->m_Buffer[sec->m_Size], bytes, n);
-	sec->m_Size += n;
+	// NOTE: An aligned 8-byte store is atomic so other threads either execute the old or 
+	// the new entry, never a mix of both. x64 keeps instruction fetches coherent with 
+	// stores from the same process.
+	uint64_t newEntry = 0;
+	jx_memcpy(&newEntry, patch, sizeof(uint64_t));
+	volatile uint64_t* entryPtr = (volatile uint64_t*)entryWrite;
+	uint64_t oldEntry = *entryPtr;
+	while (jx_atomic_cmpSwap_u64(entryPtr, newEntry, oldEntry) != oldEntry) {
+		oldEntry = *entryPtr;
+	}
+
+	const bool reprotected = arena
+		? jx64_codeHeapArenaEndWrite(arena, entry, JX64_HOT_PATCH_ENTRY_SIZE)
+		: jx_os_vmemProtect(page, pageSize, JX_VMEM_PROTECT_READ_Msk | JX_VMEM_PROTECT_EXEC_Msk)
+		;
+
+	jx_os_mutexUnlock(ctx->m_HotPatchMutex);
+
+	if (!reprotected) {
+		JX_CHECK(false, "Failed to restore code page protection.");
+		return false;
+	}
 
 	return true;
 }
 
-bool jx64_retn(jx_x64_context_t* ctx)
+jx_x64_code_cache_t* jx64_codeCacheCreate(jx_allocator_i* allocator)
 {
-	const uint8_t instr[] = { 0xC3 };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+	jx_x64_code_cache_t* cache = (jx_x64_code_cache_t*)JX_ALLOC(allocator, sizeof(jx_x64_code_cache_t));
+	if (!cache) {
+		return NULL;
+	}
+
+	jx_memset(cache, 0, sizeof(jx_x64_code_cache_t));
+	cache->m_Allocator = allocator;
+	cache->m_EntryArr = (jx_x64_code_cache_entry_t*)jx_array_create(allocator);
+	if (!cache->m_EntryArr) {
+		jx64_codeCacheDestroy(cache);
+		return NULL;
+	}
+
+	return cache;
 }
 
-bool jx64_mov(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+void jx64_codeCacheDestroy(jx_x64_code_cache_t* cache)
 {
-	if (dst.m_Type == JX64_OPERAND_SYM && src.m_Type == JX64_OPERAND_SYM) {
-		JX_CHECK(false, "Invalid operands.");
-		return false;
-	}
+	jx_allocator_i* allocator = cache->m_Allocator;
 
-	jx_x64_symbol_t* sym = NULL;
-	if (src.m_Type == JX64_OPERAND_SYM) {
-		sym = src.u.m_Sym;
-		src = jx64_opMem(src.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, 0);
-	} else if (dst.m_Type == JX64_OPERAND_SYM) {
-		sym = dst.u.m_Sym;
-		dst = jx64_opMem(dst.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, 0);
-	}
-
-	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
-	if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_IMM) {
-		if (!jx64_mov_reg_imm(enc, dst.u.m_Reg, src.u.m_ImmI64, src.m_Size)) {
-			return false;
-		}
-	} else if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_REG) {
-		if (!jx64_math_binary_op_reg_reg(enc, 0x88, dst.u.m_Reg, src.u.m_Reg)) {
-			return false;
-		}
-	} else if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_MEM) {
-		if (!jx64_math_binary_op_reg_mem(enc, 0x88, 1, dst.u.m_Reg, &src.u.m_Mem)) {
-			return false;
-		}
-	} else if (dst.m_Type == JX64_OPERAND_MEM && src.m_Type == JX64_OPERAND_IMM) {
-		if (!jx64_mov_mem_imm(enc, &dst.u.m_Mem, src.u.m_ImmI64, src.m_Size)) {
-			return false;
-		}
-	} else if (dst.m_Type == JX64_OPERAND_MEM && src.m_Type == JX64_OPERAND_REG) {
-		if (!jx64_math_binary_op_reg_mem(enc, 0x88, 0, src.u.m_Reg, &dst.u.m_Mem)) {
-			return false;
-		}
-	} else {
-		JX_CHECK(false, "Invalid operands?");
-		return false;
+	const uint32_t numEntries = (uint32_t)jx_array_sizeu(cache->m_EntryArr);
+	for (uint32_t iEntry = 0; iEntry < numEntries; ++iEntry) {
+		jx64_codeCacheEntryFree(cache, &cache->m_EntryArr[iEntry]);
 	}
+	jx_array_free(cache->m_EntryArr);
+	JX_FREE(allocator, cache);
+}
 
-	if (sym) {
-		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
-		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
+bool jx64_codeCacheContains(jx_x64_code_cache_t* cache, const char* funcName, uint64_t fingerprint)
+{
+	const jx_x64_code_cache_entry_t* entry = jx64_codeCacheFind(cache, funcName);
+	return true
+		&& entry
+		&& fingerprint != 0
+		&& entry->m_Fingerprint == fingerprint
+		;
+}
 
-		const uint32_t relocDelta = (instrSize - dispOffset) - sizeof(int32_t);
-		JX_CHECK(relocDelta <= 5, "Invalid relocation type");
-		const uint32_t curFuncOffset = (uint32_t)ctx->m_CurFunc->m_Label->m_Offset;
-		const uint32_t relocOffset = ctx->m_Section[JX64_SECTION_TEXT].m_Size - curFuncOffset + dispOffset;
-		jx64_symbolAddRelocation(ctx, ctx->m_CurFunc, JX64_RELOC_REL32 + relocDelta, relocOffset, sym->m_Name);
+void jx64_setCodeCache(jx_x64_context_t* ctx, jx_x64_code_cache_t* cache)
+{
+	ctx->m_CodeCache = cache;
+	if (!cache) {
+		return;
 	}
 
-	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
-	if (!jx64_encodeInstr(instr, enc)) {
-		return false;
-	}
+	// NOTE: Code generated with a different function entry layout cannot be reused. The IR/MIR 
+	// pipelines are part of the function fingerprints (see jx_mir_funcGetFingerprint()).
+	const uint32_t contextFlags = ctx->m_Flags & JX64_CONTEXT_FLAGS_HOT_PATCH_Msk;
+	if (cache->m_ContextFlags != contextFlags) {
+		const uint32_t numEntries = (uint32_t)jx_array_sizeu(cache->m_EntryArr);
+		for (uint32_t iEntry = 0; iEntry < numEntries; ++iEntry) {
+			jx64_codeCacheEntryFree(cache, &cache->m_EntryArr[iEntry]);
+		}
+		jx_array_resize(cache->m_EntryArr, 0);
 
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+		cache->m_ContextFlags = contextFlags;
+	}
 }
 
-bool jx64_movsx(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_funcEmitCached(jx_x64_context_t* ctx, jx_x64_symbol_t* func, uint64_t fingerprint)
 {
-	const bool invalidOperands = false
-		|| dst.m_Type != JX64_OPERAND_REG // Destination operand should always be a register
-		|| dst.m_Size <= src.m_Size
+	const jx_x64_code_cache_entry_t* entry = ctx->m_CodeCache
+		? jx64_codeCacheFind(ctx->m_CodeCache, func->m_Name)
+		: NULL
 		;
-	if (invalidOperands) {
-		JX_CHECK(false, "Invalid operands.");
+	if (!entry || fingerprint == 0 || entry->m_Fingerprint != fingerprint) {
 		return false;
 	}
 
-	jx_x64_symbol_t* sym = NULL;
-	if (src.m_Type == JX64_OPERAND_SYM) {
-		sym = src.u.m_Sym;
-		src = jx64_opMem(src.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, 0);
-	}
-
-	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
-	if (src.m_Type == JX64_OPERAND_REG) {
-		if (!jx64_movsx_reg_reg(enc, dst.u.m_Reg, src.u.m_Reg)) {
-			return false;
+	// Recreate constants (and declare helper functions) which are generated on demand
+	// while emitting code and would otherwise be missing.
+	const uint32_t numRelocs = (uint32_t)jx_array_sizeu(entry->m_RelocArr);
+	for (uint32_t iReloc = 0; iReloc < numRelocs; ++iReloc) {
+		const jx_x64_code_cache_reloc_t* cachedReloc = &entry->m_RelocArr[iReloc];
+		const char* symName = cachedReloc->m_Reloc.m_SymbolName;
+		if (jx64_symbolGetByName(ctx, symName)) {
+			continue;
 		}
-	} else if (src.m_Type == JX64_OPERAND_MEM) {
-//		JX_CHECK(false, "Untested code below! If this assert hits check if it's correct. Otherwise implemement jx64_movsx_reg_mem.");
-		if (src.m_Size == JX64_SIZE_8) {
-			const uint8_t opcode[] = { 0x0F, 0xBE };
-			if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
-				return false;
-			}
-		} else if (src.m_Size == JX64_SIZE_16) {
-			const uint8_t opcode[] = { 0x0F, 0xBF };
-			if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
+
+		if (cachedReloc->m_SymbolKind == JX64_SYMBOL_FUNCTION) {
+			if (!jx64_funcDeclare(ctx, symName)) {
 				return false;
 			}
-		} else if (src.m_Size == JX64_SIZE_32) {
-			if (!jx64_math_binary_op_reg_mem(enc, 0x60, 1, dst.u.m_Reg, &src.u.m_Mem)) {
+		} else if (cachedReloc->m_ConstSize != 0) {
+			jx_x64_symbol_t* gv = jx64_globalVarDeclare(ctx, symName);
+			if (!gv || !jx64_globalVarDefine(ctx, gv, JX64_SECTION_RODATA, cachedReloc->m_ConstData, cachedReloc->m_ConstSize, cachedReloc->m_ConstAlignment)) {
 				return false;
 			}
+
+			gv->m_Flags |= JX64_SYMBOL_FLAGS_LOCAL_Msk;
+		} else {
+			JX_CHECK(false, "Cached code references an undeclared global variable.");
+			return false;
 		}
-	} else {
-		JX_CHECK(false, "Invalid operands?");
+	}
+
+	if (!jx64_funcBegin(ctx, func)) {
 		return false;
 	}
 
-	if (sym) {
-		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
-		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
+	// NOTE: The cached code includes everything jx64_funcBegin() emits (e.g. the patchable entry).
+	const uint32_t prefixSize = ctx->m_Section[JX64_SECTION_TEXT].m_Size - (uint32_t)func->m_Label->m_Offset;
+	JX_CHECK(prefixSize <= entry->m_Size, "Cached function entry mismatch.");
+	if (!jx64_emitBytes(ctx, JX64_SECTION_TEXT, &entry->m_Code[prefixSize], entry->m_Size - prefixSize)) {
+		ctx->m_CurFunc = NULL;
+		return false;
+	}
 
-		const uint32_t relocDelta = (instrSize - dispOffset) - sizeof(int32_t);
-		JX_CHECK(relocDelta <= 5, "Invalid relocation type");
-		const uint32_t curFuncOffset = (uint32_t)ctx->m_CurFunc->m_Label->m_Offset;
-		const uint32_t relocOffset = ctx->m_Section[JX64_SECTION_TEXT].m_Size - curFuncOffset + dispOffset;
-		jx64_symbolAddRelocation(ctx, ctx->m_CurFunc, JX64_RELOC_REL32 + relocDelta, relocOffset, sym->m_Name);
+	for (uint32_t iReloc = 0; iReloc < numRelocs; ++iReloc) {
+		const jx_x64_relocation_t* reloc = &entry->m_RelocArr[iReloc].m_Reloc;
+		jx64_symbolAddRelocation(ctx, func, reloc->m_Kind, reloc->m_Offset, reloc->m_SymbolName);
 	}
 
-	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
-	if (!jx64_encodeInstr(instr, enc)) {
-		return false;
+	if (entry->m_UnwindRegionArr) {
+		const uint32_t numRegions = (uint32_t)jx_array_sizeu(entry->m_UnwindRegionArr);
+		const uint32_t numOps = (uint32_t)jx_array_sizeu(entry->m_UnwindOpArr);
+		if (!jx64_unwindInitFunc(ctx, func)) {
+			ctx->m_CurFunc = NULL;
+			return false;
+		}
+
+		jx_array_resize(func->m_UnwindRegionArr, numRegions);
+		jx_array_resize(func->m_UnwindOpArr, numOps);
+		jx_memcpy(func->m_UnwindRegionArr, entry->m_UnwindRegionArr, sizeof(jx_x64_unwind_region_t) * numRegions);
+		jx_memcpy(func->m_UnwindOpArr, entry->m_UnwindOpArr, sizeof(jx_x64_unwind_op_t) * numOps);
 	}
 
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+	func->m_Fingerprint = fingerprint;
+	jx64_funcEnd(ctx);
+
+	return true;
 }
 
-bool jx64_movzx(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+jx_x64_code_heap_t* jx64_codeHeapCreate(jx_allocator_i* allocator, uint32_t codeSize, uint32_t rodataSize, uint32_t dataSize, uint32_t flags)
 {
-	const bool invalidOperands = false
-		|| dst.m_Type != JX64_OPERAND_REG // Destination operand should always be a register
-		|| dst.m_Size < src.m_Size
-		;
-	if (invalidOperands) {
-		JX_CHECK(false, "Invalid operands.");
-		return false;
+	if (codeSize == 0) {
+		return NULL;
 	}
 
-	if (dst.m_Size == JX64_SIZE_64 && src.m_Size == JX64_SIZE_32) {
-		if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_REG && JX64_REG_GET_ID(dst.u.m_Reg) == JX64_REG_GET_ID(src.u.m_Reg)) {
-			// No-op.
-			return true;
-		} else {
-			// movzx reg64, reg32 is actually a mov reg64d, reg32
-			// The upper part of the 64-bit register is implicitly zeroed whenever 
-			// the lower 32-bit part is written.
-			dst.m_Size = JX64_SIZE_32;
-			dst.u.m_Reg = JX64_REG(JX64_REG_GET_ID(dst.u.m_Reg), 0, JX64_SIZE_32);
-			return jx64_mov(ctx, dst, src);
-		}
+	jx_x64_code_heap_t* heap = (jx_x64_code_heap_t*)JX_ALLOC(allocator, sizeof(jx_x64_code_heap_t));
+	if (!heap) {
+		return NULL;
 	}
 
-	jx_x64_symbol_t* sym = NULL;
-	if (src.m_Type == JX64_OPERAND_SYM) {
-		sym = src.u.m_Sym;
-		src = jx64_opMem(src.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, 0);
+	jx_memset(heap, 0, sizeof(jx_x64_code_heap_t));
+	heap->m_Allocator = allocator;
+	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+		jx_x64_code_heap_arena_t* arena = &heap->m_Arena[iSection];
+		arena->m_AllocArr = (jx_x64_code_heap_block_t*)jx_array_create(allocator);
+		if (!arena->m_AllocArr) {
+			jx64_codeHeapDestroy(heap);
+			return NULL;
+		}
+
+		for (uint32_t iClass = 0; iClass < JX64_CODE_HEAP_NUM_SIZE_CLASSES; ++iClass) {
+			arena->m_FreeListArr[iClass] = (jx_x64_code_heap_block_t*)jx_array_create(allocator);
+			if (!arena->m_FreeListArr[iClass]) {
+				jx64_codeHeapDestroy(heap);
+				return NULL;
+			}
+		}
 	}
 
-	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+	const uint32_t pageSize = jx_os_vmemGetPageSize();
+	const uint32_t codeProtectFlags = JX_VMEM_PROTECT_READ_Msk | JX_VMEM_PROTECT_EXEC_Msk;
 
-	if (src.m_Type == JX64_OPERAND_REG) {
-		if (!jx64_movzx_reg_reg(enc, dst.u.m_Reg, src.u.m_Reg)) {
-			return false;
-		}
-	} else if (src.m_Type == JX64_OPERAND_MEM) {
-//		JX_CHECK(false, "Untested code below! If this assert hits check if it's correct. Otherwise implemement jx64_movzx_reg_mem.");
-		if (src.m_Size == JX64_SIZE_8) {
-			const uint8_t opcode[] = { 0x0F, 0xB6 };
-			if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
-				return false;
-			}
-		} else if (src.m_Size == JX64_SIZE_16) {
-			const uint8_t opcode[] = { 0x0F, 0xB7 };
-			if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
-				return false;
+	// NOTE: Large pages cannot be partially reprotected or aliased so the whole arena is mapped 
+	// RWX. That's why they are opt-in.
+	const size_t largePageSize = (flags & JX64_CODE_HEAP_FLAGS_LARGE_PAGES_Msk) != 0
+		? jx_os_vmemGetLargePageSize()
+		: 0
+		;
+	if (largePageSize != 0) {
+		const uint64_t codeMemSize = (((uint64_t)codeSize + largePageSize - 1) / largePageSize) * largePageSize;
+		if (codeMemSize <= INT32_MAX) {
+			heap->m_CodeMem = (uint8_t*)jx_os_vmemAllocLargePages(NULL, codeMemSize, codeProtectFlags | JX_VMEM_PROTECT_WRITE_Msk);
+			if (heap->m_CodeMem) {
+				heap->m_CodeMemSize = codeMemSize;
+				heap->m_PageSize = (uint32_t)largePageSize;
+				heap->m_LargePages = true;
 			}
-		} else if (src.m_Size == JX64_SIZE_32) {
-			JX_NOT_IMPLEMENTED();
 		}
-	} else {
-		JX_CHECK(false, "Invalid operands?");
-		return false;
 	}
 
-	if (sym) {
-		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
-		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
+	// NOTE: Host functions called by JIT code usually live in the same module as the 
+	// compiler so try to keep the code within rel32 range from it.
+	// Normal pages are mapped RX and written through a separate RW view of the same memory.
+	// Other contexts can keep running code from the heap while new code is written into it.
+	if (!heap->m_CodeMem) {
+		const uintptr_t hostAddr = (uintptr_t)&jx64_codeHeapCreate;
+		heap->m_CodeMemSize = jx_roundup_u32(codeSize, pageSize);
+		heap->m_CodeMem = jx64_codeBufferAllocNear(heap->m_CodeMemSize, hostAddr, hostAddr, &heap->m_CodeMemAlias);
+		heap->m_PageSize = pageSize;
+		if (!heap->m_CodeMem) {
+			jx64_codeHeapDestroy(heap);
+			return NULL;
+		}
+	}
 
-		const uint32_t relocDelta = (instrSize - dispOffset) - sizeof(int32_t);
-		JX_CHECK(relocDelta <= 5, "Invalid relocation type");
-		const uint32_t curFuncOffset = (uint32_t)ctx->m_CurFunc->m_Label->m_Offset;
-		const uint32_t relocOffset = ctx->m_Section[JX64_SECTION_TEXT].m_Size - curFuncOffset + dispOffset;
-		jx64_symbolAddRelocation(ctx, ctx->m_CurFunc, JX64_RELOC_REL32 + relocDelta, relocOffset, sym->m_Name);
+	const uint32_t rodataMemSize = jx_roundup_u32(rodataSize, pageSize);
+	const uint32_t dataMemSize = jx_roundup_u32(dataSize, pageSize);
+	heap->m_DataMemSize = (uint64_t)rodataMemSize + (uint64_t)dataMemSize;
+	if (heap->m_DataMemSize != 0) {
+		const uintptr_t codeBegin = (uintptr_t)heap->m_CodeMem;
+		const uintptr_t codeEnd = codeBegin + (uintptr_t)heap->m_CodeMemSize - 1;
+		heap->m_DataMem = jx64_codeBufferAllocNear(heap->m_DataMemSize, codeBegin, codeEnd, NULL);
+		if (!heap->m_DataMem) {
+			jx64_codeHeapDestroy(heap);
+			return NULL;
+		}
+
+		if (rodataMemSize != 0 && !jx_os_vmemProtect(heap->m_DataMem, rodataMemSize, JX_VMEM_PROTECT_READ_Msk)) {
+			jx64_codeHeapDestroy(heap);
+			return NULL;
+		}
 	}
 
-	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
-	if (!jx64_encodeInstr(instr, enc)) {
-		return false;
+	// All arenas must be reachable from each other with rel32 displacements and
+	// image relative (ADDR32NB) offsets.
+	const uint8_t* heapBegin = heap->m_CodeMem;
+	const uint8_t* heapEnd = heap->m_CodeMem + heap->m_CodeMemSize;
+	if (heap->m_DataMem) {
+		heapBegin = heap->m_DataMem < heapBegin
+			? heap->m_DataMem
+			: heapBegin
+			;
+		heapEnd = heap->m_DataMem + heap->m_DataMemSize > heapEnd
+			? heap->m_DataMem + heap->m_DataMemSize
+			: heapEnd
+			;
 	}
 
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+	if ((uint64_t)(heapEnd - heapBegin) > INT32_MAX) {
+		jx64_codeHeapDestroy(heap);
+		return NULL;
+	}
+
+	heap->m_ImageBase = heapBegin;
+	heap->m_ImageSize = (uint64_t)(heapEnd - heapBegin);
+
+	uint8_t* dataArenaMem = heap->m_DataMem
+		? &heap->m_DataMem[rodataMemSize]
+		: NULL
+		;
+	uint8_t* codeWriteBase = heap->m_LargePages
+		? heap->m_CodeMem
+		: heap->m_CodeMemAlias
+		;
+	jx64_codeHeapArenaInit(&heap->m_Arena[JX64_SECTION_TEXT], heap->m_CodeMem, (uint32_t)heap->m_CodeMemSize, codeProtectFlags, codeWriteBase);
+	jx64_codeHeapArenaInit(&heap->m_Arena[JX64_SECTION_RODATA], heap->m_DataMem, rodataMemSize, JX_VMEM_PROTECT_READ_Msk, NULL);
+	jx64_codeHeapArenaInit(&heap->m_Arena[JX64_SECTION_DATA], dataArenaMem, dataMemSize, JX_VMEM_PROTECT_READ_Msk | JX_VMEM_PROTECT_WRITE_Msk, dataArenaMem);
+
+	return heap;
 }
 
-bool jx64_nop(jx_x64_context_t* ctx, uint32_t n)
+void jx64_codeHeapDestroy(jx_x64_code_heap_t* heap)
 {
-	if (n == 0) {
-		return false;
-	}
-
-	static const uint8_t kNops[10][9] = {
-		{ 0 },                                                    // Invalid
-		{ 0x90 },                                                 // NOP
-		{ 0x66, 0x90 },                                           // 0x66 NOP
-		{ 0x0F, 0x1F, 0x00 },                                     // NOP dword ptr [EAX]
-		{ 0x0F, 0x1F, 0x40, 0x00 },                               // NOP dword ptr [EAX + 0x00]
-		{ 0x0F, 0x1F, 0x44, 0x00, 0x00 },                         // NOP dword ptr [EAX + EAX * 1 + 0x00]
-		{ 0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00 },                   // 66 NOP dword ptr [EAX + EAX * 1 + 0x00]
-		{ 0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00 },             // NOP dword ptr [EAX + 0x00000000]
-		{ 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },       // NOP dword ptr [EAX + EAX * 1 + 0x00000000]
-		{ 0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 66 NOP dword ptr [EAX + EAX * 1 + 0x00000000]
-	};
+	jx_allocator_i* allocator = heap->m_Allocator;
 
-	while (n > 9) {
-		jx64_emitBytes(ctx, JX64_SECTION_TEXT, &kNops[9][0], 9);
-		n -= 9;
+	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+		jx_x64_code_heap_arena_t* arena = &heap->m_Arena[iSection];
+		JX_CHECK(jx_array_sizeu(arena->m_AllocArr) == 0, "Code heap destroyed while still in use.");
+		jx_array_free(arena->m_AllocArr);
+		for (uint32_t iClass = 0; iClass < JX64_CODE_HEAP_NUM_SIZE_CLASSES; ++iClass) {
+			jx_array_free(arena->m_FreeListArr[iClass]);
+		}
 	}
 
-	jx64_emitBytes(ctx, JX64_SECTION_TEXT, &kNops[n][0], n);
+	if (heap->m_CodeMemAlias) {
+		jx_os_vmemFreeAliased(heap->m_CodeMem, heap->m_CodeMemAlias, heap->m_CodeMemSize);
+	} else if (heap->m_CodeMem) {
+		jx_os_vmemFree(heap->m_CodeMem, heap->m_CodeMemSize);
+	}
+	if (heap->m_DataMem) {
+		jx_os_vmemFree(heap->m_DataMem, heap->m_DataMemSize);
+	}
 
-	return true;
+	JX_FREE(allocator, heap);
 }
 
-bool jx64_push(jx_x64_context_t* ctx, jx_x64_operand_t op)
+uint8_t* jx64_codeHeapAlloc(jx_x64_code_heap_t* heap, jx_x64_section_kind section, uint32_t size, bool isCold)
 {
-	JX_CHECK(op.m_Type != JX64_OPERAND_SYM, "TODO");
-	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t){ 0 };
-	
-#if 0
-	jx_x64_label_t* lbl = NULL;
-	if (op.m_Type == JX64_OPERAND_LBL) {
-		lbl = op.u.m_Lbl;
-		const int32_t diff = lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND
-			? 0
-			: (int32_t)lbl->m_Offset - (int32_t)ctx->m_Size
-			;
-		op = jx64_opMem(op.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, diff);
+	jx_x64_code_heap_arena_t* arena = &heap->m_Arena[section];
+	if (size == 0) {
+		return NULL;
 	}
-#endif
 
-	if (op.m_Type == JX64_OPERAND_IMM) {
-		const bool invalidOperand = false
-			|| op.m_Size == JX64_SIZE_64 // Cannot push 64-bit immediate
-			;
-		if (invalidOperand) {
-			JX_CHECK(false, "Invalid operands.");
-			return false;
-		}
+	const uint32_t blockSize = jx_roundup_u32(size, JX64_CODE_HEAP_BLOCK_SIZE);
+	if (!arena->m_Base || blockSize < size) {
+		arena->m_NumFailedAllocs++;
+		return NULL;
+	}
 
-		jx64_instrEnc_opcode1(enc, 0x68 | (op.m_Size == JX64_SIZE_8 ? 0b10 : 0));
-		jx64_instrEnc_imm(enc, true, (op.m_Size == JX64_SIZE_8) ? JX64_SIZE_8 : JX64_SIZE_32, op.u.m_ImmI64);
-	} else if (op.m_Type == JX64_OPERAND_REG) {
-		// 0x50+ r
-		if (!jx64_stack_op_reg(enc, 0x50, op.u.m_Reg)) {
-			return false;
+	// Reuse a freed block from the smallest size class which has one big enough. Hot
+	// allocations prefer the lowest block and cold allocations the highest one.
+	jx_x64_code_heap_block_t* freeList = NULL;
+	uint32_t freeBlockID = UINT32_MAX;
+	for (uint32_t iClass = jx64_codeHeapGetSizeClass(blockSize); iClass < JX64_CODE_HEAP_NUM_SIZE_CLASSES && freeBlockID == UINT32_MAX; ++iClass) {
+		freeList = arena->m_FreeListArr[iClass];
+		const uint32_t numBlocks = (uint32_t)jx_array_sizeu(freeList);
+		for (uint32_t iBlock = 0; iBlock < numBlocks; ++iBlock) {
+			const jx_x64_code_heap_block_t* block = &freeList[iBlock];
+			if (block->m_Size < blockSize) {
+				continue;
+			}
+
+			const bool isBetter = false
+				|| freeBlockID == UINT32_MAX
+				|| (isCold && block->m_Offset > freeList[freeBlockID].m_Offset)
+				|| (!isCold && block->m_Offset < freeList[freeBlockID].m_Offset)
+				;
+			if (isBetter) {
+				freeBlockID = iBlock;
+			}
 		}
-	} else if (op.m_Type == JX64_OPERAND_MEM) {
-		// FF /6
-		if (!jx64_stack_op_mem(enc, 0xFF, 0b110, &op.u.m_Mem, op.m_Size)) {
-			return false;
+	}
+
+	uint32_t offset = 0;
+	if (freeBlockID != UINT32_MAX) {
+		const jx_x64_code_heap_block_t block = freeList[freeBlockID];
+		jx_array_del(freeList, freeBlockID);
+
+		const uint32_t remainingSize = block.m_Size - blockSize;
+		offset = isCold
+			? block.m_Offset + remainingSize
+			: block.m_Offset
+			;
+		if (remainingSize != 0) {
+			const uint32_t remainingOffset = isCold
+				? block.m_Offset
+				: block.m_Offset + blockSize
+				;
+			jx64_codeHeapArenaAddFreeBlock(arena, remainingOffset, remainingSize);
 		}
 	} else {
-		JX_CHECK(false, "Invalid operands.");
-		return false;
-	}
+		if (arena->m_ColdBottom - arena->m_HotTop < blockSize) {
+			arena->m_NumFailedAllocs++;
+			return NULL;
+		}
 
-#if 0
-	if (lbl && lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
-		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
-		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
-		jx_array_push_back(lbl->m_RefsArr, (jx_x64_label_ref_t) { .m_DispOffset = ctx->m_Size + dispOffset, .m_NextInstrOffset = ctx->m_Size + instrSize });
+		if (isCold) {
+			arena->m_ColdBottom -= blockSize;
+			offset = arena->m_ColdBottom;
+		} else {
+			offset = arena->m_HotTop;
+			arena->m_HotTop += blockSize;
+		}
 	}
-#endif
 
-	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t){ 0 };
-	if (!jx64_encodeInstr(instr, enc)) {
-		return false;
-	}
+	jx_array_push_back(arena->m_AllocArr, (jx_x64_code_heap_block_t){ .m_Offset = offset, .m_Size = blockSize });
+	arena->m_UsedSize += blockSize;
+	arena->m_NumAllocs++;
 
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+	return &arena->m_Base[offset];
 }
 
-bool jx64_pop(jx_x64_context_t* ctx, jx_x64_operand_t op)
+void jx64_codeHeapFree(jx_x64_code_heap_t* heap, uint8_t* ptr)
 {
-	JX_CHECK(op.m_Type != JX64_OPERAND_SYM, "TODO");
-	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t){ 0 };
-
-#if 0
-	jx_x64_label_t* lbl = NULL;
-	if (op.m_Type == JX64_OPERAND_LBL) {
-		lbl = op.u.m_Lbl;
-		const int32_t diff = lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND
-			? 0
-			: (int32_t)lbl->m_Offset - (int32_t)ctx->m_Size
-			;
-		op = jx64_opMem(op.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, diff);
+	jx_x64_code_heap_arena_t* arena = jx64_codeHeapFindArena(heap, ptr);
+	if (!arena) {
+		JX_CHECK(false, "Pointer not allocated from this code heap.");
+		return;
 	}
-#endif
 
-	if (op.m_Type == JX64_OPERAND_REG) {
-		// 0x58+ r
-		if (!jx64_stack_op_reg(enc, 0x58, op.u.m_Reg)) {
-			return false;
-		}
-	} else if (op.m_Type == JX64_OPERAND_MEM) {
-		// 0x8F /0
-		if (!jx64_stack_op_mem(enc, 0x8F, 0b000, &op.u.m_Mem, op.m_Size)) {
-			return false;
+	const uint32_t offset = (uint32_t)(ptr - arena->m_Base);
+	const uint32_t numAllocs = (uint32_t)jx_array_sizeu(arena->m_AllocArr);
+	uint32_t allocID = UINT32_MAX;
+	for (uint32_t iAlloc = 0; iAlloc < numAllocs; ++iAlloc) {
+		if (arena->m_AllocArr[iAlloc].m_Offset == offset) {
+			allocID = iAlloc;
+			break;
 		}
-	} else {
-		JX_CHECK(false, "Invalid operands?");
-		return false;
 	}
 
-#if 0
-	if (lbl && lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
-		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
-		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
-		jx_array_push_back(lbl->m_RefsArr, (jx_x64_label_ref_t) { .m_DispOffset = ctx->m_Size + dispOffset, .m_NextInstrOffset = ctx->m_Size + instrSize });
+	if (allocID == UINT32_MAX) {
+		JX_CHECK(false, "Pointer not allocated from this code heap.");
+		return;
 	}
-#endif
 
-	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t){ 0 };
-	if (!jx64_encodeInstr(instr, enc)) {
-		return false;
+	jx_x64_code_heap_block_t block = arena->m_AllocArr[allocID];
+	jx_array_delswap(arena->m_AllocArr, allocID);
+	arena->m_UsedSize -= block.m_Size;
+	arena->m_NumAllocs--;
+
+	while (jx64_codeHeapArenaMergeAdjacentFreeBlock(arena, &block)) {
 	}
 
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+	// NOTE: Free blocks never touch the hot/cold tops; they are merged back into the untouched
+	// space between them instead. Stale code is left in place until the space is reused.
+	if (block.m_Offset + block.m_Size == arena->m_HotTop) {
+		arena->m_HotTop = block.m_Offset;
+	} else if (block.m_Offset == arena->m_ColdBottom) {
+		arena->m_ColdBottom += block.m_Size;
+	} else {
+		jx64_codeHeapArenaAddFreeBlock(arena, block.m_Offset, block.m_Size);
+	}
 }
 
-bool jx64_add(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_codeHeapWrite(jx_x64_code_heap_t* heap, uint8_t* dst, const void* src, uint32_t size)
 {
-	return jx64_math_binary_op(ctx, 0x80, 0b000, 0x00, dst, src);
-}
+	jx_x64_code_heap_arena_t* arena = jx64_codeHeapFindArena(heap, dst);
+	if (!arena || (uint64_t)(dst - arena->m_Base) + size > arena->m_Size) {
+		JX_CHECK(false, "Write outside of the code heap.");
+		return false;
+	}
 
-bool jx64_or(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
-{
-	return jx64_math_binary_op(ctx, 0x80, 0b001, 0x08, dst, src);
-}
+	uint8_t* writePtr = jx64_codeHeapArenaBeginWrite(arena, dst, size);
+	if (!writePtr) {
+		return false;
+	}
 
-bool jx64_adc(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
-{
-	return jx64_math_binary_op(ctx, 0x80, 0b010, 0x10, dst, src);
+	jx_memcpy(writePtr, src, size);
+
+	return jx64_codeHeapArenaEndWrite(arena, dst, size);
 }
 
-bool jx64_sbb(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+void jx64_codeHeapGetStats(const jx_x64_code_heap_t* heap, jx_x64_code_heap_stats_t* stats)
 {
-	return jx64_math_binary_op(ctx, 0x80, 0b011, 0x18, dst, src);
+	jx_memset(stats, 0, sizeof(jx_x64_code_heap_stats_t));
+	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+		const jx_x64_code_heap_arena_t* arena = &heap->m_Arena[iSection];
+		jx_x64_code_heap_section_stats_t* secStats = &stats->m_Section[iSection];
+
+		secStats->m_ReservedSize = arena->m_Size;
+		secStats->m_UsedSize = arena->m_UsedSize;
+		secStats->m_HotSize = arena->m_HotTop;
+		secStats->m_ColdSize = arena->m_Size - arena->m_ColdBottom;
+		secStats->m_NumAllocs = arena->m_NumAllocs;
+		secStats->m_NumFailedAllocs = arena->m_NumFailedAllocs;
+		for (uint32_t iClass = 0; iClass < JX64_CODE_HEAP_NUM_SIZE_CLASSES; ++iClass) {
+			const jx_x64_code_heap_block_t* freeList = arena->m_FreeListArr[iClass];
+			const uint32_t numBlocks = (uint32_t)jx_array_sizeu(freeList);
+			for (uint32_t iBlock = 0; iBlock < numBlocks; ++iBlock) {
+				secStats->m_FreeSize += freeList[iBlock].m_Size;
+			}
+		}
+	}
+
+	stats->m_CodePageSize = heap->m_PageSize;
+	stats->m_LargePages = heap->m_LargePages;
 }
 
-bool jx64_and(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+void jx64_setCodeHeap(jx_x64_context_t* ctx, jx_x64_code_heap_t* heap)
 {
-	return jx64_math_binary_op(ctx, 0x80, 0b100, 0x20, dst, src);
+	JX_CHECK(!ctx->m_CodeBuffer.m_Buffer, "Code heap must be set before finalizing the context.");
+	ctx->m_CodeHeap = heap;
 }
 
-bool jx64_sub(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_unwindBeginRegion(jx_x64_context_t* ctx)
 {
-	return jx64_math_binary_op(ctx, 0x80, 0b101, 0x28, dst, src);
+	jx_x64_symbol_t* func = ctx->m_CurFunc;
+	if (!func || !jx64_unwindInitFunc(ctx, func)) {
+		return false;
+	}
+
+	const uint32_t offset = ctx->m_Section[JX64_SECTION_TEXT].m_Size - (uint32_t)func->m_Label->m_Offset;
+	jx_x64_unwind_region_t* lastRegion = &jx_array_last(func->m_UnwindRegionArr);
+	if (lastRegion->m_Offset == offset) {
+		// NOTE: The previous region is empty; replace it.
+		jx_array_resize(func->m_UnwindOpArr, lastRegion->m_FirstOp);
+		return true;
+	}
+
+	jx_array_push_back(func->m_UnwindRegionArr, (jx_x64_unwind_region_t){
+		.m_Offset = offset,
+		.m_FirstOp = (uint32_t)jx_array_sizeu(func->m_UnwindOpArr)
+	});
+
+	return true;
 }
 
-bool jx64_xor(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_unwindOp(jx_x64_context_t* ctx, jx_x64_unwind_op_kind kind, jx_x64_reg reg, uint32_t operand)
 {
-	return jx64_math_binary_op(ctx, 0x80, 0b110, 0x30, dst, src);
+	jx_x64_symbol_t* func = ctx->m_CurFunc;
+	if (!func || !jx64_unwindInitFunc(ctx, func)) {
+		return false;
+	}
+
+	jx_array_push_back(func->m_UnwindOpArr, (jx_x64_unwind_op_t){
+		.m_Kind = kind,
+		.m_Reg = reg,
+		.m_Operand = operand,
+		.m_CodeOffset = ctx->m_Section[JX64_SECTION_TEXT].m_Size - (uint32_t)func->m_Label->m_Offset
+	});
+
+	return true;
 }
 
-bool jx64_cmp(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+jx_x64_symbol_t* jx64_symbolGetByName(jx_x64_context_t* ctx, const char* name)
 {
-	return jx64_math_binary_op(ctx, 0x80, 0b111, 0x38, dst, src);
+	const uint32_t numSymbols = (uint32_t)jx_array_sizeu(ctx->m_SymbolArr);
+	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
+		jx_x64_symbol_t* sym = ctx->m_SymbolArr[iSym];
+		if (!jx_strcmp(sym->m_Name, name)) {
+			return sym;
+		}
+	}
+
+	return NULL;
 }
 
-bool jx64_not(jx_x64_context_t* ctx, jx_x64_operand_t op)
+static uint32_t jx64_symbolGetIndex(jx_x64_context_t* ctx, const char* name)
 {
-	return jx64_math_unary_op(ctx, 0xF6, 0b010, op);
+	const uint32_t numSymbols = (uint32_t)jx_array_sizeu(ctx->m_SymbolArr);
+	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
+		if (!jx_strcmp(ctx->m_SymbolArr[iSym]->m_Name, name)) {
+			return iSym;
+		}
+	}
+
+	return UINT32_MAX;
 }
 
-bool jx64_neg(jx_x64_context_t* ctx, jx_x64_operand_t op)
+// NOTE: Undefined symbols are always global; the linker has to resolve them.
+static bool jx64_elfSymbolIsLocal(const jx_x64_symbol_t* sym)
 {
-	return jx64_math_unary_op(ctx, 0xF6, 0b011, op);
+	return true
+		&& (sym->m_Flags & JX64_SYMBOL_FLAGS_LOCAL_Msk) != 0
+		&& !sym->m_ExternalAddr
+		&& sym->m_Label->m_Offset != JX64_LABEL_OFFSET_UNBOUND
+		;
 }
 
-bool jx64_mul(jx_x64_context_t* ctx, jx_x64_operand_t op)
+const uint8_t* jx64_symbolGetAddress(jx_x64_context_t* ctx, jx_x64_symbol_t* sym)
 {
-	return jx64_math_unary_op(ctx, 0xF6, 0b100, op);
+	if (sym->m_ExternalAddr) {
+		return (const uint8_t*)sym->m_ExternalAddr;
+	}
+
+	if (!ctx->m_CodeBuffer.m_Buffer || sym->m_Label->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
+		return NULL;
+	}
+
+	const jx_x64_section_t* sec = &ctx->m_Section[sym->m_Label->m_Section];
+	return &sec->m_FinalAddr[sym->m_Label->m_Offset];
 }
 
-bool jx64_div(jx_x64_context_t* ctx, jx_x64_operand_t op)
+void jx64_symbolAddRelocation(jx_x64_context_t* ctx, jx_x64_symbol_t* sym, jx_x64_relocation_kind kind, uint32_t offset, const char* symbolName)
 {
-	return jx64_math_unary_op(ctx, 0xF6, 0b110, op);
+	jx_array_push_back(sym->m_RelocArr, (jx_x64_relocation_t){
+		.m_Kind = kind,
+		.m_Offset = offset,
+		.m_SymbolName = jx_strdup(symbolName, ctx->m_Allocator)
+	});
 }
 
-bool jx64_idiv(jx_x64_context_t* ctx, jx_x64_operand_t op)
+bool jx64_symbolSetExternalAddress(jx_x64_context_t* ctx, jx_x64_symbol_t* sym, void* ptr)
 {
-	return jx64_math_unary_op(ctx, 0xF6, 0b111, op);
+	sym->m_ExternalAddr = ptr;
+	return true;
 }
 
-bool jx64_inc(jx_x64_context_t* ctx, jx_x64_operand_t op)
+bool jx64_emitBytes(jx_x64_context_t* ctx, jx_x64_section_kind section, const uint8_t* bytes, uint32_t n)
 {
-	return jx64_math_unary_op(ctx, 0xFE, 0b000, op);
+	jx_x64_section_t* sec = &ctx->m_Section[section];
+	if (sec->m_Size + n > sec->m_Capacity) {
+		const uint32_t oldCapacity = sec->m_Capacity;
+		const uint32_t newCapacity = oldCapacity + jx_max_u32(n, 256);
+
+		uint8_t* newBuffer = (uint8_t*)JX_ALLOC(ctx->m_Allocator, newCapacity);
+		if (!newBuffer) {
+			return false;
+		}
+
+		jx_memcpy(newBuffer, sec->m_Buffer, oldCapacity);
+		jx_memset(&newBuffer[oldCapacity], 0, newCapacity - oldCapacity);
+
+		JX_FREE(ctx->m_Allocator, sec->m_Buffer);
+		sec->m_Buffer = newBuffer;
+		sec->m_Capacity = newCapacity;
+	}
+
+	jx_memcpy(&sec->m_Buffer[sec->m_Size], bytes, n);
+	sec->m_Size += n;
+
+	return true;
 }
 
-bool jx64_dec(jx_x64_context_t* ctx, jx_x64_operand_t op)
+bool jx64_retn(jx_x64_context_t* ctx)
 {
-	return jx64_math_unary_op(ctx, 0xFE, 0b001, op);
+	const uint8_t instr[] = { 0xC3 };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
 }
 
-bool jx64_imul(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_mov(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	JX_CHECK(dst.m_Type != JX64_OPERAND_SYM && src.m_Type != JX64_OPERAND_SYM, "TODO");
-	const bool invalidOperands = false
-		|| dst.m_Type != JX64_OPERAND_REG // Destination operand should always be a register
-		;
-	if (invalidOperands) {
+	if (dst.m_Type == JX64_OPERAND_SYM && src.m_Type == JX64_OPERAND_SYM) {
 		JX_CHECK(false, "Invalid operands.");
 		return false;
 	}
 
-#if 0
-	if (JX64_REG_GET_ID(dst.u.m_Reg) == JX64_REG_ID_RAX) {
-		return jx64_math_unary_op(ctx, 0xF6, 0b101, src);
+	jx_x64_symbol_t* sym = NULL;
+	if (src.m_Type == JX64_OPERAND_SYM) {
+		sym = src.u.m_Sym;
+		src = jx64_opMem(src.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, 0);
+	} else if (dst.m_Type == JX64_OPERAND_SYM) {
+		sym = dst.u.m_Sym;
+		dst = jx64_opMem(dst.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, 0);
 	}
-#endif
 
 	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
-
-	if (src.m_Type == JX64_OPERAND_MEM) {
-		const uint8_t opcode[] = { 0x0F, 0xAF };
-		if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
+	if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_IMM) {
+		if (!jx64_mov_reg_imm(enc, dst.u.m_Reg, src.u.m_ImmI64, src.m_Size)) {
 			return false;
 		}
-	} else if (src.m_Type == JX64_OPERAND_REG) {
-		// NOTE: Reverse the order of operands because jx64_binary_op_reg_reg assumes the instruction
-		// is in the form "op r/m, r", but in this case it's actually "op r, r/m"
-		const uint8_t opcode[] = { 0x0F, 0xAF };
-		if (!jx64_binary_op_reg_reg(enc, opcode, JX_COUNTOF(opcode), src.u.m_Reg, dst.u.m_Reg)) {
+	} else if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_REG) {
+		if (!jx64_math_binary_op_reg_reg(enc, 0x88, dst.u.m_Reg, src.u.m_Reg)) {
+			return false;
+		}
+	} else if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_MEM) {
+		if (!jx64_math_binary_op_reg_mem(enc, 0x88, 1, dst.u.m_Reg, &src.u.m_Mem)) {
+			return false;
+		}
+	} else if (dst.m_Type == JX64_OPERAND_MEM && src.m_Type == JX64_OPERAND_IMM) {
+		if (!jx64_mov_mem_imm(enc, &dst.u.m_Mem, src.u.m_ImmI64, src.m_Size)) {
+			return false;
+		}
+	} else if (dst.m_Type == JX64_OPERAND_MEM && src.m_Type == JX64_OPERAND_REG) {
+		if (!jx64_math_binary_op_reg_mem(enc, 0x88, 0, src.u.m_Reg, &dst.u.m_Mem)) {
 			return false;
 		}
-	} else if (src.m_Type == JX64_OPERAND_IMM) {
-		return jx64_imul3(ctx, dst, dst, src);
 	} else {
-		JX_CHECK(false, "Invalid operands.");
+		JX_CHECK(false, "Invalid operands?");
 		return false;
 	}
 
+	if (sym) {
+		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
+		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
+
+		const uint32_t relocDelta = (instrSize - dispOffset) - sizeof(int32_t);
+		JX_CHECK(relocDelta <= 5, "Invalid relocation type");
+		const uint32_t curFuncOffset = (uint32_t)ctx->m_CurFunc->m_Label->m_Offset;
+		const uint32_t relocOffset = ctx->m_Section[JX64_SECTION_TEXT].m_Size - curFuncOffset + dispOffset;
+		jx64_symbolAddRelocation(ctx, ctx->m_CurFunc, JX64_RELOC_REL32 + relocDelta, relocOffset, sym->m_Name);
+	}
+
 	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
 	if (!jx64_encodeInstr(instr, enc)) {
 		return false;
@@ -1001,89 +1895,59 @@ bool jx64_imul(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src
 	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
 }
 
-bool jx64_imul3(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
+bool jx64_movsx(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	JX_CHECK(dst.m_Type != JX64_OPERAND_SYM && src1.m_Type != JX64_OPERAND_SYM && src2.m_Type != JX64_OPERAND_SYM, "TODO");
 	const bool invalidOperands = false
-		|| dst.m_Type != JX64_OPERAND_REG  // Destination operand should always be a register
-		|| dst.m_Size == JX64_SIZE_8       // Destination cannot be an 8-bit register
-		|| src2.m_Type != JX64_OPERAND_IMM // Second source operand should always be an immediate value.
+		|| dst.m_Type != JX64_OPERAND_REG // Destination operand should always be a register
+		|| dst.m_Size <= src.m_Size
 		;
 	if (invalidOperands) {
 		JX_CHECK(false, "Invalid operands.");
 		return false;
 	}
 
+	jx_x64_symbol_t* sym = NULL;
+	if (src.m_Type == JX64_OPERAND_SYM) {
+		sym = src.u.m_Sym;
+		src = jx64_opMem(src.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, 0);
+	}
+
 	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+	if (src.m_Type == JX64_OPERAND_REG) {
+		if (!jx64_movsx_reg_reg(enc, dst.u.m_Reg, src.u.m_Reg)) {
+			return false;
+		}
+	} else if (src.m_Type == JX64_OPERAND_MEM) {
+//		JX_CHECK(false, "Untested code below! If this assert hits check if it's correct. Otherwise implemement jx64_movsx_reg_mem.");
+		if (src.m_Size == JX64_SIZE_8) {
+			const uint8_t opcode[] = { 0x0F, 0xBE };
+			if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
+				return false;
+			}
+		} else if (src.m_Size == JX64_SIZE_16) {
+			const uint8_t opcode[] = { 0x0F, 0xBF };
+			if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
+				return false;
+			}
+		} else if (src.m_Size == JX64_SIZE_32) {
+			if (!jx64_math_binary_op_reg_mem(enc, 0x60, 1, dst.u.m_Reg, &src.u.m_Mem)) {
+				return false;
+			}
+		}
+	} else {
+		JX_CHECK(false, "Invalid operands?");
+		return false;
+	}
 
-	if (src1.m_Type == JX64_OPERAND_MEM) {
-		JX_NOT_IMPLEMENTED();
-	} else if (src1.m_Type == JX64_OPERAND_REG) {
-		if (src2.m_Size == JX64_SIZE_8 || (src2.u.m_ImmI64 >= INT8_MIN && src2.u.m_ImmI64 <= INT8_MAX)) {
-			jx_x64_reg dst_r = dst.u.m_Reg;
-			jx_x64_reg src_r = src1.u.m_Reg;
-
-			int8_t imm8 = (int8_t)src2.u.m_ImmI64;
-
-			const bool invalidOperands = false
-				|| dst_r == JX64_REG_NONE
-				|| src_r == JX64_REG_NONE
-				|| JX64_REG_IS_RIP(dst_r)
-				|| JX64_REG_IS_RIP(src_r)
-				|| JX64_REG_GET_SIZE(dst_r) != JX64_REG_GET_SIZE(src_r)
-				;
-			if (invalidOperands) {
-				JX_CHECK(false, "Invalid operands.");
-				return false;
-			}
-
-			const jx_x64_size reg_sz = JX64_REG_GET_SIZE(dst_r);
-
-			const bool needsREX = false
-				|| reg_sz == JX64_SIZE_64
-				|| JX64_REG_IS_HI(dst_r)
-				|| JX64_REG_IS_HI(src_r)
-				;
-
-			jx64_instrEnc_operandSize(enc, reg_sz == JX64_SIZE_16);
-			jx64_instrEnc_rex(enc, needsREX, reg_sz == JX64_SIZE_64, JX64_REG_HI(dst_r), 0, JX64_REG_HI(src_r));
-			jx64_instrEnc_opcode1(enc, 0x6B);
-			jx64_instrEnc_modrm(enc, 0b11, JX64_REG_LO(dst_r), JX64_REG_LO(src_r));
-			jx64_instrEnc_imm(enc, true, JX64_SIZE_8, imm8);
-		} else {
-			jx_x64_reg dst_r = dst.u.m_Reg;
-			jx_x64_reg src_r = src1.u.m_Reg;
-			const int64_t src_imm = src2.u.m_ImmI64;
-
-			const bool invalidOperands = false
-				|| dst_r == JX64_REG_NONE
-				|| src_r == JX64_REG_NONE
-				|| JX64_REG_IS_RIP(dst_r)
-				|| JX64_REG_IS_RIP(src_r)
-				|| JX64_REG_GET_SIZE(dst_r) != JX64_REG_GET_SIZE(src_r)
-				;
-			if (invalidOperands) {
-				JX_CHECK(false, "Invalid operands.");
-				return false;
-			}
-
-			const jx_x64_size reg_sz = JX64_REG_GET_SIZE(dst_r);
-
-			const bool needsREX = false
-				|| reg_sz == JX64_SIZE_64
-				|| JX64_REG_IS_HI(dst_r)
-				|| JX64_REG_IS_HI(src_r)
-				;
+	if (sym) {
+		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
+		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
 
-			jx64_instrEnc_operandSize(enc, reg_sz == JX64_SIZE_16);
-			jx64_instrEnc_rex(enc, needsREX, reg_sz == JX64_SIZE_64, JX64_REG_HI(dst_r), 0, JX64_REG_HI(src_r));
-			jx64_instrEnc_opcode1(enc, 0x69);
-			jx64_instrEnc_modrm(enc, 0b11, JX64_REG_LO(dst_r), JX64_REG_LO(src_r));
-			jx64_instrEnc_imm(enc, true, reg_sz == JX64_SIZE_64 ? JX64_SIZE_32 : reg_sz, src_imm);
-		}
-	} else {
-		JX_CHECK(false, "Invalid operands.");
-		return false;
+		const uint32_t relocDelta = (instrSize - dispOffset) - sizeof(int32_t);
+		JX_CHECK(relocDelta <= 5, "Invalid relocation type");
+		const uint32_t curFuncOffset = (uint32_t)ctx->m_CurFunc->m_Label->m_Offset;
+		const uint32_t relocOffset = ctx->m_Section[JX64_SECTION_TEXT].m_Size - curFuncOffset + dispOffset;
+		jx64_symbolAddRelocation(ctx, ctx->m_CurFunc, JX64_RELOC_REL32 + relocDelta, relocOffset, sym->m_Name);
 	}
 
 	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
@@ -1094,27 +1958,60 @@ bool jx64_imul3(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t sr
 	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
 }
 
-bool jx64_lea(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_movzx(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
-
 	const bool invalidOperands = false
-		|| dst.m_Type != JX64_OPERAND_REG
-		|| (src.m_Type != JX64_OPERAND_MEM && src.m_Type != JX64_OPERAND_LBL && src.m_Type != JX64_OPERAND_SYM)
+		|| dst.m_Type != JX64_OPERAND_REG // Destination operand should always be a register
+		|| dst.m_Size < src.m_Size
 		;
 	if (invalidOperands) {
 		JX_CHECK(false, "Invalid operands.");
 		return false;
 	}
 
+	if (dst.m_Size == JX64_SIZE_64 && src.m_Size == JX64_SIZE_32) {
+		if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_REG && JX64_REG_GET_ID(dst.u.m_Reg) == JX64_REG_GET_ID(src.u.m_Reg)) {
+			// No-op.
+			return true;
+		} else {
+			// movzx reg64, reg32 is actually a mov reg64d, reg32
+			// The upper part of the 64-bit register is implicitly zeroed whenever 
+			// the lower 32-bit part is written.
+			dst.m_Size = JX64_SIZE_32;
+			dst.u.m_Reg = JX64_REG(JX64_REG_GET_ID(dst.u.m_Reg), 0, JX64_SIZE_32);
+			return jx64_mov(ctx, dst, src);
+		}
+	}
+
 	jx_x64_symbol_t* sym = NULL;
 	if (src.m_Type == JX64_OPERAND_SYM) {
 		sym = src.u.m_Sym;
-		src = jx64_opMem(JX64_SIZE_64, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, 0);
+		src = jx64_opMem(src.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, 0);
 	}
 
-	const uint8_t opcode = 0x8D;
-	if (!jx64_binary_op_reg_mem(enc, &opcode, 1, dst.u.m_Reg, &src.u.m_Mem)) {
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+
+	if (src.m_Type == JX64_OPERAND_REG) {
+		if (!jx64_movzx_reg_reg(enc, dst.u.m_Reg, src.u.m_Reg)) {
+			return false;
+		}
+	} else if (src.m_Type == JX64_OPERAND_MEM) {
+//		JX_CHECK(false, "Untested code below! If this assert hits check if it's correct. Otherwise implemement jx64_movzx_reg_mem.");
+		if (src.m_Size == JX64_SIZE_8) {
+			const uint8_t opcode[] = { 0x0F, 0xB6 };
+			if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
+				return false;
+			}
+		} else if (src.m_Size == JX64_SIZE_16) {
+			const uint8_t opcode[] = { 0x0F, 0xB7 };
+			if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
+				return false;
+			}
+		} else if (src.m_Size == JX64_SIZE_32) {
+			JX_NOT_IMPLEMENTED();
+		}
+	} else {
+		JX_CHECK(false, "Invalid operands?");
 		return false;
 	}
 
@@ -1137,60 +2034,138 @@ bool jx64_lea(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
 }
 
-bool jx64_test(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_nop(jx_x64_context_t* ctx, uint32_t n)
 {
-	JX_CHECK(dst.m_Type != JX64_OPERAND_SYM && src.m_Type != JX64_OPERAND_SYM, "TODO");
+	if (n == 0) {
+		return false;
+	}
+
+	// NOTE: Longer forms require more than 3 prefixes which are decoded slowly
+	// by some cores, so padding larger than 11 bytes is split into multiple NOPs.
+	static const uint8_t kNops[12][11] = {
+		{ 0 },                                                                // Invalid
+		{ 0x90 },                                                             // NOP
+		{ 0x66, 0x90 },                                                       // 0x66 NOP
+		{ 0x0F, 0x1F, 0x00 },                                                 // NOP dword ptr [EAX]
+		{ 0x0F, 0x1F, 0x40, 0x00 },                                           // NOP dword ptr [EAX + 0x00]
+		{ 0x0F, 0x1F, 0x44, 0x00, 0x00 },                                     // NOP dword ptr [EAX + EAX * 1 + 0x00]
+		{ 0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00 },                               // 66 NOP dword ptr [EAX + EAX * 1 + 0x00]
+		{ 0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00 },                         // NOP dword ptr [EAX + 0x00000000]
+		{ 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },                   // NOP dword ptr [EAX + EAX * 1 + 0x00000000]
+		{ 0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },             // 66 NOP dword ptr [EAX + EAX * 1 + 0x00000000]
+		{ 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },       // 66 CS NOP dword ptr [EAX + EAX * 1 + 0x00000000]
+		{ 0x66, 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }, // 66 66 CS NOP dword ptr [EAX + EAX * 1 + 0x00000000]
+	};
+
+	while (n > 11) {
+		jx64_emitBytes(ctx, JX64_SECTION_TEXT, &kNops[11][0], 11);
+		n -= 11;
+	}
+
+	jx64_emitBytes(ctx, JX64_SECTION_TEXT, &kNops[n][0], n);
+
+	return true;
+}
+
+bool jx64_alignText(jx_x64_context_t* ctx, uint32_t alignment)
+{
+	JX_CHECK(alignment != 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of 2.");
+
+	ctx->m_Section[JX64_SECTION_TEXT].m_Alignment = jx_max_u32(ctx->m_Section[JX64_SECTION_TEXT].m_Alignment, alignment);
+
+	const uint32_t curOffset = ctx->m_Section[JX64_SECTION_TEXT].m_Size;
+	const uint32_t padding = jx_roundup_u32(curOffset, alignment) - curOffset;
+	if (padding == 0) {
+		return true;
+	}
+
+	return jx64_nop(ctx, padding);
+}
+
+bool jx64_push(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	JX_CHECK(op.m_Type != JX64_OPERAND_SYM, "TODO");
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t){ 0 };
+	
 #if 0
-	// RIP relative addressing
 	jx_x64_label_t* lbl = NULL;
-	if (dst.m_Type == JX64_OPERAND_LBL) {
-		lbl = dst.u.m_Lbl;
+	if (op.m_Type == JX64_OPERAND_LBL) {
+		lbl = op.u.m_Lbl;
 		const int32_t diff = lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND
 			? 0
 			: (int32_t)lbl->m_Offset - (int32_t)ctx->m_Size
 			;
-		dst = jx64_opMem(src.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, diff);
+		op = jx64_opMem(op.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, diff);
 	}
 #endif
 
-	const bool invalidOperands = false
-		|| !(dst.m_Size == src.m_Size || (dst.m_Size == JX64_SIZE_64 && src.m_Size == JX64_SIZE_32)) // only allow reg size == imm size or 64-bit with 32-bit imm
-		;
-	if (invalidOperands) {
+	if (op.m_Type == JX64_OPERAND_IMM) {
+		const bool invalidOperand = false
+			|| op.m_Size == JX64_SIZE_64 // Cannot push 64-bit immediate
+			;
+		if (invalidOperand) {
+			JX_CHECK(false, "Invalid operands.");
+			return false;
+		}
+
+		jx64_instrEnc_opcode1(enc, 0x68 | (op.m_Size == JX64_SIZE_8 ? 0b10 : 0));
+		jx64_instrEnc_imm(enc, true, (op.m_Size == JX64_SIZE_8) ? JX64_SIZE_8 : JX64_SIZE_32, op.u.m_ImmI64);
+	} else if (op.m_Type == JX64_OPERAND_REG) {
+		// 0x50+ r
+		if (!jx64_stack_op_reg(enc, 0x50, op.u.m_Reg)) {
+			return false;
+		}
+	} else if (op.m_Type == JX64_OPERAND_MEM) {
+		// FF /6
+		if (!jx64_stack_op_mem(enc, 0xFF, 0b110, &op.u.m_Mem, op.m_Size)) {
+			return false;
+		}
+	} else {
 		JX_CHECK(false, "Invalid operands.");
 		return false;
 	}
 
-	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+#if 0
+	if (lbl && lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
+		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
+		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
+		jx_array_push_back(lbl->m_RefsArr, (jx_x64_label_ref_t) { .m_DispOffset = ctx->m_Size + dispOffset, .m_NextInstrOffset = ctx->m_Size + instrSize });
+	}
+#endif
 
-	const uint8_t opcode = (src.m_Type == JX64_OPERAND_IMM ? 0xF6 : 0x84)
-		| ((dst.m_Size != JX64_SIZE_8) ? 1 : 0) // w bit
-		;
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t){ 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
 
-	if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_IMM) {
-		jx_x64_size immSize = src.m_Size;
-		if (immSize == JX64_SIZE_64) {
-			if (!jx64_immFitsIn32Bits(src.u.m_ImmI64)) {
-				JX_CHECK(false, "Immediate cannot be a 64-bit value!");
-				return false;
-			} else {
-				immSize = JX64_SIZE_32;
-			}
-		}
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+}
 
-		if (!jx64_binary_op_reg_imm(enc, &opcode, 1, 0b000, dst.u.m_Reg, src.u.m_ImmI64, immSize)) {
-			return false;
-		}
-	} else if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_REG) {
-		if (!jx64_binary_op_reg_reg(enc, &opcode, 1, dst.u.m_Reg, src.u.m_Reg)) {
-			return false;
-		}
-	} else if (dst.m_Type == JX64_OPERAND_MEM && src.m_Type == JX64_OPERAND_IMM) {
-		if (!jx64_binary_op_mem_imm(enc, &opcode, 1, 0b000, &dst.u.m_Mem, dst.m_Size, src.u.m_ImmI64, src.m_Size)) {
+bool jx64_pop(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	JX_CHECK(op.m_Type != JX64_OPERAND_SYM, "TODO");
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t){ 0 };
+
+#if 0
+	jx_x64_label_t* lbl = NULL;
+	if (op.m_Type == JX64_OPERAND_LBL) {
+		lbl = op.u.m_Lbl;
+		const int32_t diff = lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND
+			? 0
+			: (int32_t)lbl->m_Offset - (int32_t)ctx->m_Size
+			;
+		op = jx64_opMem(op.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, diff);
+	}
+#endif
+
+	if (op.m_Type == JX64_OPERAND_REG) {
+		// 0x58+ r
+		if (!jx64_stack_op_reg(enc, 0x58, op.u.m_Reg)) {
 			return false;
 		}
-	} else if (dst.m_Type == JX64_OPERAND_MEM && src.m_Type == JX64_OPERAND_REG) {
-		if (!jx64_binary_op_reg_mem(enc, &opcode, 1, src.u.m_Reg, &dst.u.m_Mem)) {
+	} else if (op.m_Type == JX64_OPERAND_MEM) {
+		// 0x8F /0
+		if (!jx64_stack_op_mem(enc, 0x8F, 0b000, &op.u.m_Mem, op.m_Size)) {
 			return false;
 		}
 	} else {
@@ -1206,7 +2181,7 @@ bool jx64_test(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src
 	}
 #endif
 
-	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t){ 0 };
 	if (!jx64_encodeInstr(instr, enc)) {
 		return false;
 	}
@@ -1214,709 +2189,1938 @@ bool jx64_test(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src
 	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
 }
 
-bool jx64_std(jx_x64_context_t* ctx)
+bool jx64_add(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_math_binary_op(ctx, 0x80, 0b000, 0x00, dst, src);
+}
+
+bool jx64_or(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_math_binary_op(ctx, 0x80, 0b001, 0x08, dst, src);
+}
+
+bool jx64_adc(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_math_binary_op(ctx, 0x80, 0b010, 0x10, dst, src);
+}
+
+bool jx64_sbb(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_math_binary_op(ctx, 0x80, 0b011, 0x18, dst, src);
+}
+
+bool jx64_and(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_math_binary_op(ctx, 0x80, 0b100, 0x20, dst, src);
+}
+
+bool jx64_sub(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_math_binary_op(ctx, 0x80, 0b101, 0x28, dst, src);
+}
+
+bool jx64_xor(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_math_binary_op(ctx, 0x80, 0b110, 0x30, dst, src);
+}
+
+bool jx64_cmp(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_math_binary_op(ctx, 0x80, 0b111, 0x38, dst, src);
+}
+
+bool jx64_not(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	return jx64_math_unary_op(ctx, 0xF6, 0b010, op);
+}
+
+bool jx64_neg(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	return jx64_math_unary_op(ctx, 0xF6, 0b011, op);
+}
+
+bool jx64_mul(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	return jx64_math_unary_op(ctx, 0xF6, 0b100, op);
+}
+
+bool jx64_div(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	return jx64_math_unary_op(ctx, 0xF6, 0b110, op);
+}
+
+bool jx64_idiv(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	return jx64_math_unary_op(ctx, 0xF6, 0b111, op);
+}
+
+bool jx64_imul1(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	return jx64_math_unary_op(ctx, 0xF6, 0b101, op);
+}
+
+bool jx64_inc(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	return jx64_math_unary_op(ctx, 0xFE, 0b000, op);
+}
+
+bool jx64_dec(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	return jx64_math_unary_op(ctx, 0xFE, 0b001, op);
+}
+
+bool jx64_imul(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	JX_CHECK(dst.m_Type != JX64_OPERAND_SYM && src.m_Type != JX64_OPERAND_SYM, "TODO");
+	const bool invalidOperands = false
+		|| dst.m_Type != JX64_OPERAND_REG // Destination operand should always be a register
+		;
+	if (invalidOperands) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+#if 0
+	if (JX64_REG_GET_ID(dst.u.m_Reg) == JX64_REG_ID_RAX) {
+		return jx64_math_unary_op(ctx, 0xF6, 0b101, src);
+	}
+#endif
+
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+
+	if (src.m_Type == JX64_OPERAND_MEM) {
+		const uint8_t opcode[] = { 0x0F, 0xAF };
+		if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
+			return false;
+		}
+	} else if (src.m_Type == JX64_OPERAND_REG) {
+		// NOTE: Reverse the order of operands because jx64_binary_op_reg_reg assumes the instruction
+		// is in the form "op r/m, r", but in this case it's actually "op r, r/m"
+		const uint8_t opcode[] = { 0x0F, 0xAF };
+		if (!jx64_binary_op_reg_reg(enc, opcode, JX_COUNTOF(opcode), src.u.m_Reg, dst.u.m_Reg)) {
+			return false;
+		}
+	} else if (src.m_Type == JX64_OPERAND_IMM) {
+		return jx64_imul3(ctx, dst, dst, src);
+	} else {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
+
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+}
+
+bool jx64_imul3(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
+{
+	JX_CHECK(dst.m_Type != JX64_OPERAND_SYM && src1.m_Type != JX64_OPERAND_SYM && src2.m_Type != JX64_OPERAND_SYM, "TODO");
+	const bool invalidOperands = false
+		|| dst.m_Type != JX64_OPERAND_REG  // Destination operand should always be a register
+		|| dst.m_Size == JX64_SIZE_8       // Destination cannot be an 8-bit register
+		|| src2.m_Type != JX64_OPERAND_IMM // Second source operand should always be an immediate value.
+		;
+	if (invalidOperands) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+
+	if (src1.m_Type == JX64_OPERAND_MEM) {
+		JX_NOT_IMPLEMENTED();
+	} else if (src1.m_Type == JX64_OPERAND_REG) {
+		if (src2.m_Size == JX64_SIZE_8 || (src2.u.m_ImmI64 >= INT8_MIN && src2.u.m_ImmI64 <= INT8_MAX)) {
+			jx_x64_reg dst_r = dst.u.m_Reg;
+			jx_x64_reg src_r = src1.u.m_Reg;
+
+			int8_t imm8 = (int8_t)src2.u.m_ImmI64;
+
+			const bool invalidOperands = false
+				|| dst_r == JX64_REG_NONE
+				|| src_r == JX64_REG_NONE
+				|| JX64_REG_IS_RIP(dst_r)
+				|| JX64_REG_IS_RIP(src_r)
+				|| JX64_REG_GET_SIZE(dst_r) != JX64_REG_GET_SIZE(src_r)
+				;
+			if (invalidOperands) {
+				JX_CHECK(false, "Invalid operands.");
+				return false;
+			}
+
+			const jx_x64_size reg_sz = JX64_REG_GET_SIZE(dst_r);
+
+			const bool needsREX = false
+				|| reg_sz == JX64_SIZE_64
+				|| JX64_REG_IS_HI(dst_r)
+				|| JX64_REG_IS_HI(src_r)
+				;
+
+			jx64_instrEnc_operandSize(enc, reg_sz == JX64_SIZE_16);
+			jx64_instrEnc_rex(enc, needsREX, reg_sz == JX64_SIZE_64, JX64_REG_HI(dst_r), 0, JX64_REG_HI(src_r));
+			jx64_instrEnc_opcode1(enc, 0x6B);
+			jx64_instrEnc_modrm(enc, 0b11, JX64_REG_LO(dst_r), JX64_REG_LO(src_r));
+			jx64_instrEnc_imm(enc, true, JX64_SIZE_8, imm8);
+		} else {
+			jx_x64_reg dst_r = dst.u.m_Reg;
+			jx_x64_reg src_r = src1.u.m_Reg;
+			const int64_t src_imm = src2.u.m_ImmI64;
+
+			const bool invalidOperands = false
+				|| dst_r == JX64_REG_NONE
+				|| src_r == JX64_REG_NONE
+				|| JX64_REG_IS_RIP(dst_r)
+				|| JX64_REG_IS_RIP(src_r)
+				|| JX64_REG_GET_SIZE(dst_r) != JX64_REG_GET_SIZE(src_r)
+				;
+			if (invalidOperands) {
+				JX_CHECK(false, "Invalid operands.");
+				return false;
+			}
+
+			const jx_x64_size reg_sz = JX64_REG_GET_SIZE(dst_r);
+
+			const bool needsREX = false
+				|| reg_sz == JX64_SIZE_64
+				|| JX64_REG_IS_HI(dst_r)
+				|| JX64_REG_IS_HI(src_r)
+				;
+
+			jx64_instrEnc_operandSize(enc, reg_sz == JX64_SIZE_16);
+			jx64_instrEnc_rex(enc, needsREX, reg_sz == JX64_SIZE_64, JX64_REG_HI(dst_r), 0, JX64_REG_HI(src_r));
+			jx64_instrEnc_opcode1(enc, 0x69);
+			jx64_instrEnc_modrm(enc, 0b11, JX64_REG_LO(dst_r), JX64_REG_LO(src_r));
+			jx64_instrEnc_imm(enc, true, reg_sz == JX64_SIZE_64 ? JX64_SIZE_32 : reg_sz, src_imm);
+		}
+	} else {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
+
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+}
+
+bool jx64_lea(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+
+	const bool invalidOperands = false
+		|| dst.m_Type != JX64_OPERAND_REG
+		|| (src.m_Type != JX64_OPERAND_MEM && src.m_Type != JX64_OPERAND_LBL && src.m_Type != JX64_OPERAND_SYM)
+		;
+	if (invalidOperands) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	jx_x64_symbol_t* sym = NULL;
+	if (src.m_Type == JX64_OPERAND_SYM) {
+		sym = src.u.m_Sym;
+		src = jx64_opMem(JX64_SIZE_64, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, 0);
+	}
+
+	const uint8_t opcode = 0x8D;
+	if (!jx64_binary_op_reg_mem(enc, &opcode, 1, dst.u.m_Reg, &src.u.m_Mem)) {
+		return false;
+	}
+
+	if (sym) {
+		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
+		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
+
+		const uint32_t relocDelta = (instrSize - dispOffset) - sizeof(int32_t);
+		JX_CHECK(relocDelta <= 5, "Invalid relocation type");
+		const uint32_t curFuncOffset = (uint32_t)ctx->m_CurFunc->m_Label->m_Offset;
+		const uint32_t relocOffset = ctx->m_Section[JX64_SECTION_TEXT].m_Size - curFuncOffset + dispOffset;
+		jx64_symbolAddRelocation(ctx, ctx->m_CurFunc, JX64_RELOC_REL32 + relocDelta, relocOffset, sym->m_Name);
+	}
+
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
+
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+}
+
+bool jx64_test(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	JX_CHECK(dst.m_Type != JX64_OPERAND_SYM && src.m_Type != JX64_OPERAND_SYM, "TODO");
+#if 0
+	// RIP relative addressing
+	jx_x64_label_t* lbl = NULL;
+	if (dst.m_Type == JX64_OPERAND_LBL) {
+		lbl = dst.u.m_Lbl;
+		const int32_t diff = lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND
+			? 0
+			: (int32_t)lbl->m_Offset - (int32_t)ctx->m_Size
+			;
+		dst = jx64_opMem(src.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, diff);
+	}
+#endif
+
+	const bool invalidOperands = false
+		|| !(dst.m_Size == src.m_Size || (dst.m_Size == JX64_SIZE_64 && src.m_Size == JX64_SIZE_32)) // only allow reg size == imm size or 64-bit with 32-bit imm
+		;
+	if (invalidOperands) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+
+	const uint8_t opcode = (src.m_Type == JX64_OPERAND_IMM ? 0xF6 : 0x84)
+		| ((dst.m_Size != JX64_SIZE_8) ? 1 : 0) // w bit
+		;
+
+	if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_IMM) {
+		jx_x64_size immSize = src.m_Size;
+		if (immSize == JX64_SIZE_64) {
+			if (!jx64_immFitsIn32Bits(src.u.m_ImmI64)) {
+				JX_CHECK(false, "Immediate cannot be a 64-bit value!");
+				return false;
+			} else {
+				immSize = JX64_SIZE_32;
+			}
+		}
+
+		if (!jx64_binary_op_reg_imm(enc, &opcode, 1, 0b000, dst.u.m_Reg, src.u.m_ImmI64, immSize)) {
+			return false;
+		}
+	} else if (dst.m_Type == JX64_OPERAND_REG && src.m_Type == JX64_OPERAND_REG) {
+		if (!jx64_binary_op_reg_reg(enc, &opcode, 1, dst.u.m_Reg, src.u.m_Reg)) {
+			return false;
+		}
+	} else if (dst.m_Type == JX64_OPERAND_MEM && src.m_Type == JX64_OPERAND_IMM) {
+		if (!jx64_binary_op_mem_imm(enc, &opcode, 1, 0b000, &dst.u.m_Mem, dst.m_Size, src.u.m_ImmI64, src.m_Size)) {
+			return false;
+		}
+	} else if (dst.m_Type == JX64_OPERAND_MEM && src.m_Type == JX64_OPERAND_REG) {
+		if (!jx64_binary_op_reg_mem(enc, &opcode, 1, src.u.m_Reg, &dst.u.m_Mem)) {
+			return false;
+		}
+	} else {
+		JX_CHECK(false, "Invalid operands?");
+		return false;
+	}
+
+#if 0
+	if (lbl && lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
+		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
+		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
+		jx_array_push_back(lbl->m_RefsArr, (jx_x64_label_ref_t) { .m_DispOffset = ctx->m_Size + dispOffset, .m_NextInstrOffset = ctx->m_Size + instrSize });
+	}
+#endif
+
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
+
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+}
+
+bool jx64_std(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { 0xFD };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+}
+
+bool jx64_cld(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { 0xFC };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+}
+
+bool jx64_stc(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { 0xF9 };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+}
+
+bool jx64_cmc(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { 0xF5 };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+}
+
+bool jx64_clc(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { 0xF8 };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+}
+
+bool jx64_setcc(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t dst)
+{
+	JX_CHECK(dst.m_Type != JX64_OPERAND_SYM, "TODO");
+#if 0
+	jx_x64_label_t* lbl = NULL;
+	if (dst.m_Type == JX64_OPERAND_LBL) {
+		// RIP-relative addressing. Calculate offset to the specified label 
+		// and turn src operand into mem operand. 
+		// NOTE: Since, at this point, we don't know how long the instruction
+		// will end up being we cannot calculate the correct offset. We calculate
+		// the offset to the start of this instruction and jx64_binary_op_reg_mem() should
+		// take care of fixing it.
+		lbl = dst.u.m_Lbl;
+		const int32_t diff = lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND
+			? 0
+			: (int32_t)lbl->m_Offset - (int32_t)ctx->m_Size
+			;
+		dst = jx64_opMem(dst.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, diff);
+	}
+#endif
+
+	const bool invalidOperands = false
+		|| (dst.m_Type != JX64_OPERAND_REG && dst.m_Type != JX64_OPERAND_MEM)
+		|| dst.m_Size != JX64_SIZE_8
+		;
+	if (invalidOperands) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+
+	if (dst.m_Type == JX64_OPERAND_REG) {
+		const uint32_t reg = dst.u.m_Reg;
+		const bool needsREX = false
+			|| (JX64_REG_GET_ID(reg) >= JX64_REG_ID_RSP)
+			|| JX64_REG_IS_HI(reg)
+			;
+
+		jx64_instrEnc_rex(enc, needsREX, 0, 0, 0, JX64_REG_HI(reg));
+		jx64_instrEnc_opcode2(enc, 0x0F, 0x90 | cc);
+		jx64_instrEnc_modrm(enc, 0b11, 0b000, JX64_REG_LO(reg));
+	} else if (dst.m_Type == JX64_OPERAND_MEM) {
+		JX_NOT_IMPLEMENTED();
+	} else {
+		JX_CHECK(false, "Invalid operands?");
+		return false;
+	}
+
+#if 0
+	if (lbl && lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
+		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
+		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
+		jx_array_push_back(lbl->m_RefsArr, (jx_x64_label_ref_t) { .m_DispOffset = ctx->m_Size + dispOffset, .m_NextInstrOffset = ctx->m_Size + instrSize });
+	}
+#endif
+
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
+
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+
+	return false;
+}
+
+bool jx64_sar(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+{
+	return jx64_shift_rotate_op(ctx, 0b111, op, shift);
+}
+
+bool jx64_sal(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+{
+	return jx64_shift_rotate_op(ctx, 0b100, op, shift);
+}
+
+bool jx64_shr(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+{
+	return jx64_shift_rotate_op(ctx, 0b101, op, shift);
+}
+
+bool jx64_shl(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+{
+	return jx64_shift_rotate_op(ctx, 0b100, op, shift);
+}
+
+bool jx64_rcr(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+{
+	return jx64_shift_rotate_op(ctx, 0b011, op, shift);
+}
+
+bool jx64_rcl(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+{
+	return jx64_shift_rotate_op(ctx, 0b010, op, shift);
+}
+
+bool jx64_ror(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+{
+	return jx64_shift_rotate_op(ctx, 0b001, op, shift);
+}
+
+bool jx64_rol(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+{
+	return jx64_shift_rotate_op(ctx, 0b000, op, shift);
+}
+
+bool jx64_cmovcc(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	JX_CHECK(src.m_Type != JX64_OPERAND_SYM, "TODO");
+	const bool invalidOperands = false
+		|| dst.m_Type != JX64_OPERAND_REG  // Destination operand should always be a register
+		|| dst.m_Size == JX64_SIZE_8       // Destination cannot be an 8-bit register
+		|| (src.m_Type != JX64_OPERAND_REG && src.m_Type != JX64_OPERAND_MEM) // No immediate form
+		|| dst.m_Size != src.m_Size
+		;
+	if (invalidOperands) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+
+	const uint8_t opcode[] = { 0x0F, 0x40 | (uint8_t)cc };
+	if (src.m_Type == JX64_OPERAND_MEM) {
+		if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
+			return false;
+		}
+	} else {
+		// NOTE: Reverse the order of operands because jx64_binary_op_reg_reg assumes the instruction
+		// is in the form "op r/m, r", but in this case it's actually "op r, r/m"
+		if (!jx64_binary_op_reg_reg(enc, opcode, JX_COUNTOF(opcode), src.u.m_Reg, dst.u.m_Reg)) {
+			return false;
+		}
+	}
+
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
+
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+}
+
+bool jx64_bt(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_bit_test_op(ctx, 0xA3, 0b100, dst, src);
+}
+
+bool jx64_btr(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_bit_test_op(ctx, 0xB3, 0b110, dst, src);
+}
+
+bool jx64_bts(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_bit_test_op(ctx, 0xAB, 0b101, dst, src);
+}
+
+bool jx64_btc(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_bit_test_op(ctx, 0xBB, 0b111, dst, src);
+}
+
+bool jx64_bsr(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_bit_scan_op(ctx, false, 0xBD, dst, src);
+}
+
+bool jx64_bsf(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_bit_scan_op(ctx, false, 0xBC, dst, src);
+}
+
+bool jx64_popcnt(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_bit_scan_op(ctx, true, 0xB8, dst, src);
+}
+
+bool jx64_lzcnt(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_bit_scan_op(ctx, true, 0xBD, dst, src);
+}
+
+bool jx64_tzcnt(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_bit_scan_op(ctx, true, 0xBC, dst, src);
+}
+
+bool jx64_bswap(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	const bool invalidOperands = false
+		|| op.m_Type != JX64_OPERAND_REG
+		|| op.m_Size < JX64_SIZE_32 // 16-bit bswap is undefined
+		;
+	if (invalidOperands) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+
+	// 0F C8+rd
+	const jx_x64_reg reg = op.u.m_Reg;
+	const bool needsREX = false
+		|| op.m_Size == JX64_SIZE_64
+		|| JX64_REG_IS_HI(reg)
+		;
+	jx64_instrEnc_rex(enc, needsREX, op.m_Size == JX64_SIZE_64, 0, 0, JX64_REG_HI(reg));
+	jx64_instrEnc_opcode2(enc, 0x0F, 0xC8 | JX64_REG_LO(reg));
+
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
+
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+}
+
+bool jx64_jcc(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t op)
+{
+	if (op.m_Type != JX64_OPERAND_LBL) {
+		JX_CHECK(false, "Can only jump to labels");
+		return false;
+	}
+
+	jx_x64_label_t* lbl = op.u.m_Lbl;
+	if (lbl->m_Section != JX64_SECTION_TEXT) {
+		JX_CHECK(false, "Can only jump to text section labels");
+		return false;
+	}
+
+	jx_x64_section_t* sec = &ctx->m_Section[lbl->m_Section];
+
+	const int32_t displacement = lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND
+		? 0
+		: (int32_t)lbl->m_Offset - (int32_t)sec->m_Size
+		;
+
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t){ 0 };
+	jx64_instrEnc_opcode2(enc, 0x0F, 0x80 | cc);
+	jx64_instrEnc_disp(enc, 1, JX64_SIZE_32, (uint32_t)displacement);
+
+	// Fix displacement
+	enc->m_Disp -= jx64_instrEnc_calcInstrSize(enc);
+
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
+
+	if (lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
+		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
+		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
+		jx_array_push_back(lbl->m_RefsArr, (jx_x64_label_ref_t){ .m_DispOffset = sec->m_Size + dispOffset, .m_NextInstrOffset = sec->m_Size + instrSize });
+	}
+
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+}
+
+bool jx64_jmp(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	return jx64_jmp_call_op(ctx, 0xE9, 0xFF, 0b100, op);
+}
+
+bool jx64_call(jx_x64_context_t* ctx, jx_x64_operand_t op)
+{
+	return jx64_jmp_call_op(ctx, 0xE8, 0xFF, 0b010, op);
+}
+
+bool jx64_cwd(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { JX64_OPERAND_SIZE_PREFIX, 0x99 };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+}
+
+bool jx64_cdq(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { 0x99 };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+}
+
+bool jx64_cqo(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { JX64_REX(1, 0, 0, 0), 0x99};
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+}
+
+bool jx64_cbw(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { JX64_OPERAND_SIZE_PREFIX, 0x98 };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+}
+
+bool jx64_cwde(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { 0x98 };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+}
+
+bool jx64_cdqe(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { JX64_REX(1, 0, 0, 0), 0x98 };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+}
+
+bool jx64_int3(jx_x64_context_t* ctx)
+{
+	const uint8_t instr[] = { 0xCC };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+}
+
+bool jx64_movss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	if (dst.m_Type == JX64_OPERAND_REG) {
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x10, false, dst, src);
+	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
+		// Same encoding as reg, r/m but with different opcode and reversed
+		// operands.
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x11, false, src, dst);
+	} else {
+		JX_NOT_IMPLEMENTED();
+	}
+	return false;
+}
+
+bool jx64_movsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	if (dst.m_Type == JX64_OPERAND_REG) {
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x10, false, dst, src);
+	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
+		// Same encoding as reg, r/m but with different opcode and reversed
+		// operands.
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x11, false, src, dst);
+	} else {
+		JX_NOT_IMPLEMENTED();
+	}
+	return false;
+}
+
+bool jx64_movaps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	if (dst.m_Type == JX64_OPERAND_REG) {
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x28, false, dst, src);
+	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
+		// Same encoding as reg, r/m but with different opcode and reversed
+		// operands.
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x29, false, src, dst);
+	} else {
+		JX_NOT_IMPLEMENTED();
+	}
+	return false;
+}
+
+bool jx64_movapd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	if (dst.m_Type == JX64_OPERAND_REG) {
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x28, false, dst, src);
+	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
+		// Same encoding as reg, r/m but with different opcode and reversed
+		// operands.
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x29, false, src, dst);
+	} else {
+		JX_NOT_IMPLEMENTED();
+	}
+	return false;
+}
+
+bool jx64_movups(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	if (dst.m_Type == JX64_OPERAND_REG) {
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x10, false, dst, src);
+	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
+		// Same encoding as reg, r/m but with different opcode and reversed
+		// operands.
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x11, false, src, dst);
+	} else {
+		JX_NOT_IMPLEMENTED();
+	}
+	return false;
+}
+
+bool jx64_movupd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	if (dst.m_Type == JX64_OPERAND_REG) {
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x10, false, dst, src);
+	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
+		// Same encoding as reg, r/m but with different opcode and reversed
+		// operands.
+		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x11, false, src, dst);
+	} else {
+		JX_NOT_IMPLEMENTED();
+	}
+	return false;
+}
+
+bool jx64_movd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_movd_movq(ctx, false, dst, src);
+}
+
+bool jx64_movq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_movd_movq(ctx, true, dst, src);
+}
+
+bool jx64_addps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x58, false, dst, src);
+}
+
+bool jx64_addss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x58, false, dst, src);
+}
+
+bool jx64_addpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x58, false, dst, src);
+}
+
+bool jx64_addsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x58, false, dst, src);
+}
+
+bool jx64_andnps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x55, false, dst, src);
+}
+
+bool jx64_andnpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x55, false, dst, src);
+}
+
+bool jx64_andps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x54, false, dst, src);
+}
+
+bool jx64_andpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x54, false, dst, src);
+}
+
+bool jx64_cmpps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
+{
+	return jx64_sse_binary_op_imm8(ctx, JX64_SSE_PREFIX_NONE, 0xC2, false, dst, src, true, imm8);
+}
+
+bool jx64_cmpss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
+{
+	return jx64_sse_binary_op_imm8(ctx, JX64_SSE_PREFIX_F3, 0xC2, false, dst, src, true, imm8);
+}
+
+bool jx64_cmppd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
+{
+	return jx64_sse_binary_op_imm8(ctx, JX64_SSE_PREFIX_66, 0xC2, false, dst, src, true, imm8);
+}
+
+bool jx64_cmpsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
+{
+	return jx64_sse_binary_op_imm8(ctx, JX64_SSE_PREFIX_F2, 0xC2, false, dst, src, true, imm8);
+}
+
+bool jx64_comiss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x2F, false, dst, src);
+}
+
+bool jx64_comisd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x2F, false, dst, src);
+}
+
+bool jx64_cvtsi2ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x2A, src.m_Size == JX64_SIZE_64, dst, src);
+}
+
+bool jx64_cvtsi2sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x2A, src.m_Size == JX64_SIZE_64, dst, src);
+}
+
+bool jx64_cvtss2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x2D, dst.m_Size == JX64_SIZE_64, dst, src);
+}
+
+bool jx64_cvtsd2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x2D, dst.m_Size == JX64_SIZE_64, dst, src);
+}
+
+bool jx64_cvttss2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x2C, dst.m_Size == JX64_SIZE_64, dst, src);
+}
+
+bool jx64_cvttsd2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x2C, dst.m_Size == JX64_SIZE_64, dst, src);
+}
+
+bool jx64_cvtsd2ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x5A, false, dst, src);
+}
+
+bool jx64_cvtss2sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x5A, false, dst, src);
+}
+
+bool jx64_divps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x5E, false, dst, src);
+}
+
+bool jx64_divss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x5E, false, dst, src);
+}
+
+bool jx64_divpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x5E, false, dst, src);
+}
+
+bool jx64_divsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x5E, false, dst, src);
+}
+
+bool jx64_maxps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x5F, false, dst, src);
+}
+
+bool jx64_maxss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x5F, false, dst, src);
+}
+
+bool jx64_maxpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x5F, false, dst, src);
+}
+
+bool jx64_maxsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x5F, false, dst, src);
+}
+
+bool jx64_minps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x5D, false, dst, src);
+}
+
+bool jx64_minss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x5D, false, dst, src);
+}
+
+bool jx64_minpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x5D, false, dst, src);
+}
+
+bool jx64_minsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x5D, false, dst, src);
+}
+
+bool jx64_mulps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x59, false, dst, src);
+}
+
+bool jx64_mulss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x59, false, dst, src);
+}
+
+bool jx64_mulpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x59, false, dst, src);
+}
+
+bool jx64_mulsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x59, false, dst, src);
+}
+
+bool jx64_orps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x56, false, dst, src);
+}
+
+bool jx64_orpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x56, false, dst, src);
+}
+
+bool jx64_rcpps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	const uint8_t instr[] = { 0xFD };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x53, false, dst, src);
 }
 
-bool jx64_cld(jx_x64_context_t* ctx)
+bool jx64_rcpss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	const uint8_t instr[] = { 0xFC };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x53, false, dst, src);
 }
 
-bool jx64_stc(jx_x64_context_t* ctx)
+bool jx64_rsqrtps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	const uint8_t instr[] = { 0xF9 };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x52, false, dst, src);
 }
 
-bool jx64_cmc(jx_x64_context_t* ctx)
+bool jx64_rsqrtss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	const uint8_t instr[] = { 0xF5 };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x52, false, dst, src);
 }
 
-bool jx64_clc(jx_x64_context_t* ctx)
+bool jx64_shufps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
 {
-	const uint8_t instr[] = { 0xF8 };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, &instr[0], JX_COUNTOF(instr));
+	return jx64_sse_binary_op_imm8(ctx, JX64_SSE_PREFIX_NONE, 0xC6, false, dst, src, true, imm8);
 }
 
-bool jx64_setcc(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t dst)
+bool jx64_shufpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
 {
-	JX_CHECK(dst.m_Type != JX64_OPERAND_SYM, "TODO");
-#if 0
-	jx_x64_label_t* lbl = NULL;
-	if (dst.m_Type == JX64_OPERAND_LBL) {
-		// RIP-relative addressing. Calculate offset to the specified label 
-		// and turn src operand into mem operand. 
-		// NOTE: Since, at this point, we don't know how long the instruction
-		// will end up being we cannot calculate the correct offset. We calculate
-		// the offset to the start of this instruction and jx64_binary_op_reg_mem() should
-		// take care of fixing it.
-		lbl = dst.u.m_Lbl;
-		const int32_t diff = lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND
-			? 0
-			: (int32_t)lbl->m_Offset - (int32_t)ctx->m_Size
-			;
-		dst = jx64_opMem(dst.m_Size, JX64_REG_RIP, JX64_REG_NONE, JX64_SCALE_1, diff);
-	}
-#endif
+	return jx64_sse_binary_op_imm8(ctx, JX64_SSE_PREFIX_66, 0xC6, false, dst, src, true, imm8);
+}
 
-	const bool invalidOperands = false
-		|| (dst.m_Type != JX64_OPERAND_REG && dst.m_Type != JX64_OPERAND_MEM)
-		|| dst.m_Size != JX64_SIZE_8
-		;
-	if (invalidOperands) {
-		JX_CHECK(false, "Invalid operands.");
-		return false;
-	}
+bool jx64_sqrtps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x51, false, dst, src);
+}
 
-	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+bool jx64_sqrtss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x51, false, dst, src);
+}
 
-	if (dst.m_Type == JX64_OPERAND_REG) {
-		const uint32_t reg = dst.u.m_Reg;
-		const bool needsREX = false
-			|| (JX64_REG_GET_ID(reg) >= JX64_REG_ID_RSP)
-			|| JX64_REG_IS_HI(reg)
-			;
+bool jx64_sqrtpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x51, false, dst, src);
+}
 
-		jx64_instrEnc_rex(enc, needsREX, 0, 0, 0, JX64_REG_HI(reg));
-		jx64_instrEnc_opcode2(enc, 0x0F, 0x90 | cc);
-		jx64_instrEnc_modrm(enc, 0b11, 0b000, JX64_REG_LO(reg));
-	} else if (dst.m_Type == JX64_OPERAND_MEM) {
-		JX_NOT_IMPLEMENTED();
-	} else {
-		JX_CHECK(false, "Invalid operands?");
-		return false;
-	}
+bool jx64_sqrtsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x51, false, dst, src);
+}
 
-#if 0
-	if (lbl && lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
-		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
-		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
-		jx_array_push_back(lbl->m_RefsArr, (jx_x64_label_ref_t) { .m_DispOffset = ctx->m_Size + dispOffset, .m_NextInstrOffset = ctx->m_Size + instrSize });
-	}
-#endif
+bool jx64_subps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x5C, false, dst, src);
+}
 
-	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
-	if (!jx64_encodeInstr(instr, enc)) {
-		return false;
-	}
+bool jx64_subss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x5C, false, dst, src);
+}
 
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+bool jx64_subpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x5C, false, dst, src);
+}
 
-	return false;
+bool jx64_subsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x5C, false, dst, src);
 }
 
-bool jx64_sar(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+bool jx64_ucomiss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_shift_rotate_op(ctx, 0b111, op, shift);
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x2E, false, dst, src);
 }
 
-bool jx64_sal(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+bool jx64_ucomisd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_shift_rotate_op(ctx, 0b100, op, shift);
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x2E, false, dst, src);
 }
 
-bool jx64_shr(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+bool jx64_unpckhps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_shift_rotate_op(ctx, 0b101, op, shift);
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x15, false, dst, src);
 }
 
-bool jx64_shl(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+bool jx64_unpckhpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_shift_rotate_op(ctx, 0b100, op, shift);
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x15, false, dst, src);
 }
 
-bool jx64_rcr(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+bool jx64_unpcklps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_shift_rotate_op(ctx, 0b011, op, shift);
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x14, false, dst, src);
 }
 
-bool jx64_rcl(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+bool jx64_unpcklpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_shift_rotate_op(ctx, 0b010, op, shift);
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x14, false, dst, src);
 }
 
-bool jx64_ror(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+bool jx64_xorps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_shift_rotate_op(ctx, 0b001, op, shift);
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x57, false, dst, src);
 }
 
-bool jx64_rol(jx_x64_context_t* ctx, jx_x64_operand_t op, jx_x64_operand_t shift)
+bool jx64_xorpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_shift_rotate_op(ctx, 0b000, op, shift);
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x57, false, dst, src);
 }
 
-bool jx64_cmovcc(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_punpcklbw(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return false;
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x60, false, dst, src);
 }
 
-bool jx64_bt(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_punpcklwd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return false;
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x61, false, dst, src);
 }
 
-bool jx64_btr(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_punpckldq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return false;
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x62, false, dst, src);
 }
 
-bool jx64_bts(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_punpcklqdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return false;
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x6C, false, dst, src);
 }
 
-bool jx64_btc(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_punpckhbw(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return false;
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x68, false, dst, src);
 }
 
-bool jx64_bsr(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_punpckhwd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return false;
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x69, false, dst, src);
 }
 
-bool jx64_bsf(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_punpckhdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return false;
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x6A, false, dst, src);
 }
 
-bool jx64_jcc(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t op)
+bool jx64_punpckhqdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	if (op.m_Type != JX64_OPERAND_LBL) {
-		JX_CHECK(false, "Can only jump to labels");
-		return false;
-	}
+	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x6D, false, dst, src);
+}
 
-	jx_x64_label_t* lbl = op.u.m_Lbl;
-	if (lbl->m_Section != JX64_SECTION_TEXT) {
-		JX_CHECK(false, "Can only jump to text section labels");
-		return false;
-	}
+bool jx64_vzeroupper(jx_x64_context_t* ctx)
+{
+	ctx->m_UpperYMMDirty = false;
 
-	jx_x64_section_t* sec = &ctx->m_Section[lbl->m_Section];
+	const uint8_t instr[] = { 0xC5, 0xF8, 0x77 };
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+}
 
-	const int32_t displacement = lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND
-		? 0
-		: (int32_t)lbl->m_Offset - (int32_t)sec->m_Size
-		;
+bool jx64_isUpperYMMDirty(jx_x64_context_t* ctx)
+{
+	return ctx->m_UpperYMMDirty;
+}
 
-	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t){ 0 };
-	jx64_instrEnc_opcode2(enc, 0x0F, 0x80 | cc);
-	jx64_instrEnc_disp(enc, 1, JX64_SIZE_32, (uint32_t)displacement);
+bool jx64_vmovss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_vex_mov_op(ctx, JX64_SSE_PREFIX_F3, 0x10, 0x11, true, dst, src);
+}
 
-	// Fix displacement
-	enc->m_Disp -= jx64_instrEnc_calcInstrSize(enc);
+bool jx64_vmovsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_vex_mov_op(ctx, JX64_SSE_PREFIX_F2, 0x10, 0x11, true, dst, src);
+}
 
-	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
-	if (!jx64_encodeInstr(instr, enc)) {
-		return false;
-	}
+bool jx64_vmovaps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_vex_mov_op(ctx, JX64_SSE_PREFIX_NONE, 0x28, 0x29, false, dst, src);
+}
 
-	if (lbl->m_Offset == JX64_LABEL_OFFSET_UNBOUND) {
-		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
-		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
-		jx_array_push_back(lbl->m_RefsArr, (jx_x64_label_ref_t){ .m_DispOffset = sec->m_Size + dispOffset, .m_NextInstrOffset = sec->m_Size + instrSize });
-	}
+bool jx64_vmovapd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_vex_mov_op(ctx, JX64_SSE_PREFIX_66, 0x28, 0x29, false, dst, src);
+}
 
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+bool jx64_vmovups(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_vex_mov_op(ctx, JX64_SSE_PREFIX_NONE, 0x10, 0x11, false, dst, src);
 }
 
-bool jx64_jmp(jx_x64_context_t* ctx, jx_x64_operand_t op)
+bool jx64_vmovupd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_jmp_call_op(ctx, 0xE9, 0xFF, 0b100, op);
+	return jx64_vex_mov_op(ctx, JX64_SSE_PREFIX_66, 0x10, 0x11, false, dst, src);
 }
 
-bool jx64_call(jx_x64_context_t* ctx, jx_x64_operand_t op)
+bool jx64_vaddps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_jmp_call_op(ctx, 0xE8, 0xFF, 0b010, op);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x58, false, dst, src1, src2);
 }
 
-bool jx64_cwd(jx_x64_context_t* ctx)
+bool jx64_vaddss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	const uint8_t instr[] = { JX64_OPERAND_SIZE_PREFIX, 0x99 };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x58, false, dst, src1, src2);
 }
 
-bool jx64_cdq(jx_x64_context_t* ctx)
+bool jx64_vaddpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	const uint8_t instr[] = { 0x99 };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x58, false, dst, src1, src2);
 }
 
-bool jx64_cqo(jx_x64_context_t* ctx)
+bool jx64_vaddsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	const uint8_t instr[] = { JX64_REX(1, 0, 0, 0), 0x99};
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x58, false, dst, src1, src2);
 }
 
-bool jx64_cbw(jx_x64_context_t* ctx)
+bool jx64_vandnps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	const uint8_t instr[] = { JX64_OPERAND_SIZE_PREFIX, 0x98 };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x55, false, dst, src1, src2);
 }
 
-bool jx64_cwde(jx_x64_context_t* ctx)
+bool jx64_vandnpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	const uint8_t instr[] = { 0x98 };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x55, false, dst, src1, src2);
 }
 
-bool jx64_cdqe(jx_x64_context_t* ctx)
+bool jx64_vandps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	const uint8_t instr[] = { JX64_REX(1, 0, 0, 0), 0x98 };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x54, false, dst, src1, src2);
 }
 
-bool jx64_int3(jx_x64_context_t* ctx)
+bool jx64_vandpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	const uint8_t instr[] = { 0xCC };
-	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr, JX_COUNTOF(instr));
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x54, false, dst, src1, src2);
 }
 
-bool jx64_movss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcmpps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8)
 {
-	if (dst.m_Type == JX64_OPERAND_REG) {
-		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x10, false, dst, src);
-	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
-		// Same encoding as reg, r/m but with different opcode and reversed
-		// operands.
-		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x11, false, src, dst);
-	} else {
-		JX_NOT_IMPLEMENTED();
-	}
-	return false;
+	return jx64_vex_op_imm8(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0xC2, false, dst, src1, src2, true, imm8);
 }
 
-bool jx64_movsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcmpss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8)
 {
-	if (dst.m_Type == JX64_OPERAND_REG) {
-		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x10, false, dst, src);
-	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
-		// Same encoding as reg, r/m but with different opcode and reversed
-		// operands.
-		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x11, false, src, dst);
-	} else {
-		JX_NOT_IMPLEMENTED();
-	}
-	return false;
+	return jx64_vex_op_imm8(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0xC2, false, dst, src1, src2, true, imm8);
 }
 
-bool jx64_movaps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcmppd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8)
 {
-	if (dst.m_Type == JX64_OPERAND_REG) {
-		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x28, false, dst, src);
-	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
-		// Same encoding as reg, r/m but with different opcode and reversed
-		// operands.
-		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x29, false, src, dst);
-	} else {
-		JX_NOT_IMPLEMENTED();
-	}
-	return false;
+	return jx64_vex_op_imm8(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0xC2, false, dst, src1, src2, true, imm8);
 }
 
-bool jx64_movapd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcmpsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8)
 {
-	if (dst.m_Type == JX64_OPERAND_REG) {
-		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x28, false, dst, src);
-	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
-		// Same encoding as reg, r/m but with different opcode and reversed
-		// operands.
-		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x29, false, src, dst);
-	} else {
-		JX_NOT_IMPLEMENTED();
-	}
-	return false;
+	return jx64_vex_op_imm8(ctx, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0xC2, false, dst, src1, src2, true, imm8);
 }
 
-bool jx64_movd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcomiss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	JX_NOT_IMPLEMENTED();
-	return false;
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x2F, false, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_movq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcomisd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	if (dst.m_Type == JX64_OPERAND_REG) {
-		if (dst.m_Size == JX64_SIZE_128) {
-			return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x6E, false, src, dst);
-		} else {
-			return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x7E, true, src, dst);
-		}
-	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
-#if 1
-		JX_NOT_IMPLEMENTED();
-#else
-		// Same encoding as reg, r/m but with different opcode and reversed
-		// operands.
-		return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x7E, src, dst);
-#endif
-	} else {
-		JX_NOT_IMPLEMENTED();
-	}
-	return false;
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x2F, false, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_addps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcvtsi2ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x58, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x2A, src2.m_Size == JX64_SIZE_64, dst, src1, src2);
 }
 
-bool jx64_addss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcvtsi2sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x58, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x2A, src2.m_Size == JX64_SIZE_64, dst, src1, src2);
 }
 
-bool jx64_addpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcvtss2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x58, false, dst, src);
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x2D, dst.m_Size == JX64_SIZE_64, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_addsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcvtsd2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x58, false, dst, src);
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x2D, dst.m_Size == JX64_SIZE_64, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_andnps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcvttss2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x55, false, dst, src);
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x2C, dst.m_Size == JX64_SIZE_64, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_andnpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcvttsd2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x55, false, dst, src);
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x2C, dst.m_Size == JX64_SIZE_64, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_andps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcvtsd2ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x54, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x5A, false, dst, src1, src2);
 }
 
-bool jx64_andpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vcvtss2sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x54, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x5A, false, dst, src1, src2);
 }
 
-bool jx64_cmpps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
+bool jx64_vdivps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	JX_NOT_IMPLEMENTED();
-	return false;
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x5E, false, dst, src1, src2);
 }
 
-bool jx64_cmpss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
+bool jx64_vdivss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	JX_NOT_IMPLEMENTED();
-	return false;
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x5E, false, dst, src1, src2);
 }
 
-bool jx64_cmppd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
+bool jx64_vdivpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	JX_NOT_IMPLEMENTED();
-	return false;
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x5E, false, dst, src1, src2);
 }
 
-bool jx64_cmpsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
+bool jx64_vdivsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	JX_NOT_IMPLEMENTED();
-	return false;
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x5E, false, dst, src1, src2);
 }
 
-bool jx64_comiss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vmaxps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x2F, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x5F, false, dst, src1, src2);
 }
 
-bool jx64_comisd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vmaxss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x2F, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x5F, false, dst, src1, src2);
 }
 
-bool jx64_cvtsi2ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vmaxpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x2A, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x5F, false, dst, src1, src2);
 }
 
-bool jx64_cvtsi2sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vmaxsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x2A, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x5F, false, dst, src1, src2);
 }
 
-bool jx64_cvtss2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vminps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x2D, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x5D, false, dst, src1, src2);
 }
 
-bool jx64_cvtsd2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vminss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x2D, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x5D, false, dst, src1, src2);
 }
 
-bool jx64_cvttss2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vminpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x2C, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x5D, false, dst, src1, src2);
 }
 
-bool jx64_cvttsd2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vminsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x2C, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x5D, false, dst, src1, src2);
 }
 
-bool jx64_cvtsd2ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vmulps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x5A, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x59, false, dst, src1, src2);
 }
 
-bool jx64_cvtss2sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vmulss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x5A, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x59, false, dst, src1, src2);
 }
 
-bool jx64_divps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vmulpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x5E, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x59, false, dst, src1, src2);
 }
 
-bool jx64_divss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vmulsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x5E, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x59, false, dst, src1, src2);
 }
 
-bool jx64_divpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vorps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x5E, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x56, false, dst, src1, src2);
 }
 
-bool jx64_divsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vorpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x5E, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x56, false, dst, src1, src2);
 }
 
-bool jx64_maxps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vrcpps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x5F, false, dst, src);
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x53, false, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_maxss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vrcpss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x5F, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x53, false, dst, src1, src2);
 }
 
-bool jx64_maxpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vrsqrtps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x5F, false, dst, src);
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x52, false, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_maxsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vrsqrtss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x5F, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x52, false, dst, src1, src2);
 }
 
-bool jx64_minps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vshufps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x5D, false, dst, src);
+	return jx64_vex_op_imm8(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0xC6, false, dst, src1, src2, true, imm8);
 }
 
-bool jx64_minss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vshufpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x5D, false, dst, src);
+	return jx64_vex_op_imm8(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0xC6, false, dst, src1, src2, true, imm8);
 }
 
-bool jx64_minpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vsqrtps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x5D, false, dst, src);
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x51, false, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_minsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vsqrtss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x5D, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x51, false, dst, src1, src2);
 }
 
-bool jx64_mulps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vsqrtpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x59, false, dst, src);
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x51, false, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_mulss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vsqrtsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x59, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x51, false, dst, src1, src2);
 }
 
-bool jx64_mulpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vsubps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x59, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x5C, false, dst, src1, src2);
 }
 
-bool jx64_mulsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vsubss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x59, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F3, JX64_OPCODE_MAP_0F, 0x5C, false, dst, src1, src2);
 }
 
-bool jx64_orps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vsubpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x56, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x5C, false, dst, src1, src2);
 }
 
-bool jx64_orpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vsubsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x56, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_F2, JX64_OPCODE_MAP_0F, 0x5C, false, dst, src1, src2);
 }
 
-bool jx64_rcpps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vucomiss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x53, false, dst, src);
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x2E, false, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_rcpss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vucomisd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x53, false, dst, src);
+	return jx64_sse_op(ctx, true, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x2E, false, JX64_REG_NONE, dst, src, false, 0);
 }
 
-bool jx64_rsqrtps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vunpckhps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x52, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x15, false, dst, src1, src2);
 }
 
-bool jx64_rsqrtss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vunpckhpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x52, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x15, false, dst, src1, src2);
 }
 
-bool jx64_shufps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
+bool jx64_vunpcklps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	JX_NOT_IMPLEMENTED();
-	return false;
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x14, false, dst, src1, src2);
 }
 
-bool jx64_shufpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8)
+bool jx64_vunpcklpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	JX_NOT_IMPLEMENTED();
-	return false;
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x14, false, dst, src1, src2);
 }
 
-bool jx64_sqrtps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vxorps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x51, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_NONE, JX64_OPCODE_MAP_0F, 0x57, false, dst, src1, src2);
 }
 
-bool jx64_sqrtss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vxorpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x51, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x57, false, dst, src1, src2);
 }
 
-bool jx64_sqrtpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vpunpcklbw(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x51, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x60, false, dst, src1, src2);
 }
 
-bool jx64_sqrtsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vpunpcklwd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x51, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x61, false, dst, src1, src2);
 }
 
-bool jx64_subps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vpunpckldq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x5C, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x62, false, dst, src1, src2);
 }
 
-bool jx64_subss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vpunpcklqdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F3, 0x5C, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x6C, false, dst, src1, src2);
 }
 
-bool jx64_subpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vpunpckhbw(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x5C, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x68, false, dst, src1, src2);
 }
 
-bool jx64_subsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vpunpckhwd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_F2, 0x5C, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x69, false, dst, src1, src2);
 }
 
-bool jx64_ucomiss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vpunpckhdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x2E, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x6A, false, dst, src1, src2);
 }
 
-bool jx64_ucomisd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vpunpckhqdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x2E, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F, 0x6D, false, dst, src1, src2);
 }
 
-bool jx64_unpckhps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vfmadd213ps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x15, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F38, 0xA8, false, dst, src1, src2);
 }
 
-bool jx64_unpckhpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vfmadd213ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x15, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F38, 0xA9, false, dst, src1, src2);
 }
 
-bool jx64_unpcklps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vfmadd213pd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x14, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F38, 0xA8, true, dst, src1, src2);
 }
 
-bool jx64_unpcklpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vfmadd213sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x14, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F38, 0xA9, true, dst, src1, src2);
 }
 
-bool jx64_xorps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vfmadd231ps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_NONE, 0x57, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F38, 0xB8, false, dst, src1, src2);
 }
 
-bool jx64_xorpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vfmadd231ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x57, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F38, 0xB9, false, dst, src1, src2);
 }
 
-bool jx64_punpcklbw(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vfmadd231pd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x60, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F38, 0xB8, true, dst, src1, src2);
 }
 
-bool jx64_punpcklwd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+bool jx64_vfmadd231sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x61, false, dst, src);
+	return jx64_vex_op(ctx, JX64_SSE_PREFIX_66, JX64_OPCODE_MAP_0F38, 0xB9, true, dst, src1, src2);
 }
 
-bool jx64_punpckldq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+// NOTE: Failing to register debug info for external tools is not fatal.
+static void jx64_registerDebugInfo(jx_x64_context_t* ctx)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x62, false, dst, src);
+	jx_x64_debug_func_t* funcArr = (jx_x64_debug_func_t*)jx_array_create(ctx->m_Allocator);
+	if (!funcArr) {
+		return;
+	}
+
+	const uint8_t* textAddr = ctx->m_Section[JX64_SECTION_TEXT].m_FinalAddr;
+	const uint32_t numSymbols = (uint32_t)jx_array_sizeu(ctx->m_SymbolArr);
+	for (uint32_t iSym = 0; iSym < numSymbols; ++iSym) {
+		jx_x64_symbol_t* sym = ctx->m_SymbolArr[iSym];
+		const bool isLocalFunc = true
+			&& sym->m_Kind == JX64_SYMBOL_FUNCTION
+			&& sym->m_Size != 0
+			&& !sym->m_ExternalAddr
+			;
+		if (isLocalFunc) {
+			jx_array_push_back(funcArr, (jx_x64_debug_func_t){
+				.m_Name = sym->m_Name,
+				.m_Addr = textAddr + sym->m_Label->m_Offset,
+				.m_Size = sym->m_Size
+			});
+		}
+	}
+
+	const uint32_t numFuncs = (uint32_t)jx_array_sizeu(funcArr);
+	if ((ctx->m_Flags & JX64_CONTEXT_FLAGS_PERF_MAP_Msk) != 0) {
+		jx64_debugWritePerfMap(funcArr, numFuncs);
+	}
+
+	if ((ctx->m_Flags & JX64_CONTEXT_FLAGS_GDB_JIT_Msk) != 0 && !ctx->m_GDBImage) {
+		ctx->m_GDBImage = jx64_debugRegisterGDBImage(ctx->m_Allocator, textAddr, ctx->m_Section[JX64_SECTION_TEXT].m_Size, funcArr, numFuncs);
+	}
+
+	jx_array_free(funcArr);
+}
+
+static bool jx64_unwindInitFunc(jx_x64_context_t* ctx, jx_x64_symbol_t* func)
+{
+	if (func->m_UnwindRegionArr) {
+		return true;
+	}
+
+	func->m_UnwindRegionArr = (jx_x64_unwind_region_t*)jx_array_create(ctx->m_Allocator);
+	func->m_UnwindOpArr = (jx_x64_unwind_op_t*)jx_array_create(ctx->m_Allocator);
+	if (!func->m_UnwindRegionArr || !func->m_UnwindOpArr) {
+		jx_array_free(func->m_UnwindRegionArr);
+		jx_array_free(func->m_UnwindOpArr);
+		return false;
+	}
+
+	// NOTE: The first region always starts at the function entry and holds the prologue.
+	jx_array_push_back(func->m_UnwindRegionArr, (jx_x64_unwind_region_t){ .m_Offset = 0, .m_FirstOp = 0 });
+
+	return true;
+}
+
+// Lowers the unwind ops of all functions into Win64 UNWIND_INFO structures (__xdata) 
+// and a RUNTIME_FUNCTION table (__pdata) with one entry per region. Regions after the 
+// first are chained to the first one so only the registers saved in that region are
+// described by their own unwind info. Addresses are filled in by ADDR32NB relocations.
+// Functions without unwind ops (leaf functions, import stubs) don't need an entry.
+static bool jx64_unwindEmitTables(jx_x64_context_t* ctx)
+{
+	if (ctx->m_FunctionTableSym) {
+		return true;
+	}
+
+	const uint32_t numSymbols = (uint32_t)jx_array_sizeu(ctx->m_SymbolArr);
+	bool hasUnwindInfo = false;
+	for (uint32_t iSym = 0; iSym < numSymbols && !hasUnwindInfo; ++iSym) {
+		jx_x64_symbol_t* sym = ctx->m_SymbolArr[iSym];
+		hasUnwindInfo = true
+			&& sym->m_Kind == JX64_SYMBOL_FUNCTION
+			&& jx_array_sizeu(sym->m_UnwindOpArr) != 0
+			&& jx64_unwindFuncFitsInfo(sym)
+			;
+	}
+
+	if (!hasUnwindInfo) {
+		return true;
+	}
+
+	jx_x64_symbol_t* xdataSym = jx64_globalVarDeclare(ctx, "__xdata");
+	jx_x64_symbol_t* pdataSym = jx64_globalVarDeclare(ctx, "__pdata");
+	if (!xdataSym || !pdataSym) {
+		return false;
+	}
+
+	uint8_t* xdata = (uint8_t*)jx_array_create(ctx->m_Allocator);
+	jx_x64_runtime_function_t* pdata = (jx_x64_runtime_function_t*)jx_array_create(ctx->m_Allocator);
+	uint16_t* codes = (uint16_t*)jx_array_create(ctx->m_Allocator);
+	if (!xdata || !pdata || !codes) {
+		jx_array_free(xdata);
+		jx_array_free(pdata);
+		jx_array_free(codes);
+		return false;
+	}
+
+	bool res = true;
+	uint32_t prevFuncEnd = 0;
+	for (uint32_t iSym = 0; iSym < numSymbols && res; ++iSym) {
+		jx_x64_symbol_t* func = ctx->m_SymbolArr[iSym];
+		const uint32_t numOps = (uint32_t)jx_array_sizeu(func->m_UnwindOpArr);
+		if (func->m_Kind != JX64_SYMBOL_FUNCTION || numOps == 0) {
+			continue;
+		}
+
+		// NOTE: Unwind info is optional. A function which cannot be described is left out of 
+		// the table; only unwinding through its frame is affected.
+		if (!jx64_unwindFuncFitsInfo(func)) {
+			JX_SYS_LOG_WARNING(NULL, "%s: Prologue too large for unwind info. Function skipped.\n", func->m_Name);
+			continue;
+		}
+
+		JX_CHECK(func->m_Label->m_Offset >= prevFuncEnd, "Function table must be sorted by address.");
+		prevFuncEnd = (uint32_t)func->m_Label->m_Offset + func->m_Size;
+
+		uint32_t primaryInfoOffset = 0;
+		uint32_t primaryEnd = 0;
+		const uint32_t numRegions = (uint32_t)jx_array_sizeu(func->m_UnwindRegionArr);
+		for (uint32_t iRegion = 0; iRegion < numRegions && res; ++iRegion) {
+			const jx_x64_unwind_region_t* region = &func->m_UnwindRegionArr[iRegion];
+			const bool isLastRegion = iRegion == numRegions - 1;
+			const uint32_t regionEnd = isLastRegion
+				? func->m_Size
+				: func->m_UnwindRegionArr[iRegion + 1].m_Offset
+				;
+			const uint32_t lastOp = isLastRegion
+				? numOps
+				: func->m_UnwindRegionArr[iRegion + 1].m_FirstOp
+				;
+			if (regionEnd <= region->m_Offset) {
+				continue;
+			}
+
+			// NOTE: Unwind codes are stored in reverse execution order.
+			jx_array_resize(codes, 0);
+			uint32_t prologSize = 0;
+			for (uint32_t iOp = lastOp; iOp > region->m_FirstOp; --iOp) {
+				const jx_x64_unwind_op_t* op = &func->m_UnwindOpArr[iOp - 1];
+				const uint32_t codeOffset = op->m_CodeOffset - region->m_Offset;
+				JX_CHECK(codeOffset <= 0xFF, "Prologue too large for unwind info.");
+
+				prologSize = jx_max_u32(prologSize, codeOffset);
+
+				const uint32_t regID = JX64_REG_GET_ID(op->m_Reg);
+				switch (op->m_Kind) {
+				case JX64_UNWIND_OP_PUSH_NONVOL: {
+					jx_array_push_back(codes, JX64_UNWIND_CODE(codeOffset, JX64_UWOP_PUSH_NONVOL, regID));
+				} break;
+				case JX64_UNWIND_OP_ALLOC_STACK: {
+					const uint32_t size = op->m_Operand;
+					JX_CHECK(size != 0 && (size & 7) == 0, "Stack allocations must be a multiple of 8 bytes.");
+					if (size <= 128) {
+						jx_array_push_back(codes, JX64_UNWIND_CODE(codeOffset, JX64_UWOP_ALLOC_SMALL, size / 8 - 1));
+					} else if (size / 8 <= UINT16_MAX) {
+						jx_array_push_back(codes, JX64_UNWIND_CODE(codeOffset, JX64_UWOP_ALLOC_LARGE, 0));
+						jx_array_push_back(codes, (uint16_t)(size / 8));
+					} else {
+						jx_array_push_back(codes, JX64_UNWIND_CODE(codeOffset, JX64_UWOP_ALLOC_LARGE, 1));
+						jx_array_push_back(codes, (uint16_t)(size & 0xFFFF));
+						jx_array_push_back(codes, (uint16_t)(size >> 16));
+					}
+				} break;
+				case JX64_UNWIND_OP_SAVE_NONVOL:
+				case JX64_UNWIND_OP_SAVE_XMM128: {
+					const bool isXMM = op->m_Kind == JX64_UNWIND_OP_SAVE_XMM128;
+					const uint32_t scale = isXMM ? 16 : 8;
+					const uint32_t offset = op->m_Operand;
+					JX_CHECK((offset % scale) == 0, "Misaligned save slot.");
+					if (offset / scale <= UINT16_MAX) {
+						jx_array_push_back(codes, JX64_UNWIND_CODE(codeOffset, isXMM ? JX64_UWOP_SAVE_XMM128 : JX64_UWOP_SAVE_NONVOL, regID));
+						jx_array_push_back(codes, (uint16_t)(offset / scale));
+					} else {
+						jx_array_push_back(codes, JX64_UNWIND_CODE(codeOffset, isXMM ? JX64_UWOP_SAVE_XMM128_FAR : JX64_UWOP_SAVE_NONVOL_FAR, regID));
+						jx_array_push_back(codes, (uint16_t)(offset & 0xFFFF));
+						jx_array_push_back(codes, (uint16_t)(offset >> 16));
+					}
+				} break;
+				default:
+					JX_CHECK(false, "Unknown unwind op.");
+					break;
+				}
+			}
+
+			const uint32_t numCodes = (uint32_t)jx_array_sizeu(codes);
+			JX_CHECK(numCodes <= 0xFF, "Too many unwind codes.");
+
+			// NOTE: The code array always has an even number of entries so that 
+			// UNWIND_INFO (and the chained RUNTIME_FUNCTION) stay 4-byte aligned.
+			if ((numCodes & 1) != 0) {
+				jx_array_push_back(codes, 0);
+			}
+
+			const bool isChained = iRegion != 0;
+			const uint32_t infoOffset = (uint32_t)jx_array_sizeu(xdata);
+			const uint8_t header[4] = {
+				(uint8_t)(JX64_UNWIND_INFO_VERSION | ((isChained ? JX64_UNWIND_FLAG_CHAININFO : 0) << 3)),
+				(uint8_t)prologSize,
+				(uint8_t)numCodes,
+				0 // No frame register; rsp doesn't change after the prologue.
+			};
+			jx_memcpy(jx_array_addnptr(xdata, sizeof(header)), header, sizeof(header));
+			jx_memcpy(jx_array_addnptr(xdata, sizeof(uint16_t) * jx_array_sizeu(codes)), codes, sizeof(uint16_t) * jx_array_sizeu(codes));
+
+			if (isChained) {
+				const uint32_t chainOffset = (uint32_t)jx_array_sizeu(xdata);
+				const jx_x64_runtime_function_t primary = {
+					.m_BeginAddress = 0,
+					.m_EndAddress = primaryEnd,
+					.m_UnwindInfoAddress = primaryInfoOffset
+				};
+				jx_memcpy(jx_array_addnptr(xdata, sizeof(primary)), &primary, sizeof(primary));
+				jx64_symbolAddRelocation(ctx, xdataSym, JX64_RELOC_ADDR32NB, chainOffset + 0, func->m_Name);
+				jx64_symbolAddRelocation(ctx, xdataSym, JX64_RELOC_ADDR32NB, chainOffset + 4, func->m_Name);
+				jx64_symbolAddRelocation(ctx, xdataSym, JX64_RELOC_ADDR32NB, chainOffset + 8, xdataSym->m_Name);
+			} else {
+				primaryInfoOffset = infoOffset;
+				primaryEnd = regionEnd;
+			}
+
+			const uint32_t entryOffset = (uint32_t)(jx_array_sizeu(pdata) * sizeof(jx_x64_runtime_function_t));
+			jx_array_push_back(pdata, (jx_x64_runtime_function_t){
+				.m_BeginAddress = region->m_Offset,
+				.m_EndAddress = regionEnd,
+				.m_UnwindInfoAddress = infoOffset
+			});
+			jx64_symbolAddRelocation(ctx, pdataSym, JX64_RELOC_ADDR32NB, entryOffset + 0, func->m_Name);
+			jx64_symbolAddRelocation(ctx, pdataSym, JX64_RELOC_ADDR32NB, entryOffset + 4, func->m_Name);
+			jx64_symbolAddRelocation(ctx, pdataSym, JX64_RELOC_ADDR32NB, entryOffset + 8, xdataSym->m_Name);
+		}
+	}
+
+	res = res
+		&& jx64_globalVarDefine(ctx, xdataSym, JX64_SECTION_RODATA, xdata, (uint32_t)jx_array_sizeu(xdata), 4)
+		&& jx64_globalVarDefine(ctx, pdataSym, JX64_SECTION_RODATA, (const uint8_t*)pdata, (uint32_t)(jx_array_sizeu(pdata) * sizeof(jx_x64_runtime_function_t)), 4)
+		;
+	if (res) {
+		ctx->m_FunctionTableSym = pdataSym;
+	}
+
+	jx_array_free(codes);
+	jx_array_free(pdata);
+	jx_array_free(xdata);
+
+	return res;
 }
 
-bool jx64_punpcklqdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
-{
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x6C, false, dst, src);
+// Checks that the unwind codes of each region of the function fit into an UNWIND_INFO 
+// structure (8-bit prologue offsets and code count). Must match jx64_unwindEmitTables().
+static bool jx64_unwindFuncFitsInfo(const jx_x64_symbol_t* func)
+{
+	const uint32_t numOps = (uint32_t)jx_array_sizeu(func->m_UnwindOpArr);
+	const uint32_t numRegions = (uint32_t)jx_array_sizeu(func->m_UnwindRegionArr);
+	for (uint32_t iRegion = 0; iRegion < numRegions; ++iRegion) {
+		const jx_x64_unwind_region_t* region = &func->m_UnwindRegionArr[iRegion];
+		const uint32_t lastOp = iRegion == numRegions - 1
+			? numOps
+			: func->m_UnwindRegionArr[iRegion + 1].m_FirstOp
+			;
+
+		uint32_t numCodes = 0;
+		for (uint32_t iOp = region->m_FirstOp; iOp < lastOp; ++iOp) {
+			const jx_x64_unwind_op_t* op = &func->m_UnwindOpArr[iOp];
+			if (op->m_CodeOffset - region->m_Offset > 0xFF) {
+				return false;
+			}
+
+			switch (op->m_Kind) {
+			case JX64_UNWIND_OP_PUSH_NONVOL: {
+				numCodes += 1;
+			} break;
+			case JX64_UNWIND_OP_ALLOC_STACK: {
+				numCodes += op->m_Operand <= 128
+					? 1
+					: (op->m_Operand / 8 <= UINT16_MAX ? 2 : 3)
+					;
+			} break;
+			case JX64_UNWIND_OP_SAVE_NONVOL:
+			case JX64_UNWIND_OP_SAVE_XMM128: {
+				const uint32_t scale = op->m_Kind == JX64_UNWIND_OP_SAVE_XMM128 ? 16 : 8;
+				numCodes += op->m_Operand / scale <= UINT16_MAX
+					? 2
+					: 3
+					;
+			} break;
+			default:
+				break;
+			}
+		}
+
+		if (numCodes > 0xFF) {
+			return false;
+		}
+	}
+
+	return true;
 }
 
-bool jx64_punpckhbw(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+// Tries to allocate the code buffer so that all addresses in the [targetAddrMin, targetAddrMax] 
+// range (i.e. the host modules providing external functions) are within rel32 range from 
+// any byte of the buffer. Falls back to letting the OS pick the address.
+static uint8_t* jx64_codeBufferAllocNear(uint64_t sz, uintptr_t targetAddrMin, uintptr_t targetAddrMax, uint8_t** writableAlias)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x68, false, dst, src);
-}
+	if (targetAddrMin > targetAddrMax) {
+		return jx64_codeBufferAllocAt(NULL, sz, writableAlias);
+	}
 
-bool jx64_punpckhwd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
-{
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x69, false, dst, src);
+	const uintptr_t granularityMask = (uintptr_t)JX64_VMEM_ALLOC_GRANULARITY - 1;
+	const uintptr_t belowAddr = (targetAddrMin - (uintptr_t)sz) & ~granularityMask;
+	const uintptr_t aboveAddr = (targetAddrMax + granularityMask) & ~granularityMask;
+	bool tryBelow = targetAddrMin > sz;
+	bool tryAbove = true;
+	for (uint32_t iTry = 0; iTry < JX64_VMEM_NEAR_ALLOC_TRIES && (tryBelow || tryAbove); ++iTry) {
+		const uintptr_t step = (uintptr_t)iTry * JX64_VMEM_NEAR_ALLOC_STEP;
+
+		if (tryBelow) {
+			uint8_t* desiredAddr = (uint8_t*)(belowAddr - step);
+			tryBelow = true
+				&& belowAddr > step
+				&& jx64_isRel32Reachable(desiredAddr, sz, (const void*)targetAddrMin)
+				&& jx64_isRel32Reachable(desiredAddr, sz, (const void*)targetAddrMax)
+				;
+			if (tryBelow) {
+				uint8_t* buffer = jx64_codeBufferAllocAt(desiredAddr, sz, writableAlias);
+				if (buffer) {
+					return buffer;
+				}
+			}
+		}
+
+		if (tryAbove) {
+			uint8_t* desiredAddr = (uint8_t*)(aboveAddr + step);
+			tryAbove = true
+				&& jx64_isRel32Reachable(desiredAddr, sz, (const void*)targetAddrMin)
+				&& jx64_isRel32Reachable(desiredAddr, sz, (const void*)targetAddrMax)
+				;
+			if (tryAbove) {
+				uint8_t* buffer = jx64_codeBufferAllocAt(desiredAddr, sz, writableAlias);
+				if (buffer) {
+					return buffer;
+				}
+			}
+		}
+	}
+
+	return jx64_codeBufferAllocAt(NULL, sz, writableAlias);
 }
 
-bool jx64_punpckhdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+// Plain buffers are allocated RW and reprotected once they've been written. Buffers with 
+// a writable alias are mapped RX right away (see jx64_codeHeapCreate()).
+static uint8_t* jx64_codeBufferAllocAt(uint8_t* desiredAddr, uint64_t sz, uint8_t** writableAlias)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x6A, false, dst, src);
+	if (!writableAlias) {
+		return (uint8_t*)jx_os_vmemAlloc(desiredAddr, sz, JX_VMEM_PROTECT_READ_Msk | JX_VMEM_PROTECT_WRITE_Msk);
+	}
+
+	void* alias = NULL;
+	uint8_t* buffer = (uint8_t*)jx_os_vmemAllocAliased(desiredAddr, sz, JX_VMEM_PROTECT_READ_Msk | JX_VMEM_PROTECT_EXEC_Msk, &alias);
+	*writableAlias = (uint8_t*)alias;
+
+	return buffer;
 }
 
-bool jx64_punpckhqdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
+static bool jx64_isRel32Reachable(const uint8_t* buffer, uint64_t sz, const void* targetAddr)
 {
-	return jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x6D, false, dst, src);
+	const int64_t distBegin = (int64_t)((intptr_t)targetAddr - (intptr_t)buffer);
+	const int64_t distEnd = (int64_t)((intptr_t)targetAddr - (intptr_t)(buffer + sz));
+	return true
+		&& distBegin >= INT32_MIN && distBegin <= INT32_MAX
+		&& distEnd >= INT32_MIN && distEnd <= INT32_MAX
+		;
 }
 
 static jx_x64_symbol_t* jx64_symbolAlloc(jx_x64_context_t* ctx, jx_x64_symbol_kind kind, const char* name)
@@ -1952,6 +4156,8 @@ static void jx64_symbolFree(jx_x64_context_t* ctx, jx_x64_symbol_t* sym)
 		JX_FREE(ctx->m_Allocator, reloc->m_SymbolName);
 	}
 	jx_array_free(sym->m_RelocArr);
+	jx_array_free(sym->m_UnwindRegionArr);
+	jx_array_free(sym->m_UnwindOpArr);
 	JX_FREE(ctx->m_Allocator, sym->m_Name);
 	if (sym->m_Label) {
 		jx64_labelFree(ctx, sym->m_Label);
@@ -1960,6 +4166,257 @@ static void jx64_symbolFree(jx_x64_context_t* ctx, jx_x64_symbol_t* sym)
 	JX_FREE(ctx->m_Allocator, sym);
 }
 
+static jx_x64_code_cache_entry_t* jx64_codeCacheFind(jx_x64_code_cache_t* cache, const char* funcName)
+{
+	const uint32_t numEntries = (uint32_t)jx_array_sizeu(cache->m_EntryArr);
+	for (uint32_t iEntry = 0; iEntry < numEntries; ++iEntry) {
+		jx_x64_code_cache_entry_t* entry = &cache->m_EntryArr[iEntry];
+		if (!jx_strcmp(entry->m_Name, funcName)) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static void jx64_codeCacheStore(jx_x64_context_t* ctx, jx_x64_symbol_t* func)
+{
+	jx_x64_code_cache_t* cache = ctx->m_CodeCache;
+	jx_allocator_i* allocator = cache->m_Allocator;
+
+	jx_x64_code_cache_entry_t* existingEntry = jx64_codeCacheFind(cache, func->m_Name);
+	if (existingEntry && existingEntry->m_Fingerprint == func->m_Fingerprint) {
+		return;
+	}
+
+	jx_x64_code_cache_entry_t entry = {
+		.m_Name = jx_strdup(func->m_Name, allocator),
+		.m_Fingerprint = func->m_Fingerprint,
+		.m_Code = (uint8_t*)JX_ALLOC(allocator, jx_max_u32(func->m_Size, 1)),
+		.m_RelocArr = (jx_x64_code_cache_reloc_t*)jx_array_create(allocator),
+		.m_Size = func->m_Size
+	};
+	if (!entry.m_Name || !entry.m_Code || !entry.m_RelocArr) {
+		jx64_codeCacheEntryFree(cache, &entry);
+		return;
+	}
+
+	const jx_x64_section_t* text = &ctx->m_Section[JX64_SECTION_TEXT];
+	jx_memcpy(entry.m_Code, &text->m_Buffer[func->m_Label->m_Offset], func->m_Size);
+
+	// NOTE: Small read-only globals without relocations are constants generated on demand (e.g. 
+	// floating point literals). Keep their contents so they can be recreated in other contexts.
+	const jx_x64_section_t* rodata = &ctx->m_Section[JX64_SECTION_RODATA];
+	const uint32_t numRelocs = (uint32_t)jx_array_sizeu(func->m_RelocArr);
+	for (uint32_t iReloc = 0; iReloc < numRelocs; ++iReloc) {
+		const jx_x64_relocation_t* reloc = &func->m_RelocArr[iReloc];
+		const jx_x64_symbol_t* target = jx64_symbolGetByName(ctx, reloc->m_SymbolName);
+
+		jx_x64_code_cache_reloc_t cachedReloc = {
+			.m_Reloc = {
+				.m_Kind = reloc->m_Kind,
+				.m_Offset = reloc->m_Offset,
+				.m_SymbolName = jx_strdup(reloc->m_SymbolName, allocator)
+			},
+			.m_SymbolKind = target
+				? target->m_Kind
+				: JX64_SYMBOL_FUNCTION
+				,
+		};
+
+		const bool isConst = true
+			&& target
+			&& target->m_Kind == JX64_SYMBOL_GLOBAL_VARIABLE
+			&& target->m_Label->m_Section == JX64_SECTION_RODATA
+			&& target->m_Label->m_Offset != JX64_LABEL_OFFSET_UNBOUND
+			&& target->m_Size != 0
+			&& target->m_Size <= JX64_CODE_CACHE_MAX_CONST_SIZE
+			&& jx_array_sizeu(target->m_RelocArr) == 0
+			;
+		if (isConst) {
+			const uint32_t constOffset = (uint32_t)target->m_Label->m_Offset;
+			cachedReloc.m_ConstSize = target->m_Size;
+			cachedReloc.m_ConstAlignment = constOffset != 0
+				? jx_min_u32(constOffset & (~constOffset + 1), JX64_CODE_CACHE_MAX_CONST_SIZE)
+				: JX64_CODE_CACHE_MAX_CONST_SIZE
+				;
+			jx_memcpy(cachedReloc.m_ConstData, &rodata->m_Buffer[constOffset], target->m_Size);
+		}
+
+		jx_array_push_back(entry.m_RelocArr, cachedReloc);
+	}
+
+	if (func->m_UnwindRegionArr) {
+		const uint32_t numRegions = (uint32_t)jx_array_sizeu(func->m_UnwindRegionArr);
+		const uint32_t numOps = (uint32_t)jx_array_sizeu(func->m_UnwindOpArr);
+		entry.m_UnwindRegionArr = (jx_x64_unwind_region_t*)jx_array_create(allocator);
+		entry.m_UnwindOpArr = (jx_x64_unwind_op_t*)jx_array_create(allocator);
+		if (!entry.m_UnwindRegionArr || !entry.m_UnwindOpArr) {
+			jx64_codeCacheEntryFree(cache, &entry);
+			return;
+		}
+
+		jx_array_resize(entry.m_UnwindRegionArr, numRegions);
+		jx_array_resize(entry.m_UnwindOpArr, numOps);
+		jx_memcpy(entry.m_UnwindRegionArr, func->m_UnwindRegionArr, sizeof(jx_x64_unwind_region_t) * numRegions);
+		jx_memcpy(entry.m_UnwindOpArr, func->m_UnwindOpArr, sizeof(jx_x64_unwind_op_t) * numOps);
+	}
+
+	if (existingEntry) {
+		jx64_codeCacheEntryFree(cache, existingEntry);
+		*existingEntry = entry;
+	} else {
+		jx_array_push_back(cache->m_EntryArr, entry);
+	}
+}
+
+static void jx64_codeCacheEntryFree(jx_x64_code_cache_t* cache, jx_x64_code_cache_entry_t* entry)
+{
+	jx_allocator_i* allocator = cache->m_Allocator;
+
+	const uint32_t numRelocs = (uint32_t)jx_array_sizeu(entry->m_RelocArr);
+	for (uint32_t iReloc = 0; iReloc < numRelocs; ++iReloc) {
+		JX_FREE(allocator, entry->m_RelocArr[iReloc].m_Reloc.m_SymbolName);
+	}
+	jx_array_free(entry->m_RelocArr);
+	jx_array_free(entry->m_UnwindRegionArr);
+	jx_array_free(entry->m_UnwindOpArr);
+	JX_FREE(allocator, entry->m_Code);
+	JX_FREE(allocator, entry->m_Name);
+	jx_memset(entry, 0, sizeof(jx_x64_code_cache_entry_t));
+}
+
+static bool jx64_codeHeapAllocSections(jx_x64_context_t* ctx, const uint32_t* sectionSize)
+{
+	jx_x64_code_heap_t* heap = ctx->m_CodeHeap;
+	const bool isCold = (ctx->m_Flags & JX64_CONTEXT_FLAGS_COLD_CODE_Msk) != 0;
+	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+		if (sectionSize[iSection] == 0) {
+			continue;
+		}
+
+		jx_x64_section_t* sec = &ctx->m_Section[iSection];
+		sec->m_FinalAddr = jx64_codeHeapAlloc(heap, (jx_x64_section_kind)iSection, sectionSize[iSection], isCold);
+		if (!sec->m_FinalAddr) {
+			return false;
+		}
+	}
+
+	// NOTE: Only the text section is accessible through jx64_getBuffer() so that label
+	// offsets can still be used to get function addresses.
+	jx_x64_code_buffer_t* cb = &ctx->m_CodeBuffer;
+	cb->m_Buffer = ctx->m_Section[JX64_SECTION_TEXT].m_FinalAddr;
+	cb->m_Size = jx_roundup_u32(sectionSize[JX64_SECTION_TEXT], JX64_CODE_HEAP_BLOCK_SIZE);
+	cb->m_ImageBase = heap->m_ImageBase;
+	cb->m_ImageSize = heap->m_ImageSize;
+
+	return true;
+}
+
+static jx_x64_code_heap_arena_t* jx64_codeHeapFindArena(jx_x64_code_heap_t* heap, const uint8_t* ptr)
+{
+	for (uint32_t iSection = 0; iSection < JX64_SECTION_COUNT; ++iSection) {
+		jx_x64_code_heap_arena_t* arena = &heap->m_Arena[iSection];
+		if (arena->m_Base && ptr >= arena->m_Base && ptr < arena->m_Base + arena->m_Size) {
+			return arena;
+		}
+	}
+
+	return NULL;
+}
+
+static void jx64_codeHeapArenaInit(jx_x64_code_heap_arena_t* arena, uint8_t* base, uint32_t size, uint32_t protectFlags, uint8_t* writeBase)
+{
+	arena->m_Base = size != 0
+		? base
+		: NULL
+		;
+	arena->m_Size = size;
+	arena->m_HotTop = 0;
+	arena->m_ColdBottom = size;
+	arena->m_ProtectFlags = protectFlags;
+	arena->m_WriteBase = size != 0
+		? writeBase
+		: NULL
+		;
+}
+
+// Returns the address through which [addr, addr + size) can be written. Arenas without a 
+// writable view (i.e. rodata) are made writable until jx64_codeHeapArenaEndWrite().
+// NOTE: Executable pages are never made writable because other contexts might be running 
+// code in them.
+static uint8_t* jx64_codeHeapArenaBeginWrite(jx_x64_code_heap_arena_t* arena, uint8_t* addr, uint32_t size)
+{
+	if (arena->m_WriteBase) {
+		return &arena->m_WriteBase[addr - arena->m_Base];
+	}
+
+	JX_CHECK((arena->m_ProtectFlags & JX_VMEM_PROTECT_EXEC_Msk) == 0, "Executable arena without a writable view.");
+	const uintptr_t pageMask = (uintptr_t)jx_os_vmemGetPageSize() - 1;
+	const uintptr_t begin = (uintptr_t)addr & ~pageMask;
+	const uintptr_t end = ((uintptr_t)addr + size + pageMask) & ~pageMask;
+	return jx_os_vmemProtect((void*)begin, end - begin, arena->m_ProtectFlags | JX_VMEM_PROTECT_WRITE_Msk)
+		? addr
+		: NULL
+		;
+}
+
+static bool jx64_codeHeapArenaEndWrite(jx_x64_code_heap_arena_t* arena, uint8_t* addr, uint32_t size)
+{
+	if (arena->m_WriteBase) {
+		if ((arena->m_ProtectFlags & JX_VMEM_PROTECT_EXEC_Msk) != 0) {
+			jx_os_vmemFlushInstructionCache(addr, size);
+		}
+		return true;
+	}
+
+	const uintptr_t pageMask = (uintptr_t)jx_os_vmemGetPageSize() - 1;
+	const uintptr_t begin = (uintptr_t)addr & ~pageMask;
+	const uintptr_t end = ((uintptr_t)addr + size + pageMask) & ~pageMask;
+	return jx_os_vmemProtect((void*)begin, end - begin, arena->m_ProtectFlags);
+}
+
+static void jx64_codeHeapArenaAddFreeBlock(jx_x64_code_heap_arena_t* arena, uint32_t offset, uint32_t size)
+{
+	const uint32_t sizeClass = jx64_codeHeapGetSizeClass(size);
+	jx_array_push_back(arena->m_FreeListArr[sizeClass], (jx_x64_code_heap_block_t){ .m_Offset = offset, .m_Size = size });
+}
+
+// Removes a free block right before or right after block from the free lists and 
+// merges it into block. Returns false if there is none.
+static bool jx64_codeHeapArenaMergeAdjacentFreeBlock(jx_x64_code_heap_arena_t* arena, jx_x64_code_heap_block_t* block)
+{
+	for (uint32_t iClass = 0; iClass < JX64_CODE_HEAP_NUM_SIZE_CLASSES; ++iClass) {
+		jx_x64_code_heap_block_t* freeList = arena->m_FreeListArr[iClass];
+		const uint32_t numBlocks = (uint32_t)jx_array_sizeu(freeList);
+		for (uint32_t iBlock = 0; iBlock < numBlocks; ++iBlock) {
+			const jx_x64_code_heap_block_t* freeBlock = &freeList[iBlock];
+			if (freeBlock->m_Offset + freeBlock->m_Size == block->m_Offset) {
+				block->m_Offset = freeBlock->m_Offset;
+				block->m_Size += freeBlock->m_Size;
+				jx_array_delswap(freeList, iBlock);
+				return true;
+			} else if (block->m_Offset + block->m_Size == freeBlock->m_Offset) {
+				block->m_Size += freeBlock->m_Size;
+				jx_array_delswap(freeList, iBlock);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static uint32_t jx64_codeHeapGetSizeClass(uint32_t size)
+{
+	uint32_t sizeClass = 0;
+	while (sizeClass + 1 < JX64_CODE_HEAP_NUM_SIZE_CLASSES && size >= (JX64_CODE_HEAP_BLOCK_SIZE << (sizeClass + 1))) {
+		++sizeClass;
+	}
+
+	return sizeClass;
+}
+
 // push, pop
 static bool jx64_stack_op_mem(jx_x64_instr_encoding_t* enc, uint8_t opcode, uint8_t modrm_reg, const jx_x64_mem_t* mem, jx_x64_size sz)
 {
@@ -2328,6 +4785,10 @@ static bool jx64_jmp_call_op(jx_x64_context_t* ctx, uint8_t opcode_lbl, uint8_t
 				return false;
 			}
 
+			const bool needsREX = false
+				|| JX64_REG_IS_HI(base_r)
+				|| JX64_REG_IS_HI(index_r)
+				;
 			const bool needsDisplacement = false
 				|| mem->m_Displacement != 0
 				|| JX64_REG_IS_RBP_R13(base_r)
@@ -2340,6 +4801,7 @@ static bool jx64_jmp_call_op(jx_x64_context_t* ctx, uint8_t opcode_lbl, uint8_t
 				;
 
 			jx64_instrEnc_addrSize(enc, JX64_REG_GET_SIZE(base_r) == JX64_SIZE_32);
+			jx64_instrEnc_rex(enc, needsREX, 0, 0, JX64_REG_HI(index_r), JX64_REG_HI(base_r));
 			jx64_instrEnc_opcode1(enc, opcode_rm);
 			jx64_instrEnc_modrm(enc, mod, modrm_reg, 0b100);
 			jx64_instrEnc_sib(enc, true, mem->m_Scale, JX64_REG_LO(index_r), JX64_REG_LO(base_r));
@@ -2356,6 +4818,7 @@ static bool jx64_jmp_call_op(jx_x64_context_t* ctx, uint8_t opcode_lbl, uint8_t
 			}
 
 			jx64_instrEnc_addrSize(enc, JX64_REG_GET_SIZE(index_r) == JX64_SIZE_32);
+			jx64_instrEnc_rex(enc, JX64_REG_IS_HI(index_r), 0, 0, JX64_REG_HI(index_r), 0);
 			jx64_instrEnc_opcode1(enc, opcode_rm);
 			jx64_instrEnc_modrm(enc, 0b00, modrm_reg, 0b100);
 			jx64_instrEnc_sib(enc, true, mem->m_Scale, JX64_REG_LO(index_r), 0b101);
@@ -2395,6 +4858,7 @@ static bool jx64_jmp_call_op(jx_x64_context_t* ctx, uint8_t opcode_lbl, uint8_t
 				;
 
 			jx64_instrEnc_addrSize(enc, JX64_REG_GET_SIZE(base_r) == JX64_SIZE_32);
+			jx64_instrEnc_rex(enc, JX64_REG_IS_HI(base_r), 0, 0, 0, JX64_REG_HI(base_r));
 			jx64_instrEnc_opcode1(enc, opcode_rm);
 			jx64_instrEnc_modrm(enc, mod, modrm_reg, JX64_REG_LO(base_r));
 			jx64_instrEnc_sib(enc, isBase_rsp, 0b00, 0b100, 0b100);
@@ -3370,7 +5834,167 @@ static bool jx64_movzx_reg_reg(jx_x64_instr_encoding_t* enc, jx_x64_reg dst_r, j
 	return true;
 }
 
+// NOTE: 66 (REX.W) 0F 6E /r moves r/m32 (r/m64) to xmm, 66 (REX.W) 0F 7E /r moves xmm to r/m32 (r/m64).
+static bool jx64_movd_movq(jx_x64_context_t* ctx, bool isQWord, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	const bool dstIsXMM = dst.m_Type == JX64_OPERAND_REG && JX64_REG_GET_SIZE(dst.u.m_Reg) == JX64_SIZE_128;
+	const bool srcIsXMM = src.m_Type == JX64_OPERAND_REG && JX64_REG_GET_SIZE(src.u.m_Reg) == JX64_SIZE_128;
+	if (dstIsXMM == srcIsXMM) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	return dstIsXMM
+		? jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x6E, isQWord, dst, src)
+		: jx64_sse_binary_op(ctx, JX64_SSE_PREFIX_66, 0x7E, isQWord, src, dst)
+		;
+}
+
+// bsf/bsr/popcnt/lzcnt/tzcnt share the same "op r, r/m" encoding. The F3 
+// forms (popcnt/lzcnt/tzcnt) use the mandatory prefix on top of the 0F xx opcode.
+// NOTE: lzcnt/tzcnt decode as bsr/bsf on CPUs without LZCNT/BMI1 support so the 
+// caller is responsible for checking CPU features before emitting them.
+static bool jx64_bit_scan_op(jx_x64_context_t* ctx, bool repPrefix, uint8_t opcode1, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	JX_CHECK(src.m_Type != JX64_OPERAND_SYM, "TODO");
+	const bool invalidOperands = false
+		|| dst.m_Type != JX64_OPERAND_REG  // Destination operand should always be a register
+		|| dst.m_Size == JX64_SIZE_8       // Destination cannot be an 8-bit register
+		|| (src.m_Type != JX64_OPERAND_REG && src.m_Type != JX64_OPERAND_MEM) // No immediate form
+		|| dst.m_Size != src.m_Size
+		;
+	if (invalidOperands) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+
+	if (repPrefix) {
+		jx64_instrEnc_lock_rep(enc, JX64_LOCK_REPEAT_REPNZ);
+	}
+
+	const uint8_t opcode[] = { 0x0F, opcode1 };
+	if (src.m_Type == JX64_OPERAND_MEM) {
+		if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, &src.u.m_Mem)) {
+			return false;
+		}
+	} else {
+		// NOTE: Reverse the order of operands because jx64_binary_op_reg_reg assumes the instruction
+		// is in the form "op r/m, r", but in this case it's actually "op r, r/m"
+		if (!jx64_binary_op_reg_reg(enc, opcode, JX_COUNTOF(opcode), src.u.m_Reg, dst.u.m_Reg)) {
+			return false;
+		}
+	}
+
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
+
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+}
+
+// bt/bts/btr/btc: "op r/m, r" is 0F xx /r and "op r/m, imm8" is 0F BA /modrm_reg ib.
+// NOTE: Register bit offsets on memory operands are not masked by the CPU, so 
+// "op [mem], r" can address any bit relative to [mem].
+static bool jx64_bit_test_op(jx_x64_context_t* ctx, uint8_t opcode_rm, uint8_t modrm_reg, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	JX_CHECK(dst.m_Type != JX64_OPERAND_SYM, "TODO");
+	const bool invalidOperands = false
+		|| (dst.m_Type != JX64_OPERAND_REG && dst.m_Type != JX64_OPERAND_MEM)
+		|| dst.m_Size == JX64_SIZE_8 // No 8-bit form
+		|| (src.m_Type != JX64_OPERAND_REG && src.m_Type != JX64_OPERAND_IMM)
+		|| (src.m_Type == JX64_OPERAND_REG && dst.m_Size != src.m_Size)
+		;
+	if (invalidOperands) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
+
+	if (src.m_Type == JX64_OPERAND_IMM) {
+		const uint8_t opcode[] = { 0x0F, 0xBA };
+		if (dst.m_Type == JX64_OPERAND_REG) {
+			if (!jx64_binary_op_reg_imm(enc, opcode, JX_COUNTOF(opcode), modrm_reg, dst.u.m_Reg, src.u.m_ImmI64 & 0xFF, JX64_SIZE_8)) {
+				return false;
+			}
+		} else {
+			if (!jx64_binary_op_mem_imm(enc, opcode, JX_COUNTOF(opcode), modrm_reg, &dst.u.m_Mem, dst.m_Size, src.u.m_ImmI64 & 0xFF, JX64_SIZE_8)) {
+				return false;
+			}
+		}
+	} else {
+		const uint8_t opcode[] = { 0x0F, opcode_rm };
+		if (dst.m_Type == JX64_OPERAND_REG) {
+			if (!jx64_binary_op_reg_reg(enc, opcode, JX_COUNTOF(opcode), dst.u.m_Reg, src.u.m_Reg)) {
+				return false;
+			}
+		} else {
+			if (!jx64_binary_op_reg_mem(enc, opcode, JX_COUNTOF(opcode), src.u.m_Reg, &dst.u.m_Mem)) {
+				return false;
+			}
+		}
+	}
+
+	jx_x64_instr_buffer_t* instr = &(jx_x64_instr_buffer_t) { 0 };
+	if (!jx64_encodeInstr(instr, enc)) {
+		return false;
+	}
+
+	return jx64_emitBytes(ctx, JX64_SECTION_TEXT, instr->m_Buffer, instr->m_Size);
+}
+
 static bool jx64_sse_binary_op(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefix prefix, uint8_t opcode1, bool forceREXW, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	return jx64_sse_binary_op_imm8(ctx, prefix, opcode1, forceREXW, dst, src, false, 0);
+}
+
+static bool jx64_sse_binary_op_imm8(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefix prefix, uint8_t opcode1, bool forceREXW, jx_x64_operand_t dst, jx_x64_operand_t src, bool hasImm8, uint8_t imm8)
+{
+	return jx64_sse_op(ctx, false, prefix, JX64_OPCODE_MAP_0F, opcode1, forceREXW, JX64_REG_NONE, dst, src, hasImm8, imm8);
+}
+
+static bool jx64_vex_op(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefix prefix, jx_x64_opcode_map map, uint8_t opcode, bool vexW, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2)
+{
+	return jx64_vex_op_imm8(ctx, prefix, map, opcode, vexW, dst, src1, src2, false, 0);
+}
+
+static bool jx64_vex_op_imm8(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefix prefix, jx_x64_opcode_map map, uint8_t opcode, bool vexW, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, bool hasImm8, uint8_t imm8)
+{
+	if (src1.m_Type != JX64_OPERAND_REG) {
+		JX_CHECK(false, "Invalid operands.");
+		return false;
+	}
+
+	return jx64_sse_op(ctx, true, prefix, map, opcode, vexW, src1.u.m_Reg, dst, src2, hasImm8, imm8);
+}
+
+// NOTE: Loads/stores/reg-reg moves. The scalar reg-reg forms are 3-operand merges in VEX 
+// (vmovss xmm1, xmm2, xmm3) so dst is used as the first source to match the legacy semantics.
+static bool jx64_vex_mov_op(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefix prefix, uint8_t opcodeLoad, uint8_t opcodeStore, bool isScalar, jx_x64_operand_t dst, jx_x64_operand_t src)
+{
+	if (dst.m_Type == JX64_OPERAND_REG) {
+		const jx_x64_reg src1 = (isScalar && src.m_Type == JX64_OPERAND_REG)
+			? dst.u.m_Reg
+			: JX64_REG_NONE
+			;
+		return jx64_sse_op(ctx, true, prefix, JX64_OPCODE_MAP_0F, opcodeLoad, false, src1, dst, src, false, 0);
+	} else if (dst.m_Type == JX64_OPERAND_MEM || dst.m_Type == JX64_OPERAND_SYM) {
+		// Same encoding as reg, r/m but with different opcode and reversed
+		// operands.
+		return jx64_sse_op(ctx, true, prefix, JX64_OPCODE_MAP_0F, opcodeStore, false, JX64_REG_NONE, src, dst, false, 0);
+	} else {
+		JX_NOT_IMPLEMENTED();
+	}
+	return false;
+}
+
+// NOTE: If isVEX is true the instruction is encoded with a VEX prefix (which replaces the 
+// mandatory prefix, REX and the opcode escape bytes) and vexSrc1 is encoded in VEX.vvvv. 
+// Use JX64_REG_NONE for instructions without a first source operand.
+static bool jx64_sse_op(jx_x64_context_t* ctx, bool isVEX, jx_x64_sse_mandatory_prefix prefix, jx_x64_opcode_map map, uint8_t opcode1, bool forceREXW, jx_x64_reg vexSrc1, jx_x64_operand_t dst, jx_x64_operand_t src, bool hasImm8, uint8_t imm8)
 {
 	bool invalidOperands = false
 		|| dst.m_Type != JX64_OPERAND_REG
@@ -3389,14 +6013,31 @@ static bool jx64_sse_binary_op(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefi
 
 	jx_x64_instr_encoding_t* enc = &(jx_x64_instr_encoding_t) { 0 };
 
-	if (prefix == JX64_SSE_PREFIX_66) {
-		jx64_instrEnc_operandSize(enc, true);
-	} else if (prefix == JX64_SSE_PREFIX_F2) {
-		jx64_instrEnc_lock_rep(enc, JX64_LOCK_REPEAT_REP);
-	} else if (prefix == JX64_SSE_PREFIX_F3) {
-		jx64_instrEnc_lock_rep(enc, JX64_LOCK_REPEAT_REPNZ);
+	if (isVEX) {
+		const bool is256 = false
+			|| JX64_REG_GET_SIZE(dst.u.m_Reg) == JX64_SIZE_256
+			|| (src.m_Type == JX64_OPERAND_REG && JX64_REG_GET_SIZE(src.u.m_Reg) == JX64_SIZE_256)
+			;
+		const uint8_t vvvv = vexSrc1 != JX64_REG_NONE
+			? (uint8_t)JX64_REG_GET_ID(vexSrc1)
+			: 0
+			;
+		jx64_instrEnc_vex(enc, map, prefix, is256 ? 1 : 0, vvvv);
+		jx64_instrEnc_opcode1(enc, opcode1);
+
+		if (is256) {
+			ctx->m_UpperYMMDirty = true;
+		}
+	} else {
+		if (prefix == JX64_SSE_PREFIX_66) {
+			jx64_instrEnc_operandSize(enc, true);
+		} else if (prefix == JX64_SSE_PREFIX_F2) {
+			jx64_instrEnc_lock_rep(enc, JX64_LOCK_REPEAT_REP);
+		} else if (prefix == JX64_SSE_PREFIX_F3) {
+			jx64_instrEnc_lock_rep(enc, JX64_LOCK_REPEAT_REPNZ);
+		}
+		jx64_instrEnc_opcode2(enc, 0x0F, opcode1);
 	}
-	jx64_instrEnc_opcode2(enc, 0x0F, opcode1);
 
 	if (src.m_Type == JX64_OPERAND_REG) {
 //		if (src.m_Size != JX64_SIZE_128) {
@@ -3548,6 +6189,10 @@ static bool jx64_sse_binary_op(jx_x64_context_t* ctx, jx_x64_sse_mandatory_prefi
 		return false;
 	}
 
+	// NOTE: The immediate must be encoded before calculating the relocation delta
+	// because RIP-relative displacements are relative to the end of the instruction.
+	jx64_instrEnc_imm(enc, hasImm8, JX64_SIZE_8, imm8);
+
 	if (sym) {
 		const uint32_t dispOffset = jx64_instrEnc_calcDispOffset(enc);
 		const uint32_t instrSize = jx64_instrEnc_calcInstrSize(enc);
@@ -3738,6 +6383,39 @@ static inline void jx64_instrEnc_operandSize(jx_x64_instr_encoding_t* enc, bool
 	enc->m_OperandSizeOverride = override;
 }
 
+static inline void jx64_instrEnc_vex(jx_x64_instr_encoding_t* enc, jx_x64_opcode_map map, jx_x64_sse_mandatory_prefix prefix, uint8_t l, uint8_t vvvv)
+{
+	// NOTE: VEX.pp uses a different order than jx_x64_sse_mandatory_prefix
+	static const uint8_t kVEXpp[] = {
+		[JX64_SSE_PREFIX_NONE] = 0b00,
+		[JX64_SSE_PREFIX_66]   = 0b01,
+		[JX64_SSE_PREFIX_F2]   = 0b11,
+		[JX64_SSE_PREFIX_F3]   = 0b10,
+	};
+
+	enc->m_HasVEX = 1;
+	enc->m_VEX_L = l;
+	enc->m_VEX_pp = kVEXpp[prefix];
+	enc->m_VEX_vvvv = vvvv;
+	enc->m_VEX_Map = map;
+}
+
+static uint32_t jx64_instrEnc_calcVEXSize(const jx_x64_instr_encoding_t* enc)
+{
+	if (!enc->m_HasVEX) {
+		return 0;
+	}
+
+	// NOTE: The 2-byte form can only encode VEX.R, the 0F opcode map and W0.
+	const bool hasCompactForm = true
+		&& enc->m_REX_X == 0
+		&& enc->m_REX_B == 0
+		&& enc->m_REX_W == 0
+		&& enc->m_VEX_Map == JX64_OPCODE_MAP_0F
+		;
+	return hasCompactForm ? 2 : 3;
+}
+
 static uint32_t jx64_instrEnc_calcInstrSize(const jx_x64_instr_encoding_t* encoding)
 {
 	const bool invalidEncoding = false
@@ -3752,7 +6430,10 @@ static uint32_t jx64_instrEnc_calcInstrSize(const jx_x64_instr_encoding_t* encod
 	sz += (encoding->m_LockRepeat != JX64_LOCK_REPEAT_NONE) ? 1 : 0;
 	sz += (encoding->m_AddressSizeOverride != 0) ? 1 : 0;
 	sz += (encoding->m_OperandSizeOverride != 0) ? 1 : 0;
-	sz += encoding->m_HasREX ? 1 : 0;
+	sz += encoding->m_HasVEX
+		? jx64_instrEnc_calcVEXSize(encoding)
+		: (encoding->m_HasREX ? 1 : 0)
+		;
 	sz += encoding->m_OpcodeSize;
 	sz += encoding->m_HasModRM ? 1 : 0;
 	sz += encoding->m_HasSIB ? 1 : 0;
@@ -3777,7 +6458,10 @@ static uint32_t jx64_instrEnc_calcDispOffset(const jx_x64_instr_encoding_t* enco
 	offset += (encoding->m_LockRepeat != JX64_LOCK_REPEAT_NONE) ? 1 : 0;
 	offset += (encoding->m_AddressSizeOverride != 0) ? 1 : 0;
 	offset += (encoding->m_OperandSizeOverride != 0) ? 1 : 0;
-	offset += encoding->m_HasREX ? 1 : 0;
+	offset += encoding->m_HasVEX
+		? jx64_instrEnc_calcVEXSize(encoding)
+		: (encoding->m_HasREX ? 1 : 0)
+		;
 	offset += encoding->m_OpcodeSize;
 	offset += encoding->m_HasModRM ? 1 : 0;
 	offset += encoding->m_HasSIB ? 1 : 0;
@@ -3823,7 +6507,16 @@ static bool jx64_encodeInstr(jx_x64_instr_buffer_t* instr, const jx_x64_instr_en
 		jx64_instrBuf_push8(instr, JX64_OPERAND_SIZE_PREFIX);
 	}
 
-	if (encoding->m_HasREX) {
+	if (encoding->m_HasVEX) {
+		if (jx64_instrEnc_calcVEXSize(encoding) == 2) {
+			jx64_instrBuf_push8(instr, 0xC5);
+			jx64_instrBuf_push8(instr, JX64_VEX2_BYTE1(encoding->m_REX_R, encoding->m_VEX_vvvv, encoding->m_VEX_L, encoding->m_VEX_pp));
+		} else {
+			jx64_instrBuf_push8(instr, 0xC4);
+			jx64_instrBuf_push8(instr, JX64_VEX3_BYTE1(encoding->m_REX_R, encoding->m_REX_X, encoding->m_REX_B, encoding->m_VEX_Map));
+			jx64_instrBuf_push8(instr, JX64_VEX3_BYTE2(encoding->m_REX_W, encoding->m_VEX_vvvv, encoding->m_VEX_L, encoding->m_VEX_pp));
+		}
+	} else if (encoding->m_HasREX) {
 		jx64_instrBuf_push8(instr, JX64_REX(encoding->m_REX_W, encoding->m_REX_R, encoding->m_REX_X, encoding->m_REX_B));
 	}
 
@@ -6,6 +6,7 @@
 #include <jlib/macros.h>
 
 typedef struct jx_allocator_i jx_allocator_i;
+typedef struct jx_string_buffer_t jx_string_buffer_t;
 
 typedef struct jx_x64_label_t jx_x64_label_t;
 typedef struct jx_x64_symbol_t jx_x64_symbol_t;
@@ -17,6 +18,7 @@ typedef enum jx_x64_size
 	JX64_SIZE_32  = 2,
 	JX64_SIZE_64  = 3,
 	JX64_SIZE_128 = 4, // XMM registers
+	JX64_SIZE_256 = 5, // YMM registers (VEX.256)
 } jx_x64_size;
 
 typedef enum jx_x64_scale
@@ -213,6 +215,24 @@ typedef enum jx_x64_reg
 	JX64_REG_XMM14 = JX64_REG(JX64_REG_ID_XMM14, 0, JX64_SIZE_128),
 	JX64_REG_XMM15 = JX64_REG(JX64_REG_ID_XMM15, 0, JX64_SIZE_128),
 
+	// 256-bit registers (YMM); aliases of the XMM registers with the same ID
+	JX64_REG_YMM0  = JX64_REG(JX64_REG_ID_XMM0, 0, JX64_SIZE_256),
+	JX64_REG_YMM1  = JX64_REG(JX64_REG_ID_XMM1, 0, JX64_SIZE_256),
+	JX64_REG_YMM2  = JX64_REG(JX64_REG_ID_XMM2, 0, JX64_SIZE_256),
+	JX64_REG_YMM3  = JX64_REG(JX64_REG_ID_XMM3, 0, JX64_SIZE_256),
+	JX64_REG_YMM4  = JX64_REG(JX64_REG_ID_XMM4, 0, JX64_SIZE_256),
+	JX64_REG_YMM5  = JX64_REG(JX64_REG_ID_XMM5, 0, JX64_SIZE_256),
+	JX64_REG_YMM6  = JX64_REG(JX64_REG_ID_XMM6, 0, JX64_SIZE_256),
+	JX64_REG_YMM7  = JX64_REG(JX64_REG_ID_XMM7, 0, JX64_SIZE_256),
+	JX64_REG_YMM8  = JX64_REG(JX64_REG_ID_XMM8, 0, JX64_SIZE_256),
+	JX64_REG_YMM9  = JX64_REG(JX64_REG_ID_XMM9, 0, JX64_SIZE_256),
+	JX64_REG_YMM10 = JX64_REG(JX64_REG_ID_XMM10, 0, JX64_SIZE_256),
+	JX64_REG_YMM11 = JX64_REG(JX64_REG_ID_XMM11, 0, JX64_SIZE_256),
+	JX64_REG_YMM12 = JX64_REG(JX64_REG_ID_XMM12, 0, JX64_SIZE_256),
+	JX64_REG_YMM13 = JX64_REG(JX64_REG_ID_XMM13, 0, JX64_SIZE_256),
+	JX64_REG_YMM14 = JX64_REG(JX64_REG_ID_XMM14, 0, JX64_SIZE_256),
+	JX64_REG_YMM15 = JX64_REG(JX64_REG_ID_XMM15, 0, JX64_SIZE_256),
+
 	JX64_REG_NONE = 0xFF,
 } jx_x64_reg;
 
@@ -249,6 +269,7 @@ typedef struct jx_x64_operand_t
 typedef enum jx_x64_section_kind
 {
 	JX64_SECTION_TEXT = 0,
+	JX64_SECTION_RODATA,
 	JX64_SECTION_DATA,
 
 	JX64_SECTION_COUNT,
@@ -258,6 +279,7 @@ typedef enum jx_x64_relocation_kind
 {
 	JX64_RELOC_ABSOLUTE = 0,
 	JX64_RELOC_ADDR64 = 1,
+	JX64_RELOC_ADDR32NB = 3, // 32-bit offset from the start of the code buffer (RVA)
 	JX64_RELOC_REL32 = 4,
 	JX64_RELOC_REL32_1 = 5,
 	JX64_RELOC_REL32_2 = 6,
@@ -279,6 +301,32 @@ typedef enum jx_x64_symbol_kind
 	JX64_SYMBOL_FUNCTION
 } jx_x64_symbol_kind;
 
+typedef enum jx_x64_unwind_op_kind
+{
+	JX64_UNWIND_OP_PUSH_NONVOL, // push reg
+	JX64_UNWIND_OP_ALLOC_STACK, // sub rsp, size
+	JX64_UNWIND_OP_SAVE_NONVOL, // mov [rsp + offset], reg
+	JX64_UNWIND_OP_SAVE_XMM128, // movaps [rsp + offset], xmm
+} jx_x64_unwind_op_kind;
+
+typedef struct jx_x64_unwind_op_t
+{
+	jx_x64_unwind_op_kind m_Kind;
+	jx_x64_reg m_Reg;
+	uint32_t m_Operand;    // Allocation size or slot offset relative to rsp after the prologue.
+	uint32_t m_CodeOffset; // Offset of the end of the instruction, relative to the start of the function.
+} jx_x64_unwind_op_t;
+
+// A contiguous range of a function's code with the same frame layout. The first region 
+// holds the prologue. Later regions describe code which runs after additional registers
+// have been saved (or before that, when laid out after such code). Each region lasts 
+// until the start of the next one.
+typedef struct jx_x64_unwind_region_t
+{
+	uint32_t m_Offset;  // Relative to the start of the function.
+	uint32_t m_FirstOp; // Index of the region's first op in the function's op array.
+} jx_x64_unwind_region_t;
+
 typedef struct jx_x64_symbol_t
 {
 	jx_x64_symbol_kind m_Kind;
@@ -286,37 +334,136 @@ typedef struct jx_x64_symbol_t
 	jx_x64_label_t* m_Label;
 	char* m_Name;
 	jx_x64_relocation_t* m_RelocArr;
+	void* m_ExternalAddr; // Non-NULL if the symbol lives outside the code buffer and relocations should target it directly.
+	jx_x64_unwind_region_t* m_UnwindRegionArr; // Functions only; NULL if the function never changes rsp.
+	jx_x64_unwind_op_t* m_UnwindOpArr;
+	uint64_t m_Fingerprint; // Functions only; if non-zero the code is stored in the context's code cache on jx64_funcEnd().
+	uint32_t m_Flags; // JX64_SYMBOL_FLAGS_xxx
+	JX_PAD(4);
 } jx_x64_symbol_t;
 
+#define JX64_SYMBOL_FLAGS_LOCAL_Pos 0 // Not visible outside the module (static functions/variables, constants); emitted as STB_LOCAL in ELF objects
+#define JX64_SYMBOL_FLAGS_LOCAL_Msk (1u << JX64_SYMBOL_FLAGS_LOCAL_Pos)
+
 typedef void* (*jx64GetExternalSymbolAddrCallback)(const char* symName, void* userData);
 
 typedef struct jx_x64_context_t jx_x64_context_t;
+typedef struct jx_x64_code_cache_t jx_x64_code_cache_t;
+typedef struct jx_x64_code_heap_t jx_x64_code_heap_t;
+
+#define JX64_CONTEXT_FLAGS_PERF_MAP_Pos 0 // Write perf-<pid>.map entries for all functions on finalize
+#define JX64_CONTEXT_FLAGS_PERF_MAP_Msk (1u << JX64_CONTEXT_FLAGS_PERF_MAP_Pos)
+#define JX64_CONTEXT_FLAGS_GDB_JIT_Pos  1 // Register the code with debuggers through the GDB JIT interface on finalize
+#define JX64_CONTEXT_FLAGS_GDB_JIT_Msk  (1u << JX64_CONTEXT_FLAGS_GDB_JIT_Pos)
+#define JX64_CONTEXT_FLAGS_HOT_PATCH_Pos 2 // Start every function with a patchable entry so it can be redirected after finalize (see jx64_funcHotPatch())
+#define JX64_CONTEXT_FLAGS_HOT_PATCH_Msk (1u << JX64_CONTEXT_FLAGS_HOT_PATCH_Pos)
+#define JX64_CONTEXT_FLAGS_COLD_CODE_Pos 3 // Place the code at the cold end of the code heap, away from frequently executed code (see jx64_setCodeHeap())
+#define JX64_CONTEXT_FLAGS_COLD_CODE_Msk (1u << JX64_CONTEXT_FLAGS_COLD_CODE_Pos)
+
+#define JX64_CODE_HEAP_FLAGS_LARGE_PAGES_Pos 0 // Back the code arena with large pages if the OS allows it (falls back to normal pages). NOTE: The arena is mapped RWX.
+#define JX64_CODE_HEAP_FLAGS_LARGE_PAGES_Msk (1u << JX64_CODE_HEAP_FLAGS_LARGE_PAGES_Pos)
+
+typedef struct jx_x64_code_heap_section_stats_t
+{
+	uint64_t m_ReservedSize;
+	uint64_t m_UsedSize;      // Live allocations
+	uint64_t m_FreeSize;      // Freed blocks available for reuse
+	uint64_t m_HotSize;       // Space handed out from the bottom of the arena
+	uint64_t m_ColdSize;      // Space handed out from the top of the arena
+	uint64_t m_NumAllocs;     // Live allocations
+	uint64_t m_NumFailedAllocs;
+} jx_x64_code_heap_section_stats_t;
+
+typedef struct jx_x64_code_heap_stats_t
+{
+	jx_x64_code_heap_section_stats_t m_Section[JX64_SECTION_COUNT];
+	uint64_t m_CodePageSize;
+	bool m_LargePages;
+	JX_PAD(7);
+} jx_x64_code_heap_stats_t;
 
 jx_x64_context_t* jx_x64_createContext(jx_allocator_i* allocator);
 void jx_x64_destroyContext(jx_x64_context_t* ctx);
+void jx64_setFlags(jx_x64_context_t* ctx, uint32_t flags);
+uint32_t jx64_getFlags(jx_x64_context_t* ctx);
 
 void jx64_resetBuffer(jx_x64_context_t* ctx);
 const uint8_t* jx64_getBuffer(jx_x64_context_t* ctx, uint32_t* sz);
 bool jx64_finalize(jx_x64_context_t* ctx, jx64GetExternalSymbolAddrCallback externalSymCb, void* userData);
 
+// Serializes the context to an ELF64 relocatable object (.text/.rodata/.data, symbols and 
+// relocations) which can be linked by the system linker or inspected by objdump & co. Symbols
+// without code or data become undefined symbols. Must be called before jx64_finalize().
+// The returned buffer is allocated from the specified allocator.
+uint8_t* jx64_emitELFObject(jx_x64_context_t* ctx, jx_allocator_i* allocator, uint32_t* sz);
+
 jx_x64_label_t* jx64_labelAlloc(jx_x64_context_t* ctx, jx_x64_section_kind section);
 void jx64_labelFree(jx_x64_context_t* ctx, jx_x64_label_t* lbl);
 void jx64_labelBind(jx_x64_context_t* ctx, jx_x64_label_t* lbl);
 uint32_t jx64_labelGetOffset(jx_x64_context_t* ctx, jx_x64_label_t* lbl);
 
+uint32_t jx64_sectionGetSize(jx_x64_context_t* ctx, jx_x64_section_kind section);
+const uint8_t* jx64_sectionGetBuffer(jx_x64_context_t* ctx, jx_x64_section_kind section); // Emitted contents, without relocations applied
+
 jx_x64_symbol_t* jx64_globalVarDeclare(jx_x64_context_t* ctx, const char* name);
-bool jx64_globalVarDefine(jx_x64_context_t* ctx, jx_x64_symbol_t* gv, const uint8_t* data, uint32_t sz, uint32_t alignment);
+bool jx64_globalVarDefine(jx_x64_context_t* ctx, jx_x64_symbol_t* gv, jx_x64_section_kind section, const uint8_t* data, uint32_t sz, uint32_t alignment);
 
 jx_x64_symbol_t* jx64_funcDeclare(jx_x64_context_t* ctx, const char* name);
 bool jx64_funcBegin(jx_x64_context_t* ctx, jx_x64_symbol_t* func);
 void jx64_funcEnd(jx_x64_context_t* ctx);
 
+// Annotated disassembly of the function's code (or of all functions in the context). Can be 
+// called before or after jx64_finalize(). Symbol names are printed in place of relocated operands.
+void jx64_funcPrint(jx_x64_context_t* ctx, jx_x64_symbol_t* func, jx_string_buffer_t* sb);
+void jx64_print(jx_x64_context_t* ctx, jx_string_buffer_t* sb);
+
+// Atomically redirects all calls to a finalized function (incl. calls through function 
+// pointers) to newAddr, e.g. a recompiled version of the function finalized in another 
+// context whose external symbols resolve to this context. Passing NULL restores the 
+// original code. Requires JX64_CONTEXT_FLAGS_HOT_PATCH and newAddr within rel32 range.
+// NOTE: Threads might still be running the previous code after this returns; keep it 
+// mapped (i.e. don't destroy its context) until they are known to have left it.
+bool jx64_funcHotPatch(jx_x64_context_t* ctx, jx_x64_symbol_t* func, const void* newAddr);
+
+// Machine code of functions, keyed by name and source fingerprint, which outlives the 
+// contexts it's used with. Functions with a fingerprint are stored in the cache when 
+// emitted and can be re-emitted later, in another context, without regenerating them.
+// Cached code is only valid as long as the rest of the pipeline is configured the same.
+jx_x64_code_cache_t* jx64_codeCacheCreate(jx_allocator_i* allocator);
+void jx64_codeCacheDestroy(jx_x64_code_cache_t* cache);
+bool jx64_codeCacheContains(jx_x64_code_cache_t* cache, const char* funcName, uint64_t fingerprint);
+void jx64_setCodeCache(jx_x64_context_t* ctx, jx_x64_code_cache_t* cache); // NOTE: Call after jx64_setFlags().
+
+// A long-lived region of executable memory shared by many contexts. Each finalized context 
+// gets its sections from the heap instead of mapping its own pages and gives them back when 
+// destroyed, so small modules don't waste whole pages and code stays packed in the same 
+// (optionally large) pages, reducing iTLB misses. All arenas are within rel32 range of 
+// each other. Not thread-safe.
+jx_x64_code_heap_t* jx64_codeHeapCreate(jx_allocator_i* allocator, uint32_t codeSize, uint32_t rodataSize, uint32_t dataSize, uint32_t flags);
+void jx64_codeHeapDestroy(jx_x64_code_heap_t* heap); // NOTE: Destroy all contexts using the heap first.
+uint8_t* jx64_codeHeapAlloc(jx_x64_code_heap_t* heap, jx_x64_section_kind section, uint32_t size, bool isCold);
+void jx64_codeHeapFree(jx_x64_code_heap_t* heap, uint8_t* ptr);
+bool jx64_codeHeapWrite(jx_x64_code_heap_t* heap, uint8_t* dst, const void* src, uint32_t size);
+void jx64_codeHeapGetStats(const jx_x64_code_heap_t* heap, jx_x64_code_heap_stats_t* stats);
+void jx64_setCodeHeap(jx_x64_context_t* ctx, jx_x64_code_heap_t* heap); // NOTE: Call before jx64_finalize().
+
+// Emits the cached code of func in place of jx64_funcBegin()/jx64_funcEnd(). Symbols referenced 
+// by the code must be declared by the caller, except for constants which are recreated.
+bool jx64_funcEmitCached(jx_x64_context_t* ctx, jx_x64_symbol_t* func, uint64_t fingerprint);
+
+// Unwind information for the current function. Ops are recorded right after emitting the 
+// instruction they describe. A new region starts at the current position.
+bool jx64_unwindBeginRegion(jx_x64_context_t* ctx);
+bool jx64_unwindOp(jx_x64_context_t* ctx, jx_x64_unwind_op_kind kind, jx_x64_reg reg, uint32_t operand);
+
 jx_x64_symbol_t* jx64_symbolGetByName(jx_x64_context_t* ctx, const char* name);
+const uint8_t* jx64_symbolGetAddress(jx_x64_context_t* ctx, jx_x64_symbol_t* sym); // NULL until finalized
 void jx64_symbolAddRelocation(jx_x64_context_t* ctx, jx_x64_symbol_t* sym, jx_x64_relocation_kind kind, uint32_t offset, const char* symbolName);
 bool jx64_symbolSetExternalAddress(jx_x64_context_t* ctx, jx_x64_symbol_t* sym, void* ptr);
 
 bool jx64_emitBytes(jx_x64_context_t* ctx, jx_x64_section_kind section, const uint8_t* bytes, uint32_t n);
 bool jx64_nop(jx_x64_context_t* ctx, uint32_t n);
+bool jx64_alignText(jx_x64_context_t* ctx, uint32_t alignment);
 bool jx64_push(jx_x64_context_t* ctx, jx_x64_operand_t op);
 bool jx64_pop(jx_x64_context_t* ctx, jx_x64_operand_t op);
 bool jx64_mov(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
@@ -336,6 +483,7 @@ bool jx64_neg(jx_x64_context_t* ctx, jx_x64_operand_t op);   // Two's Complement
 bool jx64_mul(jx_x64_context_t* ctx, jx_x64_operand_t op);   // Unsigned Multiply AL, AX or EAX by register or memory
 bool jx64_div(jx_x64_context_t* ctx, jx_x64_operand_t op);   // Unsigned Divide AL, AX or EAX by register or memory
 bool jx64_idiv(jx_x64_context_t* ctx, jx_x64_operand_t op);  // Signed Devide AL, AX or EAX by register or memory
+bool jx64_imul1(jx_x64_context_t* ctx, jx_x64_operand_t op); // Signed Multiply AL, AX or EAX by register or memory
 bool jx64_inc(jx_x64_context_t* ctx, jx_x64_operand_t op);
 bool jx64_dec(jx_x64_context_t* ctx, jx_x64_operand_t op);
 bool jx64_imul(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
@@ -363,6 +511,10 @@ bool jx64_bts(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src)
 bool jx64_btc(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src); // Bit Test and Complement
 bool jx64_bsr(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src); // Bit Scan Reverse
 bool jx64_bsf(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src); // Bit Scan Forward
+bool jx64_popcnt(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src); // Return the Count of Number of Bits Set to 1 (POPCNT)
+bool jx64_lzcnt(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);  // Count the Number of Leading Zero Bits (LZCNT)
+bool jx64_tzcnt(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);  // Count the Number of Trailing Zero Bits (BMI1)
+bool jx64_bswap(jx_x64_context_t* ctx, jx_x64_operand_t op);                          // Byte Swap
 bool jx64_jcc(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t lbl);
 bool jx64_jmp(jx_x64_context_t* ctx, jx_x64_operand_t op);
 bool jx64_call(jx_x64_context_t* ctx, jx_x64_operand_t op);
@@ -378,6 +530,8 @@ bool jx64_movss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t sr
 bool jx64_movsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
 bool jx64_movaps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
 bool jx64_movapd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_movups(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_movupd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
 bool jx64_movd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
 bool jx64_movq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
 bool jx64_addps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
@@ -451,6 +605,97 @@ bool jx64_punpckhwd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_
 bool jx64_punpckhdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
 bool jx64_punpckhqdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
 
+// AVX (VEX-encoded). 3-operand forms are non-destructive (dst = src1 op src2). Operand size
+// (XMM/YMM) selects VEX.128/VEX.256. Scalar forms copy the upper lanes of dst from src1.
+bool jx64_vzeroupper(jx_x64_context_t* ctx);
+bool jx64_isUpperYMMDirty(jx_x64_context_t* ctx); // true if a VEX.256 instruction was emitted since the last vzeroupper
+bool jx64_vmovss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vmovsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vmovaps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vmovapd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vmovups(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vmovupd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vaddps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vaddss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vaddpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vaddsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vandnps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vandnpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vandps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vandpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vcmpps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8);
+bool jx64_vcmpss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8);
+bool jx64_vcmppd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8);
+bool jx64_vcmpsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8);
+bool jx64_vcomiss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vcomisd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vcvtsi2ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vcvtsi2sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vcvtss2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vcvtsd2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vcvttss2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vcvttsd2si(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vcvtsd2ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vcvtss2sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vdivps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vdivss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vdivpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vdivsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vmaxps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vmaxss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vmaxpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vmaxsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vminps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vminss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vminpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vminsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vmulps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vmulss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vmulpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vmulsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vorps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vorpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vrcpps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vrcpss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vrsqrtps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vrsqrtss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vshufps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8);
+bool jx64_vshufpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8);
+bool jx64_vsqrtps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vsqrtss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vsqrtpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vsqrtsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vsubps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vsubss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vsubpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vsubsd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vucomiss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vucomisd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+bool jx64_vunpckhps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vunpckhpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vunpcklps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vunpcklpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vxorps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vxorpd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vpunpcklbw(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vpunpcklwd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vpunpckldq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vpunpcklqdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vpunpckhbw(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vpunpckhwd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vpunpckhdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vpunpckhqdq(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+
+// FMA3. dst is both the accumulator/multiplicand and the destination (e.g. 231: dst = src1 * src2 + dst).
+bool jx64_vfmadd213ps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vfmadd213ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vfmadd213pd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vfmadd213sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vfmadd231ps(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vfmadd231ss(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vfmadd231pd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+bool jx64_vfmadd231sd(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+
 static inline jx_x64_operand_t jx64_opReg(jx_x64_reg reg)
 {
 	return (jx_x64_operand_t){ .m_Type = JX64_OPERAND_REG, .m_Size = JX64_REG_GET_SIZE(reg), .u.m_Reg = reg };
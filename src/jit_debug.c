@@ -0,0 +1,268 @@
+#include "jit_debug.h"
+#include "jit_elf.h"
+#include <jlib/allocator.h>
+#include <jlib/dbg.h>
+#include <jlib/math.h>
+#include <jlib/memory.h>
+#include <jlib/os.h>
+#include <jlib/string.h>
+#include <process.h> // _getpid
+#include <Windows.h> // RtlAddFunctionTable/RtlDeleteFunctionTable
+
+typedef enum jx_x64_gdb_image_section
+{
+	JX64_GDB_IMAGE_SECTION_NULL = 0,
+	JX64_GDB_IMAGE_SECTION_TEXT,
+	JX64_GDB_IMAGE_SECTION_SHSTRTAB,
+	JX64_GDB_IMAGE_SECTION_SYMTAB,
+	JX64_GDB_IMAGE_SECTION_STRTAB,
+
+	JX64_GDB_IMAGE_SECTION_COUNT
+} jx_x64_gdb_image_section;
+
+// NOTE: The following must match the declarations in GDB's documentation (JIT Interface).
+// The debugger places a breakpoint in __jit_debug_register_code() and walks the list
+// in __jit_debug_descriptor every time it's hit.
+typedef enum jit_actions_t
+{
+	JIT_NOACTION = 0,
+	JIT_REGISTER_FN,
+	JIT_UNREGISTER_FN
+} jit_actions_t;
+
+struct jit_code_entry
+{
+	struct jit_code_entry* next_entry;
+	struct jit_code_entry* prev_entry;
+	const char* symfile_addr;
+	uint64_t symfile_size;
+};
+
+struct jit_descriptor
+{
+	uint32_t version;
+	uint32_t action_flag; // jit_actions_t
+	struct jit_code_entry* relevant_entry;
+	struct jit_code_entry* first_entry;
+};
+
+#if JX_COMPILER_MSVC
+__declspec(noinline) void __jit_debug_register_code(void);
+#else
+__attribute__((noinline)) void __jit_debug_register_code(void);
+#endif
+
+struct jit_descriptor __jit_debug_descriptor = { 1, JIT_NOACTION, NULL, NULL };
+
+typedef struct jx_x64_gdb_image_t
+{
+	jx_allocator_i* m_Allocator;
+	uint8_t* m_ELFImage;
+	struct jit_code_entry m_CodeEntry;
+} jx_x64_gdb_image_t;
+
+static jx_os_file_t* s_PerfMapFile = NULL;
+
+static uint32_t jx64_debugAppendString(char* strTab, uint32_t* strTabSize, const char* str);
+
+bool jx64_debugWritePerfMap(const jx_x64_debug_func_t* funcArr, uint32_t numFuncs)
+{
+	// NOTE: The file is kept open for the lifetime of the process. Opening it the first
+	// time truncates any stale map left behind by an older process with the same pid.
+	if (!s_PerfMapFile) {
+		char filename[64];
+		jx_snprintf(filename, JX_COUNTOF(filename), "perf-%d.map", _getpid());
+		s_PerfMapFile = jx_os_fileOpenWrite(JX_FILE_BASE_DIR_TEMP, filename);
+		if (!s_PerfMapFile) {
+			return false;
+		}
+	}
+
+	for (uint32_t iFunc = 0; iFunc < numFuncs; ++iFunc) {
+		const jx_x64_debug_func_t* func = &funcArr[iFunc];
+
+		char line[512];
+		const int32_t len = jx_snprintf(line, JX_COUNTOF(line), "%llx %x %s\n", (uint64_t)(uintptr_t)func->m_Addr, func->m_Size, func->m_Name);
+		if (len <= 0) {
+			continue;
+		}
+
+		jx_os_fileWrite(s_PerfMapFile, line, jx_min_u32((uint32_t)len, JX_COUNTOF(line) - 1));
+	}
+
+	jx_os_fileFlush(s_PerfMapFile);
+
+	return true;
+}
+
+jx_x64_gdb_image_t* jx64_debugRegisterGDBImage(jx_allocator_i* allocator, const uint8_t* textAddr, uint32_t textSize, const jx_x64_debug_func_t* funcArr, uint32_t numFuncs)
+{
+	static const char kFilename[] = "jitcc";
+	static const char kSectionNames[] = "\0.text\0.shstrtab\0.symtab\0.strtab";
+	static const uint32_t kSectionNameOffset[JX64_GDB_IMAGE_SECTION_COUNT] = { 0, 1, 7, 17, 25 };
+
+	// Calculate the image layout: header, string tables, symbol table and section headers.
+	const uint32_t numSymbols = numFuncs + 2; // Null symbol + file symbol
+	uint32_t strTabCapacity = 1 + sizeof(kFilename);
+	for (uint32_t iFunc = 0; iFunc < numFuncs; ++iFunc) {
+		strTabCapacity += jx_strlen(funcArr[iFunc].m_Name) + 1;
+	}
+
+	const uint32_t shstrtabOffset = sizeof(jx_elf64_header_t);
+	const uint32_t strtabOffset = shstrtabOffset + sizeof(kSectionNames);
+	const uint32_t symtabOffset = jx_roundup_u32(strtabOffset + strTabCapacity, 8);
+	const uint32_t shdrOffset = symtabOffset + numSymbols * sizeof(jx_elf64_symbol_t);
+	const uint32_t imageSize = shdrOffset + JX64_GDB_IMAGE_SECTION_COUNT * sizeof(jx_elf64_section_header_t);
+
+	jx_x64_gdb_image_t* img = (jx_x64_gdb_image_t*)JX_ALLOC(allocator, sizeof(jx_x64_gdb_image_t));
+	if (!img) {
+		return NULL;
+	}
+
+	jx_memset(img, 0, sizeof(jx_x64_gdb_image_t));
+	img->m_Allocator = allocator;
+	img->m_ELFImage = (uint8_t*)JX_ALLOC(allocator, imageSize);
+	if (!img->m_ELFImage) {
+		JX_FREE(allocator, img);
+		return NULL;
+	}
+
+	uint8_t* elf = img->m_ELFImage;
+	jx_memset(elf, 0, imageSize);
+
+	jx_elf64_header_t* hdr = (jx_elf64_header_t*)elf;
+	hdr->m_Ident[0] = 0x7F;
+	hdr->m_Ident[1] = 'E';
+	hdr->m_Ident[2] = 'L';
+	hdr->m_Ident[3] = 'F';
+	hdr->m_Ident[4] = JX_ELF_CLASS64;
+	hdr->m_Ident[5] = JX_ELF_DATA2LSB;
+	hdr->m_Ident[6] = JX_ELF_VERSION;
+	hdr->m_Type = JX_ELF_ET_REL;
+	hdr->m_Machine = JX_ELF_EM_X86_64;
+	hdr->m_Version = JX_ELF_VERSION;
+	hdr->m_SectionHeaderOffset = shdrOffset;
+	hdr->m_HeaderSize = sizeof(jx_elf64_header_t);
+	hdr->m_SectionHeaderEntrySize = sizeof(jx_elf64_section_header_t);
+	hdr->m_NumSectionHeaders = JX64_GDB_IMAGE_SECTION_COUNT;
+	hdr->m_SectionNameStringTableIndex = JX64_GDB_IMAGE_SECTION_SHSTRTAB;
+
+	jx_memcpy(&elf[shstrtabOffset], kSectionNames, sizeof(kSectionNames));
+
+	char* strTab = (char*)&elf[strtabOffset];
+	uint32_t strTabSize = 1;
+
+	jx_elf64_symbol_t* symTab = (jx_elf64_symbol_t*)&elf[symtabOffset];
+	symTab[1].m_Name = jx64_debugAppendString(strTab, &strTabSize, kFilename);
+	symTab[1].m_Info = JX_ELF_ST_INFO(JX_ELF_STB_LOCAL, JX_ELF_STT_FILE);
+	symTab[1].m_SectionIndex = JX_ELF_SHN_ABS;
+
+	// NOTE: Symbol values are relative to .text, whose address is the actual address of
+	// the code buffer, so the debugger doesn't need to relocate anything.
+	for (uint32_t iFunc = 0; iFunc < numFuncs; ++iFunc) {
+		const jx_x64_debug_func_t* func = &funcArr[iFunc];
+		jx_elf64_symbol_t* sym = &symTab[iFunc + 2];
+		sym->m_Name = jx64_debugAppendString(strTab, &strTabSize, func->m_Name);
+		sym->m_Info = JX_ELF_ST_INFO(JX_ELF_STB_GLOBAL, JX_ELF_STT_FUNC);
+		sym->m_SectionIndex = JX64_GDB_IMAGE_SECTION_TEXT;
+		sym->m_Value = (uint64_t)(func->m_Addr - textAddr);
+		sym->m_Size = func->m_Size;
+	}
+
+	jx_elf64_section_header_t* shdr = (jx_elf64_section_header_t*)&elf[shdrOffset];
+	for (uint32_t iSection = 0; iSection < JX64_GDB_IMAGE_SECTION_COUNT; ++iSection) {
+		shdr[iSection].m_Name = kSectionNameOffset[iSection];
+	}
+
+	jx_elf64_section_header_t* text = &shdr[JX64_GDB_IMAGE_SECTION_TEXT];
+	text->m_Type = JX_ELF_SHT_NOBITS;
+	text->m_Flags = JX_ELF_SHF_ALLOC | JX_ELF_SHF_EXECINSTR;
+	text->m_Addr = (uint64_t)(uintptr_t)textAddr;
+	text->m_Size = textSize;
+	text->m_AddrAlign = 16;
+
+	jx_elf64_section_header_t* shstrtab = &shdr[JX64_GDB_IMAGE_SECTION_SHSTRTAB];
+	shstrtab->m_Type = JX_ELF_SHT_STRTAB;
+	shstrtab->m_Offset = shstrtabOffset;
+	shstrtab->m_Size = sizeof(kSectionNames);
+	shstrtab->m_AddrAlign = 1;
+
+	jx_elf64_section_header_t* symtab = &shdr[JX64_GDB_IMAGE_SECTION_SYMTAB];
+	symtab->m_Type = JX_ELF_SHT_SYMTAB;
+	symtab->m_Offset = symtabOffset;
+	symtab->m_Size = numSymbols * sizeof(jx_elf64_symbol_t);
+	symtab->m_Link = JX64_GDB_IMAGE_SECTION_STRTAB;
+	symtab->m_Info = 2; // Index of the first non-local symbol
+	symtab->m_AddrAlign = 8;
+	symtab->m_EntrySize = sizeof(jx_elf64_symbol_t);
+
+	jx_elf64_section_header_t* strtab = &shdr[JX64_GDB_IMAGE_SECTION_STRTAB];
+	strtab->m_Type = JX_ELF_SHT_STRTAB;
+	strtab->m_Offset = strtabOffset;
+	strtab->m_Size = strTabSize;
+	strtab->m_AddrAlign = 1;
+
+	// Link the entry into the debugger's list and notify it.
+	struct jit_code_entry* entry = &img->m_CodeEntry;
+	entry->symfile_addr = (const char*)elf;
+	entry->symfile_size = imageSize;
+	entry->prev_entry = NULL;
+	entry->next_entry = __jit_debug_descriptor.first_entry;
+	if (entry->next_entry) {
+		entry->next_entry->prev_entry = entry;
+	}
+	__jit_debug_descriptor.first_entry = entry;
+	__jit_debug_descriptor.relevant_entry = entry;
+	__jit_debug_descriptor.action_flag = JIT_REGISTER_FN;
+	__jit_debug_register_code();
+
+	return img;
+}
+
+void jx64_debugUnregisterGDBImage(jx_x64_gdb_image_t* img)
+{
+	struct jit_code_entry* entry = &img->m_CodeEntry;
+	if (entry->prev_entry) {
+		entry->prev_entry->next_entry = entry->next_entry;
+	} else {
+		__jit_debug_descriptor.first_entry = entry->next_entry;
+	}
+
+	if (entry->next_entry) {
+		entry->next_entry->prev_entry = entry->prev_entry;
+	}
+
+	__jit_debug_descriptor.relevant_entry = entry;
+	__jit_debug_descriptor.action_flag = JIT_UNREGISTER_FN;
+	__jit_debug_register_code();
+
+	jx_allocator_i* allocator = img->m_Allocator;
+	JX_FREE(allocator, img->m_ELFImage);
+	JX_FREE(allocator, img);
+}
+
+bool jx64_debugRegisterFunctionTable(const uint8_t* baseAddr, const void* funcTable, uint32_t numEntries)
+{
+	return RtlAddFunctionTable((PRUNTIME_FUNCTION)funcTable, (DWORD)numEntries, (DWORD64)(uintptr_t)baseAddr) != FALSE;
+}
+
+void jx64_debugUnregisterFunctionTable(const void* funcTable)
+{
+	RtlDeleteFunctionTable((PRUNTIME_FUNCTION)funcTable);
+}
+
+void __jit_debug_register_code(void)
+{
+	// NOTE: Must not be optimized away or folded with other empty functions.
+	static volatile uint32_t s_NumCalls = 0;
+	++s_NumCalls;
+}
+
+static uint32_t jx64_debugAppendString(char* strTab, uint32_t* strTabSize, const char* str)
+{
+	const uint32_t offset = *strTabSize;
+	const uint32_t len = jx_strlen(str);
+	jx_memcpy(&strTab[offset], str, len + 1);
+	*strTabSize = offset + len + 1;
+	return offset;
+}
@@ -0,0 +1,35 @@
+#ifndef JX_X64_DEBUG_H
+#define JX_X64_DEBUG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <jlib/macros.h> // JX_PAD
+
+typedef struct jx_allocator_i jx_allocator_i;
+
+typedef struct jx_x64_debug_func_t
+{
+	const char* m_Name;
+	const uint8_t* m_Addr;
+	uint32_t m_Size;
+	JX_PAD(4);
+} jx_x64_debug_func_t;
+
+typedef struct jx_x64_gdb_image_t jx_x64_gdb_image_t;
+
+// Appends "<start> <size> <name>" lines to perf-<pid>.map in the temp directory so
+// perf (and other tools following the same convention) can symbolize JIT code.
+bool jx64_debugWritePerfMap(const jx_x64_debug_func_t* funcArr, uint32_t numFuncs);
+
+// Builds an in-memory ELF image describing the code and registers it with attached
+// debuggers through the GDB JIT interface (__jit_debug_register_code).
+jx_x64_gdb_image_t* jx64_debugRegisterGDBImage(jx_allocator_i* allocator, const uint8_t* textAddr, uint32_t textSize, const jx_x64_debug_func_t* funcArr, uint32_t numFuncs);
+void jx64_debugUnregisterGDBImage(jx_x64_gdb_image_t* img);
+
+// Registers a table of Win64 RUNTIME_FUNCTION entries (addresses relative to baseAddr) with 
+// the OS unwinder so exceptions, debuggers and profilers can walk through JIT frames.
+// The table must stay alive until it's unregistered.
+bool jx64_debugRegisterFunctionTable(const uint8_t* baseAddr, const void* funcTable, uint32_t numEntries);
+void jx64_debugUnregisterFunctionTable(const void* funcTable);
+
+#endif // JX_X64_DEBUG_H
@@ -0,0 +1,2525 @@
+#include "jit_disasm.h"
+#include "jit.h"
+#include <jlib/allocator.h>
+#include <jlib/array.h>
+#include <jlib/dbg.h>
+#include <jlib/math.h>
+#include <jlib/memory.h>
+#include <jlib/string.h>
+
+#define JX64_DISASM_MAX_INSTR_SIZE 15
+#define JX64_DISASM_BYTES_COLUMN   10 // Instruction bytes printed before the mnemonic in listings (longer instructions shift the text)
+
+typedef enum jx_x64_reg_class
+{
+	JX64_REG_CLASS_GPR = 0,
+	JX64_REG_CLASS_VEC = 1,
+} jx_x64_reg_class;
+
+typedef struct jx_x64_decoder_t
+{
+	const uint8_t* m_Code;
+	uint32_t m_Size;
+	uint32_t m_Pos;
+	uint8_t m_Rep;   // F2/F3 prefix (0 if none)
+	uint8_t m_Seg;   // Segment override prefix (0 if none)
+	uint8_t m_VVVV;  // VEX.vvvv (not inverted)
+	uint8_t m_PP;    // VEX.pp (0: none, 1: 66, 2: F3, 3: F2)
+	uint8_t m_Map;   // VEX.mmmmm (1: 0F, 2: 0F38)
+	uint8_t m_ModRM;
+	bool m_OpSize;   // 66 prefix
+	bool m_AddrSize; // 67 prefix
+	bool m_HasREX;
+	bool m_HasVEX;
+	bool m_W;
+	bool m_R;
+	bool m_X;
+	bool m_B;
+	bool m_L;
+	bool m_Error;
+} jx_x64_decoder_t;
+
+#define JX64_SSE_OPCODE_FLAGS_NDS_PACKED_Pos 0 // VEX packed form has a first source operand in vvvv
+#define JX64_SSE_OPCODE_FLAGS_NDS_PACKED_Msk (1u << JX64_SSE_OPCODE_FLAGS_NDS_PACKED_Pos)
+#define JX64_SSE_OPCODE_FLAGS_NDS_SCALAR_Pos 1 // VEX scalar form has a first source operand in vvvv
+#define JX64_SSE_OPCODE_FLAGS_NDS_SCALAR_Msk (1u << JX64_SSE_OPCODE_FLAGS_NDS_SCALAR_Pos)
+#define JX64_SSE_OPCODE_FLAGS_IMM8_Pos       2
+#define JX64_SSE_OPCODE_FLAGS_IMM8_Msk       (1u << JX64_SSE_OPCODE_FLAGS_IMM8_Pos)
+#define JX64_SSE_OPCODE_FLAGS_COMIS_Pos      3 // Scalar memory operand even without an F2/F3 prefix
+#define JX64_SSE_OPCODE_FLAGS_COMIS_Msk      (1u << JX64_SSE_OPCODE_FLAGS_COMIS_Pos)
+
+#define JX64_SSE_OPCODE_FLAGS_NDS_Msk (JX64_SSE_OPCODE_FLAGS_NDS_PACKED_Msk | JX64_SSE_OPCODE_FLAGS_NDS_SCALAR_Msk)
+
+// Generic 0F map SSE/AVX opcodes; moves and conversions between register classes are decoded separately.
+typedef struct jx_x64_sse_opcode_desc_t
+{
+	jx_x64_mnemonic m_Mnemonic[2][4]; // [isVEX][pp]
+	uint32_t m_Flags;
+} jx_x64_sse_opcode_desc_t;
+
+#define JX64_SSE_OPCODE_4(name, flags) \
+	{ .m_Mnemonic = { \
+		{ JX64_MNEMONIC_##name##PS, JX64_MNEMONIC_##name##PD, JX64_MNEMONIC_##name##SS, JX64_MNEMONIC_##name##SD }, \
+		{ JX64_MNEMONIC_V##name##PS, JX64_MNEMONIC_V##name##PD, JX64_MNEMONIC_V##name##SS, JX64_MNEMONIC_V##name##SD } \
+	}, .m_Flags = (flags) }
+#define JX64_SSE_OPCODE_2(name, flags) \
+	{ .m_Mnemonic = { \
+		{ JX64_MNEMONIC_##name##PS, JX64_MNEMONIC_##name##PD, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_UNKNOWN }, \
+		{ JX64_MNEMONIC_V##name##PS, JX64_MNEMONIC_V##name##PD, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_UNKNOWN } \
+	}, .m_Flags = (flags) }
+#define JX64_SSE_OPCODE_PS_SS(name, flags) \
+	{ .m_Mnemonic = { \
+		{ JX64_MNEMONIC_##name##PS, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_##name##SS, JX64_MNEMONIC_UNKNOWN }, \
+		{ JX64_MNEMONIC_V##name##PS, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_V##name##SS, JX64_MNEMONIC_UNKNOWN } \
+	}, .m_Flags = (flags) }
+#define JX64_SSE_OPCODE_66(name, flags) \
+	{ .m_Mnemonic = { \
+		{ JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_##name, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_UNKNOWN }, \
+		{ JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_V##name, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_UNKNOWN } \
+	}, .m_Flags = (flags) }
+
+static const jx_x64_sse_opcode_desc_t kSSEOpcode[256] = {
+	[0x14] = JX64_SSE_OPCODE_2(UNPCKL, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x15] = JX64_SSE_OPCODE_2(UNPCKH, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x2E] = { .m_Mnemonic = {
+		{ JX64_MNEMONIC_UCOMISS, JX64_MNEMONIC_UCOMISD, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_UNKNOWN },
+		{ JX64_MNEMONIC_VUCOMISS, JX64_MNEMONIC_VUCOMISD, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_UNKNOWN }
+	}, .m_Flags = JX64_SSE_OPCODE_FLAGS_COMIS_Msk },
+	[0x2F] = { .m_Mnemonic = {
+		{ JX64_MNEMONIC_COMISS, JX64_MNEMONIC_COMISD, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_UNKNOWN },
+		{ JX64_MNEMONIC_VCOMISS, JX64_MNEMONIC_VCOMISD, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_UNKNOWN }
+	}, .m_Flags = JX64_SSE_OPCODE_FLAGS_COMIS_Msk },
+	[0x51] = JX64_SSE_OPCODE_4(SQRT, JX64_SSE_OPCODE_FLAGS_NDS_SCALAR_Msk),
+	[0x52] = JX64_SSE_OPCODE_PS_SS(RSQRT, JX64_SSE_OPCODE_FLAGS_NDS_SCALAR_Msk),
+	[0x53] = JX64_SSE_OPCODE_PS_SS(RCP, JX64_SSE_OPCODE_FLAGS_NDS_SCALAR_Msk),
+	[0x54] = JX64_SSE_OPCODE_2(AND, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x55] = JX64_SSE_OPCODE_2(ANDN, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x56] = JX64_SSE_OPCODE_2(OR, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x57] = JX64_SSE_OPCODE_2(XOR, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x58] = JX64_SSE_OPCODE_4(ADD, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x59] = JX64_SSE_OPCODE_4(MUL, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x5A] = { .m_Mnemonic = {
+		{ JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_CVTSS2SD, JX64_MNEMONIC_CVTSD2SS },
+		{ JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_VCVTSS2SD, JX64_MNEMONIC_VCVTSD2SS }
+	}, .m_Flags = JX64_SSE_OPCODE_FLAGS_NDS_SCALAR_Msk },
+	[0x5C] = JX64_SSE_OPCODE_4(SUB, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x5D] = JX64_SSE_OPCODE_4(MIN, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x5E] = JX64_SSE_OPCODE_4(DIV, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x5F] = JX64_SSE_OPCODE_4(MAX, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x60] = JX64_SSE_OPCODE_66(PUNPCKLBW, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x61] = JX64_SSE_OPCODE_66(PUNPCKLWD, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x62] = JX64_SSE_OPCODE_66(PUNPCKLDQ, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x68] = JX64_SSE_OPCODE_66(PUNPCKHBW, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x69] = JX64_SSE_OPCODE_66(PUNPCKHWD, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x6A] = JX64_SSE_OPCODE_66(PUNPCKHDQ, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x6C] = JX64_SSE_OPCODE_66(PUNPCKLQDQ, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0x6D] = JX64_SSE_OPCODE_66(PUNPCKHQDQ, JX64_SSE_OPCODE_FLAGS_NDS_Msk),
+	[0xC2] = JX64_SSE_OPCODE_4(CMP, JX64_SSE_OPCODE_FLAGS_NDS_Msk | JX64_SSE_OPCODE_FLAGS_IMM8_Msk),
+	[0xC6] = JX64_SSE_OPCODE_2(SHUF, JX64_SSE_OPCODE_FLAGS_NDS_Msk | JX64_SSE_OPCODE_FLAGS_IMM8_Msk),
+};
+
+#undef JX64_SSE_OPCODE_4
+#undef JX64_SSE_OPCODE_2
+#undef JX64_SSE_OPCODE_PS_SS
+#undef JX64_SSE_OPCODE_66
+
+static const jx_x64_mnemonic kALUMnemonic[8] = {
+	JX64_MNEMONIC_ADD, JX64_MNEMONIC_OR,  JX64_MNEMONIC_ADC, JX64_MNEMONIC_SBB,
+	JX64_MNEMONIC_AND, JX64_MNEMONIC_SUB, JX64_MNEMONIC_XOR, JX64_MNEMONIC_CMP,
+};
+
+static const jx_x64_mnemonic kShiftMnemonic[8] = {
+	JX64_MNEMONIC_ROL, JX64_MNEMONIC_ROR, JX64_MNEMONIC_RCL,     JX64_MNEMONIC_RCR,
+	JX64_MNEMONIC_SHL, JX64_MNEMONIC_SHR, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_SAR,
+};
+
+// 0F A3/AB/B3/BB (r/m, r) and 0F BA /4-/7 (r/m, imm8)
+static const jx_x64_mnemonic kBitTestMnemonic[4] = {
+	JX64_MNEMONIC_BT, JX64_MNEMONIC_BTS, JX64_MNEMONIC_BTR, JX64_MNEMONIC_BTC,
+};
+
+static const jx_x64_mnemonic kGroup3Mnemonic[8] = {
+	JX64_MNEMONIC_TEST, JX64_MNEMONIC_UNKNOWN, JX64_MNEMONIC_NOT, JX64_MNEMONIC_NEG,
+	JX64_MNEMONIC_MUL,  JX64_MNEMONIC_IMUL1,   JX64_MNEMONIC_DIV, JX64_MNEMONIC_IDIV,
+};
+
+static const char* kMnemonicName[JX64_MNEMONIC_COUNT] = {
+	[JX64_MNEMONIC_UNKNOWN]     = "(bad)",
+	[JX64_MNEMONIC_NOP]         = "nop",
+	[JX64_MNEMONIC_RET]         = "ret",
+	[JX64_MNEMONIC_INT3]        = "int3",
+	[JX64_MNEMONIC_PUSH]        = "push",
+	[JX64_MNEMONIC_POP]         = "pop",
+	[JX64_MNEMONIC_MOV]         = "mov",
+	[JX64_MNEMONIC_MOVSX]       = "movsx",
+	[JX64_MNEMONIC_MOVZX]       = "movzx",
+	[JX64_MNEMONIC_LEA]         = "lea",
+	[JX64_MNEMONIC_ADD]         = "add",
+	[JX64_MNEMONIC_OR]          = "or",
+	[JX64_MNEMONIC_ADC]         = "adc",
+	[JX64_MNEMONIC_SBB]         = "sbb",
+	[JX64_MNEMONIC_AND]         = "and",
+	[JX64_MNEMONIC_SUB]         = "sub",
+	[JX64_MNEMONIC_XOR]         = "xor",
+	[JX64_MNEMONIC_CMP]         = "cmp",
+	[JX64_MNEMONIC_TEST]        = "test",
+	[JX64_MNEMONIC_NOT]         = "not",
+	[JX64_MNEMONIC_NEG]         = "neg",
+	[JX64_MNEMONIC_MUL]         = "mul",
+	[JX64_MNEMONIC_IMUL1]       = "imul",
+	[JX64_MNEMONIC_DIV]         = "div",
+	[JX64_MNEMONIC_IDIV]        = "idiv",
+	[JX64_MNEMONIC_INC]         = "inc",
+	[JX64_MNEMONIC_DEC]         = "dec",
+	[JX64_MNEMONIC_IMUL]        = "imul",
+	[JX64_MNEMONIC_IMUL3]       = "imul",
+	[JX64_MNEMONIC_ROL]         = "rol",
+	[JX64_MNEMONIC_ROR]         = "ror",
+	[JX64_MNEMONIC_RCL]         = "rcl",
+	[JX64_MNEMONIC_RCR]         = "rcr",
+	[JX64_MNEMONIC_SHL]         = "shl",
+	[JX64_MNEMONIC_SHR]         = "shr",
+	[JX64_MNEMONIC_SAR]         = "sar",
+	[JX64_MNEMONIC_SETCC]       = "set",
+	[JX64_MNEMONIC_CMOVCC]      = "cmov",
+	[JX64_MNEMONIC_JCC]         = "j",
+	[JX64_MNEMONIC_JMP]         = "jmp",
+	[JX64_MNEMONIC_CALL]        = "call",
+	[JX64_MNEMONIC_BT]          = "bt",
+	[JX64_MNEMONIC_BTS]         = "bts",
+	[JX64_MNEMONIC_BTR]         = "btr",
+	[JX64_MNEMONIC_BTC]         = "btc",
+	[JX64_MNEMONIC_BSF]         = "bsf",
+	[JX64_MNEMONIC_BSR]         = "bsr",
+	[JX64_MNEMONIC_POPCNT]      = "popcnt",
+	[JX64_MNEMONIC_LZCNT]       = "lzcnt",
+	[JX64_MNEMONIC_TZCNT]       = "tzcnt",
+	[JX64_MNEMONIC_BSWAP]       = "bswap",
+	[JX64_MNEMONIC_STD]         = "std",
+	[JX64_MNEMONIC_CLD]         = "cld",
+	[JX64_MNEMONIC_STC]         = "stc",
+	[JX64_MNEMONIC_CMC]         = "cmc",
+	[JX64_MNEMONIC_CLC]         = "clc",
+	[JX64_MNEMONIC_CBW]         = "cbw",
+	[JX64_MNEMONIC_CWDE]        = "cwde",
+	[JX64_MNEMONIC_CDQE]        = "cdqe",
+	[JX64_MNEMONIC_CWD]         = "cwd",
+	[JX64_MNEMONIC_CDQ]         = "cdq",
+	[JX64_MNEMONIC_CQO]         = "cqo",
+	[JX64_MNEMONIC_MOVSS]       = "movss",
+	[JX64_MNEMONIC_MOVSD]       = "movsd",
+	[JX64_MNEMONIC_MOVAPS]      = "movaps",
+	[JX64_MNEMONIC_MOVAPD]      = "movapd",
+	[JX64_MNEMONIC_MOVUPS]      = "movups",
+	[JX64_MNEMONIC_MOVUPD]      = "movupd",
+	[JX64_MNEMONIC_MOVD]        = "movd",
+	[JX64_MNEMONIC_MOVQ]        = "movq",
+	[JX64_MNEMONIC_ADDPS]       = "addps",
+	[JX64_MNEMONIC_ADDSS]       = "addss",
+	[JX64_MNEMONIC_ADDPD]       = "addpd",
+	[JX64_MNEMONIC_ADDSD]       = "addsd",
+	[JX64_MNEMONIC_ANDNPS]      = "andnps",
+	[JX64_MNEMONIC_ANDNPD]      = "andnpd",
+	[JX64_MNEMONIC_ANDPS]       = "andps",
+	[JX64_MNEMONIC_ANDPD]       = "andpd",
+	[JX64_MNEMONIC_CMPPS]       = "cmpps",
+	[JX64_MNEMONIC_CMPSS]       = "cmpss",
+	[JX64_MNEMONIC_CMPPD]       = "cmppd",
+	[JX64_MNEMONIC_CMPSD]       = "cmpsd",
+	[JX64_MNEMONIC_COMISS]      = "comiss",
+	[JX64_MNEMONIC_COMISD]      = "comisd",
+	[JX64_MNEMONIC_CVTSI2SS]    = "cvtsi2ss",
+	[JX64_MNEMONIC_CVTSI2SD]    = "cvtsi2sd",
+	[JX64_MNEMONIC_CVTSS2SI]    = "cvtss2si",
+	[JX64_MNEMONIC_CVTSD2SI]    = "cvtsd2si",
+	[JX64_MNEMONIC_CVTTSS2SI]   = "cvttss2si",
+	[JX64_MNEMONIC_CVTTSD2SI]   = "cvttsd2si",
+	[JX64_MNEMONIC_CVTSD2SS]    = "cvtsd2ss",
+	[JX64_MNEMONIC_CVTSS2SD]    = "cvtss2sd",
+	[JX64_MNEMONIC_DIVPS]       = "divps",
+	[JX64_MNEMONIC_DIVSS]       = "divss",
+	[JX64_MNEMONIC_DIVPD]       = "divpd",
+	[JX64_MNEMONIC_DIVSD]       = "divsd",
+	[JX64_MNEMONIC_MAXPS]       = "maxps",
+	[JX64_MNEMONIC_MAXSS]       = "maxss",
+	[JX64_MNEMONIC_MAXPD]       = "maxpd",
+	[JX64_MNEMONIC_MAXSD]       = "maxsd",
+	[JX64_MNEMONIC_MINPS]       = "minps",
+	[JX64_MNEMONIC_MINSS]       = "minss",
+	[JX64_MNEMONIC_MINPD]       = "minpd",
+	[JX64_MNEMONIC_MINSD]       = "minsd",
+	[JX64_MNEMONIC_MULPS]       = "mulps",
+	[JX64_MNEMONIC_MULSS]       = "mulss",
+	[JX64_MNEMONIC_MULPD]       = "mulpd",
+	[JX64_MNEMONIC_MULSD]       = "mulsd",
+	[JX64_MNEMONIC_ORPS]        = "orps",
+	[JX64_MNEMONIC_ORPD]        = "orpd",
+	[JX64_MNEMONIC_RCPPS]       = "rcpps",
+	[JX64_MNEMONIC_RCPSS]       = "rcpss",
+	[JX64_MNEMONIC_RSQRTPS]     = "rsqrtps",
+	[JX64_MNEMONIC_RSQRTSS]     = "rsqrtss",
+	[JX64_MNEMONIC_SHUFPS]      = "shufps",
+	[JX64_MNEMONIC_SHUFPD]      = "shufpd",
+	[JX64_MNEMONIC_SQRTPS]      = "sqrtps",
+	[JX64_MNEMONIC_SQRTSS]      = "sqrtss",
+	[JX64_MNEMONIC_SQRTPD]      = "sqrtpd",
+	[JX64_MNEMONIC_SQRTSD]      = "sqrtsd",
+	[JX64_MNEMONIC_SUBPS]       = "subps",
+	[JX64_MNEMONIC_SUBSS]       = "subss",
+	[JX64_MNEMONIC_SUBPD]       = "subpd",
+	[JX64_MNEMONIC_SUBSD]       = "subsd",
+	[JX64_MNEMONIC_UCOMISS]     = "ucomiss",
+	[JX64_MNEMONIC_UCOMISD]     = "ucomisd",
+	[JX64_MNEMONIC_UNPCKHPS]    = "unpckhps",
+	[JX64_MNEMONIC_UNPCKHPD]    = "unpckhpd",
+	[JX64_MNEMONIC_UNPCKLPS]    = "unpcklps",
+	[JX64_MNEMONIC_UNPCKLPD]    = "unpcklpd",
+	[JX64_MNEMONIC_XORPS]       = "xorps",
+	[JX64_MNEMONIC_XORPD]       = "xorpd",
+	[JX64_MNEMONIC_PUNPCKLBW]   = "punpcklbw",
+	[JX64_MNEMONIC_PUNPCKLWD]   = "punpcklwd",
+	[JX64_MNEMONIC_PUNPCKLDQ]   = "punpckldq",
+	[JX64_MNEMONIC_PUNPCKLQDQ]  = "punpcklqdq",
+	[JX64_MNEMONIC_PUNPCKHBW]   = "punpckhbw",
+	[JX64_MNEMONIC_PUNPCKHWD]   = "punpckhwd",
+	[JX64_MNEMONIC_PUNPCKHDQ]   = "punpckhdq",
+	[JX64_MNEMONIC_PUNPCKHQDQ]  = "punpckhqdq",
+	[JX64_MNEMONIC_VZEROUPPER]  = "vzeroupper",
+	[JX64_MNEMONIC_VMOVSS]      = "vmovss",
+	[JX64_MNEMONIC_VMOVSD]      = "vmovsd",
+	[JX64_MNEMONIC_VMOVAPS]     = "vmovaps",
+	[JX64_MNEMONIC_VMOVAPD]     = "vmovapd",
+	[JX64_MNEMONIC_VMOVUPS]     = "vmovups",
+	[JX64_MNEMONIC_VMOVUPD]     = "vmovupd",
+	[JX64_MNEMONIC_VADDPS]      = "vaddps",
+	[JX64_MNEMONIC_VADDSS]      = "vaddss",
+	[JX64_MNEMONIC_VADDPD]      = "vaddpd",
+	[JX64_MNEMONIC_VADDSD]      = "vaddsd",
+	[JX64_MNEMONIC_VANDNPS]     = "vandnps",
+	[JX64_MNEMONIC_VANDNPD]     = "vandnpd",
+	[JX64_MNEMONIC_VANDPS]      = "vandps",
+	[JX64_MNEMONIC_VANDPD]      = "vandpd",
+	[JX64_MNEMONIC_VCMPPS]      = "vcmpps",
+	[JX64_MNEMONIC_VCMPSS]      = "vcmpss",
+	[JX64_MNEMONIC_VCMPPD]      = "vcmppd",
+	[JX64_MNEMONIC_VCMPSD]      = "vcmpsd",
+	[JX64_MNEMONIC_VCOMISS]     = "vcomiss",
+	[JX64_MNEMONIC_VCOMISD]     = "vcomisd",
+	[JX64_MNEMONIC_VCVTSI2SS]   = "vcvtsi2ss",
+	[JX64_MNEMONIC_VCVTSI2SD]   = "vcvtsi2sd",
+	[JX64_MNEMONIC_VCVTSS2SI]   = "vcvtss2si",
+	[JX64_MNEMONIC_VCVTSD2SI]   = "vcvtsd2si",
+	[JX64_MNEMONIC_VCVTTSS2SI]  = "vcvttss2si",
+	[JX64_MNEMONIC_VCVTTSD2SI]  = "vcvttsd2si",
+	[JX64_MNEMONIC_VCVTSD2SS]   = "vcvtsd2ss",
+	[JX64_MNEMONIC_VCVTSS2SD]   = "vcvtss2sd",
+	[JX64_MNEMONIC_VDIVPS]      = "vdivps",
+	[JX64_MNEMONIC_VDIVSS]      = "vdivss",
+	[JX64_MNEMONIC_VDIVPD]      = "vdivpd",
+	[JX64_MNEMONIC_VDIVSD]      = "vdivsd",
+	[JX64_MNEMONIC_VMAXPS]      = "vmaxps",
+	[JX64_MNEMONIC_VMAXSS]      = "vmaxss",
+	[JX64_MNEMONIC_VMAXPD]      = "vmaxpd",
+	[JX64_MNEMONIC_VMAXSD]      = "vmaxsd",
+	[JX64_MNEMONIC_VMINPS]      = "vminps",
+	[JX64_MNEMONIC_VMINSS]      = "vminss",
+	[JX64_MNEMONIC_VMINPD]      = "vminpd",
+	[JX64_MNEMONIC_VMINSD]      = "vminsd",
+	[JX64_MNEMONIC_VMULPS]      = "vmulps",
+	[JX64_MNEMONIC_VMULSS]      = "vmulss",
+	[JX64_MNEMONIC_VMULPD]      = "vmulpd",
+	[JX64_MNEMONIC_VMULSD]      = "vmulsd",
+	[JX64_MNEMONIC_VORPS]       = "vorps",
+	[JX64_MNEMONIC_VORPD]       = "vorpd",
+	[JX64_MNEMONIC_VRCPPS]      = "vrcpps",
+	[JX64_MNEMONIC_VRCPSS]      = "vrcpss",
+	[JX64_MNEMONIC_VRSQRTPS]    = "vrsqrtps",
+	[JX64_MNEMONIC_VRSQRTSS]    = "vrsqrtss",
+	[JX64_MNEMONIC_VSHUFPS]     = "vshufps",
+	[JX64_MNEMONIC_VSHUFPD]     = "vshufpd",
+	[JX64_MNEMONIC_VSQRTPS]     = "vsqrtps",
+	[JX64_MNEMONIC_VSQRTSS]     = "vsqrtss",
+	[JX64_MNEMONIC_VSQRTPD]     = "vsqrtpd",
+	[JX64_MNEMONIC_VSQRTSD]     = "vsqrtsd",
+	[JX64_MNEMONIC_VSUBPS]      = "vsubps",
+	[JX64_MNEMONIC_VSUBSS]      = "vsubss",
+	[JX64_MNEMONIC_VSUBPD]      = "vsubpd",
+	[JX64_MNEMONIC_VSUBSD]      = "vsubsd",
+	[JX64_MNEMONIC_VUCOMISS]    = "vucomiss",
+	[JX64_MNEMONIC_VUCOMISD]    = "vucomisd",
+	[JX64_MNEMONIC_VUNPCKHPS]   = "vunpckhps",
+	[JX64_MNEMONIC_VUNPCKHPD]   = "vunpckhpd",
+	[JX64_MNEMONIC_VUNPCKLPS]   = "vunpcklps",
+	[JX64_MNEMONIC_VUNPCKLPD]   = "vunpcklpd",
+	[JX64_MNEMONIC_VXORPS]      = "vxorps",
+	[JX64_MNEMONIC_VXORPD]      = "vxorpd",
+	[JX64_MNEMONIC_VPUNPCKLBW]  = "vpunpcklbw",
+	[JX64_MNEMONIC_VPUNPCKLWD]  = "vpunpcklwd",
+	[JX64_MNEMONIC_VPUNPCKLDQ]  = "vpunpckldq",
+	[JX64_MNEMONIC_VPUNPCKLQDQ] = "vpunpcklqdq",
+	[JX64_MNEMONIC_VPUNPCKHBW]  = "vpunpckhbw",
+	[JX64_MNEMONIC_VPUNPCKHWD]  = "vpunpckhwd",
+	[JX64_MNEMONIC_VPUNPCKHDQ]  = "vpunpckhdq",
+	[JX64_MNEMONIC_VPUNPCKHQDQ] = "vpunpckhqdq",
+	[JX64_MNEMONIC_VFMADD213PS] = "vfmadd213ps",
+	[JX64_MNEMONIC_VFMADD213SS] = "vfmadd213ss",
+	[JX64_MNEMONIC_VFMADD213PD] = "vfmadd213pd",
+	[JX64_MNEMONIC_VFMADD213SD] = "vfmadd213sd",
+	[JX64_MNEMONIC_VFMADD231PS] = "vfmadd231ps",
+	[JX64_MNEMONIC_VFMADD231SS] = "vfmadd231ss",
+	[JX64_MNEMONIC_VFMADD231PD] = "vfmadd231pd",
+	[JX64_MNEMONIC_VFMADD231SD] = "vfmadd231sd",
+};
+
+static const char* kCondCodeSuffix[16] = {
+	"o", "no", "b", "ae", "e", "ne", "be", "a", "s", "ns", "p", "np", "l", "ge", "le", "g"
+};
+
+static const char* kGPRName[4][16] = {
+	{ "al",  "cl",  "dl",  "bl",  "spl", "bpl", "sil", "dil", "r8b", "r9b", "r10b", "r11b", "r12b", "r13b", "r14b", "r15b" },
+	{ "ax",  "cx",  "dx",  "bx",  "sp",  "bp",  "si",  "di",  "r8w", "r9w", "r10w", "r11w", "r12w", "r13w", "r14w", "r15w" },
+	{ "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi", "r8d", "r9d", "r10d", "r11d", "r12d", "r13d", "r14d", "r15d" },
+	{ "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8",  "r9",  "r10",  "r11",  "r12",  "r13",  "r14",  "r15" },
+};
+
+static const char* kMemSizeName[] = {
+	[JX64_SIZE_8]   = "byte",
+	[JX64_SIZE_16]  = "word",
+	[JX64_SIZE_32]  = "dword",
+	[JX64_SIZE_64]  = "qword",
+	[JX64_SIZE_128] = "xmmword",
+	[JX64_SIZE_256] = "ymmword",
+};
+
+static uint8_t jx64_dec_fetch8(jx_x64_decoder_t* dec);
+static int64_t jx64_dec_fetchImm(jx_x64_decoder_t* dec, jx_x64_size size);
+static jx_x64_size jx64_dec_opSize(const jx_x64_decoder_t* dec);
+static uint32_t jx64_dec_regField(const jx_x64_decoder_t* dec);
+static bool jx64_dec_rmIsReg(const jx_x64_decoder_t* dec);
+static jx_x64_operand_t jx64_dec_gpr(jx_x64_decoder_t* dec, uint32_t id, jx_x64_size size);
+static jx_x64_operand_t jx64_dec_vec(const jx_x64_decoder_t* dec, uint32_t id);
+static jx_x64_operand_t jx64_dec_imm(jx_x64_decoder_t* dec, jx_x64_size size);
+static jx_x64_operand_t jx64_dec_immU8(jx_x64_decoder_t* dec);
+static jx_x64_operand_t jx64_dec_rel(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, jx_x64_size size);
+static jx_x64_operand_t jx64_dec_rm(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, jx_x64_reg_class regClass, jx_x64_size size);
+static jx_x64_operand_t jx64_dec_rmMem(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, jx_x64_reg_class regClass, jx_x64_size regSize, jx_x64_size memSize);
+static void jx64_dec_addOperand(jx_x64_disasm_instr_t* instr, jx_x64_operand_t op);
+static bool jx64_dec_oneByteMap(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, uint8_t opcode);
+static bool jx64_dec_twoByteMap(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, uint8_t opcode);
+static bool jx64_dec_sse(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, uint8_t opcode);
+static bool jx64_dec_fma(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, uint8_t opcode);
+
+static bool jx64_disasm_hasCC(jx_x64_mnemonic mnemonic);
+static bool jx64_disasm_isBranch(const jx_x64_disasm_instr_t* instr);
+static int32_t jx64_disasm_findLabel(const uint32_t* labelArr, uint32_t target);
+static const jx_x64_relocation_t* jx64_disasm_findReloc(const jx_x64_relocation_t* relocArr, uint32_t numRelocs, uint32_t pos, const jx_x64_disasm_instr_t* instr);
+static void jx64_disasm_printMnemonic(jx_string_buffer_t* sb, jx_x64_mnemonic mnemonic, jx_x64_condition_code cc);
+static void jx64_disasm_printReg(jx_string_buffer_t* sb, jx_x64_reg reg);
+static void jx64_disasm_printOperand(jx_string_buffer_t* sb, const jx_x64_disasm_instr_t* instr, const jx_x64_operand_t* op, uint32_t offset, const char* symName, const uint32_t* labelArr);
+static void jx64_disasm_printInstr(jx_string_buffer_t* sb, const jx_x64_disasm_instr_t* instr, uint32_t offset, const char* symName, const uint32_t* labelArr);
+
+bool jx64_disasmDecode(const uint8_t* code, uint32_t size, jx_x64_disasm_instr_t* instr)
+{
+	jx_memset(instr, 0, sizeof(jx_x64_disasm_instr_t));
+
+	jx_x64_decoder_t* dec = &(jx_x64_decoder_t){
+		.m_Code = code,
+		.m_Size = size
+	};
+
+	// Legacy prefixes
+	uint8_t opcode = jx64_dec_fetch8(dec);
+	while (!dec->m_Error) {
+		if (opcode == 0x66) {
+			dec->m_OpSize = true;
+		} else if (opcode == 0x67) {
+			dec->m_AddrSize = true;
+		} else if (opcode == 0xF2 || opcode == 0xF3) {
+			dec->m_Rep = opcode;
+		} else if (opcode == 0x26 || opcode == 0x2E || opcode == 0x36 || opcode == 0x3E || opcode == 0x64 || opcode == 0x65) {
+			dec->m_Seg = opcode;
+		} else {
+			break;
+		}
+
+		opcode = jx64_dec_fetch8(dec);
+	}
+
+	if (opcode >= 0x40 && opcode <= 0x4F) {
+		dec->m_HasREX = true;
+		dec->m_W = (opcode & 0x08) != 0;
+		dec->m_R = (opcode & 0x04) != 0;
+		dec->m_X = (opcode & 0x02) != 0;
+		dec->m_B = (opcode & 0x01) != 0;
+		opcode = jx64_dec_fetch8(dec);
+	} else if (opcode == 0xC4 || opcode == 0xC5) {
+		// NOTE: VEX replaces the mandatory SIMD prefixes.
+		if (dec->m_OpSize || dec->m_Rep || dec->m_Seg) {
+			return false;
+		}
+
+		dec->m_HasVEX = true;
+
+		const uint8_t vex1 = jx64_dec_fetch8(dec);
+		dec->m_R = (vex1 & 0x80) == 0;
+		if (opcode == 0xC5) {
+			dec->m_Map = 1;
+			dec->m_VVVV = (uint8_t)((~vex1 >> 3) & 0x0F);
+			dec->m_L = (vex1 & 0x04) != 0;
+			dec->m_PP = vex1 & 0x03;
+		} else {
+			dec->m_X = (vex1 & 0x40) == 0;
+			dec->m_B = (vex1 & 0x20) == 0;
+			dec->m_Map = vex1 & 0x1F;
+
+			const uint8_t vex2 = jx64_dec_fetch8(dec);
+			dec->m_W = (vex2 & 0x80) != 0;
+			dec->m_VVVV = (uint8_t)((~vex2 >> 3) & 0x0F);
+			dec->m_L = (vex2 & 0x04) != 0;
+			dec->m_PP = vex2 & 0x03;
+		}
+		opcode = jx64_dec_fetch8(dec);
+	}
+
+	if (dec->m_Error) {
+		return false;
+	}
+
+	bool res = false;
+	if (dec->m_HasVEX) {
+		res = dec->m_Map == 1
+			? jx64_dec_sse(dec, instr, opcode)
+			: (dec->m_Map == 2 ? jx64_dec_fma(dec, instr, opcode) : false)
+			;
+	} else if (opcode == 0x0F) {
+		opcode = jx64_dec_fetch8(dec);
+		res = !dec->m_Error && jx64_dec_twoByteMap(dec, instr, opcode);
+	} else {
+		res = jx64_dec_oneByteMap(dec, instr, opcode);
+	}
+
+	if (!res || dec->m_Error || instr->m_Mnemonic == JX64_MNEMONIC_UNKNOWN) {
+		jx_memset(instr, 0, sizeof(jx_x64_disasm_instr_t));
+		return false;
+	}
+
+	instr->m_Size = dec->m_Pos;
+
+	return true;
+}
+
+void jx64_disasmInstrPrint(const jx_x64_disasm_instr_t* instr, uint32_t offset, jx_string_buffer_t* sb)
+{
+	jx64_disasm_printInstr(sb, instr, offset, NULL, NULL);
+}
+
+void jx64_disasmPrint(jx_allocator_i* allocator, const uint8_t* code, uint32_t size, const jx_x64_relocation_t* relocArr, uint32_t numRelocs, jx_string_buffer_t* sb)
+{
+	// Collect the targets of all branches inside the code. Branches with relocations
+	// target other symbols.
+	uint32_t* labelArr = (uint32_t*)jx_array_create(allocator);
+	if (labelArr) {
+		uint32_t pos = 0;
+		while (pos < size) {
+			jx_x64_disasm_instr_t instr;
+			if (!jx64_disasmDecode(&code[pos], size - pos, &instr)) {
+				++pos;
+				continue;
+			}
+
+			const bool isLocalBranch = true
+				&& jx64_disasm_isBranch(&instr)
+				&& instr.m_Operands[0].m_Type == JX64_OPERAND_IMM
+				&& !jx64_disasm_findReloc(relocArr, numRelocs, pos, &instr)
+				;
+			if (isLocalBranch) {
+				const int64_t target = (int64_t)pos + instr.m_Size + instr.m_Operands[0].u.m_ImmI64;
+				if (target >= 0 && target <= (int64_t)size && jx64_disasm_findLabel(labelArr, (uint32_t)target) < 0) {
+					uint32_t insertPos = (uint32_t)jx_array_sizeu(labelArr);
+					while (insertPos > 0 && labelArr[insertPos - 1] > (uint32_t)target) {
+						--insertPos;
+					}
+					jx_array_insert(labelArr, insertPos, (uint32_t)target);
+				}
+			}
+
+			pos += instr.m_Size;
+		}
+	}
+
+	uint32_t pos = 0;
+	while (pos < size) {
+		const int32_t labelID = jx64_disasm_findLabel(labelArr, pos);
+		if (labelID >= 0) {
+			jx_strbuf_printf(sb, ".L%d:\n", labelID);
+		}
+
+		jx_x64_disasm_instr_t instr;
+		const bool decoded = jx64_disasmDecode(&code[pos], size - pos, &instr);
+		const uint32_t instrSize = decoded
+			? instr.m_Size
+			: 1
+			;
+
+		jx_strbuf_printf(sb, "  %04X:", pos);
+		for (uint32_t i = 0; i < jx_max_u32(instrSize, JX64_DISASM_BYTES_COLUMN); ++i) {
+			if (i < instrSize) {
+				jx_strbuf_printf(sb, " %02X", code[pos + i]);
+			} else {
+				jx_strbuf_pushCStr(sb, "   ");
+			}
+		}
+		jx_strbuf_pushCStr(sb, "  ");
+
+		if (decoded) {
+			const jx_x64_relocation_t* reloc = jx64_disasm_findReloc(relocArr, numRelocs, pos, &instr);
+			jx64_disasm_printInstr(sb, &instr, pos, reloc ? reloc->m_SymbolName : NULL, labelArr);
+		} else {
+			jx_strbuf_printf(sb, "db 0x%02X", code[pos]);
+		}
+		jx_strbuf_pushCStr(sb, "\n");
+
+		pos += instrSize;
+	}
+
+	jx_array_free(labelArr);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Decoder
+//
+static uint8_t jx64_dec_fetch8(jx_x64_decoder_t* dec)
+{
+	if (dec->m_Pos >= dec->m_Size || dec->m_Pos >= JX64_DISASM_MAX_INSTR_SIZE) {
+		dec->m_Error = true;
+		return 0;
+	}
+
+	return dec->m_Code[dec->m_Pos++];
+}
+
+// NOTE: Immediates and displacements are sign-extended.
+static int64_t jx64_dec_fetchImm(jx_x64_decoder_t* dec, jx_x64_size size)
+{
+	const uint32_t numBytes = 1u << size;
+
+	uint64_t val = 0;
+	for (uint32_t i = 0; i < numBytes; ++i) {
+		val |= (uint64_t)jx64_dec_fetch8(dec) << (i * 8);
+	}
+
+	return size == JX64_SIZE_8
+		? (int64_t)(int8_t)val
+		: (size == JX64_SIZE_16
+			? (int64_t)(int16_t)val
+			: (size == JX64_SIZE_32 ? (int64_t)(int32_t)val : (int64_t)val))
+		;
+}
+
+static jx_x64_size jx64_dec_opSize(const jx_x64_decoder_t* dec)
+{
+	return dec->m_W
+		? JX64_SIZE_64
+		: (dec->m_OpSize ? JX64_SIZE_16 : JX64_SIZE_32)
+		;
+}
+
+static uint32_t jx64_dec_regField(const jx_x64_decoder_t* dec)
+{
+	return ((dec->m_ModRM >> 3) & 0x07) | (dec->m_R ? 0x08 : 0x00);
+}
+
+static bool jx64_dec_rmIsReg(const jx_x64_decoder_t* dec)
+{
+	return (dec->m_ModRM >> 6) == 0b11;
+}
+
+static jx_x64_operand_t jx64_dec_gpr(jx_x64_decoder_t* dec, uint32_t id, jx_x64_size size)
+{
+	// NOTE: Without a REX prefix 8-bit registers 4-7 are ah, ch, dh and bh which are never used.
+	if (size == JX64_SIZE_8 && id >= 4 && id < 8 && !dec->m_HasREX) {
+		dec->m_Error = true;
+	}
+
+	return jx64_opReg((jx_x64_reg)JX64_REG(id, 0, size));
+}
+
+static jx_x64_operand_t jx64_dec_vec(const jx_x64_decoder_t* dec, uint32_t id)
+{
+	return jx64_opReg((jx_x64_reg)JX64_REG(id, 0, dec->m_L ? JX64_SIZE_256 : JX64_SIZE_128));
+}
+
+static jx_x64_operand_t jx64_dec_imm(jx_x64_decoder_t* dec, jx_x64_size size)
+{
+	return (jx_x64_operand_t){ .m_Type = JX64_OPERAND_IMM, .m_Size = size, .u.m_ImmI64 = jx64_dec_fetchImm(dec, size) };
+}
+
+static jx_x64_operand_t jx64_dec_immU8(jx_x64_decoder_t* dec)
+{
+	return (jx_x64_operand_t){ .m_Type = JX64_OPERAND_IMM, .m_Size = JX64_SIZE_8, .u.m_ImmI64 = (int64_t)jx64_dec_fetch8(dec) };
+}
+
+static jx_x64_operand_t jx64_dec_rel(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, jx_x64_size size)
+{
+	if (size == JX64_SIZE_32) {
+		instr->m_RelOffset = dec->m_Pos;
+	}
+
+	return jx64_dec_imm(dec, size);
+}
+
+static jx_x64_operand_t jx64_dec_rm(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, jx_x64_reg_class regClass, jx_x64_size size)
+{
+	return jx64_dec_rmMem(dec, instr, regClass, size, size);
+}
+
+static jx_x64_operand_t jx64_dec_rmMem(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, jx_x64_reg_class regClass, jx_x64_size regSize, jx_x64_size memSize)
+{
+	const uint32_t mod = dec->m_ModRM >> 6;
+	const uint32_t rm = dec->m_ModRM & 0x07;
+	if (mod == 0b11) {
+		const uint32_t id = rm | (dec->m_B ? 0x08 : 0x00);
+		return regClass == JX64_REG_CLASS_GPR
+			? jx64_dec_gpr(dec, id, regSize)
+			: jx64_dec_vec(dec, id)
+			;
+	}
+
+	const jx_x64_size addrSize = dec->m_AddrSize
+		? JX64_SIZE_32
+		: JX64_SIZE_64
+		;
+
+	jx_x64_reg base = JX64_REG_NONE;
+	jx_x64_reg index = JX64_REG_NONE;
+	jx_x64_scale scale = JX64_SCALE_1;
+	int64_t disp = 0;
+	if (rm == 0b100) {
+		const uint8_t sib = jx64_dec_fetch8(dec);
+		const uint32_t indexID = ((sib >> 3) & 0x07) | (dec->m_X ? 0x08 : 0x00);
+		if (indexID != JX64_REG_ID_RSP) {
+			index = (jx_x64_reg)JX64_REG(indexID, 0, addrSize);
+			scale = (jx_x64_scale)(sib >> 6);
+		}
+
+		if ((sib & 0x07) == 0b101 && mod == 0b00) {
+			disp = jx64_dec_fetchImm(dec, JX64_SIZE_32);
+		} else {
+			base = (jx_x64_reg)JX64_REG((sib & 0x07) | (dec->m_B ? 0x08 : 0x00), 0, addrSize);
+		}
+	} else if (rm == 0b101 && mod == 0b00) {
+		base = addrSize == JX64_SIZE_32
+			? JX64_REG_EIP
+			: JX64_REG_RIP
+			;
+		instr->m_RelOffset = dec->m_Pos;
+		disp = jx64_dec_fetchImm(dec, JX64_SIZE_32);
+	} else {
+		base = (jx_x64_reg)JX64_REG(rm | (dec->m_B ? 0x08 : 0x00), 0, addrSize);
+	}
+
+	if (mod == 0b01) {
+		disp = jx64_dec_fetchImm(dec, JX64_SIZE_8);
+	} else if (mod == 0b10) {
+		disp = jx64_dec_fetchImm(dec, JX64_SIZE_32);
+	}
+
+	return jx64_opMem(memSize, base, index, scale, (int32_t)disp);
+}
+
+static void jx64_dec_addOperand(jx_x64_disasm_instr_t* instr, jx_x64_operand_t op)
+{
+	JX_CHECK(instr->m_NumOperands < JX_COUNTOF(instr->m_Operands), "Too many operands!");
+	instr->m_Operands[instr->m_NumOperands++] = op;
+}
+
+static bool jx64_dec_oneByteMap(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, uint8_t opcode)
+{
+	if (dec->m_Rep || dec->m_Seg) {
+		return false;
+	}
+
+	const jx_x64_size opSize = jx64_dec_opSize(dec);
+	const jx_x64_size immSize = opSize == JX64_SIZE_64
+		? JX64_SIZE_32
+		: opSize
+		;
+
+	if (opcode < 0x40 && (opcode & 0x07) < 6) {
+		// add/or/adc/sbb/and/sub/xor/cmp
+		instr->m_Mnemonic = kALUMnemonic[opcode >> 3];
+
+		const uint32_t form = opcode & 0x07;
+		if (form == 4) {
+			jx64_dec_addOperand(instr, jx64_opReg(JX64_REG_AL));
+			jx64_dec_addOperand(instr, jx64_dec_imm(dec, JX64_SIZE_8));
+		} else if (form == 5) {
+			jx64_dec_addOperand(instr, jx64_dec_gpr(dec, JX64_REG_ID_RAX, opSize));
+			jx64_dec_addOperand(instr, jx64_dec_imm(dec, immSize));
+		} else {
+			const jx_x64_size size = (form & 1) != 0
+				? opSize
+				: JX64_SIZE_8
+				;
+			dec->m_ModRM = jx64_dec_fetch8(dec);
+			const jx_x64_operand_t reg = jx64_dec_gpr(dec, jx64_dec_regField(dec), size);
+			const jx_x64_operand_t rm = jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, size);
+			jx64_dec_addOperand(instr, form < 2 ? rm : reg);
+			jx64_dec_addOperand(instr, form < 2 ? reg : rm);
+		}
+
+		return true;
+	} else if (opcode >= 0x50 && opcode <= 0x5F) {
+		instr->m_Mnemonic = opcode < 0x58
+			? JX64_MNEMONIC_PUSH
+			: JX64_MNEMONIC_POP
+			;
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, (opcode & 0x07) | (dec->m_B ? 0x08 : 0x00), dec->m_OpSize ? JX64_SIZE_16 : JX64_SIZE_64));
+		return true;
+	} else if (opcode >= 0x70 && opcode <= 0x7F) {
+		instr->m_Mnemonic = JX64_MNEMONIC_JCC;
+		instr->m_CC = (jx_x64_condition_code)(opcode & 0x0F);
+		jx64_dec_addOperand(instr, jx64_dec_rel(dec, instr, JX64_SIZE_8));
+		return true;
+	} else if (opcode >= 0xB0 && opcode <= 0xB7) {
+		instr->m_Mnemonic = JX64_MNEMONIC_MOV;
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, (opcode & 0x07) | (dec->m_B ? 0x08 : 0x00), JX64_SIZE_8));
+		jx64_dec_addOperand(instr, jx64_dec_imm(dec, JX64_SIZE_8));
+		return true;
+	} else if (opcode >= 0xB8 && opcode <= 0xBF) {
+		instr->m_Mnemonic = JX64_MNEMONIC_MOV;
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, (opcode & 0x07) | (dec->m_B ? 0x08 : 0x00), opSize));
+		jx64_dec_addOperand(instr, jx64_dec_imm(dec, opSize));
+		return true;
+	}
+
+	switch (opcode) {
+	case 0x63: {
+		instr->m_Mnemonic = JX64_MNEMONIC_MOVSX;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, jx64_dec_regField(dec), opSize));
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, JX64_SIZE_32));
+	} break;
+	case 0x68:
+	case 0x6A: {
+		instr->m_Mnemonic = JX64_MNEMONIC_PUSH;
+		jx64_dec_addOperand(instr, jx64_dec_imm(dec, opcode == 0x6A ? JX64_SIZE_8 : immSize));
+	} break;
+	case 0x69:
+	case 0x6B: {
+		instr->m_Mnemonic = JX64_MNEMONIC_IMUL3;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, jx64_dec_regField(dec), opSize));
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, opSize));
+		jx64_dec_addOperand(instr, jx64_dec_imm(dec, opcode == 0x6B ? JX64_SIZE_8 : immSize));
+	} break;
+	case 0x80:
+	case 0x81:
+	case 0x83: {
+		const jx_x64_size size = opcode == 0x80
+			? JX64_SIZE_8
+			: opSize
+			;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		instr->m_Mnemonic = kALUMnemonic[(dec->m_ModRM >> 3) & 0x07];
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, size));
+		jx64_dec_addOperand(instr, jx64_dec_imm(dec, opcode == 0x81 ? immSize : JX64_SIZE_8));
+	} break;
+	case 0x84:
+	case 0x85:
+	case 0x88:
+	case 0x89:
+	case 0x8A:
+	case 0x8B: {
+		const jx_x64_size size = (opcode & 1) != 0
+			? opSize
+			: JX64_SIZE_8
+			;
+		instr->m_Mnemonic = opcode < 0x88
+			? JX64_MNEMONIC_TEST
+			: JX64_MNEMONIC_MOV
+			;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		const jx_x64_operand_t reg = jx64_dec_gpr(dec, jx64_dec_regField(dec), size);
+		const jx_x64_operand_t rm = jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, size);
+		const bool regIsDst = opcode == 0x8A || opcode == 0x8B;
+		jx64_dec_addOperand(instr, regIsDst ? reg : rm);
+		jx64_dec_addOperand(instr, regIsDst ? rm : reg);
+	} break;
+	case 0x8D: {
+		instr->m_Mnemonic = JX64_MNEMONIC_LEA;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		if (jx64_dec_rmIsReg(dec)) {
+			return false;
+		}
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, jx64_dec_regField(dec), opSize));
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, opSize));
+	} break;
+	case 0x8F: {
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		if (((dec->m_ModRM >> 3) & 0x07) != 0) {
+			return false;
+		}
+		instr->m_Mnemonic = JX64_MNEMONIC_POP;
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, dec->m_OpSize ? JX64_SIZE_16 : JX64_SIZE_64));
+	} break;
+	case 0x90: {
+		// NOTE: With REX.B this is xchg r8, rax.
+		if (dec->m_B) {
+			return false;
+		}
+		instr->m_Mnemonic = JX64_MNEMONIC_NOP;
+	} break;
+	case 0x98: {
+		instr->m_Mnemonic = opSize == JX64_SIZE_64
+			? JX64_MNEMONIC_CDQE
+			: (opSize == JX64_SIZE_16 ? JX64_MNEMONIC_CBW : JX64_MNEMONIC_CWDE)
+			;
+	} break;
+	case 0x99: {
+		instr->m_Mnemonic = opSize == JX64_SIZE_64
+			? JX64_MNEMONIC_CQO
+			: (opSize == JX64_SIZE_16 ? JX64_MNEMONIC_CWD : JX64_MNEMONIC_CDQ)
+			;
+	} break;
+	case 0xA8:
+	case 0xA9: {
+		instr->m_Mnemonic = JX64_MNEMONIC_TEST;
+		if (opcode == 0xA8) {
+			jx64_dec_addOperand(instr, jx64_opReg(JX64_REG_AL));
+			jx64_dec_addOperand(instr, jx64_dec_imm(dec, JX64_SIZE_8));
+		} else {
+			jx64_dec_addOperand(instr, jx64_dec_gpr(dec, JX64_REG_ID_RAX, opSize));
+			jx64_dec_addOperand(instr, jx64_dec_imm(dec, immSize));
+		}
+	} break;
+	case 0xC0:
+	case 0xC1:
+	case 0xD0:
+	case 0xD1:
+	case 0xD2:
+	case 0xD3: {
+		const jx_x64_size size = (opcode & 1) != 0
+			? opSize
+			: JX64_SIZE_8
+			;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		instr->m_Mnemonic = kShiftMnemonic[(dec->m_ModRM >> 3) & 0x07];
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, size));
+		if (opcode == 0xC0 || opcode == 0xC1) {
+			jx64_dec_addOperand(instr, jx64_dec_immU8(dec));
+		} else if (opcode == 0xD0 || opcode == 0xD1) {
+			jx64_dec_addOperand(instr, jx64_opImmI8(1));
+		} else {
+			jx64_dec_addOperand(instr, jx64_opReg(JX64_REG_CL));
+		}
+	} break;
+	case 0xC3: {
+		instr->m_Mnemonic = JX64_MNEMONIC_RET;
+	} break;
+	case 0xC6:
+	case 0xC7: {
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		if (((dec->m_ModRM >> 3) & 0x07) != 0) {
+			return false;
+		}
+
+		const jx_x64_size size = opcode == 0xC7
+			? opSize
+			: JX64_SIZE_8
+			;
+		instr->m_Mnemonic = JX64_MNEMONIC_MOV;
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, size));
+
+		// NOTE: The encoder takes the size of memory stores from the immediate, so qword
+		// stores of sign-extended 32-bit immediates are returned as 64-bit immediates.
+		jx_x64_operand_t imm = jx64_dec_imm(dec, size == JX64_SIZE_64 ? JX64_SIZE_32 : size);
+		if (size == JX64_SIZE_64 && !jx64_dec_rmIsReg(dec)) {
+			imm.m_Size = JX64_SIZE_64;
+		}
+		jx64_dec_addOperand(instr, imm);
+	} break;
+	case 0xCC: {
+		instr->m_Mnemonic = JX64_MNEMONIC_INT3;
+	} break;
+	case 0xE8:
+	case 0xE9:
+	case 0xEB: {
+		instr->m_Mnemonic = opcode == 0xE8
+			? JX64_MNEMONIC_CALL
+			: JX64_MNEMONIC_JMP
+			;
+		jx64_dec_addOperand(instr, jx64_dec_rel(dec, instr, opcode == 0xEB ? JX64_SIZE_8 : JX64_SIZE_32));
+	} break;
+	case 0xF5: {
+		instr->m_Mnemonic = JX64_MNEMONIC_CMC;
+	} break;
+	case 0xF8: {
+		instr->m_Mnemonic = JX64_MNEMONIC_CLC;
+	} break;
+	case 0xF9: {
+		instr->m_Mnemonic = JX64_MNEMONIC_STC;
+	} break;
+	case 0xFC: {
+		instr->m_Mnemonic = JX64_MNEMONIC_CLD;
+	} break;
+	case 0xFD: {
+		instr->m_Mnemonic = JX64_MNEMONIC_STD;
+	} break;
+	case 0xF6:
+	case 0xF7: {
+		const jx_x64_size size = opcode == 0xF7
+			? opSize
+			: JX64_SIZE_8
+			;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		instr->m_Mnemonic = kGroup3Mnemonic[(dec->m_ModRM >> 3) & 0x07];
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, size));
+		if (instr->m_Mnemonic == JX64_MNEMONIC_TEST) {
+			jx64_dec_addOperand(instr, jx64_dec_imm(dec, size == JX64_SIZE_64 ? JX64_SIZE_32 : size));
+		}
+	} break;
+	case 0xFE:
+	case 0xFF: {
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+
+		const uint32_t ext = (dec->m_ModRM >> 3) & 0x07;
+		if (ext == 0 || ext == 1) {
+			instr->m_Mnemonic = ext == 0
+				? JX64_MNEMONIC_INC
+				: JX64_MNEMONIC_DEC
+				;
+			jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, opcode == 0xFF ? opSize : JX64_SIZE_8));
+		} else if (opcode == 0xFE) {
+			return false;
+		} else if (ext == 2 || ext == 4) {
+			instr->m_Mnemonic = ext == 2
+				? JX64_MNEMONIC_CALL
+				: JX64_MNEMONIC_JMP
+				;
+			jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, JX64_SIZE_64));
+		} else if (ext == 6) {
+			instr->m_Mnemonic = JX64_MNEMONIC_PUSH;
+			jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, dec->m_OpSize ? JX64_SIZE_16 : JX64_SIZE_64));
+		} else {
+			return false;
+		}
+	} break;
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+static bool jx64_dec_twoByteMap(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, uint8_t opcode)
+{
+	if (opcode == 0x1F) {
+		// Multi-byte nop (segment overrides are used as padding)
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		if (dec->m_Rep || ((dec->m_ModRM >> 3) & 0x07) != 0) {
+			return false;
+		}
+
+		instr->m_Mnemonic = JX64_MNEMONIC_NOP;
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, jx64_dec_opSize(dec)));
+		return true;
+	}
+
+	if (dec->m_Seg) {
+		return false;
+	}
+
+	// NOTE: F3 is part of the opcode of popcnt/lzcnt/tzcnt. Everything else with a
+	// rep prefix is an SSE instruction.
+	const bool isBitCount = false
+		|| opcode == 0xB8
+		|| opcode == 0xBC
+		|| opcode == 0xBD
+		;
+	if (dec->m_Rep && !isBitCount) {
+		return jx64_dec_sse(dec, instr, opcode);
+	}
+
+	const jx_x64_size opSize = jx64_dec_opSize(dec);
+	if (opcode >= 0x40 && opcode <= 0x4F) {
+		instr->m_Mnemonic = JX64_MNEMONIC_CMOVCC;
+		instr->m_CC = (jx_x64_condition_code)(opcode & 0x0F);
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, jx64_dec_regField(dec), opSize));
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, opSize));
+		return true;
+	} else if (opcode >= 0x80 && opcode <= 0x8F) {
+		instr->m_Mnemonic = JX64_MNEMONIC_JCC;
+		instr->m_CC = (jx_x64_condition_code)(opcode & 0x0F);
+		jx64_dec_addOperand(instr, jx64_dec_rel(dec, instr, JX64_SIZE_32));
+		return true;
+	} else if (opcode >= 0x90 && opcode <= 0x9F) {
+		instr->m_Mnemonic = JX64_MNEMONIC_SETCC;
+		instr->m_CC = (jx_x64_condition_code)(opcode & 0x0F);
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, JX64_SIZE_8));
+		return true;
+	} else if (opcode >= 0xC8 && opcode <= 0xCF) {
+		instr->m_Mnemonic = JX64_MNEMONIC_BSWAP;
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, (opcode & 0x07) | (dec->m_B ? 0x08 : 0x00), opSize));
+		return true;
+	}
+
+	switch (opcode) {
+	case 0xA3:
+	case 0xAB:
+	case 0xB3:
+	case 0xBB: {
+		instr->m_Mnemonic = kBitTestMnemonic[(opcode >> 3) & 0x03];
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, opSize));
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, jx64_dec_regField(dec), opSize));
+	} break;
+	case 0xBA: {
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		const uint32_t group = (dec->m_ModRM >> 3) & 0x07;
+		if (group < 4) {
+			return false;
+		}
+
+		instr->m_Mnemonic = kBitTestMnemonic[group - 4];
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, opSize));
+		jx64_dec_addOperand(instr, jx64_dec_immU8(dec));
+	} break;
+	case 0xAF: {
+		instr->m_Mnemonic = JX64_MNEMONIC_IMUL;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, jx64_dec_regField(dec), opSize));
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, opSize));
+	} break;
+	case 0xB6:
+	case 0xB7:
+	case 0xBE:
+	case 0xBF: {
+		instr->m_Mnemonic = opcode < 0xBE
+			? JX64_MNEMONIC_MOVZX
+			: JX64_MNEMONIC_MOVSX
+			;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, jx64_dec_regField(dec), opSize));
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, (opcode & 1) != 0 ? JX64_SIZE_16 : JX64_SIZE_8));
+	} break;
+	case 0xB8:
+	case 0xBC:
+	case 0xBD: {
+		if (dec->m_Rep == 0xF3) {
+			instr->m_Mnemonic = opcode == 0xB8
+				? JX64_MNEMONIC_POPCNT
+				: (opcode == 0xBC ? JX64_MNEMONIC_TZCNT : JX64_MNEMONIC_LZCNT)
+				;
+		} else if (!dec->m_Rep && opcode != 0xB8) {
+			instr->m_Mnemonic = opcode == 0xBC
+				? JX64_MNEMONIC_BSF
+				: JX64_MNEMONIC_BSR
+				;
+		} else {
+			return false;
+		}
+
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, jx64_dec_regField(dec), opSize));
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, opSize));
+	} break;
+	default:
+		return jx64_dec_sse(dec, instr, opcode);
+	}
+
+	return true;
+}
+
+// NOTE: Legacy SSE (0F map with mandatory prefixes) and VEX map 1.
+static bool jx64_dec_sse(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, uint8_t opcode)
+{
+	const bool isVEX = dec->m_HasVEX;
+
+	uint32_t pp = dec->m_PP;
+	if (!isVEX) {
+		if (dec->m_OpSize && dec->m_Rep) {
+			return false;
+		}
+
+		pp = dec->m_Rep == 0xF3
+			? 2
+			: (dec->m_Rep == 0xF2 ? 3 : (dec->m_OpSize ? 1 : 0))
+			;
+	}
+
+	const bool isScalar = pp >= 2;
+	const jx_x64_size scalarSize = pp == 3
+		? JX64_SIZE_64
+		: JX64_SIZE_32
+		;
+	const jx_x64_size vecMemSize = isScalar
+		? scalarSize
+		: (dec->m_L ? JX64_SIZE_256 : JX64_SIZE_128)
+		;
+	const jx_x64_size gprSize = dec->m_W
+		? JX64_SIZE_64
+		: JX64_SIZE_32
+		;
+
+	switch (opcode) {
+	case 0x10:
+	case 0x11: {
+		static const jx_x64_mnemonic kMovMnemonic[2][4] = {
+			{ JX64_MNEMONIC_MOVUPS,  JX64_MNEMONIC_MOVUPD,  JX64_MNEMONIC_MOVSS,  JX64_MNEMONIC_MOVSD },
+			{ JX64_MNEMONIC_VMOVUPS, JX64_MNEMONIC_VMOVUPD, JX64_MNEMONIC_VMOVSS, JX64_MNEMONIC_VMOVSD },
+		};
+		instr->m_Mnemonic = kMovMnemonic[isVEX ? 1 : 0][pp];
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+
+		// NOTE: VEX scalar reg-reg moves merge the upper lanes from vvvv.
+		const bool isMerge = isVEX && isScalar && jx64_dec_rmIsReg(dec);
+		if (!isMerge && dec->m_VVVV != 0) {
+			return false;
+		}
+
+		const jx_x64_operand_t reg = jx64_dec_vec(dec, jx64_dec_regField(dec));
+		const jx_x64_operand_t rm = jx64_dec_rmMem(dec, instr, JX64_REG_CLASS_VEC, 0, vecMemSize);
+		jx64_dec_addOperand(instr, opcode == 0x10 ? reg : rm);
+		if (isMerge) {
+			jx64_dec_addOperand(instr, jx64_dec_vec(dec, dec->m_VVVV));
+		}
+		jx64_dec_addOperand(instr, opcode == 0x10 ? rm : reg);
+	} break;
+	case 0x28:
+	case 0x29: {
+		if (pp > 1 || dec->m_VVVV != 0) {
+			return false;
+		}
+
+		instr->m_Mnemonic = isVEX
+			? (pp == 0 ? JX64_MNEMONIC_VMOVAPS : JX64_MNEMONIC_VMOVAPD)
+			: (pp == 0 ? JX64_MNEMONIC_MOVAPS : JX64_MNEMONIC_MOVAPD)
+			;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+
+		const jx_x64_operand_t reg = jx64_dec_vec(dec, jx64_dec_regField(dec));
+		const jx_x64_operand_t rm = jx64_dec_rmMem(dec, instr, JX64_REG_CLASS_VEC, 0, vecMemSize);
+		jx64_dec_addOperand(instr, opcode == 0x28 ? reg : rm);
+		jx64_dec_addOperand(instr, opcode == 0x28 ? rm : reg);
+	} break;
+	case 0x2A: {
+		if (!isScalar) {
+			return false;
+		}
+
+		instr->m_Mnemonic = isVEX
+			? (pp == 2 ? JX64_MNEMONIC_VCVTSI2SS : JX64_MNEMONIC_VCVTSI2SD)
+			: (pp == 2 ? JX64_MNEMONIC_CVTSI2SS : JX64_MNEMONIC_CVTSI2SD)
+			;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_vec(dec, jx64_dec_regField(dec)));
+		if (isVEX) {
+			jx64_dec_addOperand(instr, jx64_dec_vec(dec, dec->m_VVVV));
+		}
+		jx64_dec_addOperand(instr, jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, gprSize));
+	} break;
+	case 0x2C:
+	case 0x2D: {
+		if (!isScalar || dec->m_VVVV != 0) {
+			return false;
+		}
+
+		static const jx_x64_mnemonic kCvtMnemonic[2][2][2] = {
+			{ { JX64_MNEMONIC_CVTTSS2SI,  JX64_MNEMONIC_CVTTSD2SI },  { JX64_MNEMONIC_CVTSS2SI,  JX64_MNEMONIC_CVTSD2SI } },
+			{ { JX64_MNEMONIC_VCVTTSS2SI, JX64_MNEMONIC_VCVTTSD2SI }, { JX64_MNEMONIC_VCVTSS2SI, JX64_MNEMONIC_VCVTSD2SI } },
+		};
+		instr->m_Mnemonic = kCvtMnemonic[isVEX ? 1 : 0][opcode & 1][pp - 2];
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_gpr(dec, jx64_dec_regField(dec), gprSize));
+		jx64_dec_addOperand(instr, jx64_dec_rmMem(dec, instr, JX64_REG_CLASS_VEC, 0, scalarSize));
+	} break;
+	case 0x6E:
+	case 0x7E: {
+		if (isVEX || pp != 1) {
+			return false;
+		}
+
+		instr->m_Mnemonic = dec->m_W
+			? JX64_MNEMONIC_MOVQ
+			: JX64_MNEMONIC_MOVD
+			;
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+
+		const jx_x64_operand_t reg = jx64_dec_vec(dec, jx64_dec_regField(dec));
+		const jx_x64_operand_t rm = jx64_dec_rm(dec, instr, JX64_REG_CLASS_GPR, gprSize);
+		jx64_dec_addOperand(instr, opcode == 0x6E ? reg : rm);
+		jx64_dec_addOperand(instr, opcode == 0x6E ? rm : reg);
+	} break;
+	case 0x77: {
+		if (!isVEX || pp != 0 || dec->m_L || dec->m_VVVV != 0) {
+			return false;
+		}
+
+		instr->m_Mnemonic = JX64_MNEMONIC_VZEROUPPER;
+	} break;
+	default: {
+		const jx_x64_sse_opcode_desc_t* desc = &kSSEOpcode[opcode];
+		instr->m_Mnemonic = desc->m_Mnemonic[isVEX ? 1 : 0][pp];
+		if (instr->m_Mnemonic == JX64_MNEMONIC_UNKNOWN) {
+			return false;
+		}
+
+		const uint32_t ndsFlag = isScalar
+			? JX64_SSE_OPCODE_FLAGS_NDS_SCALAR_Msk
+			: JX64_SSE_OPCODE_FLAGS_NDS_PACKED_Msk
+			;
+		const bool hasNDS = isVEX && (desc->m_Flags & ndsFlag) != 0;
+		if (!hasNDS && dec->m_VVVV != 0) {
+			return false;
+		}
+
+		const jx_x64_size memSize = (desc->m_Flags & JX64_SSE_OPCODE_FLAGS_COMIS_Msk) != 0
+			? (pp == 0 ? JX64_SIZE_32 : JX64_SIZE_64)
+			: vecMemSize
+			;
+
+		dec->m_ModRM = jx64_dec_fetch8(dec);
+		jx64_dec_addOperand(instr, jx64_dec_vec(dec, jx64_dec_regField(dec)));
+		if (hasNDS) {
+			jx64_dec_addOperand(instr, jx64_dec_vec(dec, dec->m_VVVV));
+		}
+		jx64_dec_addOperand(instr, jx64_dec_rmMem(dec, instr, JX64_REG_CLASS_VEC, 0, memSize));
+		if ((desc->m_Flags & JX64_SSE_OPCODE_FLAGS_IMM8_Msk) != 0) {
+			jx64_dec_addOperand(instr, jx64_dec_immU8(dec));
+		}
+	} break;
+	}
+
+	return true;
+}
+
+// NOTE: VEX map 2 (0F38); only the FMA3 instructions supported by the encoder.
+static bool jx64_dec_fma(jx_x64_decoder_t* dec, jx_x64_disasm_instr_t* instr, uint8_t opcode)
+{
+	if (dec->m_PP != 1) {
+		return false;
+	}
+
+	jx_x64_mnemonic baseMnemonic = JX64_MNEMONIC_UNKNOWN;
+	if (opcode == 0xA8 || opcode == 0xA9) {
+		baseMnemonic = JX64_MNEMONIC_VFMADD213PS;
+	} else if (opcode == 0xB8 || opcode == 0xB9) {
+		baseMnemonic = JX64_MNEMONIC_VFMADD231PS;
+	} else {
+		return false;
+	}
+
+	// NOTE: Mnemonics are ordered ps, ss, pd, sd; VEX.W selects double precision.
+	const bool isScalar = (opcode & 1) != 0;
+	instr->m_Mnemonic = (jx_x64_mnemonic)(baseMnemonic + (dec->m_W ? 2 : 0) + (isScalar ? 1 : 0));
+
+	const jx_x64_size memSize = isScalar
+		? (dec->m_W ? JX64_SIZE_64 : JX64_SIZE_32)
+		: (dec->m_L ? JX64_SIZE_256 : JX64_SIZE_128)
+		;
+	dec->m_ModRM = jx64_dec_fetch8(dec);
+	jx64_dec_addOperand(instr, jx64_dec_vec(dec, jx64_dec_regField(dec)));
+	jx64_dec_addOperand(instr, jx64_dec_vec(dec, dec->m_VVVV));
+	jx64_dec_addOperand(instr, jx64_dec_rmMem(dec, instr, JX64_REG_CLASS_VEC, 0, memSize));
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Printing
+//
+static bool jx64_disasm_hasCC(jx_x64_mnemonic mnemonic)
+{
+	return false
+		|| mnemonic == JX64_MNEMONIC_SETCC
+		|| mnemonic == JX64_MNEMONIC_CMOVCC
+		|| mnemonic == JX64_MNEMONIC_JCC
+		;
+}
+
+static bool jx64_disasm_isBranch(const jx_x64_disasm_instr_t* instr)
+{
+	return false
+		|| instr->m_Mnemonic == JX64_MNEMONIC_JCC
+		|| instr->m_Mnemonic == JX64_MNEMONIC_JMP
+		|| instr->m_Mnemonic == JX64_MNEMONIC_CALL
+		;
+}
+
+// NOTE: labelArr is sorted.
+static int32_t jx64_disasm_findLabel(const uint32_t* labelArr, uint32_t target)
+{
+	uint32_t first = 0;
+	uint32_t last = (uint32_t)jx_array_sizeu(labelArr);
+	while (first < last) {
+		const uint32_t mid = first + (last - first) / 2;
+		if (labelArr[mid] == target) {
+			return (int32_t)mid;
+		} else if (labelArr[mid] < target) {
+			first = mid + 1;
+		} else {
+			last = mid;
+		}
+	}
+
+	return -1;
+}
+
+static const jx_x64_relocation_t* jx64_disasm_findReloc(const jx_x64_relocation_t* relocArr, uint32_t numRelocs, uint32_t pos, const jx_x64_disasm_instr_t* instr)
+{
+	if (instr->m_RelOffset == 0) {
+		return NULL;
+	}
+
+	const uint32_t relocOffset = pos + instr->m_RelOffset;
+	for (uint32_t iReloc = 0; iReloc < numRelocs; ++iReloc) {
+		if (relocArr[iReloc].m_Offset == relocOffset) {
+			return &relocArr[iReloc];
+		}
+	}
+
+	return NULL;
+}
+
+static void jx64_disasm_printMnemonic(jx_string_buffer_t* sb, jx_x64_mnemonic mnemonic, jx_x64_condition_code cc)
+{
+	jx_strbuf_printf(sb, "%s%s", kMnemonicName[mnemonic], jx64_disasm_hasCC(mnemonic) ? kCondCodeSuffix[cc] : "");
+}
+
+static void jx64_disasm_printReg(jx_string_buffer_t* sb, jx_x64_reg reg)
+{
+	const uint32_t id = JX64_REG_GET_ID(reg);
+	const jx_x64_size size = (jx_x64_size)JX64_REG_GET_SIZE(reg);
+	if (JX64_REG_GET_FLAG(reg) != 0) {
+		jx_strbuf_pushCStr(sb, size == JX64_SIZE_32 ? "eip" : "rip");
+	} else if (size == JX64_SIZE_128) {
+		jx_strbuf_printf(sb, "xmm%u", id);
+	} else if (size == JX64_SIZE_256) {
+		jx_strbuf_printf(sb, "ymm%u", id);
+	} else {
+		jx_strbuf_pushCStr(sb, kGPRName[size][id]);
+	}
+}
+
+static void jx64_disasm_printOperand(jx_string_buffer_t* sb, const jx_x64_disasm_instr_t* instr, const jx_x64_operand_t* op, uint32_t offset, const char* symName, const uint32_t* labelArr)
+{
+	switch (op->m_Type) {
+	case JX64_OPERAND_REG: {
+		jx64_disasm_printReg(sb, op->u.m_Reg);
+	} break;
+	case JX64_OPERAND_IMM: {
+		if (instr && jx64_disasm_isBranch(instr)) {
+			const int64_t target = (int64_t)offset + instr->m_Size + op->u.m_ImmI64;
+			const int32_t labelID = target >= 0
+				? jx64_disasm_findLabel(labelArr, (uint32_t)target)
+				: -1
+				;
+			if (symName) {
+				jx_strbuf_pushCStr(sb, symName);
+			} else if (labelID >= 0) {
+				jx_strbuf_printf(sb, ".L%d", labelID);
+			} else {
+				jx_strbuf_printf(sb, "0x%llX", (uint64_t)target);
+			}
+		} else if (op->u.m_ImmI64 < 0) {
+			jx_strbuf_printf(sb, "-0x%llX", (uint64_t)-op->u.m_ImmI64);
+		} else {
+			jx_strbuf_printf(sb, "0x%llX", (uint64_t)op->u.m_ImmI64);
+		}
+	} break;
+	case JX64_OPERAND_MEM: {
+		const jx_x64_mem_t* mem = &op->u.m_Mem;
+		if (!instr || (instr->m_Mnemonic != JX64_MNEMONIC_LEA && instr->m_Mnemonic != JX64_MNEMONIC_NOP)) {
+			jx_strbuf_printf(sb, "%s ptr ", kMemSizeName[op->m_Size]);
+		}
+
+		jx_strbuf_pushCStr(sb, "[");
+		bool isFirst = true;
+		if (mem->m_Base != JX64_REG_NONE) {
+			jx64_disasm_printReg(sb, mem->m_Base);
+			isFirst = false;
+		}
+		if (mem->m_Index != JX64_REG_NONE) {
+			if (!isFirst) {
+				jx_strbuf_pushCStr(sb, "+");
+			}
+			jx64_disasm_printReg(sb, mem->m_Index);
+			if (mem->m_Scale != JX64_SCALE_1) {
+				jx_strbuf_printf(sb, "*%u", 1u << mem->m_Scale);
+			}
+			isFirst = false;
+		}
+		if (symName) {
+			jx_strbuf_printf(sb, "%s%s", isFirst ? "" : "+", symName);
+			isFirst = false;
+		}
+		if (isFirst) {
+			jx_strbuf_printf(sb, "0x%X", (uint32_t)mem->m_Displacement);
+		} else if (mem->m_Displacement < 0) {
+			jx_strbuf_printf(sb, "-0x%X", (uint32_t)-(int64_t)mem->m_Displacement);
+		} else if (mem->m_Displacement > 0) {
+			jx_strbuf_printf(sb, "+0x%X", (uint32_t)mem->m_Displacement);
+		}
+		jx_strbuf_pushCStr(sb, "]");
+	} break;
+	case JX64_OPERAND_LBL: {
+		jx_strbuf_pushCStr(sb, ".L");
+	} break;
+	case JX64_OPERAND_SYM: {
+		jx_strbuf_pushCStr(sb, op->u.m_Sym->m_Name);
+	} break;
+	case JX64_OPERAND_MEM_SYM: {
+		jx_strbuf_printf(sb, "[%s", op->u.m_MemSym.m_Symbol->m_Name);
+		if (op->u.m_MemSym.m_Displacement != 0) {
+			jx_strbuf_printf(sb, "%+d", op->u.m_MemSym.m_Displacement);
+		}
+		jx_strbuf_pushCStr(sb, "]");
+	} break;
+	default:
+		JX_CHECK(false, "Unknown operand type");
+		break;
+	}
+}
+
+static void jx64_disasm_printInstr(jx_string_buffer_t* sb, const jx_x64_disasm_instr_t* instr, uint32_t offset, const char* symName, const uint32_t* labelArr)
+{
+	jx64_disasm_printMnemonic(sb, instr->m_Mnemonic, instr->m_CC);
+
+	for (uint32_t iOp = 0; iOp < instr->m_NumOperands; ++iOp) {
+		jx_strbuf_pushCStr(sb, iOp == 0 ? " " : ", ");
+		jx64_disasm_printOperand(sb, instr, &instr->m_Operands[iOp], offset, symName, labelArr);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Self-check
+//
+typedef enum jx_x64_disasm_check_kind
+{
+	JX64_DISASM_CHECK_NONE = 0, // Not emitted by any jx64_* function
+	JX64_DISASM_CHECK_NOP,
+	JX64_DISASM_CHECK_VOID,
+	JX64_DISASM_CHECK_UNARY,
+	JX64_DISASM_CHECK_BINARY,
+	JX64_DISASM_CHECK_TERNARY,
+	JX64_DISASM_CHECK_BINARY_IMM8,
+	JX64_DISASM_CHECK_TERNARY_IMM8,
+	JX64_DISASM_CHECK_COND_UNARY,
+	JX64_DISASM_CHECK_COND_BINARY,
+} jx_x64_disasm_check_kind;
+
+// Operand combinations to emit. R: GPR, M: memory, I: immediate, S: symbol, V: vector register.
+// GPR forms are emitted for every size in m_Sizes. Vector forms use XMM registers and are
+// repeated with YMM registers if FORM_256 is set.
+typedef enum jx_x64_disasm_form
+{
+	JX64_DISASM_FORM_R     = 1u << 0,
+	JX64_DISASM_FORM_M     = 1u << 1,
+	JX64_DISASM_FORM_I     = 1u << 2,  // 8-bit and 32-bit immediates
+	JX64_DISASM_FORM_RR    = 1u << 3,
+	JX64_DISASM_FORM_RM    = 1u << 4,
+	JX64_DISASM_FORM_MR    = 1u << 5,
+	JX64_DISASM_FORM_RI    = 1u << 6,
+	JX64_DISASM_FORM_MI    = 1u << 7,
+	JX64_DISASM_FORM_RS    = 1u << 8,
+	JX64_DISASM_FORM_SR    = 1u << 9,
+	JX64_DISASM_FORM_SHIFT = 1u << 10, // r/m, 1/imm8/cl
+	JX64_DISASM_FORM_EXT   = 1u << 11, // r, r/m with 8-bit and 16-bit sources smaller than the destination
+	JX64_DISASM_FORM_EXT32 = 1u << 12, // r64, r/m32
+	JX64_DISASM_FORM_RRI   = 1u << 13,
+	JX64_DISASM_FORM_LBL   = 1u << 14,
+	JX64_DISASM_FORM_SYM   = 1u << 15,
+	JX64_DISASM_FORM_MSYM  = 1u << 16,
+	JX64_DISASM_FORM_VV    = 1u << 17,
+	JX64_DISASM_FORM_VM    = 1u << 18,
+	JX64_DISASM_FORM_MV    = 1u << 19,
+	JX64_DISASM_FORM_VS    = 1u << 20,
+	JX64_DISASM_FORM_VR    = 1u << 21,
+	JX64_DISASM_FORM_RV    = 1u << 22,
+	JX64_DISASM_FORM_RVM   = 1u << 23, // GPR destination, vector memory source
+	JX64_DISASM_FORM_VVV   = 1u << 24,
+	JX64_DISASM_FORM_VVM   = 1u << 25,
+	JX64_DISASM_FORM_VVS   = 1u << 26,
+	JX64_DISASM_FORM_VVR   = 1u << 27,
+	JX64_DISASM_FORM_256   = 1u << 28,
+} jx_x64_disasm_form;
+
+typedef bool (*jx64NopFunc)(jx_x64_context_t* ctx, uint32_t n);
+typedef bool (*jx64VoidFunc)(jx_x64_context_t* ctx);
+typedef bool (*jx64UnaryFunc)(jx_x64_context_t* ctx, jx_x64_operand_t op);
+typedef bool (*jx64BinaryFunc)(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src);
+typedef bool (*jx64TernaryFunc)(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2);
+typedef bool (*jx64BinaryImm8Func)(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src, uint8_t imm8);
+typedef bool (*jx64TernaryImm8Func)(jx_x64_context_t* ctx, jx_x64_operand_t dst, jx_x64_operand_t src1, jx_x64_operand_t src2, uint8_t imm8);
+typedef bool (*jx64CondUnaryFunc)(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t op);
+typedef bool (*jx64CondBinaryFunc)(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t dst, jx_x64_operand_t src);
+
+typedef struct jx_x64_disasm_check_desc_t
+{
+	jx_x64_disasm_check_kind m_Kind;
+	uint32_t m_Forms;
+	uint8_t m_Sizes;   // Mask of GPR operand sizes (1 << jx_x64_size)
+	uint8_t m_MemSize; // Size of vector memory operands; 0 to use the GPR size
+	JX_PAD(6);
+	union
+	{
+		jx64NopFunc m_Nop;
+		jx64VoidFunc m_Void;
+		jx64UnaryFunc m_Unary;
+		jx64BinaryFunc m_Binary;
+		jx64TernaryFunc m_Ternary;
+		jx64BinaryImm8Func m_BinaryImm8;
+		jx64TernaryImm8Func m_TernaryImm8;
+		jx64CondUnaryFunc m_CondUnary;
+		jx64CondBinaryFunc m_CondBinary;
+	} u;
+} jx_x64_disasm_check_desc_t;
+
+typedef struct jx_x64_disasm_checker_t
+{
+	jx_x64_context_t* m_Ctx;
+	jx_x64_symbol_t* m_Func;
+	jx_x64_symbol_t* m_Var;
+	jx_x64_symbol_t* m_ExtFunc;
+	jx_x64_label_t* m_Label; // Bound at the start of the function
+	jx_string_buffer_t* m_Log;
+	uint32_t m_NumInstructions;
+	uint32_t m_NumFailures;
+} jx_x64_disasm_checker_t;
+
+#define JX64_DISASM_SIZES_8       (1u << JX64_SIZE_8)
+#define JX64_DISASM_SIZES_32      (1u << JX64_SIZE_32)
+#define JX64_DISASM_SIZES_64      (1u << JX64_SIZE_64)
+#define JX64_DISASM_SIZES_16_64   ((1u << JX64_SIZE_16) | (1u << JX64_SIZE_64))
+#define JX64_DISASM_SIZES_32_64   ((1u << JX64_SIZE_32) | (1u << JX64_SIZE_64))
+#define JX64_DISASM_SIZES_16_32_64 ((1u << JX64_SIZE_16) | (1u << JX64_SIZE_32) | (1u << JX64_SIZE_64))
+#define JX64_DISASM_SIZES_ALL     ((1u << JX64_SIZE_8) | (1u << JX64_SIZE_16) | (1u << JX64_SIZE_32) | (1u << JX64_SIZE_64))
+
+#define JX64_CHECK_NOP(func)                          { .m_Kind = JX64_DISASM_CHECK_NOP, .u.m_Nop = (func) }
+#define JX64_CHECK_VOID(func)                         { .m_Kind = JX64_DISASM_CHECK_VOID, .u.m_Void = (func) }
+#define JX64_CHECK_UNARY(func, forms, sizes)          { .m_Kind = JX64_DISASM_CHECK_UNARY, .m_Forms = (forms), .m_Sizes = (sizes), .u.m_Unary = (func) }
+#define JX64_CHECK_BINARY(func, forms, sizes, mem)    { .m_Kind = JX64_DISASM_CHECK_BINARY, .m_Forms = (forms), .m_Sizes = (sizes), .m_MemSize = (mem), .u.m_Binary = (func) }
+#define JX64_CHECK_TERNARY(func, forms, sizes, mem)   { .m_Kind = JX64_DISASM_CHECK_TERNARY, .m_Forms = (forms), .m_Sizes = (sizes), .m_MemSize = (mem), .u.m_Ternary = (func) }
+#define JX64_CHECK_BINARY_IMM8(func, forms, mem)      { .m_Kind = JX64_DISASM_CHECK_BINARY_IMM8, .m_Forms = (forms), .m_MemSize = (mem), .u.m_BinaryImm8 = (func) }
+#define JX64_CHECK_TERNARY_IMM8(func, forms, mem)     { .m_Kind = JX64_DISASM_CHECK_TERNARY_IMM8, .m_Forms = (forms), .m_MemSize = (mem), .u.m_TernaryImm8 = (func) }
+#define JX64_CHECK_COND_UNARY(func, forms, sizes)     { .m_Kind = JX64_DISASM_CHECK_COND_UNARY, .m_Forms = (forms), .m_Sizes = (sizes), .u.m_CondUnary = (func) }
+#define JX64_CHECK_COND_BINARY(func, forms, sizes)    { .m_Kind = JX64_DISASM_CHECK_COND_BINARY, .m_Forms = (forms), .m_Sizes = (sizes), .u.m_CondBinary = (func) }
+
+// Legacy SSE
+#define JX64_CHECK_SSE(func, mem)           JX64_CHECK_BINARY(func, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_VS, 0, mem)
+#define JX64_CHECK_SSE_MOV(func, mem)       JX64_CHECK_BINARY(func, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_MV | JX64_DISASM_FORM_VS, 0, mem)
+#define JX64_CHECK_SSE_CVT2SI(func, mem)    JX64_CHECK_BINARY(func, JX64_DISASM_FORM_RV | JX64_DISASM_FORM_RVM, JX64_DISASM_SIZES_32_64, mem)
+// VEX packed (p) and scalar (s) forms
+#define JX64_CHECK_AVX_MOVP(func)           JX64_CHECK_BINARY(func, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_MV | JX64_DISASM_FORM_VS | JX64_DISASM_FORM_256, 0, JX64_SIZE_128)
+#define JX64_CHECK_AVX_MOVS(func, mem)      JX64_CHECK_BINARY(func, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_MV | JX64_DISASM_FORM_VS, 0, mem)
+#define JX64_CHECK_AVX_UNARYP(func)         JX64_CHECK_BINARY(func, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_VS | JX64_DISASM_FORM_256, 0, JX64_SIZE_128)
+#define JX64_CHECK_AVX_P(func)              JX64_CHECK_TERNARY(func, JX64_DISASM_FORM_VVV | JX64_DISASM_FORM_VVM | JX64_DISASM_FORM_VVS | JX64_DISASM_FORM_256, 0, JX64_SIZE_128)
+#define JX64_CHECK_AVX_S(func, mem)         JX64_CHECK_TERNARY(func, JX64_DISASM_FORM_VVV | JX64_DISASM_FORM_VVM | JX64_DISASM_FORM_VVS, 0, mem)
+
+static const jx_x64_disasm_check_desc_t kCheckDesc[JX64_MNEMONIC_COUNT] = {
+	[JX64_MNEMONIC_NOP]         = JX64_CHECK_NOP(jx64_nop),
+	[JX64_MNEMONIC_RET]         = JX64_CHECK_VOID(jx64_retn),
+	[JX64_MNEMONIC_INT3]        = JX64_CHECK_VOID(jx64_int3),
+	[JX64_MNEMONIC_PUSH]        = JX64_CHECK_UNARY(jx64_push, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M | JX64_DISASM_FORM_I, JX64_DISASM_SIZES_16_64),
+	[JX64_MNEMONIC_POP]         = JX64_CHECK_UNARY(jx64_pop, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M, JX64_DISASM_SIZES_16_64),
+	[JX64_MNEMONIC_MOV]         = JX64_CHECK_BINARY(jx64_mov, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI | JX64_DISASM_FORM_RS | JX64_DISASM_FORM_SR, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_MOVSX]       = JX64_CHECK_BINARY(jx64_movsx, JX64_DISASM_FORM_EXT | JX64_DISASM_FORM_EXT32, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_MOVZX]       = JX64_CHECK_BINARY(jx64_movzx, JX64_DISASM_FORM_EXT, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_LEA]         = JX64_CHECK_BINARY(jx64_lea, JX64_DISASM_FORM_RM | JX64_DISASM_FORM_RS, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_ADD]         = JX64_CHECK_BINARY(jx64_add, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI | JX64_DISASM_FORM_RS | JX64_DISASM_FORM_SR, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_OR]          = JX64_CHECK_BINARY(jx64_or, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI | JX64_DISASM_FORM_RS | JX64_DISASM_FORM_SR, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_ADC]         = JX64_CHECK_BINARY(jx64_adc, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI | JX64_DISASM_FORM_RS | JX64_DISASM_FORM_SR, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_SBB]         = JX64_CHECK_BINARY(jx64_sbb, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI | JX64_DISASM_FORM_RS | JX64_DISASM_FORM_SR, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_AND]         = JX64_CHECK_BINARY(jx64_and, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI | JX64_DISASM_FORM_RS | JX64_DISASM_FORM_SR, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_SUB]         = JX64_CHECK_BINARY(jx64_sub, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI | JX64_DISASM_FORM_RS | JX64_DISASM_FORM_SR, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_XOR]         = JX64_CHECK_BINARY(jx64_xor, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI | JX64_DISASM_FORM_RS | JX64_DISASM_FORM_SR, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_CMP]         = JX64_CHECK_BINARY(jx64_cmp, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI | JX64_DISASM_FORM_RS | JX64_DISASM_FORM_SR, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_TEST]        = JX64_CHECK_BINARY(jx64_test, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_NOT]         = JX64_CHECK_UNARY(jx64_not, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M, JX64_DISASM_SIZES_ALL),
+	[JX64_MNEMONIC_NEG]         = JX64_CHECK_UNARY(jx64_neg, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M, JX64_DISASM_SIZES_ALL),
+	[JX64_MNEMONIC_MUL]         = JX64_CHECK_UNARY(jx64_mul, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M, JX64_DISASM_SIZES_ALL),
+	[JX64_MNEMONIC_IMUL1]       = JX64_CHECK_UNARY(jx64_imul1, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M, JX64_DISASM_SIZES_ALL),
+	[JX64_MNEMONIC_DIV]         = JX64_CHECK_UNARY(jx64_div, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M, JX64_DISASM_SIZES_ALL),
+	[JX64_MNEMONIC_IDIV]        = JX64_CHECK_UNARY(jx64_idiv, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M, JX64_DISASM_SIZES_ALL),
+	[JX64_MNEMONIC_INC]         = JX64_CHECK_UNARY(jx64_inc, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M, JX64_DISASM_SIZES_ALL),
+	[JX64_MNEMONIC_DEC]         = JX64_CHECK_UNARY(jx64_dec, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M, JX64_DISASM_SIZES_ALL),
+	[JX64_MNEMONIC_IMUL]        = JX64_CHECK_BINARY(jx64_imul, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_IMUL3]       = JX64_CHECK_TERNARY(jx64_imul3, JX64_DISASM_FORM_RRI, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_ROL]         = JX64_CHECK_BINARY(jx64_rol, JX64_DISASM_FORM_SHIFT, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_ROR]         = JX64_CHECK_BINARY(jx64_ror, JX64_DISASM_FORM_SHIFT, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_RCL]         = JX64_CHECK_BINARY(jx64_rcl, JX64_DISASM_FORM_SHIFT, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_RCR]         = JX64_CHECK_BINARY(jx64_rcr, JX64_DISASM_FORM_SHIFT, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_SHL]         = JX64_CHECK_BINARY(jx64_shl, JX64_DISASM_FORM_SHIFT, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_SHR]         = JX64_CHECK_BINARY(jx64_shr, JX64_DISASM_FORM_SHIFT, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_SAR]         = JX64_CHECK_BINARY(jx64_sar, JX64_DISASM_FORM_SHIFT, JX64_DISASM_SIZES_ALL, 0),
+	[JX64_MNEMONIC_SETCC]       = JX64_CHECK_COND_UNARY(jx64_setcc, JX64_DISASM_FORM_R, JX64_DISASM_SIZES_8),
+	[JX64_MNEMONIC_CMOVCC]      = JX64_CHECK_COND_BINARY(jx64_cmovcc, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM, JX64_DISASM_SIZES_16_32_64),
+	[JX64_MNEMONIC_JCC]         = JX64_CHECK_COND_UNARY(jx64_jcc, JX64_DISASM_FORM_LBL, 0),
+	[JX64_MNEMONIC_JMP]         = JX64_CHECK_UNARY(jx64_jmp, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M | JX64_DISASM_FORM_LBL | JX64_DISASM_FORM_SYM | JX64_DISASM_FORM_MSYM, JX64_DISASM_SIZES_64),
+	[JX64_MNEMONIC_CALL]        = JX64_CHECK_UNARY(jx64_call, JX64_DISASM_FORM_R | JX64_DISASM_FORM_M | JX64_DISASM_FORM_LBL | JX64_DISASM_FORM_SYM | JX64_DISASM_FORM_MSYM, JX64_DISASM_SIZES_64),
+	[JX64_MNEMONIC_BT]          = JX64_CHECK_BINARY(jx64_bt, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_BTS]         = JX64_CHECK_BINARY(jx64_bts, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_BTR]         = JX64_CHECK_BINARY(jx64_btr, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_BTC]         = JX64_CHECK_BINARY(jx64_btc, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_MR | JX64_DISASM_FORM_RI | JX64_DISASM_FORM_MI, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_BSF]         = JX64_CHECK_BINARY(jx64_bsf, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_BSR]         = JX64_CHECK_BINARY(jx64_bsr, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_POPCNT]      = JX64_CHECK_BINARY(jx64_popcnt, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_LZCNT]       = JX64_CHECK_BINARY(jx64_lzcnt, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_TZCNT]       = JX64_CHECK_BINARY(jx64_tzcnt, JX64_DISASM_FORM_RR | JX64_DISASM_FORM_RM, JX64_DISASM_SIZES_16_32_64, 0),
+	[JX64_MNEMONIC_BSWAP]       = JX64_CHECK_UNARY(jx64_bswap, JX64_DISASM_FORM_R, JX64_DISASM_SIZES_32_64),
+	[JX64_MNEMONIC_STD]         = JX64_CHECK_VOID(jx64_std),
+	[JX64_MNEMONIC_CLD]         = JX64_CHECK_VOID(jx64_cld),
+	[JX64_MNEMONIC_STC]         = JX64_CHECK_VOID(jx64_stc),
+	[JX64_MNEMONIC_CMC]         = JX64_CHECK_VOID(jx64_cmc),
+	[JX64_MNEMONIC_CLC]         = JX64_CHECK_VOID(jx64_clc),
+	[JX64_MNEMONIC_CBW]         = JX64_CHECK_VOID(jx64_cbw),
+	[JX64_MNEMONIC_CWDE]        = JX64_CHECK_VOID(jx64_cwde),
+	[JX64_MNEMONIC_CDQE]        = JX64_CHECK_VOID(jx64_cdqe),
+	[JX64_MNEMONIC_CWD]         = JX64_CHECK_VOID(jx64_cwd),
+	[JX64_MNEMONIC_CDQ]         = JX64_CHECK_VOID(jx64_cdq),
+	[JX64_MNEMONIC_CQO]         = JX64_CHECK_VOID(jx64_cqo),
+	[JX64_MNEMONIC_MOVSS]       = JX64_CHECK_SSE_MOV(jx64_movss, JX64_SIZE_32),
+	[JX64_MNEMONIC_MOVSD]       = JX64_CHECK_SSE_MOV(jx64_movsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_MOVAPS]      = JX64_CHECK_SSE_MOV(jx64_movaps, JX64_SIZE_128),
+	[JX64_MNEMONIC_MOVAPD]      = JX64_CHECK_SSE_MOV(jx64_movapd, JX64_SIZE_128),
+	[JX64_MNEMONIC_MOVUPS]      = JX64_CHECK_SSE_MOV(jx64_movups, JX64_SIZE_128),
+	[JX64_MNEMONIC_MOVUPD]      = JX64_CHECK_SSE_MOV(jx64_movupd, JX64_SIZE_128),
+	[JX64_MNEMONIC_MOVD]        = JX64_CHECK_BINARY(jx64_movd, JX64_DISASM_FORM_VR | JX64_DISASM_FORM_RV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_MV, JX64_DISASM_SIZES_32, 0),
+	[JX64_MNEMONIC_MOVQ]        = JX64_CHECK_BINARY(jx64_movq, JX64_DISASM_FORM_VR | JX64_DISASM_FORM_RV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_MV, JX64_DISASM_SIZES_64, 0),
+	[JX64_MNEMONIC_ADDPS]       = JX64_CHECK_SSE(jx64_addps, JX64_SIZE_128),
+	[JX64_MNEMONIC_ADDSS]       = JX64_CHECK_SSE(jx64_addss, JX64_SIZE_32),
+	[JX64_MNEMONIC_ADDPD]       = JX64_CHECK_SSE(jx64_addpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_ADDSD]       = JX64_CHECK_SSE(jx64_addsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_ANDNPS]      = JX64_CHECK_SSE(jx64_andnps, JX64_SIZE_128),
+	[JX64_MNEMONIC_ANDNPD]      = JX64_CHECK_SSE(jx64_andnpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_ANDPS]       = JX64_CHECK_SSE(jx64_andps, JX64_SIZE_128),
+	[JX64_MNEMONIC_ANDPD]       = JX64_CHECK_SSE(jx64_andpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_CMPPS]       = JX64_CHECK_BINARY_IMM8(jx64_cmpps, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_VS, JX64_SIZE_128),
+	[JX64_MNEMONIC_CMPSS]       = JX64_CHECK_BINARY_IMM8(jx64_cmpss, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_VS, JX64_SIZE_32),
+	[JX64_MNEMONIC_CMPPD]       = JX64_CHECK_BINARY_IMM8(jx64_cmppd, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_VS, JX64_SIZE_128),
+	[JX64_MNEMONIC_CMPSD]       = JX64_CHECK_BINARY_IMM8(jx64_cmpsd, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_VS, JX64_SIZE_64),
+	[JX64_MNEMONIC_COMISS]      = JX64_CHECK_SSE(jx64_comiss, JX64_SIZE_32),
+	[JX64_MNEMONIC_COMISD]      = JX64_CHECK_SSE(jx64_comisd, JX64_SIZE_64),
+	[JX64_MNEMONIC_CVTSI2SS]    = JX64_CHECK_BINARY(jx64_cvtsi2ss, JX64_DISASM_FORM_VR | JX64_DISASM_FORM_VM, JX64_DISASM_SIZES_32_64, 0),
+	[JX64_MNEMONIC_CVTSI2SD]    = JX64_CHECK_BINARY(jx64_cvtsi2sd, JX64_DISASM_FORM_VR | JX64_DISASM_FORM_VM, JX64_DISASM_SIZES_32_64, 0),
+	[JX64_MNEMONIC_CVTSS2SI]    = JX64_CHECK_SSE_CVT2SI(jx64_cvtss2si, JX64_SIZE_32),
+	[JX64_MNEMONIC_CVTSD2SI]    = JX64_CHECK_SSE_CVT2SI(jx64_cvtsd2si, JX64_SIZE_64),
+	[JX64_MNEMONIC_CVTTSS2SI]   = JX64_CHECK_SSE_CVT2SI(jx64_cvttss2si, JX64_SIZE_32),
+	[JX64_MNEMONIC_CVTTSD2SI]   = JX64_CHECK_SSE_CVT2SI(jx64_cvttsd2si, JX64_SIZE_64),
+	[JX64_MNEMONIC_CVTSD2SS]    = JX64_CHECK_SSE(jx64_cvtsd2ss, JX64_SIZE_64),
+	[JX64_MNEMONIC_CVTSS2SD]    = JX64_CHECK_SSE(jx64_cvtss2sd, JX64_SIZE_32),
+	[JX64_MNEMONIC_DIVPS]       = JX64_CHECK_SSE(jx64_divps, JX64_SIZE_128),
+	[JX64_MNEMONIC_DIVSS]       = JX64_CHECK_SSE(jx64_divss, JX64_SIZE_32),
+	[JX64_MNEMONIC_DIVPD]       = JX64_CHECK_SSE(jx64_divpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_DIVSD]       = JX64_CHECK_SSE(jx64_divsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_MAXPS]       = JX64_CHECK_SSE(jx64_maxps, JX64_SIZE_128),
+	[JX64_MNEMONIC_MAXSS]       = JX64_CHECK_SSE(jx64_maxss, JX64_SIZE_32),
+	[JX64_MNEMONIC_MAXPD]       = JX64_CHECK_SSE(jx64_maxpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_MAXSD]       = JX64_CHECK_SSE(jx64_maxsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_MINPS]       = JX64_CHECK_SSE(jx64_minps, JX64_SIZE_128),
+	[JX64_MNEMONIC_MINSS]       = JX64_CHECK_SSE(jx64_minss, JX64_SIZE_32),
+	[JX64_MNEMONIC_MINPD]       = JX64_CHECK_SSE(jx64_minpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_MINSD]       = JX64_CHECK_SSE(jx64_minsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_MULPS]       = JX64_CHECK_SSE(jx64_mulps, JX64_SIZE_128),
+	[JX64_MNEMONIC_MULSS]       = JX64_CHECK_SSE(jx64_mulss, JX64_SIZE_32),
+	[JX64_MNEMONIC_MULPD]       = JX64_CHECK_SSE(jx64_mulpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_MULSD]       = JX64_CHECK_SSE(jx64_mulsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_ORPS]        = JX64_CHECK_SSE(jx64_orps, JX64_SIZE_128),
+	[JX64_MNEMONIC_ORPD]        = JX64_CHECK_SSE(jx64_orpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_RCPPS]       = JX64_CHECK_SSE(jx64_rcpps, JX64_SIZE_128),
+	[JX64_MNEMONIC_RCPSS]       = JX64_CHECK_SSE(jx64_rcpss, JX64_SIZE_32),
+	[JX64_MNEMONIC_RSQRTPS]     = JX64_CHECK_SSE(jx64_rsqrtps, JX64_SIZE_128),
+	[JX64_MNEMONIC_RSQRTSS]     = JX64_CHECK_SSE(jx64_rsqrtss, JX64_SIZE_32),
+	[JX64_MNEMONIC_SHUFPS]      = JX64_CHECK_BINARY_IMM8(jx64_shufps, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_VS, JX64_SIZE_128),
+	[JX64_MNEMONIC_SHUFPD]      = JX64_CHECK_BINARY_IMM8(jx64_shufpd, JX64_DISASM_FORM_VV | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_VS, JX64_SIZE_128),
+	[JX64_MNEMONIC_SQRTPS]      = JX64_CHECK_SSE(jx64_sqrtps, JX64_SIZE_128),
+	[JX64_MNEMONIC_SQRTSS]      = JX64_CHECK_SSE(jx64_sqrtss, JX64_SIZE_32),
+	[JX64_MNEMONIC_SQRTPD]      = JX64_CHECK_SSE(jx64_sqrtpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_SQRTSD]      = JX64_CHECK_SSE(jx64_sqrtsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_SUBPS]       = JX64_CHECK_SSE(jx64_subps, JX64_SIZE_128),
+	[JX64_MNEMONIC_SUBSS]       = JX64_CHECK_SSE(jx64_subss, JX64_SIZE_32),
+	[JX64_MNEMONIC_SUBPD]       = JX64_CHECK_SSE(jx64_subpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_SUBSD]       = JX64_CHECK_SSE(jx64_subsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_UCOMISS]     = JX64_CHECK_SSE(jx64_ucomiss, JX64_SIZE_32),
+	[JX64_MNEMONIC_UCOMISD]     = JX64_CHECK_SSE(jx64_ucomisd, JX64_SIZE_64),
+	[JX64_MNEMONIC_UNPCKHPS]    = JX64_CHECK_SSE(jx64_unpckhps, JX64_SIZE_128),
+	[JX64_MNEMONIC_UNPCKHPD]    = JX64_CHECK_SSE(jx64_unpckhpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_UNPCKLPS]    = JX64_CHECK_SSE(jx64_unpcklps, JX64_SIZE_128),
+	[JX64_MNEMONIC_UNPCKLPD]    = JX64_CHECK_SSE(jx64_unpcklpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_XORPS]       = JX64_CHECK_SSE(jx64_xorps, JX64_SIZE_128),
+	[JX64_MNEMONIC_XORPD]       = JX64_CHECK_SSE(jx64_xorpd, JX64_SIZE_128),
+	[JX64_MNEMONIC_PUNPCKLBW]   = JX64_CHECK_SSE(jx64_punpcklbw, JX64_SIZE_128),
+	[JX64_MNEMONIC_PUNPCKLWD]   = JX64_CHECK_SSE(jx64_punpcklwd, JX64_SIZE_128),
+	[JX64_MNEMONIC_PUNPCKLDQ]   = JX64_CHECK_SSE(jx64_punpckldq, JX64_SIZE_128),
+	[JX64_MNEMONIC_PUNPCKLQDQ]  = JX64_CHECK_SSE(jx64_punpcklqdq, JX64_SIZE_128),
+	[JX64_MNEMONIC_PUNPCKHBW]   = JX64_CHECK_SSE(jx64_punpckhbw, JX64_SIZE_128),
+	[JX64_MNEMONIC_PUNPCKHWD]   = JX64_CHECK_SSE(jx64_punpckhwd, JX64_SIZE_128),
+	[JX64_MNEMONIC_PUNPCKHDQ]   = JX64_CHECK_SSE(jx64_punpckhdq, JX64_SIZE_128),
+	[JX64_MNEMONIC_PUNPCKHQDQ]  = JX64_CHECK_SSE(jx64_punpckhqdq, JX64_SIZE_128),
+	[JX64_MNEMONIC_VZEROUPPER]  = JX64_CHECK_VOID(jx64_vzeroupper),
+	[JX64_MNEMONIC_VMOVSS]      = JX64_CHECK_AVX_MOVS(jx64_vmovss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VMOVSD]      = JX64_CHECK_AVX_MOVS(jx64_vmovsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VMOVAPS]     = JX64_CHECK_AVX_MOVP(jx64_vmovaps),
+	[JX64_MNEMONIC_VMOVAPD]     = JX64_CHECK_AVX_MOVP(jx64_vmovapd),
+	[JX64_MNEMONIC_VMOVUPS]     = JX64_CHECK_AVX_MOVP(jx64_vmovups),
+	[JX64_MNEMONIC_VMOVUPD]     = JX64_CHECK_AVX_MOVP(jx64_vmovupd),
+	[JX64_MNEMONIC_VADDPS]      = JX64_CHECK_AVX_P(jx64_vaddps),
+	[JX64_MNEMONIC_VADDSS]      = JX64_CHECK_AVX_S(jx64_vaddss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VADDPD]      = JX64_CHECK_AVX_P(jx64_vaddpd),
+	[JX64_MNEMONIC_VADDSD]      = JX64_CHECK_AVX_S(jx64_vaddsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VANDNPS]     = JX64_CHECK_AVX_P(jx64_vandnps),
+	[JX64_MNEMONIC_VANDNPD]     = JX64_CHECK_AVX_P(jx64_vandnpd),
+	[JX64_MNEMONIC_VANDPS]      = JX64_CHECK_AVX_P(jx64_vandps),
+	[JX64_MNEMONIC_VANDPD]      = JX64_CHECK_AVX_P(jx64_vandpd),
+	[JX64_MNEMONIC_VCMPPS]      = JX64_CHECK_TERNARY_IMM8(jx64_vcmpps, JX64_DISASM_FORM_VVV | JX64_DISASM_FORM_VVM | JX64_DISASM_FORM_VVS | JX64_DISASM_FORM_256, JX64_SIZE_128),
+	[JX64_MNEMONIC_VCMPSS]      = JX64_CHECK_TERNARY_IMM8(jx64_vcmpss, JX64_DISASM_FORM_VVV | JX64_DISASM_FORM_VVM | JX64_DISASM_FORM_VVS, JX64_SIZE_32),
+	[JX64_MNEMONIC_VCMPPD]      = JX64_CHECK_TERNARY_IMM8(jx64_vcmppd, JX64_DISASM_FORM_VVV | JX64_DISASM_FORM_VVM | JX64_DISASM_FORM_VVS | JX64_DISASM_FORM_256, JX64_SIZE_128),
+	[JX64_MNEMONIC_VCMPSD]      = JX64_CHECK_TERNARY_IMM8(jx64_vcmpsd, JX64_DISASM_FORM_VVV | JX64_DISASM_FORM_VVM | JX64_DISASM_FORM_VVS, JX64_SIZE_64),
+	[JX64_MNEMONIC_VCOMISS]     = JX64_CHECK_SSE(jx64_vcomiss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VCOMISD]     = JX64_CHECK_SSE(jx64_vcomisd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VCVTSI2SS]   = JX64_CHECK_TERNARY(jx64_vcvtsi2ss, JX64_DISASM_FORM_VVR | JX64_DISASM_FORM_VVM, JX64_DISASM_SIZES_32_64, 0),
+	[JX64_MNEMONIC_VCVTSI2SD]   = JX64_CHECK_TERNARY(jx64_vcvtsi2sd, JX64_DISASM_FORM_VVR | JX64_DISASM_FORM_VVM, JX64_DISASM_SIZES_32_64, 0),
+	[JX64_MNEMONIC_VCVTSS2SI]   = JX64_CHECK_SSE_CVT2SI(jx64_vcvtss2si, JX64_SIZE_32),
+	[JX64_MNEMONIC_VCVTSD2SI]   = JX64_CHECK_SSE_CVT2SI(jx64_vcvtsd2si, JX64_SIZE_64),
+	[JX64_MNEMONIC_VCVTTSS2SI]  = JX64_CHECK_SSE_CVT2SI(jx64_vcvttss2si, JX64_SIZE_32),
+	[JX64_MNEMONIC_VCVTTSD2SI]  = JX64_CHECK_SSE_CVT2SI(jx64_vcvttsd2si, JX64_SIZE_64),
+	[JX64_MNEMONIC_VCVTSD2SS]   = JX64_CHECK_AVX_S(jx64_vcvtsd2ss, JX64_SIZE_64),
+	[JX64_MNEMONIC_VCVTSS2SD]   = JX64_CHECK_AVX_S(jx64_vcvtss2sd, JX64_SIZE_32),
+	[JX64_MNEMONIC_VDIVPS]      = JX64_CHECK_AVX_P(jx64_vdivps),
+	[JX64_MNEMONIC_VDIVSS]      = JX64_CHECK_AVX_S(jx64_vdivss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VDIVPD]      = JX64_CHECK_AVX_P(jx64_vdivpd),
+	[JX64_MNEMONIC_VDIVSD]      = JX64_CHECK_AVX_S(jx64_vdivsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VMAXPS]      = JX64_CHECK_AVX_P(jx64_vmaxps),
+	[JX64_MNEMONIC_VMAXSS]      = JX64_CHECK_AVX_S(jx64_vmaxss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VMAXPD]      = JX64_CHECK_AVX_P(jx64_vmaxpd),
+	[JX64_MNEMONIC_VMAXSD]      = JX64_CHECK_AVX_S(jx64_vmaxsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VMINPS]      = JX64_CHECK_AVX_P(jx64_vminps),
+	[JX64_MNEMONIC_VMINSS]      = JX64_CHECK_AVX_S(jx64_vminss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VMINPD]      = JX64_CHECK_AVX_P(jx64_vminpd),
+	[JX64_MNEMONIC_VMINSD]      = JX64_CHECK_AVX_S(jx64_vminsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VMULPS]      = JX64_CHECK_AVX_P(jx64_vmulps),
+	[JX64_MNEMONIC_VMULSS]      = JX64_CHECK_AVX_S(jx64_vmulss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VMULPD]      = JX64_CHECK_AVX_P(jx64_vmulpd),
+	[JX64_MNEMONIC_VMULSD]      = JX64_CHECK_AVX_S(jx64_vmulsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VORPS]       = JX64_CHECK_AVX_P(jx64_vorps),
+	[JX64_MNEMONIC_VORPD]       = JX64_CHECK_AVX_P(jx64_vorpd),
+	[JX64_MNEMONIC_VRCPPS]      = JX64_CHECK_AVX_UNARYP(jx64_vrcpps),
+	[JX64_MNEMONIC_VRCPSS]      = JX64_CHECK_AVX_S(jx64_vrcpss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VRSQRTPS]    = JX64_CHECK_AVX_UNARYP(jx64_vrsqrtps),
+	[JX64_MNEMONIC_VRSQRTSS]    = JX64_CHECK_AVX_S(jx64_vrsqrtss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VSHUFPS]     = JX64_CHECK_TERNARY_IMM8(jx64_vshufps, JX64_DISASM_FORM_VVV | JX64_DISASM_FORM_VVM | JX64_DISASM_FORM_VVS | JX64_DISASM_FORM_256, JX64_SIZE_128),
+	[JX64_MNEMONIC_VSHUFPD]     = JX64_CHECK_TERNARY_IMM8(jx64_vshufpd, JX64_DISASM_FORM_VVV | JX64_DISASM_FORM_VVM | JX64_DISASM_FORM_VVS | JX64_DISASM_FORM_256, JX64_SIZE_128),
+	[JX64_MNEMONIC_VSQRTPS]     = JX64_CHECK_AVX_UNARYP(jx64_vsqrtps),
+	[JX64_MNEMONIC_VSQRTSS]     = JX64_CHECK_AVX_S(jx64_vsqrtss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VSQRTPD]     = JX64_CHECK_AVX_UNARYP(jx64_vsqrtpd),
+	[JX64_MNEMONIC_VSQRTSD]     = JX64_CHECK_AVX_S(jx64_vsqrtsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VSUBPS]      = JX64_CHECK_AVX_P(jx64_vsubps),
+	[JX64_MNEMONIC_VSUBSS]      = JX64_CHECK_AVX_S(jx64_vsubss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VSUBPD]      = JX64_CHECK_AVX_P(jx64_vsubpd),
+	[JX64_MNEMONIC_VSUBSD]      = JX64_CHECK_AVX_S(jx64_vsubsd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VUCOMISS]    = JX64_CHECK_SSE(jx64_vucomiss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VUCOMISD]    = JX64_CHECK_SSE(jx64_vucomisd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VUNPCKHPS]   = JX64_CHECK_AVX_P(jx64_vunpckhps),
+	[JX64_MNEMONIC_VUNPCKHPD]   = JX64_CHECK_AVX_P(jx64_vunpckhpd),
+	[JX64_MNEMONIC_VUNPCKLPS]   = JX64_CHECK_AVX_P(jx64_vunpcklps),
+	[JX64_MNEMONIC_VUNPCKLPD]   = JX64_CHECK_AVX_P(jx64_vunpcklpd),
+	[JX64_MNEMONIC_VXORPS]      = JX64_CHECK_AVX_P(jx64_vxorps),
+	[JX64_MNEMONIC_VXORPD]      = JX64_CHECK_AVX_P(jx64_vxorpd),
+	[JX64_MNEMONIC_VPUNPCKLBW]  = JX64_CHECK_AVX_S(jx64_vpunpcklbw, JX64_SIZE_128),
+	[JX64_MNEMONIC_VPUNPCKLWD]  = JX64_CHECK_AVX_S(jx64_vpunpcklwd, JX64_SIZE_128),
+	[JX64_MNEMONIC_VPUNPCKLDQ]  = JX64_CHECK_AVX_S(jx64_vpunpckldq, JX64_SIZE_128),
+	[JX64_MNEMONIC_VPUNPCKLQDQ] = JX64_CHECK_AVX_S(jx64_vpunpcklqdq, JX64_SIZE_128),
+	[JX64_MNEMONIC_VPUNPCKHBW]  = JX64_CHECK_AVX_S(jx64_vpunpckhbw, JX64_SIZE_128),
+	[JX64_MNEMONIC_VPUNPCKHWD]  = JX64_CHECK_AVX_S(jx64_vpunpckhwd, JX64_SIZE_128),
+	[JX64_MNEMONIC_VPUNPCKHDQ]  = JX64_CHECK_AVX_S(jx64_vpunpckhdq, JX64_SIZE_128),
+	[JX64_MNEMONIC_VPUNPCKHQDQ] = JX64_CHECK_AVX_S(jx64_vpunpckhqdq, JX64_SIZE_128),
+	[JX64_MNEMONIC_VFMADD213PS] = JX64_CHECK_AVX_P(jx64_vfmadd213ps),
+	[JX64_MNEMONIC_VFMADD213SS] = JX64_CHECK_AVX_S(jx64_vfmadd213ss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VFMADD213PD] = JX64_CHECK_AVX_P(jx64_vfmadd213pd),
+	[JX64_MNEMONIC_VFMADD213SD] = JX64_CHECK_AVX_S(jx64_vfmadd213sd, JX64_SIZE_64),
+	[JX64_MNEMONIC_VFMADD231PS] = JX64_CHECK_AVX_P(jx64_vfmadd231ps),
+	[JX64_MNEMONIC_VFMADD231SS] = JX64_CHECK_AVX_S(jx64_vfmadd231ss, JX64_SIZE_32),
+	[JX64_MNEMONIC_VFMADD231PD] = JX64_CHECK_AVX_P(jx64_vfmadd231pd),
+	[JX64_MNEMONIC_VFMADD231SD] = JX64_CHECK_AVX_S(jx64_vfmadd231sd, JX64_SIZE_64),
+};
+
+#undef JX64_CHECK_NOP
+#undef JX64_CHECK_VOID
+#undef JX64_CHECK_UNARY
+#undef JX64_CHECK_BINARY
+#undef JX64_CHECK_TERNARY
+#undef JX64_CHECK_BINARY_IMM8
+#undef JX64_CHECK_TERNARY_IMM8
+#undef JX64_CHECK_COND_UNARY
+#undef JX64_CHECK_COND_BINARY
+#undef JX64_CHECK_SSE
+#undef JX64_CHECK_SSE_MOV
+#undef JX64_CHECK_SSE_CVT2SI
+#undef JX64_CHECK_AVX_MOVP
+#undef JX64_CHECK_AVX_MOVS
+#undef JX64_CHECK_AVX_UNARYP
+#undef JX64_CHECK_AVX_P
+#undef JX64_CHECK_AVX_S
+
+// NOTE: Registers are picked so that every instruction is checked with and without REX/VEX
+// extension bits, incl. the special rm/base encodings of rsp/rbp/r12/r13.
+static const uint32_t kCheckGPR[] = { JX64_REG_ID_RAX, JX64_REG_ID_RSI, JX64_REG_ID_R9, JX64_REG_ID_R13 };
+static const uint32_t kCheckVec[] = { 0, 7, 9, 15 };
+
+static const jx_x64_mem_t kCheckMem[] = {
+	{ .m_Base = JX64_REG_RBX, .m_Index = JX64_REG_NONE, .m_Scale = JX64_SCALE_1, .m_Displacement = 0 },
+	{ .m_Base = JX64_REG_RBP, .m_Index = JX64_REG_NONE, .m_Scale = JX64_SCALE_1, .m_Displacement = 0 },
+	{ .m_Base = JX64_REG_RSP, .m_Index = JX64_REG_NONE, .m_Scale = JX64_SCALE_1, .m_Displacement = 8 },
+	{ .m_Base = JX64_REG_R13, .m_Index = JX64_REG_NONE, .m_Scale = JX64_SCALE_1, .m_Displacement = 0x100 },
+	{ .m_Base = JX64_REG_R12, .m_Index = JX64_REG_NONE, .m_Scale = JX64_SCALE_1, .m_Displacement = 0 },
+	{ .m_Base = JX64_REG_RAX, .m_Index = JX64_REG_R9, .m_Scale = JX64_SCALE_4, .m_Displacement = -8 },
+	{ .m_Base = JX64_REG_RBP, .m_Index = JX64_REG_RCX, .m_Scale = JX64_SCALE_8, .m_Displacement = 0 },
+	{ .m_Base = JX64_REG_NONE, .m_Index = JX64_REG_R8, .m_Scale = JX64_SCALE_2, .m_Displacement = 0x40 },
+	{ .m_Base = JX64_REG_NONE, .m_Index = JX64_REG_NONE, .m_Scale = JX64_SCALE_1, .m_Displacement = 0x1000 },
+	{ .m_Base = JX64_REG_RIP, .m_Index = JX64_REG_NONE, .m_Scale = JX64_SCALE_1, .m_Displacement = 0x10 },
+	{ .m_Base = JX64_REG_EAX, .m_Index = JX64_REG_ECX, .m_Scale = JX64_SCALE_2, .m_Displacement = 4 },
+	{ .m_Base = JX64_REG_ECX, .m_Index = JX64_REG_NONE, .m_Scale = JX64_SCALE_1, .m_Displacement = -0x200 },
+};
+
+static void jx64_disasm_checkMnemonic(jx_x64_disasm_checker_t* checker, jx_x64_mnemonic mnemonic);
+static void jx64_disasm_checkGPRForms(jx_x64_disasm_checker_t* checker, jx_x64_mnemonic mnemonic, jx_x64_condition_code cc, jx_x64_size size);
+static void jx64_disasm_checkVecForms(jx_x64_disasm_checker_t* checker, jx_x64_mnemonic mnemonic, jx_x64_condition_code cc, bool is256);
+static void jx64_disasm_checkInstr(jx_x64_disasm_checker_t* checker, jx_x64_mnemonic mnemonic, jx_x64_condition_code cc, const jx_x64_operand_t* srcOps, uint32_t numSrcOps);
+static bool jx64_disasm_checkEmit(jx_x64_context_t* ctx, const jx_x64_disasm_check_desc_t* desc, jx_x64_condition_code cc, const jx_x64_operand_t* ops);
+static uint32_t jx64_disasm_checkMapOperands(jx_x64_disasm_checker_t* checker, const jx_x64_disasm_instr_t* instr, uint32_t instrOffset, uint32_t firstReloc, jx_x64_operand_t* ops);
+static bool jx64_disasm_checkOperandEqual(const jx_x64_operand_t* a, const jx_x64_operand_t* b);
+static void jx64_disasm_checkFail(jx_x64_disasm_checker_t* checker, jx_x64_mnemonic mnemonic, jx_x64_condition_code cc, const char* reason, uint32_t instrOffset, uint32_t instrSize);
+static uint32_t jx64_disasm_checkImmediates(jx_x64_mnemonic mnemonic, jx_x64_size size, bool isMem, jx_x64_operand_t* imm);
+static jx_x64_operand_t jx64_disasm_checkGPR(uint32_t id, jx_x64_size size);
+static jx_x64_operand_t jx64_disasm_checkVecReg(uint32_t id, bool is256);
+static jx_x64_operand_t jx64_disasm_checkMem(uint32_t id, jx_x64_size size);
+
+bool jx64_disasmSelfCheck(jx_allocator_i* allocator, jx_string_buffer_t* log)
+{
+	jx_x64_context_t* ctx = jx_x64_createContext(allocator);
+	if (!ctx) {
+		return false;
+	}
+
+	jx_x64_disasm_checker_t* checker = &(jx_x64_disasm_checker_t){
+		.m_Ctx = ctx,
+		.m_Log = log
+	};
+
+	static const uint8_t kVarData[16] = { 0 };
+	checker->m_Func = jx64_funcDeclare(ctx, "jx64_disasm_check");
+	checker->m_ExtFunc = jx64_funcDeclare(ctx, "jx64_disasm_check_callee");
+	checker->m_Var = jx64_globalVarDeclare(ctx, "jx64_disasm_check_var");
+	jx64_globalVarDefine(ctx, checker->m_Var, JX64_SECTION_DATA, kVarData, JX_COUNTOF(kVarData), 16);
+
+	jx64_funcBegin(ctx, checker->m_Func);
+	checker->m_Label = jx64_labelAlloc(ctx, JX64_SECTION_TEXT);
+	jx64_labelBind(ctx, checker->m_Label);
+
+	for (uint32_t iMnemonic = JX64_MNEMONIC_UNKNOWN + 1; iMnemonic < JX64_MNEMONIC_COUNT; ++iMnemonic) {
+		jx64_disasm_checkMnemonic(checker, (jx_x64_mnemonic)iMnemonic);
+	}
+
+	jx64_funcEnd(ctx);
+	jx64_labelFree(ctx, checker->m_Label);
+	jx_x64_destroyContext(ctx);
+
+	jx_strbuf_printf(log, "x64 disassembler self-check: %u instructions, %u failures\n", checker->m_NumInstructions, checker->m_NumFailures);
+
+	return checker->m_NumFailures == 0;
+}
+
+static void jx64_disasm_checkMnemonic(jx_x64_disasm_checker_t* checker, jx_x64_mnemonic mnemonic)
+{
+	const jx_x64_disasm_check_desc_t* desc = &kCheckDesc[mnemonic];
+	if (desc->m_Kind == JX64_DISASM_CHECK_NONE) {
+		return;
+	}
+
+	if (desc->m_Kind == JX64_DISASM_CHECK_NOP) {
+		for (uint32_t n = 1; n <= 11; ++n) {
+			const jx_x64_operand_t op = jx64_opImmI32((int32_t)n);
+			jx64_disasm_checkInstr(checker, mnemonic, JX64_CC_O, &op, 1);
+		}
+		return;
+	} else if (desc->m_Kind == JX64_DISASM_CHECK_VOID) {
+		jx64_disasm_checkInstr(checker, mnemonic, JX64_CC_O, NULL, 0);
+		return;
+	}
+
+	const bool hasCC = false
+		|| desc->m_Kind == JX64_DISASM_CHECK_COND_UNARY
+		|| desc->m_Kind == JX64_DISASM_CHECK_COND_BINARY
+		;
+	const uint32_t numCC = hasCC
+		? 16
+		: 1
+		;
+	for (uint32_t iCC = 0; iCC < numCC; ++iCC) {
+		const jx_x64_condition_code cc = (jx_x64_condition_code)iCC;
+
+		for (uint32_t size = JX64_SIZE_8; size <= JX64_SIZE_64; ++size) {
+			if ((desc->m_Sizes & (1u << size)) != 0) {
+				jx64_disasm_checkGPRForms(checker, mnemonic, cc, (jx_x64_size)size);
+			}
+		}
+
+		if ((desc->m_Forms & JX64_DISASM_FORM_I) != 0) {
+			static const int32_t kPushImm[] = { 0x7F, -2, 0x12345678, 5 };
+			for (uint32_t i = 0; i < JX_COUNTOF(kPushImm); ++i) {
+				const jx_x64_operand_t op = i < 2
+					? jx64_opImmI8((int8_t)kPushImm[i])
+					: jx64_opImmI32(kPushImm[i])
+					;
+				jx64_disasm_checkInstr(checker, mnemonic, cc, &op, 1);
+			}
+		}
+		if ((desc->m_Forms & JX64_DISASM_FORM_LBL) != 0) {
+			const jx_x64_operand_t op = jx64_opLbl(JX64_SIZE_32, checker->m_Label);
+			jx64_disasm_checkInstr(checker, mnemonic, cc, &op, 1);
+		}
+		if ((desc->m_Forms & JX64_DISASM_FORM_SYM) != 0) {
+			const jx_x64_operand_t op = jx64_opSymbol(JX64_SIZE_64, checker->m_ExtFunc);
+			jx64_disasm_checkInstr(checker, mnemonic, cc, &op, 1);
+		}
+		if ((desc->m_Forms & JX64_DISASM_FORM_MSYM) != 0) {
+			const jx_x64_operand_t op = jx64_opMemSymbol(JX64_SIZE_64, checker->m_Var, 8);
+			jx64_disasm_checkInstr(checker, mnemonic, cc, &op, 1);
+		}
+
+		if (desc->m_MemSize != 0) {
+			jx64_disasm_checkVecForms(checker, mnemonic, cc, false);
+			if ((desc->m_Forms & JX64_DISASM_FORM_256) != 0) {
+				jx64_disasm_checkVecForms(checker, mnemonic, cc, true);
+			}
+		}
+	}
+}
+
+// Forms with GPR operands (or memory operands with the size of the GPR) of the specified size.
+static void jx64_disasm_checkGPRForms(jx_x64_disasm_checker_t* checker, jx_x64_mnemonic mnemonic, jx_x64_condition_code cc, jx_x64_size size)
+{
+	const jx_x64_disasm_check_desc_t* desc = &kCheckDesc[mnemonic];
+	const uint32_t forms = desc->m_Forms;
+	const uint32_t numGPR = JX_COUNTOF(kCheckGPR);
+	const uint32_t numVec = JX_COUNTOF(kCheckVec);
+	const uint32_t numMem = JX_COUNTOF(kCheckMem);
+	const bool hasVecOperands = desc->m_MemSize != 0 || (forms & (JX64_DISASM_FORM_VR | JX64_DISASM_FORM_RV | JX64_DISASM_FORM_VVR | JX64_DISASM_FORM_VM | JX64_DISASM_FORM_MV | JX64_DISASM_FORM_VVM)) != 0;
+
+	jx_x64_operand_t ops[4];
+	for (uint32_t i = 0; i < numGPR; ++i) {
+		ops[0] = jx64_disasm_checkGPR(kCheckGPR[i], size);
+		if ((forms & JX64_DISASM_FORM_R) != 0) {
+			jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 1);
+		}
+
+		for (uint32_t j = 0; j < numGPR; ++j) {
+			ops[1] = jx64_disasm_checkGPR(kCheckGPR[j], size);
+			if ((forms & JX64_DISASM_FORM_RR) != 0) {
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+			if ((forms & JX64_DISASM_FORM_RRI) != 0) {
+				jx_x64_operand_t imm[2];
+				const uint32_t numImm = jx64_disasm_checkImmediates(mnemonic, size, false, imm);
+				for (uint32_t k = 0; k < numImm; ++k) {
+					ops[2] = imm[k];
+					jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 3);
+				}
+			}
+			if ((forms & JX64_DISASM_FORM_EXT) != 0) {
+				for (uint32_t srcSize = JX64_SIZE_8; srcSize <= JX64_SIZE_16 && srcSize < (uint32_t)size; ++srcSize) {
+					ops[1] = jx64_disasm_checkGPR(kCheckGPR[j], (jx_x64_size)srcSize);
+					jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+				}
+			}
+			if ((forms & JX64_DISASM_FORM_EXT32) != 0 && size == JX64_SIZE_64) {
+				ops[1] = jx64_disasm_checkGPR(kCheckGPR[j], JX64_SIZE_32);
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+		}
+
+		for (uint32_t j = 0; j < numMem; ++j) {
+			ops[1] = jx64_disasm_checkMem(j, size);
+			if ((forms & JX64_DISASM_FORM_RM) != 0) {
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+			if ((forms & JX64_DISASM_FORM_EXT) != 0) {
+				for (uint32_t srcSize = JX64_SIZE_8; srcSize <= JX64_SIZE_16 && srcSize < (uint32_t)size; ++srcSize) {
+					ops[1] = jx64_disasm_checkMem(j, (jx_x64_size)srcSize);
+					jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+				}
+			}
+			if ((forms & JX64_DISASM_FORM_EXT32) != 0 && size == JX64_SIZE_64) {
+				ops[1] = jx64_disasm_checkMem(j, JX64_SIZE_32);
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+			if ((forms & JX64_DISASM_FORM_RVM) != 0) {
+				ops[1] = jx64_disasm_checkMem(j, (jx_x64_size)desc->m_MemSize);
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+		}
+
+		if ((forms & JX64_DISASM_FORM_RI) != 0) {
+			jx_x64_operand_t imm[2];
+			const uint32_t numImm = jx64_disasm_checkImmediates(mnemonic, size, false, imm);
+			for (uint32_t k = 0; k < numImm; ++k) {
+				ops[1] = imm[k];
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+		}
+		if ((forms & JX64_DISASM_FORM_SHIFT) != 0) {
+			const jx_x64_operand_t kShift[] = { jx64_opImmI8(1), jx64_opImmI8(5), jx64_opReg(JX64_REG_CL) };
+			for (uint32_t k = 0; k < JX_COUNTOF(kShift); ++k) {
+				ops[1] = kShift[k];
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+		}
+		if ((forms & JX64_DISASM_FORM_RS) != 0) {
+			ops[1] = jx64_opSymbol(size, checker->m_Var);
+			jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+		}
+		if ((forms & JX64_DISASM_FORM_RV) != 0) {
+			for (uint32_t j = 0; j < numVec; ++j) {
+				ops[1] = jx64_disasm_checkVecReg(kCheckVec[j], false);
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < numMem; ++i) {
+		ops[0] = jx64_disasm_checkMem(i, size);
+		if ((forms & JX64_DISASM_FORM_M) != 0) {
+			jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 1);
+		}
+		if ((forms & JX64_DISASM_FORM_MR) != 0) {
+			for (uint32_t j = 0; j < numGPR; ++j) {
+				ops[1] = jx64_disasm_checkGPR(kCheckGPR[j], size);
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+		}
+		if ((forms & JX64_DISASM_FORM_MI) != 0) {
+			jx_x64_operand_t imm[2];
+			const uint32_t numImm = jx64_disasm_checkImmediates(mnemonic, size, true, imm);
+			for (uint32_t k = 0; k < numImm; ++k) {
+				ops[1] = imm[k];
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+		}
+		if ((forms & JX64_DISASM_FORM_SHIFT) != 0) {
+			const jx_x64_operand_t kShift[] = { jx64_opImmI8(1), jx64_opImmI8(5), jx64_opReg(JX64_REG_CL) };
+			for (uint32_t k = 0; k < JX_COUNTOF(kShift); ++k) {
+				ops[1] = kShift[k];
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+		}
+	}
+
+	if ((forms & JX64_DISASM_FORM_SR) != 0) {
+		ops[0] = jx64_opSymbol(size, checker->m_Var);
+		for (uint32_t j = 0; j < numGPR; ++j) {
+			ops[1] = jx64_disasm_checkGPR(kCheckGPR[j], size);
+			jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+		}
+	}
+
+	// Conversions and moves between GPRs and vector registers
+	if (!hasVecOperands) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < numVec; ++i) {
+		ops[0] = jx64_disasm_checkVecReg(kCheckVec[i], false);
+		for (uint32_t j = 0; j < numGPR; ++j) {
+			ops[1] = jx64_disasm_checkGPR(kCheckGPR[j], size);
+			if ((forms & JX64_DISASM_FORM_VR) != 0) {
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+
+			if ((forms & JX64_DISASM_FORM_VVR) != 0) {
+				for (uint32_t k = 0; k < numVec; ++k) {
+					ops[1] = jx64_disasm_checkVecReg(kCheckVec[k], false);
+					ops[2] = jx64_disasm_checkGPR(kCheckGPR[j], size);
+					jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 3);
+				}
+			}
+		}
+
+		// Memory operands with the size of the GPR
+		if (desc->m_MemSize != 0) {
+			continue;
+		}
+
+		for (uint32_t j = 0; j < numMem; ++j) {
+			ops[1] = jx64_disasm_checkMem(j, size);
+			if ((forms & JX64_DISASM_FORM_VM) != 0) {
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+
+			if ((forms & JX64_DISASM_FORM_MV) != 0) {
+				const jx_x64_operand_t store[2] = { ops[1], ops[0] };
+				jx64_disasm_checkInstr(checker, mnemonic, cc, store, 2);
+			}
+
+			if ((forms & JX64_DISASM_FORM_VVM) != 0) {
+				for (uint32_t k = 0; k < numVec; ++k) {
+					ops[1] = jx64_disasm_checkVecReg(kCheckVec[k], false);
+					ops[2] = jx64_disasm_checkMem(j, size);
+					jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 3);
+				}
+			}
+		}
+	}
+}
+
+// Forms with only vector register and vector memory operands.
+static void jx64_disasm_checkVecForms(jx_x64_disasm_checker_t* checker, jx_x64_mnemonic mnemonic, jx_x64_condition_code cc, bool is256)
+{
+	const jx_x64_disasm_check_desc_t* desc = &kCheckDesc[mnemonic];
+	const uint32_t forms = desc->m_Forms;
+	const jx_x64_size memSize = is256
+		? JX64_SIZE_256
+		: (jx_x64_size)desc->m_MemSize
+		;
+	const uint32_t numVec = JX_COUNTOF(kCheckVec);
+	const uint32_t numMem = JX_COUNTOF(kCheckMem);
+
+	jx_x64_operand_t ops[4];
+	for (uint32_t i = 0; i < numVec; ++i) {
+		ops[0] = jx64_disasm_checkVecReg(kCheckVec[i], is256);
+
+		for (uint32_t j = 0; j < numVec; ++j) {
+			ops[1] = jx64_disasm_checkVecReg(kCheckVec[j], is256);
+			if ((forms & JX64_DISASM_FORM_VV) != 0) {
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+
+			for (uint32_t k = 0; k < numVec; ++k) {
+				ops[2] = jx64_disasm_checkVecReg(kCheckVec[k], is256);
+				if ((forms & JX64_DISASM_FORM_VVV) != 0) {
+					jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 3);
+				}
+			}
+
+			for (uint32_t k = 0; k < numMem; ++k) {
+				ops[2] = jx64_disasm_checkMem(k, memSize);
+				if ((forms & JX64_DISASM_FORM_VVM) != 0) {
+					jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 3);
+				}
+			}
+
+			ops[2] = jx64_opSymbol(memSize, checker->m_Var);
+			if ((forms & JX64_DISASM_FORM_VVS) != 0) {
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 3);
+			}
+		}
+
+		for (uint32_t j = 0; j < numMem; ++j) {
+			ops[1] = jx64_disasm_checkMem(j, memSize);
+			if ((forms & JX64_DISASM_FORM_VM) != 0) {
+				jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+			}
+
+			if ((forms & JX64_DISASM_FORM_MV) != 0) {
+				const jx_x64_operand_t store[2] = { ops[1], ops[0] };
+				jx64_disasm_checkInstr(checker, mnemonic, cc, store, 2);
+			}
+		}
+
+		ops[1] = jx64_opSymbol(memSize, checker->m_Var);
+		if ((forms & JX64_DISASM_FORM_VS) != 0) {
+			jx64_disasm_checkInstr(checker, mnemonic, cc, ops, 2);
+		}
+	}
+}
+
+// Emits the instruction, decodes it and checks that it matches the original. Then re-encodes
+// the decoded instruction and checks that it produces the same bytes.
+static void jx64_disasm_checkInstr(jx_x64_disasm_checker_t* checker, jx_x64_mnemonic mnemonic, jx_x64_condition_code cc, const jx_x64_operand_t* srcOps, uint32_t numSrcOps)
+{
+	jx_x64_context_t* ctx = checker->m_Ctx;
+	const jx_x64_disasm_check_desc_t* desc = &kCheckDesc[mnemonic];
+
+	jx_x64_operand_t ops[4];
+	uint32_t numOps = 0;
+	for (uint32_t i = 0; i < numSrcOps; ++i) {
+		ops[numOps++] = srcOps[i];
+	}
+	if (desc->m_Kind == JX64_DISASM_CHECK_BINARY_IMM8 || desc->m_Kind == JX64_DISASM_CHECK_TERNARY_IMM8) {
+		ops[numOps++] = jx64_opImmI8(0x1B);
+	}
+
+	checker->m_NumInstructions++;
+
+	const uint32_t offset = jx64_sectionGetSize(ctx, JX64_SECTION_TEXT);
+	const uint32_t firstReloc = (uint32_t)jx_array_sizeu(checker->m_Func->m_RelocArr);
+	if (!jx64_disasm_checkEmit(ctx, desc, cc, ops)) {
+		jx64_disasm_checkFail(checker, mnemonic, cc, "emit failed", offset, 0);
+		return;
+	}
+
+	const uint32_t size = jx64_sectionGetSize(ctx, JX64_SECTION_TEXT) - offset;
+
+	jx_x64_disasm_instr_t instr;
+	if (!jx64_disasmDecode(&jx64_sectionGetBuffer(ctx, JX64_SECTION_TEXT)[offset], size, &instr)) {
+		jx64_disasm_checkFail(checker, mnemonic, cc, "decode failed", offset, size);
+		return;
+	}
+
+	const bool isSameInstr = true
+		&& instr.m_Size == size
+		&& instr.m_Mnemonic == mnemonic
+		&& (!jx64_disasm_hasCC(mnemonic) || instr.m_CC == cc)
+		;
+	if (!isSameInstr) {
+		jx64_disasm_checkFail(checker, mnemonic, cc, "wrong instruction", offset, size);
+		return;
+	}
+
+	// NOTE: NOP operands are padding.
+	if (desc->m_Kind == JX64_DISASM_CHECK_NOP) {
+		return;
+	}
+
+	jx_x64_operand_t decodedOps[4];
+	const uint32_t numDecodedOps = jx64_disasm_checkMapOperands(checker, &instr, offset, firstReloc, decodedOps);
+	bool hasLabel = false;
+	bool operandsMatch = numDecodedOps == numOps;
+	for (uint32_t i = 0; i < numOps && operandsMatch; ++i) {
+		operandsMatch = jx64_disasm_checkOperandEqual(&ops[i], &decodedOps[i]);
+		hasLabel = hasLabel || ops[i].m_Type == JX64_OPERAND_LBL;
+	}
+	if (!operandsMatch) {
+		jx64_disasm_checkFail(checker, mnemonic, cc, "wrong operands", offset, size);
+		return;
+	}
+
+	// Re-encode
+	const uint32_t reOffset = jx64_sectionGetSize(ctx, JX64_SECTION_TEXT);
+	const uint32_t reFirstReloc = (uint32_t)jx_array_sizeu(checker->m_Func->m_RelocArr);
+	if (!jx64_disasm_checkEmit(ctx, desc, cc, decodedOps)) {
+		jx64_disasm_checkFail(checker, mnemonic, cc, "re-encoding failed", offset, size);
+		return;
+	}
+
+	const uint32_t reSize = jx64_sectionGetSize(ctx, JX64_SECTION_TEXT) - reOffset;
+	const uint8_t* text = jx64_sectionGetBuffer(ctx, JX64_SECTION_TEXT);
+	if (!hasLabel) {
+		if (reSize != size || jx_memcmp(&text[offset], &text[reOffset], size) != 0) {
+			jx64_disasm_checkFail(checker, mnemonic, cc, "re-encoded bytes differ", reOffset, reSize);
+		}
+	} else {
+		// NOTE: Label displacements depend on the position of the instruction.
+		jx_x64_disasm_instr_t reInstr;
+		jx_x64_operand_t reOps[4];
+		const bool isValid = true
+			&& jx64_disasmDecode(&text[reOffset], reSize, &reInstr)
+			&& reInstr.m_Size == reSize
+			&& reInstr.m_Mnemonic == mnemonic
+			&& reInstr.m_CC == instr.m_CC
+			&& jx64_disasm_checkMapOperands(checker, &reInstr, reOffset, reFirstReloc, reOps) == numOps
+			;
+		bool reOperandsMatch = isValid;
+		for (uint32_t i = 0; i < numOps && reOperandsMatch; ++i) {
+			reOperandsMatch = jx64_disasm_checkOperandEqual(&ops[i], &reOps[i]);
+		}
+		if (!reOperandsMatch) {
+			jx64_disasm_checkFail(checker, mnemonic, cc, "re-encoded instruction differs", reOffset, reSize);
+		}
+	}
+}
+
+static bool jx64_disasm_checkEmit(jx_x64_context_t* ctx, const jx_x64_disasm_check_desc_t* desc, jx_x64_condition_code cc, const jx_x64_operand_t* ops)
+{
+	switch (desc->m_Kind) {
+	case JX64_DISASM_CHECK_NOP:
+		return desc->u.m_Nop(ctx, (uint32_t)ops[0].u.m_ImmI64);
+	case JX64_DISASM_CHECK_VOID:
+		return desc->u.m_Void(ctx);
+	case JX64_DISASM_CHECK_UNARY:
+		return desc->u.m_Unary(ctx, ops[0]);
+	case JX64_DISASM_CHECK_BINARY:
+		return desc->u.m_Binary(ctx, ops[0], ops[1]);
+	case JX64_DISASM_CHECK_TERNARY:
+		return desc->u.m_Ternary(ctx, ops[0], ops[1], ops[2]);
+	case JX64_DISASM_CHECK_BINARY_IMM8:
+		return desc->u.m_BinaryImm8(ctx, ops[0], ops[1], (uint8_t)ops[2].u.m_ImmI64);
+	case JX64_DISASM_CHECK_TERNARY_IMM8:
+		return desc->u.m_TernaryImm8(ctx, ops[0], ops[1], ops[2], (uint8_t)ops[3].u.m_ImmI64);
+	case JX64_DISASM_CHECK_COND_UNARY:
+		return desc->u.m_CondUnary(ctx, cc, ops[0]);
+	case JX64_DISASM_CHECK_COND_BINARY:
+		return desc->u.m_CondBinary(ctx, cc, ops[0], ops[1]);
+	default:
+		JX_CHECK(false, "Unknown check kind");
+		break;
+	}
+
+	return false;
+}
+
+// Converts the decoded operands to the operands passed to the jx64_* functions: branches 
+// to the check label become label operands and relocated displacements become symbols.
+static uint32_t jx64_disasm_checkMapOperands(jx_x64_disasm_checker_t* checker, const jx_x64_disasm_instr_t* instr, uint32_t instrOffset, uint32_t firstReloc, jx_x64_operand_t* ops)
+{
+	jx_x64_context_t* ctx = checker->m_Ctx;
+	const uint32_t labelOffset = jx64_labelGetOffset(ctx, checker->m_Label);
+	const jx_x64_relocation_t* relocArr = checker->m_Func->m_RelocArr;
+	const uint32_t numRelocs = (uint32_t)jx_array_sizeu(relocArr);
+	const jx_x64_relocation_t* reloc = numRelocs > firstReloc
+		? jx64_disasm_findReloc(&relocArr[firstReloc], numRelocs - firstReloc, instrOffset - labelOffset, instr)
+		: NULL
+		;
+	jx_x64_symbol_t* sym = reloc
+		? jx64_symbolGetByName(ctx, reloc->m_SymbolName)
+		: NULL
+		;
+
+	const bool isBranch = jx64_disasm_isBranch(instr);
+	for (uint32_t i = 0; i < instr->m_NumOperands; ++i) {
+		jx_x64_operand_t op = instr->m_Operands[i];
+		if (op.m_Type == JX64_OPERAND_IMM && isBranch) {
+			const int64_t target = (int64_t)instrOffset + instr->m_Size + op.u.m_ImmI64;
+			if (sym) {
+				op = jx64_opSymbol(JX64_SIZE_64, sym);
+			} else if (target == (int64_t)labelOffset) {
+				op = jx64_opLbl(JX64_SIZE_32, checker->m_Label);
+			}
+		} else if (op.m_Type == JX64_OPERAND_MEM && op.u.m_Mem.m_Base == JX64_REG_RIP && sym) {
+			if (isBranch) {
+				op = jx64_opMemSymbol(JX64_SIZE_64, sym, op.u.m_Mem.m_Displacement);
+			} else if (op.u.m_Mem.m_Displacement == 0) {
+				op = jx64_opSymbol(op.m_Size, sym);
+			}
+		}
+		ops[i] = op;
+	}
+
+	// NOTE: VEX scalar reg-reg moves are emitted by jx64_vmovss/vmovsd with the destination
+	// as the first source.
+	uint32_t numOps = instr->m_NumOperands;
+	if (kCheckDesc[instr->m_Mnemonic].m_Kind == JX64_DISASM_CHECK_BINARY && numOps == 3) {
+		ops[1] = ops[2];
+		numOps = 2;
+	}
+
+	return numOps;
+}
+
+static bool jx64_disasm_checkOperandEqual(const jx_x64_operand_t* a, const jx_x64_operand_t* b)
+{
+	if (a->m_Type != b->m_Type) {
+		return false;
+	}
+
+	switch (a->m_Type) {
+	case JX64_OPERAND_REG:
+		return a->u.m_Reg == b->u.m_Reg;
+	case JX64_OPERAND_IMM:
+		return a->u.m_ImmI64 == b->u.m_ImmI64;
+	case JX64_OPERAND_MEM:
+		return true
+			&& a->m_Size == b->m_Size
+			&& a->u.m_Mem.m_Base == b->u.m_Mem.m_Base
+			&& a->u.m_Mem.m_Index == b->u.m_Mem.m_Index
+			&& (a->u.m_Mem.m_Index == JX64_REG_NONE || a->u.m_Mem.m_Scale == b->u.m_Mem.m_Scale)
+			&& a->u.m_Mem.m_Displacement == b->u.m_Mem.m_Displacement
+			;
+	case JX64_OPERAND_LBL:
+		return a->u.m_Lbl == b->u.m_Lbl;
+	case JX64_OPERAND_SYM:
+		return a->u.m_Sym == b->u.m_Sym;
+	case JX64_OPERAND_MEM_SYM:
+		return true
+			&& a->u.m_MemSym.m_Symbol == b->u.m_MemSym.m_Symbol
+			&& a->u.m_MemSym.m_Displacement == b->u.m_MemSym.m_Displacement
+			;
+	default:
+		break;
+	}
+
+	return false;
+}
+
+static void jx64_disasm_checkFail(jx_x64_disasm_checker_t* checker, jx_x64_mnemonic mnemonic, jx_x64_condition_code cc, const char* reason, uint32_t instrOffset, uint32_t instrSize)
+{
+	jx_string_buffer_t* log = checker->m_Log;
+	const uint8_t* code = &jx64_sectionGetBuffer(checker->m_Ctx, JX64_SECTION_TEXT)[instrOffset];
+
+	checker->m_NumFailures++;
+
+	jx64_disasm_printMnemonic(log, mnemonic, cc);
+	jx_strbuf_printf(log, ": %s:", reason);
+	for (uint32_t i = 0; i < instrSize; ++i) {
+		jx_strbuf_printf(log, " %02X", code[i]);
+	}
+
+	jx_x64_disasm_instr_t instr;
+	if (instrSize != 0 && jx64_disasmDecode(code, instrSize, &instr)) {
+		jx_strbuf_pushCStr(log, " -> ");
+		jx64_disasm_printInstr(log, &instr, 0, NULL, NULL);
+	}
+	jx_strbuf_pushCStr(log, "\n");
+}
+
+// NOTE: The encoder picks the shortest form for each immediate so both a small and a large
+// value is used for each size.
+static uint32_t jx64_disasm_checkImmediates(jx_x64_mnemonic mnemonic, jx_x64_size size, bool isMem, jx_x64_operand_t* imm)
+{
+	// NOTE: Bit offsets are always 8-bit immediates.
+	if (mnemonic >= JX64_MNEMONIC_BT && mnemonic <= JX64_MNEMONIC_BTC) {
+		imm[0] = jx64_opImmI8(5);
+		imm[1] = jx64_opImmI8(15);
+		return 2;
+	}
+
+	switch (size) {
+	case JX64_SIZE_8:
+		imm[0] = jx64_opImmI8(0x7F);
+		imm[1] = jx64_opImmI8(-2);
+		break;
+	case JX64_SIZE_16:
+		imm[0] = jx64_opImmI16(0x1234);
+		imm[1] = jx64_opImmI16(-3);
+		break;
+	case JX64_SIZE_32:
+		imm[0] = jx64_opImmI32(0x12345678);
+		imm[1] = jx64_opImmI32(5);
+		break;
+	case JX64_SIZE_64:
+		if (mnemonic != JX64_MNEMONIC_MOV) {
+			imm[0] = jx64_opImmI32(0x12345678);
+			imm[1] = jx64_opImmI32(5);
+		} else if (!isMem) {
+			imm[0] = jx64_opImmI64(0x123456789AB);
+			imm[1] = jx64_opImmI64(-3);
+		} else {
+			imm[0] = jx64_opImmI64(0x12345678);
+			imm[1] = jx64_opImmI64(-3);
+		}
+		break;
+	default:
+		JX_CHECK(false, "Invalid immediate size");
+		return 0;
+	}
+
+	return 2;
+}
+
+static jx_x64_operand_t jx64_disasm_checkGPR(uint32_t id, jx_x64_size size)
+{
+	return jx64_opReg((jx_x64_reg)JX64_REG(id, 0, size));
+}
+
+static jx_x64_operand_t jx64_disasm_checkVecReg(uint32_t id, bool is256)
+{
+	return jx64_opReg((jx_x64_reg)JX64_REG(id, 0, is256 ? JX64_SIZE_256 : JX64_SIZE_128));
+}
+
+static jx_x64_operand_t jx64_disasm_checkMem(uint32_t id, jx_x64_size size)
+{
+	const jx_x64_mem_t* mem = &kCheckMem[id];
+	return jx64_opMem(size, mem->m_Base, mem->m_Index, mem->m_Scale, mem->m_Displacement);
+}
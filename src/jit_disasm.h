@@ -0,0 +1,278 @@
+#ifndef JX_X64_DISASM_H
+#define JX_X64_DISASM_H
+
+#include "jit.h"
+
+typedef struct jx_allocator_i jx_allocator_i;
+typedef struct jx_string_buffer_t jx_string_buffer_t;
+
+// NOTE: Covers (at least) every instruction form the encoder in jit.c can emit.
+typedef enum jx_x64_mnemonic
+{
+	JX64_MNEMONIC_UNKNOWN = 0,
+
+	JX64_MNEMONIC_NOP,
+	JX64_MNEMONIC_RET,
+	JX64_MNEMONIC_INT3,
+	JX64_MNEMONIC_PUSH,
+	JX64_MNEMONIC_POP,
+	JX64_MNEMONIC_MOV,
+	JX64_MNEMONIC_MOVSX,
+	JX64_MNEMONIC_MOVZX,
+	JX64_MNEMONIC_LEA,
+	JX64_MNEMONIC_ADD,
+	JX64_MNEMONIC_OR,
+	JX64_MNEMONIC_ADC,
+	JX64_MNEMONIC_SBB,
+	JX64_MNEMONIC_AND,
+	JX64_MNEMONIC_SUB,
+	JX64_MNEMONIC_XOR,
+	JX64_MNEMONIC_CMP,
+	JX64_MNEMONIC_TEST,
+	JX64_MNEMONIC_NOT,
+	JX64_MNEMONIC_NEG,
+	JX64_MNEMONIC_MUL,
+	JX64_MNEMONIC_IMUL1,
+	JX64_MNEMONIC_DIV,
+	JX64_MNEMONIC_IDIV,
+	JX64_MNEMONIC_INC,
+	JX64_MNEMONIC_DEC,
+	JX64_MNEMONIC_IMUL,
+	JX64_MNEMONIC_IMUL3,
+	JX64_MNEMONIC_ROL,
+	JX64_MNEMONIC_ROR,
+	JX64_MNEMONIC_RCL,
+	JX64_MNEMONIC_RCR,
+	JX64_MNEMONIC_SHL,
+	JX64_MNEMONIC_SHR,
+	JX64_MNEMONIC_SAR,
+	JX64_MNEMONIC_SETCC,
+	JX64_MNEMONIC_CMOVCC,
+	JX64_MNEMONIC_JCC,
+	JX64_MNEMONIC_JMP,
+	JX64_MNEMONIC_CALL,
+	JX64_MNEMONIC_BT,
+	JX64_MNEMONIC_BTS,
+	JX64_MNEMONIC_BTR,
+	JX64_MNEMONIC_BTC,
+	JX64_MNEMONIC_BSF,
+	JX64_MNEMONIC_BSR,
+	JX64_MNEMONIC_POPCNT,
+	JX64_MNEMONIC_LZCNT,
+	JX64_MNEMONIC_TZCNT,
+	JX64_MNEMONIC_BSWAP,
+	JX64_MNEMONIC_STD,
+	JX64_MNEMONIC_CLD,
+	JX64_MNEMONIC_STC,
+	JX64_MNEMONIC_CMC,
+	JX64_MNEMONIC_CLC,
+	JX64_MNEMONIC_CBW,
+	JX64_MNEMONIC_CWDE,
+	JX64_MNEMONIC_CDQE,
+	JX64_MNEMONIC_CWD,
+	JX64_MNEMONIC_CDQ,
+	JX64_MNEMONIC_CQO,
+
+	JX64_MNEMONIC_MOVSS,
+	JX64_MNEMONIC_MOVSD,
+	JX64_MNEMONIC_MOVAPS,
+	JX64_MNEMONIC_MOVAPD,
+	JX64_MNEMONIC_MOVUPS,
+	JX64_MNEMONIC_MOVUPD,
+	JX64_MNEMONIC_MOVD,
+	JX64_MNEMONIC_MOVQ,
+	JX64_MNEMONIC_ADDPS,
+	JX64_MNEMONIC_ADDSS,
+	JX64_MNEMONIC_ADDPD,
+	JX64_MNEMONIC_ADDSD,
+	JX64_MNEMONIC_ANDNPS,
+	JX64_MNEMONIC_ANDNPD,
+	JX64_MNEMONIC_ANDPS,
+	JX64_MNEMONIC_ANDPD,
+	JX64_MNEMONIC_CMPPS,
+	JX64_MNEMONIC_CMPSS,
+	JX64_MNEMONIC_CMPPD,
+	JX64_MNEMONIC_CMPSD,
+	JX64_MNEMONIC_COMISS,
+	JX64_MNEMONIC_COMISD,
+	JX64_MNEMONIC_CVTSI2SS,
+	JX64_MNEMONIC_CVTSI2SD,
+	JX64_MNEMONIC_CVTSS2SI,
+	JX64_MNEMONIC_CVTSD2SI,
+	JX64_MNEMONIC_CVTTSS2SI,
+	JX64_MNEMONIC_CVTTSD2SI,
+	JX64_MNEMONIC_CVTSD2SS,
+	JX64_MNEMONIC_CVTSS2SD,
+	JX64_MNEMONIC_DIVPS,
+	JX64_MNEMONIC_DIVSS,
+	JX64_MNEMONIC_DIVPD,
+	JX64_MNEMONIC_DIVSD,
+	JX64_MNEMONIC_MAXPS,
+	JX64_MNEMONIC_MAXSS,
+	JX64_MNEMONIC_MAXPD,
+	JX64_MNEMONIC_MAXSD,
+	JX64_MNEMONIC_MINPS,
+	JX64_MNEMONIC_MINSS,
+	JX64_MNEMONIC_MINPD,
+	JX64_MNEMONIC_MINSD,
+	JX64_MNEMONIC_MULPS,
+	JX64_MNEMONIC_MULSS,
+	JX64_MNEMONIC_MULPD,
+	JX64_MNEMONIC_MULSD,
+	JX64_MNEMONIC_ORPS,
+	JX64_MNEMONIC_ORPD,
+	JX64_MNEMONIC_RCPPS,
+	JX64_MNEMONIC_RCPSS,
+	JX64_MNEMONIC_RSQRTPS,
+	JX64_MNEMONIC_RSQRTSS,
+	JX64_MNEMONIC_SHUFPS,
+	JX64_MNEMONIC_SHUFPD,
+	JX64_MNEMONIC_SQRTPS,
+	JX64_MNEMONIC_SQRTSS,
+	JX64_MNEMONIC_SQRTPD,
+	JX64_MNEMONIC_SQRTSD,
+	JX64_MNEMONIC_SUBPS,
+	JX64_MNEMONIC_SUBSS,
+	JX64_MNEMONIC_SUBPD,
+	JX64_MNEMONIC_SUBSD,
+	JX64_MNEMONIC_UCOMISS,
+	JX64_MNEMONIC_UCOMISD,
+	JX64_MNEMONIC_UNPCKHPS,
+	JX64_MNEMONIC_UNPCKHPD,
+	JX64_MNEMONIC_UNPCKLPS,
+	JX64_MNEMONIC_UNPCKLPD,
+	JX64_MNEMONIC_XORPS,
+	JX64_MNEMONIC_XORPD,
+	JX64_MNEMONIC_PUNPCKLBW,
+	JX64_MNEMONIC_PUNPCKLWD,
+	JX64_MNEMONIC_PUNPCKLDQ,
+	JX64_MNEMONIC_PUNPCKLQDQ,
+	JX64_MNEMONIC_PUNPCKHBW,
+	JX64_MNEMONIC_PUNPCKHWD,
+	JX64_MNEMONIC_PUNPCKHDQ,
+	JX64_MNEMONIC_PUNPCKHQDQ,
+
+	JX64_MNEMONIC_VZEROUPPER,
+	JX64_MNEMONIC_VMOVSS,
+	JX64_MNEMONIC_VMOVSD,
+	JX64_MNEMONIC_VMOVAPS,
+	JX64_MNEMONIC_VMOVAPD,
+	JX64_MNEMONIC_VMOVUPS,
+	JX64_MNEMONIC_VMOVUPD,
+	JX64_MNEMONIC_VADDPS,
+	JX64_MNEMONIC_VADDSS,
+	JX64_MNEMONIC_VADDPD,
+	JX64_MNEMONIC_VADDSD,
+	JX64_MNEMONIC_VANDNPS,
+	JX64_MNEMONIC_VANDNPD,
+	JX64_MNEMONIC_VANDPS,
+	JX64_MNEMONIC_VANDPD,
+	JX64_MNEMONIC_VCMPPS,
+	JX64_MNEMONIC_VCMPSS,
+	JX64_MNEMONIC_VCMPPD,
+	JX64_MNEMONIC_VCMPSD,
+	JX64_MNEMONIC_VCOMISS,
+	JX64_MNEMONIC_VCOMISD,
+	JX64_MNEMONIC_VCVTSI2SS,
+	JX64_MNEMONIC_VCVTSI2SD,
+	JX64_MNEMONIC_VCVTSS2SI,
+	JX64_MNEMONIC_VCVTSD2SI,
+	JX64_MNEMONIC_VCVTTSS2SI,
+	JX64_MNEMONIC_VCVTTSD2SI,
+	JX64_MNEMONIC_VCVTSD2SS,
+	JX64_MNEMONIC_VCVTSS2SD,
+	JX64_MNEMONIC_VDIVPS,
+	JX64_MNEMONIC_VDIVSS,
+	JX64_MNEMONIC_VDIVPD,
+	JX64_MNEMONIC_VDIVSD,
+	JX64_MNEMONIC_VMAXPS,
+	JX64_MNEMONIC_VMAXSS,
+	JX64_MNEMONIC_VMAXPD,
+	JX64_MNEMONIC_VMAXSD,
+	JX64_MNEMONIC_VMINPS,
+	JX64_MNEMONIC_VMINSS,
+	JX64_MNEMONIC_VMINPD,
+	JX64_MNEMONIC_VMINSD,
+	JX64_MNEMONIC_VMULPS,
+	JX64_MNEMONIC_VMULSS,
+	JX64_MNEMONIC_VMULPD,
+	JX64_MNEMONIC_VMULSD,
+	JX64_MNEMONIC_VORPS,
+	JX64_MNEMONIC_VORPD,
+	JX64_MNEMONIC_VRCPPS,
+	JX64_MNEMONIC_VRCPSS,
+	JX64_MNEMONIC_VRSQRTPS,
+	JX64_MNEMONIC_VRSQRTSS,
+	JX64_MNEMONIC_VSHUFPS,
+	JX64_MNEMONIC_VSHUFPD,
+	JX64_MNEMONIC_VSQRTPS,
+	JX64_MNEMONIC_VSQRTSS,
+	JX64_MNEMONIC_VSQRTPD,
+	JX64_MNEMONIC_VSQRTSD,
+	JX64_MNEMONIC_VSUBPS,
+	JX64_MNEMONIC_VSUBSS,
+	JX64_MNEMONIC_VSUBPD,
+	JX64_MNEMONIC_VSUBSD,
+	JX64_MNEMONIC_VUCOMISS,
+	JX64_MNEMONIC_VUCOMISD,
+	JX64_MNEMONIC_VUNPCKHPS,
+	JX64_MNEMONIC_VUNPCKHPD,
+	JX64_MNEMONIC_VUNPCKLPS,
+	JX64_MNEMONIC_VUNPCKLPD,
+	JX64_MNEMONIC_VXORPS,
+	JX64_MNEMONIC_VXORPD,
+	JX64_MNEMONIC_VPUNPCKLBW,
+	JX64_MNEMONIC_VPUNPCKLWD,
+	JX64_MNEMONIC_VPUNPCKLDQ,
+	JX64_MNEMONIC_VPUNPCKLQDQ,
+	JX64_MNEMONIC_VPUNPCKHBW,
+	JX64_MNEMONIC_VPUNPCKHWD,
+	JX64_MNEMONIC_VPUNPCKHDQ,
+	JX64_MNEMONIC_VPUNPCKHQDQ,
+	JX64_MNEMONIC_VFMADD213PS,
+	JX64_MNEMONIC_VFMADD213SS,
+	JX64_MNEMONIC_VFMADD213PD,
+	JX64_MNEMONIC_VFMADD213SD,
+	JX64_MNEMONIC_VFMADD231PS,
+	JX64_MNEMONIC_VFMADD231SS,
+	JX64_MNEMONIC_VFMADD231PD,
+	JX64_MNEMONIC_VFMADD231SD,
+
+	JX64_MNEMONIC_COUNT
+} jx_x64_mnemonic;
+
+// A decoded instruction. Operands are in Intel order, using the same conventions as the
+// jx64_* emitters (e.g. imul3 has 3 operands, VEX scalar reg-reg moves have 3). Branch
+// targets are IMM operands holding the displacement relative to the end of the instruction.
+// RIP-relative memory operands use JX64_REG_RIP as base and the raw displacement.
+typedef struct jx_x64_disasm_instr_t
+{
+	jx_x64_mnemonic m_Mnemonic;
+	jx_x64_condition_code m_CC; // setcc, cmovcc and jcc only
+	jx_x64_operand_t m_Operands[4];
+	uint32_t m_NumOperands;
+	uint32_t m_Size;
+	uint32_t m_RelOffset; // Offset of the rel32/disp32 field which might be the target of a relocation (0 if none).
+	JX_PAD(4);
+} jx_x64_disasm_instr_t;
+
+// Decodes the instruction at the start of code. Returns false if the bytes don't form an
+// instruction known to the disassembler.
+bool jx64_disasmDecode(const uint8_t* code, uint32_t size, jx_x64_disasm_instr_t* instr);
+
+// Prints the instruction in Intel syntax. offset is the position of the instruction in the
+// code and is used to print absolute branch targets.
+void jx64_disasmInstrPrint(const jx_x64_disasm_instr_t* instr, uint32_t offset, jx_string_buffer_t* sb);
+
+// Prints an annotated listing of a function's code: byte offsets, instruction bytes, Intel
+// syntax, .L<n> labels for branch targets inside the function and symbol names for operands
+// with relocations (offsets relative to the start of code). Bytes which cannot be decoded
+// are printed as db.
+void jx64_disasmPrint(jx_allocator_i* allocator, const uint8_t* code, uint32_t size, const jx_x64_relocation_t* relocArr, uint32_t numRelocs, jx_string_buffer_t* sb);
+
+// Round-trip test of the encoder and the disassembler. Emits every form of every jx64_*
+// instruction, disassembles it and re-encodes the result, expecting identical bytes and
+// operands. Mismatches are appended to log. Returns true if all instructions passed.
+bool jx64_disasmSelfCheck(jx_allocator_i* allocator, jx_string_buffer_t* log);
+
+#endif // JX_X64_DISASM_H
@@ -0,0 +1,90 @@
+#ifndef JX_X64_ELF_H
+#define JX_X64_ELF_H
+
+#include <stdint.h>
+
+// ELF64 definitions used to describe x64 code to external tools (debuggers, linkers).
+#define JX_ELF_CLASS64      2
+#define JX_ELF_DATA2LSB     1
+#define JX_ELF_VERSION      1
+#define JX_ELF_ET_REL       1
+#define JX_ELF_EM_X86_64    62
+
+#define JX_ELF_SHT_PROGBITS 1
+#define JX_ELF_SHT_SYMTAB   2
+#define JX_ELF_SHT_STRTAB   3
+#define JX_ELF_SHT_RELA     4
+#define JX_ELF_SHT_NOBITS   8
+
+#define JX_ELF_SHF_WRITE     0x01
+#define JX_ELF_SHF_ALLOC     0x02
+#define JX_ELF_SHF_EXECINSTR 0x04
+#define JX_ELF_SHF_INFO_LINK 0x40
+
+#define JX_ELF_SHN_UNDEF 0x0000
+#define JX_ELF_SHN_ABS   0xFFF1
+
+#define JX_ELF_STB_LOCAL  0
+#define JX_ELF_STB_GLOBAL 1
+#define JX_ELF_STT_NOTYPE 0
+#define JX_ELF_STT_OBJECT 1
+#define JX_ELF_STT_FUNC   2
+#define JX_ELF_STT_FILE   4
+#define JX_ELF_ST_INFO(bind, type) (uint8_t)(((bind) << 4) | ((type) & 0x0F))
+
+#define JX_ELF_R_X86_64_64       1 // S + A
+#define JX_ELF_R_X86_64_PC32     2 // S + A - P
+#define JX_ELF_R_X86_64_PLT32    4 // L + A - P
+#define JX_ELF_R_X86_64_GOTPCREL 9 // G + GOT + A - P
+#define JX_ELF_R_INFO(sym, type) (((uint64_t)(sym) << 32) | (uint64_t)(type))
+
+typedef struct jx_elf64_header_t
+{
+	uint8_t m_Ident[16];
+	uint16_t m_Type;
+	uint16_t m_Machine;
+	uint32_t m_Version;
+	uint64_t m_Entry;
+	uint64_t m_ProgramHeaderOffset;
+	uint64_t m_SectionHeaderOffset;
+	uint32_t m_Flags;
+	uint16_t m_HeaderSize;
+	uint16_t m_ProgramHeaderEntrySize;
+	uint16_t m_NumProgramHeaders;
+	uint16_t m_SectionHeaderEntrySize;
+	uint16_t m_NumSectionHeaders;
+	uint16_t m_SectionNameStringTableIndex;
+} jx_elf64_header_t;
+
+typedef struct jx_elf64_section_header_t
+{
+	uint32_t m_Name;
+	uint32_t m_Type;
+	uint64_t m_Flags;
+	uint64_t m_Addr;
+	uint64_t m_Offset;
+	uint64_t m_Size;
+	uint32_t m_Link;
+	uint32_t m_Info;
+	uint64_t m_AddrAlign;
+	uint64_t m_EntrySize;
+} jx_elf64_section_header_t;
+
+typedef struct jx_elf64_symbol_t
+{
+	uint32_t m_Name;
+	uint8_t m_Info;
+	uint8_t m_Other;
+	uint16_t m_SectionIndex;
+	uint64_t m_Value;
+	uint64_t m_Size;
+} jx_elf64_symbol_t;
+
+typedef struct jx_elf64_rela_t
+{
+	uint64_t m_Offset;
+	uint64_t m_Info;
+	int64_t m_Addend;
+} jx_elf64_rela_t;
+
+#endif // JX_X64_ELF_H
@@ -8,11 +8,20 @@
 #include <jlib/memory.h>
 #include <jlib/string.h>
 
+#define JX64GEN_DEFAULT_FUNC_ALIGNMENT   16
+#define JX64GEN_DEFAULT_LOOP_ALIGNMENT   32 // Instruction fetch/decoded uop cache window
+#define JX64GEN_DEFAULT_LOOP_MAX_PADDING 15
+#define JX64GEN_AVG_INSTR_SIZE           4  // Used to estimate the size of a loop before it's emitted
+#define JX64GEN_LOOP_MAX_WINDOWS         4  // Loops spanning more fetch windows gain nothing from alignment
+
 typedef bool (*jx64VoidFunc)(jx_x64_context_t* ctx);
 typedef bool (*jx64UnaryFunc)(jx_x64_context_t* ctx, jx_x64_operand_t op);
 typedef bool (*jx64BinaryFunc)(jx_x64_context_t* ctx, jx_x64_operand_t op1, jx_x64_operand_t op2);
 typedef bool (*jx64TernaryFunc)(jx_x64_context_t* ctx, jx_x64_operand_t op1, jx_x64_operand_t op2, jx_x64_operand_t op3);
+typedef bool (*jx64BinaryImm8Func)(jx_x64_context_t* ctx, jx_x64_operand_t op1, jx_x64_operand_t op2, uint8_t imm8);
+typedef bool (*jx64TernaryImm8Func)(jx_x64_context_t* ctx, jx_x64_operand_t op1, jx_x64_operand_t op2, jx_x64_operand_t op3, uint8_t imm8);
 typedef bool (*jx64CondFunc)(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t op);
+typedef bool (*jx64CondBinaryFunc)(jx_x64_context_t* ctx, jx_x64_condition_code cc, jx_x64_operand_t op1, jx_x64_operand_t op2);
 
 typedef enum jx64gen_instr_kind
 {
@@ -22,6 +31,10 @@ typedef enum jx64gen_instr_kind
 	JX64GEN_INSTR_BINARY = 3,
 	JX64GEN_INSTR_TERNARY = 4,
 	JX64GEN_INSTR_COND = 5,
+	JX64GEN_INSTR_BINARY_IMM8 = 6,
+	JX64GEN_INSTR_COND_BINARY = 7,
+	JX64GEN_INSTR_VEX_BINARY = 8,      // 2-address MIR instruction emitted as 3-operand VEX instruction (dst, dst, src)
+	JX64GEN_INSTR_VEX_BINARY_IMM8 = 9, // Same as above with an 8-bit immediate
 } jx64gen_instr_kind;
 
 typedef struct jx64gen_instr_desc_t
@@ -34,12 +47,20 @@ typedef struct jx64gen_instr_desc_t
 		jx64UnaryFunc m_UnaryFunc;
 		jx64BinaryFunc m_BinaryFunc;
 		jx64TernaryFunc m_TernaryFunc;
+		jx64BinaryImm8Func m_BinaryImm8Func;
+		jx64TernaryImm8Func m_TernaryImm8Func;
 		struct
 		{
 			jx64CondFunc m_Func;
 			uint32_t m_Code;
 			JX_PAD(4);
 		} m_Cond;
+		struct
+		{
+			jx64CondBinaryFunc m_Func;
+			uint32_t m_Code;
+			JX_PAD(4);
+		} m_CondBinary;
 	} u;
 } jx64gen_instr_desc_t;
 
@@ -54,7 +75,9 @@ static const jx64gen_instr_desc_t kInstrDesc[] = {
 	[JMIR_OP_IMUL]       = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_imul },
 	[JMIR_OP_IMUL3]      = { .m_Kind = JX64GEN_INSTR_TERNARY, .u.m_TernaryFunc = jx64_imul3 },
 	[JMIR_OP_IDIV]       = { .m_Kind = JX64GEN_INSTR_UNARY,   .u.m_UnaryFunc = jx64_idiv },
-	[JMIR_OP_DIV]        = { .m_Kind = JX64GEN_INSTR_UNARY,   .u.m_UnaryFunc = jx64_idiv },
+	[JMIR_OP_DIV]        = { .m_Kind = JX64GEN_INSTR_UNARY,   .u.m_UnaryFunc = jx64_div },
+	[JMIR_OP_IMUL1]      = { .m_Kind = JX64GEN_INSTR_UNARY,   .u.m_UnaryFunc = jx64_imul1 },
+	[JMIR_OP_MUL]        = { .m_Kind = JX64GEN_INSTR_UNARY,   .u.m_UnaryFunc = jx64_mul },
 	[JMIR_OP_ADD]        = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_add },
 	[JMIR_OP_SUB]        = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_sub },
 	[JMIR_OP_LEA]        = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_lea },
@@ -64,7 +87,16 @@ static const jx64gen_instr_desc_t kInstrDesc[] = {
 	[JMIR_OP_SAR]        = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_sar },
 	[JMIR_OP_SHR]        = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_shr },
 	[JMIR_OP_SHL]        = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_shl },
+	[JMIR_OP_ROL]        = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_rol },
+	[JMIR_OP_ROR]        = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_ror },
+	[JMIR_OP_BSWAP]      = { .m_Kind = JX64GEN_INSTR_UNARY,   .u.m_UnaryFunc = jx64_bswap },
+	[JMIR_OP_BSF]        = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_bsf },
+	[JMIR_OP_BSR]        = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_bsr },
+	[JMIR_OP_POPCNT]     = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_popcnt },
+	[JMIR_OP_LZCNT]      = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_lzcnt },
+	[JMIR_OP_TZCNT]      = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_tzcnt },
 	[JMIR_OP_CALL]       = { .m_Kind = JX64GEN_INSTR_UNARY,   .u.m_UnaryFunc = jx64_call },
+	[JMIR_OP_TAILCALL]   = { .m_Kind = JX64GEN_INSTR_UNARY,   .u.m_UnaryFunc = jx64_jmp },
 	[JMIR_OP_PUSH]       = { .m_Kind = JX64GEN_INSTR_UNARY,   .u.m_UnaryFunc = jx64_push },
 	[JMIR_OP_POP]        = { .m_Kind = JX64GEN_INSTR_UNARY,   .u.m_UnaryFunc = jx64_pop },
 	[JMIR_OP_CDQ]        = { .m_Kind = JX64GEN_INSTR_VOID,    .u.m_VoidFunc = jx64_cdq },
@@ -102,10 +134,28 @@ static const jx64gen_instr_desc_t kInstrDesc[] = {
 	[JMIR_OP_JNL]        = { .m_Kind = JX64GEN_INSTR_COND,    .u.m_Cond.m_Func = jx64_jcc, .u.m_Cond.m_Code = JMIR_CC_NL },
 	[JMIR_OP_JLE]        = { .m_Kind = JX64GEN_INSTR_COND,    .u.m_Cond.m_Func = jx64_jcc, .u.m_Cond.m_Code = JMIR_CC_LE },
 	[JMIR_OP_JNLE]       = { .m_Kind = JX64GEN_INSTR_COND,    .u.m_Cond.m_Func = jx64_jcc, .u.m_Cond.m_Code = JMIR_CC_NLE },
+	[JMIR_OP_CMOVO]      = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_O },
+	[JMIR_OP_CMOVNO]     = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_NO },
+	[JMIR_OP_CMOVB]      = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_B },
+	[JMIR_OP_CMOVNB]     = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_NB },
+	[JMIR_OP_CMOVE]      = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_E },
+	[JMIR_OP_CMOVNE]     = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_NE },
+	[JMIR_OP_CMOVBE]     = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_BE },
+	[JMIR_OP_CMOVNBE]    = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_NBE },
+	[JMIR_OP_CMOVS]      = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_S },
+	[JMIR_OP_CMOVNS]     = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_NS },
+	[JMIR_OP_CMOVP]      = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_P },
+	[JMIR_OP_CMOVNP]     = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_NP },
+	[JMIR_OP_CMOVL]      = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_L },
+	[JMIR_OP_CMOVNL]     = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_NL },
+	[JMIR_OP_CMOVLE]     = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_LE },
+	[JMIR_OP_CMOVNLE]    = { .m_Kind = JX64GEN_INSTR_COND_BINARY, .u.m_CondBinary.m_Func = jx64_cmovcc, .u.m_CondBinary.m_Code = JMIR_CC_NLE },
 	[JMIR_OP_MOVSS]      = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_movss },
 	[JMIR_OP_MOVSD]      = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_movsd },
 	[JMIR_OP_MOVAPS]     = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_movaps },
 	[JMIR_OP_MOVAPD]     = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_movapd },
+	[JMIR_OP_MOVUPS]     = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_movups },
+	[JMIR_OP_MOVUPD]     = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_movupd },
 	[JMIR_OP_MOVD]       = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_movd },
 	[JMIR_OP_MOVQ]       = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_movq },
 	[JMIR_OP_ADDPS]      = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_addps },
@@ -148,6 +198,8 @@ static const jx64gen_instr_desc_t kInstrDesc[] = {
 	[JMIR_OP_RCPSS]      = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_rcpss },
 	[JMIR_OP_RSQRTPS]    = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_rsqrtps },
 	[JMIR_OP_RSQRTSS]    = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_rsqrtss },
+	[JMIR_OP_SHUFPS]     = { .m_Kind = JX64GEN_INSTR_BINARY_IMM8, .u.m_BinaryImm8Func = jx64_shufps },
+	[JMIR_OP_SHUFPD]     = { .m_Kind = JX64GEN_INSTR_BINARY_IMM8, .u.m_BinaryImm8Func = jx64_shufpd },
 	[JMIR_OP_SQRTPS]     = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_sqrtps },
 	[JMIR_OP_SQRTSS]     = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_sqrtss },
 	[JMIR_OP_SQRTPD]     = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_sqrtpd },
@@ -174,6 +226,84 @@ static const jx64gen_instr_desc_t kInstrDesc[] = {
 	[JMIR_OP_PUNPCKHQDQ] = { .m_Kind = JX64GEN_INSTR_BINARY,  .u.m_BinaryFunc = jx64_punpckhqdq },
 };
 
+// NOTE: VEX-encoded replacements for the SSE entries of kInstrDesc, used when the host supports AVX.
+// Opcodes without an entry here (e.g. MOVD/MOVQ) fall back to the legacy encoding. Mixing legacy SSE
+// and VEX.128 instructions is free as long as the upper halves of the YMM registers are clean.
+static const jx64gen_instr_desc_t kInstrDescAVX[] = {
+	[JMIR_OP_MOVSS]      = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vmovss },
+	[JMIR_OP_MOVSD]      = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vmovsd },
+	[JMIR_OP_MOVAPS]     = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vmovaps },
+	[JMIR_OP_MOVAPD]     = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vmovapd },
+	[JMIR_OP_MOVUPS]     = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vmovups },
+	[JMIR_OP_MOVUPD]     = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vmovupd },
+	[JMIR_OP_ADDPS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vaddps },
+	[JMIR_OP_ADDSS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vaddss },
+	[JMIR_OP_ADDPD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vaddpd },
+	[JMIR_OP_ADDSD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vaddsd },
+	[JMIR_OP_ANDNPS]     = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vandnps },
+	[JMIR_OP_ANDNPD]     = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vandnpd },
+	[JMIR_OP_ANDPS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vandps },
+	[JMIR_OP_ANDPD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vandpd },
+	[JMIR_OP_COMISS]     = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vcomiss },
+	[JMIR_OP_COMISD]     = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vcomisd },
+	[JMIR_OP_CVTSI2SS]   = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vcvtsi2ss },
+	[JMIR_OP_CVTSI2SD]   = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vcvtsi2sd },
+	[JMIR_OP_CVTSS2SI]   = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vcvtss2si },
+	[JMIR_OP_CVTSD2SI]   = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vcvtsd2si },
+	[JMIR_OP_CVTTSS2SI]  = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vcvttss2si },
+	[JMIR_OP_CVTTSD2SI]  = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vcvttsd2si },
+	[JMIR_OP_CVTSD2SS]   = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vcvtsd2ss },
+	[JMIR_OP_CVTSS2SD]   = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vcvtss2sd },
+	[JMIR_OP_DIVPS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vdivps },
+	[JMIR_OP_DIVSS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vdivss },
+	[JMIR_OP_DIVPD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vdivpd },
+	[JMIR_OP_DIVSD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vdivsd },
+	[JMIR_OP_MAXPS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vmaxps },
+	[JMIR_OP_MAXSS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vmaxss },
+	[JMIR_OP_MAXPD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vmaxpd },
+	[JMIR_OP_MAXSD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vmaxsd },
+	[JMIR_OP_MINPS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vminps },
+	[JMIR_OP_MINSS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vminss },
+	[JMIR_OP_MINPD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vminpd },
+	[JMIR_OP_MINSD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vminsd },
+	[JMIR_OP_MULPS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vmulps },
+	[JMIR_OP_MULSS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vmulss },
+	[JMIR_OP_MULPD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vmulpd },
+	[JMIR_OP_MULSD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vmulsd },
+	[JMIR_OP_ORPS]       = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vorps },
+	[JMIR_OP_ORPD]       = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vorpd },
+	[JMIR_OP_RCPPS]      = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vrcpps },
+	[JMIR_OP_RCPSS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vrcpss },
+	[JMIR_OP_RSQRTPS]    = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vrsqrtps },
+	[JMIR_OP_RSQRTSS]    = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vrsqrtss },
+	[JMIR_OP_SHUFPS]     = { .m_Kind = JX64GEN_INSTR_VEX_BINARY_IMM8, .u.m_TernaryImm8Func = jx64_vshufps },
+	[JMIR_OP_SHUFPD]     = { .m_Kind = JX64GEN_INSTR_VEX_BINARY_IMM8, .u.m_TernaryImm8Func = jx64_vshufpd },
+	[JMIR_OP_SQRTPS]     = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vsqrtps },
+	[JMIR_OP_SQRTSS]     = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vsqrtss },
+	[JMIR_OP_SQRTPD]     = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vsqrtpd },
+	[JMIR_OP_SQRTSD]     = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vsqrtsd },
+	[JMIR_OP_SUBPS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vsubps },
+	[JMIR_OP_SUBSS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vsubss },
+	[JMIR_OP_SUBPD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vsubpd },
+	[JMIR_OP_SUBSD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vsubsd },
+	[JMIR_OP_UCOMISS]    = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vucomiss },
+	[JMIR_OP_UCOMISD]    = { .m_Kind = JX64GEN_INSTR_BINARY,          .u.m_BinaryFunc = jx64_vucomisd },
+	[JMIR_OP_UNPCKHPS]   = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vunpckhps },
+	[JMIR_OP_UNPCKHPD]   = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vunpckhpd },
+	[JMIR_OP_UNPCKLPS]   = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vunpcklps },
+	[JMIR_OP_UNPCKLPD]   = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vunpcklpd },
+	[JMIR_OP_XORPS]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vxorps },
+	[JMIR_OP_XORPD]      = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vxorpd },
+	[JMIR_OP_PUNPCKLBW]  = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vpunpcklbw },
+	[JMIR_OP_PUNPCKLWD]  = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vpunpcklwd },
+	[JMIR_OP_PUNPCKLDQ]  = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vpunpckldq },
+	[JMIR_OP_PUNPCKLQDQ] = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vpunpcklqdq },
+	[JMIR_OP_PUNPCKHBW]  = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vpunpckhbw },
+	[JMIR_OP_PUNPCKHWD]  = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vpunpckhwd },
+	[JMIR_OP_PUNPCKHDQ]  = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vpunpckhdq },
+	[JMIR_OP_PUNPCKHQDQ] = { .m_Kind = JX64GEN_INSTR_VEX_BINARY,      .u.m_TernaryFunc = jx64_vpunpckhqdq },
+};
+
 typedef struct jx_x64gen_context_t
 {
 	jx_allocator_i* m_Allocator;
@@ -182,8 +312,13 @@ typedef struct jx_x64gen_context_t
 	jx_x64_symbol_t** m_GlobalVars;
 	jx_x64_symbol_t** m_Funcs;
 	jx_x64_label_t** m_BasicBlocks;
+	uint32_t* m_LoopSizeArr; // Estimated size of the loop headed by each basic block; 0 if the block should not be aligned.
 	jx64GetExternalSymbolAddrCallback m_ExternalSymCallback;
 	void* m_ExternalSymCallbackUserData;
+	uint32_t m_FuncAlignment;
+	uint32_t m_LoopAlignment;
+	uint32_t m_LoopMaxPadding;
+	JX_PAD(4);
 } jx_x64gen_context_t;
 
 static jx_x64_operand_t jx_x64gen_convertMIROperand(jx_x64gen_context_t* ctx, const jx_mir_operand_t* mirOp);
@@ -191,6 +326,12 @@ static jx_x64_size jx_x64gen_convertMIRTypeToSize(jx_mir_type_kind type);
 static jx_x64_reg jx_x64gen_convertMIRReg(jx_mir_reg_t mirReg, jx_x64_size sz);
 static jx_x64_scale jx_x64gen_convertMIRScale(uint32_t mirScale);
 static void jx_x64gen_setExternalSymbol(jx_x64_context_t* ctx, const char* name, void* addr);
+static const jx64gen_instr_desc_t* jx_x64gen_getInstrDesc(uint32_t opcode, bool useAVX);
+static bool jx_x64gen_emitFusedMoveVEX(jx_x64gen_context_t* ctx, const jx_mir_instruction_t* movInstr);
+static void jx_x64gen_findAlignedLoops(jx_x64gen_context_t* ctx, jx_mir_scc_t* sccList);
+static bool jx_x64gen_sccIsLoop(const jx_mir_scc_t* scc);
+static void jx_x64gen_alignLoopHeader(jx_x64gen_context_t* ctx, uint32_t loopSize);
+static void jx_x64gen_emitUnwindOp(jx_x64gen_context_t* ctx, const jx_mir_frame_event_t* event);
 
 jx_x64gen_context_t* jx_x64gen_createContext(jx_x64_context_t* jitCtx, jx_mir_context_t* mirCtx, jx64GetExternalSymbolAddrCallback externalSymCb, void* userData, jx_allocator_i* allocator)
 {
@@ -205,6 +346,9 @@ jx_x64gen_context_t* jx_x64gen_createContext(jx_x64_context_t* jitCtx, jx_mir_co
 	ctx->m_MIRCtx = mirCtx;
 	ctx->m_ExternalSymCallback = externalSymCb;
 	ctx->m_ExternalSymCallbackUserData = userData;
+	ctx->m_FuncAlignment = JX64GEN_DEFAULT_FUNC_ALIGNMENT;
+	ctx->m_LoopAlignment = JX64GEN_DEFAULT_LOOP_ALIGNMENT;
+	ctx->m_LoopMaxPadding = JX64GEN_DEFAULT_LOOP_MAX_PADDING;
 	ctx->m_GlobalVars = (jx_x64_symbol_t**)jx_array_create(allocator);
 	if (!ctx->m_GlobalVars) {
 		jx_x64gen_destroyContext(ctx);
@@ -223,11 +367,22 @@ jx_x64gen_context_t* jx_x64gen_createContext(jx_x64_context_t* jitCtx, jx_mir_co
 		return NULL;
 	}
 
+	ctx->m_LoopSizeArr = (uint32_t*)jx_array_create(allocator);
+	if (!ctx->m_LoopSizeArr) {
+		jx_x64gen_destroyContext(ctx);
+		return NULL;
+	}
+
 	return ctx;
 }
 
 void jx_x64gen_destroyContext(jx_x64gen_context_t* ctx)
 {
+	if (ctx->m_LoopSizeArr) {
+		jx_array_free(ctx->m_LoopSizeArr);
+		ctx->m_LoopSizeArr = NULL;
+	}
+
 	if (ctx->m_BasicBlocks) {
 		jx_array_free(ctx->m_BasicBlocks);
 		ctx->m_BasicBlocks = NULL;
@@ -246,7 +401,24 @@ void jx_x64gen_destroyContext(jx_x64gen_context_t* ctx)
 	JX_FREE(ctx->m_Allocator, ctx);
 }
 
+void jx_x64gen_setCodeAlignment(jx_x64gen_context_t* ctx, uint32_t funcAlignment, uint32_t loopAlignment, uint32_t loopMaxPadding)
+{
+	JX_CHECK((funcAlignment & (funcAlignment - 1)) == 0, "Function alignment must be a power of 2.");
+	JX_CHECK((loopAlignment & (loopAlignment - 1)) == 0, "Loop alignment must be a power of 2.");
+	ctx->m_FuncAlignment = funcAlignment;
+	ctx->m_LoopAlignment = loopAlignment;
+	ctx->m_LoopMaxPadding = loopMaxPadding;
+}
+
 bool jx_x64gen_codeGen(jx_x64gen_context_t* ctx)
+{
+	return true
+		&& jx_x64gen_emitCode(ctx)
+		&& jx64_finalize(ctx->m_JITCtx, ctx->m_ExternalSymCallback, ctx->m_ExternalSymCallbackUserData)
+		;
+}
+
+bool jx_x64gen_emitCode(jx_x64gen_context_t* ctx)
 {
 	jx_mir_context_t* mirCtx = ctx->m_MIRCtx;
 	jx_x64_context_t* jitCtx = ctx->m_JITCtx;
@@ -255,6 +427,9 @@ bool jx_x64gen_codeGen(jx_x64gen_context_t* ctx)
 	jx_array_resize(ctx->m_Funcs, 0);
 	jx_array_resize(ctx->m_BasicBlocks, 0);
 
+	// Select instruction encodings based on the host CPU (see jx_mir_createContext()).
+	const bool useAVX = (jx_mir_getFlags(mirCtx) & JMIR_CONTEXT_FLAGS_TARGET_AVX_Msk) != 0;
+
 	// Declare global variables.
 	const uint32_t numGlobalVars = jx_mir_getNumGlobalVars(mirCtx);
 	for (uint32_t iGV = 0; iGV < numGlobalVars; ++iGV) {
@@ -264,6 +439,10 @@ bool jx_x64gen_codeGen(jx_x64gen_context_t* ctx)
 			return false;
 		}
 
+		if ((mirGV->m_Flags & JMIR_GLOBAL_VAR_FLAGS_INTERNAL_Msk) != 0) {
+			gv->m_Flags |= JX64_SYMBOL_FLAGS_LOCAL_Msk;
+		}
+
 		jx_array_push_back(ctx->m_GlobalVars, gv);
 	}
 
@@ -276,6 +455,10 @@ bool jx_x64gen_codeGen(jx_x64gen_context_t* ctx)
 			return false;
 		}
 
+		if ((mirFunc->m_Flags & JMIR_FUNC_FLAGS_INTERNAL_Msk) != 0) {
+			func->m_Flags |= JX64_SYMBOL_FLAGS_LOCAL_Msk;
+		}
+
 		jx_array_push_back(ctx->m_Funcs, func);
 	}
 
@@ -294,16 +477,90 @@ bool jx_x64gen_codeGen(jx_x64gen_context_t* ctx)
 				jx_array_push_back(ctx->m_BasicBlocks, lbl);
 			}
 
+			const bool alignLoops = true
+				&& ctx->m_LoopAlignment > 1
+				&& jx_mir_funcUpdateSCCs(mirCtx, mirFunc)
+				;
+			if (alignLoops) {
+				jx_array_resize(ctx->m_LoopSizeArr, numBasicBlocks);
+				jx_memset(ctx->m_LoopSizeArr, 0, sizeof(uint32_t) * numBasicBlocks);
+				jx_x64gen_findAlignedLoops(ctx, mirFunc->m_SCCListHead);
+			}
+
+			// Callee-saved registers stored outside the entry block (shrink-wrapping) are only
+			// saved in blocks dominated by the save block. Code for those blocks gets its own 
+			// unwind regions.
+			const jx_mir_frame_info_t* frameInfo = mirFunc->m_FrameInfo;
+			const jx_mir_frame_event_t* frameEventArr = frameInfo->m_EventArr;
+			const uint32_t numFrameEvents = (uint32_t)jx_array_sizeu(frameEventArr);
+			jx_mir_basic_block_t* saveBB = frameInfo->m_SaveBB;
+			const bool hasSaveRegions = true
+				&& saveBB
+				&& saveBB != mirFunc->m_BasicBlockListHead
+				;
+			const bool emitUnwindInfo = false
+				|| !hasSaveRegions
+				|| jx_mir_funcUpdateDomTree(mirCtx, mirFunc)
+				;
+			uint32_t nextFrameEvent = emitUnwindInfo
+				? 0
+				: numFrameEvents
+				;
+			bool regsSaved = false;
+
+			if (ctx->m_FuncAlignment > 1) {
+				jx64_alignText(jitCtx, ctx->m_FuncAlignment);
+			}
+
+			ctx->m_Funcs[iFunc]->m_Fingerprint = mirFunc->m_Fingerprint;
 			jx64_funcBegin(jitCtx, ctx->m_Funcs[iFunc]);
 
 			jx_mir_basic_block_t* mirBB = mirFunc->m_BasicBlockListHead;
 			while (mirBB) {
+				if (alignLoops && ctx->m_LoopSizeArr[mirBB->m_ID] != 0) {
+					jx_x64gen_alignLoopHeader(ctx, ctx->m_LoopSizeArr[mirBB->m_ID]);
+				}
+
+				if (emitUnwindInfo && hasSaveRegions) {
+					const bool bbRegsSaved = jx_mir_bbDominates(mirCtx, saveBB, mirBB);
+					if (bbRegsSaved != regsSaved || mirBB == saveBB) {
+						jx64_unwindBeginRegion(jitCtx);
+
+						// NOTE: The save block records the saves as they are emitted. Other blocks 
+						// start with the registers already saved.
+						if (bbRegsSaved && mirBB != saveBB) {
+							for (uint32_t iEvent = 0; iEvent < numFrameEvents; ++iEvent) {
+								const jx_mir_frame_event_t* event = &frameEventArr[iEvent];
+								if (event->m_Instr->m_ParentBB == saveBB) {
+									jx_x64gen_emitUnwindOp(ctx, event);
+								}
+							}
+						}
+
+						regsSaved = bbRegsSaved;
+					}
+				}
+
 				jx64_labelBind(jitCtx, ctx->m_BasicBlocks[mirBB->m_ID]);
 
 				jx_mir_instruction_t* mirInstr = mirBB->m_InstrListHead;
 				while (mirInstr) {
-					JX_CHECK(mirInstr->m_OpCode < JX_COUNTOF(kInstrDesc), "Unknown opcode!");
-					const jx64gen_instr_desc_t* desc = &kInstrDesc[mirInstr->m_OpCode];
+					if (useAVX && jx_x64gen_emitFusedMoveVEX(ctx, mirInstr)) {
+						mirInstr = mirInstr->m_Next->m_Next;
+						continue;
+					}
+
+					const bool isCall = false
+						|| mirInstr->m_OpCode == JMIR_OP_CALL
+						|| mirInstr->m_OpCode == JMIR_OP_TAILCALL
+						|| mirInstr->m_OpCode == JMIR_OP_RET
+						;
+					if (isCall && jx64_isUpperYMMDirty(jitCtx)) {
+						// NOTE: Avoid AVX-SSE transition penalties in callees/callers which use legacy SSE encodings.
+						jx64_vzeroupper(jitCtx);
+					}
+
+					const jx64gen_instr_desc_t* desc = jx_x64gen_getInstrDesc(mirInstr->m_OpCode, useAVX);
 					switch (desc->m_Kind) {
 					case JX64GEN_INSTR_VOID: {
 						if (!desc->u.m_VoidFunc(jitCtx)) {
@@ -331,17 +588,54 @@ bool jx_x64gen_codeGen(jx_x64gen_context_t* ctx)
 							JX_CHECK(false, "Failed to emit instruction.");
 						}
 					} break;
+					case JX64GEN_INSTR_BINARY_IMM8: {
+						jx_x64_operand_t op1 = jx_x64gen_convertMIROperand(ctx, mirInstr->m_Operands[0]);
+						jx_x64_operand_t op2 = jx_x64gen_convertMIROperand(ctx, mirInstr->m_Operands[1]);
+						JX_CHECK(mirInstr->m_Operands[2]->m_Kind == JMIR_OPERAND_CONST, "Expected constant operand.");
+						const uint8_t imm8 = (uint8_t)mirInstr->m_Operands[2]->u.m_ConstI64;
+						if (!desc->u.m_BinaryImm8Func(jitCtx, op1, op2, imm8)) {
+							JX_CHECK(false, "Failed to emit instruction.");
+						}
+					} break;
 					case JX64GEN_INSTR_COND: {
 						jx_x64_operand_t op = jx_x64gen_convertMIROperand(ctx, mirInstr->m_Operands[0]);
 						if (!desc->u.m_Cond.m_Func(jitCtx, desc->u.m_Cond.m_Code, op)) {
 							JX_CHECK(false, "Failed to emit instruction.");
 						}
 					} break;
+					case JX64GEN_INSTR_COND_BINARY: {
+						jx_x64_operand_t op1 = jx_x64gen_convertMIROperand(ctx, mirInstr->m_Operands[0]);
+						jx_x64_operand_t op2 = jx_x64gen_convertMIROperand(ctx, mirInstr->m_Operands[1]);
+						if (!desc->u.m_CondBinary.m_Func(jitCtx, desc->u.m_CondBinary.m_Code, op1, op2)) {
+							JX_CHECK(false, "Failed to emit instruction.");
+						}
+					} break;
+					case JX64GEN_INSTR_VEX_BINARY: {
+						jx_x64_operand_t op1 = jx_x64gen_convertMIROperand(ctx, mirInstr->m_Operands[0]);
+						jx_x64_operand_t op2 = jx_x64gen_convertMIROperand(ctx, mirInstr->m_Operands[1]);
+						if (!desc->u.m_TernaryFunc(jitCtx, op1, op1, op2)) {
+							JX_CHECK(false, "Failed to emit instruction.");
+						}
+					} break;
+					case JX64GEN_INSTR_VEX_BINARY_IMM8: {
+						jx_x64_operand_t op1 = jx_x64gen_convertMIROperand(ctx, mirInstr->m_Operands[0]);
+						jx_x64_operand_t op2 = jx_x64gen_convertMIROperand(ctx, mirInstr->m_Operands[1]);
+						JX_CHECK(mirInstr->m_Operands[2]->m_Kind == JMIR_OPERAND_CONST, "Expected constant operand.");
+						const uint8_t imm8 = (uint8_t)mirInstr->m_Operands[2]->u.m_ConstI64;
+						if (!desc->u.m_TernaryImm8Func(jitCtx, op1, op1, op2, imm8)) {
+							JX_CHECK(false, "Failed to emit instruction.");
+						}
+					} break;
 					default:
 						JX_NOT_IMPLEMENTED();
 						break;
 					}
 
+					while (nextFrameEvent < numFrameEvents && frameEventArr[nextFrameEvent].m_Instr == mirInstr) {
+						jx_x64gen_emitUnwindOp(ctx, &frameEventArr[nextFrameEvent]);
+						++nextFrameEvent;
+					}
+
 					mirInstr = mirInstr->m_Next;
 				}
 
@@ -354,6 +648,15 @@ bool jx_x64gen_codeGen(jx_x64gen_context_t* ctx)
 				jx64_labelFree(jitCtx, ctx->m_BasicBlocks[iBB]);
 			}
 			jx_array_resize(ctx->m_BasicBlocks, 0);
+		} else if (mirFunc->m_Fingerprint != 0) {
+			// NOTE: The body of an unchanged function wasn't generated (see jx_irgen_setFuncCacheCallback()).
+			if (ctx->m_FuncAlignment > 1) {
+				jx64_alignText(jitCtx, ctx->m_FuncAlignment);
+			}
+
+			if (!jx64_funcEmitCached(jitCtx, ctx->m_Funcs[iFunc], mirFunc->m_Fingerprint)) {
+				return false;
+			}
 		}
 	}
 
@@ -363,7 +666,11 @@ bool jx_x64gen_codeGen(jx_x64gen_context_t* ctx)
 
 		const uint32_t dataSize = (uint32_t)jx_array_sizeu(mirGV->m_DataArr);
 		if (dataSize) {
-			jx64_globalVarDefine(jitCtx, ctx->m_GlobalVars[iGV], mirGV->m_DataArr, dataSize, mirGV->m_Alignment);
+			const jx_x64_section_kind section = (mirGV->m_Flags & JMIR_GLOBAL_VAR_FLAGS_READ_ONLY_Msk) != 0
+				? JX64_SECTION_RODATA
+				: JX64_SECTION_DATA
+				;
+			jx64_globalVarDefine(jitCtx, ctx->m_GlobalVars[iGV], section, mirGV->m_DataArr, dataSize, mirGV->m_Alignment);
 		}
 
 		const uint32_t numRelocations = (uint32_t)jx_array_sizeu(mirGV->m_RelocationsArr);
@@ -373,7 +680,7 @@ bool jx_x64gen_codeGen(jx_x64gen_context_t* ctx)
 		}
 	}
 
-	return jx64_finalize(jitCtx, ctx->m_ExternalSymCallback, ctx->m_ExternalSymCallbackUserData);
+	return true;
 }
 
 static jx_x64_operand_t jx_x64gen_convertMIROperand(jx_x64gen_context_t* ctx, const jx_mir_operand_t* mirOp)
@@ -440,7 +747,8 @@ static jx_x64_operand_t jx_x64gen_convertMIROperand(jx_x64gen_context_t* ctx, co
 			jx_x64_symbol_t* sym = jx64_symbolGetByName(ctx->m_JITCtx, globalName);
 			if (!sym) {
 				sym = jx64_globalVarDeclare(ctx->m_JITCtx, globalName);
-				jx64_globalVarDefine(ctx->m_JITCtx, sym, (const uint8_t*)&fconst, sizeof(float), 4);
+				sym->m_Flags |= JX64_SYMBOL_FLAGS_LOCAL_Msk;
+				jx64_globalVarDefine(ctx->m_JITCtx, sym, JX64_SECTION_RODATA, (const uint8_t*)&fconst, sizeof(float), 4);
 			}
 
 			op = jx64_opSymbol(JX64_SIZE_32, sym);
@@ -452,7 +760,8 @@ static jx_x64_operand_t jx_x64gen_convertMIROperand(jx_x64gen_context_t* ctx, co
 			jx_x64_symbol_t* sym = jx64_symbolGetByName(ctx->m_JITCtx, globalName);
 			if (!sym) {
 				sym = jx64_globalVarDeclare(ctx->m_JITCtx, globalName);
-				jx64_globalVarDefine(ctx->m_JITCtx, sym, (const uint8_t*)&dconst, sizeof(double), 8);
+				sym->m_Flags |= JX64_SYMBOL_FLAGS_LOCAL_Msk;
+				jx64_globalVarDefine(ctx->m_JITCtx, sym, JX64_SECTION_RODATA, (const uint8_t*)&dconst, sizeof(double), 8);
 			}
 
 			op = jx64_opSymbol(JX64_SIZE_64, sym);
@@ -601,4 +910,224 @@ static void jx_x64gen_setExternalSymbol(jx_x64_context_t* ctx, const char* name,
 	if (sym) {
 		jx64_symbolSetExternalAddress(ctx, sym, addr);
 	}
-}
\ No newline at end of file
+}
+
+// Marks the headers of the loops which are worth aligning. Only innermost loops without
+// calls are considered; outer loops and loops which call other functions are either
+// colder or dominated by other costs. The loop size is estimated from its instruction 
+// count since the final layout isn't known until the loop is emitted.
+static void jx_x64gen_findAlignedLoops(jx_x64gen_context_t* ctx, jx_mir_scc_t* sccList)
+{
+	jx_mir_scc_t* scc = sccList;
+	while (scc) {
+		if (!jx_x64gen_sccIsLoop(scc)) {
+			scc = scc->m_Next;
+			continue;
+		}
+
+		bool hasInnerLoop = false;
+		jx_mir_scc_t* child = scc->m_FirstChild;
+		while (child && !hasInnerLoop) {
+			hasInnerLoop = jx_x64gen_sccIsLoop(child);
+			child = child->m_Next;
+		}
+
+		if (hasInnerLoop) {
+			jx_x64gen_findAlignedLoops(ctx, scc->m_FirstChild);
+			scc = scc->m_Next;
+			continue;
+		}
+
+		const uint32_t numNodes = (uint32_t)jx_array_sizeu(scc->m_BasicBlockArr);
+
+		// NOTE: Irreducible SCCs have no single header to align.
+		jx_mir_basic_block_t* header = scc->m_EntryNode != NULL
+			? scc->m_EntryNode
+			: (numNodes == 1 ? scc->m_BasicBlockArr[0] : NULL)
+			;
+		if (header) {
+			uint32_t numInstrs = 0;
+			bool hasCall = false;
+			for (uint32_t iNode = 0; iNode <= numNodes && !hasCall; ++iNode) {
+				jx_mir_basic_block_t* bb = iNode == numNodes
+					? scc->m_EntryNode
+					: scc->m_BasicBlockArr[iNode]
+					;
+				if (!bb) {
+					continue;
+				}
+
+				jx_mir_instruction_t* instr = bb->m_InstrListHead;
+				while (instr) {
+					hasCall = hasCall
+						|| instr->m_OpCode == JMIR_OP_CALL
+						|| instr->m_OpCode == JMIR_OP_TAILCALL
+						;
+					++numInstrs;
+					instr = instr->m_Next;
+				}
+			}
+
+			const uint32_t loopSize = numInstrs * JX64GEN_AVG_INSTR_SIZE;
+			if (!hasCall && loopSize <= ctx->m_LoopAlignment * JX64GEN_LOOP_MAX_WINDOWS) {
+				ctx->m_LoopSizeArr[header->m_ID] = loopSize;
+			}
+		}
+
+		scc = scc->m_Next;
+	}
+}
+
+static bool jx_x64gen_sccIsLoop(const jx_mir_scc_t* scc)
+{
+	const uint32_t numNodes = (uint32_t)jx_array_sizeu(scc->m_BasicBlockArr);
+	if (scc->m_EntryNode || numNodes > 1) {
+		return true;
+	} else if (numNodes == 0) {
+		return false;
+	}
+
+	// A single basic block SCC is a loop only if the block branches to itself.
+	jx_mir_basic_block_t* bb = scc->m_BasicBlockArr[0];
+	const uint32_t numSuccs = (uint32_t)jx_array_sizeu(bb->m_SuccArr);
+	for (uint32_t iSucc = 0; iSucc < numSuccs; ++iSucc) {
+		if (bb->m_SuccArr[iSucc] == bb) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Pads the code up to the next loop alignment boundary, unless the padding is too large
+// or the loop already spans the minimum number of fetch windows at the current offset 
+// (e.g. tiny loops which already fit in a single window).
+static void jx_x64gen_alignLoopHeader(jx_x64gen_context_t* ctx, uint32_t loopSize)
+{
+	const uint32_t alignment = ctx->m_LoopAlignment;
+	const uint32_t curOffset = jx64_sectionGetSize(ctx->m_JITCtx, JX64_SECTION_TEXT);
+	const uint32_t misalignment = curOffset & (alignment - 1);
+	if (misalignment == 0) {
+		return;
+	}
+
+	const uint32_t padding = alignment - misalignment;
+	if (padding > ctx->m_LoopMaxPadding) {
+		return;
+	}
+
+	const uint32_t numWindows = (misalignment + loopSize + alignment - 1) / alignment;
+	const uint32_t numAlignedWindows = (loopSize + alignment - 1) / alignment;
+	if (numAlignedWindows >= numWindows) {
+		return;
+	}
+
+	jx64_nop(ctx->m_JITCtx, padding);
+}
+
+static void jx_x64gen_emitUnwindOp(jx_x64gen_context_t* ctx, const jx_mir_frame_event_t* event)
+{
+	switch (event->m_Kind) {
+	case JMIR_FRAME_EVENT_PUSH_REG: {
+		jx64_unwindOp(ctx->m_JITCtx, JX64_UNWIND_OP_PUSH_NONVOL, jx_x64gen_convertMIRReg(event->m_Reg, JX64_SIZE_64), 0);
+	} break;
+	case JMIR_FRAME_EVENT_ALLOC: {
+		jx64_unwindOp(ctx->m_JITCtx, JX64_UNWIND_OP_ALLOC_STACK, JX64_REG_RSP, event->m_Offset);
+	} break;
+	case JMIR_FRAME_EVENT_SAVE_REG: {
+		if (event->m_Reg.m_Class == JMIR_REG_CLASS_XMM) {
+			jx64_unwindOp(ctx->m_JITCtx, JX64_UNWIND_OP_SAVE_XMM128, jx_x64gen_convertMIRReg(event->m_Reg, JX64_SIZE_128), event->m_Offset);
+		} else {
+			jx64_unwindOp(ctx->m_JITCtx, JX64_UNWIND_OP_SAVE_NONVOL, jx_x64gen_convertMIRReg(event->m_Reg, JX64_SIZE_64), event->m_Offset);
+		}
+	} break;
+	default:
+		JX_CHECK(false, "Unknown frame event.");
+		break;
+	}
+}
+
+static const jx64gen_instr_desc_t* jx_x64gen_getInstrDesc(uint32_t opcode, bool useAVX)
+{
+	JX_CHECK(opcode < JX_COUNTOF(kInstrDesc), "Unknown opcode!");
+	if (useAVX && opcode < JX_COUNTOF(kInstrDescAVX) && kInstrDescAVX[opcode].m_Kind != JX64GEN_INSTR_UNKNOWN) {
+		return &kInstrDescAVX[opcode];
+	}
+
+	return &kInstrDesc[opcode];
+}
+
+// Fuses a register copy with the following 2-address SSE instruction into a single 
+// non-destructive VEX instruction, e.g.
+//   movaps xmm0, xmm1
+//   addps xmm0, xmm2
+// =>
+//   vaddps xmm0, xmm1, xmm2
+//
+// Scalar moves (movss/movsd) preserve the upper lanes of the destination while the fused 
+// instruction copies them from the move's source. This is only allowed when the result is 
+// a scalar value, in which case the upper lanes are never read.
+static bool jx_x64gen_emitFusedMoveVEX(jx_x64gen_context_t* ctx, const jx_mir_instruction_t* movInstr)
+{
+	const bool isFullMove = false
+		|| movInstr->m_OpCode == JMIR_OP_MOVAPS
+		|| movInstr->m_OpCode == JMIR_OP_MOVAPD
+		;
+	const bool isScalarMove = false
+		|| movInstr->m_OpCode == JMIR_OP_MOVSS
+		|| movInstr->m_OpCode == JMIR_OP_MOVSD
+		;
+	if (!isFullMove && !isScalarMove) {
+		return false;
+	}
+
+	const jx_mir_instruction_t* opInstr = movInstr->m_Next;
+	if (!opInstr || opInstr->m_OpCode >= JX_COUNTOF(kInstrDescAVX)) {
+		return false;
+	}
+
+	const jx64gen_instr_desc_t* desc = &kInstrDescAVX[opInstr->m_OpCode];
+	if (desc->m_Kind != JX64GEN_INSTR_VEX_BINARY && desc->m_Kind != JX64GEN_INSTR_VEX_BINARY_IMM8) {
+		return false;
+	}
+
+	const jx_mir_operand_t* movDst = movInstr->m_Operands[0];
+	const jx_mir_operand_t* movSrc = movInstr->m_Operands[1];
+	const jx_mir_operand_t* opDst = opInstr->m_Operands[0];
+	const jx_mir_operand_t* opSrc = opInstr->m_Operands[1];
+	const bool canFuse = true
+		&& movDst->m_Kind == JMIR_OPERAND_REGISTER
+		&& movSrc->m_Kind == JMIR_OPERAND_REGISTER
+		&& opDst->m_Kind == JMIR_OPERAND_REGISTER
+		&& jx_mir_regEqual(movDst->u.m_Reg, opDst->u.m_Reg)
+		&& (isFullMove || opDst->m_Type == JMIR_TYPE_F32 || opDst->m_Type == JMIR_TYPE_F64)
+		;
+	if (!canFuse) {
+		return false;
+	}
+
+	// NOTE: If the instruction reads the destination register as its second source, it reads
+	// the value copied by the move.
+	const bool srcIsDst = true
+		&& opSrc->m_Kind == JMIR_OPERAND_REGISTER
+		&& jx_mir_regEqual(opSrc->u.m_Reg, movDst->u.m_Reg)
+		;
+
+	jx_x64_context_t* jitCtx = ctx->m_JITCtx;
+	jx_x64_operand_t dst = jx_x64gen_convertMIROperand(ctx, opDst);
+	jx_x64_operand_t src1 = jx_x64gen_convertMIROperand(ctx, movSrc);
+	jx_x64_operand_t src2 = jx_x64gen_convertMIROperand(ctx, srcIsDst ? movSrc : opSrc);
+	if (desc->m_Kind == JX64GEN_INSTR_VEX_BINARY) {
+		if (!desc->u.m_TernaryFunc(jitCtx, dst, src1, src2)) {
+			JX_CHECK(false, "Failed to emit instruction.");
+		}
+	} else {
+		JX_CHECK(opInstr->m_Operands[2]->m_Kind == JMIR_OPERAND_CONST, "Expected constant operand.");
+		const uint8_t imm8 = (uint8_t)opInstr->m_Operands[2]->u.m_ConstI64;
+		if (!desc->u.m_TernaryImm8Func(jitCtx, dst, src1, src2, imm8)) {
+			JX_CHECK(false, "Failed to emit instruction.");
+		}
+	}
+
+	return true;
+}
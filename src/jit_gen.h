@@ -14,6 +14,14 @@ typedef struct jx_x64gen_context_t jx_x64gen_context_t;
 jx_x64gen_context_t* jx_x64gen_createContext(jx_x64_context_t* jitCtx, jx_mir_context_t* mirCtx, jx64GetExternalSymbolAddrCallback externalSymCb, void* userData, jx_allocator_i* allocator);
 void jx_x64gen_destroyContext(jx_x64gen_context_t* ctx);
 
+// Alignments must be powers of 2. An alignment of 0 or 1 disables padding. Loop headers 
+// are only padded if the padding does not exceed loopMaxPadding bytes.
+void jx_x64gen_setCodeAlignment(jx_x64gen_context_t* ctx, uint32_t funcAlignment, uint32_t loopAlignment, uint32_t loopMaxPadding);
+
 bool jx_x64gen_codeGen(jx_x64gen_context_t* ctx);
 
+// Same as jx_x64gen_codeGen() but doesn't finalize the JIT context, e.g. in order to emit
+// an object file with jx64_emitELFObject() first.
+bool jx_x64gen_emitCode(jx_x64gen_context_t* ctx);
+
 #endif // JX_X64_GEN_H
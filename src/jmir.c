@@ -3,6 +3,7 @@
 #include <jlib/allocator.h>
 #include <jlib/array.h>
 #include <jlib/bitset.h>
+#include <jlib/cpu.h>
 #include <jlib/dbg.h>
 #include <jlib/hashmap.h>
 #include <jlib/logger.h>
@@ -10,6 +11,7 @@
 #include <jlib/memory.h>
 #include <jlib/string.h>
 #include <tracy/tracy/TracyC.h>
+#include <intrin.h>
 
 static const char* kMIROpcodeMnemonic[] = {
 	[JMIR_OP_RET] = "ret",
@@ -23,6 +25,8 @@ static const char* kMIROpcodeMnemonic[] = {
 	[JMIR_OP_IMUL3] = "imul",
 	[JMIR_OP_IDIV] = "idiv",
 	[JMIR_OP_DIV] = "div",
+	[JMIR_OP_IMUL1] = "imul",
+	[JMIR_OP_MUL] = "mul",
 	[JMIR_OP_ADD] = "add",
 	[JMIR_OP_SUB] = "sub",
 	[JMIR_OP_LEA] = "lea",
@@ -32,7 +36,16 @@ static const char* kMIROpcodeMnemonic[] = {
 	[JMIR_OP_SAR] = "sar",
 	[JMIR_OP_SHR] = "shr",
 	[JMIR_OP_SHL] = "shl",
+	[JMIR_OP_ROL] = "rol",
+	[JMIR_OP_ROR] = "ror",
+	[JMIR_OP_BSWAP] = "bswap",
+	[JMIR_OP_BSF] = "bsf",
+	[JMIR_OP_BSR] = "bsr",
+	[JMIR_OP_POPCNT] = "popcnt",
+	[JMIR_OP_LZCNT] = "lzcnt",
+	[JMIR_OP_TZCNT] = "tzcnt",
 	[JMIR_OP_CALL] = "call",
+	[JMIR_OP_TAILCALL] = "jmp",
 	[JMIR_OP_PUSH] = "push",
 	[JMIR_OP_POP] = "pop",
 	[JMIR_OP_CDQ] = "cdq",
@@ -69,10 +82,28 @@ static const char* kMIROpcodeMnemonic[] = {
 	[JMIR_OP_JNL] = "jge",
 	[JMIR_OP_JLE] = "jle",
 	[JMIR_OP_JNLE] = "jg",
+	[JMIR_OP_CMOVO] = "cmovo",
+	[JMIR_OP_CMOVNO] = "cmovno",
+	[JMIR_OP_CMOVB] = "cmovb",
+	[JMIR_OP_CMOVNB] = "cmovnb",
+	[JMIR_OP_CMOVE] = "cmove",
+	[JMIR_OP_CMOVNE] = "cmovne",
+	[JMIR_OP_CMOVBE] = "cmovbe",
+	[JMIR_OP_CMOVNBE] = "cmovnbe",
+	[JMIR_OP_CMOVS] = "cmovs",
+	[JMIR_OP_CMOVNS] = "cmovns",
+	[JMIR_OP_CMOVP] = "cmovp",
+	[JMIR_OP_CMOVNP] = "cmovnp",
+	[JMIR_OP_CMOVL] = "cmovl",
+	[JMIR_OP_CMOVNL] = "cmovnl",
+	[JMIR_OP_CMOVLE] = "cmovle",
+	[JMIR_OP_CMOVNLE] = "cmovnle",
 	[JMIR_OP_MOVSS] = "movss",
 	[JMIR_OP_MOVSD] = "movsd",
 	[JMIR_OP_MOVAPS] = "movaps",
 	[JMIR_OP_MOVAPD] = "movapd",
+	[JMIR_OP_MOVUPS] = "movups",
+	[JMIR_OP_MOVUPD] = "movupd",
 	[JMIR_OP_MOVD] = "movd",
 	[JMIR_OP_MOVQ] = "movq",
 	[JMIR_OP_ADDPS] = "addps",
@@ -115,6 +146,8 @@ static const char* kMIROpcodeMnemonic[] = {
 	[JMIR_OP_RCPSS] = "rcpss",
 	[JMIR_OP_RSQRTPS] = "rsqrtps",
 	[JMIR_OP_RSQRTSS] = "rsqrtss",
+	[JMIR_OP_SHUFPS] = "shufps",
+	[JMIR_OP_SHUFPD] = "shufpd",
 	[JMIR_OP_SQRTPS] = "sqrtps",
 	[JMIR_OP_SQRTSS] = "sqrtss",
 	[JMIR_OP_SQRTPD] = "sqrtpd",
@@ -141,51 +174,208 @@ static const char* kMIROpcodeMnemonic[] = {
 	[JMIR_OP_PUNPCKHQDQ] = "punpckhqdq",
 };
 
-typedef struct jx_mir_frame_info_t
-{
-	jx_mir_memory_ref_t** m_StackObjArr;
-	uint32_t m_MaxCallArgs;
-	uint32_t m_Size;
-} jx_mir_frame_info_t;
-
 typedef struct jx_mir_context_t
 {
 	jx_allocator_i* m_Allocator;
 	jx_allocator_i* m_LinearAllocator;
 	jx_mir_function_t** m_FuncArr;
 	jx_mir_global_variable_t** m_GlobalVarArr;
-	jx_mir_function_pass_t* m_FuncPass_removeFallthroughJmp;
-	jx_mir_function_pass_t* m_FuncPass_simplifyCondJmp;
-	jx_mir_function_pass_t* m_FuncPass_deadCodeElimination;
-	jx_mir_function_pass_t* m_FuncPass_peephole;
-	jx_mir_function_pass_t* m_FuncPass_regAlloc;
-	jx_mir_function_pass_t* m_FuncPass_removeRedundantMoves;
-	jx_mir_function_pass_t* m_FuncPass_redundantConstElimination;
-	jx_mir_function_pass_t* m_FuncPass_instrCombine;
-	jx_mir_function_pass_t* m_FuncPass_simplifyCFG;
+	jx_mir_pipeline_t* m_DefaultPipeline; // Owned by the context; one of the opt level presets
+	jx_mir_pipeline_t* m_Pipeline;
 	jx_hashmap_t* m_FuncProtoMap;
+	jx_mir_passCallback m_PassCallback;
+	void* m_PassCallbackUserData;
+	jx_mir_funcPipelineCallback m_FuncPipelineCallback;
+	void* m_FuncPipelineCallbackUserData;
+	uint32_t m_Flags; // JMIR_CONTEXT_FLAGS_xxx
 } jx_mir_context_t;
 
+typedef enum jmir_pipeline_step_kind
+{
+	JMIR_PIPELINE_STEP_PASS = 0,
+	JMIR_PIPELINE_STEP_LOOP_BEGIN,
+	JMIR_PIPELINE_STEP_LOOP_END,
+} jmir_pipeline_step_kind;
+
+typedef struct jmir_pipeline_step_t
+{
+	jx_mir_function_pass_t* m_FuncPass;
+	jmir_pipeline_step_kind m_Kind;
+	jx_mir_pass_kind m_PassKind;
+	uint32_t m_Flags;
+	uint32_t m_MaxIterations;
+	uint64_t m_OptionsHash; // All options set on the pass, in order
+} jmir_pipeline_step_t;
+
+typedef struct jx_mir_pipeline_t
+{
+	jmir_pipeline_step_t* m_StepArr;
+} jx_mir_pipeline_t;
+
+#define JMIR_PASS_DESC_FLAGS_REQUIRED_Pos 0 // Must be part of every pipeline
+#define JMIR_PASS_DESC_FLAGS_REQUIRED_Msk (1u << JMIR_PASS_DESC_FLAGS_REQUIRED_Pos)
+#define JMIR_PASS_DESC_FLAGS_PRE_RA_Pos   1 // Must run before register allocation
+#define JMIR_PASS_DESC_FLAGS_PRE_RA_Msk   (1u << JMIR_PASS_DESC_FLAGS_PRE_RA_Pos)
+#define JMIR_PASS_DESC_FLAGS_POST_RA_Pos  2 // Must run after register allocation
+#define JMIR_PASS_DESC_FLAGS_POST_RA_Msk  (1u << JMIR_PASS_DESC_FLAGS_POST_RA_Pos)
+#define JMIR_PASS_DESC_FLAGS_LAST_Pos     3 // Must be the last step of the pipeline (i.e. runs once, outside of any loop)
+#define JMIR_PASS_DESC_FLAGS_LAST_Msk     (1u << JMIR_PASS_DESC_FLAGS_LAST_Pos)
+
+typedef struct jmir_pass_desc_t
+{
+	const char* m_Name;
+	jmirFuncPassCtorFunc m_FuncPassCtor;
+	uint32_t m_Flags; // JMIR_PASS_DESC_FLAGS_xxx
+} jmir_pass_desc_t;
+
+static const jmir_pass_desc_t kPassDesc[] = {
+	[JMIR_PASS_REMOVE_FALLTHROUGH_JMP]       = { "removeFallthroughJmp",      jx_mir_funcPassCreate_removeFallthroughJmp,      0 },
+	[JMIR_PASS_SIMPLIFY_COND_JMP]            = { "simplifyCondJmp",           jx_mir_funcPassCreate_simplifyCondJmp,           0 },
+	[JMIR_PASS_DEAD_CODE_ELIMINATION]        = { "deadCodeElimination",       jx_mir_funcPassCreate_deadCodeElimination,       JMIR_PASS_DESC_FLAGS_PRE_RA_Msk },
+	[JMIR_PASS_PEEPHOLE]                     = { "peephole",                  jx_mir_funcPassCreate_peephole,                  JMIR_PASS_DESC_FLAGS_PRE_RA_Msk },
+	[JMIR_PASS_REG_ALLOC]                    = { "regAlloc",                  jx_mir_funcPassCreate_regAlloc,                  JMIR_PASS_DESC_FLAGS_REQUIRED_Msk },
+	[JMIR_PASS_REMOVE_REDUNDANT_MOVES]       = { "removeRedundantMoves",      jx_mir_funcPassCreate_removeRedundantMoves,      JMIR_PASS_DESC_FLAGS_REQUIRED_Msk | JMIR_PASS_DESC_FLAGS_POST_RA_Msk },
+	[JMIR_PASS_REDUNDANT_CONST_ELIMINATION]  = { "redundantConstElimination", jx_mir_funcPassCreate_redundantConstElimination, JMIR_PASS_DESC_FLAGS_POST_RA_Msk },
+	[JMIR_PASS_INSTR_COMBINE]                = { "instrCombine",              jx_mir_funcPassCreate_instrCombine,              JMIR_PASS_DESC_FLAGS_PRE_RA_Msk },
+	[JMIR_PASS_SIMPLIFY_CFG]                 = { "simplifyCFG",               jx_mir_funcPassCreate_simplifyCFG,               JMIR_PASS_DESC_FLAGS_PRE_RA_Msk },
+	[JMIR_PASS_SLP_VECTORIZER]               = { "slpVectorizer",             jx_mir_funcPassCreate_slpVectorizer,             JMIR_PASS_DESC_FLAGS_PRE_RA_Msk },
+	[JMIR_PASS_STACK_SLOT_COLORING]          = { "stackSlotColoring",         jx_mir_funcPassCreate_stackSlotColoring,         JMIR_PASS_DESC_FLAGS_POST_RA_Msk | JMIR_PASS_DESC_FLAGS_LAST_Msk },
+	[JMIR_PASS_PRE_RA_SCHEDULER]             = { "preRAScheduler",            jx_mir_funcPassCreate_preRAScheduler,            JMIR_PASS_DESC_FLAGS_PRE_RA_Msk },
+	[JMIR_PASS_POST_RA_SCHEDULER]            = { "postRAScheduler",           jx_mir_funcPassCreate_postRAScheduler,           JMIR_PASS_DESC_FLAGS_POST_RA_Msk },
+};
+JX_STATIC_ASSERT(JX_COUNTOF(kPassDesc) == JMIR_PASS_COUNT, "Missing pass descriptor?");
+
+typedef struct jmir_pipeline_preset_step_t
+{
+	jmir_pipeline_step_kind m_Kind;
+	jx_mir_pass_kind m_PassKind;
+	uint32_t m_Arg; // Step flags for passes, max iterations for loops
+} jmir_pipeline_preset_step_t;
+
+#define PASS(kind)            { JMIR_PIPELINE_STEP_PASS, JMIR_PASS_##kind, 0 }
+#define PASS_IF_CHANGED(kind) { JMIR_PIPELINE_STEP_PASS, JMIR_PASS_##kind, JMIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Msk }
+#define LOOP(n)               { JMIR_PIPELINE_STEP_LOOP_BEGIN, JMIR_PASS_COUNT, n }
+#define END_LOOP()            { JMIR_PIPELINE_STEP_LOOP_END, JMIR_PASS_COUNT, 0 }
+
+static const jmir_pipeline_preset_step_t kPipelinePresetO0[] = {
+	PASS(REMOVE_FALLTHROUGH_JMP),
+	PASS(REG_ALLOC),
+	PASS(REMOVE_REDUNDANT_MOVES),
+};
+
+static const jmir_pipeline_preset_step_t kPipelinePresetO1[] = {
+	PASS(REMOVE_FALLTHROUGH_JMP),
+	PASS(SIMPLIFY_COND_JMP),
+	PASS(SIMPLIFY_CFG),
+	LOOP(2),
+		PASS(INSTR_COMBINE),
+		PASS(DEAD_CODE_ELIMINATION),
+		PASS(PEEPHOLE),
+		PASS(DEAD_CODE_ELIMINATION),
+	END_LOOP(),
+	PASS(REG_ALLOC),
+	PASS(REMOVE_REDUNDANT_MOVES),
+	PASS(REDUNDANT_CONST_ELIMINATION),
+	PASS(SIMPLIFY_COND_JMP),
+	PASS(STACK_SLOT_COLORING),
+};
+
+// NOTE: stackSlotColoring must run after all passes which might allocate new stack 
+// objects and before callee-saved register slots are allocated (i.e. last). It expects
+// the stack objects to be sorted by offset so it cannot run more than once.
+static const jmir_pipeline_preset_step_t kPipelinePresetO2[] = {
+	PASS(REMOVE_FALLTHROUGH_JMP),
+	PASS(SIMPLIFY_COND_JMP),
+	PASS(SIMPLIFY_CFG),
+	LOOP(5),
+		PASS(INSTR_COMBINE),
+		PASS(DEAD_CODE_ELIMINATION),
+		PASS(PEEPHOLE),
+		PASS(DEAD_CODE_ELIMINATION),
+	END_LOOP(),
+	PASS(SLP_VECTORIZER),
+	PASS_IF_CHANGED(DEAD_CODE_ELIMINATION),
+	PASS(PRE_RA_SCHEDULER),
+	PASS(REG_ALLOC),
+	PASS(REMOVE_REDUNDANT_MOVES),
+	PASS(REDUNDANT_CONST_ELIMINATION),
+	PASS(SIMPLIFY_COND_JMP),
+	PASS(POST_RA_SCHEDULER),
+	PASS(STACK_SLOT_COLORING),
+};
+
+static const jmir_pipeline_preset_step_t kPipelinePresetOs[] = {
+	PASS(REMOVE_FALLTHROUGH_JMP),
+	PASS(SIMPLIFY_COND_JMP),
+	PASS(SIMPLIFY_CFG),
+	LOOP(5),
+		PASS(INSTR_COMBINE),
+		PASS(DEAD_CODE_ELIMINATION),
+		PASS(PEEPHOLE),
+		PASS(DEAD_CODE_ELIMINATION),
+	END_LOOP(),
+	PASS(SLP_VECTORIZER),
+	PASS_IF_CHANGED(DEAD_CODE_ELIMINATION),
+	PASS(REG_ALLOC),
+	PASS(REMOVE_REDUNDANT_MOVES),
+	PASS(REDUNDANT_CONST_ELIMINATION),
+	PASS(SIMPLIFY_COND_JMP),
+	PASS(STACK_SLOT_COLORING),
+};
+
+#undef PASS
+#undef PASS_IF_CHANGED
+#undef LOOP
+#undef END_LOOP
+
+typedef struct jmir_pipeline_preset_t
+{
+	const jmir_pipeline_preset_step_t* m_Steps;
+	uint32_t m_NumSteps;
+} jmir_pipeline_preset_t;
+
+static const jmir_pipeline_preset_t kPipelinePreset[] = {
+	[JMIR_OPT_LEVEL_O0] = { kPipelinePresetO0, JX_COUNTOF(kPipelinePresetO0) },
+	[JMIR_OPT_LEVEL_O1] = { kPipelinePresetO1, JX_COUNTOF(kPipelinePresetO1) },
+	[JMIR_OPT_LEVEL_O2] = { kPipelinePresetO2, JX_COUNTOF(kPipelinePresetO2) },
+	[JMIR_OPT_LEVEL_Os] = { kPipelinePresetOs, JX_COUNTOF(kPipelinePresetOs) },
+};
+
 static jx_mir_operand_t* jmir_operandAlloc(jx_mir_context_t* ctx, jx_mir_operand_kind kind, jx_mir_type_kind type);
 static jx_mir_instruction_t* jmir_instrAlloc(jx_mir_context_t* ctx, uint32_t opcode, uint32_t numOperands, jx_mir_operand_t** operands);
 static jx_mir_instruction_t* jmir_instrAlloc1(jx_mir_context_t* ctx, uint32_t opcode, jx_mir_operand_t* op1);
 static jx_mir_instruction_t* jmir_instrAlloc2(jx_mir_context_t* ctx, uint32_t opcode, jx_mir_operand_t* op1, jx_mir_operand_t* op2);
 static jx_mir_instruction_t* jmir_instrAlloc3(jx_mir_context_t* ctx, uint32_t opcode, jx_mir_operand_t* op1, jx_mir_operand_t* op2, jx_mir_operand_t* op3);
 static bool jmir_instrUpdateUseDefInfo(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_instruction_t* instr);
+static inline bool jmir_instrUsesReg(const jx_mir_instruction_t* instr, jx_mir_reg_t reg);
+static inline bool jmir_instrDefsReg(const jx_mir_instruction_t* instr, jx_mir_reg_t reg);
 static void jmir_regPrint(jx_mir_context_t* ctx, jx_mir_reg_t reg, jx_mir_type_kind type, jx_string_buffer_t* sb);
 static jx_mir_operand_t* jmir_funcCreateArgument(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_basic_block_t* bb, uint32_t argID, jx_mir_type_kind argType);
 static void jmir_funcFree(jx_mir_context_t* ctx, jx_mir_function_t* func);
-static jx_mir_function_pass_t* jmir_funcPassCreate(jx_mir_context_t* ctx, jmirFuncPassCtorFunc ctorFunc, void* passConfig);
+static jx_mir_function_pass_t* jmir_funcPassCreate(jx_mir_context_t* ctx, const char* name, jmirFuncPassCtorFunc ctorFunc, void* passConfig);
 static void jmir_funcPassDestroy(jx_mir_context_t* ctx, jx_mir_function_pass_t* pass);
 static bool jmir_funcPassApply(jx_mir_context_t* ctx, jx_mir_function_pass_t* pass, jx_mir_function_t* func);
+static void jmir_pipelineStepDestroy(jx_mir_context_t* ctx, jmir_pipeline_step_t* step);
+static bool jmir_pipelineInsertStep(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos, const jmir_pipeline_step_t* step);
+static uint32_t jmir_pipelineFindLoopEnd(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t loopBegin);
+static bool jmir_pipelineRunSteps(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t begin, uint32_t end, jx_mir_function_t* func);
+static jx_mir_pipeline_t* jmir_getFuncPipeline(jx_mir_context_t* ctx, const char* funcName);
+static uint32_t jmir_detectTargetFlags(void);
 static void jmir_globalVarFree(jx_mir_context_t* ctx, jx_mir_global_variable_t* gv);
 static jx_mir_memory_ref_t* jmir_memRefAlloc(jx_mir_context_t* ctx, jx_mir_reg_t baseReg, jx_mir_reg_t indexReg, uint32_t scale, int32_t displacement);
 static jx_mir_frame_info_t* jmir_frameCreate(jx_mir_context_t* ctx);
 static void jmir_frameDestroy(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo);
-static jx_mir_memory_ref_t* jmir_frameAllocObj(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo, uint32_t sz, uint32_t alignment);
+static jx_mir_memory_ref_t* jmir_frameAllocObj(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo, uint32_t sz, uint32_t alignment, uint32_t slotFlags);
 static jx_mir_memory_ref_t* jmir_frameObjRel(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo, jx_mir_memory_ref_t* baseObj, int32_t offset);
 static void jmir_frameMakeRoomForCall(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo, uint32_t numArguments);
-static void jmir_frameFinalize(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo);
+static void jmir_frameFinalize(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo, uint32_t numPushedRegs);
+static void jmir_frameAddEvent(jx_mir_frame_info_t* frameInfo, jx_mir_frame_event_kind kind, jx_mir_instruction_t* instr, jx_mir_reg_t reg, uint32_t offset);
+static bool jmir_frameIsSpillSlot(jx_mir_frame_info_t* frameInfo, const jx_mir_memory_ref_t* memRef);
+static void jmir_funcSplitVirtualRegAroundLoops(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_reg_t reg, jx_mir_memory_ref_t* stackSlot);
+static jx_mir_basic_block_t* jmir_sccGetPreheader(jx_mir_scc_t* scc);
+static bool jmir_sccContainsBasicBlock(jx_mir_scc_t* scc, jx_mir_basic_block_t* bb);
+static jx_mir_basic_block_t* jmir_funcFindCalleeSavedRegsSaveBlock(jx_mir_context_t* ctx, jx_mir_function_t* func, const uint32_t* savedRegs);
+static bool jmir_bbIsValidSaveBlock(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_basic_block_t* saveBB);
 static uint64_t jmir_funcProtoHashCallback(const void* item, uint64_t seed0, uint64_t seed1, void* udata);
 static int32_t jmir_funcProtoCompareCallback(const void* a, const void* b, void* udata);
 static jx_mir_scc_t* jmir_sccAlloc(jx_mir_context_t* ctx);
@@ -200,6 +390,7 @@ jx_mir_context_t* jx_mir_createContext(jx_allocator_i* allocator)
 
 	jx_memset(ctx, 0, sizeof(jx_mir_context_t));
 	ctx->m_Allocator = allocator;
+	ctx->m_Flags = jmir_detectTargetFlags();
 
 	ctx->m_LinearAllocator = allocator_api->createLinearAllocator(256 << 10, allocator);
 	if (!ctx->m_LinearAllocator) {
@@ -225,18 +416,13 @@ jx_mir_context_t* jx_mir_createContext(jx_allocator_i* allocator)
 		return NULL;
 	}
 
-	// Initialize function passes to be executed when funcEnd is called
-	{
-		ctx->m_FuncPass_removeFallthroughJmp = jmir_funcPassCreate(ctx, jx_mir_funcPassCreate_removeFallthroughJmp, NULL);
-		ctx->m_FuncPass_simplifyCondJmp = jmir_funcPassCreate(ctx, jx_mir_funcPassCreate_simplifyCondJmp, NULL);
-		ctx->m_FuncPass_deadCodeElimination = jmir_funcPassCreate(ctx, jx_mir_funcPassCreate_deadCodeElimination, NULL);
-		ctx->m_FuncPass_peephole = jmir_funcPassCreate(ctx, jx_mir_funcPassCreate_peephole, NULL);
-		ctx->m_FuncPass_regAlloc = jmir_funcPassCreate(ctx, jx_mir_funcPassCreate_regAlloc, NULL);
-		ctx->m_FuncPass_removeRedundantMoves = jmir_funcPassCreate(ctx, jx_mir_funcPassCreate_removeRedundantMoves, NULL);
-		ctx->m_FuncPass_redundantConstElimination = jmir_funcPassCreate(ctx, jx_mir_funcPassCreate_redundantConstElimination, NULL);
-		ctx->m_FuncPass_instrCombine = jmir_funcPassCreate(ctx, jx_mir_funcPassCreate_instrCombine, NULL);
-		ctx->m_FuncPass_simplifyCFG = jmir_funcPassCreate(ctx, jx_mir_funcPassCreate_simplifyCFG, NULL);
+	// Initialize the default pipeline to be executed when funcEnd is called
+	ctx->m_DefaultPipeline = jx_mir_pipelineCreatePreset(ctx, JMIR_OPT_LEVEL_O2);
+	if (!ctx->m_DefaultPipeline) {
+		jx_mir_destroyContext(ctx);
+		return NULL;
 	}
+	ctx->m_Pipeline = ctx->m_DefaultPipeline;
 
 	return ctx;
 }
@@ -245,53 +431,12 @@ void jx_mir_destroyContext(jx_mir_context_t* ctx)
 {
 	jx_allocator_i* allocator = ctx->m_Allocator;
 
-	// Free function passes
-	{
-		if (ctx->m_FuncPass_removeFallthroughJmp) {
-			jmir_funcPassDestroy(ctx, ctx->m_FuncPass_removeFallthroughJmp);
-			ctx->m_FuncPass_removeFallthroughJmp = NULL;
-		}
-
-		if (ctx->m_FuncPass_simplifyCondJmp) {
-			jmir_funcPassDestroy(ctx, ctx->m_FuncPass_simplifyCondJmp);
-			ctx->m_FuncPass_simplifyCondJmp = NULL;
-		}
-		
-		if (ctx->m_FuncPass_deadCodeElimination) {
-			jmir_funcPassDestroy(ctx, ctx->m_FuncPass_deadCodeElimination);
-			ctx->m_FuncPass_deadCodeElimination = NULL;
-		}
-
-		if (ctx->m_FuncPass_peephole) {
-			jmir_funcPassDestroy(ctx, ctx->m_FuncPass_peephole);
-			ctx->m_FuncPass_peephole = NULL;
-		}
-
-		if (ctx->m_FuncPass_regAlloc) {
-			jmir_funcPassDestroy(ctx, ctx->m_FuncPass_regAlloc);
-			ctx->m_FuncPass_regAlloc = NULL;
-		}
-
-		if (ctx->m_FuncPass_removeRedundantMoves) {
-			jmir_funcPassDestroy(ctx, ctx->m_FuncPass_removeRedundantMoves);
-			ctx->m_FuncPass_removeRedundantMoves = NULL;
-		}
-
-		if (ctx->m_FuncPass_redundantConstElimination) {
-			jmir_funcPassDestroy(ctx, ctx->m_FuncPass_redundantConstElimination);
-			ctx->m_FuncPass_redundantConstElimination = NULL;
-		}
-
-		if (ctx->m_FuncPass_instrCombine) {
-			jmir_funcPassDestroy(ctx, ctx->m_FuncPass_instrCombine);
-			ctx->m_FuncPass_instrCombine = NULL;
-		}
-
-		if (ctx->m_FuncPass_simplifyCFG) {
-			jmir_funcPassDestroy(ctx, ctx->m_FuncPass_simplifyCFG);
-			ctx->m_FuncPass_simplifyCFG = NULL;
-		}
+	// Free pipelines
+	if (ctx->m_DefaultPipeline) {
+		jx_mir_pipelineDestroy(ctx, ctx->m_DefaultPipeline);
+		ctx->m_DefaultPipeline = NULL;
 	}
+	ctx->m_Pipeline = NULL;
 
 	const uint32_t numGlobalVars = (uint32_t)jx_array_sizeu(ctx->m_GlobalVarArr);
 	for (uint32_t iGV = 0; iGV < numGlobalVars; ++iGV) {
@@ -318,6 +463,61 @@ void jx_mir_destroyContext(jx_mir_context_t* ctx)
 	JX_FREE(allocator, ctx);
 }
 
+void jx_mir_setPassCallback(jx_mir_context_t* ctx, jx_mir_passCallback callback, void* userData)
+{
+	ctx->m_PassCallback = callback;
+	ctx->m_PassCallbackUserData = userData;
+}
+
+bool jx_mir_setOptLevel(jx_mir_context_t* ctx, jx_mir_opt_level level)
+{
+	jx_mir_pipeline_t* pipeline = jx_mir_pipelineCreatePreset(ctx, level);
+	if (!pipeline) {
+		return false;
+	}
+
+	if (ctx->m_Pipeline == ctx->m_DefaultPipeline) {
+		ctx->m_Pipeline = pipeline;
+	}
+
+	jx_mir_pipelineDestroy(ctx, ctx->m_DefaultPipeline);
+	ctx->m_DefaultPipeline = pipeline;
+
+	return true;
+}
+
+bool jx_mir_setPipeline(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline)
+{
+	if (!pipeline) {
+		ctx->m_Pipeline = ctx->m_DefaultPipeline;
+		return true;
+	}
+
+	if (!jx_mir_pipelineIsValid(ctx, pipeline)) {
+		return false;
+	}
+
+	ctx->m_Pipeline = pipeline;
+
+	return true;
+}
+
+void jx_mir_setFuncPipelineCallback(jx_mir_context_t* ctx, jx_mir_funcPipelineCallback callback, void* userData)
+{
+	ctx->m_FuncPipelineCallback = callback;
+	ctx->m_FuncPipelineCallbackUserData = userData;
+}
+
+void jx_mir_setFlags(jx_mir_context_t* ctx, uint32_t flags)
+{
+	ctx->m_Flags = flags;
+}
+
+uint32_t jx_mir_getFlags(jx_mir_context_t* ctx)
+{
+	return ctx->m_Flags;
+}
+
 void jx_mir_print(jx_mir_context_t* ctx, jx_string_buffer_t* sb)
 {
 	TracyCZoneN(tracyCtx, "MIR: Print", 1);
@@ -442,6 +642,328 @@ void jx_mir_globalVarAddRelocation(jx_mir_context_t* ctx, jx_mir_global_variable
 	});
 }
 
+jx_mir_pipeline_t* jx_mir_pipelineCreate(jx_mir_context_t* ctx)
+{
+	jx_mir_pipeline_t* pipeline = (jx_mir_pipeline_t*)JX_ALLOC(ctx->m_Allocator, sizeof(jx_mir_pipeline_t));
+	if (!pipeline) {
+		return NULL;
+	}
+
+	jx_memset(pipeline, 0, sizeof(jx_mir_pipeline_t));
+	pipeline->m_StepArr = (jmir_pipeline_step_t*)jx_array_create(ctx->m_Allocator);
+	if (!pipeline->m_StepArr) {
+		JX_FREE(ctx->m_Allocator, pipeline);
+		return NULL;
+	}
+
+	return pipeline;
+}
+
+jx_mir_pipeline_t* jx_mir_pipelineCreatePreset(jx_mir_context_t* ctx, jx_mir_opt_level level)
+{
+	if ((uint32_t)level >= JX_COUNTOF(kPipelinePreset)) {
+		return NULL;
+	}
+
+	jx_mir_pipeline_t* pipeline = jx_mir_pipelineCreate(ctx);
+	if (!pipeline) {
+		return NULL;
+	}
+
+	const jmir_pipeline_preset_t* preset = &kPipelinePreset[level];
+	for (uint32_t iStep = 0; iStep < preset->m_NumSteps; ++iStep) {
+		const jmir_pipeline_preset_step_t* presetStep = &preset->m_Steps[iStep];
+
+		bool res = false;
+		switch (presetStep->m_Kind) {
+		case JMIR_PIPELINE_STEP_PASS: {
+			res = jx_mir_pipelineInsertPass(ctx, pipeline, JMIR_PIPELINE_POS_END, presetStep->m_PassKind, presetStep->m_Arg);
+		} break;
+		case JMIR_PIPELINE_STEP_LOOP_BEGIN: {
+			res = jx_mir_pipelineInsertLoopBegin(ctx, pipeline, JMIR_PIPELINE_POS_END, presetStep->m_Arg);
+		} break;
+		case JMIR_PIPELINE_STEP_LOOP_END: {
+			res = jx_mir_pipelineInsertLoopEnd(ctx, pipeline, JMIR_PIPELINE_POS_END);
+		} break;
+		default:
+			JX_CHECK(false, "Unknown pipeline step kind");
+			break;
+		}
+
+		if (!res) {
+			jx_mir_pipelineDestroy(ctx, pipeline);
+			return NULL;
+		}
+	}
+
+	JX_CHECK(jx_mir_pipelineIsValid(ctx, pipeline), "Invalid pipeline preset!");
+
+	return pipeline;
+}
+
+void jx_mir_pipelineDestroy(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline)
+{
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = 0; iStep < numSteps; ++iStep) {
+		jmir_pipelineStepDestroy(ctx, &pipeline->m_StepArr[iStep]);
+	}
+	jx_array_free(pipeline->m_StepArr);
+
+	JX_FREE(ctx->m_Allocator, pipeline);
+}
+
+uint32_t jx_mir_pipelineGetNumSteps(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline)
+{
+	return (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+}
+
+bool jx_mir_pipelineInsertPass(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos, jx_mir_pass_kind kind, uint32_t flags)
+{
+	if ((uint32_t)kind >= JMIR_PASS_COUNT) {
+		return false;
+	}
+
+	const jmir_pass_desc_t* desc = &kPassDesc[kind];
+
+	jmir_pipeline_step_t step = {
+		.m_Kind = JMIR_PIPELINE_STEP_PASS,
+		.m_PassKind = kind,
+		.m_Flags = flags,
+		.m_MaxIterations = 1,
+	};
+
+	step.m_FuncPass = jmir_funcPassCreate(ctx, desc->m_Name, desc->m_FuncPassCtor, NULL);
+	if (!step.m_FuncPass) {
+		return false;
+	}
+
+	if (!jmir_pipelineInsertStep(ctx, pipeline, pos, &step)) {
+		jmir_pipelineStepDestroy(ctx, &step);
+		return false;
+	}
+
+	return true;
+}
+
+bool jx_mir_pipelineInsertLoopBegin(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos, uint32_t maxIterations)
+{
+	if (maxIterations == 0) {
+		return false;
+	}
+
+	jmir_pipeline_step_t step = {
+		.m_Kind = JMIR_PIPELINE_STEP_LOOP_BEGIN,
+		.m_PassKind = JMIR_PASS_COUNT,
+		.m_MaxIterations = maxIterations,
+	};
+
+	return jmir_pipelineInsertStep(ctx, pipeline, pos, &step);
+}
+
+bool jx_mir_pipelineInsertLoopEnd(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos)
+{
+	jmir_pipeline_step_t step = {
+		.m_Kind = JMIR_PIPELINE_STEP_LOOP_END,
+		.m_PassKind = JMIR_PASS_COUNT,
+	};
+
+	return jmir_pipelineInsertStep(ctx, pipeline, pos, &step);
+}
+
+void jx_mir_pipelineRemoveStep(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos)
+{
+	if (pos >= (uint32_t)jx_array_sizeu(pipeline->m_StepArr)) {
+		return;
+	}
+
+	jmir_pipelineStepDestroy(ctx, &pipeline->m_StepArr[pos]);
+	jx_array_del(pipeline->m_StepArr, pos);
+}
+
+void jx_mir_pipelineMoveStep(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t from, uint32_t to)
+{
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	if (from >= numSteps || to >= numSteps || from == to) {
+		return;
+	}
+
+	jmir_pipeline_step_t step = pipeline->m_StepArr[from];
+	jx_array_del(pipeline->m_StepArr, from);
+	jx_array_insert(pipeline->m_StepArr, to, step);
+}
+
+bool jx_mir_pipelineSetMaxIterations(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos, uint32_t maxIterations)
+{
+	if (pos >= (uint32_t)jx_array_sizeu(pipeline->m_StepArr) || maxIterations == 0) {
+		return false;
+	}
+
+	jmir_pipeline_step_t* step = &pipeline->m_StepArr[pos];
+	if (step->m_Kind != JMIR_PIPELINE_STEP_LOOP_BEGIN) {
+		return false;
+	}
+
+	step->m_MaxIterations = maxIterations;
+
+	return true;
+}
+
+bool jx_mir_pipelineSetPassOption(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos, const char* name, int64_t value)
+{
+	if (pos >= (uint32_t)jx_array_sizeu(pipeline->m_StepArr)) {
+		return false;
+	}
+
+	jmir_pipeline_step_t* step = &pipeline->m_StepArr[pos];
+	jx_mir_function_pass_t* pass = step->m_FuncPass;
+	if (!pass || !pass->setOption) {
+		return false;
+	}
+
+	if (!pass->setOption(pass->m_Inst, name, value)) {
+		return false;
+	}
+
+	step->m_OptionsHash = jx_hashFNV1a(name, jx_strlen(name), step->m_OptionsHash, 0);
+	step->m_OptionsHash = jx_hashFNV1a(&value, sizeof(int64_t), step->m_OptionsHash, 0);
+
+	return true;
+}
+
+bool jx_mir_pipelineIsValid(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline)
+{
+	uint32_t depth = 0;
+	uint32_t numRegAllocs = 0;
+	uint32_t passCount[JMIR_PASS_COUNT] = { 0 };
+
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = 0; iStep < numSteps; ++iStep) {
+		const jmir_pipeline_step_t* step = &pipeline->m_StepArr[iStep];
+		switch (step->m_Kind) {
+		case JMIR_PIPELINE_STEP_PASS: {
+			const uint32_t descFlags = kPassDesc[step->m_PassKind].m_Flags;
+			if ((descFlags & JMIR_PASS_DESC_FLAGS_LAST_Msk) != 0 && iStep != numSteps - 1) {
+				return false;
+			}
+
+			if (step->m_PassKind == JMIR_PASS_REG_ALLOC) {
+				if (depth != 0) {
+					return false;
+				}
+				++numRegAllocs;
+			} else if ((descFlags & JMIR_PASS_DESC_FLAGS_PRE_RA_Msk) != 0 && numRegAllocs != 0) {
+				return false;
+			} else if ((descFlags & JMIR_PASS_DESC_FLAGS_POST_RA_Msk) != 0 && numRegAllocs == 0) {
+				return false;
+			}
+
+			++passCount[step->m_PassKind];
+		} break;
+		case JMIR_PIPELINE_STEP_LOOP_BEGIN: {
+			if (step->m_MaxIterations == 0) {
+				return false;
+			}
+			++depth;
+		} break;
+		case JMIR_PIPELINE_STEP_LOOP_END: {
+			if (depth == 0) {
+				return false;
+			}
+			--depth;
+		} break;
+		default:
+			return false;
+		}
+	}
+
+	if (depth != 0 || numRegAllocs != 1) {
+		return false;
+	}
+
+	for (uint32_t iPass = 0; iPass < JMIR_PASS_COUNT; ++iPass) {
+		if ((kPassDesc[iPass].m_Flags & JMIR_PASS_DESC_FLAGS_REQUIRED_Msk) != 0 && passCount[iPass] == 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint64_t jx_mir_pipelineHash(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline)
+{
+	uint64_t hash = 0;
+
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = 0; iStep < numSteps; ++iStep) {
+		const jmir_pipeline_step_t* step = &pipeline->m_StepArr[iStep];
+		const uint64_t stepData[] = {
+			(uint64_t)step->m_Kind,
+			(uint64_t)step->m_PassKind,
+			(uint64_t)step->m_Flags,
+			(uint64_t)step->m_MaxIterations,
+			step->m_OptionsHash,
+		};
+		hash = jx_hashFNV1a(stepData, sizeof(stepData), hash, 0);
+	}
+
+	return hash;
+}
+
+void jx_mir_pipelinePrint(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, jx_string_buffer_t* sb)
+{
+	uint32_t depth = 0;
+
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = 0; iStep < numSteps; ++iStep) {
+		const jmir_pipeline_step_t* step = &pipeline->m_StepArr[iStep];
+		if (step->m_Kind == JMIR_PIPELINE_STEP_LOOP_END && depth != 0) {
+			--depth;
+		}
+
+		jx_strbuf_printf(sb, "%3u: ", iStep);
+		for (uint32_t i = 0; i < depth; ++i) {
+			jx_strbuf_printf(sb, "  ");
+		}
+
+		switch (step->m_Kind) {
+		case JMIR_PIPELINE_STEP_PASS: {
+			jx_strbuf_printf(sb, "%s%s\n"
+				, kPassDesc[step->m_PassKind].m_Name
+				, (step->m_Flags & JMIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Msk) != 0 ? " [if changed]" : ""
+			);
+		} break;
+		case JMIR_PIPELINE_STEP_LOOP_BEGIN: {
+			jx_strbuf_printf(sb, "loop (max %u iterations) {\n", step->m_MaxIterations);
+			++depth;
+		} break;
+		case JMIR_PIPELINE_STEP_LOOP_END: {
+			jx_strbuf_printf(sb, "}\n");
+		} break;
+		default:
+			JX_CHECK(false, "Unknown pipeline step kind");
+			break;
+		}
+	}
+}
+
+uint64_t jx_mir_funcGetFingerprint(jx_mir_context_t* ctx, const char* funcName, uint64_t irFingerprint)
+{
+	if (irFingerprint == 0) {
+		return 0;
+	}
+
+	// NOTE: The context flags change the frame layout and the instruction encodings.
+	jx_mir_pipeline_t* pipeline = jmir_getFuncPipeline(ctx, funcName);
+	uint64_t fingerprint = jx_hashFNV1a(&(uint64_t){ jx_mir_pipelineHash(ctx, pipeline) }, sizeof(uint64_t), irFingerprint, 0);
+	fingerprint = jx_hashFNV1a(&ctx->m_Flags, sizeof(uint32_t), fingerprint, 0);
+
+	// NOTE: 0 means unknown.
+	return fingerprint != 0
+		? fingerprint
+		: 1
+		;
+}
+
 jx_mir_function_proto_t* jx_mir_funcProto(jx_mir_context_t* ctx, jx_mir_type_kind retType, uint32_t numArgs, jx_mir_type_kind* args, uint32_t flags)
 {
 	jx_mir_function_proto_t* key = &(jx_mir_function_proto_t){
@@ -501,6 +1023,17 @@ jx_mir_function_t* jx_mir_funcBegin(jx_mir_context_t* ctx, const char* name, jx_
 	func->m_Name = jx_strdup(name, ctx->m_LinearAllocator);
 	func->m_Prototype = proto;
 
+	// NOTE: Incoming stack arguments and the vararg shadow space are addressed relative 
+	// to RBP so keep the frame pointer in such functions.
+	const bool needsFramePointer = false
+		|| (ctx->m_Flags & JMIR_CONTEXT_FLAGS_KEEP_FRAME_POINTER_Msk) != 0
+		|| (proto->m_Flags & JMIR_FUNC_PROTO_FLAGS_VARARG_Msk) != 0
+		|| proto->m_NumArgs > JX_COUNTOF(kMIRFuncArgIReg)
+		;
+	if (needsFramePointer) {
+		func->m_Flags |= JMIR_FUNC_FLAGS_FRAME_POINTER_Msk;
+	}
+
 	jx_mir_basic_block_t* entryBlock = jx_mir_bbAlloc(ctx);
 
 	const uint32_t numArgs = proto->m_NumArgs;
@@ -555,91 +1088,134 @@ void jx_mir_funcEnd(jx_mir_context_t* ctx, jx_mir_function_t* func)
 	jx_mir_funcUpdateCFG(ctx, func);
 
 	{
-		jmir_funcPassApply(ctx, ctx->m_FuncPass_removeFallthroughJmp, func);
-		jmir_funcPassApply(ctx, ctx->m_FuncPass_simplifyCondJmp, func);
-		jmir_funcPassApply(ctx, ctx->m_FuncPass_simplifyCFG, func);
+		jx_mir_pipeline_t* pipeline = jmir_getFuncPipeline(ctx, func->m_Name);
+		jmir_pipelineRunSteps(ctx, pipeline, 0, (uint32_t)jx_array_sizeu(pipeline->m_StepArr), func);
 
-#if 0
-		{
-			jx_string_buffer_t* sb = jx_strbuf_create(ctx->m_Allocator);
-			jx_strbuf_printf(sb, "%s pre-instrCombine\n", func->m_Name);
-			jx_mir_funcPrint(ctx, func, sb);
-			jx_strbuf_nullTerminate(sb);
-			JX_SYS_LOG_INFO(NULL, "\n%s", jx_strbuf_getString(sb, NULL));
-			jx_strbuf_destroy(sb);
-		}
-#endif
+		// NOTE: Don't run any other pass which might add 
+		// new virtual registers to the function. 
+	}
 
-		uint32_t numIter = 0;
-		bool changed = true;
-		while (changed && numIter < 5) {
-			changed = jmir_funcPassApply(ctx, ctx->m_FuncPass_instrCombine, func);
-			changed = jmir_funcPassApply(ctx, ctx->m_FuncPass_deadCodeElimination, func) || changed;
-			changed = jmir_funcPassApply(ctx, ctx->m_FuncPass_peephole, func) || changed;
-			changed = jmir_funcPassApply(ctx, ctx->m_FuncPass_deadCodeElimination, func) || changed;
-			++numIter;
+	// Collect all callee-saved registers used by the function.
+	const bool hasFramePointer = (func->m_Flags & JMIR_FUNC_FLAGS_FRAME_POINTER_Msk) != 0;
+	uint32_t savedRegs[JMIR_REG_CLASS_COUNT] = { 0 };
+	for (uint32_t iReg = 0; iReg < JX_COUNTOF(kMIRFuncCalleeSavedIReg); ++iReg) {
+		jx_mir_reg_t reg = kMIRFuncCalleeSavedIReg[iReg];
+		if (hasFramePointer && reg.m_ID == JMIR_HWREGID_BP) {
+			// NOTE: Saved by the prologue.
+			continue;
 		}
 
-#if 0
-		{
-//			jx_mir_funcRenumberVirtualRegs(ctx, func);
-			jx_string_buffer_t* sb = jx_strbuf_create(ctx->m_Allocator);
-			jx_strbuf_printf(sb, "%s pre-RA\n", func->m_Name);
-			jx_mir_funcPrint(ctx, func, sb);
-			jx_strbuf_nullTerminate(sb);
-			JX_SYS_LOG_INFO(NULL, "\n%s", jx_strbuf_getString(sb, NULL));
-			jx_strbuf_destroy(sb);
+		savedRegs[JMIR_REG_CLASS_GP] |= func->m_UsedHWRegs[JMIR_REG_CLASS_GP] & (1u << reg.m_ID);
+	}
+	for (uint32_t iReg = 0; iReg < JX_COUNTOF(kMIRFuncCalleeSavedFReg); ++iReg) {
+		jx_mir_reg_t reg = kMIRFuncCalleeSavedFReg[iReg];
+		savedRegs[JMIR_REG_CLASS_XMM] |= func->m_UsedHWRegs[JMIR_REG_CLASS_XMM] & (1u << reg.m_ID);
+	}
+
+	// Shrink-wrapping: Save the registers in the block which dominates all their uses.
+	// If that's the entry block, GP registers are pushed/popped by the prologue/epilogue.
+	// Otherwise they are stored into stack slots, because the stack objects are addressed 
+	// relative to RSP which cannot change after the prologue.
+	jx_mir_basic_block_t* entryBlock = func->m_BasicBlockListHead;
+	jx_mir_basic_block_t* saveBB = (savedRegs[JMIR_REG_CLASS_GP] | savedRegs[JMIR_REG_CLASS_XMM]) != 0
+		? jmir_funcFindCalleeSavedRegsSaveBlock(ctx, func, savedRegs)
+		: entryBlock
+		;
+	const bool pushCalleeSavedIRegs = saveBB == entryBlock;
+
+	jx_mir_operand_t* gpRegStackSlot[JX_COUNTOF(kMIRFuncCalleeSavedIReg)] = { 0 };
+	jx_mir_operand_t* xmmRegStackSlot[JX_COUNTOF(kMIRFuncCalleeSavedFReg)] = { 0 };
+	uint32_t numPushedRegs = hasFramePointer ? 1 : 0;
+	for (uint32_t iReg = 0; iReg < JX_COUNTOF(kMIRFuncCalleeSavedIReg); ++iReg) {
+		jx_mir_reg_t reg = kMIRFuncCalleeSavedIReg[iReg];
+		if ((savedRegs[JMIR_REG_CLASS_GP] & (1u << reg.m_ID)) != 0) {
+			if (pushCalleeSavedIRegs) {
+				++numPushedRegs;
+			} else {
+				gpRegStackSlot[iReg] = jx_mir_opStackObj(ctx, func, JMIR_TYPE_I64, 8, 8);
+			}
 		}
-#endif
+	}
+	for (uint32_t iReg = 0; iReg < JX_COUNTOF(kMIRFuncCalleeSavedFReg); ++iReg) {
+		jx_mir_reg_t reg = kMIRFuncCalleeSavedFReg[iReg];
+		if ((savedRegs[JMIR_REG_CLASS_XMM] & (1u << reg.m_ID)) != 0) {
+			xmmRegStackSlot[iReg] = jx_mir_opStackObj(ctx, func, JMIR_TYPE_F128, 16, 16);
+		}
+	}
 
-		jmir_funcPassApply(ctx, ctx->m_FuncPass_regAlloc, func);
-		jmir_funcPassApply(ctx, ctx->m_FuncPass_removeRedundantMoves, func);
-		jmir_funcPassApply(ctx, ctx->m_FuncPass_redundantConstElimination, func);
+	// Restore the registers in all exit blocks dominated by the save block. The rest of the 
+	// exit blocks are never reached after the registers have been saved (see jmir_bbIsValidSaveBlock()).
+	// NOTE: Collect the blocks before inserting any instructions because that invalidates
+	// the dominator tree.
+	jx_mir_basic_block_t** restoreBBArr = (jx_mir_basic_block_t**)jx_array_create(ctx->m_Allocator);
+	{
+		jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
+		while (bb) {
+			jx_mir_instruction_t* firstTerminator = jx_mir_bbGetFirstTerminatorInstr(ctx, bb);
+			const bool restoreRegs = true
+				&& firstTerminator
+				&& (firstTerminator->m_OpCode == JMIR_OP_RET || firstTerminator->m_OpCode == JMIR_OP_TAILCALL)
+				&& (saveBB == entryBlock || jx_mir_bbDominates(ctx, saveBB, bb))
+				;
+			if (restoreRegs) {
+				jx_array_push_back(restoreBBArr, bb);
+			}
 
-#if 0
-		{
-			jx_string_buffer_t* sb = jx_strbuf_create(ctx->m_Allocator);
-			jx_strbuf_printf(sb, "%s post-RA\n", func->m_Name);
-			jx_mir_funcPrint(ctx, func, sb);
-			jx_strbuf_nullTerminate(sb);
-			JX_SYS_LOG_INFO(NULL, "\n%s", jx_strbuf_getString(sb, NULL));
-			jx_strbuf_destroy(sb);
+			bb = bb->m_Next;
 		}
-#endif
 
-		jmir_funcPassApply(ctx, ctx->m_FuncPass_simplifyCondJmp, func);
-	
-		// NOTE: Don't run any other pass which might add 
-		// new virtual registers to the function. 
+		const uint32_t numRestoreBBs = (uint32_t)jx_array_sizeu(restoreBBArr);
+		for (uint32_t iBB = 0; iBB < numRestoreBBs; ++iBB) {
+			jx_mir_basic_block_t* bb = restoreBBArr[iBB];
+			jx_mir_instruction_t* firstTerminator = jx_mir_bbGetFirstTerminatorInstr(ctx, bb);
+
+			// Restore all callee-saved GP registers from the stack.
+			for (uint32_t iReg = 0; iReg < JX_COUNTOF(kMIRFuncCalleeSavedIReg); ++iReg) {
+				if (gpRegStackSlot[iReg]) {
+					jx_mir_reg_t reg = kMIRFuncCalleeSavedIReg[iReg];
+					jx_mir_bbInsertInstrBefore(ctx, bb, firstTerminator, jx_mir_mov(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_I64, reg), gpRegStackSlot[iReg]));
+				}
+			}
+
+			// Restore all callee-saved FP registers from the stack.
+			for (uint32_t iReg = 0; iReg < JX_COUNTOF(kMIRFuncCalleeSavedFReg); ++iReg) {
+				if (xmmRegStackSlot[iReg]) {
+					jx_mir_reg_t reg = kMIRFuncCalleeSavedFReg[iReg];
+					jx_mir_bbInsertInstrBefore(ctx, bb, firstTerminator, jx_mir_movaps(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_F128, reg), xmmRegStackSlot[iReg]));
+				}
+			}
+		}
 	}
+	jx_array_free(restoreBBArr);
 
-	// Store all callee-saved registers used by the function on the stack.
-	jx_mir_operand_t* gpRegStackSlot[JX_COUNTOF(kMIRFuncCalleeSavedIReg)] = { 0 };
-	jx_mir_operand_t* xmmRegStackSlot[JX_COUNTOF(kMIRFuncCalleeSavedFReg)] = { 0 };
+	// Store all callee-saved registers which aren't pushed by the prologue at the start of the save block.
+	// NOTE: All prologue instructions are prepended to their blocks so their frame events are recorded
+	// in reverse order (see below).
+	jx_mir_frame_info_t* frameInfo = func->m_FrameInfo;
+	jx_array_resize(frameInfo->m_EventArr, 0);
+	frameInfo->m_SaveBB = saveBB;
 	for (uint32_t iReg = 0; iReg < JX_COUNTOF(kMIRFuncCalleeSavedIReg); ++iReg) {
-		jx_mir_reg_t reg = kMIRFuncCalleeSavedIReg[iReg];
-		if ((func->m_UsedHWRegs[JMIR_REG_CLASS_GP] & (1u << reg.m_ID)) != 0) {
-			jx_mir_operand_t* stackSlot = jx_mir_opStackObj(ctx, func, JMIR_TYPE_I64, 8, 8);
-			jx_mir_bbPrependInstr(ctx, func->m_BasicBlockListHead, jx_mir_mov(ctx, stackSlot, jx_mir_opHWReg(ctx, func, JMIR_TYPE_I64, reg)));
-			gpRegStackSlot[iReg] = stackSlot;
+		if (gpRegStackSlot[iReg]) {
+			jx_mir_reg_t reg = kMIRFuncCalleeSavedIReg[iReg];
+			jx_mir_instruction_t* saveInstr = jx_mir_mov(ctx, gpRegStackSlot[iReg], jx_mir_opHWReg(ctx, func, JMIR_TYPE_I64, reg));
+			jx_mir_bbPrependInstr(ctx, saveBB, saveInstr);
+			jmir_frameAddEvent(frameInfo, JMIR_FRAME_EVENT_SAVE_REG, saveInstr, reg, (uint32_t)gpRegStackSlot[iReg]->u.m_MemRef->m_Displacement);
 		}
 	}
 	for (uint32_t iReg = 0; iReg < JX_COUNTOF(kMIRFuncCalleeSavedFReg); ++iReg) {
-		jx_mir_reg_t reg = kMIRFuncCalleeSavedFReg[iReg];
-		if ((func->m_UsedHWRegs[JMIR_REG_CLASS_XMM] & (1u << reg.m_ID)) != 0) {
-			jx_mir_operand_t* stackSlot = jx_mir_opStackObj(ctx, func, JMIR_TYPE_F128, 16, 16);
-			jx_mir_bbPrependInstr(ctx, func->m_BasicBlockListHead, jx_mir_movaps(ctx, stackSlot, jx_mir_opHWReg(ctx, func, JMIR_TYPE_F128, reg)));
-			xmmRegStackSlot[iReg] = stackSlot;
+		if (xmmRegStackSlot[iReg]) {
+			jx_mir_reg_t reg = kMIRFuncCalleeSavedFReg[iReg];
+			jx_mir_instruction_t* saveInstr = jx_mir_movaps(ctx, xmmRegStackSlot[iReg], jx_mir_opHWReg(ctx, func, JMIR_TYPE_F128, reg));
+			jx_mir_bbPrependInstr(ctx, saveBB, saveInstr);
+			jmir_frameAddEvent(frameInfo, JMIR_FRAME_EVENT_SAVE_REG, saveInstr, reg, (uint32_t)xmmRegStackSlot[iReg]->u.m_MemRef->m_Displacement);
 		}
 	}
 
 	// Insert prologue/epilogue
-	jx_mir_frame_info_t* frameInfo = func->m_FrameInfo;
-	jmir_frameFinalize(ctx, frameInfo);
+	jmir_frameFinalize(ctx, frameInfo, numPushedRegs);
 
 	{
 		// NOTE: Prepend prologue instructions in reverse order.
-		jx_mir_basic_block_t* entryBlock = func->m_BasicBlockListHead;
 		if ((func->m_Prototype->m_Flags & JMIR_FUNC_PROTO_FLAGS_VARARG_Msk) != 0) {
 			// Store register operands into their shadow space.
 			for (uint32_t iArgReg = 0; iArgReg < JX_COUNTOF(kMIRFuncArgIReg); ++iArgReg) {
@@ -654,36 +1230,68 @@ void jx_mir_funcEnd(jx_mir_context_t* ctx, jx_mir_function_t* func)
 		}
 
 		if (frameInfo->m_Size != 0) {
-			jx_mir_bbPrependInstr(ctx, entryBlock, jx_mir_sub(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_SP), jx_mir_opIConst(ctx, func, JMIR_TYPE_I32, (int64_t)frameInfo->m_Size)));
+			jx_mir_instruction_t* allocInstr = jx_mir_sub(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_SP), jx_mir_opIConst(ctx, func, JMIR_TYPE_I32, (int64_t)frameInfo->m_Size));
+			jx_mir_bbPrependInstr(ctx, entryBlock, allocInstr);
+			jmir_frameAddEvent(frameInfo, JMIR_FRAME_EVENT_ALLOC, allocInstr, kMIRRegGP_SP, frameInfo->m_Size);
+		}
+		if (pushCalleeSavedIRegs) {
+			for (uint32_t iReg = JX_COUNTOF(kMIRFuncCalleeSavedIReg); iReg > 0; --iReg) {
+				jx_mir_reg_t reg = kMIRFuncCalleeSavedIReg[iReg - 1];
+				if ((savedRegs[JMIR_REG_CLASS_GP] & (1u << reg.m_ID)) != 0) {
+					jx_mir_instruction_t* pushInstr = jx_mir_push(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_I64, reg));
+					jx_mir_bbPrependInstr(ctx, entryBlock, pushInstr);
+					jmir_frameAddEvent(frameInfo, JMIR_FRAME_EVENT_PUSH_REG, pushInstr, reg, 0);
+				}
+			}
+		}
+		if (hasFramePointer) {
+			// NOTE: rsp doesn't change after the prologue so setting up rbp isn't an event
+			// an unwinder needs to know about.
+			jx_mir_instruction_t* pushInstr = jx_mir_push(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_BP));
+			jx_mir_bbPrependInstr(ctx, entryBlock, jx_mir_mov(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_BP), jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_SP)));
+			jx_mir_bbPrependInstr(ctx, entryBlock, pushInstr);
+			jmir_frameAddEvent(frameInfo, JMIR_FRAME_EVENT_PUSH_REG, pushInstr, kMIRRegGP_BP, 0);
+		}
+
+		// Put the frame events in execution order. Since the save block is either the entry block
+		// (where the stores follow the prologue) or a block dominated by it, this is also the order
+		// the instructions appear in the final code.
+		const uint32_t numEvents = (uint32_t)jx_array_sizeu(frameInfo->m_EventArr);
+		for (uint32_t iEvent = 0; iEvent < numEvents / 2; ++iEvent) {
+			jx_mir_frame_event_t tmp = frameInfo->m_EventArr[iEvent];
+			frameInfo->m_EventArr[iEvent] = frameInfo->m_EventArr[numEvents - 1 - iEvent];
+			frameInfo->m_EventArr[numEvents - 1 - iEvent] = tmp;
 		}
-		jx_mir_bbPrependInstr(ctx, entryBlock, jx_mir_mov(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_BP), jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_SP)));
-		jx_mir_bbPrependInstr(ctx, entryBlock, jx_mir_push(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_BP)));
 
 		// Add epilogue code to each exit block.
 		jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
 		while (bb) {
 			jx_mir_instruction_t* firstTerminator = jx_mir_bbGetFirstTerminatorInstr(ctx, bb);
-			if (firstTerminator && firstTerminator->m_OpCode == JMIR_OP_RET) {
+			const bool isExitBlock = true
+				&& firstTerminator
+				&& (firstTerminator->m_OpCode == JMIR_OP_RET || firstTerminator->m_OpCode == JMIR_OP_TAILCALL)
+				;
+			if (isExitBlock) {
 				JX_CHECK(!firstTerminator->m_Next, "Unexpected instruction after ret!");
 
-				// Restore all callee-saved GP registers from the stack.
-				for (uint32_t iReg = 0; iReg < JX_COUNTOF(kMIRFuncCalleeSavedIReg); ++iReg) {
-					if (gpRegStackSlot[iReg]) {
-						jx_mir_reg_t reg = kMIRFuncCalleeSavedIReg[iReg];
-						jx_mir_bbInsertInstrBefore(ctx, bb, firstTerminator, jx_mir_mov(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_I64, reg), gpRegStackSlot[iReg]));
-					}
+				if (hasFramePointer && numPushedRegs == 1) {
+					jx_mir_bbInsertInstrBefore(ctx, bb, firstTerminator, jx_mir_mov(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_SP), jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_BP)));
+				} else if (frameInfo->m_Size != 0) {
+					jx_mir_bbInsertInstrBefore(ctx, bb, firstTerminator, jx_mir_add(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_SP), jx_mir_opIConst(ctx, func, JMIR_TYPE_I32, (int64_t)frameInfo->m_Size)));
 				}
 
-				// Restore all callee-saved FP registers from the stack.
-				for (uint32_t iReg = 0; iReg < JX_COUNTOF(kMIRFuncCalleeSavedFReg); ++iReg) {
-					if (xmmRegStackSlot[iReg]) {
-						jx_mir_reg_t reg = kMIRFuncCalleeSavedFReg[iReg];
-						jx_mir_bbInsertInstrBefore(ctx, bb, firstTerminator, jx_mir_movaps(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_F128, reg), xmmRegStackSlot[iReg]));
+				if (pushCalleeSavedIRegs) {
+					for (uint32_t iReg = JX_COUNTOF(kMIRFuncCalleeSavedIReg); iReg > 0; --iReg) {
+						jx_mir_reg_t reg = kMIRFuncCalleeSavedIReg[iReg - 1];
+						if ((savedRegs[JMIR_REG_CLASS_GP] & (1u << reg.m_ID)) != 0) {
+							jx_mir_bbInsertInstrBefore(ctx, bb, firstTerminator, jx_mir_pop(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_I64, reg)));
+						}
 					}
 				}
 
-				jx_mir_bbInsertInstrBefore(ctx, bb, firstTerminator, jx_mir_mov(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_SP), jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_BP)));
-				jx_mir_bbInsertInstrBefore(ctx, bb, firstTerminator, jx_mir_pop(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_BP)));
+				if (hasFramePointer) {
+					jx_mir_bbInsertInstrBefore(ctx, bb, firstTerminator, jx_mir_pop(ctx, jx_mir_opHWReg(ctx, func, JMIR_TYPE_PTR, kMIRRegGP_BP)));
+				}
 			}
 
 			bb = bb->m_Next;
@@ -730,7 +1338,7 @@ void jx_mir_funcAppendBasicBlock(jx_mir_context_t* ctx, jx_mir_function_t* func,
 
 	func->m_BasicBlockListTail = bb;
 
-	func->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk);
+	func->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk | JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk);
 }
 
 void jx_mir_funcPrependBasicBlock(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_basic_block_t* bb)
@@ -750,7 +1358,7 @@ void jx_mir_funcPrependBasicBlock(jx_mir_context_t* ctx, jx_mir_function_t* func
 	}
 	func->m_BasicBlockListHead = bb;
 
-	func->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk);
+	func->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk | JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk);
 }
 
 bool jx_mir_funcRemoveBasicBlock(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_basic_block_t* bb)
@@ -781,7 +1389,7 @@ bool jx_mir_funcRemoveBasicBlock(jx_mir_context_t* ctx, jx_mir_function_t* func,
 	bb->m_Next = NULL;
 	bb->m_ID = UINT32_MAX;
 
-	func->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk);
+	func->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk | JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk);
 
 	return true;
 }
@@ -837,7 +1445,7 @@ bool jx_mir_funcUpdateCFG(jx_mir_context_t* ctx, jx_mir_function_t* func)
 				}
 
 				fallthroughToNextBlock = instr->m_OpCode != JMIR_OP_JMP;
-			} else if (instr->m_OpCode == JMIR_OP_RET) {
+			} else if (instr->m_OpCode == JMIR_OP_RET || instr->m_OpCode == JMIR_OP_TAILCALL) {
 				// Return.
 				fallthroughToNextBlock = false;
 				retFound = true;
@@ -1341,6 +1949,140 @@ bool jx_mir_funcUpdateSCCs(jx_mir_context_t* ctx, jx_mir_function_t* func)
 	return true;
 }
 
+// Dominator tree algorithm based on "A Simple, Fast Dominance Algorithm"
+// https://www.cs.tufts.edu/~nr/cs257/archive/keith-cooper/dom14.pdf
+// 
+// NOTE: Same as jx_ir_funcUpdateDomTree(). A non-zero m_RevPostOrderID marks 
+// a visited block.
+static void jmir_bbDFWalk(jx_mir_context_t* ctx, jx_mir_basic_block_t* bb, uint32_t* c)
+{
+	JX_CHECK(bb->m_RevPostOrderID == 0, "Basic block already visited!");
+	bb->m_RevPostOrderID = UINT32_MAX;
+
+	const uint32_t numSucc = (uint32_t)jx_array_sizeu(bb->m_SuccArr);
+	for (uint32_t iSucc = numSucc; iSucc > 0; --iSucc) {
+		jx_mir_basic_block_t* succ = bb->m_SuccArr[iSucc - 1];
+		if (succ->m_RevPostOrderID == 0) {
+			jmir_bbDFWalk(ctx, succ, c);
+		}
+	}
+
+	bb->m_RevPostOrderID = *c;
+	*c = *c - 1;
+}
+
+static jx_mir_basic_block_t* jmir_funcIDomIntersect(jx_mir_basic_block_t* b1, jx_mir_basic_block_t* b2)
+{
+	jx_mir_basic_block_t* finger1 = b1;
+	jx_mir_basic_block_t* finger2 = b2;
+	while (finger1 != finger2) {
+		while (finger1->m_RevPostOrderID > finger2->m_RevPostOrderID) {
+			finger1 = finger1->m_ImmDom;
+		}
+		while (finger2->m_RevPostOrderID > finger1->m_RevPostOrderID) {
+			finger2 = finger2->m_ImmDom;
+		}
+	}
+
+	return finger1;
+}
+
+bool jx_mir_funcUpdateDomTree(jx_mir_context_t* ctx, jx_mir_function_t* func)
+{
+	if ((func->m_Flags & JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk) != 0) {
+		return true;
+	}
+
+	if (!jx_mir_funcUpdateCFG(ctx, func)) {
+		return false;
+	}
+
+	TracyCZoneN(tracyCtx, "mir: Update Dom Tree", 1);
+
+	// Count the number of basic blocks (incl. unreachable blocks)
+	// and reset the RPO index.
+	uint32_t numBasicBlocks = 0;
+	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		bb->m_RevPostOrderID = 0;
+		++numBasicBlocks;
+		bb = bb->m_Next;
+	}
+
+	// Depth-First Search
+	uint32_t c = numBasicBlocks;
+	jmir_bbDFWalk(ctx, func->m_BasicBlockListHead, &c);
+
+	// Collect all basic blocks in reverse postorder. Unreachable blocks
+	// end up with a zero RPO index and no immediate dominator.
+	jx_mir_basic_block_t** bbRPO = (jx_mir_basic_block_t**)JX_ALLOC(ctx->m_Allocator, sizeof(jx_mir_basic_block_t*) * numBasicBlocks);
+	if (!bbRPO) {
+		TracyCZoneEnd(tracyCtx);
+		return false;
+	}
+	jx_memset(bbRPO, 0, sizeof(jx_mir_basic_block_t*) * numBasicBlocks);
+
+	bb = func->m_BasicBlockListHead;
+	while (bb) {
+		bb->m_ImmDom = NULL;
+		if (bb->m_RevPostOrderID != 0) {
+			JX_CHECK(bb->m_RevPostOrderID <= numBasicBlocks, "Invalid reverse postorder index.");
+			bbRPO[bb->m_RevPostOrderID - 1] = bb;
+		}
+		bb = bb->m_Next;
+	}
+
+	// The first reachable block in RPO is the entry block. If there are unreachable 
+	// blocks the RPO array starts with NULL entries.
+	const uint32_t firstRPOID = c;
+	JX_CHECK(bbRPO[firstRPOID] == func->m_BasicBlockListHead, "Expected entry block to be first in RPO");
+
+	// Build dominator tree iteratively
+	bb = func->m_BasicBlockListHead;
+	bb->m_ImmDom = bb;
+
+	bool changed = true;
+	while (changed) {
+		changed = false;
+
+		for (uint32_t iBB = firstRPOID + 1; iBB < numBasicBlocks; ++iBB) {
+			jx_mir_basic_block_t* bb = bbRPO[iBB];
+
+			// Find first processed predecessor of bb
+			jx_mir_basic_block_t* firstProcessedPred = NULL;
+			const uint32_t numPred = (uint32_t)jx_array_sizeu(bb->m_PredArr);
+			for (uint32_t iPred = 0; iPred < numPred; ++iPred) {
+				jx_mir_basic_block_t* pred = bb->m_PredArr[iPred];
+				if (pred->m_ImmDom) {
+					firstProcessedPred = pred;
+					break;
+				}
+			}
+
+			jx_mir_basic_block_t* newIDom = firstProcessedPred;
+			for (uint32_t iPred = 0; iPred < numPred; ++iPred) {
+				jx_mir_basic_block_t* pred = bb->m_PredArr[iPred];
+				if (pred != firstProcessedPred && pred->m_ImmDom) {
+					newIDom = jmir_funcIDomIntersect(pred, newIDom);
+				}
+			}
+
+			if (bb->m_ImmDom != newIDom) {
+				bb->m_ImmDom = newIDom;
+				changed = true;
+			}
+		}
+	}
+
+	JX_FREE(ctx->m_Allocator, bbRPO);
+
+	func->m_Flags |= JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk;
+
+	TracyCZoneEnd(tracyCtx);
+
+	return true;
+}
+
 uint32_t jx_mir_funcGetRegBitsetSize(jx_mir_context_t* ctx, jx_mir_function_t* func)
 {
 	return 0
@@ -1443,7 +2185,16 @@ bool jx_mir_funcSpillVirtualReg(jx_mir_context_t* ctx, jx_mir_function_t* func,
 	JX_CHECK(jx_mir_regIsValid(reg) && jx_mir_regIsVirtual(reg), "Trying to spill an invalid or a hw register!");
 
 	jx_mir_type_kind regType = reg.m_Class == JMIR_REG_CLASS_GP ? JMIR_TYPE_I64 : JMIR_TYPE_F128;
-	jx_mir_operand_t* stackSlot = jx_mir_opStackObj(ctx, func, regType, jx_mir_typeGetSize(regType), jx_mir_typeGetAlignment(regType));
+	jx_mir_operand_t* stackSlot = jmir_operandAlloc(ctx, JMIR_OPERAND_MEMORY_REF, regType);
+	if (!stackSlot) {
+		return false;
+	}
+
+	stackSlot->u.m_MemRef = jmir_frameAllocObj(ctx, func->m_FrameInfo, jx_mir_typeGetSize(regType), jx_mir_typeGetAlignment(regType), JMIR_STACK_SLOT_FLAGS_SPILL_Msk);
+
+	// Uses inside loops which only read the register get a single reload in the loop's 
+	// preheader. All remaining uses/defs are spilled below.
+	jmir_funcSplitVirtualRegAroundLoops(ctx, func, reg, stackSlot->u.m_MemRef);
 
 	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
 	while (bb) {
@@ -1552,10 +2303,209 @@ bool jx_mir_funcSpillVirtualReg(jx_mir_context_t* ctx, jx_mir_function_t* func,
 			instr = instrNext;
 		}
 
-		bb = bb->m_Next;
+		bb = bb->m_Next;
+	}
+
+	return true;
+}
+
+// Replaces the register with a fresh copy of its (only) definition right before each use.
+// The original definition is removed.
+bool jx_mir_funcRematerializeVirtualReg(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_reg_t reg, jx_mir_instruction_t* defInstr)
+{
+	JX_CHECK(jx_mir_regIsValid(reg) && jx_mir_regIsVirtual(reg), "Trying to rematerialize an invalid or a hw register!");
+	JX_CHECK(jx_mir_instrIsRematerializable(defInstr) && jx_mir_regEqual(defInstr->m_Operands[0]->u.m_Reg, reg), "Invalid definition instruction");
+
+	const jx_mir_type_kind regType = defInstr->m_Operands[0]->m_Type;
+	jx_mir_operand_t* src = defInstr->m_Operands[1];
+
+	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		jx_mir_instruction_t* instr = bb->m_InstrListHead;
+		while (instr) {
+			jx_mir_instruction_t* instrNext = instr->m_Next;
+
+			if (instr != defInstr) {
+				jmir_instrUpdateUseDefInfo(ctx, func, instr);
+				JX_CHECK(!jmir_instrDefsReg(instr, reg), "Rematerialized register has more than one definition!");
+
+				if (jmir_instrUsesReg(instr, reg)) {
+					jx_mir_operand_t* temp = jx_mir_opVirtualReg(ctx, func, regType);
+					jx_mir_instruction_t* rematInstr = defInstr->m_OpCode == JMIR_OP_LEA
+						? jx_mir_lea(ctx, temp, src)
+						: jx_mir_mov(ctx, temp, src)
+						;
+					jx_mir_bbInsertInstrBefore(ctx, bb, instr, rematInstr);
+					jmir_funcReplaceInstrVirtualReg(ctx, func, instr, reg, temp->u.m_Reg);
+				}
+			}
+
+			instr = instrNext;
+		}
+
+		bb = bb->m_Next;
+	}
+
+	jx_mir_bbRemoveInstr(ctx, defInstr->m_ParentBB, defInstr);
+	jx_mir_instrFree(ctx, defInstr);
+
+	return true;
+}
+
+// Finds all outermost natural loops with a preheader which use the register without 
+// redefining it. A reload is inserted at the end of the preheader and all uses inside 
+// the loop are replaced by the reloaded value, so the loop body is free of reloads if 
+// the new register gets a color.
+// 
+// NOTE: Loops with calls are skipped; the value would have to live in a callee-saved 
+// register across the call, so it's cheaper to reload it after each call. Registers which 
+// are themselves reloads are never split, otherwise spilling the new register on the next 
+// allocation round would split the same live range again.
+static void jmir_funcSplitVirtualRegAroundLoops(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_reg_t reg, jx_mir_memory_ref_t* stackSlot)
+{
+	if (!jx_mir_funcUpdateSCCs(ctx, func)) {
+		return;
+	}
+
+	bool isReload = true;
+	uint32_t numDefs = 0;
+	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		jx_mir_instruction_t* instr = bb->m_InstrListHead;
+		while (instr) {
+			jmir_instrUpdateUseDefInfo(ctx, func, instr);
+			if (jmir_instrDefsReg(instr, reg)) {
+				isReload = true
+					&& isReload
+					&& (instr->m_OpCode == JMIR_OP_MOV || instr->m_OpCode == JMIR_OP_MOVAPS)
+					&& instr->m_Operands[1]->m_Kind == JMIR_OPERAND_MEMORY_REF
+					&& jmir_frameIsSpillSlot(func->m_FrameInfo, instr->m_Operands[1]->u.m_MemRef)
+					;
+				++numDefs;
+			}
+
+			instr = instr->m_Next;
+		}
+
+		bb = bb->m_Next;
+	}
+
+	if (numDefs == 0 || isReload) {
+		return;
+	}
+
+	// NOTE: Inserting instructions invalidates the SCCs but doesn't free them, so it's 
+	// safe to keep walking the list.
+	jx_mir_scc_t* scc = func->m_SCCListHead;
+	while (scc) {
+		jx_mir_basic_block_t* preheader = scc->m_EntryNode
+			? jmir_sccGetPreheader(scc)
+			: NULL
+			;
+		if (preheader) {
+			const uint32_t numLoopBlocks = (uint32_t)jx_array_sizeu(scc->m_BasicBlockArr) + 1;
+
+			bool use = false;
+			bool def = false;
+			bool hasCall = false;
+			for (uint32_t iBB = 0; iBB < numLoopBlocks && !def && !hasCall; ++iBB) {
+				jx_mir_basic_block_t* loopBB = iBB == 0
+					? scc->m_EntryNode
+					: scc->m_BasicBlockArr[iBB - 1]
+					;
+
+				jx_mir_instruction_t* instr = loopBB->m_InstrListHead;
+				while (instr && !def && !hasCall) {
+					use = use || jmir_instrUsesReg(instr, reg);
+					def = jmir_instrDefsReg(instr, reg);
+					hasCall = instr->m_OpCode == JMIR_OP_CALL;
+					instr = instr->m_Next;
+				}
+			}
+
+			if (use && !def && !hasCall) {
+				const jx_mir_type_kind regType = reg.m_Class == JMIR_REG_CLASS_GP
+					? JMIR_TYPE_I64
+					: JMIR_TYPE_F128
+					;
+				jx_mir_operand_t* temp = jx_mir_opVirtualReg(ctx, func, regType);
+				jx_mir_operand_t* stackSlotTyped = jx_mir_opStackObjRel(ctx, func, regType, stackSlot, 0);
+				jx_mir_instruction_t* reloadInstr = regType == JMIR_TYPE_F128
+					? jx_mir_movaps(ctx, temp, stackSlotTyped)
+					: jx_mir_mov(ctx, temp, stackSlotTyped)
+					;
+
+				jx_mir_instruction_t* termInstr = jx_mir_bbGetFirstTerminatorInstr(ctx, preheader);
+				if (termInstr) {
+					jx_mir_bbInsertInstrBefore(ctx, preheader, termInstr, reloadInstr);
+				} else {
+					jx_mir_bbAppendInstr(ctx, preheader, reloadInstr);
+				}
+
+				for (uint32_t iBB = 0; iBB < numLoopBlocks; ++iBB) {
+					jx_mir_basic_block_t* loopBB = iBB == 0
+						? scc->m_EntryNode
+						: scc->m_BasicBlockArr[iBB - 1]
+						;
+
+					jx_mir_instruction_t* instr = loopBB->m_InstrListHead;
+					while (instr) {
+						if (jmir_instrUsesReg(instr, reg)) {
+							jmir_funcReplaceInstrVirtualReg(ctx, func, instr, reg, temp->u.m_Reg);
+							jmir_instrUpdateUseDefInfo(ctx, func, instr);
+						}
+
+						instr = instr->m_Next;
+					}
+				}
+			}
+		}
+
+		scc = scc->m_Next;
+	}
+}
+
+// Returns the only block outside the loop which jumps to the loop header, if that 
+// block has no other successors.
+static jx_mir_basic_block_t* jmir_sccGetPreheader(jx_mir_scc_t* scc)
+{
+	jx_mir_basic_block_t* header = scc->m_EntryNode;
+	jx_mir_basic_block_t* preheader = NULL;
+
+	const uint32_t numPreds = (uint32_t)jx_array_sizeu(header->m_PredArr);
+	for (uint32_t iPred = 0; iPred < numPreds; ++iPred) {
+		jx_mir_basic_block_t* pred = header->m_PredArr[iPred];
+		if (jmir_sccContainsBasicBlock(scc, pred)) {
+			continue;
+		}
+
+		if (preheader && preheader != pred) {
+			return NULL;
+		}
+
+		preheader = pred;
 	}
 
-	return true;
+	return preheader && jx_array_sizeu(preheader->m_SuccArr) == 1
+		? preheader
+		: NULL
+		;
+}
+
+static bool jmir_sccContainsBasicBlock(jx_mir_scc_t* scc, jx_mir_basic_block_t* bb)
+{
+	if (scc->m_EntryNode == bb) {
+		return true;
+	}
+
+	const uint32_t numBlocks = (uint32_t)jx_array_sizeu(scc->m_BasicBlockArr);
+	for (uint32_t iBB = 0; iBB < numBlocks; ++iBB) {
+		if (scc->m_BasicBlockArr[iBB] == bb) {
+			return true;
+		}
+	}
+
+	return false;
 }
 
 void jx_mir_funcPrint(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_string_buffer_t* sb)
@@ -1723,7 +2673,7 @@ bool jx_mir_bbAppendInstr(jx_mir_context_t* ctx, jx_mir_basic_block_t* bb, jx_mi
 	bb->m_InstrListTail = instr;
 
 	if (bb->m_ParentFunc) {
-		bb->m_ParentFunc->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk);
+		bb->m_ParentFunc->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk | JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk);
 	}
 
 	return true;
@@ -1747,7 +2697,7 @@ bool jx_mir_bbPrependInstr(jx_mir_context_t* ctx, jx_mir_basic_block_t* bb, jx_m
 	bb->m_InstrListHead = instr;
 
 	if (bb->m_ParentFunc) {
-		bb->m_ParentFunc->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk);
+		bb->m_ParentFunc->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk | JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk);
 	}
 
 	return true;
@@ -1776,7 +2726,7 @@ bool jx_mir_bbInsertInstrBefore(jx_mir_context_t* ctx, jx_mir_basic_block_t* bb,
 	}
 
 	if (bb->m_ParentFunc) {
-		bb->m_ParentFunc->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk);
+		bb->m_ParentFunc->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk | JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk);
 	}
 
 	return true;
@@ -1805,7 +2755,7 @@ bool jx_mir_bbInsertInstrAfter(jx_mir_context_t* ctx, jx_mir_basic_block_t* bb,
 	}
 
 	if (bb->m_ParentFunc) {
-		bb->m_ParentFunc->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk);
+		bb->m_ParentFunc->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk | JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk);
 	}
 
 	return true;
@@ -1839,7 +2789,7 @@ bool jx_mir_bbRemoveInstr(jx_mir_context_t* ctx, jx_mir_basic_block_t* bb, jx_mi
 	instr->m_Next = NULL;
 
 	if (bb->m_ParentFunc) {
-		bb->m_ParentFunc->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk);
+		bb->m_ParentFunc->m_Flags &= ~(JMIR_FUNC_FLAGS_CFG_VALID_Msk | JMIR_FUNC_FLAGS_SCC_VALID_Msk | JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk);
 	}
 
 	return true;
@@ -1866,6 +2816,22 @@ jx_mir_instruction_t* jx_mir_bbGetFirstTerminatorInstr(jx_mir_context_t* ctx, jx
 	return lastTerminatorInstr;
 }
 
+bool jx_mir_bbDominates(jx_mir_context_t* ctx, jx_mir_basic_block_t* dom, jx_mir_basic_block_t* bb)
+{
+	JX_UNUSED(ctx);
+	JX_CHECK((bb->m_ParentFunc->m_Flags & JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk) != 0, "Dominator tree not up to date!");
+
+	while (bb && bb != dom) {
+		jx_mir_basic_block_t* idom = bb->m_ImmDom;
+		bb = idom != bb
+			? idom
+			: NULL
+			;
+	}
+
+	return bb == dom;
+}
+
 jx_mir_operand_t* jx_mir_opVirtualReg(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_type_kind type)
 {
 	jx_mir_operand_t* operand = jmir_operandAlloc(ctx, JMIR_OPERAND_REGISTER, type);
@@ -1986,7 +2952,7 @@ jx_mir_operand_t* jx_mir_opStackObj(jx_mir_context_t* ctx, jx_mir_function_t* fu
 		return NULL;
 	}
 
-	operand->u.m_MemRef = jmir_frameAllocObj(ctx, func->m_FrameInfo, sz, alignment);
+	operand->u.m_MemRef = jmir_frameAllocObj(ctx, func->m_FrameInfo, sz, alignment, 0);
 
 	return operand;
 }
@@ -2377,7 +3343,8 @@ jx_mir_instruction_t* jx_mir_neg(jx_mir_context_t* ctx, jx_mir_operand_t* op)
 
 jx_mir_instruction_t* jx_mir_mul(jx_mir_context_t* ctx, jx_mir_operand_t* op)
 {
-	return NULL;
+	JX_CHECK(op->m_Kind != JMIR_OPERAND_CONST, "mul does not support immediate operands");
+	return jmir_instrAlloc1(ctx, JMIR_OP_MUL, op);
 }
 
 jx_mir_instruction_t* jx_mir_div(jx_mir_context_t* ctx, jx_mir_operand_t* op)
@@ -2391,6 +3358,12 @@ jx_mir_instruction_t* jx_mir_idiv(jx_mir_context_t* ctx, jx_mir_operand_t* op)
 	return jmir_instrAlloc1(ctx, JMIR_OP_IDIV, op);
 }
 
+jx_mir_instruction_t* jx_mir_imul1(jx_mir_context_t* ctx, jx_mir_operand_t* op)
+{
+	JX_CHECK(op->m_Kind != JMIR_OPERAND_CONST, "imul does not support immediate operands");
+	return jmir_instrAlloc1(ctx, JMIR_OP_IMUL1, op);
+}
+
 jx_mir_instruction_t* jx_mir_inc(jx_mir_context_t* ctx, jx_mir_operand_t* op)
 {
 	return NULL;
@@ -2459,17 +3432,48 @@ jx_mir_instruction_t* jx_mir_rcl(jx_mir_context_t* ctx, jx_mir_operand_t* op, jx
 
 jx_mir_instruction_t* jx_mir_ror(jx_mir_context_t* ctx, jx_mir_operand_t* op, jx_mir_operand_t* shift)
 {
-	return NULL;
+	return jmir_instrAlloc2(ctx, JMIR_OP_ROR, op, shift);
 }
 
 jx_mir_instruction_t* jx_mir_rol(jx_mir_context_t* ctx, jx_mir_operand_t* op, jx_mir_operand_t* shift)
 {
-	return NULL;
+	return jmir_instrAlloc2(ctx, JMIR_OP_ROL, op, shift);
+}
+
+jx_mir_instruction_t* jx_mir_bswap(jx_mir_context_t* ctx, jx_mir_operand_t* op)
+{
+	JX_CHECK(op->m_Kind == JMIR_OPERAND_REGISTER, "bswap expects a register operand.");
+	return jmir_instrAlloc1(ctx, JMIR_OP_BSWAP, op);
+}
+
+jx_mir_instruction_t* jx_mir_bsf(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src)
+{
+	return jmir_instrAlloc2(ctx, JMIR_OP_BSF, dst, src);
+}
+
+jx_mir_instruction_t* jx_mir_bsr(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src)
+{
+	return jmir_instrAlloc2(ctx, JMIR_OP_BSR, dst, src);
+}
+
+jx_mir_instruction_t* jx_mir_popcnt(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src)
+{
+	return jmir_instrAlloc2(ctx, JMIR_OP_POPCNT, dst, src);
+}
+
+jx_mir_instruction_t* jx_mir_lzcnt(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src)
+{
+	return jmir_instrAlloc2(ctx, JMIR_OP_LZCNT, dst, src);
+}
+
+jx_mir_instruction_t* jx_mir_tzcnt(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src)
+{
+	return jmir_instrAlloc2(ctx, JMIR_OP_TZCNT, dst, src);
 }
 
 jx_mir_instruction_t* jx_mir_cmovcc(jx_mir_context_t* ctx, jx_mir_condition_code cc, jx_mir_operand_t* dst, jx_mir_operand_t* src)
 {
-	return NULL;
+	return jmir_instrAlloc2(ctx, JMIR_OP_CMOVCC_BASE + cc, dst, src);
 }
 
 jx_mir_instruction_t* jx_mir_jcc(jx_mir_context_t* ctx, jx_mir_condition_code cc, jx_mir_operand_t* op)
@@ -2492,6 +3496,19 @@ jx_mir_instruction_t* jx_mir_call(jx_mir_context_t* ctx, jx_mir_operand_t* func,
 	return instr;
 }
 
+// Sibling call. Must be the last instruction of its basic block. The epilogue is 
+// inserted before it by jx_mir_funcEnd() and the call is emitted as a jmp.
+jx_mir_instruction_t* jx_mir_tailcall(jx_mir_context_t* ctx, jx_mir_operand_t* func, jx_mir_function_proto_t* proto)
+{
+	JX_CHECK(func->m_Kind == JMIR_OPERAND_EXTERNAL_SYMBOL, "Only direct tail calls are supported.");
+	jx_mir_instruction_t* instr = jmir_instrAlloc1(ctx, JMIR_OP_TAILCALL, func);
+	if (instr) {
+		instr->m_FuncProto = proto;
+	}
+
+	return instr;
+}
+
 jx_mir_instruction_t* jx_mir_push(jx_mir_context_t* ctx, jx_mir_operand_t* op)
 {
 	return jmir_instrAlloc1(ctx, JMIR_OP_PUSH, op);
@@ -2537,6 +3554,16 @@ jx_mir_instruction_t* jx_mir_movapd(jx_mir_context_t* ctx, jx_mir_operand_t* dst
 	return jmir_instrAlloc2(ctx, JMIR_OP_MOVAPD, dst, src);
 }
 
+jx_mir_instruction_t* jx_mir_movups(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src)
+{
+	return jmir_instrAlloc2(ctx, JMIR_OP_MOVUPS, dst, src);
+}
+
+jx_mir_instruction_t* jx_mir_movupd(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src)
+{
+	return jmir_instrAlloc2(ctx, JMIR_OP_MOVUPD, dst, src);
+}
+
 jx_mir_instruction_t* jx_mir_movd(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src)
 {
 	return jmir_instrAlloc2(ctx, JMIR_OP_MOVD, dst, src);
@@ -2773,14 +3800,26 @@ jx_mir_instruction_t* jx_mir_rsqrtss(jx_mir_context_t* ctx, jx_mir_operand_t* ds
 
 jx_mir_instruction_t* jx_mir_shufps(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src, uint8_t imm8)
 {
-	JX_NOT_IMPLEMENTED();
-	return NULL;
+	jx_mir_operand_t* imm = jmir_operandAlloc(ctx, JMIR_OPERAND_CONST, JMIR_TYPE_I8);
+	if (!imm) {
+		return NULL;
+	}
+
+	imm->u.m_ConstI64 = (int64_t)imm8;
+
+	return jmir_instrAlloc3(ctx, JMIR_OP_SHUFPS, dst, src, imm);
 }
 
 jx_mir_instruction_t* jx_mir_shufpd(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src, uint8_t imm8)
 {
-	JX_NOT_IMPLEMENTED();
-	return NULL;
+	jx_mir_operand_t* imm = jmir_operandAlloc(ctx, JMIR_OPERAND_CONST, JMIR_TYPE_I8);
+	if (!imm) {
+		return NULL;
+	}
+
+	imm->u.m_ConstI64 = (int64_t)imm8;
+
+	return jmir_instrAlloc3(ctx, JMIR_OP_SHUFPD, dst, src, imm);
 }
 
 jx_mir_instruction_t* jx_mir_sqrtps(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src)
@@ -2908,6 +3947,7 @@ static bool jmir_opcodeIsTerminator(uint32_t opcode)
 	return false
 		|| opcode == JMIR_OP_RET
 		|| opcode == JMIR_OP_JMP
+		|| opcode == JMIR_OP_TAILCALL
 		|| jx_mir_opcodeIsJcc(opcode)
 		;
 }
@@ -2986,6 +4026,32 @@ static inline void jmir_instrAddDef(jx_mir_instr_usedef_t* useDef, jx_mir_reg_t
 	useDef->m_Defs[useDef->m_NumDefs++] = reg;
 }
 
+static inline bool jmir_instrUsesReg(const jx_mir_instruction_t* instr, jx_mir_reg_t reg)
+{
+	const jx_mir_instr_usedef_t* useDef = &instr->m_UseDef;
+	const uint32_t numUses = useDef->m_NumUses;
+	for (uint32_t iUse = 0; iUse < numUses; ++iUse) {
+		if (jx_mir_regEqual(useDef->m_Uses[iUse], reg)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static inline bool jmir_instrDefsReg(const jx_mir_instruction_t* instr, jx_mir_reg_t reg)
+{
+	const jx_mir_instr_usedef_t* useDef = &instr->m_UseDef;
+	const uint32_t numDefs = useDef->m_NumDefs;
+	for (uint32_t iDef = 0; iDef < numDefs; ++iDef) {
+		if (jx_mir_regEqual(useDef->m_Defs[iDef], reg)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static bool jmir_instrUpdateUseDefInfo(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_instruction_t* instr)
 {
 	jx_mir_instr_usedef_t* annot = &instr->m_UseDef;
@@ -3023,6 +4089,8 @@ static bool jmir_instrUpdateUseDefInfo(jx_mir_context_t* ctx, jx_mir_function_t*
 	case JMIR_OP_MOVQ:
 	case JMIR_OP_MOVAPS:
 	case JMIR_OP_MOVAPD:
+	case JMIR_OP_MOVUPS:
+	case JMIR_OP_MOVUPD:
 	case JMIR_OP_CVTSI2SS:
 	case JMIR_OP_CVTSI2SD:
 	case JMIR_OP_CVTSS2SI:
@@ -3038,7 +4106,12 @@ static bool jmir_instrUpdateUseDefInfo(jx_mir_context_t* ctx, jx_mir_function_t*
 	case JMIR_OP_SQRTPS:
 	case JMIR_OP_SQRTSS:
 	case JMIR_OP_SQRTPD:
-	case JMIR_OP_SQRTSD: {
+	case JMIR_OP_SQRTSD:
+	case JMIR_OP_BSF:
+	case JMIR_OP_BSR:
+	case JMIR_OP_POPCNT:
+	case JMIR_OP_LZCNT:
+	case JMIR_OP_TZCNT: {
 		jx_mir_operand_t* src = instr->m_Operands[1];
 		if (src->m_Kind == JMIR_OPERAND_REGISTER) {
 			jmir_instrAddUse(annot, src->u.m_Reg);
@@ -3055,6 +4128,28 @@ static bool jmir_instrUpdateUseDefInfo(jx_mir_context_t* ctx, jx_mir_function_t*
 			jmir_instrAddUse(annot, dst->u.m_MemRef->m_IndexReg);
 		}
 	} break;
+	case JMIR_OP_BSWAP: {
+		jx_mir_operand_t* op = instr->m_Operands[0];
+		JX_CHECK(op->m_Kind == JMIR_OPERAND_REGISTER, "Expected register operand.");
+		jmir_instrAddUse(annot, op->u.m_Reg);
+		jmir_instrAddDef(annot, op->u.m_Reg);
+	} break;
+	case JMIR_OP_IMUL1:
+	case JMIR_OP_MUL: {
+		jx_mir_operand_t* op = instr->m_Operands[0];
+
+		jmir_instrAddUse(annot, kMIRRegGP_A);
+
+		if (op->m_Kind == JMIR_OPERAND_REGISTER) {
+			jmir_instrAddUse(annot, op->u.m_Reg);
+		} else if (op->m_Kind == JMIR_OPERAND_MEMORY_REF) {
+			jmir_instrAddUse(annot, op->u.m_MemRef->m_BaseReg);
+			jmir_instrAddUse(annot, op->u.m_MemRef->m_IndexReg);
+		}
+
+		jmir_instrAddDef(annot, kMIRRegGP_A);
+		jmir_instrAddDef(annot, kMIRRegGP_D);
+	} break;
 	case JMIR_OP_IDIV:
 	case JMIR_OP_DIV: {
 		jx_mir_operand_t* op = instr->m_Operands[0];
@@ -3087,6 +4182,23 @@ static bool jmir_instrUpdateUseDefInfo(jx_mir_context_t* ctx, jx_mir_function_t*
 
 		JX_CHECK(instr->m_Operands[2]->m_Kind == JMIR_OPERAND_CONST, "Expected constant operand.");
 	} break;
+	case JMIR_OP_SHUFPS:
+	case JMIR_OP_SHUFPD: {
+		jx_mir_operand_t* src = instr->m_Operands[1];
+		if (src->m_Kind == JMIR_OPERAND_REGISTER) {
+			jmir_instrAddUse(annot, src->u.m_Reg);
+		} else if (src->m_Kind == JMIR_OPERAND_MEMORY_REF) {
+			jmir_instrAddUse(annot, src->u.m_MemRef->m_BaseReg);
+			jmir_instrAddUse(annot, src->u.m_MemRef->m_IndexReg);
+		}
+
+		jx_mir_operand_t* dst = instr->m_Operands[0];
+		JX_CHECK(dst->m_Kind == JMIR_OPERAND_REGISTER, "Expected register operand.");
+		jmir_instrAddUse(annot, dst->u.m_Reg); // shuffles use both src and dst operands.
+		jmir_instrAddDef(annot, dst->u.m_Reg);
+
+		JX_CHECK(instr->m_Operands[2]->m_Kind == JMIR_OPERAND_CONST, "Expected constant operand.");
+	} break;
 	case JMIR_OP_ADD:
 	case JMIR_OP_SUB:
 	case JMIR_OP_IMUL:
@@ -3095,6 +4207,24 @@ static bool jmir_instrUpdateUseDefInfo(jx_mir_context_t* ctx, jx_mir_function_t*
 	case JMIR_OP_SAR:
 	case JMIR_OP_SHR:
 	case JMIR_OP_SHL: 
+	case JMIR_OP_ROL:
+	case JMIR_OP_ROR:
+	case JMIR_OP_CMOVO:
+	case JMIR_OP_CMOVNO:
+	case JMIR_OP_CMOVB:
+	case JMIR_OP_CMOVNB:
+	case JMIR_OP_CMOVE:
+	case JMIR_OP_CMOVNE:
+	case JMIR_OP_CMOVBE:
+	case JMIR_OP_CMOVNBE:
+	case JMIR_OP_CMOVS:
+	case JMIR_OP_CMOVNS:
+	case JMIR_OP_CMOVP:
+	case JMIR_OP_CMOVNP:
+	case JMIR_OP_CMOVL:
+	case JMIR_OP_CMOVNL:
+	case JMIR_OP_CMOVLE:
+	case JMIR_OP_CMOVNLE:
 	case JMIR_OP_ADDPS:
 	case JMIR_OP_ADDSS:
 	case JMIR_OP_ADDPD:
@@ -3195,7 +4325,8 @@ static bool jmir_instrUpdateUseDefInfo(jx_mir_context_t* ctx, jx_mir_function_t*
 		JX_CHECK(dst->m_Kind == JMIR_OPERAND_REGISTER, "lea destination operand expected to be a register.");
 		jmir_instrAddDef(annot, dst->u.m_Reg);
 	} break;
-	case JMIR_OP_CALL: {
+	case JMIR_OP_CALL:
+	case JMIR_OP_TAILCALL: {
 		jx_mir_operand_t* funcOp = instr->m_Operands[0];
 		if (funcOp->m_Kind == JMIR_OPERAND_REGISTER) {
 			jmir_instrAddUse(annot, funcOp->u.m_Reg);
@@ -3236,7 +4367,8 @@ static bool jmir_instrUpdateUseDefInfo(jx_mir_context_t* ctx, jx_mir_function_t*
 
 		// TODO: If the called function is not an external function we might be able 
 		// to def only the caller-saved regs touched by the function.
-		{
+		// NOTE: Tail calls never return to this function so they don't def anything.
+		if (instr->m_OpCode == JMIR_OP_CALL) {
 			const uint32_t numCallerSavedIRegs = JX_COUNTOF(kMIRFuncCallerSavedIReg);
 			for (uint32_t iReg = 0; iReg < numCallerSavedIRegs; ++iReg) {
 				jmir_instrAddDef(annot, kMIRFuncCallerSavedIReg[iReg]);
@@ -3354,6 +4486,33 @@ bool jx_mir_instrIsMovRegReg(jx_mir_instruction_t* instr)
 		;
 }
 
+// Returns true for instructions which define a virtual GP register from a constant 
+// or an address which doesn't depend on any other register, i.e. the instruction can 
+// be re-executed anywhere in the function without affecting the flags.
+bool jx_mir_instrIsRematerializable(jx_mir_instruction_t* instr)
+{
+	if (instr->m_NumOperands != 2) {
+		return false;
+	}
+
+	jx_mir_operand_t* dst = instr->m_Operands[0];
+	jx_mir_operand_t* src = instr->m_Operands[1];
+	if (dst->m_Kind != JMIR_OPERAND_REGISTER || !jx_mir_regIsVirtual(dst->u.m_Reg) || !jx_mir_regIsClass(dst->u.m_Reg, JMIR_REG_CLASS_GP)) {
+		return false;
+	}
+
+	if (instr->m_OpCode == JMIR_OP_MOV) {
+		return src->m_Kind == JMIR_OPERAND_CONST;
+	} else if (instr->m_OpCode == JMIR_OP_LEA) {
+		return false
+			|| src->m_Kind == JMIR_OPERAND_EXTERNAL_SYMBOL
+			|| jx_mir_opIsStackObj(src)
+			;
+	}
+
+	return false;
+}
+
 static jx_mir_operand_t* jmir_funcCreateArgument(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_basic_block_t* bb, uint32_t argID, jx_mir_type_kind argType)
 {
 	jx_mir_operand_t* vReg = jx_mir_opVirtualReg(ctx, func, argType);
@@ -3407,29 +4566,178 @@ static void jmir_funcFree(jx_mir_context_t* ctx, jx_mir_function_t* func)
 	}
 }
 
-static jx_mir_function_pass_t* jmir_funcPassCreate(jx_mir_context_t* ctx, jmirFuncPassCtorFunc ctorFunc, void* passConfig)
+static jx_mir_function_pass_t* jmir_funcPassCreate(jx_mir_context_t* ctx, const char* name, jmirFuncPassCtorFunc ctorFunc, void* passConfig)
 {
-	jx_mir_function_pass_t* pass = (jx_mir_function_pass_t*)JX_ALLOC(ctx->m_LinearAllocator, sizeof(jx_mir_function_pass_t));
+	// NOTE: Passes are owned by pipelines which can be created and destroyed at any time,
+	// so they are allocated from the main allocator instead of the linear allocator.
+	jx_mir_function_pass_t* pass = (jx_mir_function_pass_t*)JX_ALLOC(ctx->m_Allocator, sizeof(jx_mir_function_pass_t));
 	if (!pass) {
 		return NULL;
 	}
 
 	jx_memset(pass, 0, sizeof(jx_mir_function_pass_t));
 	if (!ctorFunc(pass, ctx->m_Allocator)) {
+		JX_FREE(ctx->m_Allocator, pass);
 		return NULL;
 	}
 
+	pass->m_Name = name;
+
 	return pass;
 }
 
 static void jmir_funcPassDestroy(jx_mir_context_t* ctx, jx_mir_function_pass_t* pass)
 {
 	pass->destroy(pass->m_Inst, ctx->m_Allocator);
+	JX_FREE(ctx->m_Allocator, pass);
 }
 
 static bool jmir_funcPassApply(jx_mir_context_t* ctx, jx_mir_function_pass_t* pass, jx_mir_function_t* func)
 {
-	return pass->run(pass->m_Inst, ctx, func);
+	if (!ctx->m_PassCallback) {
+		return pass->run(pass->m_Inst, ctx, func);
+	}
+
+	ctx->m_PassCallback(pass->m_Name, false, ctx->m_PassCallbackUserData);
+	const bool changed = pass->run(pass->m_Inst, ctx, func);
+	ctx->m_PassCallback(pass->m_Name, true, ctx->m_PassCallbackUserData);
+
+	return changed;
+}
+
+static void jmir_pipelineStepDestroy(jx_mir_context_t* ctx, jmir_pipeline_step_t* step)
+{
+	if (step->m_FuncPass) {
+		jmir_funcPassDestroy(ctx, step->m_FuncPass);
+		step->m_FuncPass = NULL;
+	}
+}
+
+static bool jmir_pipelineInsertStep(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos, const jmir_pipeline_step_t* step)
+{
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	if (pos == JMIR_PIPELINE_POS_END) {
+		pos = numSteps;
+	} else if (pos > numSteps) {
+		return false;
+	}
+
+	jx_array_insert(pipeline->m_StepArr, pos, *step);
+
+	return true;
+}
+
+// Returns the index of the LOOP_END step which matches the LOOP_BEGIN step at loopBegin.
+static uint32_t jmir_pipelineFindLoopEnd(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t loopBegin)
+{
+	JX_CHECK(pipeline->m_StepArr[loopBegin].m_Kind == JMIR_PIPELINE_STEP_LOOP_BEGIN, "Expected loop begin step");
+
+	uint32_t depth = 0;
+
+	const uint32_t numSteps = (uint32_t)jx_array_sizeu(pipeline->m_StepArr);
+	for (uint32_t iStep = loopBegin; iStep < numSteps; ++iStep) {
+		const jmir_pipeline_step_kind kind = pipeline->m_StepArr[iStep].m_Kind;
+		if (kind == JMIR_PIPELINE_STEP_LOOP_BEGIN) {
+			++depth;
+		} else if (kind == JMIR_PIPELINE_STEP_LOOP_END) {
+			--depth;
+			if (depth == 0) {
+				return iStep;
+			}
+		}
+	}
+
+	JX_CHECK(false, "Unbalanced pipeline loop");
+	return numSteps;
+}
+
+static uint32_t jmir_detectTargetFlags(void)
+{
+	const uint64_t cpuFeatures = jx_cpu_getFeatures();
+	if ((cpuFeatures & JX_CPU_FEATURE_AVX) == 0) {
+		return 0;
+	}
+
+	// NOTE: CPUID only reports that the CPU supports AVX. The OS must also save/restore
+	// the YMM state on context switches (OSXSAVE set and XCR0 bits 1 and 2 enabled).
+	int cpuInfo[4];
+	__cpuid(cpuInfo, 1);
+	const bool hasOSXSAVE = (cpuInfo[2] & (1 << 27)) != 0;
+	if (!hasOSXSAVE || (_xgetbv(0) & 0x06) != 0x06) {
+		return 0;
+	}
+
+	uint32_t flags = JMIR_CONTEXT_FLAGS_TARGET_AVX_Msk;
+	flags |= (cpuFeatures & JX_CPU_FEATURE_AVX2) != 0
+		? JMIR_CONTEXT_FLAGS_TARGET_AVX2_Msk
+		: 0
+		;
+	flags |= (cpuFeatures & JX_CPU_FEATURE_FMA) != 0
+		? JMIR_CONTEXT_FLAGS_TARGET_FMA_Msk
+		: 0
+		;
+
+	return flags;
+}
+
+// NOTE: Pipelines are only validated when installed but the caller can still edit them
+// afterwards. Invalid pipelines fall back to the context's pipeline and then to the opt
+// level pipeline.
+static jx_mir_pipeline_t* jmir_getFuncPipeline(jx_mir_context_t* ctx, const char* funcName)
+{
+	jx_mir_pipeline_t* pipeline = ctx->m_FuncPipelineCallback
+		? ctx->m_FuncPipelineCallback(funcName, ctx->m_FuncPipelineCallbackUserData)
+		: NULL
+		;
+	if (pipeline && jx_mir_pipelineIsValid(ctx, pipeline)) {
+		return pipeline;
+	}
+
+	return jx_mir_pipelineIsValid(ctx, ctx->m_Pipeline)
+		? ctx->m_Pipeline
+		: ctx->m_DefaultPipeline
+		;
+}
+
+static bool jmir_pipelineRunSteps(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t begin, uint32_t end, jx_mir_function_t* func)
+{
+	bool changed = false;
+	bool prevChanged = true;
+
+	uint32_t iStep = begin;
+	while (iStep < end) {
+		const jmir_pipeline_step_t* step = &pipeline->m_StepArr[iStep];
+		if (step->m_Kind == JMIR_PIPELINE_STEP_LOOP_BEGIN) {
+			const uint32_t loopEnd = jmir_pipelineFindLoopEnd(ctx, pipeline, iStep);
+			JX_CHECK(loopEnd < end, "Unbalanced pipeline loop");
+
+			bool loopChanged = false;
+			bool iterChanged = true;
+			uint32_t iter = 0;
+			while (iterChanged && iter < step->m_MaxIterations) {
+				iterChanged = jmir_pipelineRunSteps(ctx, pipeline, iStep + 1, loopEnd, func);
+				loopChanged = loopChanged || iterChanged;
+				++iter;
+			}
+
+			prevChanged = loopChanged;
+			changed = changed || loopChanged;
+			iStep = loopEnd + 1;
+		} else {
+			const bool skip = true
+				&& (step->m_Flags & JMIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Msk) != 0
+				&& !prevChanged
+				;
+			if (step->m_FuncPass && !skip) {
+				prevChanged = jmir_funcPassApply(ctx, step->m_FuncPass, func);
+				changed = changed || prevChanged;
+			}
+
+			++iStep;
+		}
+	}
+
+	return changed;
 }
 
 static void jmir_globalVarFree(jx_mir_context_t* ctx, jx_mir_global_variable_t* gv)
@@ -3468,15 +4776,29 @@ static jx_mir_frame_info_t* jmir_frameCreate(jx_mir_context_t* ctx)
 		return NULL;
 	}
 
+	fi->m_StackSlotArr = (jx_mir_stack_slot_t*)jx_array_create(ctx->m_Allocator);
+	if (!fi->m_StackSlotArr) {
+		jmir_frameDestroy(ctx, fi);
+		return NULL;
+	}
+
+	fi->m_EventArr = (jx_mir_frame_event_t*)jx_array_create(ctx->m_Allocator);
+	if (!fi->m_EventArr) {
+		jmir_frameDestroy(ctx, fi);
+		return NULL;
+	}
+
 	return fi;
 }
 
 static void jmir_frameDestroy(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo)
 {
 	jx_array_free(frameInfo->m_StackObjArr);
+	jx_array_free(frameInfo->m_StackSlotArr);
+	jx_array_free(frameInfo->m_EventArr);
 }
 
-static jx_mir_memory_ref_t* jmir_frameAllocObj(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo, uint32_t sz, uint32_t alignment)
+static jx_mir_memory_ref_t* jmir_frameAllocObj(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo, uint32_t sz, uint32_t alignment, uint32_t slotFlags)
 {
 	jx_mir_memory_ref_t* obj = jmir_memRefAlloc(ctx, kMIRRegGP_SP, kMIRRegGPNone, 1, jx_roundup_u32(frameInfo->m_Size, alignment));
 	if (!obj) {
@@ -3486,6 +4808,7 @@ static jx_mir_memory_ref_t* jmir_frameAllocObj(jx_mir_context_t* ctx, jx_mir_fra
 	frameInfo->m_Size = obj->m_Displacement + sz;
 
 	jx_array_push_back(frameInfo->m_StackObjArr, obj);
+	jx_array_push_back(frameInfo->m_StackSlotArr, (jx_mir_stack_slot_t){ .m_Obj = obj, .m_Size = sz, .m_Alignment = alignment, .m_Flags = slotFlags });
 
 	return obj;
 }
@@ -3526,9 +4849,142 @@ static void jmir_frameMakeRoomForCall(jx_mir_context_t* ctx, jx_mir_frame_info_t
 	frameInfo->m_Size += delta;
 }
 
-static void jmir_frameFinalize(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo)
+static void jmir_frameFinalize(jx_mir_context_t* ctx, jx_mir_frame_info_t* frameInfo, uint32_t numPushedRegs)
+{
+	if (frameInfo->m_Size != 0 || frameInfo->m_MaxCallArgs != 0) {
+		// NOTE: The return address and all registers pushed by the prologue (incl. RBP)
+		// sit between the caller's 16-byte aligned rsp and the frame.
+		const uint32_t pushSize = 8 + numPushedRegs * 8;
+		frameInfo->m_Size = jx_roundup_u32(frameInfo->m_Size + pushSize, 16) - pushSize;
+	}
+}
+
+static void jmir_frameAddEvent(jx_mir_frame_info_t* frameInfo, jx_mir_frame_event_kind kind, jx_mir_instruction_t* instr, jx_mir_reg_t reg, uint32_t offset)
+{
+	jx_array_push_back(frameInfo->m_EventArr, (jx_mir_frame_event_t){
+		.m_Instr = instr,
+		.m_Kind = kind,
+		.m_Reg = reg,
+		.m_Offset = offset
+	});
+}
+
+static bool jmir_frameIsSpillSlot(jx_mir_frame_info_t* frameInfo, const jx_mir_memory_ref_t* memRef)
+{
+	if (!jx_mir_regEqual(memRef->m_BaseReg, kMIRRegGP_SP) || jx_mir_regIsValid(memRef->m_IndexReg)) {
+		return false;
+	}
+
+	const uint32_t numSlots = (uint32_t)jx_array_sizeu(frameInfo->m_StackSlotArr);
+	for (uint32_t iSlot = 0; iSlot < numSlots; ++iSlot) {
+		const jx_mir_stack_slot_t* slot = &frameInfo->m_StackSlotArr[iSlot];
+		if (slot->m_Obj->m_Displacement == memRef->m_Displacement) {
+			return (slot->m_Flags & JMIR_STACK_SLOT_FLAGS_SPILL_Msk) != 0;
+		}
+	}
+
+	return false;
+}
+
+// Returns the nearest common dominator of all basic blocks which use any of the 
+// specified callee-saved registers, hoisted until it's a valid save point. Falls 
+// back to the entry block.
+static jx_mir_basic_block_t* jmir_funcFindCalleeSavedRegsSaveBlock(jx_mir_context_t* ctx, jx_mir_function_t* func, const uint32_t* savedRegs)
+{
+	jx_mir_basic_block_t* entryBlock = func->m_BasicBlockListHead;
+	if (!jx_mir_funcUpdateDomTree(ctx, func)) {
+		return entryBlock;
+	}
+
+	jx_mir_basic_block_t* saveBB = NULL;
+	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb && saveBB != entryBlock) {
+		bool usesSavedReg = false;
+
+		jx_mir_instruction_t* instr = bb->m_InstrListHead;
+		while (instr && !usesSavedReg) {
+			jmir_instrUpdateUseDefInfo(ctx, func, instr);
+
+			const jx_mir_instr_usedef_t* useDef = &instr->m_UseDef;
+			for (uint32_t iDef = 0; iDef < useDef->m_NumDefs && !usesSavedReg; ++iDef) {
+				jx_mir_reg_t reg = useDef->m_Defs[iDef];
+				usesSavedReg = !reg.m_IsVirtual && (savedRegs[reg.m_Class] & (1u << reg.m_ID)) != 0;
+			}
+			for (uint32_t iUse = 0; iUse < useDef->m_NumUses && !usesSavedReg; ++iUse) {
+				jx_mir_reg_t reg = useDef->m_Uses[iUse];
+				usesSavedReg = !reg.m_IsVirtual && (savedRegs[reg.m_Class] & (1u << reg.m_ID)) != 0;
+			}
+
+			instr = instr->m_Next;
+		}
+
+		// NOTE: Unreachable blocks don't have an immediate dominator.
+		if (usesSavedReg && bb->m_ImmDom) {
+			saveBB = saveBB
+				? jmir_funcIDomIntersect(saveBB, bb)
+				: bb
+				;
+		}
+
+		bb = bb->m_Next;
+	}
+
+	if (!saveBB) {
+		return entryBlock;
+	}
+
+	while (saveBB != entryBlock && !jmir_bbIsValidSaveBlock(ctx, func, saveBB)) {
+		saveBB = saveBB->m_ImmDom;
+	}
+
+	return saveBB;
+}
+
+// A basic block is a valid save point if it isn't part of a loop (the registers would be 
+// saved again after being modified) and all exit blocks reachable from it are dominated
+// by it (the registers are restored in those exit blocks only).
+static bool jmir_bbIsValidSaveBlock(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_basic_block_t* saveBB)
 {
-	frameInfo->m_Size = jx_roundup_u32(frameInfo->m_Size, 16);
+	jx_bitset_t* visited = jx_bitsetCreate(func->m_NextBasicBlockID, ctx->m_Allocator);
+	if (!visited) {
+		return false;
+	}
+
+	jx_mir_basic_block_t** stack = (jx_mir_basic_block_t**)jx_array_create(ctx->m_Allocator);
+	if (!stack) {
+		jx_bitsetDestroy(visited, ctx->m_Allocator);
+		return false;
+	}
+
+	const uint32_t numSaveBBSucc = (uint32_t)jx_array_sizeu(saveBB->m_SuccArr);
+	for (uint32_t iSucc = 0; iSucc < numSaveBBSucc; ++iSucc) {
+		jx_array_push_back(stack, saveBB->m_SuccArr[iSucc]);
+	}
+
+	bool isValid = true;
+	while (isValid && jx_array_sizeu(stack) != 0) {
+		jx_mir_basic_block_t* bb = jx_array_pop_back(stack);
+		if (jx_bitsetIsBitSet(visited, bb->m_ID)) {
+			continue;
+		}
+		jx_bitsetSetBit(visited, bb->m_ID);
+
+		const uint32_t numSucc = (uint32_t)jx_array_sizeu(bb->m_SuccArr);
+		if (bb == saveBB) {
+			isValid = false;
+		} else if (numSucc == 0) {
+			isValid = jx_mir_bbDominates(ctx, saveBB, bb);
+		} else {
+			for (uint32_t iSucc = 0; iSucc < numSucc; ++iSucc) {
+				jx_array_push_back(stack, bb->m_SuccArr[iSucc]);
+			}
+		}
+	}
+
+	jx_array_free(stack);
+	jx_bitsetDestroy(visited, ctx->m_Allocator);
+
+	return isValid;
 }
 
 static uint64_t jmir_funcProtoHashCallback(const void* item, uint64_t seed0, uint64_t seed1, void* udata)
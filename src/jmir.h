@@ -18,6 +18,7 @@ typedef struct jx_mir_basic_block_t jx_mir_basic_block_t;
 typedef struct jx_mir_function_t jx_mir_function_t;
 typedef struct jx_mir_frame_info_t jx_mir_frame_info_t;
 typedef struct jx_mir_function_pass_t jx_mir_function_pass_t;
+typedef struct jx_mir_pipeline_t jx_mir_pipeline_t;
 typedef struct jx_mir_scc_t jx_mir_scc_t;
 
 typedef enum jx_mir_type_kind
@@ -48,6 +49,8 @@ typedef enum jx_mir_opcode
 	JMIR_OP_IMUL3,
 	JMIR_OP_IDIV,
 	JMIR_OP_DIV,
+	JMIR_OP_IMUL1,
+	JMIR_OP_MUL,
 	JMIR_OP_ADD,
 	JMIR_OP_SUB,
 	JMIR_OP_LEA,
@@ -57,7 +60,16 @@ typedef enum jx_mir_opcode
 	JMIR_OP_SAR,
 	JMIR_OP_SHR,
 	JMIR_OP_SHL,
+	JMIR_OP_ROL,
+	JMIR_OP_ROR,
+	JMIR_OP_BSWAP,
+	JMIR_OP_BSF,
+	JMIR_OP_BSR,
+	JMIR_OP_POPCNT,
+	JMIR_OP_LZCNT,
+	JMIR_OP_TZCNT,
 	JMIR_OP_CALL,
+	JMIR_OP_TAILCALL,
 	JMIR_OP_PUSH,
 	JMIR_OP_POP,
 	JMIR_OP_CDQ,
@@ -98,10 +110,29 @@ typedef enum jx_mir_opcode
 	JMIR_OP_JLE,
 	JMIR_OP_JNLE,
 
+	JMIR_OP_CMOVO,
+	JMIR_OP_CMOVNO,
+	JMIR_OP_CMOVB,
+	JMIR_OP_CMOVNB,
+	JMIR_OP_CMOVE,
+	JMIR_OP_CMOVNE,
+	JMIR_OP_CMOVBE,
+	JMIR_OP_CMOVNBE,
+	JMIR_OP_CMOVS,
+	JMIR_OP_CMOVNS,
+	JMIR_OP_CMOVP,
+	JMIR_OP_CMOVNP,
+	JMIR_OP_CMOVL,
+	JMIR_OP_CMOVNL,
+	JMIR_OP_CMOVLE,
+	JMIR_OP_CMOVNLE,
+
 	JMIR_OP_MOVSS,
 	JMIR_OP_MOVSD,
 	JMIR_OP_MOVAPS,
 	JMIR_OP_MOVAPD,
+	JMIR_OP_MOVUPS,
+	JMIR_OP_MOVUPD,
 	JMIR_OP_MOVD,
 	JMIR_OP_MOVQ,
 	JMIR_OP_ADDPS,
@@ -144,6 +175,8 @@ typedef enum jx_mir_opcode
 	JMIR_OP_RCPSS,
 	JMIR_OP_RSQRTPS,
 	JMIR_OP_RSQRTSS,
+	JMIR_OP_SHUFPS,
+	JMIR_OP_SHUFPD,
 	JMIR_OP_SQRTPS,
 	JMIR_OP_SQRTSS,
 	JMIR_OP_SQRTPD,
@@ -171,6 +204,7 @@ typedef enum jx_mir_opcode
 
 	JMIR_OP_SETCC_BASE = JMIR_OP_SETO,
 	JMIR_OP_JCC_BASE = JMIR_OP_JO,
+	JMIR_OP_CMOVCC_BASE = JMIR_OP_CMOVO,
 } jx_mir_opcode;
 
 typedef enum jx_mir_condition_code
@@ -321,7 +355,7 @@ static const jx_mir_reg_t kMIRFuncCallerSavedFReg[] = {
 
 static const jx_mir_reg_t kMIRFuncCalleeSavedIReg[] = {
 	JMIR_REG_HW_GP(JMIR_HWREGID_B),
-//	JMIR_REG_HW_GP(JMIR_HWREGID_BP), // Always saved by the function if needed; never used by the register allocator.
+	JMIR_REG_HW_GP(JMIR_HWREGID_BP), // Only allocatable in functions without a frame pointer (see JMIR_FUNC_FLAGS_FRAME_POINTER)
 	JMIR_REG_HW_GP(JMIR_HWREGID_SI),
 	JMIR_REG_HW_GP(JMIR_HWREGID_DI),
 	JMIR_REG_HW_GP(JMIR_HWREGID_R12),
@@ -439,11 +473,12 @@ typedef struct jx_mir_basic_block_t
 	jx_mir_instruction_t* m_InstrListHead;
 	jx_mir_instruction_t* m_InstrListTail;
 	uint32_t m_ID;
-	JX_PAD(4);
+	uint32_t m_RevPostOrderID;
 
 	// Annotations
 	jx_mir_basic_block_t** m_PredArr;
 	jx_mir_basic_block_t** m_SuccArr;
+	jx_mir_basic_block_t* m_ImmDom; // Immediate Dominator
 	jx_bitset_t m_LiveInSet;
 	jx_bitset_t m_LiveOutSet;
 	jx_mir_bb_scc_info_t m_SCCInfo;
@@ -461,12 +496,57 @@ typedef struct jx_mir_scc_t
 	JX_PAD(4);
 } jx_mir_scc_t;
 
+#define JMIR_STACK_SLOT_FLAGS_SPILL_Pos 0 // Slot holds a spilled register; every store to it overwrites the whole value.
+#define JMIR_STACK_SLOT_FLAGS_SPILL_Msk (1u << JMIR_STACK_SLOT_FLAGS_SPILL_Pos)
+
+typedef struct jx_mir_stack_slot_t
+{
+	jx_mir_memory_ref_t* m_Obj; // Stack object allocated for this slot.
+	uint32_t m_Size;
+	uint32_t m_Alignment;
+	uint32_t m_Flags; // JMIR_STACK_SLOT_FLAGS_xxx
+	JX_PAD(4);
+} jx_mir_stack_slot_t;
+
+typedef enum jx_mir_frame_event_kind
+{
+	JMIR_FRAME_EVENT_PUSH_REG, // push reg
+	JMIR_FRAME_EVENT_ALLOC,    // sub rsp, size
+	JMIR_FRAME_EVENT_SAVE_REG, // mov/movaps [rsp + offset], reg
+} jx_mir_frame_event_kind;
+
+// A prologue instruction which changes the frame, as seen by an unwinder.
+typedef struct jx_mir_frame_event_t
+{
+	jx_mir_instruction_t* m_Instr; // The event takes effect after this instruction.
+	jx_mir_frame_event_kind m_Kind;
+	jx_mir_reg_t m_Reg;
+	uint32_t m_Offset; // Allocation size (JMIR_FRAME_EVENT_ALLOC) or slot offset relative to rsp after the prologue (JMIR_FRAME_EVENT_SAVE_REG)
+	JX_PAD(4);
+} jx_mir_frame_event_t;
+
+typedef struct jx_mir_frame_info_t
+{
+	jx_mir_memory_ref_t** m_StackObjArr; // All stack objects, incl. objects relative to other objects.
+	jx_mir_stack_slot_t* m_StackSlotArr; // One entry per allocated stack object, sorted by offset.
+	jx_mir_frame_event_t* m_EventArr;    // Prologue events in execution order. Filled in by jx_mir_funcEnd().
+	jx_mir_basic_block_t* m_SaveBB;      // Block which saves the callee-saved registers not pushed by the prologue.
+	uint32_t m_MaxCallArgs;
+	uint32_t m_Size;
+} jx_mir_frame_info_t;
+
 #define JMIR_FUNC_FLAGS_CFG_VALID_Pos       0
 #define JMIR_FUNC_FLAGS_CFG_VALID_Msk       (1u << JMIR_FUNC_FLAGS_CFG_VALID_Pos)
 #define JMIR_FUNC_FLAGS_LIVENESS_VALID_Pos  1
 #define JMIR_FUNC_FLAGS_LIVENESS_VALID_Msk  (1u << JMIR_FUNC_FLAGS_LIVENESS_VALID_Pos)
 #define JMIR_FUNC_FLAGS_SCC_VALID_Pos       2
 #define JMIR_FUNC_FLAGS_SCC_VALID_Msk       (1u << JMIR_FUNC_FLAGS_SCC_VALID_Pos)
+#define JMIR_FUNC_FLAGS_FRAME_POINTER_Pos   3 // Function addresses incoming arguments through RBP; RBP isn't available to the register allocator.
+#define JMIR_FUNC_FLAGS_FRAME_POINTER_Msk   (1u << JMIR_FUNC_FLAGS_FRAME_POINTER_Pos)
+#define JMIR_FUNC_FLAGS_DOM_TREE_VALID_Pos  4
+#define JMIR_FUNC_FLAGS_DOM_TREE_VALID_Msk  (1u << JMIR_FUNC_FLAGS_DOM_TREE_VALID_Pos)
+#define JMIR_FUNC_FLAGS_INTERNAL_Pos        5 // Internal linkage (static); not visible outside the module.
+#define JMIR_FUNC_FLAGS_INTERNAL_Msk        (1u << JMIR_FUNC_FLAGS_INTERNAL_Pos)
 
 typedef struct jx_mir_function_t
 {
@@ -482,6 +562,7 @@ typedef struct jx_mir_function_t
 	uint32_t m_Flags; // JMIR_FUNC_FLAGS_xxx
 	uint32_t m_NextVirtualRegID[JMIR_REG_CLASS_COUNT];
 	uint32_t m_UsedHWRegs[JMIR_REG_CLASS_COUNT];
+	uint64_t m_Fingerprint; // IR fingerprint mixed with the MIR pipeline (see jx_mir_funcGetFingerprint()); 0 if unknown.
 } jx_mir_function_t;
 
 typedef struct jx_mir_relocation_t
@@ -491,13 +572,18 @@ typedef struct jx_mir_relocation_t
 	JX_PAD(4);
 } jx_mir_relocation_t;
 
+#define JMIR_GLOBAL_VAR_FLAGS_READ_ONLY_Pos 0
+#define JMIR_GLOBAL_VAR_FLAGS_READ_ONLY_Msk (1u << JMIR_GLOBAL_VAR_FLAGS_READ_ONLY_Pos)
+#define JMIR_GLOBAL_VAR_FLAGS_INTERNAL_Pos  1 // Internal linkage (static variables, string literals, compiler generated constants)
+#define JMIR_GLOBAL_VAR_FLAGS_INTERNAL_Msk  (1u << JMIR_GLOBAL_VAR_FLAGS_INTERNAL_Pos)
+
 typedef struct jx_mir_global_variable_t
 {
 	char* m_Name;
 	uint8_t* m_DataArr;
 	jx_mir_relocation_t* m_RelocationsArr;
 	uint32_t m_Alignment;
-	JX_PAD(4);
+	uint32_t m_Flags; // JMIR_GLOBAL_VAR_FLAGS_xxx
 } jx_mir_global_variable_t;
 
 typedef struct jx_mir_context_t jx_mir_context_t;
@@ -507,13 +593,70 @@ typedef struct jx_mir_function_pass_t
 {
 	jx_mir_function_pass_o* m_Inst;
 	jx_mir_function_pass_t* m_Next;
+	const char* m_Name;
 
 	bool (*run)(jx_mir_function_pass_o* pass, jx_mir_context_t* ctx, jx_mir_function_t* func);
 	void (*destroy)(jx_mir_function_pass_o* pass, jx_allocator_i* allocator);
+	bool (*setOption)(jx_mir_function_pass_o* pass, const char* name, int64_t value); // Optional
 } jx_mir_function_pass_t;
 
+typedef enum jx_mir_pass_kind
+{
+	JMIR_PASS_REMOVE_FALLTHROUGH_JMP = 0,
+	JMIR_PASS_SIMPLIFY_COND_JMP,
+	JMIR_PASS_DEAD_CODE_ELIMINATION,         // Pre-RA
+	JMIR_PASS_PEEPHOLE,                      // Pre-RA
+	JMIR_PASS_REG_ALLOC,                     // Required
+	JMIR_PASS_REMOVE_REDUNDANT_MOVES,        // Required, post-RA
+	JMIR_PASS_REDUNDANT_CONST_ELIMINATION,   // Post-RA
+	JMIR_PASS_INSTR_COMBINE,                 // Pre-RA
+	JMIR_PASS_SIMPLIFY_CFG,                  // Pre-RA
+	JMIR_PASS_SLP_VECTORIZER,                // Pre-RA
+	JMIR_PASS_STACK_SLOT_COLORING,           // Post-RA
+	JMIR_PASS_PRE_RA_SCHEDULER,              // Pre-RA; Options: issueWidth
+	JMIR_PASS_POST_RA_SCHEDULER,             // Post-RA; Options: issueWidth
+
+	JMIR_PASS_COUNT
+} jx_mir_pass_kind;
+
+typedef enum jx_mir_opt_level
+{
+	JMIR_OPT_LEVEL_O0 = 0, // Only the passes required to produce valid code
+	JMIR_OPT_LEVEL_O1,     // Cheap cleanups, no vectorization or scheduling
+	JMIR_OPT_LEVEL_O2,     // Default
+	JMIR_OPT_LEVEL_Os,     // O2 without the schedulers
+} jx_mir_opt_level;
+
+#define JMIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Pos 0 // Run the pass only if the previous step changed the function
+#define JMIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Msk (1u << JMIR_PIPELINE_STEP_FLAGS_IF_CHANGED_Pos)
+
+#define JMIR_PIPELINE_POS_END UINT32_MAX
+
+#define JMIR_CONTEXT_FLAGS_KEEP_FRAME_POINTER_Pos 0 // Always emit push rbp/mov rbp, rsp (e.g. for profilers which walk the stack through RBP)
+#define JMIR_CONTEXT_FLAGS_KEEP_FRAME_POINTER_Msk (1u << JMIR_CONTEXT_FLAGS_KEEP_FRAME_POINTER_Pos)
+#define JMIR_CONTEXT_FLAGS_TARGET_AVX_Pos         1 // Host supports AVX; select VEX-encoded forms for SSE instructions (detected by jx_mir_createContext)
+#define JMIR_CONTEXT_FLAGS_TARGET_AVX_Msk         (1u << JMIR_CONTEXT_FLAGS_TARGET_AVX_Pos)
+#define JMIR_CONTEXT_FLAGS_TARGET_AVX2_Pos        2 // Host supports AVX2 (detected by jx_mir_createContext)
+#define JMIR_CONTEXT_FLAGS_TARGET_AVX2_Msk        (1u << JMIR_CONTEXT_FLAGS_TARGET_AVX2_Pos)
+#define JMIR_CONTEXT_FLAGS_TARGET_FMA_Pos         3 // Host supports FMA3 (detected by jx_mir_createContext)
+#define JMIR_CONTEXT_FLAGS_TARGET_FMA_Msk         (1u << JMIR_CONTEXT_FLAGS_TARGET_FMA_Pos)
+#define JMIR_CONTEXT_FLAGS_TARGET_Msk             (JMIR_CONTEXT_FLAGS_TARGET_AVX_Msk | JMIR_CONTEXT_FLAGS_TARGET_AVX2_Msk | JMIR_CONTEXT_FLAGS_TARGET_FMA_Msk)
+
+// Called before and after each pass executed by jx_mir_funcEnd().
+typedef void (*jx_mir_passCallback)(const char* passName, bool isEnd, void* userData);
+
+// Returns the pipeline which should be used for the specified function or NULL to use 
+// the context's pipeline.
+typedef jx_mir_pipeline_t* (*jx_mir_funcPipelineCallback)(const char* funcName, void* userData);
+
 jx_mir_context_t* jx_mir_createContext(jx_allocator_i* allocator);
 void jx_mir_destroyContext(jx_mir_context_t* ctx);
+void jx_mir_setPassCallback(jx_mir_context_t* ctx, jx_mir_passCallback callback, void* userData);
+bool jx_mir_setOptLevel(jx_mir_context_t* ctx, jx_mir_opt_level level);
+bool jx_mir_setPipeline(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline); // NULL to restore the opt level pipeline
+void jx_mir_setFuncPipelineCallback(jx_mir_context_t* ctx, jx_mir_funcPipelineCallback callback, void* userData);
+void jx_mir_setFlags(jx_mir_context_t* ctx, uint32_t flags); // NOTE: Keep the JMIR_CONTEXT_FLAGS_TARGET_xxx flags from jx_mir_getFlags() unless overriding them.
+uint32_t jx_mir_getFlags(jx_mir_context_t* ctx);
 void jx_mir_print(jx_mir_context_t* ctx, jx_string_buffer_t* sb);
 uint32_t jx_mir_getNumGlobalVars(jx_mir_context_t* ctx);
 jx_mir_global_variable_t* jx_mir_getGlobalVarByID(jx_mir_context_t* ctx, uint32_t id);
@@ -527,6 +670,37 @@ void jx_mir_globalVarEnd(jx_mir_context_t* ctx, jx_mir_global_variable_t* gv);
 uint32_t jx_mir_globalVarAppendData(jx_mir_context_t* ctx, jx_mir_global_variable_t* gv, const uint8_t* data, uint32_t sz);
 void jx_mir_globalVarAddRelocation(jx_mir_context_t* ctx, jx_mir_global_variable_t* gv, uint32_t dataOffset, const char* symbolName);
 
+// Pass pipelines
+// 
+// A pipeline is the list of steps executed by jx_mir_funcEnd() between building the CFG 
+// and inserting the prologue/epilogue. Each pass step owns its own instance of the pass, 
+// so options are per step. Loops repeat their steps until none of them changes the function
+// or the max number of iterations is reached. A valid pipeline includes exactly one register 
+// allocation step (outside of any loop) and all required passes, with pre-RA passes before 
+// and post-RA passes after it. stackSlotColoring can only be the last step.
+// 
+// Pipelines are owned by the caller and must outlive their use by the context.
+// They are validated again by jx_mir_funcEnd() since they can be edited after being installed; 
+// an invalid pipeline is replaced by the opt level pipeline.
+jx_mir_pipeline_t* jx_mir_pipelineCreate(jx_mir_context_t* ctx);
+jx_mir_pipeline_t* jx_mir_pipelineCreatePreset(jx_mir_context_t* ctx, jx_mir_opt_level level);
+void jx_mir_pipelineDestroy(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline);
+uint32_t jx_mir_pipelineGetNumSteps(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline);
+bool jx_mir_pipelineInsertPass(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos, jx_mir_pass_kind kind, uint32_t flags);
+bool jx_mir_pipelineInsertLoopBegin(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos, uint32_t maxIterations);
+bool jx_mir_pipelineInsertLoopEnd(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos);
+void jx_mir_pipelineRemoveStep(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos);
+void jx_mir_pipelineMoveStep(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t from, uint32_t to);
+bool jx_mir_pipelineSetMaxIterations(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos, uint32_t maxIterations);
+bool jx_mir_pipelineSetPassOption(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, uint32_t pos, const char* name, int64_t value);
+bool jx_mir_pipelineIsValid(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline);
+uint64_t jx_mir_pipelineHash(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline);
+void jx_mir_pipelinePrint(jx_mir_context_t* ctx, jx_mir_pipeline_t* pipeline, jx_string_buffer_t* sb);
+
+// Mixes the pipeline which jx_mir_funcEnd() will apply to the function and the context
+// flags into its IR fingerprint (see jx_ir_funcGetFingerprint()). Returns 0 if irFingerprint is 0.
+uint64_t jx_mir_funcGetFingerprint(jx_mir_context_t* ctx, const char* funcName, uint64_t irFingerprint);
+
 jx_mir_function_proto_t* jx_mir_funcProto(jx_mir_context_t* ctx, jx_mir_type_kind retType, uint32_t numArgs, jx_mir_type_kind* args, uint32_t flags);
 jx_mir_function_t* jx_mir_funcBegin(jx_mir_context_t* ctx, const char* name, jx_mir_function_proto_t* proto);
 void jx_mir_funcEnd(jx_mir_context_t* ctx, jx_mir_function_t* func);
@@ -539,10 +713,12 @@ bool jx_mir_funcUpdateCFG(jx_mir_context_t* ctx, jx_mir_function_t* func);
 bool jx_mir_funcRenumberVirtualRegs(jx_mir_context_t* ctx, jx_mir_function_t* func);
 bool jx_mir_funcUpdateLiveness(jx_mir_context_t* ctx, jx_mir_function_t* func);
 bool jx_mir_funcUpdateSCCs(jx_mir_context_t* ctx, jx_mir_function_t* func);
+bool jx_mir_funcUpdateDomTree(jx_mir_context_t* ctx, jx_mir_function_t* func);
 uint32_t jx_mir_funcGetRegBitsetSize(jx_mir_context_t* ctx, jx_mir_function_t* func);
 jx_mir_reg_t jx_mir_funcMapBitsetIDToReg(jx_mir_context_t* ctx, jx_mir_function_t* func, uint32_t id);
 uint32_t jx_mir_funcMapRegToBitsetID(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_reg_t reg);
 bool jx_mir_funcSpillVirtualReg(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_reg_t reg);
+bool jx_mir_funcRematerializeVirtualReg(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_reg_t reg, jx_mir_instruction_t* defInstr);
 void jx_mir_funcPrint(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_string_buffer_t* sb);
 
 jx_mir_basic_block_t* jx_mir_bbAlloc(jx_mir_context_t* ctx);
@@ -553,6 +729,7 @@ bool jx_mir_bbInsertInstrBefore(jx_mir_context_t* ctx, jx_mir_basic_block_t* bb,
 bool jx_mir_bbInsertInstrAfter(jx_mir_context_t* ctx, jx_mir_basic_block_t* bb, jx_mir_instruction_t* anchor, jx_mir_instruction_t* instr);
 bool jx_mir_bbRemoveInstr(jx_mir_context_t* ctx, jx_mir_basic_block_t* bb, jx_mir_instruction_t* instr);
 jx_mir_instruction_t* jx_mir_bbGetFirstTerminatorInstr(jx_mir_context_t* ctx, jx_mir_basic_block_t* bb);
+bool jx_mir_bbDominates(jx_mir_context_t* ctx, jx_mir_basic_block_t* dom, jx_mir_basic_block_t* bb);
 
 jx_mir_operand_t* jx_mir_opVirtualReg(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_type_kind type);
 jx_mir_operand_t* jx_mir_opHWReg(jx_mir_context_t* ctx, jx_mir_function_t* func, jx_mir_type_kind type, jx_mir_reg_t reg);
@@ -569,6 +746,7 @@ void jx_mir_opPrint(jx_mir_context_t* ctx, jx_mir_operand_t* op, bool memRefSkip
 void jx_mir_instrFree(jx_mir_context_t* ctx, jx_mir_instruction_t* instr);
 void jx_mir_instrPrint(jx_mir_context_t* ctx, jx_mir_instruction_t* instr, jx_string_buffer_t* sb);
 bool jx_mir_instrIsMovRegReg(jx_mir_instruction_t* instr);
+bool jx_mir_instrIsRematerializable(jx_mir_instruction_t* instr);
 jx_mir_instruction_t* jx_mir_mov(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
 jx_mir_instruction_t* jx_mir_movsx(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
 jx_mir_instruction_t* jx_mir_movzx(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
@@ -586,6 +764,7 @@ jx_mir_instruction_t* jx_mir_neg(jx_mir_context_t* ctx, jx_mir_operand_t* op);
 jx_mir_instruction_t* jx_mir_mul(jx_mir_context_t* ctx, jx_mir_operand_t* op);
 jx_mir_instruction_t* jx_mir_div(jx_mir_context_t* ctx, jx_mir_operand_t* op);
 jx_mir_instruction_t* jx_mir_idiv(jx_mir_context_t* ctx, jx_mir_operand_t* op);
+jx_mir_instruction_t* jx_mir_imul1(jx_mir_context_t* ctx, jx_mir_operand_t* op);
 jx_mir_instruction_t* jx_mir_inc(jx_mir_context_t* ctx, jx_mir_operand_t* op);
 jx_mir_instruction_t* jx_mir_dec(jx_mir_context_t* ctx, jx_mir_operand_t* op);
 jx_mir_instruction_t* jx_mir_imul(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
@@ -601,10 +780,17 @@ jx_mir_instruction_t* jx_mir_rcr(jx_mir_context_t* ctx, jx_mir_operand_t* op, jx
 jx_mir_instruction_t* jx_mir_rcl(jx_mir_context_t* ctx, jx_mir_operand_t* op, jx_mir_operand_t* shift);
 jx_mir_instruction_t* jx_mir_ror(jx_mir_context_t* ctx, jx_mir_operand_t* op, jx_mir_operand_t* shift);
 jx_mir_instruction_t* jx_mir_rol(jx_mir_context_t* ctx, jx_mir_operand_t* op, jx_mir_operand_t* shift);
+jx_mir_instruction_t* jx_mir_bswap(jx_mir_context_t* ctx, jx_mir_operand_t* op);
+jx_mir_instruction_t* jx_mir_bsf(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
+jx_mir_instruction_t* jx_mir_bsr(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
+jx_mir_instruction_t* jx_mir_popcnt(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
+jx_mir_instruction_t* jx_mir_lzcnt(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
+jx_mir_instruction_t* jx_mir_tzcnt(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
 jx_mir_instruction_t* jx_mir_cmovcc(jx_mir_context_t* ctx, jx_mir_condition_code cc, jx_mir_operand_t* dst, jx_mir_operand_t* src);
 jx_mir_instruction_t* jx_mir_jcc(jx_mir_context_t* ctx, jx_mir_condition_code cc, jx_mir_operand_t* op);
 jx_mir_instruction_t* jx_mir_jmp(jx_mir_context_t* ctx, jx_mir_operand_t* op);
 jx_mir_instruction_t* jx_mir_call(jx_mir_context_t* ctx, jx_mir_operand_t* func, jx_mir_function_proto_t* proto);
+jx_mir_instruction_t* jx_mir_tailcall(jx_mir_context_t* ctx, jx_mir_operand_t* func, jx_mir_function_proto_t* proto);
 jx_mir_instruction_t* jx_mir_push(jx_mir_context_t* ctx, jx_mir_operand_t* op);
 jx_mir_instruction_t* jx_mir_pop(jx_mir_context_t* ctx, jx_mir_operand_t* op);
 jx_mir_instruction_t* jx_mir_cdq(jx_mir_context_t* ctx);
@@ -615,6 +801,8 @@ jx_mir_instruction_t* jx_mir_movss(jx_mir_context_t* ctx, jx_mir_operand_t* dst,
 jx_mir_instruction_t* jx_mir_movsd(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
 jx_mir_instruction_t* jx_mir_movaps(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
 jx_mir_instruction_t* jx_mir_movapd(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
+jx_mir_instruction_t* jx_mir_movups(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
+jx_mir_instruction_t* jx_mir_movupd(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
 jx_mir_instruction_t* jx_mir_movd(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
 jx_mir_instruction_t* jx_mir_movq(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
 jx_mir_instruction_t* jx_mir_addps(jx_mir_context_t* ctx, jx_mir_operand_t* dst, jx_mir_operand_t* src);
@@ -918,6 +1106,14 @@ static inline bool jx_mir_opcodeIsSetcc(uint32_t opcode)
 		;
 }
 
+static inline bool jx_mir_opcodeIsCmovcc(uint32_t opcode)
+{
+	return true
+		&& (opcode >= JMIR_OP_CMOVCC_BASE)
+		&& (opcode < JMIR_OP_CMOVCC_BASE + JMIR_CC_COUNT)
+		;
+}
+
 static inline bool jx_mir_opcodeIsComparison(uint32_t opcode)
 {
 	return false
@@ -934,6 +1130,7 @@ static inline bool jx_mir_opcodeIsTerminator(uint32_t opcode)
 	return false
 		|| opcode == JMIR_OP_RET
 		|| opcode == JMIR_OP_JMP
+		|| opcode == JMIR_OP_TAILCALL
 		|| jx_mir_opcodeIsJcc(opcode)
 		;
 }
@@ -3,6 +3,7 @@
 #include "jir.h"
 #include <jlib/allocator.h>
 #include <jlib/array.h>
+#include <jlib/cpu.h>
 #include <jlib/dbg.h>
 #include <jlib/hashmap.h>
 #include <jlib/math.h>
@@ -31,6 +32,44 @@ typedef struct jmir_value_operand_item_t
 	jx_mir_operand_t* m_MIROperand;
 } jmir_value_operand_item_t;
 
+typedef enum jmirgen_fold_kind
+{
+	JMIRGEN_FOLD_ADDRESS = 0,    // GEP folded into the memory operand (or lea) of its user
+	JMIRGEN_FOLD_MEMORY_OPERAND, // Load folded into the source operand of its user
+	JMIRGEN_FOLD_FLAGS,          // Comparison folded into a conditional branch
+} jmirgen_fold_kind;
+
+typedef struct jmir_folded_instr_item_t
+{
+	jx_ir_instruction_t* m_IRInstr;
+	jmirgen_fold_kind m_Kind;
+	JX_PAD(4);
+} jmir_folded_instr_item_t;
+
+// Tree pattern: the value of operand m_OperandID of the user instruction is computed 
+// by a def instruction which can be folded into the user. Matched patterns form trees 
+// (e.g. load(gep(gep)) into add) which are selected together when the root is built.
+typedef struct jmirgen_fold_pattern_t
+{
+	jx_ir_opcode m_UserOpCodeFirst;
+	jx_ir_opcode m_UserOpCodeLast;
+	jx_ir_opcode m_DefOpCodeFirst;
+	jx_ir_opcode m_DefOpCodeLast;
+	uint32_t m_OperandID;
+	jmirgen_fold_kind m_Kind;
+} jmirgen_fold_pattern_t;
+
+// Address in the form [base + index * scale + disp]. The base is either a 
+// register or a stack object. Stack objects cannot have an index register. 
+typedef struct jmirgen_address_t
+{
+	jx_mir_memory_ref_t* m_StackObj;
+	jx_mir_operand_t* m_BaseReg;
+	jx_mir_operand_t* m_IndexReg;
+	uint32_t m_Scale;
+	int32_t m_Displacement;
+} jmirgen_address_t;
+
 typedef struct jx_mirgen_context_t
 {
 	jx_allocator_i* m_Allocator;
@@ -42,6 +81,8 @@ typedef struct jx_mirgen_context_t
 	jx_hashmap_t* m_FuncMap;
 	jx_hashmap_t* m_BasicBlockMap;
 	jx_hashmap_t* m_ValueMap;
+	jx_hashmap_t* m_FoldedInstrMap;
+	uint64_t m_CPUFeatures;
 } jx_mirgen_context_t;
 
 static bool jmirgen_globalVarBuild(jx_mirgen_context_t* ctx, const char* namePrefix, jx_ir_global_variable_t* irGV);
@@ -54,6 +95,7 @@ static jx_mir_operand_t* jmirgen_instrBuild_add(jx_mirgen_context_t* ctx, jx_ir_
 static jx_mir_operand_t* jmirgen_instrBuild_sub(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_mul(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_div_rem(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
+static jx_mir_operand_t* jmirgen_instrBuild_mulhi(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_and(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_or(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_xor(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
@@ -66,6 +108,11 @@ static jx_mir_operand_t* jmirgen_instrBuild_phi(jx_mirgen_context_t* ctx, jx_ir_
 static jx_mir_operand_t* jmirgen_instrBuild_call(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_shl(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_shr(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
+static jx_mir_operand_t* jmirgen_instrBuild_rotate(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
+static jx_mir_operand_t* jmirgen_instrBuild_bswap(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
+static jx_mir_operand_t* jmirgen_instrBuild_popcnt(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
+static jx_mir_operand_t* jmirgen_instrBuild_ctlz(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
+static jx_mir_operand_t* jmirgen_instrBuild_cttz(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_trunc(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_zext(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_sext(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
@@ -78,6 +125,20 @@ static jx_mir_operand_t* jmirgen_instrBuild_fp2ui(jx_mirgen_context_t* ctx, jx_i
 static jx_mir_operand_t* jmirgen_instrBuild_fp2si(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_ui2fp(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 static jx_mir_operand_t* jmirgen_instrBuild_si2fp(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
+static jx_mir_operand_t* jmirgen_instrBuild_select(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
+static jx_mir_operand_t* jmirgen_genSelectInt(jx_mirgen_context_t* ctx, jx_mir_type_kind type, jx_mir_operand_t* cond, jx_mir_operand_t* trueOp, jx_mir_operand_t* falseOp);
+static jx_mir_condition_code jmirgen_genCompare(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
+static void jmirgen_bbMatchPatterns(jx_mirgen_context_t* ctx, jx_ir_basic_block_t* irBB);
+static bool jmirgen_patternCanFold(jx_ir_instruction_t* userInstr, jx_ir_instruction_t* defInstr, jmirgen_fold_kind kind);
+static bool jmirgen_instrIsFolded(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
+static void jmirgen_matchAddress(jx_mirgen_context_t* ctx, jx_ir_value_t* ptrVal, jmirgen_address_t* addr);
+static void jmirgen_matchGEP(jx_mirgen_context_t* ctx, jx_ir_instruction_t* gepInstr, jmirgen_address_t* addr);
+static void jmirgen_addressAddDisplacement(jmirgen_address_t* addr, int64_t displacement);
+static void jmirgen_addressAddIndex(jx_mirgen_context_t* ctx, jmirgen_address_t* addr, jx_mir_operand_t* indexOperand, uint32_t itemSize);
+static jx_mir_operand_t* jmirgen_addressToMemRef(jx_mirgen_context_t* ctx, jmirgen_address_t* addr, jx_mir_type_kind type);
+static jx_mir_operand_t* jmirgen_addressToReg(jx_mirgen_context_t* ctx, jmirgen_address_t* addr);
+static jx_mir_operand_t* jmirgen_bitCountWiden(jx_mirgen_context_t* ctx, jx_mir_operand_t* operand);
+static jx_mir_operand_t* jmirgen_bitCountResult(jx_mirgen_context_t* ctx, jx_mir_type_kind type, jx_mir_operand_t* wideReg);
 static jx_mir_basic_block_t* jmirgen_getOrCreateBasicBlock(jx_mirgen_context_t* ctx, jx_ir_basic_block_t* irBB);
 static jx_mir_operand_t* jmirgen_getOperand(jx_mirgen_context_t* ctx, jx_ir_value_t* val);
 static jx_mir_operand_t* jmirgen_genMemSet(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
@@ -99,6 +160,8 @@ static uint64_t jmir_bbItemHash(const void* item, uint64_t seed0, uint64_t seed1
 static int32_t jmir_bbItemCompare(const void* a, const void* b, void* udata);
 static uint64_t jmir_valueOperandItemHash(const void* item, uint64_t seed0, uint64_t seed1, void* udata);
 static int32_t jmir_valueOperandItemCompare(const void* a, const void* b, void* udata);
+static uint64_t jmir_foldedInstrItemHash(const void* item, uint64_t seed0, uint64_t seed1, void* udata);
+static int32_t jmir_foldedInstrItemCompare(const void* a, const void* b, void* udata);
 
 typedef jx_mir_operand_t* (*jmirgen_instrBuildFunc)(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr);
 
@@ -110,6 +173,7 @@ static jmirgen_instrBuildFunc kIRInstrBuildFunc[] = {
 	[JIR_OP_MUL]             = jmirgen_instrBuild_mul,
 	[JIR_OP_DIV]             = jmirgen_instrBuild_div_rem,
 	[JIR_OP_REM]             = jmirgen_instrBuild_div_rem,
+	[JIR_OP_MULHI]           = jmirgen_instrBuild_mulhi,
 	[JIR_OP_AND]             = jmirgen_instrBuild_and,
 	[JIR_OP_OR]              = jmirgen_instrBuild_or,
 	[JIR_OP_XOR]             = jmirgen_instrBuild_xor,
@@ -139,6 +203,13 @@ static jmirgen_instrBuildFunc kIRInstrBuildFunc[] = {
 	[JIR_OP_FP2SI]           = jmirgen_instrBuild_fp2si,
 	[JIR_OP_UI2FP]           = jmirgen_instrBuild_ui2fp,
 	[JIR_OP_SI2FP]           = jmirgen_instrBuild_si2fp,
+	[JIR_OP_SELECT]          = jmirgen_instrBuild_select,
+	[JIR_OP_ROL]             = jmirgen_instrBuild_rotate,
+	[JIR_OP_ROR]             = jmirgen_instrBuild_rotate,
+	[JIR_OP_BSWAP]           = jmirgen_instrBuild_bswap,
+	[JIR_OP_POPCNT]          = jmirgen_instrBuild_popcnt,
+	[JIR_OP_CTLZ]            = jmirgen_instrBuild_ctlz,
+	[JIR_OP_CTTZ]            = jmirgen_instrBuild_cttz,
 };
 
 static const jx_mir_condition_code kIRCCToMIRCCSigned[] = {
@@ -159,6 +230,25 @@ static const jx_mir_condition_code kIRCCToMIRCCUnsigned[] = {
 	[JIR_CC_NE] = JMIR_CC_NE,
 };
 
+static const jmirgen_fold_pattern_t kFoldPatterns[] = {
+	// mov reg, [base + index * scale + disp]
+	// mov [base + index * scale + disp], reg
+	// lea reg, [base + index * scale + disp]
+	{ JIR_OP_LOAD,            JIR_OP_LOAD,            JIR_OP_GET_ELEMENT_PTR, JIR_OP_GET_ELEMENT_PTR, 0, JMIRGEN_FOLD_ADDRESS },
+	{ JIR_OP_STORE,           JIR_OP_STORE,           JIR_OP_GET_ELEMENT_PTR, JIR_OP_GET_ELEMENT_PTR, 0, JMIRGEN_FOLD_ADDRESS },
+	{ JIR_OP_GET_ELEMENT_PTR, JIR_OP_GET_ELEMENT_PTR, JIR_OP_GET_ELEMENT_PTR, JIR_OP_GET_ELEMENT_PTR, 0, JMIRGEN_FOLD_ADDRESS },
+
+	// op reg, [mem]
+	{ JIR_OP_ADD,             JIR_OP_ADD,             JIR_OP_LOAD,            JIR_OP_LOAD,            1, JMIRGEN_FOLD_MEMORY_OPERAND },
+	{ JIR_OP_SUB,             JIR_OP_SUB,             JIR_OP_LOAD,            JIR_OP_LOAD,            1, JMIRGEN_FOLD_MEMORY_OPERAND },
+	{ JIR_OP_AND,             JIR_OP_XOR,             JIR_OP_LOAD,            JIR_OP_LOAD,            1, JMIRGEN_FOLD_MEMORY_OPERAND },
+	{ JIR_OP_SET_LE,          JIR_OP_SET_NE,          JIR_OP_LOAD,            JIR_OP_LOAD,            1, JMIRGEN_FOLD_MEMORY_OPERAND },
+
+	// cmp lhs, rhs
+	// jcc bb
+	{ JIR_OP_BRANCH,          JIR_OP_BRANCH,          JIR_OP_SET_LE,          JIR_OP_SET_NE,          0, JMIRGEN_FOLD_FLAGS },
+};
+
 jx_mirgen_context_t* jx_mirgen_createContext(jx_ir_context_t* irCtx, jx_mir_context_t* mirCtx, jx_allocator_i* allocator)
 {
 	jx_mirgen_context_t* ctx = (jx_mirgen_context_t*)JX_ALLOC(allocator, sizeof(jx_mirgen_context_t));
@@ -170,6 +260,7 @@ jx_mirgen_context_t* jx_mirgen_createContext(jx_ir_context_t* irCtx, jx_mir_cont
 	ctx->m_Allocator = allocator;
 	ctx->m_IRCtx = irCtx;
 	ctx->m_MIRCtx = mirCtx;
+	ctx->m_CPUFeatures = jx_cpu_getFeatures();
 
 	ctx->m_FuncMap = jx_hashmapCreate(allocator, sizeof(jmir_func_item_t), 64, 0, 0, jmir_funcItemHash, jmir_funcItemCompare, NULL, NULL);
 	if (!ctx->m_FuncMap) {
@@ -189,6 +280,12 @@ jx_mirgen_context_t* jx_mirgen_createContext(jx_ir_context_t* irCtx, jx_mir_cont
 		return NULL;
 	}
 
+	ctx->m_FoldedInstrMap = jx_hashmapCreate(allocator, sizeof(jmir_folded_instr_item_t), 64, 0, 0, jmir_foldedInstrItemHash, jmir_foldedInstrItemCompare, NULL, NULL);
+	if (!ctx->m_FoldedInstrMap) {
+		jx_mirgen_destroyContext(ctx);
+		return NULL;
+	}
+
 	ctx->m_PhiInstrArr = (jx_ir_instruction_t**)jx_array_create(allocator);
 	if (!ctx->m_PhiInstrArr) {
 		jx_mirgen_destroyContext(ctx);
@@ -203,6 +300,11 @@ void jx_mirgen_destroyContext(jx_mirgen_context_t* ctx)
 	jx_allocator_i* allocator = ctx->m_Allocator;
 	jx_array_free(ctx->m_PhiInstrArr);
 
+	if (ctx->m_FoldedInstrMap) {
+		jx_hashmapDestroy(ctx->m_FoldedInstrMap);
+		ctx->m_FoldedInstrMap = NULL;
+	}
+
 	if (ctx->m_ValueMap) {
 		jx_hashmapDestroy(ctx->m_ValueMap);
 		ctx->m_ValueMap = NULL;
@@ -259,6 +361,13 @@ static bool jmirgen_globalVarBuild(jx_mirgen_context_t* ctx, const char* namePre
 		return jx_array_sizeu(irGV->super.super.m_OperandArr) == 0;
 	}
 
+	if (irGV->m_IsConstantGlobal) {
+		gv->m_Flags |= JMIR_GLOBAL_VAR_FLAGS_READ_ONLY_Msk;
+	}
+	if (irGV->super.m_LinkageKind == JIR_LINKAGE_INTERNAL) {
+		gv->m_Flags |= JMIR_GLOBAL_VAR_FLAGS_INTERNAL_Msk;
+	}
+
 	if (jx_array_sizeu(irGV->super.super.m_OperandArr)) {
 		jx_ir_constant_t* gvInit = jx_ir_valueToConst(irGV->super.super.m_OperandArr[0]->m_Value);
 		JX_CHECK(gvInit, "Expected constant value operand.");
@@ -402,6 +511,10 @@ static bool jmirgen_funcBuild(jx_mirgen_context_t* ctx, const char* namePrefix,
 	} else if (!jx_strcmp(funcName, "__debugbreak")) {
 		TracyCZoneEnd(tracyCtx);
 		return true;
+	} else if (!jx_strncmp(funcName, "__builtin_", 10)) {
+		// NOTE: Builtins are lowered to IR instructions by the bit idioms pass.
+		TracyCZoneEnd(tracyCtx);
+		return true;
 	}
 
 	jx_ir_type_function_t* irFuncType = jx_ir_funcGetType(irctx, irFunc);
@@ -432,9 +545,14 @@ static bool jmirgen_funcBuild(jx_mirgen_context_t* ctx, const char* namePrefix,
 	jx_mir_function_t* func = jx_mir_funcBegin(mirctx, funcName, funcProto);
 	if (func) {
 		ctx->m_Func = func;
+		func->m_Fingerprint = jx_mir_funcGetFingerprint(mirctx, funcName, irFunc->m_Fingerprint);
+		if (irFunc->super.m_LinkageKind == JIR_LINKAGE_INTERNAL) {
+			func->m_Flags |= JMIR_FUNC_FLAGS_INTERNAL_Msk;
+		}
 
 		jx_array_resize(ctx->m_PhiInstrArr, 0);
 		jx_hashmapClear(ctx->m_BasicBlockMap, false);
+		jx_hashmapClear(ctx->m_FoldedInstrMap, false);
 
 		jx_ir_basic_block_t* irBB = irFunc->m_BasicBlockListHead;
 		while (irBB) {
@@ -443,9 +561,12 @@ static bool jmirgen_funcBuild(jx_mirgen_context_t* ctx, const char* namePrefix,
 
 			ctx->m_BasicBlock = bb;
 
+			jmirgen_bbMatchPatterns(ctx, irBB);
+
 			jx_ir_instruction_t* irInstr = irBB->m_InstrListHead;
 			while (irInstr) {
-				if (!jmirgen_instrBuild(ctx, irInstr)) {
+				// NOTE: Folded instructions are selected as part of their (single) user.
+				if (!jmirgen_instrIsFolded(ctx, irInstr) && !jmirgen_instrBuild(ctx, irInstr)) {
 					TracyCZoneEnd(tracyCtx);
 					return false;
 				}
@@ -504,6 +625,12 @@ static jx_mir_operand_t* jmirgen_instrBuild_ret(jx_mirgen_context_t* ctx, jx_ir_
 {
 	JX_CHECK(retInstr->m_OpCode == JIR_OP_RET, "Expected ret instruction");
 
+	// Nothing to do if the function has already been exited by a tail call.
+	jx_mir_instruction_t* lastInstr = ctx->m_BasicBlock->m_InstrListTail;
+	if (lastInstr && lastInstr->m_OpCode == JMIR_OP_TAILCALL) {
+		return NULL;
+	}
+
 	jx_mir_operand_t* retReg = NULL;
 	const uint32_t numOperands = (uint32_t)jx_array_sizeu(retInstr->super.m_OperandArr);
 	if (numOperands == 1) {
@@ -572,16 +699,26 @@ static jx_mir_operand_t* jmirgen_instrBuild_branch(jx_mirgen_context_t* ctx, jx_
 		jx_mir_basic_block_t* mirTrueBB = jmirgen_getOrCreateBasicBlock(ctx, trueBB);
 		jx_mir_basic_block_t* mirFalseBB = jmirgen_getOrCreateBasicBlock(ctx, falseBB);
 
-		jx_mir_operand_t* condOperand = jmirgen_getOperand(ctx, condVal);
-		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_test(ctx->m_MIRCtx, condOperand, condOperand));
+		// If the condition is a comparison which has been folded into the branch, 
+		// jump directly on the flags set by the comparison.
+		// cmp lhs, rhs
+		// jcc bb_true or jncc bb_false
+		jx_mir_condition_code cc = JMIR_CC_NZ;
+		jx_ir_instruction_t* condInstr = jx_ir_valueToInstr(condVal);
+		if (condInstr && jmirgen_instrIsFolded(ctx, condInstr)) {
+			cc = jmirgen_genCompare(ctx, condInstr);
+		} else {
+			jx_mir_operand_t* condOperand = jmirgen_getOperand(ctx, condVal);
+			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_test(ctx->m_MIRCtx, condOperand, condOperand));
+		}
 
 		// NOTE: The code below tries to maximize fallthrough jumps (which will be eliminated) by
 		// checking which of the 2 target BBs are the next in the list to be handled.
 		if (falseBB == branchInstr->m_ParentBB->m_Next) {
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_jcc(ctx->m_MIRCtx, JMIR_CC_NZ, jx_mir_opBasicBlock(ctx->m_MIRCtx, ctx->m_Func, mirTrueBB)));
+			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_jcc(ctx->m_MIRCtx, cc, jx_mir_opBasicBlock(ctx->m_MIRCtx, ctx->m_Func, mirTrueBB)));
 			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_jmp(ctx->m_MIRCtx, jx_mir_opBasicBlock(ctx->m_MIRCtx, ctx->m_Func, mirFalseBB)));
 		} else {
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_jcc(ctx->m_MIRCtx, JMIR_CC_Z, jx_mir_opBasicBlock(ctx->m_MIRCtx, ctx->m_Func, mirFalseBB)));
+			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_jcc(ctx->m_MIRCtx, jx_mir_ccInvert(cc), jx_mir_opBasicBlock(ctx->m_MIRCtx, ctx->m_Func, mirFalseBB)));
 			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_jmp(ctx->m_MIRCtx, jx_mir_opBasicBlock(ctx->m_MIRCtx, ctx->m_Func, mirTrueBB)));
 		}
 	} else {
@@ -755,8 +892,8 @@ static jx_mir_operand_t* jmirgen_instrBuild_div_rem(jx_mirgen_context_t* ctx, jx
 		JX_CHECK(type == JMIR_TYPE_I32 || type == JMIR_TYPE_I64 || type == JMIR_TYPE_PTR, "Expected 32-bit or 64-bit division");
 
 		if (rhs->m_Kind == JMIR_OPERAND_CONST) {
-			// TODO: Div by constant. Try to avoid div/idiv. Is this the right place to do this or it's better to 
-			// add an IR pass?
+			// NOTE: Most divisions by constants have already been replaced by multiply-high sequences
+			// by the IR peephole pass. The ones left here (e.g. x / -1) still need a register operand.
 			jx_mir_operand_t* reg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, rhs->m_Type);
 			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, reg, rhs));
 			rhs = reg;
@@ -799,6 +936,44 @@ static jx_mir_operand_t* jmirgen_instrBuild_div_rem(jx_mirgen_context_t* ctx, jx
 	return dstReg;
 }
 
+static jx_mir_operand_t* jmirgen_instrBuild_mulhi(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
+{
+	JX_CHECK(irInstr->m_OpCode == JIR_OP_MULHI, "Expected mulhi instruction");
+	jx_ir_value_t* instrVal = jx_ir_instrToValue(irInstr);
+	jx_ir_type_t* instrType = instrVal->m_Type;
+
+	jx_mir_operand_t* lhs = jmirgen_getOperand(ctx, irInstr->super.m_OperandArr[0]->m_Value);
+	jx_mir_operand_t* rhs = jmirgen_getOperand(ctx, irInstr->super.m_OperandArr[1]->m_Value);
+
+	jx_mir_type_kind type = jmirgen_convertType(instrType);
+	JX_CHECK(type == JMIR_TYPE_I32 || type == JMIR_TYPE_I64, "Expected 32-bit or 64-bit mulhi");
+
+	jx_mir_operand_t* dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, type);
+
+	// MUL/IMUL r/m do not accept immediate operands.
+	if (rhs->m_Kind == JMIR_OPERAND_CONST) {
+		jx_mir_operand_t* reg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, rhs->m_Type);
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, reg, rhs));
+		rhs = reg;
+	}
+
+	jx_mir_operand_t* loReg = jx_mir_opHWReg(ctx->m_MIRCtx, ctx->m_Func, type, kMIRRegGP_A);
+	jx_mir_operand_t* hiReg = jx_mir_opHWReg(ctx->m_MIRCtx, ctx->m_Func, type, kMIRRegGP_D);
+
+	// mov eax, lhs
+	// mul/imul rhs
+	// mov reg, edx
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, loReg, lhs));
+	if (jx_ir_typeIsSigned(instrType)) {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_imul1(ctx->m_MIRCtx, rhs));
+	} else {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mul(ctx->m_MIRCtx, rhs));
+	}
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, dstReg, hiReg));
+
+	return dstReg;
+}
+
 static jx_mir_operand_t* jmirgen_instrBuild_and(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
 {
 	JX_CHECK(irInstr->m_OpCode == JIR_OP_AND, "Expected and instruction");
@@ -867,40 +1042,49 @@ static jx_mir_operand_t* jmirgen_instrBuild_xor(jx_mirgen_context_t* ctx, jx_ir_
 
 static jx_mir_operand_t* jmirgen_instrBuild_setcc(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
 {
+	// cmp lhs, rhs
+	// setcc reg8
+	const jx_mir_condition_code mirCC = jmirgen_genCompare(ctx, irInstr);
+
+	jx_mir_operand_t* dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I8);
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_setcc(ctx->m_MIRCtx, mirCC, dstReg));
+
+	return dstReg;
+}
+
+// Emits the comparison of a setcc IR instruction and returns the condition code
+// which must be used to test the resulting flags.
+static jx_mir_condition_code jmirgen_genCompare(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
+{
+	JX_CHECK(irInstr->m_OpCode >= JIR_OP_SET_LE && irInstr->m_OpCode <= JIR_OP_SET_NE, "Expected setcc instruction");
+
 	jx_ir_value_t* lhsVal = irInstr->super.m_OperandArr[0]->m_Value;
 	jx_ir_value_t* rhsVal = irInstr->super.m_OperandArr[1]->m_Value;
 	jx_mir_operand_t* lhs = jmirgen_getOperand(ctx, lhsVal);
 	jx_mir_operand_t* rhs = jmirgen_getOperand(ctx, rhsVal);
-	if (!lhs || !rhs) {
-		return NULL;
-	}
 
 	jx_ir_type_t* cmpType = lhsVal->m_Type;
 
-	jx_mir_operand_t* dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I8);;
-
 	jx_ir_condition_code irCC = irInstr->m_OpCode - JIR_OP_SET_CC_BASE;
 
+	jx_mir_condition_code mirCC = JMIR_CC_E;
 	if (jx_ir_typeIsFloatingPoint(cmpType)) {
-		jx_mir_condition_code mirCC = kIRCCToMIRCCUnsigned[irCC];
+		mirCC = kIRCCToMIRCCUnsigned[irCC];
 			
 		if (cmpType->m_Kind == JIR_TYPE_F32) {
 			rhs = jmirgen_ensureOperandRegOrMem(ctx, rhs);
 			lhs = jmirgen_ensureOperandReg(ctx, lhs);
 			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_ucomiss(ctx->m_MIRCtx, lhs, rhs));
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_setcc(ctx->m_MIRCtx, mirCC, dstReg));
 		} else if (cmpType->m_Kind == JIR_TYPE_F64) {
 			rhs = jmirgen_ensureOperandRegOrMem(ctx, rhs);
 			lhs = jmirgen_ensureOperandReg(ctx, lhs);
 			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_ucomisd(ctx->m_MIRCtx, lhs, rhs));
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_setcc(ctx->m_MIRCtx, mirCC, dstReg));
 		} else {
 			JX_CHECK(false, "Unknown floating point type.");
 		}
 	} else {
 		// cmp lhs, rhs
-		// setcc reg8
-		jx_mir_condition_code mirCC = jx_ir_typeIsSigned(cmpType)
+		mirCC = jx_ir_typeIsSigned(cmpType)
 			? kIRCCToMIRCCSigned[irCC]
 			: kIRCCToMIRCCUnsigned[irCC]
 			;
@@ -911,22 +1095,23 @@ static jx_mir_operand_t* jmirgen_instrBuild_setcc(jx_mirgen_context_t* ctx, jx_i
 			rhs = jmirgen_ensureOperandReg(ctx, rhs);
 			lhs = jmirgen_ensureOperandReg(ctx, lhs);
 			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_cmp(ctx->m_MIRCtx, lhs, rhs));
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_setcc(ctx->m_MIRCtx, mirCC, dstReg));
 		} else if (lhsConst && !rhsConst) {
 			// Swap operands and condition code.
 			lhs = jmirgen_ensureOperandNotConstI64(ctx, lhs);
 			lhs = jmirgen_ensureOperandRegOrMem(ctx, lhs);
 			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_cmp(ctx->m_MIRCtx, rhs, lhs));
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_setcc(ctx->m_MIRCtx, jx_mir_ccSwapOperands(mirCC), dstReg));
+			mirCC = jx_mir_ccSwapOperands(mirCC);
 		} else {
 			rhs = jmirgen_ensureOperandNotConstI64(ctx, rhs);
 			rhs = jmirgen_ensureOperandRegOrMem(ctx, rhs);
+			if (rhs->m_Kind == JMIR_OPERAND_MEMORY_REF) {
+				lhs = jmirgen_ensureOperandReg(ctx, lhs);
+			}
 			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_cmp(ctx->m_MIRCtx, lhs, rhs));
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_setcc(ctx->m_MIRCtx, mirCC, dstReg));
 		}
 	}
 
-	return dstReg;
+	return mirCC;
 }
 
 static jx_mir_operand_t* jmirgen_instrBuild_alloca(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
@@ -965,45 +1150,12 @@ static jx_mir_operand_t* jmirgen_instrBuild_load(jx_mirgen_context_t* ctx, jx_ir
 	jx_ir_type_pointer_t* ptrType = jx_ir_typeToPointer(ptrVal->m_Type);
 	JX_CHECK(ptrType, "Expected pointer type!");
 
-	jx_mir_operand_t* srcOperand = jmirgen_getOperand(ctx, ptrVal);
-
-	jx_mir_operand_t* dstReg = NULL;
-
 	jx_mir_type_kind regType = jmirgen_convertType(ptrType->m_BaseType);
-	dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, regType);
-
-	if (srcOperand->m_Kind != JMIR_OPERAND_REGISTER) {
-		if (jx_mir_opIsStackObj(srcOperand)) {
-			jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, tmpReg, srcOperand));
-			srcOperand = tmpReg;
-		} else if (srcOperand->m_Kind == JMIR_OPERAND_EXTERNAL_SYMBOL) {
-			jx_mir_global_variable_t* gv = jx_mir_getGlobalVarByName(ctx->m_MIRCtx, srcOperand->u.m_ExternalSymbol.m_Name);
-			JX_CHECK(gv, "Global variable not found");
-			const bool hasData = jx_array_sizeu(gv->m_DataArr) != 0;
-			if (hasData) {
-				jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, tmpReg, srcOperand));
-				srcOperand = tmpReg;
-			} else {
-				jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmpReg, srcOperand));
-				srcOperand = tmpReg;
-			}
-		} else {
-			jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, regType);
-			if (regType == JMIR_TYPE_F32) {
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_movss(ctx->m_MIRCtx, tmpReg, srcOperand));
-			} else if (regType == JMIR_TYPE_F64) {
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_movsd(ctx->m_MIRCtx, tmpReg, srcOperand));
-			} else {
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmpReg, srcOperand));
-			}
-			srcOperand = tmpReg;
-		}
-	}
+	jx_mir_operand_t* dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, regType);
 
-	jx_mir_operand_t* memRef = jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, regType, srcOperand->u.m_Reg, kMIRRegGPNone, 1, 0);
+	jmirgen_address_t addr;
+	jmirgen_matchAddress(ctx, ptrVal, &addr);
+	jx_mir_operand_t* memRef = jmirgen_addressToMemRef(ctx, &addr, regType);
 	if (regType == JMIR_TYPE_F32) {
 		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_movss(ctx->m_MIRCtx, dstReg, memRef));
 	} else if (regType == JMIR_TYPE_F64) {
@@ -1023,30 +1175,13 @@ static jx_mir_operand_t* jmirgen_instrBuild_store(jx_mirgen_context_t* ctx, jx_i
 	jx_ir_type_pointer_t* ptrType = jx_ir_typeToPointer(ptrVal->m_Type);
 	JX_CHECK(ptrType, "Expected pointer type!");
 
-	jx_mir_operand_t* dstOperand = jmirgen_getOperand(ctx, ptrVal);
 	jx_mir_operand_t* srcOperand = jmirgen_getOperand(ctx, irInstr->super.m_OperandArr[1]->m_Value);
 
 	jx_mir_type_kind regType = jmirgen_convertType(ptrType->m_BaseType);
 
-	jx_mir_operand_t* memRef = NULL;
-	if (dstOperand->m_Kind == JMIR_OPERAND_REGISTER) {
-		memRef = jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, regType, dstOperand->u.m_Reg, kMIRRegGPNone, 1, 0);
-	} else if (jx_mir_opIsStackObj(dstOperand)) {
-		memRef = dstOperand;
-	} else if (dstOperand->m_Kind == JMIR_OPERAND_EXTERNAL_SYMBOL) {
-		jx_mir_global_variable_t* gv = jx_mir_getGlobalVarByName(ctx->m_MIRCtx, dstOperand->u.m_ExternalSymbol.m_Name);
-		JX_CHECK(gv, "Global variable not found");
-		const bool hasData = jx_array_sizeu(gv->m_DataArr) != 0;
-		jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
-		if (hasData) {
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, tmpReg, dstOperand));
-		} else {
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmpReg, dstOperand));
-		}
-		memRef = jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, regType, tmpReg->u.m_Reg, kMIRRegGPNone, 1, 0);
-	} else {
-		JX_CHECK(false, "Unhandle store destination operand.");
-	}
+	jmirgen_address_t addr;
+	jmirgen_matchAddress(ctx, ptrVal, &addr);
+	jx_mir_operand_t* memRef = jmirgen_addressToMemRef(ctx, &addr, regType);
 
 	if (jx_mir_opIsStackObj(srcOperand)) {
 		jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
@@ -1093,199 +1228,12 @@ static jx_mir_operand_t* jmirgen_instrBuild_gep(jx_mirgen_context_t* ctx, jx_ir_
 {
 	JX_CHECK(gepInstr->m_OpCode == JIR_OP_GET_ELEMENT_PTR, "Expected GEP instruction");
 
-	// Result is always a pointer.
-	jx_mir_operand_t* dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
-
-	const uint32_t numOperands = (uint32_t)jx_array_sizeu(gepInstr->super.m_OperandArr);
-	JX_CHECK(numOperands >= 2, "GEP instruction expected to have at least 2 operands!");
-
-	jx_ir_value_t* basePtrVal = gepInstr->super.m_OperandArr[0]->m_Value;
-	jx_ir_type_pointer_t* basePtrType = jx_ir_typeToPointer(basePtrVal->m_Type);
-	JX_CHECK(basePtrType, "Expected pointer type");
-
-	jx_mir_operand_t* basePtrOperand = jmirgen_getOperand(ctx, basePtrVal);
-	if (jx_mir_opIsStackObj(basePtrOperand)) {
-		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, basePtrOperand));
-	} else if (basePtrOperand->m_Kind == JMIR_OPERAND_EXTERNAL_SYMBOL) {
-		jx_mir_global_variable_t* gv = jx_mir_getGlobalVarByName(ctx->m_MIRCtx, basePtrOperand->u.m_ExternalSymbol.m_Name);
-		JX_CHECK(gv, "Global variable not found");
-		const bool hasData = jx_array_sizeu(gv->m_DataArr) != 0;
-		if (hasData) {
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, basePtrOperand));
-		} else {
-			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, dstReg, basePtrOperand));
-		}
-	} else {
-		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, dstReg, basePtrOperand));
-	}
-	jx_ir_type_t* dstRegType = basePtrVal->m_Type;
+	// lea reg, [base + index * scale + disp]
+	jmirgen_address_t addr;
+	jmirgen_matchGEP(ctx, gepInstr, &addr);
 
-	for (uint32_t iOperand = 1; iOperand < numOperands; ++iOperand) {
-		jx_ir_value_t* operandVal = gepInstr->super.m_OperandArr[iOperand]->m_Value;
-		JX_CHECK(jx_ir_typeIsInteger(operandVal->m_Type), "Expeced index to have integer type!");
-		jx_mir_operand_t* indexOperand = jmirgen_getOperand(ctx, operandVal);
-		if (indexOperand->m_Kind == JMIR_OPERAND_CONST) {
-			if (dstRegType->m_Kind == JIR_TYPE_POINTER) {
-				JX_CHECK(iOperand == 1, "Only first index can be on a pointer type.");
-				jx_ir_type_pointer_t* ptrType = jx_ir_typeToPointer(dstRegType);
-				const size_t itemSize = jx_ir_typeGetSize(ptrType->m_BaseType);
-				const int64_t displacement = indexOperand->u.m_ConstI64 * (int64_t)itemSize;
-				JX_CHECK(displacement <= INT32_MAX, "Displacement too large");
-				if (displacement != 0) {
-					jx_mir_operand_t* memRef = jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR, dstReg->u.m_Reg, kMIRRegGPNone, 1, (int32_t)displacement);
-
-					dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
-					jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, memRef));
-				}
-				dstRegType = ptrType->m_BaseType;
-			} else if (dstRegType->m_Kind == JIR_TYPE_ARRAY) {
-				jx_ir_type_array_t* arrType = jx_ir_typeToArray(dstRegType);
-				const size_t itemSize = jx_ir_typeGetSize(arrType->m_BaseType);
-				const int64_t displacement = indexOperand->u.m_ConstI64 * (int64_t)itemSize;
-				JX_CHECK(displacement <= INT32_MAX, "Displacement too large");
-				if (displacement != 0) {
-					jx_mir_operand_t* memRef = jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR, dstReg->u.m_Reg, kMIRRegGPNone, 1, (int32_t)displacement);
-
-					dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
-					jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, memRef));
-				}
-				dstRegType = arrType->m_BaseType;
-			} else if (dstRegType->m_Kind == JIR_TYPE_STRUCT) {
-				jx_ir_type_struct_t* structType = jx_ir_typeToStruct(dstRegType);
-				JX_CHECK(indexOperand->u.m_ConstI64 < structType->m_NumMembers, "Invalid struct member index!");
-				jx_ir_struct_member_t* member = &structType->m_Members[indexOperand->u.m_ConstI64];
-				const uint32_t memberOffset = (uint32_t)jx_ir_typeStructGetMemberOffset(structType, (uint32_t)indexOperand->u.m_ConstI64);
-				JX_CHECK(memberOffset <= INT32_MAX, "Displacement too large");
-				if (memberOffset != 0) {
-					jx_mir_operand_t* memRef = jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR, dstReg->u.m_Reg, kMIRRegGPNone, 1, (int32_t)memberOffset);
-
-					dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
-					jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, memRef));
-				}
-				dstRegType = member->m_Type;
-			} else {
-				JX_CHECK(false, "Unexpected type in GEP index list");
-			}
-		} else {
-			jx_ir_type_t* baseType = NULL;
-			if (dstRegType->m_Kind == JIR_TYPE_POINTER) {
-				JX_CHECK(iOperand == 1, "Only first index can be on a pointer type.");
-				jx_ir_type_pointer_t* ptrType = jx_ir_typeToPointer(dstRegType);
-				baseType = ptrType->m_BaseType;
-			} else if (dstRegType->m_Kind == JIR_TYPE_ARRAY) {
-				jx_ir_type_array_t* arrType = jx_ir_typeToArray(dstRegType);
-				baseType = arrType->m_BaseType;
-			} else {
-				JX_CHECK(false, "Unexpected type in GEP index list");
-			}
-
-			JX_CHECK(baseType, "This will fail!");
-
-			if (indexOperand->m_Kind != JMIR_OPERAND_REGISTER) {
-				jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
-				if (indexOperand->m_Type != JMIR_TYPE_PTR && indexOperand->m_Type != JMIR_TYPE_I64) {
-					jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_movsx(ctx->m_MIRCtx, tmp, indexOperand));
-				} else {
-					jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmp, indexOperand));
-				}
-				indexOperand = tmp;
-			} else {
-				if (indexOperand->m_Type != JMIR_TYPE_PTR && indexOperand->m_Type != JMIR_TYPE_I64) {
-					jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
-					jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_movsx(ctx->m_MIRCtx, tmp, indexOperand));
-					indexOperand = tmp;
-				}
-			}
-
-			const uint32_t itemSize = (uint32_t)jx_ir_typeGetSize(baseType);
-#if 0
-			switch (itemSize) {
-			case 1:
-			case 2:
-			case 4: 
-			case 8: {
-				// dst = dst + index * (1,2,4,8)
-				//  =>
-				// lea %dst, [%dst + %index * (1,2,4,8]
-				jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
-				jx_mir_operand_t* memRef = jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR, dstReg->u.m_Reg, indexOperand->u.m_Reg, itemSize, 0);
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, tmp, memRef));
-				dstReg = tmp;
-			} break;
-			case 3:
-			case 6:
-			case 12: 
-			case 24: {
-				// dst = dst + (index * 3) * (1,2,4,8)
-				//  =>
-				// lea %tmp, [%index + %index * 2]
-				// lea %dst, [%dst + %tmp * (1,2,4,8)]
-				jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, tmp, jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, indexOperand->u.m_Reg, indexOperand->u.m_Reg, 2, 0)));
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, dstReg->u.m_Reg, tmp->u.m_Reg, itemSize / 3, 0)));
-			} break;
-			case 5: 
-			case 10: 
-			case 20: 
-			case 40: {
-				// dst = dst + (index * 5) * (1,2,4,8)
-				//  =>
-				// lea %tmp, [%index + %index * 4]
-				// lea %dst, [%dst + %tmp * (1,2,4,8)]
-				jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, tmp, jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, indexOperand->u.m_Reg, indexOperand->u.m_Reg, 4, 0)));
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, dstReg->u.m_Reg, tmp->u.m_Reg, itemSize / 5, 0)));
-			} break;
-			case 9: 
-			case 18: 
-			case 36: 
-			case 72: {
-				// dst = dst + (index * 9) * (1,2,4,8)
-				//  =>
-				// lea %tmp, [%index + %index * 8]
-				// lea %dst, [%dst + %tmp * (1,2,4,8)]
-				jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, tmp, jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, indexOperand->u.m_Reg, indexOperand->u.m_Reg, 8, 0)));
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, dstReg->u.m_Reg, tmp->u.m_Reg, itemSize / 9, 0)));
-			} break;
-			case 16: {
-				// dst = dst + (index * 2) * 8
-				//  =>
-				// lea %tmp, [%index + %index]
-				// lea %dst, [%dst + %tmp * 8]
-				jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, tmp, jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, indexOperand->u.m_Reg, indexOperand->u.m_Reg, 1, 0)));
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, dstReg->u.m_Reg, tmp->u.m_Reg, itemSize / 2, 0)));
-			} break;
-			default: {
-				jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_imul3(ctx->m_MIRCtx, tmp, indexOperand, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, itemSize)));
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_add(ctx->m_MIRCtx, dstReg, tmp));
-			} break;
-			}
-#else
-			if (itemSize <= 8 && jx_isPow2_u32(itemSize)) {
-				jx_mir_operand_t* memRef = jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR, dstReg->u.m_Reg, indexOperand->u.m_Reg, itemSize, 0);
-
-				dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, memRef));
-			} else {
-				jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
-#if 0
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmp, indexOperand));
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_imul(ctx->m_MIRCtx, tmp, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, itemSize)));
-#else
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_imul3(ctx->m_MIRCtx, tmp, indexOperand, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, itemSize)));
-#endif
-				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_add(ctx->m_MIRCtx, dstReg, tmp));
-			}
-#endif
-
-			dstRegType = baseType;
-		}
-	}
-
-	return dstReg;
+	// Result is always a pointer.
+	return jmirgen_addressToReg(ctx, &addr);
 }
 
 static jx_mir_operand_t* jmirgen_instrBuild_phi(jx_mirgen_context_t* ctx, jx_ir_instruction_t* phiInstr)
@@ -1338,8 +1286,26 @@ static jx_mir_operand_t* jmirgen_instrBuild_call(jx_mirgen_context_t* ctx, jx_ir
 	jx_ir_type_function_t* funcType = jx_ir_typeToFunction(funcPtrType->m_BaseType);
 	JX_CHECK(funcType, "Expected function type");
 
+	// Calls marked by the IR as tail calls are immediately followed by a ret of their result. 
+	// If all arguments are passed in registers, tear down the frame and jump to the callee 
+	// instead. The callee will reuse the caller's shadow space and return address.
+	// NOTE: The ret is skipped by jmirgen_instrBuild_ret() so it must either be a void ret 
+	// or return the call's result; anything else would return whatever the callee left in 
+	// the return register.
+	jx_ir_instruction_t* nextInstr = irInstr->m_Next;
+	const bool isTailCall = true
+		&& (jx_ir_instrToValue(irInstr)->m_Flags & JIR_VALUE_FLAGS_TAIL_CALL_Msk) != 0
+		&& nextInstr
+		&& nextInstr->m_OpCode == JIR_OP_RET
+		&& (jx_array_sizeu(nextInstr->super.m_OperandArr) == 0 || nextInstr->super.m_OperandArr[0]->m_Value == jx_ir_instrToValue(irInstr))
+		&& jx_ir_valueToFunc(funcPtrVal) != NULL
+		&& numOperands - 1 <= JX_COUNTOF(kMIRFuncArgIReg)
+		;
+
 	// Make sure the stack has enough space for N-argument call
-	jx_mir_funcAllocStackForCall(ctx->m_MIRCtx, ctx->m_Func, numOperands - 1);
+	if (!isTailCall) {
+		jx_mir_funcAllocStackForCall(ctx->m_MIRCtx, ctx->m_Func, numOperands - 1);
+	}
 
 	for (uint32_t iOperand = 1; iOperand < numOperands; ++iOperand) {
 		jx_ir_value_t* argVal = irInstr->super.m_OperandArr[iOperand]->m_Value;
@@ -1381,6 +1347,18 @@ static jx_mir_operand_t* jmirgen_instrBuild_call(jx_mirgen_context_t* ctx, jx_ir
 		funcOp = jmirgen_ensureOperandReg(ctx, funcOp);
 	}
 	jx_mir_function_proto_t* funcProto = jmirgen_funcTypeToProto(ctx, funcType);
+	if (isTailCall) {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_tailcall(ctx->m_MIRCtx, funcOp, funcProto));
+
+		// NOTE: The result is already in the return register and it's only used by the ret.
+		if (funcType->m_RetType->m_Kind == JIR_TYPE_VOID) {
+			return NULL;
+		}
+
+		jx_mir_type_kind retType = jmirgen_convertType(funcType->m_RetType);
+		return jx_mir_opHWReg(ctx->m_MIRCtx, ctx->m_Func, retType, jx_mir_typeIsFloatingPoint(retType) ? kMIRRegXMM_0 : kMIRRegGP_A);
+	}
+
 	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_call(ctx->m_MIRCtx, funcOp, funcProto));
 
 	// Get result from rret register into a virtual register
@@ -1463,6 +1441,220 @@ static jx_mir_operand_t* jmirgen_instrBuild_shr(jx_mirgen_context_t* ctx, jx_ir_
 	return dstReg;
 }
 
+static jx_mir_operand_t* jmirgen_instrBuild_rotate(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
+{
+	JX_CHECK(irInstr->m_OpCode == JIR_OP_ROL || irInstr->m_OpCode == JIR_OP_ROR, "Expected rol or ror instruction");
+
+	jx_ir_type_t* instrType = jx_ir_instrToValue(irInstr)->m_Type;
+	JX_CHECK(jx_ir_typeIsInteger(instrType), "Expected integer rotate");
+
+	jx_mir_operand_t* lhs = jmirgen_getOperand(ctx, irInstr->super.m_OperandArr[0]->m_Value);
+	jx_mir_operand_t* rhs = jmirgen_getOperand(ctx, irInstr->super.m_OperandArr[1]->m_Value);
+	jx_mir_operand_t* dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, jmirgen_convertType(instrType));
+
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, dstReg, lhs));
+
+	if (rhs->m_Kind == JMIR_OPERAND_CONST) {
+		// NOTE: The CPU masks the rotate count anyway. Mask it here so it always fits into imm8.
+		const int64_t mask = (int64_t)(jx_ir_typeGetSize(instrType) * 8 - 1);
+		rhs = jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I8, rhs->u.m_ConstI64 & mask);
+	} else {
+		jx_mir_operand_t* cl = jx_mir_opHWReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I8, kMIRRegGP_C);
+		if (rhs->m_Type != JMIR_TYPE_I8) {
+			rhs = jmirgen_ensureOperandReg(ctx, rhs);
+			rhs = jx_mir_opRegAlias(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I8, rhs->u.m_Reg);
+		}
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, cl, rhs));
+		rhs = cl;
+	}
+
+	if (irInstr->m_OpCode == JIR_OP_ROL) {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_rol(ctx->m_MIRCtx, dstReg, rhs));
+	} else {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_ror(ctx->m_MIRCtx, dstReg, rhs));
+	}
+
+	return dstReg;
+}
+
+// 16-bit: mov dst, src; ror dst, 8
+// 32/64-bit: mov dst, src; bswap dst
+static jx_mir_operand_t* jmirgen_instrBuild_bswap(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
+{
+	JX_CHECK(irInstr->m_OpCode == JIR_OP_BSWAP, "Expected bswap instruction");
+
+	jx_ir_type_t* instrType = jx_ir_instrToValue(irInstr)->m_Type;
+	JX_CHECK(jx_ir_typeIsInteger(instrType), "Expected integer bswap");
+
+	jx_mir_operand_t* operand = jmirgen_getOperand(ctx, irInstr->super.m_OperandArr[0]->m_Value);
+	jx_mir_type_kind type = jmirgen_convertType(instrType);
+	jx_mir_operand_t* dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, type);
+	jmirgen_genMov(ctx, dstReg, operand);
+
+	if (type == JMIR_TYPE_I16) {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_ror(ctx->m_MIRCtx, dstReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I8, 8)));
+	} else {
+		JX_CHECK(type == JMIR_TYPE_I32 || type == JMIR_TYPE_I64, "Invalid bswap type");
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_bswap(ctx->m_MIRCtx, dstReg));
+	}
+
+	return dstReg;
+}
+
+// popcnt/lzcnt/tzcnt and bsf/bsr do not have 8-bit forms, so 8-bit and 16-bit
+// operands are zero extended to 32 bits and the result is truncated back.
+static jx_mir_operand_t* jmirgen_bitCountWiden(jx_mirgen_context_t* ctx, jx_mir_operand_t* operand)
+{
+	operand = jmirgen_ensureOperandRegOrMem(ctx, operand);
+	return jmirgen_ensureOperandI32OrI64(ctx, operand, false);
+}
+
+static jx_mir_operand_t* jmirgen_bitCountResult(jx_mirgen_context_t* ctx, jx_mir_type_kind type, jx_mir_operand_t* wideReg)
+{
+	if (wideReg->m_Type == type) {
+		return wideReg;
+	}
+
+	jx_mir_operand_t* resReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, type);
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, resReg, jx_mir_opRegAlias(ctx->m_MIRCtx, ctx->m_Func, type, wideReg->u.m_Reg)));
+	return resReg;
+}
+
+// Without POPCNT:
+// x = x - ((x >> 1) & 0x55..55)
+// x = (x & 0x33..33) + ((x >> 2) & 0x33..33)
+// x = (x + (x >> 4)) & 0x0F..0F
+// x = (x * 0x01..01) >> (width - 8)
+static jx_mir_operand_t* jmirgen_instrBuild_popcnt(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
+{
+	JX_CHECK(irInstr->m_OpCode == JIR_OP_POPCNT, "Expected popcnt instruction");
+
+	jx_ir_type_t* instrType = jx_ir_instrToValue(irInstr)->m_Type;
+	JX_CHECK(jx_ir_typeIsInteger(instrType), "Expected integer popcnt");
+
+	jx_mir_type_kind type = jmirgen_convertType(instrType);
+	jx_mir_operand_t* operand = jmirgen_bitCountWiden(ctx, jmirgen_getOperand(ctx, irInstr->super.m_OperandArr[0]->m_Value));
+	jx_mir_type_kind wideType = operand->m_Type;
+
+	jx_mir_operand_t* resReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, wideType);
+	if ((ctx->m_CPUFeatures & JX_CPU_FEATURE_POPCNT) != 0) {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_popcnt(ctx->m_MIRCtx, resReg, operand));
+		return jmirgen_bitCountResult(ctx, type, resReg);
+	}
+
+	const bool is64Bit = wideType == JMIR_TYPE_I64;
+	jx_mir_operand_t* m1 = jmirgen_ensureOperandNotConstI64(ctx, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, wideType, is64Bit ? 0x5555555555555555ll : 0x55555555ll));
+	jx_mir_operand_t* m2 = jmirgen_ensureOperandNotConstI64(ctx, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, wideType, is64Bit ? 0x3333333333333333ll : 0x33333333ll));
+	jx_mir_operand_t* m4 = jmirgen_ensureOperandNotConstI64(ctx, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, wideType, is64Bit ? 0x0F0F0F0F0F0F0F0Fll : 0x0F0F0F0Fll));
+	jx_mir_operand_t* h01 = jmirgen_ensureOperandNotConstI64(ctx, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, wideType, is64Bit ? 0x0101010101010101ll : 0x01010101ll));
+	jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, wideType);
+
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, resReg, operand));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmpReg, resReg));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_shr(ctx->m_MIRCtx, tmpReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I8, 1)));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_and(ctx->m_MIRCtx, tmpReg, m1));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_sub(ctx->m_MIRCtx, resReg, tmpReg));
+
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmpReg, resReg));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_shr(ctx->m_MIRCtx, tmpReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I8, 2)));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_and(ctx->m_MIRCtx, tmpReg, m2));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_and(ctx->m_MIRCtx, resReg, m2));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_add(ctx->m_MIRCtx, resReg, tmpReg));
+
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmpReg, resReg));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_shr(ctx->m_MIRCtx, tmpReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I8, 4)));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_add(ctx->m_MIRCtx, resReg, tmpReg));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_and(ctx->m_MIRCtx, resReg, m4));
+
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_imul(ctx->m_MIRCtx, resReg, h01));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_shr(ctx->m_MIRCtx, resReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I8, is64Bit ? 56 : 24)));
+
+	return jmirgen_bitCountResult(ctx, type, resReg);
+}
+
+// With LZCNT:
+// lzcnt res, src
+// sub res, 32 - width (8/16-bit only)
+// 
+// Without LZCNT (bsr returns the index of the highest set bit and sets ZF if src is 0):
+// mov res, 2 * width - 1
+// bsr tmp, src
+// cmovnz res, tmp
+// xor res, width - 1
+static jx_mir_operand_t* jmirgen_instrBuild_ctlz(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
+{
+	JX_CHECK(irInstr->m_OpCode == JIR_OP_CTLZ, "Expected ctlz instruction");
+
+	jx_ir_type_t* instrType = jx_ir_instrToValue(irInstr)->m_Type;
+	JX_CHECK(jx_ir_typeIsInteger(instrType), "Expected integer ctlz");
+
+	jx_mir_type_kind type = jmirgen_convertType(instrType);
+	jx_mir_operand_t* operand = jmirgen_bitCountWiden(ctx, jmirgen_getOperand(ctx, irInstr->super.m_OperandArr[0]->m_Value));
+	jx_mir_type_kind wideType = operand->m_Type;
+	const int64_t width = (int64_t)jx_ir_typeGetSize(instrType) * 8;
+	const int64_t wideWidth = wideType == JMIR_TYPE_I64 ? 64 : 32;
+
+	jx_mir_operand_t* resReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, wideType);
+	if ((ctx->m_CPUFeatures & JX_CPU_FEATURE_LZCNT) != 0) {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lzcnt(ctx->m_MIRCtx, resReg, operand));
+		if (width != wideWidth) {
+			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_sub(ctx->m_MIRCtx, resReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, wideType, wideWidth - width)));
+		}
+	} else {
+		// NOTE: The operand has been zero extended so the index of the highest set bit
+		// is the same in the narrow and the wide type.
+		jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, wideType);
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, resReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, wideType, 2 * width - 1)));
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_bsr(ctx->m_MIRCtx, tmpReg, operand));
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_cmovcc(ctx->m_MIRCtx, JMIR_CC_NE, resReg, tmpReg));
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_xor(ctx->m_MIRCtx, resReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, wideType, width - 1)));
+	}
+
+	return jmirgen_bitCountResult(ctx, type, resReg);
+}
+
+// 8/16-bit operands get bit #width set before counting, which takes care of the zero 
+// input without any extra instructions:
+// or src, 1 << width
+// tzcnt/bsf res, src
+// 
+// 32/64-bit without BMI1 (bsf sets ZF if src is 0):
+// mov res, width
+// bsf tmp, src
+// cmovnz res, tmp
+static jx_mir_operand_t* jmirgen_instrBuild_cttz(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
+{
+	JX_CHECK(irInstr->m_OpCode == JIR_OP_CTTZ, "Expected cttz instruction");
+
+	jx_ir_type_t* instrType = jx_ir_instrToValue(irInstr)->m_Type;
+	JX_CHECK(jx_ir_typeIsInteger(instrType), "Expected integer cttz");
+
+	jx_mir_type_kind type = jmirgen_convertType(instrType);
+	jx_mir_operand_t* operand = jmirgen_bitCountWiden(ctx, jmirgen_getOperand(ctx, irInstr->super.m_OperandArr[0]->m_Value));
+	jx_mir_type_kind wideType = operand->m_Type;
+	const int64_t width = (int64_t)jx_ir_typeGetSize(instrType) * 8;
+	const int64_t wideWidth = wideType == JMIR_TYPE_I64 ? 64 : 32;
+
+	jx_mir_operand_t* resReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, wideType);
+	if (width != wideWidth) {
+		jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, wideType);
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmpReg, operand));
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_or(ctx->m_MIRCtx, tmpReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, wideType, 1ll << width)));
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, (ctx->m_CPUFeatures & JX_CPU_FEATURE_BMI1) != 0
+			? jx_mir_tzcnt(ctx->m_MIRCtx, resReg, tmpReg)
+			: jx_mir_bsf(ctx->m_MIRCtx, resReg, tmpReg));
+	} else if ((ctx->m_CPUFeatures & JX_CPU_FEATURE_BMI1) != 0) {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_tzcnt(ctx->m_MIRCtx, resReg, operand));
+	} else {
+		jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, wideType);
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, resReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, wideType, width)));
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_bsf(ctx->m_MIRCtx, tmpReg, operand));
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_cmovcc(ctx->m_MIRCtx, JMIR_CC_NE, resReg, tmpReg));
+	}
+
+	return jmirgen_bitCountResult(ctx, type, resReg);
+}
+
 static jx_mir_operand_t* jmirgen_instrBuild_trunc(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
 {
 	JX_CHECK(irInstr->m_OpCode == JIR_OP_TRUNC, "Expected trunc instruction");
@@ -1839,12 +2031,14 @@ static jx_mir_operand_t* jmirgen_instrBuild_ui2fp(jx_mirgen_context_t* ctx, jx_i
 			if (!jx_mir_getGlobalVarByName(ctx->m_MIRCtx, "$__ui64_to_f64_c0__$")) {
 				static const uint32_t ui64_to_f64_c0[4] = { 0x43300000, 0x45300000, 0, 0 };
 				jx_mir_global_variable_t* gv = jx_mir_globalVarBegin(ctx->m_MIRCtx, "$__ui64_to_f64_c0__$", 16);
+				gv->m_Flags |= JMIR_GLOBAL_VAR_FLAGS_READ_ONLY_Msk | JMIR_GLOBAL_VAR_FLAGS_INTERNAL_Msk;
 				jx_mir_globalVarAppendData(ctx->m_MIRCtx, gv, (const uint8_t*)&ui64_to_f64_c0[0], sizeof(uint32_t) * 4);
 				jx_mir_globalVarEnd(ctx->m_MIRCtx, gv);
 			}
 			if (!jx_mir_getGlobalVarByName(ctx->m_MIRCtx, "$__ui64_to_f64_c1__$")) {
 				static const uint64_t ui64_to_f64_c1[2] = { 0x4330000000000000ull, 0x4530000000000000ull };
 				jx_mir_global_variable_t* gv = jx_mir_globalVarBegin(ctx->m_MIRCtx, "$__ui64_to_f64_c1__$", 16);
+				gv->m_Flags |= JMIR_GLOBAL_VAR_FLAGS_READ_ONLY_Msk | JMIR_GLOBAL_VAR_FLAGS_INTERNAL_Msk;
 				jx_mir_globalVarAppendData(ctx->m_MIRCtx, gv, (const uint8_t*)&ui64_to_f64_c1[0], sizeof(uint64_t) * 2);
 				jx_mir_globalVarEnd(ctx->m_MIRCtx, gv);
 			}
@@ -1899,6 +2093,147 @@ static jx_mir_operand_t* jmirgen_instrBuild_si2fp(jx_mirgen_context_t* ctx, jx_i
 	return resReg;
 }
 
+static jx_mir_operand_t* jmirgen_instrBuild_select(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
+{
+	JX_CHECK(irInstr->m_OpCode == JIR_OP_SELECT, "Expected select instruction");
+
+	jx_ir_type_t* instrType = jx_ir_instrToValue(irInstr)->m_Type;
+	jx_ir_value_t* condVal = irInstr->super.m_OperandArr[0]->m_Value;
+	jx_ir_value_t* trueVal = irInstr->super.m_OperandArr[1]->m_Value;
+	jx_ir_value_t* falseVal = irInstr->super.m_OperandArr[2]->m_Value;
+
+	jx_mir_operand_t* cond = jmirgen_getOperand(ctx, condVal);
+	jx_mir_operand_t* trueOp = jmirgen_getOperand(ctx, trueVal);
+	jx_mir_operand_t* falseOp = jmirgen_getOperand(ctx, falseVal);
+	if (!cond || !trueOp || !falseOp) {
+		return NULL;
+	}
+
+	jx_mir_type_kind type = jmirgen_convertType(instrType);
+
+	if (cond->m_Kind == JMIR_OPERAND_CONST) {
+		jx_mir_operand_t* resReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, type);
+		jmirgen_genMov(ctx, resReg, cond->u.m_ConstI64 != 0 ? trueOp : falseOp);
+		return resReg;
+	}
+
+	if (!jx_ir_typeIsFloatingPoint(instrType)) {
+		return jmirgen_genSelectInt(ctx, type, cond, trueOp, falseOp);
+	}
+
+	// Check if this is a min/max pattern which can be lowered to minss/maxss (or minsd/maxsd).
+	// minss dst, src => dst = dst < src ? dst : src
+	// maxss dst, src => dst = dst > src ? dst : src
+	// so:
+	// a < b ? a : b => min(a, b)
+	// a > b ? a : b => max(a, b)
+	// a < b ? b : a => max(b, a)
+	// a > b ? b : a => min(b, a)
+	jx_ir_instruction_t* cmpInstr = jx_ir_valueToInstr(condVal);
+	if (cmpInstr && (cmpInstr->m_OpCode == JIR_OP_SET_LT || cmpInstr->m_OpCode == JIR_OP_SET_GT)) {
+		jx_ir_value_t* cmpLhs = cmpInstr->super.m_OperandArr[0]->m_Value;
+		jx_ir_value_t* cmpRhs = cmpInstr->super.m_OperandArr[1]->m_Value;
+		const bool isMinMax = false
+			|| (trueVal == cmpLhs && falseVal == cmpRhs)
+			|| (trueVal == cmpRhs && falseVal == cmpLhs)
+			;
+		if (isMinMax) {
+			const bool isMin = (cmpInstr->m_OpCode == JIR_OP_SET_LT) == (trueVal == cmpLhs);
+
+			falseOp = jmirgen_ensureOperandRegOrMem(ctx, falseOp);
+
+			jx_mir_operand_t* resReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, type);
+			jmirgen_genMov(ctx, resReg, trueOp);
+			if (type == JMIR_TYPE_F32) {
+				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, isMin
+					? jx_mir_minss(ctx->m_MIRCtx, resReg, falseOp)
+					: jx_mir_maxss(ctx->m_MIRCtx, resReg, falseOp));
+			} else if (type == JMIR_TYPE_F64) {
+				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, isMin
+					? jx_mir_minsd(ctx->m_MIRCtx, resReg, falseOp)
+					: jx_mir_maxsd(ctx->m_MIRCtx, resReg, falseOp));
+			} else {
+				JX_CHECK(false, "Unknown floating point type");
+			}
+
+			return resReg;
+		}
+	}
+
+	// Generic floating point select. Move both values to GP registers, 
+	// select using cmov and move the result back to an XMM register.
+	const bool isF32 = type == JMIR_TYPE_F32;
+	jx_mir_type_kind intType = isF32 ? JMIR_TYPE_I32 : JMIR_TYPE_I64;
+
+	trueOp = jmirgen_ensureOperandReg(ctx, trueOp);
+	falseOp = jmirgen_ensureOperandReg(ctx, falseOp);
+
+	jx_mir_operand_t* trueIntReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, intType);
+	jx_mir_operand_t* falseIntReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, intType);
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, isF32 ? jx_mir_movd(ctx->m_MIRCtx, trueIntReg, trueOp) : jx_mir_movq(ctx->m_MIRCtx, trueIntReg, trueOp));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, isF32 ? jx_mir_movd(ctx->m_MIRCtx, falseIntReg, falseOp) : jx_mir_movq(ctx->m_MIRCtx, falseIntReg, falseOp));
+
+	jx_mir_operand_t* intResReg = jmirgen_genSelectInt(ctx, intType, cond, trueIntReg, falseIntReg);
+
+	jx_mir_operand_t* resReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, type);
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, isF32 ? jx_mir_movd(ctx->m_MIRCtx, resReg, intResReg) : jx_mir_movq(ctx->m_MIRCtx, resReg, intResReg));
+
+	return resReg;
+}
+
+// mov res, falseOp
+// test cond, cond
+// cmovnz res, trueOp
+// 
+// NOTE: cmov does not support 8-bit operands so 8-bit selects are 
+// performed on 32-bit registers.
+static jx_mir_operand_t* jmirgen_genSelectInt(jx_mirgen_context_t* ctx, jx_mir_type_kind type, jx_mir_operand_t* cond, jx_mir_operand_t* trueOp, jx_mir_operand_t* falseOp)
+{
+	const bool is8Bit = type == JMIR_TYPE_I8;
+	jx_mir_type_kind cmovType = is8Bit ? JMIR_TYPE_I32 : type;
+
+	// cmov's source operand must be a register or a memory reference
+	if (is8Bit) {
+		jx_mir_operand_t* tmpReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I32);
+		if (trueOp->m_Kind == JMIR_OPERAND_CONST) {
+			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmpReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I32, (int64_t)(trueOp->u.m_ConstI64 & 0xFF))));
+		} else {
+			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_movzx(ctx->m_MIRCtx, tmpReg, jmirgen_ensureOperandRegOrMem(ctx, trueOp)));
+		}
+		trueOp = tmpReg;
+	} else {
+		trueOp = jmirgen_ensureOperandRegOrMem(ctx, trueOp);
+		if (trueOp->m_Kind == JMIR_OPERAND_MEMORY_REF && trueOp->m_Type != cmovType) {
+			trueOp = jmirgen_ensureOperandReg(ctx, trueOp);
+		}
+	}
+
+	jx_mir_operand_t* resReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, cmovType);
+	if (is8Bit) {
+		if (falseOp->m_Kind == JMIR_OPERAND_CONST) {
+			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, resReg, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I32, (int64_t)(falseOp->u.m_ConstI64 & 0xFF))));
+		} else {
+			jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_movzx(ctx->m_MIRCtx, resReg, jmirgen_ensureOperandRegOrMem(ctx, falseOp)));
+		}
+	} else {
+		if (falseOp->m_Kind != JMIR_OPERAND_CONST) {
+			falseOp = jmirgen_ensureOperandRegOrMem(ctx, falseOp);
+		}
+		jmirgen_genMov(ctx, resReg, falseOp);
+	}
+
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_test(ctx->m_MIRCtx, cond, cond));
+	jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_cmovcc(ctx->m_MIRCtx, JMIR_CC_NE, resReg, trueOp));
+
+	if (is8Bit) {
+		jx_mir_operand_t* res8Reg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, type);
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, res8Reg, jx_mir_opRegAlias(ctx->m_MIRCtx, ctx->m_Func, type, resReg->u.m_Reg)));
+		resReg = res8Reg;
+	}
+
+	return resReg;
+}
+
 static jx_mir_basic_block_t* jmirgen_getOrCreateBasicBlock(jx_mirgen_context_t* ctx, jx_ir_basic_block_t* irBB)
 {
 	jmir_basic_block_item_t* key = &(jmir_basic_block_item_t){
@@ -1939,7 +2274,15 @@ static jx_mir_basic_block_t* jmirgen_getBasicBlock(jx_mirgen_context_t* ctx, jx_
 static jx_mir_operand_t* jmirgen_getOperand(jx_mirgen_context_t* ctx, jx_ir_value_t* val)
 {
 	jx_mir_operand_t* operand = NULL;
-	if (val->m_Kind == JIR_VALUE_INSTRUCTION) {
+	if (val->m_Kind == JIR_VALUE_INSTRUCTION && jmirgen_instrIsFolded(ctx, jx_ir_valueToInstr(val))) {
+		// Folded load; the memory reference becomes the operand of the user.
+		jx_ir_instruction_t* loadInstr = jx_ir_valueToInstr(val);
+		JX_CHECK(loadInstr->m_OpCode == JIR_OP_LOAD, "Only loads can be used as operands when folded.");
+
+		jmirgen_address_t addr;
+		jmirgen_matchAddress(ctx, loadInstr->super.m_OperandArr[0]->m_Value, &addr);
+		operand = jmirgen_addressToMemRef(ctx, &addr, jmirgen_convertType(val->m_Type));
+	} else if (val->m_Kind == JIR_VALUE_INSTRUCTION) {
 		jmir_value_operand_item_t* item = (jmir_value_operand_item_t*)jx_hashmapGet(ctx->m_ValueMap, &(jmir_value_operand_item_t){.m_IRVal = val });
 		operand = item
 			? item->m_MIROperand
@@ -1990,6 +2333,235 @@ static jx_mir_operand_t* jmirgen_getOperand(jx_mirgen_context_t* ctx, jx_ir_valu
 	return operand;
 }
 
+// Marks all instructions of the basic block which can be folded into their user 
+// based on the patterns in kFoldPatterns. Folded instructions don't generate any 
+// code by themselves; they are selected together with their user.
+static void jmirgen_bbMatchPatterns(jx_mirgen_context_t* ctx, jx_ir_basic_block_t* irBB)
+{
+	jx_ir_instruction_t* userInstr = irBB->m_InstrListHead;
+	while (userInstr) {
+		const uint32_t numOperands = (uint32_t)jx_array_sizeu(userInstr->super.m_OperandArr);
+		for (uint32_t iOperand = 0; iOperand < numOperands; ++iOperand) {
+			jx_ir_value_t* operandVal = userInstr->super.m_OperandArr[iOperand]->m_Value;
+			jx_ir_instruction_t* defInstr = jx_ir_valueToInstr(operandVal);
+			const bool isCandidate = true
+				&& defInstr
+				&& defInstr->m_ParentBB == irBB
+				&& operandVal->m_UsesListHead
+				&& operandVal->m_UsesListHead == operandVal->m_UsesListTail
+				;
+			if (!isCandidate) {
+				continue;
+			}
+
+			const uint32_t numPatterns = (uint32_t)JX_COUNTOF(kFoldPatterns);
+			for (uint32_t iPattern = 0; iPattern < numPatterns; ++iPattern) {
+				const jmirgen_fold_pattern_t* pattern = &kFoldPatterns[iPattern];
+				const bool isMatch = true
+					&& userInstr->m_OpCode >= pattern->m_UserOpCodeFirst
+					&& userInstr->m_OpCode <= pattern->m_UserOpCodeLast
+					&& defInstr->m_OpCode >= pattern->m_DefOpCodeFirst
+					&& defInstr->m_OpCode <= pattern->m_DefOpCodeLast
+					&& iOperand == pattern->m_OperandID
+					&& jmirgen_patternCanFold(userInstr, defInstr, pattern->m_Kind)
+					;
+				if (isMatch) {
+					jx_hashmapSet(ctx->m_FoldedInstrMap, &(jmir_folded_instr_item_t){ .m_IRInstr = defInstr, .m_Kind = pattern->m_Kind });
+					break;
+				}
+			}
+		}
+
+		userInstr = userInstr->m_Next;
+	}
+}
+
+static bool jmirgen_patternCanFold(jx_ir_instruction_t* userInstr, jx_ir_instruction_t* defInstr, jmirgen_fold_kind kind)
+{
+	if (kind == JMIRGEN_FOLD_ADDRESS) {
+		// Address calculations don't access memory.
+		return true;
+	} else if (kind == JMIRGEN_FOLD_MEMORY_OPERAND) {
+		const jx_mir_type_kind type = jmirgen_convertType(jx_ir_instrToValue(defInstr)->m_Type);
+		const bool isScalar = false
+			|| type == JMIR_TYPE_I8
+			|| type == JMIR_TYPE_I16
+			|| type == JMIR_TYPE_I32
+			|| type == JMIR_TYPE_I64
+			|| type == JMIR_TYPE_F32
+			|| type == JMIR_TYPE_F64
+			;
+		if (!isScalar) {
+			return false;
+		}
+	}
+
+	// The def instruction is effectively moved to the position of its user. Make sure 
+	// there are no instructions in between which might write to memory.
+	jx_ir_instruction_t* instr = defInstr->m_Next;
+	while (instr && instr != userInstr) {
+		if (instr->m_OpCode == JIR_OP_STORE || instr->m_OpCode == JIR_OP_CALL) {
+			return false;
+		}
+
+		instr = instr->m_Next;
+	}
+
+	return instr == userInstr;
+}
+
+static bool jmirgen_instrIsFolded(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
+{
+	return jx_hashmapGet(ctx->m_FoldedInstrMap, &(jmir_folded_instr_item_t){ .m_IRInstr = irInstr }) != NULL;
+}
+
+static void jmirgen_matchAddress(jx_mirgen_context_t* ctx, jx_ir_value_t* ptrVal, jmirgen_address_t* addr)
+{
+	jx_ir_instruction_t* ptrInstr = jx_ir_valueToInstr(ptrVal);
+	if (ptrInstr && ptrInstr->m_OpCode == JIR_OP_GET_ELEMENT_PTR && jmirgen_instrIsFolded(ctx, ptrInstr)) {
+		jmirgen_matchGEP(ctx, ptrInstr, addr);
+		return;
+	}
+
+	jx_memset(addr, 0, sizeof(jmirgen_address_t));
+	addr->m_Scale = 1;
+
+	jx_mir_operand_t* ptrOperand = jmirgen_getOperand(ctx, ptrVal);
+	if (jx_mir_opIsStackObj(ptrOperand)) {
+		addr->m_StackObj = ptrOperand->u.m_MemRef;
+	} else {
+		addr->m_BaseReg = jmirgen_ensureOperandReg(ctx, ptrOperand);
+	}
+}
+
+static void jmirgen_matchGEP(jx_mirgen_context_t* ctx, jx_ir_instruction_t* gepInstr, jmirgen_address_t* addr)
+{
+	JX_CHECK(gepInstr->m_OpCode == JIR_OP_GET_ELEMENT_PTR, "Expected GEP instruction");
+
+	const uint32_t numOperands = (uint32_t)jx_array_sizeu(gepInstr->super.m_OperandArr);
+	JX_CHECK(numOperands >= 2, "GEP instruction expected to have at least 2 operands!");
+
+	jx_ir_value_t* basePtrVal = gepInstr->super.m_OperandArr[0]->m_Value;
+	JX_CHECK(jx_ir_typeToPointer(basePtrVal->m_Type), "Expected pointer type");
+
+	jmirgen_matchAddress(ctx, basePtrVal, addr);
+
+	jx_ir_type_t* curType = basePtrVal->m_Type;
+	for (uint32_t iOperand = 1; iOperand < numOperands; ++iOperand) {
+		jx_ir_value_t* operandVal = gepInstr->super.m_OperandArr[iOperand]->m_Value;
+		JX_CHECK(jx_ir_typeIsInteger(operandVal->m_Type), "Expeced index to have integer type!");
+		jx_mir_operand_t* indexOperand = jmirgen_getOperand(ctx, operandVal);
+		if (indexOperand->m_Kind == JMIR_OPERAND_CONST) {
+			if (curType->m_Kind == JIR_TYPE_POINTER) {
+				JX_CHECK(iOperand == 1, "Only first index can be on a pointer type.");
+				jx_ir_type_pointer_t* ptrType = jx_ir_typeToPointer(curType);
+				jmirgen_addressAddDisplacement(addr, indexOperand->u.m_ConstI64 * (int64_t)jx_ir_typeGetSize(ptrType->m_BaseType));
+				curType = ptrType->m_BaseType;
+			} else if (curType->m_Kind == JIR_TYPE_ARRAY) {
+				jx_ir_type_array_t* arrType = jx_ir_typeToArray(curType);
+				jmirgen_addressAddDisplacement(addr, indexOperand->u.m_ConstI64 * (int64_t)jx_ir_typeGetSize(arrType->m_BaseType));
+				curType = arrType->m_BaseType;
+			} else if (curType->m_Kind == JIR_TYPE_STRUCT) {
+				jx_ir_type_struct_t* structType = jx_ir_typeToStruct(curType);
+				JX_CHECK(indexOperand->u.m_ConstI64 < structType->m_NumMembers, "Invalid struct member index!");
+				jmirgen_addressAddDisplacement(addr, (int64_t)jx_ir_typeStructGetMemberOffset(structType, (uint32_t)indexOperand->u.m_ConstI64));
+				curType = structType->m_Members[indexOperand->u.m_ConstI64].m_Type;
+			} else {
+				JX_CHECK(false, "Unexpected type in GEP index list");
+			}
+		} else {
+			jx_ir_type_t* baseType = NULL;
+			if (curType->m_Kind == JIR_TYPE_POINTER) {
+				JX_CHECK(iOperand == 1, "Only first index can be on a pointer type.");
+				baseType = jx_ir_typeToPointer(curType)->m_BaseType;
+			} else if (curType->m_Kind == JIR_TYPE_ARRAY) {
+				baseType = jx_ir_typeToArray(curType)->m_BaseType;
+			} else {
+				JX_CHECK(false, "Unexpected type in GEP index list");
+			}
+
+			if (indexOperand->m_Kind != JMIR_OPERAND_REGISTER) {
+				jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
+				if (indexOperand->m_Type != JMIR_TYPE_PTR && indexOperand->m_Type != JMIR_TYPE_I64) {
+					jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_movsx(ctx->m_MIRCtx, tmp, indexOperand));
+				} else {
+					jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, tmp, indexOperand));
+				}
+				indexOperand = tmp;
+			} else if (indexOperand->m_Type != JMIR_TYPE_PTR && indexOperand->m_Type != JMIR_TYPE_I64) {
+				jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
+				jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_movsx(ctx->m_MIRCtx, tmp, indexOperand));
+				indexOperand = tmp;
+			}
+
+			jmirgen_addressAddIndex(ctx, addr, indexOperand, (uint32_t)jx_ir_typeGetSize(baseType));
+			curType = baseType;
+		}
+	}
+}
+
+static void jmirgen_addressAddDisplacement(jmirgen_address_t* addr, int64_t displacement)
+{
+	const int64_t newDisplacement = (int64_t)addr->m_Displacement + displacement;
+	JX_CHECK(newDisplacement >= INT32_MIN && newDisplacement <= INT32_MAX, "Displacement too large");
+	addr->m_Displacement = (int32_t)newDisplacement;
+}
+
+static void jmirgen_addressAddIndex(jx_mirgen_context_t* ctx, jmirgen_address_t* addr, jx_mir_operand_t* indexOperand, uint32_t itemSize)
+{
+	if (addr->m_IndexReg || addr->m_StackObj) {
+		// NOTE: There is only one index register per address and stack objects 
+		// cannot have an index register. Calculate the address so far and use 
+		// it as the base register.
+		jx_mir_operand_t* baseReg = jmirgen_addressToReg(ctx, addr);
+		jx_memset(addr, 0, sizeof(jmirgen_address_t));
+		addr->m_BaseReg = baseReg;
+		addr->m_Scale = 1;
+	}
+
+	if (itemSize <= 8 && jx_isPow2_u32(itemSize)) {
+		addr->m_IndexReg = indexOperand;
+		addr->m_Scale = itemSize;
+	} else {
+		jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64);
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_imul3(ctx->m_MIRCtx, tmp, indexOperand, jx_mir_opIConst(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_I64, itemSize)));
+		addr->m_IndexReg = tmp;
+		addr->m_Scale = 1;
+	}
+}
+
+static jx_mir_operand_t* jmirgen_addressToMemRef(jx_mirgen_context_t* ctx, jmirgen_address_t* addr, jx_mir_type_kind type)
+{
+	if (addr->m_StackObj) {
+		JX_CHECK(!addr->m_IndexReg, "Stack objects cannot have an index register.");
+		return jx_mir_opStackObjRel(ctx->m_MIRCtx, ctx->m_Func, type, addr->m_StackObj, addr->m_Displacement);
+	}
+
+	const jx_mir_reg_t indexReg = addr->m_IndexReg
+		? addr->m_IndexReg->u.m_Reg
+		: kMIRRegGPNone
+		;
+	return jx_mir_opMemoryRef(ctx->m_MIRCtx, ctx->m_Func, type, addr->m_BaseReg->u.m_Reg, indexReg, addr->m_Scale, addr->m_Displacement);
+}
+
+static jx_mir_operand_t* jmirgen_addressToReg(jx_mirgen_context_t* ctx, jmirgen_address_t* addr)
+{
+	jx_mir_operand_t* dstReg = jx_mir_opVirtualReg(ctx->m_MIRCtx, ctx->m_Func, JMIR_TYPE_PTR);
+
+	const bool isBaseOnly = true
+		&& !addr->m_StackObj
+		&& !addr->m_IndexReg
+		&& addr->m_Displacement == 0
+		;
+	if (isBaseOnly) {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_mov(ctx->m_MIRCtx, dstReg, addr->m_BaseReg));
+	} else {
+		jx_mir_bbAppendInstr(ctx->m_MIRCtx, ctx->m_BasicBlock, jx_mir_lea(ctx->m_MIRCtx, dstReg, jmirgen_addressToMemRef(ctx, addr, JMIR_TYPE_PTR)));
+	}
+
+	return dstReg;
+}
+
 static jx_mir_operand_t* jmirgen_genMemSet(jx_mirgen_context_t* ctx, jx_ir_instruction_t* irInstr)
 {
 	jx_ir_value_t* ptrVal = irInstr->super.m_OperandArr[1]->m_Value;
@@ -2592,3 +3164,19 @@ static int32_t jmir_valueOperandItemCompare(const void* a, const void* b, void*
 		: (((uintptr_t)valItemA->m_IRVal > (uintptr_t)valItemB->m_IRVal) ? 1 : 0)
 		;
 }
+
+static uint64_t jmir_foldedInstrItemHash(const void* item, uint64_t seed0, uint64_t seed1, void* udata)
+{
+	const jmir_folded_instr_item_t* instrItem = (const jmir_folded_instr_item_t*)item;
+	return (uint64_t)(uintptr_t)instrItem->m_IRInstr;
+}
+
+static int32_t jmir_foldedInstrItemCompare(const void* a, const void* b, void* udata)
+{
+	const jmir_folded_instr_item_t* instrItemA = (const jmir_folded_instr_item_t*)a;
+	const jmir_folded_instr_item_t* instrItemB = (const jmir_folded_instr_item_t*)b;
+	return (uintptr_t)instrItemA->m_IRInstr < (uintptr_t)instrItemB->m_IRInstr
+		? -1
+		: (((uintptr_t)instrItemA->m_IRInstr > (uintptr_t)instrItemB->m_IRInstr) ? 1 : 0)
+		;
+}
@@ -162,10 +162,90 @@ static bool jmir_funcPass_simplifyCondJmpRun(jx_mir_function_pass_o* inst, jx_mi
 	jx_mir_funcUpdateLiveness(ctx, func);
 
 	uint32_t numJumpsSimplified = 0;
+	uint32_t numCmovsSimplified = 0;
 
 	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
 	while (bb) {
-		jx_mir_instruction_t* instr = jx_mir_bbGetFirstTerminatorInstr(ctx, bb);
+		jx_mir_instruction_t* instr = bb->m_InstrListHead;
+		while (instr) {
+			jx_mir_instruction_t* instrNext = instr->m_Next;
+
+			if (instr->m_OpCode == JMIR_OP_CMOVE || instr->m_OpCode == JMIR_OP_CMOVNE) {
+				// Turn the following sequence
+				//
+				// cmp/ucomiss/comiss ...
+				// setcc %vrb
+				// mov %vr, ...         ; zero or more movs/cmovs which don't affect flags
+				// test %vrb, %vrb
+				// cmove/cmovne %vr, ...
+				//
+				// into
+				//
+				// cmp ...
+				// mov %vr, ...
+				// cmovcc %vr, ...
+				//
+				// NOTE: setcc is left in place and will be removed by DCE if it's not used anymore.
+				jx_mir_instruction_t* testInstr = instr->m_Prev;
+				const bool isValidTest = true
+					&& testInstr
+					&& testInstr->m_OpCode == JMIR_OP_TEST
+					&& testInstr->m_Operands[0]->m_Kind == JMIR_OPERAND_REGISTER
+					&& testInstr->m_Operands[1]->m_Kind == JMIR_OPERAND_REGISTER
+					&& testInstr->m_Operands[0]->m_Type == JMIR_TYPE_I8
+					&& jx_mir_regEqual(testInstr->m_Operands[0]->u.m_Reg, testInstr->m_Operands[1]->u.m_Reg)
+					;
+				if (isValidTest) {
+					jx_mir_reg_t condReg = testInstr->m_Operands[0]->u.m_Reg;
+
+					jx_mir_instruction_t* setccInstr = testInstr->m_Prev;
+					while (setccInstr) {
+						const bool isFlagsNeutral = false
+							|| setccInstr->m_OpCode == JMIR_OP_MOV
+							|| setccInstr->m_OpCode == JMIR_OP_MOVZX
+							|| setccInstr->m_OpCode == JMIR_OP_MOVD
+							|| setccInstr->m_OpCode == JMIR_OP_MOVQ
+							|| jx_mir_opcodeIsCmovcc(setccInstr->m_OpCode)
+							;
+						if (!isFlagsNeutral) {
+							break;
+						}
+
+						jx_mir_operand_t* dst = setccInstr->m_Operands[0];
+						if (dst->m_Kind == JMIR_OPERAND_REGISTER && jx_mir_regEqual(dst->u.m_Reg, condReg)) {
+							setccInstr = NULL;
+							break;
+						}
+
+						setccInstr = setccInstr->m_Prev;
+					}
+
+					const bool isValidSetcc = true
+						&& setccInstr
+						&& jx_mir_opcodeIsSetcc(setccInstr->m_OpCode)
+						&& setccInstr->m_Operands[0]->m_Kind == JMIR_OPERAND_REGISTER
+						&& jx_mir_regEqual(setccInstr->m_Operands[0]->u.m_Reg, condReg)
+						;
+					if (isValidSetcc) {
+						jx_mir_condition_code setCC = (jx_mir_condition_code)(setccInstr->m_OpCode - JMIR_OP_SETCC_BASE);
+						if (instr->m_OpCode == JMIR_OP_CMOVE) {
+							setCC = jx_mir_ccInvert(setCC);
+						}
+
+						instr->m_OpCode = JMIR_OP_CMOVCC_BASE + setCC;
+
+						jx_mir_bbRemoveInstr(ctx, bb, testInstr);
+						jx_mir_instrFree(ctx, testInstr);
+
+						++numCmovsSimplified;
+					}
+				}
+			}
+
+			instr = instrNext;
+		}
+
+		instr = jx_mir_bbGetFirstTerminatorInstr(ctx, bb);
 		while (instr) {
 			jx_mir_instruction_t* instrNext = instr->m_Next;
 
@@ -293,7 +373,7 @@ static bool jmir_funcPass_simplifyCondJmpRun(jx_mir_function_pass_o* inst, jx_mi
 
 	TracyCZoneEnd(tracyCtx);
 
-	return numJumpsSimplified != 0;
+	return (numJumpsSimplified + numCmovsSimplified) != 0;
 }
 
 #if 0 // Not needed
@@ -424,7 +504,10 @@ typedef struct jmir_graph_node_t
 	uint32_t m_Degree;
 	uint32_t m_ID; // ID of the node; used as the index in all bitsets; must be unique
 	uint32_t m_Color;
+	uint32_t m_NumDefs;
+	jx_mir_instruction_t* m_DefInstr; // Last instruction defining the register; only useful if m_NumDefs == 1
 	double m_SpillCost;
+	double m_DefSpillCost;            // Part of m_SpillCost coming from defs
 } jmir_graph_node_t;
 
 typedef struct jmir_mov_instr_t
@@ -494,6 +577,7 @@ static jmir_graph_node_t* jmir_regAlloc_nodeAdjacentIterNext(jmir_graph_node_t*
 static bool jmir_regAlloc_nodeInit(jmir_func_pass_regalloc_t* pass, jmir_graph_node_t* node, uint32_t id, jx_mir_reg_t reg, uint32_t color);
 static void jmir_regAlloc_nodeSetState(jmir_func_pass_regalloc_t* pass, jmir_graph_node_t* node, jmir_graph_node_state state);
 static jmir_graph_node_t* jmir_regAlloc_getNode(jmir_func_pass_regalloc_t* pass, uint32_t nodeID);
+static bool jmir_regAlloc_nodeIsRematerializable(jmir_graph_node_t* node);
 static bool jmir_nodeIs(const jmir_graph_node_t* node, jmir_graph_node_state state);
 
 static jmir_mov_instr_t* jmir_regAlloc_movAlloc(jmir_func_pass_regalloc_t* pass, jx_mir_instruction_t* instr);
@@ -647,6 +731,11 @@ static bool jmir_funcPass_regAllocRun(jx_mir_function_pass_o* inst, jx_mir_conte
 	};
 #endif
 
+	// RBP is a regular callee-saved register in functions without a frame pointer.
+	jmir_hw_reg_desc_t funcGPRegDesc[JX_COUNTOF(gpRegDesc)];
+	jx_memcpy(funcGPRegDesc, gpRegDesc, sizeof(gpRegDesc));
+	funcGPRegDesc[JMIR_HWREGID_BP].m_Available = (func->m_Flags & JMIR_FUNC_FLAGS_FRAME_POINTER_Msk) == 0;
+
 	uint32_t iter = 0;
 	bool changed = true;
 	while (changed && iter < JMIR_REGALLOC_MAX_ITERATIONS) {
@@ -654,7 +743,7 @@ static bool jmir_funcPass_regAllocRun(jx_mir_function_pass_o* inst, jx_mir_conte
 //		JX_TRACE("regalloc: iteration: %u", iter);
 
 		// Liveness analysis + build
-		if (!jmir_regAlloc_init(pass, ctx, func, gpRegDesc, xmmRegDesc)) {
+		if (!jmir_regAlloc_init(pass, ctx, func, funcGPRegDesc, xmmRegDesc)) {
 			break;
 		}
 
@@ -804,6 +893,9 @@ static bool jmir_regAlloc_init(jmir_func_pass_regalloc_t* pass, jx_mir_context_t
 						jmir_graph_node_t* defNode = jmir_regAlloc_getNode(pass, jx_mir_funcMapRegToBitsetID(ctx, func, instrUseDefAnnot->m_Defs[iDef]));
 						if (defNode->m_Color == UINT32_MAX) {
 							defNode->m_SpillCost += spillCostDelta;
+							defNode->m_DefSpillCost += spillCostDelta;
+							defNode->m_DefInstr = instr;
+							defNode->m_NumDefs++;
 						}
 					}
 
@@ -825,6 +917,12 @@ static bool jmir_regAlloc_init(jmir_func_pass_regalloc_t* pass, jx_mir_context_t
 
 	for (uint32_t iNode = 32; iNode < numNodes; ++iNode) {
 		jmir_graph_node_t* node = &pass->m_Nodes[iNode];
+		if (jmir_regAlloc_nodeIsRematerializable(node)) {
+			// No store is needed and each reload is replaced by a cheap instruction 
+			// which doesn't touch memory.
+			node->m_SpillCost = (node->m_SpillCost - node->m_DefSpillCost) * 0.5;
+		}
+
 //		JX_TRACE("regalloc: Node %u: SpillCost = %.0f, Degree = %u, Ratio = %f", node->m_ID, node->m_SpillCost, node->m_Degree, node->m_SpillCost / (double)node->m_Degree);
 		node->m_SpillCost /= (double)node->m_Degree;
 	}
@@ -1082,7 +1180,11 @@ static void jmir_regAlloc_spill(jmir_func_pass_regalloc_t* pass)
 
 //		JX_TRACE("regalloc: Spilling node %u (%%vr%u%s) with cost %f", node->m_ID, vreg.m_ID, vreg.m_Class == JMIR_REG_CLASS_GP ? "" : "f", node->m_SpillCost);
 
-		if (!jx_mir_funcSpillVirtualReg(ctx, func, vreg)) {
+		if (jmir_regAlloc_nodeIsRematerializable(node)) {
+			if (!jx_mir_funcRematerializeVirtualReg(ctx, func, vreg, node->m_DefInstr)) {
+				JX_CHECK(false, "Failed to rematerialize vreg %u", vreg.m_ID);
+			}
+		} else if (!jx_mir_funcSpillVirtualReg(ctx, func, vreg)) {
 			JX_CHECK(false, "Failed to spill vreg %u", vreg.m_ID);
 		}
 
@@ -1422,6 +1524,16 @@ static inline bool jmir_nodeIs(const jmir_graph_node_t* node, jmir_graph_node_st
 	return node->m_State == state;
 }
 
+// A spilled register can be recomputed before each use instead of being reloaded 
+// from the stack if it has a single cheap definition.
+static bool jmir_regAlloc_nodeIsRematerializable(jmir_graph_node_t* node)
+{
+	return true
+		&& node->m_NumDefs == 1
+		&& jx_mir_instrIsRematerializable(node->m_DefInstr)
+		;
+}
+
 static jmir_mov_instr_t* jmir_regAlloc_movAlloc(jmir_func_pass_regalloc_t* pass, jx_mir_instruction_t* instr)
 {
 	jmir_mov_instr_t* mov = (jmir_mov_instr_t*)JX_ALLOC(pass->m_LinearAllocator, sizeof(jmir_mov_instr_t));
@@ -2416,7 +2528,9 @@ static bool jmir_funcPass_instrCombineRun(jx_mir_function_pass_o* inst, jx_mir_c
 				jmir_instrCombine_setRegDef(pass, dst->u.m_Reg, instr);
 			} break;
 			case JMIR_OP_IDIV:
-			case JMIR_OP_DIV: {
+			case JMIR_OP_DIV:
+			case JMIR_OP_IMUL1:
+			case JMIR_OP_MUL: {
 				jx_mir_operand_t* op = instr->m_Operands[0];
 
 				// TODO: 
@@ -2529,7 +2643,33 @@ static bool jmir_funcPass_instrCombineRun(jx_mir_function_pass_o* inst, jx_mir_c
 			} break;
 			case JMIR_OP_SAR:
 			case JMIR_OP_SHR:
-			case JMIR_OP_SHL: {
+			case JMIR_OP_SHL: 
+			case JMIR_OP_ROL:
+			case JMIR_OP_ROR:
+			case JMIR_OP_BSWAP:
+			case JMIR_OP_BSF:
+			case JMIR_OP_BSR:
+			case JMIR_OP_POPCNT:
+			case JMIR_OP_LZCNT:
+			case JMIR_OP_TZCNT:
+			case JMIR_OP_SHUFPS:
+			case JMIR_OP_SHUFPD:
+			case JMIR_OP_CMOVO:
+			case JMIR_OP_CMOVNO:
+			case JMIR_OP_CMOVB:
+			case JMIR_OP_CMOVNB:
+			case JMIR_OP_CMOVE:
+			case JMIR_OP_CMOVNE:
+			case JMIR_OP_CMOVBE:
+			case JMIR_OP_CMOVNBE:
+			case JMIR_OP_CMOVS:
+			case JMIR_OP_CMOVNS:
+			case JMIR_OP_CMOVP:
+			case JMIR_OP_CMOVNP:
+			case JMIR_OP_CMOVL:
+			case JMIR_OP_CMOVNL:
+			case JMIR_OP_CMOVLE:
+			case JMIR_OP_CMOVNLE: {
 				jx_mir_operand_t* lhs = instr->m_Operands[0];
 				if (lhs->m_Kind == JMIR_OPERAND_REGISTER) {
 					jmir_instrCombine_removeRegDef(pass, lhs->u.m_Reg);
@@ -2572,7 +2712,9 @@ static bool jmir_funcPass_instrCombineRun(jx_mir_function_pass_o* inst, jx_mir_c
 				// Nop
 			} break;
 			case JMIR_OP_MOVD:
-			case JMIR_OP_MOVQ: {
+			case JMIR_OP_MOVQ: 
+			case JMIR_OP_MOVUPS:
+			case JMIR_OP_MOVUPD: {
 				jx_mir_operand_t* dst = instr->m_Operands[0];
 				jx_mir_operand_t* src = instr->m_Operands[1];
 
@@ -2814,6 +2956,7 @@ static bool jmir_funcPass_instrCombineRun(jx_mir_function_pass_o* inst, jx_mir_c
 			case JMIR_OP_RET:
 			case JMIR_OP_JMP:
 			case JMIR_OP_CALL:
+			case JMIR_OP_TAILCALL:
 			case JMIR_OP_CDQ:
 			case JMIR_OP_CQO: 
 			case JMIR_OP_INT3: {
@@ -2876,6 +3019,8 @@ static bool jmir_instrCombine_instrMightWriteToMem(jmir_func_pass_instr_combine_
 	case JMIR_OP_JMP: 
 	case JMIR_OP_IDIV:
 	case JMIR_OP_DIV: 
+	case JMIR_OP_IMUL1:
+	case JMIR_OP_MUL:
 	case JMIR_OP_IMUL:
 	case JMIR_OP_IMUL3: 
 	case JMIR_OP_LEA: 
@@ -2962,10 +3107,29 @@ static bool jmir_instrCombine_instrMightWriteToMem(jmir_func_pass_instr_combine_
 	case JMIR_OP_PUNPCKHWD:
 	case JMIR_OP_PUNPCKHDQ:
 	case JMIR_OP_PUNPCKHQDQ: 
+	case JMIR_OP_SHUFPS:
+	case JMIR_OP_SHUFPD:
+	case JMIR_OP_CMOVO:
+	case JMIR_OP_CMOVNO:
+	case JMIR_OP_CMOVB:
+	case JMIR_OP_CMOVNB:
+	case JMIR_OP_CMOVE:
+	case JMIR_OP_CMOVNE:
+	case JMIR_OP_CMOVBE:
+	case JMIR_OP_CMOVNBE:
+	case JMIR_OP_CMOVS:
+	case JMIR_OP_CMOVNS:
+	case JMIR_OP_CMOVP:
+	case JMIR_OP_CMOVNP:
+	case JMIR_OP_CMOVL:
+	case JMIR_OP_CMOVNL:
+	case JMIR_OP_CMOVLE:
+	case JMIR_OP_CMOVNLE:
 	case JMIR_OP_INT3: {
 		// Does not write to memory
 	} break;
-	case JMIR_OP_CALL: {
+	case JMIR_OP_CALL:
+	case JMIR_OP_TAILCALL: {
 		res = true;
 	} break;
 	case JMIR_OP_MOV:
@@ -2979,6 +3143,14 @@ static bool jmir_instrCombine_instrMightWriteToMem(jmir_func_pass_instr_combine_
 	case JMIR_OP_SAR:
 	case JMIR_OP_SHR:
 	case JMIR_OP_SHL:
+	case JMIR_OP_ROL:
+	case JMIR_OP_ROR:
+	case JMIR_OP_BSWAP:
+	case JMIR_OP_BSF:
+	case JMIR_OP_BSR:
+	case JMIR_OP_POPCNT:
+	case JMIR_OP_LZCNT:
+	case JMIR_OP_TZCNT:
 	case JMIR_OP_POP:
 	case JMIR_OP_SETO:
 	case JMIR_OP_SETNO:
@@ -3001,7 +3173,9 @@ static bool jmir_instrCombine_instrMightWriteToMem(jmir_func_pass_instr_combine_
 	case JMIR_OP_MOVAPS:
 	case JMIR_OP_MOVAPD:
 	case JMIR_OP_MOVD:
-	case JMIR_OP_MOVQ: {
+	case JMIR_OP_MOVQ: 
+	case JMIR_OP_MOVUPS:
+	case JMIR_OP_MOVUPD: {
 		jx_mir_operand_t* dst = instr->m_Operands[0];
 		res = true
 			&& dst->m_Kind == JMIR_OPERAND_MEMORY_REF
@@ -3341,6 +3515,7 @@ static bool jmir_funcPass_redundantConstEliminationRun(jx_mir_function_pass_o* i
 
 			switch (instr->m_OpCode) {
 			case JMIR_OP_RET:
+			case JMIR_OP_TAILCALL:
 			case JMIR_OP_CMP:
 			case JMIR_OP_TEST:
 			case JMIR_OP_JMP:
@@ -3420,6 +3595,14 @@ static bool jmir_funcPass_redundantConstEliminationRun(jx_mir_function_pass_o* i
 			case JMIR_OP_SAR:
 			case JMIR_OP_SHR:
 			case JMIR_OP_SHL: 
+			case JMIR_OP_ROL:
+			case JMIR_OP_ROR:
+			case JMIR_OP_BSWAP:
+			case JMIR_OP_BSF:
+			case JMIR_OP_BSR:
+			case JMIR_OP_POPCNT:
+			case JMIR_OP_LZCNT:
+			case JMIR_OP_TZCNT:
 			case JMIR_OP_SETO:
 			case JMIR_OP_SETNO:
 			case JMIR_OP_SETB:
@@ -3436,6 +3619,22 @@ static bool jmir_funcPass_redundantConstEliminationRun(jx_mir_function_pass_o* i
 			case JMIR_OP_SETNL:
 			case JMIR_OP_SETLE:
 			case JMIR_OP_SETNLE:
+			case JMIR_OP_CMOVO:
+			case JMIR_OP_CMOVNO:
+			case JMIR_OP_CMOVB:
+			case JMIR_OP_CMOVNB:
+			case JMIR_OP_CMOVE:
+			case JMIR_OP_CMOVNE:
+			case JMIR_OP_CMOVBE:
+			case JMIR_OP_CMOVNBE:
+			case JMIR_OP_CMOVS:
+			case JMIR_OP_CMOVNS:
+			case JMIR_OP_CMOVP:
+			case JMIR_OP_CMOVNP:
+			case JMIR_OP_CMOVL:
+			case JMIR_OP_CMOVNL:
+			case JMIR_OP_CMOVLE:
+			case JMIR_OP_CMOVNLE:
 			case JMIR_OP_MOVAPS:
 			case JMIR_OP_MOVAPD:
 			case JMIR_OP_MOVD:
@@ -3497,7 +3696,11 @@ static bool jmir_funcPass_redundantConstEliminationRun(jx_mir_function_pass_o* i
 			case JMIR_OP_PUNPCKHBW:
 			case JMIR_OP_PUNPCKHWD:
 			case JMIR_OP_PUNPCKHDQ:
-			case JMIR_OP_PUNPCKHQDQ: {
+			case JMIR_OP_PUNPCKHQDQ: 
+			case JMIR_OP_MOVUPS:
+			case JMIR_OP_MOVUPD:
+			case JMIR_OP_SHUFPS:
+			case JMIR_OP_SHUFPD: {
 				// Any binary operation which affects the first register operand should be removed from the map.
 				jx_mir_operand_t* dstOp = instr->m_Operands[0];
 				if (dstOp->m_Kind == JMIR_OPERAND_REGISTER) {
@@ -3505,8 +3708,10 @@ static bool jmir_funcPass_redundantConstEliminationRun(jx_mir_function_pass_o* i
 				}
 			} break;
 			case JMIR_OP_IDIV:
-			case JMIR_OP_DIV: {
-				// IDIV/DIV implicitly affect RAX and RDX. Remove them from the map.
+			case JMIR_OP_DIV:
+			case JMIR_OP_IMUL1:
+			case JMIR_OP_MUL: {
+				// IDIV/DIV/IMUL/MUL implicitly affect RAX and RDX. Remove them from the map.
 				jx_hashmapDelete(pass->m_RegConstMap, &(jmir_reg_value_item_t){.m_Reg = kMIRRegGP_A});
 				jx_hashmapDelete(pass->m_RegConstMap, &(jmir_reg_value_item_t){.m_Reg = kMIRRegGP_D});
 			} break;
@@ -3696,6 +3901,2376 @@ static bool jmir_funcPass_simplifyCFGRun(jx_mir_function_pass_o* inst, jx_mir_co
 	return numBasicBlocksChanged != 0;
 }
 
+//////////////////////////////////////////////////////////////////////////
+// SLP Vectorizer
+//
+// Packs groups of scalar float stores to consecutive addresses (4x movss or 
+// 2x movsd) into a single 128-bit store and tries to build the stored value 
+// with packed instructions by walking the lanes' def chains backwards.
+// 
+// Isomorphic scalar ops (addss/subss/mulss/divss/minss/maxss and their sd 
+// counterparts) become their packed versions, consecutive scalar loads become 
+// a single unaligned load, identical lanes are broadcasted with shufps/unpcklpd 
+// and everything else is gathered with unpck instructions. The group is only 
+// vectorized if the packed sequence is estimated to be cheaper than the scalar
+// one.
+// 
+// The vector code is placed right before the last store of the group, so all 
+// earlier stores are sunk to that point and all loads of the tree are delayed
+// to that point. This is only done if it's provably safe, i.e. none of the 
+// registers read by the tree is redefined in between and there are no calls 
+// or other memory writes in the affected range. Memory reads in the range 
+// must not overlap any of the sunk stores. Since there is no alias info at 
+// this level, two memory refs are considered disjoint only if they use the 
+// same base/index registers and their ranges don't overlap.
+//
+// NOTE: This runs on MIR instead of IR because IR has no vector types.
+// Scalar instructions left without uses are removed by DCE.
+//
+#define JMIR_SLP_MAX_LANES 4
+#define JMIR_SLP_MAX_DEPTH 8
+#define JMIR_SLP_INVALID_ID UINT32_MAX
+
+typedef enum jmir_slp_value_kind
+{
+	JMIR_SLP_VALUE_UNKNOWN = 0,
+	JMIR_SLP_VALUE_REG,   // Register not defined by a vectorizable instruction (or live-in)
+	JMIR_SLP_VALUE_MEM,   // Scalar load (memory ref or external symbol)
+	JMIR_SLP_VALUE_CONST, // Float constant
+	JMIR_SLP_VALUE_OP,    // Result of a scalar binary op
+} jmir_slp_value_kind;
+
+typedef struct jmir_slp_value_t
+{
+	jmir_slp_value_kind m_Kind;
+	uint32_t m_Pos;              // Index of the instruction which reads this value.
+	uint32_t m_DefPos;           // Index of the defining instruction (REG/OP) or of the load (MEM)
+	uint32_t m_OpCode;           // Scalar opcode (OP)
+	jx_mir_operand_t* m_Operand; // Register (REG/OP), memory ref/symbol (MEM) or constant (CONST)
+} jmir_slp_value_t;
+
+typedef enum jmir_slp_node_kind
+{
+	JMIR_SLP_NODE_OP,
+	JMIR_SLP_NODE_LOAD,
+	JMIR_SLP_NODE_SPLAT,
+	JMIR_SLP_NODE_GATHER,
+} jmir_slp_node_kind;
+
+typedef struct jmir_slp_node_t
+{
+	jmir_slp_node_kind m_Kind;
+	uint32_t m_OpCode; // Packed opcode (OP)
+	uint32_t m_Child[2];
+	jmir_slp_value_t m_Lanes[JMIR_SLP_MAX_LANES];
+} jmir_slp_node_t;
+
+typedef struct jmir_slp_reg_read_t
+{
+	jx_mir_reg_t m_Reg;
+	uint32_t m_Pos;
+} jmir_slp_reg_read_t;
+
+typedef struct jmir_func_pass_slp_t
+{
+	jx_allocator_i* m_Allocator;
+	jx_mir_context_t* m_Ctx;
+	jx_mir_function_t* m_Func;
+	jx_mir_instruction_t** m_InstrArr;
+	jmir_slp_node_t* m_NodeArr;
+	jmir_slp_reg_read_t* m_RegReadArr;
+	uint32_t m_MinReadPos;
+	uint32_t m_ScalarCost;
+	uint32_t m_VectorCost;
+	uint32_t m_NumLanes;
+	jx_mir_type_kind m_ElemType;
+	JX_PAD(4);
+} jmir_func_pass_slp_t;
+
+static void jmir_funcPass_slpVectorizerDestroy(jx_mir_function_pass_o* inst, jx_allocator_i* allocator);
+static bool jmir_funcPass_slpVectorizerRun(jx_mir_function_pass_o* inst, jx_mir_context_t* ctx, jx_mir_function_t* func);
+
+static bool jmir_slp_vectorizeStoreGroup(jmir_func_pass_slp_t* pass, jx_mir_basic_block_t* bb, uint32_t firstStoreID);
+static uint32_t jmir_slp_buildNode(jmir_func_pass_slp_t* pass, const jmir_slp_value_t* lanes, uint32_t depth);
+static jx_mir_operand_t* jmir_slp_emitNode(jmir_func_pass_slp_t* pass, jx_mir_basic_block_t* bb, jx_mir_instruction_t* anchor, uint32_t nodeID);
+static jx_mir_operand_t* jmir_slp_emitScalar(jmir_func_pass_slp_t* pass, jx_mir_basic_block_t* bb, jx_mir_instruction_t* anchor, const jmir_slp_value_t* val);
+static bool jmir_slp_isSafeToSinkStores(jmir_func_pass_slp_t* pass, const uint32_t* storeIDs, uint32_t lastStoreID);
+static void jmir_slp_getValue(jmir_func_pass_slp_t* pass, jx_mir_operand_t* op, uint32_t pos, jmir_slp_value_t* val);
+static bool jmir_slp_valueEqual(const jmir_slp_value_t* a, const jmir_slp_value_t* b);
+static void jmir_slp_addRead(jmir_func_pass_slp_t* pass, const jmir_slp_value_t* val);
+static uint32_t jmir_slp_findLastDef(jmir_func_pass_slp_t* pass, jx_mir_reg_t reg, uint32_t pos);
+static bool jmir_slp_isRegDefinedInRange(jmir_func_pass_slp_t* pass, jx_mir_reg_t reg, uint32_t first, uint32_t last);
+static bool jmir_slp_isScalarStore(jx_mir_instruction_t* instr);
+static bool jmir_slp_memRefsDisjoint(const jx_mir_operand_t* op, const jx_mir_memory_ref_t* memRef, uint32_t sz);
+static uint32_t jmir_slp_getPackedOpCode(jmir_func_pass_slp_t* pass, uint32_t scalarOpCode);
+
+bool jx_mir_funcPassCreate_slpVectorizer(jx_mir_function_pass_t* pass, jx_allocator_i* allocator)
+{
+	jmir_func_pass_slp_t* inst = (jmir_func_pass_slp_t*)JX_ALLOC(allocator, sizeof(jmir_func_pass_slp_t));
+	if (!inst) {
+		return false;
+	}
+
+	jx_memset(inst, 0, sizeof(jmir_func_pass_slp_t));
+	inst->m_Allocator = allocator;
+
+	inst->m_InstrArr = (jx_mir_instruction_t**)jx_array_create(allocator);
+	if (!inst->m_InstrArr) {
+		jmir_funcPass_slpVectorizerDestroy((jx_mir_function_pass_o*)inst, allocator);
+		return false;
+	}
+
+	inst->m_NodeArr = (jmir_slp_node_t*)jx_array_create(allocator);
+	if (!inst->m_NodeArr) {
+		jmir_funcPass_slpVectorizerDestroy((jx_mir_function_pass_o*)inst, allocator);
+		return false;
+	}
+
+	inst->m_RegReadArr = (jmir_slp_reg_read_t*)jx_array_create(allocator);
+	if (!inst->m_RegReadArr) {
+		jmir_funcPass_slpVectorizerDestroy((jx_mir_function_pass_o*)inst, allocator);
+		return false;
+	}
+
+	pass->m_Inst = (jx_mir_function_pass_o*)inst;
+	pass->run = jmir_funcPass_slpVectorizerRun;
+	pass->destroy = jmir_funcPass_slpVectorizerDestroy;
+
+	return true;
+}
+
+static void jmir_funcPass_slpVectorizerDestroy(jx_mir_function_pass_o* inst, jx_allocator_i* allocator)
+{
+	jmir_func_pass_slp_t* pass = (jmir_func_pass_slp_t*)inst;
+
+	if (pass->m_RegReadArr) {
+		jx_array_free(pass->m_RegReadArr);
+		pass->m_RegReadArr = NULL;
+	}
+
+	if (pass->m_NodeArr) {
+		jx_array_free(pass->m_NodeArr);
+		pass->m_NodeArr = NULL;
+	}
+
+	if (pass->m_InstrArr) {
+		jx_array_free(pass->m_InstrArr);
+		pass->m_InstrArr = NULL;
+	}
+
+	JX_FREE(pass->m_Allocator, pass);
+}
+
+static bool jmir_funcPass_slpVectorizerRun(jx_mir_function_pass_o* inst, jx_mir_context_t* ctx, jx_mir_function_t* func)
+{
+	TracyCZoneN(tracyCtx, "slpVectorizer", 1);
+
+	jmir_func_pass_slp_t* pass = (jmir_func_pass_slp_t*)inst;
+	pass->m_Ctx = ctx;
+	pass->m_Func = func;
+
+	// Make sure use/def info is up to date.
+	jx_mir_funcUpdateLiveness(ctx, func);
+
+	uint32_t numGroupsVectorized = 0;
+
+	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		bool changed = true;
+		while (changed) {
+			changed = false;
+
+			jx_array_resize(pass->m_InstrArr, 0);
+			jx_mir_instruction_t* instr = bb->m_InstrListHead;
+			while (instr) {
+				jx_array_push_back(pass->m_InstrArr, instr);
+				instr = instr->m_Next;
+			}
+
+			const uint32_t numInstrs = (uint32_t)jx_array_sizeu(pass->m_InstrArr);
+			for (uint32_t iInstr = 0; iInstr < numInstrs; ++iInstr) {
+				if (jmir_slp_vectorizeStoreGroup(pass, bb, iInstr)) {
+					++numGroupsVectorized;
+
+					// New instructions have been inserted. Recalculate use/def info
+					// and restart the scan of this basic block.
+					jx_mir_funcUpdateLiveness(ctx, func);
+					changed = true;
+					break;
+				}
+			}
+		}
+
+		bb = bb->m_Next;
+	}
+
+	TracyCZoneEnd(tracyCtx);
+
+	return numGroupsVectorized != 0;
+}
+
+static bool jmir_slp_vectorizeStoreGroup(jmir_func_pass_slp_t* pass, jx_mir_basic_block_t* bb, uint32_t firstStoreID)
+{
+	jx_mir_context_t* ctx = pass->m_Ctx;
+	jx_mir_function_t* func = pass->m_Func;
+
+	jx_mir_instruction_t* firstStore = pass->m_InstrArr[firstStoreID];
+	if (!jmir_slp_isScalarStore(firstStore)) {
+		return false;
+	}
+
+	const jx_mir_memory_ref_t* baseMemRef = firstStore->m_Operands[0]->u.m_MemRef;
+	pass->m_ElemType = firstStore->m_Operands[0]->m_Type;
+	const uint32_t elemSize = jx_mir_typeGetSize(pass->m_ElemType);
+	pass->m_NumLanes = 16 / elemSize;
+
+	// Find a unique store for each lane. If more than one store writes to 
+	// the same lane, give up.
+	uint32_t storeIDs[JMIR_SLP_MAX_LANES];
+	const uint32_t numLanes = pass->m_NumLanes;
+	const uint32_t numInstrs = (uint32_t)jx_array_sizeu(pass->m_InstrArr);
+	for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+		storeIDs[iLane] = JMIR_SLP_INVALID_ID;
+
+		const int32_t laneDisp = baseMemRef->m_Displacement + (int32_t)(iLane * elemSize);
+		for (uint32_t iInstr = 0; iInstr < numInstrs; ++iInstr) {
+			jx_mir_instruction_t* instr = pass->m_InstrArr[iInstr];
+			if (!jmir_slp_isScalarStore(instr) || instr->m_Operands[0]->m_Type != pass->m_ElemType) {
+				continue;
+			}
+
+			const jx_mir_memory_ref_t* memRef = instr->m_Operands[0]->u.m_MemRef;
+			const bool sameLane = true
+				&& jx_mir_regEqual(memRef->m_BaseReg, baseMemRef->m_BaseReg)
+				&& jx_mir_regEqual(memRef->m_IndexReg, baseMemRef->m_IndexReg)
+				&& memRef->m_Scale == baseMemRef->m_Scale
+				&& memRef->m_Displacement == laneDisp
+				;
+			if (sameLane) {
+				if (storeIDs[iLane] != JMIR_SLP_INVALID_ID) {
+					return false;
+				}
+
+				storeIDs[iLane] = iInstr;
+			}
+		}
+
+		if (storeIDs[iLane] == JMIR_SLP_INVALID_ID) {
+			return false;
+		}
+	}
+
+	uint32_t lastStoreID = storeIDs[0];
+	for (uint32_t iLane = 1; iLane < numLanes; ++iLane) {
+		lastStoreID = jx_max_u32(lastStoreID, storeIDs[iLane]);
+	}
+
+	// Build the tree
+	jx_array_resize(pass->m_NodeArr, 0);
+	jx_array_resize(pass->m_RegReadArr, 0);
+	pass->m_MinReadPos = lastStoreID;
+	pass->m_ScalarCost = numLanes;
+	pass->m_VectorCost = 1;
+
+	jmir_slp_value_t lanes[JMIR_SLP_MAX_LANES];
+	for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+		jx_mir_instruction_t* store = pass->m_InstrArr[storeIDs[iLane]];
+		jmir_slp_getValue(pass, store->m_Operands[1], storeIDs[iLane], &lanes[iLane]);
+	}
+
+	const uint32_t rootID = jmir_slp_buildNode(pass, lanes, 0);
+	if (rootID == JMIR_SLP_INVALID_ID) {
+		return false;
+	}
+
+	if (pass->m_VectorCost >= pass->m_ScalarCost) {
+		return false;
+	}
+
+	if (!jmir_slp_isSafeToSinkStores(pass, storeIDs, lastStoreID)) {
+		return false;
+	}
+
+	// Emit the packed code right before the last store and remove all scalar stores.
+	jx_mir_instruction_t* lastStore = pass->m_InstrArr[lastStoreID];
+	jx_mir_operand_t* vec = jmir_slp_emitNode(pass, bb, lastStore, rootID);
+
+	jx_mir_operand_t* dstOp = firstStore->m_Operands[0];
+	jx_mir_operand_t* vecDst = jx_mir_opIsStackObj(dstOp)
+		? jx_mir_opStackObjRel(ctx, func, JMIR_TYPE_F128, dstOp->u.m_MemRef, 0)
+		: jx_mir_opMemoryRef(ctx, func, JMIR_TYPE_F128, baseMemRef->m_BaseReg, baseMemRef->m_IndexReg, baseMemRef->m_Scale, baseMemRef->m_Displacement)
+		;
+	jx_mir_bbInsertInstrBefore(ctx, bb, lastStore, pass->m_ElemType == JMIR_TYPE_F32
+		? jx_mir_movups(ctx, vecDst, vec)
+		: jx_mir_movupd(ctx, vecDst, vec)
+	);
+
+	for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+		jx_mir_instruction_t* store = pass->m_InstrArr[storeIDs[iLane]];
+		jx_mir_bbRemoveInstr(ctx, bb, store);
+		jx_mir_instrFree(ctx, store);
+	}
+
+	return true;
+}
+
+static uint32_t jmir_slp_buildNode(jmir_func_pass_slp_t* pass, const jmir_slp_value_t* lanes, uint32_t depth)
+{
+	const uint32_t numLanes = pass->m_NumLanes;
+	const uint32_t elemSize = jx_mir_typeGetSize(pass->m_ElemType);
+
+	jmir_slp_node_t node = { 0 };
+	node.m_Child[0] = JMIR_SLP_INVALID_ID;
+	node.m_Child[1] = JMIR_SLP_INVALID_ID;
+	for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+		if (lanes[iLane].m_Kind == JMIR_SLP_VALUE_UNKNOWN) {
+			return JMIR_SLP_INVALID_ID;
+		}
+
+		node.m_Lanes[iLane] = lanes[iLane];
+	}
+
+	// Isomorphic binary ops => packed binary op
+	bool isOp = depth < JMIR_SLP_MAX_DEPTH;
+	for (uint32_t iLane = 0; iLane < numLanes && isOp; ++iLane) {
+		isOp = true
+			&& lanes[iLane].m_Kind == JMIR_SLP_VALUE_OP
+			&& lanes[iLane].m_OpCode == lanes[0].m_OpCode
+			&& (iLane == 0 || lanes[iLane].m_DefPos != lanes[0].m_DefPos)
+			;
+	}
+
+	if (isOp) {
+		jmir_slp_value_t lhs[JMIR_SLP_MAX_LANES];
+		jmir_slp_value_t rhs[JMIR_SLP_MAX_LANES];
+		for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+			jx_mir_instruction_t* instr = pass->m_InstrArr[lanes[iLane].m_DefPos];
+			jmir_slp_getValue(pass, instr->m_Operands[0], lanes[iLane].m_DefPos, &lhs[iLane]);
+			jmir_slp_getValue(pass, instr->m_Operands[1], lanes[iLane].m_DefPos, &rhs[iLane]);
+		}
+
+		node.m_Kind = JMIR_SLP_NODE_OP;
+		node.m_OpCode = jmir_slp_getPackedOpCode(pass, lanes[0].m_OpCode);
+		node.m_Child[0] = jmir_slp_buildNode(pass, lhs, depth + 1);
+		if (node.m_Child[0] == JMIR_SLP_INVALID_ID) {
+			return JMIR_SLP_INVALID_ID;
+		}
+
+		node.m_Child[1] = jmir_slp_buildNode(pass, rhs, depth + 1);
+		if (node.m_Child[1] == JMIR_SLP_INVALID_ID) {
+			return JMIR_SLP_INVALID_ID;
+		}
+
+		// movaps + op
+		pass->m_ScalarCost += numLanes;
+		pass->m_VectorCost += 2;
+
+		jx_array_push_back(pass->m_NodeArr, node);
+		return (uint32_t)jx_array_sizeu(pass->m_NodeArr) - 1;
+	}
+
+	// Loads from consecutive addresses => unaligned packed load
+	bool isLoad = true;
+	for (uint32_t iLane = 0; iLane < numLanes && isLoad; ++iLane) {
+		const jx_mir_operand_t* op = lanes[iLane].m_Operand;
+		isLoad = true
+			&& lanes[iLane].m_Kind == JMIR_SLP_VALUE_MEM
+			&& op->m_Kind == JMIR_OPERAND_MEMORY_REF
+			&& op->m_Type == pass->m_ElemType
+			&& jx_mir_regEqual(op->u.m_MemRef->m_BaseReg, lanes[0].m_Operand->u.m_MemRef->m_BaseReg)
+			&& jx_mir_regEqual(op->u.m_MemRef->m_IndexReg, lanes[0].m_Operand->u.m_MemRef->m_IndexReg)
+			&& op->u.m_MemRef->m_Scale == lanes[0].m_Operand->u.m_MemRef->m_Scale
+			&& op->u.m_MemRef->m_Displacement == lanes[0].m_Operand->u.m_MemRef->m_Displacement + (int32_t)(iLane * elemSize)
+			;
+	}
+
+	if (isLoad) {
+		for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+			jmir_slp_addRead(pass, &lanes[iLane]);
+		}
+
+		pass->m_ScalarCost += numLanes;
+		pass->m_VectorCost += 1;
+
+		node.m_Kind = JMIR_SLP_NODE_LOAD;
+		jx_array_push_back(pass->m_NodeArr, node);
+		return (uint32_t)jx_array_sizeu(pass->m_NodeArr) - 1;
+	}
+
+	// Values which cannot be packed any further are read as scalar registers.
+	// Ops are read from their destination register right after their definition.
+	for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+		jmir_slp_value_t* val = &node.m_Lanes[iLane];
+		if (val->m_Kind == JMIR_SLP_VALUE_OP) {
+			val->m_Kind = JMIR_SLP_VALUE_REG;
+			val->m_Pos = val->m_DefPos + 1;
+		}
+	}
+
+	bool isSplat = true;
+	for (uint32_t iLane = 1; iLane < numLanes && isSplat; ++iLane) {
+		isSplat = jmir_slp_valueEqual(&node.m_Lanes[0], &node.m_Lanes[iLane]);
+	}
+
+	if (isSplat) {
+		jmir_slp_addRead(pass, &node.m_Lanes[0]);
+
+		// movaps + shufps/unpcklpd (+ movss/movsd if the scalar is not already in a register)
+		pass->m_VectorCost += node.m_Lanes[0].m_Kind == JMIR_SLP_VALUE_REG ? 2 : 3;
+
+		node.m_Kind = JMIR_SLP_NODE_SPLAT;
+		jx_array_push_back(pass->m_NodeArr, node);
+		return (uint32_t)jx_array_sizeu(pass->m_NodeArr) - 1;
+	}
+
+	for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+		jmir_slp_addRead(pass, &node.m_Lanes[iLane]);
+		pass->m_VectorCost += node.m_Lanes[iLane].m_Kind == JMIR_SLP_VALUE_REG ? 0 : 1;
+	}
+
+	// F32: 2x movaps + 3x unpck, F64: movaps + unpcklpd
+	pass->m_VectorCost += numLanes == 4 ? 5 : 2;
+
+	node.m_Kind = JMIR_SLP_NODE_GATHER;
+	jx_array_push_back(pass->m_NodeArr, node);
+	return (uint32_t)jx_array_sizeu(pass->m_NodeArr) - 1;
+}
+
+static jx_mir_operand_t* jmir_slp_emitNode(jmir_func_pass_slp_t* pass, jx_mir_basic_block_t* bb, jx_mir_instruction_t* anchor, uint32_t nodeID)
+{
+	jx_mir_context_t* ctx = pass->m_Ctx;
+	jx_mir_function_t* func = pass->m_Func;
+	const bool isF32 = pass->m_ElemType == JMIR_TYPE_F32;
+
+	const jmir_slp_node_t node = pass->m_NodeArr[nodeID];
+
+	jx_mir_operand_t* dst = jx_mir_opVirtualReg(ctx, func, JMIR_TYPE_F128);
+	switch (node.m_Kind) {
+	case JMIR_SLP_NODE_OP: {
+		jx_mir_operand_t* lhs = jmir_slp_emitNode(pass, bb, anchor, node.m_Child[0]);
+		jx_mir_operand_t* rhs = jmir_slp_emitNode(pass, bb, anchor, node.m_Child[1]);
+
+		jx_mir_instruction_t* op = NULL;
+		switch (node.m_OpCode) {
+		case JMIR_OP_ADDPS: op = jx_mir_addps(ctx, dst, rhs); break;
+		case JMIR_OP_ADDPD: op = jx_mir_addpd(ctx, dst, rhs); break;
+		case JMIR_OP_SUBPS: op = jx_mir_subps(ctx, dst, rhs); break;
+		case JMIR_OP_SUBPD: op = jx_mir_subpd(ctx, dst, rhs); break;
+		case JMIR_OP_MULPS: op = jx_mir_mulps(ctx, dst, rhs); break;
+		case JMIR_OP_MULPD: op = jx_mir_mulpd(ctx, dst, rhs); break;
+		case JMIR_OP_DIVPS: op = jx_mir_divps(ctx, dst, rhs); break;
+		case JMIR_OP_DIVPD: op = jx_mir_divpd(ctx, dst, rhs); break;
+		case JMIR_OP_MINPS: op = jx_mir_minps(ctx, dst, rhs); break;
+		case JMIR_OP_MINPD: op = jx_mir_minpd(ctx, dst, rhs); break;
+		case JMIR_OP_MAXPS: op = jx_mir_maxps(ctx, dst, rhs); break;
+		case JMIR_OP_MAXPD: op = jx_mir_maxpd(ctx, dst, rhs); break;
+		default:
+			JX_CHECK(false, "Unexpected packed opcode");
+			break;
+		}
+
+		jx_mir_bbInsertInstrBefore(ctx, bb, anchor, jx_mir_movaps(ctx, dst, lhs));
+		jx_mir_bbInsertInstrBefore(ctx, bb, anchor, op);
+	} break;
+	case JMIR_SLP_NODE_LOAD: {
+		jx_mir_operand_t* srcOp = node.m_Lanes[0].m_Operand;
+		const jx_mir_memory_ref_t* memRef = srcOp->u.m_MemRef;
+		jx_mir_operand_t* src = jx_mir_opIsStackObj(srcOp)
+			? jx_mir_opStackObjRel(ctx, func, JMIR_TYPE_F128, srcOp->u.m_MemRef, 0)
+			: jx_mir_opMemoryRef(ctx, func, JMIR_TYPE_F128, memRef->m_BaseReg, memRef->m_IndexReg, memRef->m_Scale, memRef->m_Displacement)
+			;
+		jx_mir_bbInsertInstrBefore(ctx, bb, anchor, isF32
+			? jx_mir_movups(ctx, dst, src)
+			: jx_mir_movupd(ctx, dst, src)
+		);
+	} break;
+	case JMIR_SLP_NODE_SPLAT: {
+		jx_mir_operand_t* scalar = jmir_slp_emitScalar(pass, bb, anchor, &node.m_Lanes[0]);
+		jx_mir_bbInsertInstrBefore(ctx, bb, anchor, jx_mir_movaps(ctx, dst, scalar));
+		jx_mir_bbInsertInstrBefore(ctx, bb, anchor, isF32
+			? jx_mir_shufps(ctx, dst, dst, 0x00)
+			: jx_mir_unpcklpd(ctx, dst, dst)
+		);
+	} break;
+	case JMIR_SLP_NODE_GATHER: {
+		jx_mir_operand_t* scalars[JMIR_SLP_MAX_LANES];
+		for (uint32_t iLane = 0; iLane < pass->m_NumLanes; ++iLane) {
+			scalars[iLane] = jmir_slp_emitScalar(pass, bb, anchor, &node.m_Lanes[iLane]);
+		}
+
+		if (isF32) {
+			// dst = { s0, s1, ?, ? }, hi = { s2, s3, ?, ? } => dst = { s0, s1, s2, s3 }
+			jx_mir_operand_t* hi = jx_mir_opVirtualReg(ctx, func, JMIR_TYPE_F128);
+			jx_mir_bbInsertInstrBefore(ctx, bb, anchor, jx_mir_movaps(ctx, dst, scalars[0]));
+			jx_mir_bbInsertInstrBefore(ctx, bb, anchor, jx_mir_unpcklps(ctx, dst, scalars[1]));
+			jx_mir_bbInsertInstrBefore(ctx, bb, anchor, jx_mir_movaps(ctx, hi, scalars[2]));
+			jx_mir_bbInsertInstrBefore(ctx, bb, anchor, jx_mir_unpcklps(ctx, hi, scalars[3]));
+			jx_mir_bbInsertInstrBefore(ctx, bb, anchor, jx_mir_unpcklpd(ctx, dst, hi));
+		} else {
+			jx_mir_bbInsertInstrBefore(ctx, bb, anchor, jx_mir_movaps(ctx, dst, scalars[0]));
+			jx_mir_bbInsertInstrBefore(ctx, bb, anchor, jx_mir_unpcklpd(ctx, dst, scalars[1]));
+		}
+	} break;
+	default:
+		JX_CHECK(false, "Unknown SLP node kind");
+		break;
+	}
+
+	return dst;
+}
+
+static jx_mir_operand_t* jmir_slp_emitScalar(jmir_func_pass_slp_t* pass, jx_mir_basic_block_t* bb, jx_mir_instruction_t* anchor, const jmir_slp_value_t* val)
+{
+	jx_mir_context_t* ctx = pass->m_Ctx;
+	jx_mir_function_t* func = pass->m_Func;
+
+	jx_mir_reg_t reg = kMIRRegGPNone;
+	if (val->m_Kind == JMIR_SLP_VALUE_REG) {
+		reg = val->m_Operand->u.m_Reg;
+	} else {
+		// Load the constant or the memory operand into a new scalar register.
+		jx_mir_operand_t* tmp = jx_mir_opVirtualReg(ctx, func, pass->m_ElemType);
+		jx_mir_bbInsertInstrBefore(ctx, bb, anchor, pass->m_ElemType == JMIR_TYPE_F32
+			? jx_mir_movss(ctx, tmp, val->m_Operand)
+			: jx_mir_movsd(ctx, tmp, val->m_Operand)
+		);
+		reg = tmp->u.m_Reg;
+	}
+
+	// Only the lowest element of the register is valid. The rest of the elements
+	// are ignored by the code using the returned operand.
+	return jx_mir_opRegAlias(ctx, func, JMIR_TYPE_F128, reg);
+}
+
+static bool jmir_slp_isSafeToSinkStores(jmir_func_pass_slp_t* pass, const uint32_t* storeIDs, uint32_t lastStoreID)
+{
+	const uint32_t numLanes = pass->m_NumLanes;
+	const uint32_t elemSize = jx_mir_typeGetSize(pass->m_ElemType);
+
+	// All registers read by the tree must have the same value at the last store.
+	const uint32_t numReads = (uint32_t)jx_array_sizeu(pass->m_RegReadArr);
+	for (uint32_t iRead = 0; iRead < numReads; ++iRead) {
+		const jmir_slp_reg_read_t* read = &pass->m_RegReadArr[iRead];
+		if (jmir_slp_isRegDefinedInRange(pass, read->m_Reg, read->m_Pos, lastStoreID)) {
+			return false;
+		}
+	}
+
+	// Same for the address registers of the stores.
+	uint32_t firstID = pass->m_MinReadPos;
+	for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+		const uint32_t storeID = storeIDs[iLane];
+		const jx_mir_memory_ref_t* memRef = pass->m_InstrArr[storeID]->m_Operands[0]->u.m_MemRef;
+		const bool addrChanged = false
+			|| jmir_slp_isRegDefinedInRange(pass, memRef->m_BaseReg, storeID, lastStoreID)
+			|| jmir_slp_isRegDefinedInRange(pass, memRef->m_IndexReg, storeID, lastStoreID)
+			;
+		if (addrChanged) {
+			return false;
+		}
+
+		firstID = jx_min_u32(firstID, storeID);
+	}
+
+	// No other memory writes are allowed in the affected range and no memory
+	// read is allowed to overlap a store which has been sunk past it.
+	for (uint32_t iInstr = firstID; iInstr <= lastStoreID; ++iInstr) {
+		bool isGroupStore = false;
+		for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+			isGroupStore = isGroupStore || storeIDs[iLane] == iInstr;
+		}
+
+		if (isGroupStore) {
+			continue;
+		}
+
+		jx_mir_instruction_t* instr = pass->m_InstrArr[iInstr];
+		const bool hasSideEffects = false
+			|| instr->m_OpCode == JMIR_OP_CALL
+			|| instr->m_OpCode == JMIR_OP_TAILCALL
+			|| instr->m_OpCode == JMIR_OP_PUSH
+			|| instr->m_OpCode == JMIR_OP_POP
+			;
+		if (hasSideEffects) {
+			return false;
+		}
+
+		if (instr->m_OpCode == JMIR_OP_LEA) {
+			continue;
+		}
+
+		const uint32_t numOperands = instr->m_NumOperands;
+		for (uint32_t iOperand = 0; iOperand < numOperands; ++iOperand) {
+			jx_mir_operand_t* op = instr->m_Operands[iOperand];
+			if (op->m_Kind != JMIR_OPERAND_MEMORY_REF && op->m_Kind != JMIR_OPERAND_EXTERNAL_SYMBOL) {
+				continue;
+			}
+
+			const bool isCmp = false
+				|| jx_mir_opcodeIsComparison(instr->m_OpCode)
+				|| instr->m_OpCode == JMIR_OP_TEST
+				;
+			if (iOperand == 0 && !isCmp) {
+				return false;
+			}
+
+			for (uint32_t iLane = 0; iLane < numLanes; ++iLane) {
+				const uint32_t storeID = storeIDs[iLane];
+				if (storeID < iInstr && !jmir_slp_memRefsDisjoint(op, pass->m_InstrArr[storeID]->m_Operands[0]->u.m_MemRef, elemSize)) {
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+static void jmir_slp_getValue(jmir_func_pass_slp_t* pass, jx_mir_operand_t* op, uint32_t pos, jmir_slp_value_t* val)
+{
+	jx_memset(val, 0, sizeof(jmir_slp_value_t));
+	val->m_Kind = JMIR_SLP_VALUE_UNKNOWN;
+	val->m_Pos = pos;
+	val->m_DefPos = JMIR_SLP_INVALID_ID;
+	val->m_Operand = op;
+
+	if (op->m_Type != pass->m_ElemType) {
+		return;
+	}
+
+	if (op->m_Kind == JMIR_OPERAND_CONST) {
+		val->m_Kind = JMIR_SLP_VALUE_CONST;
+		return;
+	} else if (op->m_Kind == JMIR_OPERAND_MEMORY_REF || op->m_Kind == JMIR_OPERAND_EXTERNAL_SYMBOL) {
+		val->m_Kind = JMIR_SLP_VALUE_MEM;
+		val->m_DefPos = pos;
+		return;
+	} else if (op->m_Kind != JMIR_OPERAND_REGISTER) {
+		return;
+	}
+
+	val->m_Kind = JMIR_SLP_VALUE_REG;
+	val->m_DefPos = jmir_slp_findLastDef(pass, op->u.m_Reg, pos);
+	if (val->m_DefPos == JMIR_SLP_INVALID_ID) {
+		// Live-in register
+		return;
+	}
+
+	jx_mir_instruction_t* def = pass->m_InstrArr[val->m_DefPos];
+	if (def->m_NumOperands != 2 || !jx_mir_opIsReg(def->m_Operands[0], op->u.m_Reg)) {
+		return;
+	}
+
+	const uint32_t movOpCode = pass->m_ElemType == JMIR_TYPE_F32
+		? JMIR_OP_MOVSS
+		: JMIR_OP_MOVSD
+		;
+	if (def->m_OpCode == movOpCode) {
+		// Look through scalar copies, loads and constants.
+		jmir_slp_getValue(pass, def->m_Operands[1], val->m_DefPos, val);
+	} else if (jmir_slp_getPackedOpCode(pass, def->m_OpCode) != JMIR_SLP_INVALID_ID) {
+		val->m_Kind = JMIR_SLP_VALUE_OP;
+		val->m_OpCode = def->m_OpCode;
+	}
+}
+
+static bool jmir_slp_valueEqual(const jmir_slp_value_t* a, const jmir_slp_value_t* b)
+{
+	if (a->m_Kind != b->m_Kind) {
+		return false;
+	}
+
+	switch (a->m_Kind) {
+	case JMIR_SLP_VALUE_REG:
+		return true
+			&& jx_mir_regEqual(a->m_Operand->u.m_Reg, b->m_Operand->u.m_Reg)
+			&& a->m_DefPos == b->m_DefPos
+			;
+	case JMIR_SLP_VALUE_MEM:
+		return true
+			&& a->m_DefPos == b->m_DefPos
+			&& jx_mir_opEqual(a->m_Operand, b->m_Operand)
+			;
+	case JMIR_SLP_VALUE_CONST:
+		return jx_mir_opEqual(a->m_Operand, b->m_Operand);
+	default:
+		break;
+	}
+
+	return false;
+}
+
+static void jmir_slp_addRead(jmir_func_pass_slp_t* pass, const jmir_slp_value_t* val)
+{
+	pass->m_MinReadPos = jx_min_u32(pass->m_MinReadPos, val->m_Pos);
+
+	const jx_mir_operand_t* op = val->m_Operand;
+	if (val->m_Kind == JMIR_SLP_VALUE_REG) {
+		jx_array_push_back(pass->m_RegReadArr, (jmir_slp_reg_read_t){ .m_Reg = op->u.m_Reg, .m_Pos = val->m_Pos });
+	} else if (val->m_Kind == JMIR_SLP_VALUE_MEM && op->m_Kind == JMIR_OPERAND_MEMORY_REF) {
+		if (jx_mir_regIsValid(op->u.m_MemRef->m_BaseReg)) {
+			jx_array_push_back(pass->m_RegReadArr, (jmir_slp_reg_read_t){ .m_Reg = op->u.m_MemRef->m_BaseReg, .m_Pos = val->m_Pos });
+		}
+		if (jx_mir_regIsValid(op->u.m_MemRef->m_IndexReg)) {
+			jx_array_push_back(pass->m_RegReadArr, (jmir_slp_reg_read_t){ .m_Reg = op->u.m_MemRef->m_IndexReg, .m_Pos = val->m_Pos });
+		}
+	}
+}
+
+static uint32_t jmir_slp_findLastDef(jmir_func_pass_slp_t* pass, jx_mir_reg_t reg, uint32_t pos)
+{
+	for (uint32_t iInstr = pos; iInstr > 0; --iInstr) {
+		const jx_mir_instr_usedef_t* useDef = &pass->m_InstrArr[iInstr - 1]->m_UseDef;
+		const uint32_t numDefs = useDef->m_NumDefs;
+		for (uint32_t iDef = 0; iDef < numDefs; ++iDef) {
+			if (jx_mir_regEqual(useDef->m_Defs[iDef], reg)) {
+				return iInstr - 1;
+			}
+		}
+	}
+
+	return JMIR_SLP_INVALID_ID;
+}
+
+// Checks if reg is defined by any instruction in the range [first, last)
+static bool jmir_slp_isRegDefinedInRange(jmir_func_pass_slp_t* pass, jx_mir_reg_t reg, uint32_t first, uint32_t last)
+{
+	if (!jx_mir_regIsValid(reg)) {
+		return false;
+	}
+
+	for (uint32_t iInstr = first; iInstr < last; ++iInstr) {
+		const jx_mir_instr_usedef_t* useDef = &pass->m_InstrArr[iInstr]->m_UseDef;
+		const uint32_t numDefs = useDef->m_NumDefs;
+		for (uint32_t iDef = 0; iDef < numDefs; ++iDef) {
+			if (jx_mir_regEqual(useDef->m_Defs[iDef], reg)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static bool jmir_slp_isScalarStore(jx_mir_instruction_t* instr)
+{
+	if (instr->m_OpCode != JMIR_OP_MOVSS && instr->m_OpCode != JMIR_OP_MOVSD) {
+		return false;
+	}
+
+	jx_mir_operand_t* dst = instr->m_Operands[0];
+	jx_mir_operand_t* src = instr->m_Operands[1];
+	return true
+		&& dst->m_Kind == JMIR_OPERAND_MEMORY_REF
+		&& src->m_Kind == JMIR_OPERAND_REGISTER
+		&& dst->m_Type == (instr->m_OpCode == JMIR_OP_MOVSS ? JMIR_TYPE_F32 : JMIR_TYPE_F64)
+		;
+}
+
+static bool jmir_slp_memRefsDisjoint(const jx_mir_operand_t* op, const jx_mir_memory_ref_t* memRef, uint32_t sz)
+{
+	if (op->m_Kind == JMIR_OPERAND_EXTERNAL_SYMBOL) {
+		// Globals cannot overlap stack objects. Everything else might.
+		return true
+			&& jx_mir_regEqual(memRef->m_BaseReg, kMIRRegGP_SP)
+			&& !jx_mir_regIsValid(memRef->m_IndexReg)
+			;
+	}
+
+	JX_CHECK(op->m_Kind == JMIR_OPERAND_MEMORY_REF, "Expected memory operand");
+	const jx_mir_memory_ref_t* opMemRef = op->u.m_MemRef;
+	const bool sameAddressBase = true
+		&& jx_mir_regEqual(opMemRef->m_BaseReg, memRef->m_BaseReg)
+		&& jx_mir_regEqual(opMemRef->m_IndexReg, memRef->m_IndexReg)
+		&& (!jx_mir_regIsValid(memRef->m_IndexReg) || opMemRef->m_Scale == memRef->m_Scale)
+		;
+	if (!sameAddressBase) {
+		return false;
+	}
+
+	const int64_t opStart = (int64_t)opMemRef->m_Displacement;
+	const int64_t opEnd = opStart + (int64_t)jx_mir_typeGetSize(op->m_Type);
+	const int64_t start = (int64_t)memRef->m_Displacement;
+	const int64_t end = start + (int64_t)sz;
+	return opEnd <= start || end <= opStart;
+}
+
+static uint32_t jmir_slp_getPackedOpCode(jmir_func_pass_slp_t* pass, uint32_t scalarOpCode)
+{
+	const bool isF32 = pass->m_ElemType == JMIR_TYPE_F32;
+
+	switch (scalarOpCode) {
+	case JMIR_OP_ADDSS: return isF32 ? JMIR_OP_ADDPS : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_SUBSS: return isF32 ? JMIR_OP_SUBPS : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_MULSS: return isF32 ? JMIR_OP_MULPS : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_DIVSS: return isF32 ? JMIR_OP_DIVPS : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_MINSS: return isF32 ? JMIR_OP_MINPS : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_MAXSS: return isF32 ? JMIR_OP_MAXPS : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_ADDSD: return !isF32 ? JMIR_OP_ADDPD : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_SUBSD: return !isF32 ? JMIR_OP_SUBPD : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_MULSD: return !isF32 ? JMIR_OP_MULPD : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_DIVSD: return !isF32 ? JMIR_OP_DIVPD : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_MINSD: return !isF32 ? JMIR_OP_MINPD : JMIR_SLP_INVALID_ID;
+	case JMIR_OP_MAXSD: return !isF32 ? JMIR_OP_MAXPD : JMIR_SLP_INVALID_ID;
+	default:
+		break;
+	}
+
+	return JMIR_SLP_INVALID_ID;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Stack Slot Coloring
+// 
+// Post-RA pass which shares stack slots between objects with non-overlapping 
+// live ranges and compacts the frame. Slots are laid out by decreasing access 
+// frequency (weighted by loop depth) starting right above the outgoing argument 
+// area, so the hottest slots get the smallest displacements from RSP.
+// 
+// A slot is live at an instruction if the instruction accesses it or if it's
+// read by a later instruction before being overwritten. Only stores covering the
+// whole slot (or any store to a spill slot) end a live range. Slots whose address 
+// is taken (lea or indexed accesses) are never shared but are still moved.
+// 
+// NOTE: If any stack reference cannot be mapped to exactly one slot, the frame is 
+// left unchanged.
+//
+#define JMIR_SSC_INVALID_ID   UINT32_MAX
+#define JMIR_SSC_MAX_ACCESSES 4
+
+typedef struct jmir_ssc_slot_t
+{
+	jx_bitset_t* m_LivePoints; // IDs of the instructions at which the slot is live
+	uint64_t m_Weight;
+	uint32_t m_Offset;         // Offset before compaction
+	uint32_t m_GroupID;
+	bool m_AddressTaken;
+	JX_PAD(7);
+} jmir_ssc_slot_t;
+
+typedef struct jmir_ssc_group_t
+{
+	jx_bitset_t* m_LivePoints;
+	uint64_t m_Weight;
+	uint32_t m_Size;
+	uint32_t m_Alignment;
+	uint32_t m_Offset;         // Offset after compaction
+	bool m_AddressTaken;
+	JX_PAD(3);
+} jmir_ssc_group_t;
+
+typedef struct jmir_ssc_bb_info_t
+{
+	jx_bitset_t* m_Gen;
+	jx_bitset_t* m_Kill;
+	jx_bitset_t* m_LiveIn;
+	jx_bitset_t* m_LiveOut;
+	uint32_t m_FirstInstrID;
+	JX_PAD(4);
+} jmir_ssc_bb_info_t;
+
+typedef struct jmir_ssc_access_t
+{
+	uint32_t m_SlotID;
+	bool m_IsDef;
+	JX_PAD(3);
+} jmir_ssc_access_t;
+
+typedef struct jmir_func_pass_ssc_t
+{
+	jx_allocator_i* m_Allocator;
+	jx_allocator_i* m_LinearAllocator;
+	jx_mir_context_t* m_Ctx;
+	jx_mir_function_t* m_Func;
+	jmir_ssc_slot_t* m_Slots;
+	jmir_ssc_group_t* m_Groups;
+	jmir_ssc_bb_info_t* m_BBInfo;
+	uint32_t m_NumSlots;
+	uint32_t m_NumGroups;
+	uint32_t m_NumInstructions;
+	uint32_t m_ArgAreaSize;
+} jmir_func_pass_ssc_t;
+
+static void jmir_funcPass_stackSlotColoringDestroy(jx_mir_function_pass_o* inst, jx_allocator_i* allocator);
+static bool jmir_funcPass_stackSlotColoringRun(jx_mir_function_pass_o* inst, jx_mir_context_t* ctx, jx_mir_function_t* func);
+
+static bool jmir_ssc_init(jmir_func_pass_ssc_t* pass);
+static void jmir_ssc_computeLiveness(jmir_func_pass_ssc_t* pass);
+static void jmir_ssc_buildGroups(jmir_func_pass_ssc_t* pass);
+static void jmir_ssc_layoutGroups(jmir_func_pass_ssc_t* pass);
+static void jmir_ssc_rewrite(jmir_func_pass_ssc_t* pass);
+static bool jmir_ssc_getInstrAccesses(jmir_func_pass_ssc_t* pass, jx_mir_instruction_t* instr, jmir_ssc_access_t* accesses, uint32_t* numAccesses);
+static uint32_t jmir_ssc_findSlot(jmir_func_pass_ssc_t* pass, int32_t displacement);
+static bool jmir_ssc_isStore(uint32_t opcode);
+static bool jmir_ssc_bitsetIntersects(const jx_bitset_t* a, const jx_bitset_t* b);
+
+bool jx_mir_funcPassCreate_stackSlotColoring(jx_mir_function_pass_t* pass, jx_allocator_i* allocator)
+{
+	jmir_func_pass_ssc_t* inst = (jmir_func_pass_ssc_t*)JX_ALLOC(allocator, sizeof(jmir_func_pass_ssc_t));
+	if (!inst) {
+		return false;
+	}
+
+	jx_memset(inst, 0, sizeof(jmir_func_pass_ssc_t));
+	inst->m_Allocator = allocator;
+
+	inst->m_LinearAllocator = allocator_api->createLinearAllocator(1u << 20, allocator);
+	if (!inst->m_LinearAllocator) {
+		JX_FREE(allocator, inst);
+		return false;
+	}
+
+	pass->m_Inst = (jx_mir_function_pass_o*)inst;
+	pass->run = jmir_funcPass_stackSlotColoringRun;
+	pass->destroy = jmir_funcPass_stackSlotColoringDestroy;
+
+	return true;
+}
+
+static void jmir_funcPass_stackSlotColoringDestroy(jx_mir_function_pass_o* inst, jx_allocator_i* allocator)
+{
+	jmir_func_pass_ssc_t* pass = (jmir_func_pass_ssc_t*)inst;
+
+	if (pass->m_LinearAllocator) {
+		allocator_api->destroyLinearAllocator(pass->m_LinearAllocator);
+		pass->m_LinearAllocator = NULL;
+	}
+
+	JX_FREE(allocator, pass);
+}
+
+static bool jmir_funcPass_stackSlotColoringRun(jx_mir_function_pass_o* inst, jx_mir_context_t* ctx, jx_mir_function_t* func)
+{
+	jx_mir_frame_info_t* frameInfo = func->m_FrameInfo;
+	if (jx_array_sizeu(frameInfo->m_StackSlotArr) < 2) {
+		return false;
+	}
+
+	TracyCZoneN(tracyCtx, "stackSlotColoring", 1);
+
+	jmir_func_pass_ssc_t* pass = (jmir_func_pass_ssc_t*)inst;
+	pass->m_Ctx = ctx;
+	pass->m_Func = func;
+
+	allocator_api->linearAllocatorReset(pass->m_LinearAllocator);
+
+	if (!jmir_ssc_init(pass)) {
+		TracyCZoneEnd(tracyCtx);
+		return false;
+	}
+
+	jmir_ssc_computeLiveness(pass);
+	jmir_ssc_buildGroups(pass);
+	jmir_ssc_layoutGroups(pass);
+	jmir_ssc_rewrite(pass);
+
+	TracyCZoneEnd(tracyCtx);
+
+	return true;
+}
+
+// Collects all slots and per-block gen/kill sets. Returns false if there is a
+// stack reference which cannot be handled.
+static bool jmir_ssc_init(jmir_func_pass_ssc_t* pass)
+{
+	jx_mir_context_t* ctx = pass->m_Ctx;
+	jx_mir_function_t* func = pass->m_Func;
+	jx_mir_frame_info_t* frameInfo = func->m_FrameInfo;
+
+	if (!jx_mir_funcUpdateCFG(ctx, func) || !jx_mir_funcUpdateSCCs(ctx, func)) {
+		return false;
+	}
+
+	pass->m_ArgAreaSize = frameInfo->m_MaxCallArgs * 8;
+	pass->m_NumSlots = (uint32_t)jx_array_sizeu(frameInfo->m_StackSlotArr);
+	pass->m_NumGroups = 0;
+	pass->m_Slots = (jmir_ssc_slot_t*)JX_ALLOC(pass->m_LinearAllocator, sizeof(jmir_ssc_slot_t) * pass->m_NumSlots);
+	pass->m_Groups = (jmir_ssc_group_t*)JX_ALLOC(pass->m_LinearAllocator, sizeof(jmir_ssc_group_t) * pass->m_NumSlots);
+	pass->m_BBInfo = (jmir_ssc_bb_info_t*)JX_ALLOC(pass->m_LinearAllocator, sizeof(jmir_ssc_bb_info_t) * func->m_NextBasicBlockID);
+	if (!pass->m_Slots || !pass->m_Groups || !pass->m_BBInfo) {
+		return false;
+	}
+
+	jx_memset(pass->m_Slots, 0, sizeof(jmir_ssc_slot_t) * pass->m_NumSlots);
+	jx_memset(pass->m_Groups, 0, sizeof(jmir_ssc_group_t) * pass->m_NumSlots);
+	jx_memset(pass->m_BBInfo, 0, sizeof(jmir_ssc_bb_info_t) * func->m_NextBasicBlockID);
+
+	for (uint32_t iSlot = 0; iSlot < pass->m_NumSlots; ++iSlot) {
+		jmir_ssc_slot_t* slot = &pass->m_Slots[iSlot];
+		slot->m_Offset = (uint32_t)frameInfo->m_StackSlotArr[iSlot].m_Obj->m_Displacement;
+		slot->m_GroupID = JMIR_SSC_INVALID_ID;
+		JX_CHECK(iSlot == 0 || slot->m_Offset >= pass->m_Slots[iSlot - 1].m_Offset, "Stack slots expected to be sorted by offset");
+	}
+
+	// Number instructions and calculate gen/kill sets.
+	uint32_t instrID = 0;
+	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		jmir_ssc_bb_info_t* bbInfo = &pass->m_BBInfo[bb->m_ID];
+		bbInfo->m_Gen = jx_bitsetCreate(pass->m_NumSlots, pass->m_LinearAllocator);
+		bbInfo->m_Kill = jx_bitsetCreate(pass->m_NumSlots, pass->m_LinearAllocator);
+		bbInfo->m_LiveIn = jx_bitsetCreate(pass->m_NumSlots, pass->m_LinearAllocator);
+		bbInfo->m_LiveOut = jx_bitsetCreate(pass->m_NumSlots, pass->m_LinearAllocator);
+		bbInfo->m_FirstInstrID = instrID;
+		if (!bbInfo->m_Gen || !bbInfo->m_Kill || !bbInfo->m_LiveIn || !bbInfo->m_LiveOut) {
+			return false;
+		}
+
+		const uint32_t loopDepth = bb->m_SCCInfo.m_SCC
+			? jx_min_u32(bb->m_SCCInfo.m_SCC->m_Depth, 6)
+			: 0
+			;
+		const uint64_t weight = (uint64_t)jx_pow_u32(10, loopDepth);
+
+		jx_mir_instruction_t* instr = bb->m_InstrListHead;
+		while (instr) {
+			jmir_ssc_access_t accesses[JMIR_SSC_MAX_ACCESSES];
+			uint32_t numAccesses = 0;
+			if (!jmir_ssc_getInstrAccesses(pass, instr, accesses, &numAccesses)) {
+				return false;
+			}
+
+			// Uses first, then defs.
+			for (uint32_t iAccess = 0; iAccess < numAccesses; ++iAccess) {
+				const uint32_t slotID = accesses[iAccess].m_SlotID;
+				pass->m_Slots[slotID].m_Weight += weight;
+				if (!accesses[iAccess].m_IsDef && !jx_bitsetIsBitSet(bbInfo->m_Kill, slotID)) {
+					jx_bitsetSetBit(bbInfo->m_Gen, slotID);
+				}
+			}
+			for (uint32_t iAccess = 0; iAccess < numAccesses; ++iAccess) {
+				if (accesses[iAccess].m_IsDef) {
+					jx_bitsetSetBit(bbInfo->m_Kill, accesses[iAccess].m_SlotID);
+				}
+			}
+
+			++instrID;
+			instr = instr->m_Next;
+		}
+
+		bb = bb->m_Next;
+	}
+
+	pass->m_NumInstructions = instrID;
+
+	for (uint32_t iSlot = 0; iSlot < pass->m_NumSlots; ++iSlot) {
+		jmir_ssc_slot_t* slot = &pass->m_Slots[iSlot];
+		if (!slot->m_AddressTaken) {
+			slot->m_LivePoints = jx_bitsetCreate(pass->m_NumInstructions, pass->m_LinearAllocator);
+			if (!slot->m_LivePoints) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static void jmir_ssc_computeLiveness(jmir_func_pass_ssc_t* pass)
+{
+	jx_mir_function_t* func = pass->m_Func;
+
+	// Block-level liveness
+	jx_bitset_t* liveIn = jx_bitsetCreate(pass->m_NumSlots, pass->m_LinearAllocator);
+	bool changed = true;
+	while (changed) {
+		changed = false;
+
+		jx_mir_basic_block_t* bb = func->m_BasicBlockListTail;
+		while (bb) {
+			jmir_ssc_bb_info_t* bbInfo = &pass->m_BBInfo[bb->m_ID];
+
+			jx_bitsetClear(bbInfo->m_LiveOut);
+			const uint32_t numSucc = (uint32_t)jx_array_sizeu(bb->m_SuccArr);
+			for (uint32_t iSucc = 0; iSucc < numSucc; ++iSucc) {
+				jx_bitsetUnion(bbInfo->m_LiveOut, pass->m_BBInfo[bb->m_SuccArr[iSucc]->m_ID].m_LiveIn);
+			}
+
+			// liveIn = gen U (liveOut - kill)
+			jx_bitsetCopy(liveIn, bbInfo->m_LiveOut);
+			jx_bitsetSub(liveIn, bbInfo->m_Kill);
+			jx_bitsetUnion(liveIn, bbInfo->m_Gen);
+			if (!jx_bitsetEqual(liveIn, bbInfo->m_LiveIn)) {
+				jx_bitsetCopy(bbInfo->m_LiveIn, liveIn);
+				changed = true;
+			}
+
+			bb = bb->m_Prev;
+		}
+	}
+
+	// Instruction-level live points
+	jx_bitset_t* live = jx_bitsetCreate(pass->m_NumSlots, pass->m_LinearAllocator);
+	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		jmir_ssc_bb_info_t* bbInfo = &pass->m_BBInfo[bb->m_ID];
+		jx_bitsetCopy(live, bbInfo->m_LiveOut);
+
+		uint32_t instrID = bbInfo->m_FirstInstrID;
+		jx_mir_instruction_t* instr = bb->m_InstrListHead;
+		while (instr) {
+			++instrID;
+			instr = instr->m_Next;
+		}
+
+		instr = bb->m_InstrListTail;
+		while (instr) {
+			--instrID;
+
+			jmir_ssc_access_t accesses[JMIR_SSC_MAX_ACCESSES];
+			uint32_t numAccesses = 0;
+			jmir_ssc_getInstrAccesses(pass, instr, accesses, &numAccesses);
+
+			for (uint32_t iAccess = 0; iAccess < numAccesses; ++iAccess) {
+				jx_bitsetSetBit(live, accesses[iAccess].m_SlotID);
+			}
+
+			jx_bitset_iterator_t it;
+			jx_bitsetIterBegin(live, &it, 0);
+			uint32_t slotID = jx_bitsetIterNext(live, &it);
+			while (slotID != UINT32_MAX) {
+				jmir_ssc_slot_t* slot = &pass->m_Slots[slotID];
+				if (slot->m_LivePoints) {
+					jx_bitsetSetBit(slot->m_LivePoints, instrID);
+				}
+
+				slotID = jx_bitsetIterNext(live, &it);
+			}
+
+			// live = (live - defs) U uses
+			for (uint32_t iAccess = 0; iAccess < numAccesses; ++iAccess) {
+				if (accesses[iAccess].m_IsDef) {
+					jx_bitsetResetBit(live, accesses[iAccess].m_SlotID);
+				}
+			}
+			for (uint32_t iAccess = 0; iAccess < numAccesses; ++iAccess) {
+				if (!accesses[iAccess].m_IsDef) {
+					jx_bitsetSetBit(live, accesses[iAccess].m_SlotID);
+				}
+			}
+
+			instr = instr->m_Prev;
+		}
+
+		bb = bb->m_Next;
+	}
+}
+
+static void jmir_ssc_buildGroups(jmir_func_pass_ssc_t* pass)
+{
+	jx_mir_frame_info_t* frameInfo = pass->m_Func->m_FrameInfo;
+	const uint32_t numSlots = pass->m_NumSlots;
+
+	// Visit slots by decreasing weight so the hottest slots pick their group first.
+	uint32_t* order = (uint32_t*)JX_ALLOC(pass->m_LinearAllocator, sizeof(uint32_t) * numSlots);
+	for (uint32_t iSlot = 0; iSlot < numSlots; ++iSlot) {
+		uint32_t pos = iSlot;
+		while (pos > 0 && pass->m_Slots[order[pos - 1]].m_Weight < pass->m_Slots[iSlot].m_Weight) {
+			order[pos] = order[pos - 1];
+			--pos;
+		}
+		order[pos] = iSlot;
+	}
+
+	for (uint32_t iOrder = 0; iOrder < numSlots; ++iOrder) {
+		const uint32_t slotID = order[iOrder];
+		jmir_ssc_slot_t* slot = &pass->m_Slots[slotID];
+		const jx_mir_stack_slot_t* frameSlot = &frameInfo->m_StackSlotArr[slotID];
+
+		if (!slot->m_AddressTaken) {
+			for (uint32_t iGroup = 0; iGroup < pass->m_NumGroups; ++iGroup) {
+				jmir_ssc_group_t* group = &pass->m_Groups[iGroup];
+				const bool canShare = true
+					&& !group->m_AddressTaken
+					&& group->m_Size == frameSlot->m_Size
+					&& group->m_Alignment == frameSlot->m_Alignment
+					&& !jmir_ssc_bitsetIntersects(group->m_LivePoints, slot->m_LivePoints)
+					;
+				if (canShare) {
+					jx_bitsetUnion(group->m_LivePoints, slot->m_LivePoints);
+					group->m_Weight += slot->m_Weight;
+					slot->m_GroupID = iGroup;
+					break;
+				}
+			}
+		}
+
+		if (slot->m_GroupID == JMIR_SSC_INVALID_ID) {
+			jmir_ssc_group_t* group = &pass->m_Groups[pass->m_NumGroups];
+			group->m_Size = frameSlot->m_Size;
+			group->m_Alignment = frameSlot->m_Alignment;
+			group->m_Weight = slot->m_Weight;
+			group->m_AddressTaken = slot->m_AddressTaken;
+			if (!slot->m_AddressTaken) {
+				group->m_LivePoints = jx_bitsetCreate(pass->m_NumInstructions, pass->m_LinearAllocator);
+				jx_bitsetCopy(group->m_LivePoints, slot->m_LivePoints);
+			}
+
+			slot->m_GroupID = pass->m_NumGroups++;
+		}
+	}
+}
+
+static void jmir_ssc_layoutGroups(jmir_func_pass_ssc_t* pass)
+{
+	const uint32_t numGroups = pass->m_NumGroups;
+
+	uint32_t* order = (uint32_t*)JX_ALLOC(pass->m_LinearAllocator, sizeof(uint32_t) * numGroups);
+	for (uint32_t iGroup = 0; iGroup < numGroups; ++iGroup) {
+		uint32_t pos = iGroup;
+		while (pos > 0 && pass->m_Groups[order[pos - 1]].m_Weight < pass->m_Groups[iGroup].m_Weight) {
+			order[pos] = order[pos - 1];
+			--pos;
+		}
+		order[pos] = iGroup;
+	}
+
+	uint32_t offset = pass->m_ArgAreaSize;
+	for (uint32_t iOrder = 0; iOrder < numGroups; ++iOrder) {
+		jmir_ssc_group_t* group = &pass->m_Groups[order[iOrder]];
+		offset = jx_roundup_u32(offset, jx_max_u32(group->m_Alignment, 1));
+		group->m_Offset = offset;
+		offset += group->m_Size;
+	}
+
+	pass->m_Func->m_FrameInfo->m_Size = offset;
+}
+
+static void jmir_ssc_rewrite(jmir_func_pass_ssc_t* pass)
+{
+	jx_mir_context_t* ctx = pass->m_Ctx;
+	jx_mir_function_t* func = pass->m_Func;
+	jx_mir_frame_info_t* frameInfo = func->m_FrameInfo;
+
+	// NOTE: Memory refs might be shared between instructions and the frame's object list, 
+	// so instruction operands are replaced with new memory refs instead of being patched.
+	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		jx_mir_instruction_t* instr = bb->m_InstrListHead;
+		while (instr) {
+			const uint32_t numOperands = instr->m_NumOperands;
+			for (uint32_t iOperand = 0; iOperand < numOperands; ++iOperand) {
+				jx_mir_operand_t* operand = instr->m_Operands[iOperand];
+				if (operand->m_Kind != JMIR_OPERAND_MEMORY_REF || !jx_mir_regEqual(operand->u.m_MemRef->m_BaseReg, kMIRRegGP_SP)) {
+					continue;
+				}
+
+				const jx_mir_memory_ref_t* memRef = operand->u.m_MemRef;
+				const uint32_t slotID = jmir_ssc_findSlot(pass, memRef->m_Displacement);
+				if (slotID == JMIR_SSC_INVALID_ID) {
+					continue;
+				}
+
+				const jmir_ssc_slot_t* slot = &pass->m_Slots[slotID];
+				const int32_t newDisplacement = memRef->m_Displacement - (int32_t)slot->m_Offset + (int32_t)pass->m_Groups[slot->m_GroupID].m_Offset;
+				if (newDisplacement != memRef->m_Displacement) {
+					instr->m_Operands[iOperand] = jx_mir_opMemoryRef(ctx, func, operand->m_Type, memRef->m_BaseReg, memRef->m_IndexReg, memRef->m_Scale, newDisplacement);
+				}
+			}
+
+			instr = instr->m_Next;
+		}
+
+		bb = bb->m_Next;
+	}
+
+	// Patch all stack objects in place (incl. objects relative to other objects).
+	const uint32_t numStackObjects = (uint32_t)jx_array_sizeu(frameInfo->m_StackObjArr);
+	for (uint32_t iObj = 0; iObj < numStackObjects; ++iObj) {
+		jx_mir_memory_ref_t* obj = frameInfo->m_StackObjArr[iObj];
+		const uint32_t slotID = jmir_ssc_findSlot(pass, obj->m_Displacement);
+		if (slotID != JMIR_SSC_INVALID_ID) {
+			const jmir_ssc_slot_t* slot = &pass->m_Slots[slotID];
+			obj->m_Displacement = obj->m_Displacement - (int32_t)slot->m_Offset + (int32_t)pass->m_Groups[slot->m_GroupID].m_Offset;
+		}
+	}
+}
+
+// Returns all slot accesses of the instruction. Returns false if the instruction references 
+// the frame in a way which doesn't allow moving or sharing slots.
+static bool jmir_ssc_getInstrAccesses(jmir_func_pass_ssc_t* pass, jx_mir_instruction_t* instr, jmir_ssc_access_t* accesses, uint32_t* numAccesses)
+{
+	jx_mir_frame_info_t* frameInfo = pass->m_Func->m_FrameInfo;
+
+	*numAccesses = 0;
+
+	const uint32_t numOperands = instr->m_NumOperands;
+	for (uint32_t iOperand = 0; iOperand < numOperands; ++iOperand) {
+		jx_mir_operand_t* operand = instr->m_Operands[iOperand];
+		if (operand->m_Kind == JMIR_OPERAND_REGISTER) {
+			if (jx_mir_regEqual(operand->u.m_Reg, kMIRRegGP_SP)) {
+				// Frame address escapes through a register.
+				return false;
+			}
+			continue;
+		} else if (operand->m_Kind != JMIR_OPERAND_MEMORY_REF) {
+			continue;
+		}
+
+		const jx_mir_memory_ref_t* memRef = operand->u.m_MemRef;
+		if (jx_mir_regEqual(memRef->m_IndexReg, kMIRRegGP_SP)) {
+			return false;
+		} else if (!jx_mir_regEqual(memRef->m_BaseReg, kMIRRegGP_SP)) {
+			continue;
+		}
+
+		const bool hasIndex = jx_mir_regIsValid(memRef->m_IndexReg);
+		if (!hasIndex && memRef->m_Displacement >= 0 && (uint32_t)memRef->m_Displacement < pass->m_ArgAreaSize) {
+			// Outgoing call arguments
+			continue;
+		}
+
+		const uint32_t slotID = jmir_ssc_findSlot(pass, memRef->m_Displacement);
+		if (slotID == JMIR_SSC_INVALID_ID || *numAccesses == JMIR_SSC_MAX_ACCESSES) {
+			return false;
+		}
+
+		jmir_ssc_slot_t* slot = &pass->m_Slots[slotID];
+		const jx_mir_stack_slot_t* frameSlot = &frameInfo->m_StackSlotArr[slotID];
+		const uint32_t slotOffset = (uint32_t)memRef->m_Displacement - slot->m_Offset;
+		if (instr->m_OpCode == JMIR_OP_LEA || hasIndex) {
+			slot->m_AddressTaken = true;
+		} else if (slotOffset + jx_mir_typeGetSize(operand->m_Type) > frameSlot->m_Size) {
+			// Access crosses slot boundaries.
+			return false;
+		}
+
+		const bool isDef = true
+			&& iOperand == 0
+			&& slotOffset == 0
+			&& jmir_ssc_isStore(instr->m_OpCode)
+			&& ((frameSlot->m_Flags & JMIR_STACK_SLOT_FLAGS_SPILL_Msk) != 0 || jx_mir_typeGetSize(operand->m_Type) == frameSlot->m_Size)
+			;
+		accesses[*numAccesses] = (jmir_ssc_access_t){ .m_SlotID = slotID, .m_IsDef = isDef };
+		*numAccesses = *numAccesses + 1;
+	}
+
+	return true;
+}
+
+// Returns the ID of the slot containing the specified (pre-compaction) displacement.
+static uint32_t jmir_ssc_findSlot(jmir_func_pass_ssc_t* pass, int32_t displacement)
+{
+	if (displacement < 0) {
+		return JMIR_SSC_INVALID_ID;
+	}
+
+	// Find the last slot starting at or before the displacement.
+	uint32_t lo = 0;
+	uint32_t hi = pass->m_NumSlots;
+	while (lo < hi) {
+		const uint32_t mid = lo + (hi - lo) / 2;
+		if (pass->m_Slots[mid].m_Offset <= (uint32_t)displacement) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if (lo == 0) {
+		return JMIR_SSC_INVALID_ID;
+	}
+
+	const uint32_t slotID = lo - 1;
+	const jx_mir_stack_slot_t* frameSlot = &pass->m_Func->m_FrameInfo->m_StackSlotArr[slotID];
+	return (uint32_t)displacement < pass->m_Slots[slotID].m_Offset + jx_max_u32(frameSlot->m_Size, 1)
+		? slotID
+		: JMIR_SSC_INVALID_ID
+		;
+}
+
+static bool jmir_ssc_isStore(uint32_t opcode)
+{
+	return false
+		|| opcode == JMIR_OP_MOV
+		|| opcode == JMIR_OP_MOVSS
+		|| opcode == JMIR_OP_MOVSD
+		|| opcode == JMIR_OP_MOVAPS
+		|| opcode == JMIR_OP_MOVAPD
+		|| opcode == JMIR_OP_MOVUPS
+		|| opcode == JMIR_OP_MOVUPD
+		|| opcode == JMIR_OP_MOVD
+		|| opcode == JMIR_OP_MOVQ
+		;
+}
+
+static bool jmir_ssc_bitsetIntersects(const jx_bitset_t* a, const jx_bitset_t* b)
+{
+	const uint32_t numWords = (jx_min_u32(a->m_NumBits, b->m_NumBits) + 63) / 64;
+	for (uint32_t iWord = 0; iWord < numWords; ++iWord) {
+		if ((a->m_Bits[iWord] & b->m_Bits[iWord]) != 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Instruction Scheduler
+// 
+// List scheduler over the instructions of each basic block. Blocks are split into 
+// regions at calls and terminators. Pre-RA, instructions which reference hw registers 
+// (other than RSP) also split regions, so argument setup and implicit register sequences 
+// (e.g. cqo/idiv) are left as they were generated.
+// 
+// The dependency DAG of each region is built from the use/def info of the instructions
+// (RAW/WAR/WAW on registers), from the flags register and from memory references. Two 
+// memory references are assumed to alias unless both are non-overlapping stack slots or
+// one of them is a stack slot and the other a global.
+// 
+// Post-RA, ready instructions are picked by the length of their critical path to the 
+// end of the region, using a per-opcode latency table for a generic modern x86 core with
+// a 4-wide issue (the "issueWidth" option). Pre-RA, the instruction with the best effect 
+// on register pressure is picked instead whenever the number of live registers of a class 
+// gets close to the number of available hw registers.
+//
+#define JMIR_SCHED_ISSUE_WIDTH  4
+#define JMIR_SCHED_LOAD_LATENCY 4
+#define JMIR_SCHED_INVALID_ID   UINT32_MAX
+
+typedef enum jmir_sched_mode
+{
+	JMIR_SCHED_MODE_PRE_RA = 0,
+	JMIR_SCHED_MODE_POST_RA,
+} jmir_sched_mode;
+
+typedef struct jmir_sched_node_t
+{
+	jx_mir_instruction_t* m_Instr;
+	uint32_t m_FirstSucc;
+	uint32_t m_NumSuccs;
+	uint32_t m_NumPreds;      // Number of unscheduled predecessors
+	uint32_t m_Latency;
+	uint32_t m_Height;        // Critical path length to the end of the region (incl. own latency)
+	uint32_t m_EarliestCycle;
+} jmir_sched_node_t;
+
+typedef struct jmir_sched_edge_t
+{
+	uint32_t m_From;
+	uint32_t m_To;
+	uint32_t m_Latency;
+} jmir_sched_edge_t;
+
+typedef struct jmir_sched_reg_use_t
+{
+	uint32_t m_NodeID;
+	uint32_t m_Next;
+} jmir_sched_reg_use_t;
+
+typedef struct jmir_sched_mem_access_t
+{
+	const jx_mir_memory_ref_t* m_MemRef; // NULL for global variables (external symbols)
+	uint32_t m_NodeID;
+	uint32_t m_Size;
+	bool m_IsStore;
+	JX_PAD(7);
+} jmir_sched_mem_access_t;
+
+typedef struct jmir_func_pass_sched_t
+{
+	jx_allocator_i* m_Allocator;
+	jx_mir_context_t* m_Ctx;
+	jx_mir_function_t* m_Func;
+	jmir_sched_node_t* m_NodeArr;
+	jmir_sched_edge_t* m_EdgeArr;
+	uint32_t* m_SuccArr;
+	uint32_t* m_SuccLatencyArr;
+	uint32_t* m_ReadyArr;
+	uint32_t* m_OrderArr;
+	uint32_t* m_RegLastDef;
+	uint32_t* m_RegFirstUse;       // Head of the list of uses since the last def
+	uint32_t* m_RegNumUses;        // Number of unscheduled uses in the current region
+	jmir_sched_reg_use_t* m_RegUseArr;
+	jmir_sched_mem_access_t* m_MemAccessArr;
+	jx_bitset_t* m_LiveSet;
+	const jx_bitset_t* m_LiveAfterSet;
+	jmir_sched_mode m_Mode;
+	uint32_t m_IssueWidth;
+	uint32_t m_NumRegIDs;          // All registers + flags
+	uint32_t m_Pressure[JMIR_REG_CLASS_COUNT];
+	uint32_t m_PressureLimit[JMIR_REG_CLASS_COUNT];
+} jmir_func_pass_sched_t;
+
+static bool jmir_funcPass_schedulerCreate(jx_mir_function_pass_t* pass, jx_allocator_i* allocator, jmir_sched_mode mode);
+static void jmir_funcPass_schedulerDestroy(jx_mir_function_pass_o* inst, jx_allocator_i* allocator);
+static bool jmir_funcPass_schedulerRun(jx_mir_function_pass_o* inst, jx_mir_context_t* ctx, jx_mir_function_t* func);
+static bool jmir_funcPass_schedulerSetOption(jx_mir_function_pass_o* inst, const char* name, int64_t value);
+
+static bool jmir_sched_scheduleRegion(jmir_func_pass_sched_t* pass, jx_mir_basic_block_t* bb, jx_mir_instruction_t* firstInstr, uint32_t numInstrs, jx_mir_instruction_t* endInstr);
+static void jmir_sched_buildDAG(jmir_func_pass_sched_t* pass, uint32_t numNodes);
+static void jmir_sched_addEdge(jmir_func_pass_sched_t* pass, uint32_t from, uint32_t to, uint32_t latency);
+static void jmir_sched_scheduleLatency(jmir_func_pass_sched_t* pass, uint32_t numNodes);
+static void jmir_sched_schedulePressure(jmir_func_pass_sched_t* pass, uint32_t numNodes);
+static void jmir_sched_nodeScheduled(jmir_func_pass_sched_t* pass, uint32_t nodeID, uint32_t cycle);
+static void jmir_sched_updatePressure(jmir_func_pass_sched_t* pass, jx_mir_instruction_t* instr, int32_t* delta, bool apply);
+static bool jmir_sched_isBarrier(jmir_func_pass_sched_t* pass, jx_mir_instruction_t* instr);
+static bool jmir_sched_getMemAccess(jx_mir_instruction_t* instr, jmir_sched_mem_access_t* access);
+static bool jmir_sched_memMayAlias(const jmir_sched_mem_access_t* a, const jmir_sched_mem_access_t* b);
+static bool jmir_sched_opcodeReadsFlags(uint32_t opcode);
+static bool jmir_sched_opcodeWritesFlags(uint32_t opcode);
+static uint32_t jmir_sched_getLatency(jx_mir_instruction_t* instr);
+
+bool jx_mir_funcPassCreate_preRAScheduler(jx_mir_function_pass_t* pass, jx_allocator_i* allocator)
+{
+	return jmir_funcPass_schedulerCreate(pass, allocator, JMIR_SCHED_MODE_PRE_RA);
+}
+
+bool jx_mir_funcPassCreate_postRAScheduler(jx_mir_function_pass_t* pass, jx_allocator_i* allocator)
+{
+	return jmir_funcPass_schedulerCreate(pass, allocator, JMIR_SCHED_MODE_POST_RA);
+}
+
+static bool jmir_funcPass_schedulerCreate(jx_mir_function_pass_t* pass, jx_allocator_i* allocator, jmir_sched_mode mode)
+{
+	jmir_func_pass_sched_t* inst = (jmir_func_pass_sched_t*)JX_ALLOC(allocator, sizeof(jmir_func_pass_sched_t));
+	if (!inst) {
+		return false;
+	}
+
+	jx_memset(inst, 0, sizeof(jmir_func_pass_sched_t));
+	inst->m_Allocator = allocator;
+	inst->m_Mode = mode;
+	inst->m_IssueWidth = JMIR_SCHED_ISSUE_WIDTH;
+
+	inst->m_NodeArr = (jmir_sched_node_t*)jx_array_create(allocator);
+	inst->m_EdgeArr = (jmir_sched_edge_t*)jx_array_create(allocator);
+	inst->m_SuccArr = (uint32_t*)jx_array_create(allocator);
+	inst->m_SuccLatencyArr = (uint32_t*)jx_array_create(allocator);
+	inst->m_ReadyArr = (uint32_t*)jx_array_create(allocator);
+	inst->m_OrderArr = (uint32_t*)jx_array_create(allocator);
+	inst->m_RegLastDef = (uint32_t*)jx_array_create(allocator);
+	inst->m_RegFirstUse = (uint32_t*)jx_array_create(allocator);
+	inst->m_RegNumUses = (uint32_t*)jx_array_create(allocator);
+	inst->m_RegUseArr = (jmir_sched_reg_use_t*)jx_array_create(allocator);
+	inst->m_MemAccessArr = (jmir_sched_mem_access_t*)jx_array_create(allocator);
+	const bool allocated = true
+		&& inst->m_NodeArr
+		&& inst->m_EdgeArr
+		&& inst->m_SuccArr
+		&& inst->m_SuccLatencyArr
+		&& inst->m_ReadyArr
+		&& inst->m_OrderArr
+		&& inst->m_RegLastDef
+		&& inst->m_RegFirstUse
+		&& inst->m_RegNumUses
+		&& inst->m_RegUseArr
+		&& inst->m_MemAccessArr
+		;
+	if (!allocated) {
+		jmir_funcPass_schedulerDestroy((jx_mir_function_pass_o*)inst, allocator);
+		return false;
+	}
+
+	// NOTE: RSP is never allocated and RBP might be reserved for the frame pointer.
+	inst->m_PressureLimit[JMIR_REG_CLASS_GP] = 14 - 2;
+	inst->m_PressureLimit[JMIR_REG_CLASS_XMM] = 16 - 2;
+
+	pass->m_Inst = (jx_mir_function_pass_o*)inst;
+	pass->run = jmir_funcPass_schedulerRun;
+	pass->destroy = jmir_funcPass_schedulerDestroy;
+	pass->setOption = jmir_funcPass_schedulerSetOption;
+
+	return true;
+}
+
+static void jmir_funcPass_schedulerDestroy(jx_mir_function_pass_o* inst, jx_allocator_i* allocator)
+{
+	jmir_func_pass_sched_t* pass = (jmir_func_pass_sched_t*)inst;
+
+	jx_array_free(pass->m_NodeArr);
+	jx_array_free(pass->m_EdgeArr);
+	jx_array_free(pass->m_SuccArr);
+	jx_array_free(pass->m_SuccLatencyArr);
+	jx_array_free(pass->m_ReadyArr);
+	jx_array_free(pass->m_OrderArr);
+	jx_array_free(pass->m_RegLastDef);
+	jx_array_free(pass->m_RegFirstUse);
+	jx_array_free(pass->m_RegNumUses);
+	jx_array_free(pass->m_RegUseArr);
+	jx_array_free(pass->m_MemAccessArr);
+
+	JX_FREE(allocator, pass);
+}
+
+static bool jmir_funcPass_schedulerRun(jx_mir_function_pass_o* inst, jx_mir_context_t* ctx, jx_mir_function_t* func)
+{
+	TracyCZoneN(tracyCtx, "scheduler", 1);
+
+	jmir_func_pass_sched_t* pass = (jmir_func_pass_sched_t*)inst;
+	pass->m_Ctx = ctx;
+	pass->m_Func = func;
+
+	// NOTE: Liveness is needed for the live-in/out sets of each region and it also 
+	// recalculates the use/def info of all instructions.
+	if (!jx_mir_funcUpdateLiveness(ctx, func)) {
+		TracyCZoneEnd(tracyCtx);
+		return false;
+	}
+
+	const uint32_t numRegs = jx_mir_funcGetRegBitsetSize(ctx, func);
+	pass->m_NumRegIDs = numRegs + 1; // Last ID is the flags register
+	jx_array_resize(pass->m_RegLastDef, pass->m_NumRegIDs);
+	jx_array_resize(pass->m_RegFirstUse, pass->m_NumRegIDs);
+	jx_array_resize(pass->m_RegNumUses, pass->m_NumRegIDs);
+
+	pass->m_LiveSet = pass->m_Mode == JMIR_SCHED_MODE_PRE_RA
+		? jx_bitsetCreate(numRegs, pass->m_Allocator)
+		: NULL
+		;
+
+	bool changed = false;
+	jx_mir_basic_block_t* bb = func->m_BasicBlockListHead;
+	while (bb) {
+		jx_mir_instruction_t* instr = bb->m_InstrListHead;
+		while (instr) {
+			if (jmir_sched_isBarrier(pass, instr)) {
+				instr = instr->m_Next;
+				continue;
+			}
+
+			jx_mir_instruction_t* firstInstr = instr;
+			uint32_t numInstrs = 0;
+			while (instr && !jmir_sched_isBarrier(pass, instr)) {
+				++numInstrs;
+				instr = instr->m_Next;
+			}
+
+			if (numInstrs > 1) {
+				changed = jmir_sched_scheduleRegion(pass, bb, firstInstr, numInstrs, instr) || changed;
+			}
+		}
+
+		bb = bb->m_Next;
+	}
+
+	if (pass->m_LiveSet) {
+		jx_bitsetDestroy(pass->m_LiveSet, pass->m_Allocator);
+		pass->m_LiveSet = NULL;
+	}
+
+	TracyCZoneEnd(tracyCtx);
+
+	return changed;
+}
+
+static bool jmir_funcPass_schedulerSetOption(jx_mir_function_pass_o* inst, const char* name, int64_t value)
+{
+	jmir_func_pass_sched_t* pass = (jmir_func_pass_sched_t*)inst;
+
+	if (!jx_strcmp(name, "issueWidth")) {
+		if (value < 1 || value > 16) {
+			return false;
+		}
+
+		pass->m_IssueWidth = (uint32_t)value;
+		return true;
+	}
+
+	return false;
+}
+
+static bool jmir_sched_scheduleRegion(jmir_func_pass_sched_t* pass, jx_mir_basic_block_t* bb, jx_mir_instruction_t* firstInstr, uint32_t numInstrs, jx_mir_instruction_t* endInstr)
+{
+	jx_mir_context_t* ctx = pass->m_Ctx;
+
+	jx_array_resize(pass->m_NodeArr, numInstrs);
+	jx_array_resize(pass->m_OrderArr, 0);
+
+	jx_mir_instruction_t* instr = firstInstr;
+	for (uint32_t iNode = 0; iNode < numInstrs; ++iNode) {
+		jmir_sched_node_t* node = &pass->m_NodeArr[iNode];
+		jx_memset(node, 0, sizeof(jmir_sched_node_t));
+		node->m_Instr = instr;
+		node->m_Latency = jmir_sched_getLatency(instr);
+		instr = instr->m_Next;
+	}
+
+	jmir_sched_buildDAG(pass, numInstrs);
+
+	if (pass->m_Mode == JMIR_SCHED_MODE_PRE_RA) {
+		// Live registers before the first instruction and after the last instruction of the region.
+		jx_bitsetCopy(pass->m_LiveSet, firstInstr->m_Prev ? &firstInstr->m_Prev->m_LiveOutSet : &bb->m_LiveInSet);
+		pass->m_LiveAfterSet = &pass->m_NodeArr[numInstrs - 1].m_Instr->m_LiveOutSet;
+
+		jx_memset(pass->m_Pressure, 0, sizeof(pass->m_Pressure));
+		jx_bitset_iterator_t it;
+		jx_bitsetIterBegin(pass->m_LiveSet, &it, 0);
+		uint32_t regID = jx_bitsetIterNext(pass->m_LiveSet, &it);
+		while (regID != UINT32_MAX) {
+			pass->m_Pressure[jx_mir_funcMapBitsetIDToReg(ctx, pass->m_Func, regID).m_Class]++;
+			regID = jx_bitsetIterNext(pass->m_LiveSet, &it);
+		}
+
+		jmir_sched_schedulePressure(pass, numInstrs);
+	} else {
+		jmir_sched_scheduleLatency(pass, numInstrs);
+	}
+
+	JX_CHECK(jx_array_sizeu(pass->m_OrderArr) == numInstrs, "Not all instructions have been scheduled.");
+
+	bool changed = false;
+	for (uint32_t iNode = 0; iNode < numInstrs && !changed; ++iNode) {
+		changed = pass->m_OrderArr[iNode] != iNode;
+	}
+
+	if (changed) {
+		for (uint32_t iNode = 0; iNode < numInstrs; ++iNode) {
+			jx_mir_instruction_t* schedInstr = pass->m_NodeArr[pass->m_OrderArr[iNode]].m_Instr;
+			jx_mir_bbRemoveInstr(ctx, bb, schedInstr);
+			if (endInstr) {
+				jx_mir_bbInsertInstrBefore(ctx, bb, endInstr, schedInstr);
+			} else {
+				jx_mir_bbAppendInstr(ctx, bb, schedInstr);
+			}
+		}
+	}
+
+	return changed;
+}
+
+static void jmir_sched_buildDAG(jmir_func_pass_sched_t* pass, uint32_t numNodes)
+{
+	jx_mir_context_t* ctx = pass->m_Ctx;
+	jx_mir_function_t* func = pass->m_Func;
+	const uint32_t flagsRegID = pass->m_NumRegIDs - 1;
+
+	jx_memset(pass->m_RegLastDef, 0xFF, sizeof(uint32_t) * pass->m_NumRegIDs);
+	jx_memset(pass->m_RegFirstUse, 0xFF, sizeof(uint32_t) * pass->m_NumRegIDs);
+	jx_memset(pass->m_RegNumUses, 0, sizeof(uint32_t) * pass->m_NumRegIDs);
+	jx_array_resize(pass->m_EdgeArr, 0);
+	jx_array_resize(pass->m_RegUseArr, 0);
+	jx_array_resize(pass->m_MemAccessArr, 0);
+
+	for (uint32_t iNode = 0; iNode < numNodes; ++iNode) {
+		jx_mir_instruction_t* instr = pass->m_NodeArr[iNode].m_Instr;
+		const jx_mir_instr_usedef_t* useDef = &instr->m_UseDef;
+
+		uint32_t useIDs[JMIR_MAX_INSTR_USES + 1];
+		uint32_t numUses = 0;
+		for (uint32_t iUse = 0; iUse < useDef->m_NumUses; ++iUse) {
+			useIDs[numUses++] = jx_mir_funcMapRegToBitsetID(ctx, func, useDef->m_Uses[iUse]);
+		}
+		if (jmir_sched_opcodeReadsFlags(instr->m_OpCode)) {
+			useIDs[numUses++] = flagsRegID;
+		}
+
+		uint32_t defIDs[JMIR_MAX_INSTR_DEFS + 1];
+		uint32_t numDefs = 0;
+		for (uint32_t iDef = 0; iDef < useDef->m_NumDefs; ++iDef) {
+			defIDs[numDefs++] = jx_mir_funcMapRegToBitsetID(ctx, func, useDef->m_Defs[iDef]);
+		}
+		if (jmir_sched_opcodeWritesFlags(instr->m_OpCode)) {
+			defIDs[numDefs++] = flagsRegID;
+		}
+
+		// RAW
+		for (uint32_t iUse = 0; iUse < numUses; ++iUse) {
+			const uint32_t regID = useIDs[iUse];
+			const uint32_t defNodeID = pass->m_RegLastDef[regID];
+			if (defNodeID != JMIR_SCHED_INVALID_ID) {
+				jmir_sched_addEdge(pass, defNodeID, iNode, pass->m_NodeArr[defNodeID].m_Latency);
+			}
+
+			jx_array_push_back(pass->m_RegUseArr, (jmir_sched_reg_use_t){ .m_NodeID = iNode, .m_Next = pass->m_RegFirstUse[regID] });
+			pass->m_RegFirstUse[regID] = (uint32_t)jx_array_sizeu(pass->m_RegUseArr) - 1;
+			pass->m_RegNumUses[regID]++;
+		}
+
+		// WAR + WAW
+		for (uint32_t iDef = 0; iDef < numDefs; ++iDef) {
+			const uint32_t regID = defIDs[iDef];
+
+			uint32_t useID = pass->m_RegFirstUse[regID];
+			while (useID != JMIR_SCHED_INVALID_ID) {
+				const jmir_sched_reg_use_t* use = &pass->m_RegUseArr[useID];
+				if (use->m_NodeID != iNode) {
+					jmir_sched_addEdge(pass, use->m_NodeID, iNode, 0);
+				}
+				useID = use->m_Next;
+			}
+
+			const uint32_t defNodeID = pass->m_RegLastDef[regID];
+			if (defNodeID != JMIR_SCHED_INVALID_ID && defNodeID != iNode) {
+				jmir_sched_addEdge(pass, defNodeID, iNode, 0);
+			}
+
+			pass->m_RegLastDef[regID] = iNode;
+			pass->m_RegFirstUse[regID] = JMIR_SCHED_INVALID_ID;
+		}
+
+		// Memory
+		jmir_sched_mem_access_t access;
+		if (jmir_sched_getMemAccess(instr, &access)) {
+			access.m_NodeID = iNode;
+
+			const uint32_t numAccesses = (uint32_t)jx_array_sizeu(pass->m_MemAccessArr);
+			for (uint32_t iAccess = 0; iAccess < numAccesses; ++iAccess) {
+				const jmir_sched_mem_access_t* prevAccess = &pass->m_MemAccessArr[iAccess];
+				if ((prevAccess->m_IsStore || access.m_IsStore) && jmir_sched_memMayAlias(prevAccess, &access)) {
+					const uint32_t latency = prevAccess->m_IsStore && !access.m_IsStore
+						? pass->m_NodeArr[prevAccess->m_NodeID].m_Latency
+						: 0
+						;
+					jmir_sched_addEdge(pass, prevAccess->m_NodeID, iNode, latency);
+				}
+			}
+
+			jx_array_push_back(pass->m_MemAccessArr, access);
+		}
+	}
+
+	// Build successor lists
+	const uint32_t numEdges = (uint32_t)jx_array_sizeu(pass->m_EdgeArr);
+	for (uint32_t iEdge = 0; iEdge < numEdges; ++iEdge) {
+		const jmir_sched_edge_t* edge = &pass->m_EdgeArr[iEdge];
+		pass->m_NodeArr[edge->m_From].m_NumSuccs++;
+		pass->m_NodeArr[edge->m_To].m_NumPreds++;
+	}
+
+	uint32_t firstSucc = 0;
+	for (uint32_t iNode = 0; iNode < numNodes; ++iNode) {
+		jmir_sched_node_t* node = &pass->m_NodeArr[iNode];
+		node->m_FirstSucc = firstSucc;
+		firstSucc += node->m_NumSuccs;
+		node->m_NumSuccs = 0;
+	}
+
+	jx_array_resize(pass->m_SuccArr, numEdges);
+	jx_array_resize(pass->m_SuccLatencyArr, numEdges);
+	for (uint32_t iEdge = 0; iEdge < numEdges; ++iEdge) {
+		const jmir_sched_edge_t* edge = &pass->m_EdgeArr[iEdge];
+		jmir_sched_node_t* from = &pass->m_NodeArr[edge->m_From];
+		pass->m_SuccArr[from->m_FirstSucc + from->m_NumSuccs] = edge->m_To;
+		pass->m_SuccLatencyArr[from->m_FirstSucc + from->m_NumSuccs] = edge->m_Latency;
+		from->m_NumSuccs++;
+	}
+
+	// Heights (edges always go from earlier to later instructions)
+	for (uint32_t iNode = numNodes; iNode > 0; --iNode) {
+		jmir_sched_node_t* node = &pass->m_NodeArr[iNode - 1];
+		uint32_t height = node->m_Latency;
+		for (uint32_t iSucc = 0; iSucc < node->m_NumSuccs; ++iSucc) {
+			const uint32_t succID = pass->m_SuccArr[node->m_FirstSucc + iSucc];
+			const uint32_t latency = pass->m_SuccLatencyArr[node->m_FirstSucc + iSucc];
+			height = jx_max_u32(height, latency + pass->m_NodeArr[succID].m_Height);
+		}
+		node->m_Height = height;
+	}
+}
+
+static void jmir_sched_addEdge(jmir_func_pass_sched_t* pass, uint32_t from, uint32_t to, uint32_t latency)
+{
+	JX_CHECK(from < to, "Scheduler edges must point forward.");
+	jx_array_push_back(pass->m_EdgeArr, (jmir_sched_edge_t){ .m_From = from, .m_To = to, .m_Latency = latency });
+}
+
+// Cycle-driven list scheduling. The ready instruction with the longest path to the end of 
+// the region is issued first; if no instruction is ready at the current cycle, the clock 
+// advances to the cycle the first instruction becomes ready.
+static void jmir_sched_scheduleLatency(jmir_func_pass_sched_t* pass, uint32_t numNodes)
+{
+	jx_array_resize(pass->m_ReadyArr, 0);
+	for (uint32_t iNode = 0; iNode < numNodes; ++iNode) {
+		if (pass->m_NodeArr[iNode].m_NumPreds == 0) {
+			jx_array_push_back(pass->m_ReadyArr, iNode);
+		}
+	}
+
+	uint32_t cycle = 0;
+	uint32_t numIssued = 0;
+	while (jx_array_sizeu(pass->m_ReadyArr) != 0) {
+		const uint32_t numReady = (uint32_t)jx_array_sizeu(pass->m_ReadyArr);
+
+		uint32_t bestReadyID = JMIR_SCHED_INVALID_ID;
+		uint32_t minEarliestCycle = UINT32_MAX;
+		for (uint32_t iReady = 0; iReady < numReady; ++iReady) {
+			const uint32_t nodeID = pass->m_ReadyArr[iReady];
+			const jmir_sched_node_t* node = &pass->m_NodeArr[nodeID];
+			minEarliestCycle = jx_min_u32(minEarliestCycle, node->m_EarliestCycle);
+			if (node->m_EarliestCycle > cycle) {
+				continue;
+			}
+
+			if (bestReadyID == JMIR_SCHED_INVALID_ID) {
+				bestReadyID = iReady;
+			} else {
+				const uint32_t bestNodeID = pass->m_ReadyArr[bestReadyID];
+				const jmir_sched_node_t* bestNode = &pass->m_NodeArr[bestNodeID];
+				const bool isBetter = false
+					|| node->m_Height > bestNode->m_Height
+					|| (node->m_Height == bestNode->m_Height && nodeID < bestNodeID)
+					;
+				if (isBetter) {
+					bestReadyID = iReady;
+				}
+			}
+		}
+
+		if (bestReadyID == JMIR_SCHED_INVALID_ID) {
+			cycle = minEarliestCycle;
+			numIssued = 0;
+			continue;
+		}
+
+		const uint32_t nodeID = pass->m_ReadyArr[bestReadyID];
+		jx_array_delswap(pass->m_ReadyArr, bestReadyID);
+		jmir_sched_nodeScheduled(pass, nodeID, cycle);
+
+		++numIssued;
+		if (numIssued == pass->m_IssueWidth) {
+			++cycle;
+			numIssued = 0;
+		}
+	}
+}
+
+// Critical path list scheduling which switches to the instruction with the smallest increase
+// in register pressure whenever a register class is close to running out of hw registers.
+static void jmir_sched_schedulePressure(jmir_func_pass_sched_t* pass, uint32_t numNodes)
+{
+	jx_array_resize(pass->m_ReadyArr, 0);
+	for (uint32_t iNode = 0; iNode < numNodes; ++iNode) {
+		if (pass->m_NodeArr[iNode].m_NumPreds == 0) {
+			jx_array_push_back(pass->m_ReadyArr, iNode);
+		}
+	}
+
+	while (jx_array_sizeu(pass->m_ReadyArr) != 0) {
+		bool highPressure[JMIR_REG_CLASS_COUNT];
+		bool anyHighPressure = false;
+		for (uint32_t iClass = 0; iClass < JMIR_REG_CLASS_COUNT; ++iClass) {
+			highPressure[iClass] = pass->m_Pressure[iClass] >= pass->m_PressureLimit[iClass];
+			anyHighPressure = anyHighPressure || highPressure[iClass];
+		}
+
+		const uint32_t numReady = (uint32_t)jx_array_sizeu(pass->m_ReadyArr);
+
+		uint32_t bestReadyID = JMIR_SCHED_INVALID_ID;
+		int32_t bestDelta = INT32_MAX;
+		for (uint32_t iReady = 0; iReady < numReady; ++iReady) {
+			const uint32_t nodeID = pass->m_ReadyArr[iReady];
+			const jmir_sched_node_t* node = &pass->m_NodeArr[nodeID];
+
+			int32_t delta = 0;
+			if (anyHighPressure) {
+				int32_t classDelta[JMIR_REG_CLASS_COUNT];
+				jmir_sched_updatePressure(pass, node->m_Instr, classDelta, false);
+				for (uint32_t iClass = 0; iClass < JMIR_REG_CLASS_COUNT; ++iClass) {
+					if (highPressure[iClass]) {
+						delta += classDelta[iClass];
+					}
+				}
+			}
+
+			if (bestReadyID == JMIR_SCHED_INVALID_ID) {
+				bestReadyID = iReady;
+				bestDelta = delta;
+			} else {
+				const uint32_t bestNodeID = pass->m_ReadyArr[bestReadyID];
+				const jmir_sched_node_t* bestNode = &pass->m_NodeArr[bestNodeID];
+				const bool isBetter = false
+					|| delta < bestDelta
+					|| (delta == bestDelta && node->m_Height > bestNode->m_Height)
+					|| (delta == bestDelta && node->m_Height == bestNode->m_Height && nodeID < bestNodeID)
+					;
+				if (isBetter) {
+					bestReadyID = iReady;
+					bestDelta = delta;
+				}
+			}
+		}
+
+		const uint32_t nodeID = pass->m_ReadyArr[bestReadyID];
+		jx_array_delswap(pass->m_ReadyArr, bestReadyID);
+
+		int32_t classDelta[JMIR_REG_CLASS_COUNT];
+		jmir_sched_updatePressure(pass, pass->m_NodeArr[nodeID].m_Instr, classDelta, true);
+		for (uint32_t iClass = 0; iClass < JMIR_REG_CLASS_COUNT; ++iClass) {
+			pass->m_Pressure[iClass] = (uint32_t)((int32_t)pass->m_Pressure[iClass] + classDelta[iClass]);
+		}
+
+		jmir_sched_nodeScheduled(pass, nodeID, 0);
+	}
+}
+
+static void jmir_sched_nodeScheduled(jmir_func_pass_sched_t* pass, uint32_t nodeID, uint32_t cycle)
+{
+	jx_array_push_back(pass->m_OrderArr, nodeID);
+
+	const jmir_sched_node_t* node = &pass->m_NodeArr[nodeID];
+	for (uint32_t iSucc = 0; iSucc < node->m_NumSuccs; ++iSucc) {
+		jmir_sched_node_t* succ = &pass->m_NodeArr[pass->m_SuccArr[node->m_FirstSucc + iSucc]];
+		succ->m_EarliestCycle = jx_max_u32(succ->m_EarliestCycle, cycle + pass->m_SuccLatencyArr[node->m_FirstSucc + iSucc]);
+
+		JX_CHECK(succ->m_NumPreds != 0, "Invalid predecessor count.");
+		succ->m_NumPreds--;
+		if (succ->m_NumPreds == 0) {
+			jx_array_push_back(pass->m_ReadyArr, pass->m_SuccArr[node->m_FirstSucc + iSucc]);
+		}
+	}
+}
+
+// Calculates the change in the number of live registers of each class if the instruction 
+// is scheduled next. If apply is true, the live set and the remaining use counts are updated.
+static void jmir_sched_updatePressure(jmir_func_pass_sched_t* pass, jx_mir_instruction_t* instr, int32_t* delta, bool apply)
+{
+	jx_mir_context_t* ctx = pass->m_Ctx;
+	jx_mir_function_t* func = pass->m_Func;
+	const jx_mir_instr_usedef_t* useDef = &instr->m_UseDef;
+
+	jx_memset(delta, 0, sizeof(int32_t) * JMIR_REG_CLASS_COUNT);
+
+	// Collect distinct registers
+	jx_mir_reg_t regs[JMIR_MAX_INSTR_USES + JMIR_MAX_INSTR_DEFS];
+	uint32_t numRegs = 0;
+	for (uint32_t iReg = 0; iReg < useDef->m_NumUses + useDef->m_NumDefs; ++iReg) {
+		const jx_mir_reg_t reg = iReg < useDef->m_NumUses
+			? useDef->m_Uses[iReg]
+			: useDef->m_Defs[iReg - useDef->m_NumUses]
+			;
+
+		bool found = false;
+		for (uint32_t j = 0; j < numRegs && !found; ++j) {
+			found = jx_mir_regEqual(regs[j], reg);
+		}
+
+		if (!found) {
+			regs[numRegs++] = reg;
+		}
+	}
+
+	for (uint32_t iReg = 0; iReg < numRegs; ++iReg) {
+		const jx_mir_reg_t reg = regs[iReg];
+		const uint32_t regID = jx_mir_funcMapRegToBitsetID(ctx, func, reg);
+
+		uint32_t numUses = 0;
+		for (uint32_t iUse = 0; iUse < useDef->m_NumUses; ++iUse) {
+			numUses += jx_mir_regEqual(useDef->m_Uses[iUse], reg) ? 1 : 0;
+		}
+
+		bool isDef = false;
+		for (uint32_t iDef = 0; iDef < useDef->m_NumDefs && !isDef; ++iDef) {
+			isDef = jx_mir_regEqual(useDef->m_Defs[iDef], reg);
+		}
+
+		JX_CHECK(pass->m_RegNumUses[regID] >= numUses, "Invalid use count.");
+		const uint32_t numUsesAfter = pass->m_RegNumUses[regID] - numUses;
+		const bool wasLive = jx_bitsetIsBitSet(pass->m_LiveSet, regID);
+		const bool usedLater = numUsesAfter != 0 || jx_bitsetIsBitSet(pass->m_LiveAfterSet, regID);
+		const bool isLive = isDef
+			? usedLater
+			: wasLive && usedLater
+			;
+		delta[reg.m_Class] += (int32_t)isLive - (int32_t)wasLive;
+
+		if (apply) {
+			pass->m_RegNumUses[regID] = numUsesAfter;
+			if (isLive) {
+				jx_bitsetSetBit(pass->m_LiveSet, regID);
+			} else {
+				jx_bitsetResetBit(pass->m_LiveSet, regID);
+			}
+		}
+	}
+}
+
+static bool jmir_sched_isBarrier(jmir_func_pass_sched_t* pass, jx_mir_instruction_t* instr)
+{
+	const uint32_t opcode = instr->m_OpCode;
+	const bool isBarrierOpcode = false
+		|| jx_mir_opcodeIsTerminator(opcode)
+		|| opcode == JMIR_OP_CALL
+		|| opcode == JMIR_OP_TAILCALL
+		|| opcode == JMIR_OP_PUSH
+		|| opcode == JMIR_OP_POP
+		|| opcode == JMIR_OP_INT3
+		;
+	if (isBarrierOpcode) {
+		return true;
+	}
+
+	if (pass->m_Mode == JMIR_SCHED_MODE_PRE_RA) {
+		const jx_mir_instr_usedef_t* useDef = &instr->m_UseDef;
+		for (uint32_t iUse = 0; iUse < useDef->m_NumUses; ++iUse) {
+			const jx_mir_reg_t reg = useDef->m_Uses[iUse];
+			if (jx_mir_regIsHW(reg) && !jx_mir_regEqual(reg, kMIRRegGP_SP)) {
+				return true;
+			}
+		}
+		for (uint32_t iDef = 0; iDef < useDef->m_NumDefs; ++iDef) {
+			if (jx_mir_regIsHW(useDef->m_Defs[iDef])) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// x86 instructions have at most one memory operand. Operands which are external 
+// symbols are RIP-relative memory references.
+static bool jmir_sched_getMemAccess(jx_mir_instruction_t* instr, jmir_sched_mem_access_t* access)
+{
+	const uint32_t opcode = instr->m_OpCode;
+	if (opcode == JMIR_OP_LEA) {
+		return false;
+	}
+
+	const bool isCompare = false
+		|| opcode == JMIR_OP_CMP
+		|| opcode == JMIR_OP_TEST
+		|| opcode == JMIR_OP_COMISS
+		|| opcode == JMIR_OP_COMISD
+		|| opcode == JMIR_OP_UCOMISS
+		|| opcode == JMIR_OP_UCOMISD
+		;
+
+	const uint32_t numOperands = instr->m_NumOperands;
+	for (uint32_t iOperand = 0; iOperand < numOperands; ++iOperand) {
+		jx_mir_operand_t* operand = instr->m_Operands[iOperand];
+		if (operand->m_Kind == JMIR_OPERAND_MEMORY_REF || operand->m_Kind == JMIR_OPERAND_EXTERNAL_SYMBOL) {
+			access->m_MemRef = operand->m_Kind == JMIR_OPERAND_MEMORY_REF
+				? operand->u.m_MemRef
+				: NULL
+				;
+			access->m_NodeID = JMIR_SCHED_INVALID_ID;
+			access->m_Size = jx_mir_typeGetSize(operand->m_Type);
+			access->m_IsStore = iOperand == 0 && !isCompare;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool jmir_sched_memMayAlias(const jmir_sched_mem_access_t* a, const jmir_sched_mem_access_t* b)
+{
+	const jx_mir_memory_ref_t* memRefA = a->m_MemRef;
+	const jx_mir_memory_ref_t* memRefB = b->m_MemRef;
+	const bool isStackA = memRefA && jx_mir_regEqual(memRefA->m_BaseReg, kMIRRegGP_SP) && !jx_mir_regIsValid(memRefA->m_IndexReg);
+	const bool isStackB = memRefB && jx_mir_regEqual(memRefB->m_BaseReg, kMIRRegGP_SP) && !jx_mir_regIsValid(memRefB->m_IndexReg);
+
+	if (!memRefA || !memRefB) {
+		// Globals never alias stack slots.
+		return !isStackA && !isStackB;
+	} else if (isStackA && isStackB) {
+		const int32_t endA = memRefA->m_Displacement + (int32_t)jx_max_u32(a->m_Size, 1);
+		const int32_t endB = memRefB->m_Displacement + (int32_t)jx_max_u32(b->m_Size, 1);
+		return memRefA->m_Displacement < endB && memRefB->m_Displacement < endA;
+	}
+
+	return true;
+}
+
+static bool jmir_sched_opcodeReadsFlags(uint32_t opcode)
+{
+	return false
+		|| (opcode >= JMIR_OP_SETCC_BASE && opcode < JMIR_OP_SETCC_BASE + JMIR_CC_COUNT)
+		|| (opcode >= JMIR_OP_JCC_BASE && opcode < JMIR_OP_JCC_BASE + JMIR_CC_COUNT)
+		|| (opcode >= JMIR_OP_CMOVCC_BASE && opcode < JMIR_OP_CMOVCC_BASE + JMIR_CC_COUNT)
+		;
+}
+
+// NOTE: Conservative; everything not known to leave the flags intact is assumed to clobber them.
+static bool jmir_sched_opcodeWritesFlags(uint32_t opcode)
+{
+	if (jmir_sched_opcodeReadsFlags(opcode)) {
+		return false;
+	}
+
+	switch (opcode) {
+	case JMIR_OP_RET:
+	case JMIR_OP_JMP:
+	case JMIR_OP_MOV:
+	case JMIR_OP_MOVSX:
+	case JMIR_OP_MOVZX:
+	case JMIR_OP_LEA:
+	case JMIR_OP_BSWAP:
+	case JMIR_OP_PUSH:
+	case JMIR_OP_POP:
+	case JMIR_OP_CDQ:
+	case JMIR_OP_CQO:
+	case JMIR_OP_MOVSS:
+	case JMIR_OP_MOVSD:
+	case JMIR_OP_MOVAPS:
+	case JMIR_OP_MOVAPD:
+	case JMIR_OP_MOVUPS:
+	case JMIR_OP_MOVUPD:
+	case JMIR_OP_MOVD:
+	case JMIR_OP_MOVQ:
+	case JMIR_OP_ADDPS:
+	case JMIR_OP_ADDSS:
+	case JMIR_OP_ADDPD:
+	case JMIR_OP_ADDSD:
+	case JMIR_OP_ANDNPS:
+	case JMIR_OP_ANDNPD:
+	case JMIR_OP_ANDPS:
+	case JMIR_OP_ANDPD:
+	case JMIR_OP_CVTSI2SS:
+	case JMIR_OP_CVTSI2SD:
+	case JMIR_OP_CVTSS2SI:
+	case JMIR_OP_CVTSD2SI:
+	case JMIR_OP_CVTTSS2SI:
+	case JMIR_OP_CVTTSD2SI:
+	case JMIR_OP_CVTSD2SS:
+	case JMIR_OP_CVTSS2SD:
+	case JMIR_OP_DIVPS:
+	case JMIR_OP_DIVSS:
+	case JMIR_OP_DIVPD:
+	case JMIR_OP_DIVSD:
+	case JMIR_OP_MAXPS:
+	case JMIR_OP_MAXSS:
+	case JMIR_OP_MAXPD:
+	case JMIR_OP_MAXSD:
+	case JMIR_OP_MINPS:
+	case JMIR_OP_MINSS:
+	case JMIR_OP_MINPD:
+	case JMIR_OP_MINSD:
+	case JMIR_OP_MULPS:
+	case JMIR_OP_MULSS:
+	case JMIR_OP_MULPD:
+	case JMIR_OP_MULSD:
+	case JMIR_OP_ORPS:
+	case JMIR_OP_ORPD:
+	case JMIR_OP_RCPPS:
+	case JMIR_OP_RCPSS:
+	case JMIR_OP_RSQRTPS:
+	case JMIR_OP_RSQRTSS:
+	case JMIR_OP_SHUFPS:
+	case JMIR_OP_SHUFPD:
+	case JMIR_OP_SQRTPS:
+	case JMIR_OP_SQRTSS:
+	case JMIR_OP_SQRTPD:
+	case JMIR_OP_SQRTSD:
+	case JMIR_OP_SUBPS:
+	case JMIR_OP_SUBSS:
+	case JMIR_OP_SUBPD:
+	case JMIR_OP_SUBSD:
+	case JMIR_OP_UNPCKHPS:
+	case JMIR_OP_UNPCKHPD:
+	case JMIR_OP_UNPCKLPS:
+	case JMIR_OP_UNPCKLPD:
+	case JMIR_OP_XORPS:
+	case JMIR_OP_XORPD:
+	case JMIR_OP_PUNPCKLBW:
+	case JMIR_OP_PUNPCKLWD:
+	case JMIR_OP_PUNPCKLDQ:
+	case JMIR_OP_PUNPCKLQDQ:
+	case JMIR_OP_PUNPCKHBW:
+	case JMIR_OP_PUNPCKHWD:
+	case JMIR_OP_PUNPCKHDQ:
+	case JMIR_OP_PUNPCKHQDQ:
+		return false;
+	default:
+		break;
+	}
+
+	return true;
+}
+
+// Approximate latencies (in cycles) of a generic modern x86 core. Instructions
+// with a memory source operand get an additional load-to-use latency.
+static uint32_t jmir_sched_getLatency(jx_mir_instruction_t* instr)
+{
+	uint32_t latency = 1;
+	switch (instr->m_OpCode) {
+	case JMIR_OP_IMUL:
+	case JMIR_OP_IMUL3:
+	case JMIR_OP_POPCNT:
+	case JMIR_OP_LZCNT:
+	case JMIR_OP_TZCNT:
+	case JMIR_OP_BSF:
+	case JMIR_OP_BSR:
+	case JMIR_OP_COMISS:
+	case JMIR_OP_COMISD:
+	case JMIR_OP_UCOMISS:
+	case JMIR_OP_UCOMISD:
+		latency = 3;
+		break;
+	case JMIR_OP_IMUL1:
+	case JMIR_OP_MUL:
+	case JMIR_OP_ADDPS:
+	case JMIR_OP_ADDSS:
+	case JMIR_OP_ADDPD:
+	case JMIR_OP_ADDSD:
+	case JMIR_OP_SUBPS:
+	case JMIR_OP_SUBSS:
+	case JMIR_OP_SUBPD:
+	case JMIR_OP_SUBSD:
+	case JMIR_OP_MULPS:
+	case JMIR_OP_MULSS:
+	case JMIR_OP_MULPD:
+	case JMIR_OP_MULSD:
+	case JMIR_OP_MINPS:
+	case JMIR_OP_MINSS:
+	case JMIR_OP_MINPD:
+	case JMIR_OP_MINSD:
+	case JMIR_OP_MAXPS:
+	case JMIR_OP_MAXSS:
+	case JMIR_OP_MAXPD:
+	case JMIR_OP_MAXSD:
+	case JMIR_OP_RCPPS:
+	case JMIR_OP_RCPSS:
+	case JMIR_OP_RSQRTPS:
+	case JMIR_OP_RSQRTSS:
+	case JMIR_OP_CVTSS2SI:
+	case JMIR_OP_CVTSD2SI:
+	case JMIR_OP_CVTTSS2SI:
+	case JMIR_OP_CVTTSD2SI:
+	case JMIR_OP_CVTSD2SS:
+	case JMIR_OP_CVTSS2SD:
+		latency = 4;
+		break;
+	case JMIR_OP_CVTSI2SS:
+	case JMIR_OP_CVTSI2SD:
+		latency = 5;
+		break;
+	case JMIR_OP_MOVD:
+	case JMIR_OP_MOVQ:
+		latency = 2;
+		break;
+	case JMIR_OP_DIVPS:
+	case JMIR_OP_DIVSS:
+		latency = 11;
+		break;
+	case JMIR_OP_SQRTPS:
+	case JMIR_OP_SQRTSS:
+		latency = 12;
+		break;
+	case JMIR_OP_DIVPD:
+	case JMIR_OP_DIVSD:
+		latency = 14;
+		break;
+	case JMIR_OP_SQRTPD:
+	case JMIR_OP_SQRTSD:
+		latency = 18;
+		break;
+	case JMIR_OP_IDIV:
+	case JMIR_OP_DIV:
+		latency = 26;
+		break;
+	default:
+		break;
+	}
+
+	jmir_sched_mem_access_t access;
+	if (jmir_sched_getMemAccess(instr, &access)) {
+		const bool isPureStore = true
+			&& access.m_IsStore
+			&& instr->m_NumOperands == 2
+			&& instr->m_Operands[1]->m_Kind != JMIR_OPERAND_MEMORY_REF
+			&& (instr->m_OpCode == JMIR_OP_MOV || (instr->m_OpCode >= JMIR_OP_MOVSS && instr->m_OpCode <= JMIR_OP_MOVQ))
+			;
+		if (!isPureStore) {
+			latency += JMIR_SCHED_LOAD_LATENCY;
+		}
+	}
+
+	return latency;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Common helpers
 //
@@ -18,6 +18,10 @@ bool jx_mir_funcPassCreate_instrCombine(jx_mir_function_pass_t* pass, jx_allocat
 bool jx_mir_funcPassCreate_deadCodeElimination(jx_mir_function_pass_t* pass, jx_allocator_i* allocator);
 bool jx_mir_funcPassCreate_redundantConstElimination(jx_mir_function_pass_t* pass, jx_allocator_i* allocator);
 bool jx_mir_funcPassCreate_simplifyCFG(jx_mir_function_pass_t* pass, jx_allocator_i* allocator);
+bool jx_mir_funcPassCreate_slpVectorizer(jx_mir_function_pass_t* pass, jx_allocator_i* allocator);
+bool jx_mir_funcPassCreate_stackSlotColoring(jx_mir_function_pass_t* pass, jx_allocator_i* allocator);
+bool jx_mir_funcPassCreate_preRAScheduler(jx_mir_function_pass_t* pass, jx_allocator_i* allocator);
+bool jx_mir_funcPassCreate_postRAScheduler(jx_mir_function_pass_t* pass, jx_allocator_i* allocator);
 
 #if 0 // Not needed
 bool jx_mir_funcPassCreate_fixMemMemOps(jx_mir_function_pass_t* pass, jx_allocator_i* allocator);
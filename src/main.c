@@ -1,5 +1,6 @@
 #include "jcc.h"
 #include "jit.h"
+#include "jit_disasm.h"
 #include "jit_gen.h"
 #include "jir.h"
 #include "jir_gen.h"
@@ -16,6 +17,7 @@
 #include <jlib/math.h>
 #include <jlib/memory.h>
 #include <jlib/os.h>
+#include <jlib/sort.h>
 #include <jlib/string.h>
 #include <tracy/tracy/TracyC.h>
 
@@ -25,9 +27,98 @@ typedef struct sym_addr_item_t
 	void* m_Addr;
 } sym_addr_item_t;
 
+// userData of isFuncCachedCallback()
+typedef struct func_cache_t
+{
+	jx_x64_code_cache_t* m_CodeCache;
+	jx_mir_context_t* m_MIRCtx;
+} func_cache_t;
+
+typedef struct bench_ref_compiler_t
+{
+	const char* m_Name;
+	const char* m_Command;
+	const char* m_Flags;
+} bench_ref_compiler_t;
+
+typedef struct bench_result_t
+{
+	double m_MedianTime_us;
+	double m_MinTime_us;
+	uint32_t m_CodeSize;
+	int32_t m_ReturnValue;
+	bool m_Valid;
+	JX_PAD(7);
+} bench_result_t;
+
+typedef int32_t(*pfnBenchMain)(void);
+
+#define CTBENCH_MAX_STAGES 64
+#define CTBENCH_MAX_DEPTH  8
+
+typedef struct ctbench_stage_t
+{
+	const char* m_Group;
+	const char* m_Name;
+	int64_t m_Time;      // Including nested stages
+	int64_t m_SelfTime;
+	uint64_t m_NumCalls;
+	uint64_t m_NumAllocs;
+	uint64_t m_PeakBytes; // Max memory allocated on top of what was live when the stage started
+} ctbench_stage_t;
+
+typedef struct ctbench_frame_t
+{
+	ctbench_stage_t* m_Stage;
+	int64_t m_StartTime;
+	int64_t m_ChildTime;
+	uint64_t m_StartNumAllocs;
+	uint64_t m_StartBytes;
+	uint64_t m_PeakBytes;
+} ctbench_frame_t;
+
+// Tracks the allocations and the time spent in each compilation stage. m_Allocator forwards
+// all requests to m_ParentAllocator and is passed to all compiler contexts.
+typedef struct ctbench_context_t
+{
+	jx_allocator_i m_Allocator;
+	jx_allocator_i* m_ParentAllocator;
+	uint64_t m_NumAllocs;
+	uint64_t m_CurBytes;
+	uint64_t m_PeakBytes;
+	ctbench_stage_t m_Stages[CTBENCH_MAX_STAGES];
+	ctbench_frame_t m_Stack[CTBENCH_MAX_DEPTH];
+	uint32_t m_NumStages;
+	uint32_t m_StackSize;
+} ctbench_context_t;
+
 static void runCTestSuiteTests(jx_allocator_i* allocator);
+static bool ctestCompileAndRun(jx_allocator_i* allocator, jx_x64_code_heap_t* codeHeap, const char* sourceFile, jx_ir_opt_level irOptLevel, jx_mir_opt_level mirOptLevel);
 static void runSingleFileCompile(jx_allocator_i* allocator);
 static void runSQLite3Demo(jx_allocator_i* allocator);
+static void runIncrementalCompileDemo(jx_allocator_i* allocator);
+static bool runDisasmSelfCheck(jx_allocator_i* allocator);
+static void runBenchmarks(jx_allocator_i* allocator);
+static bool benchJITKernel(jx_allocator_i* allocator, const char* sourceFile, bench_result_t* res);
+static bool benchRefKernel(jx_allocator_i* allocator, const bench_ref_compiler_t* compiler, const char* kernelName, bench_result_t* res);
+static void benchMeasure(pfnBenchMain mainFunc, bench_result_t* res);
+static uint32_t benchGetCOFFCodeSize(jx_allocator_i* allocator, jx_file_base_dir baseDir, const char* relPath);
+static void benchReportResult(jx_string_buffer_t* report, const char* compilerName, const bench_result_t* res, bool isLast);
+static int32_t benchCompareTimes(const void* a, const void* b, void* userData);
+static int benchPrintfStub(const char* fmt, ...);
+static void* getBenchExternalSymbolCallback(const char* symName, void* userData);
+static void runCompileTimeBenchmark(jx_allocator_i* allocator);
+static bool ctbenchCompileFile(ctbench_context_t* ctx, const char* sourceFile);
+static void ctbenchReset(ctbench_context_t* ctx);
+static void ctbenchStageBegin(ctbench_context_t* ctx, const char* group, const char* name);
+static void ctbenchStageEnd(ctbench_context_t* ctx);
+static void ctbenchReportSuite(ctbench_context_t* ctx, jx_string_buffer_t* report, const char* suiteName, uint32_t numFiles, uint32_t numFailed, int64_t totalTime, bool isLast);
+static void* ctbenchRealloc(jx_allocator_o* inst, void* ptr, uint64_t sz, uint64_t align, const char* file, uint32_t line);
+static void ctbenchFrontendStageCallback(const char* stageName, bool isEnd, void* userData);
+static void ctbenchIRPassCallback(const char* passName, bool isEnd, void* userData);
+static void ctbenchMIRPassCallback(const char* passName, bool isEnd, void* userData);
+static void* ctbenchExternalSymbolCallback(const char* symName, void* userData);
+static bool isFuncCachedCallback(const char* funcName, uint64_t fingerprint, void* userData);
 static void* getExternalSymbolCallback(const char* symName, void* userData);
 static bool redirectSystemLogger(void);
 static bool loadModuleDef(jx_hashmap_t* symMap, jx_file_base_dir baseDir, const char* defFilename, jx_allocator_i* allocator);
@@ -50,6 +141,14 @@ int main(int argc, char** argv)
 	runSingleFileCompile(allocator);
 #elif 1
 	runSQLite3Demo(allocator);
+#elif 0
+	runIncrementalCompileDemo(allocator);
+#elif 0
+	runDisasmSelfCheck(allocator);
+#elif 0
+	runBenchmarks(allocator);
+#elif 0
+	runCompileTimeBenchmark(allocator);
 #endif
 
 	allocator_api->destroyAllocator(allocator);
@@ -65,6 +164,19 @@ static void runCTestSuiteTests(jx_allocator_i* allocator)
 	uint32_t numSkipped = 0;
 	uint32_t numPass = 0;
 	uint32_t numFailed = 0;
+
+	// NOTE: The encoder/disassembler round-trip counts as a test so that encoder regressions
+	// fail the run.
+	++totalTests;
+	if (runDisasmSelfCheck(allocator)) {
+		++numPass;
+	} else {
+		++numFailed;
+	}
+
+	// NOTE: All tests share the same code heap. The memory of each test is reused by the next one.
+	jx_x64_code_heap_t* codeHeap = jx64_codeHeapCreate(allocator, 16u << 20, 4u << 20, 4u << 20, 0);
+
 	for (uint32_t iTest = 1; iTest <= 220; ++iTest) {
 		++totalTests;
 
@@ -94,70 +206,111 @@ static void runCTestSuiteTests(jx_allocator_i* allocator)
 			continue;
 		}
 
-		jx_cc_context_t* ctx = jx_cc_createContext(allocator, logger_api->m_SystemLogger);
-		jx_cc_addIncludePath(ctx, JX_FILE_BASE_DIR_INSTALL, "include");
+		if (ctestCompileAndRun(allocator, codeHeap, sourceFile, JIR_OPT_LEVEL_O2, JMIR_OPT_LEVEL_O2)) {
+			++numPass;
+		} else {
+			++numFailed;
+		}
+	}
 
-		jx_cc_translation_unit_t* tu = jx_cc_compileFile(ctx, JX_FILE_BASE_DIR_INSTALL, sourceFile);
-		if (tu && tu->m_NumErrors == 0) {
-			jx_ir_context_t* irCtx = jx_ir_createContext(allocator);
-			jx_irgen_context_t* genCtx = jx_irgen_createContext(irCtx, allocator);
+	// NOTE: Builtins are only lowered by the bitIdioms IR pass so make sure they also compile
+	// without optimizations.
+	{
+		++totalTests;
 
-			jx_irgen_moduleGen(genCtx, sourceFile, tu);
+		const char* sourceFile = "test/bit_intrinsics.c";
+		JX_SYS_LOG_INFO(NULL, "%s (O0): ", sourceFile);
+		if (ctestCompileAndRun(allocator, codeHeap, sourceFile, JIR_OPT_LEVEL_O0, JMIR_OPT_LEVEL_O0)) {
+			++numPass;
+		} else {
+			++numFailed;
+		}
+	}
 
-			jx_irgen_destroyContext(genCtx);
+	JX_SYS_LOG_INFO(NULL, "Total: %u\n", totalTests);
+	JX_SYS_LOG_INFO(NULL, "Pass : %u\n", numPass);
+	JX_SYS_LOG_INFO(NULL, "Fail : %u\n", numFailed);
+	JX_SYS_LOG_INFO(NULL, "Skip : %u\n", numSkipped);
 
-			jx_mir_context_t* mirCtx = jx_mir_createContext(allocator);
-			jx_mirgen_context_t* mirGenCtx = jx_mirgen_createContext(irCtx, mirCtx, allocator);
+	if (codeHeap) {
+		jx_x64_code_heap_stats_t stats;
+		jx64_codeHeapGetStats(codeHeap, &stats);
 
-			jx_ir_module_t* irMod = jx_ir_getModule(irCtx, 0);
-			if (irMod) {
-				jx_mirgen_moduleGen(mirGenCtx, irMod);
-			}
+		const jx_x64_code_heap_section_stats_t* textStats = &stats.m_Section[JX64_SECTION_TEXT];
+		JX_SYS_LOG_INFO(NULL, "Code heap: %s pages, %u KB high water mark, %u failed allocations\n"
+			, stats.m_LargePages ? "large" : "normal"
+			, (uint32_t)((textStats->m_HotSize + textStats->m_ColdSize) >> 10)
+			, (uint32_t)textStats->m_NumFailedAllocs
+		);
 
-			jx_mirgen_destroyContext(mirGenCtx);
+		jx64_codeHeapDestroy(codeHeap);
+	}
+}
 
-			jx_x64_context_t* jitCtx = jx_x64_createContext(allocator);
-			jx_x64gen_context_t* jitgenCtx = jx_x64gen_createContext(jitCtx, mirCtx, getExternalSymbolCallback, NULL, allocator);
+static bool ctestCompileAndRun(jx_allocator_i* allocator, jx_x64_code_heap_t* codeHeap, const char* sourceFile, jx_ir_opt_level irOptLevel, jx_mir_opt_level mirOptLevel)
+{
+	bool passed = false;
 
-			if (jx_x64gen_codeGen(jitgenCtx)) {
-				uint32_t execBufSize = 0;
-				const uint8_t* execBuf = jx64_getBuffer(jitCtx, &execBufSize);
+	jx_cc_context_t* ctx = jx_cc_createContext(allocator, logger_api->m_SystemLogger);
+	jx_cc_addIncludePath(ctx, JX_FILE_BASE_DIR_INSTALL, "include");
 
-				typedef int32_t(*pfnMain)(void);
-				jx_x64_symbol_t* symMain = jx64_symbolGetByName(jitCtx, "main");
-				if (symMain) {
-					pfnMain mainFunc = (pfnMain)((uint8_t*)execBuf + jx64_labelGetOffset(jitCtx, symMain->m_Label));
-					int32_t ret = mainFunc();
-					if (ret == 0) {
-						++numPass;
-						JX_SYS_LOG_DEBUG(NULL, "PASS\n", sourceFile);
-					} else {
-						++numFailed;
-						JX_SYS_LOG_ERROR(NULL, "FAIL\n", sourceFile);
-					}
+	jx_cc_translation_unit_t* tu = jx_cc_compileFile(ctx, JX_FILE_BASE_DIR_INSTALL, sourceFile);
+	if (tu && tu->m_NumErrors == 0) {
+		jx_ir_context_t* irCtx = jx_ir_createContext(allocator);
+		jx_ir_setOptLevel(irCtx, irOptLevel);
+		jx_irgen_context_t* genCtx = jx_irgen_createContext(irCtx, allocator);
+
+		jx_irgen_moduleGen(genCtx, sourceFile, tu);
+
+		jx_irgen_destroyContext(genCtx);
+
+		jx_mir_context_t* mirCtx = jx_mir_createContext(allocator);
+		jx_mir_setOptLevel(mirCtx, mirOptLevel);
+		jx_mirgen_context_t* mirGenCtx = jx_mirgen_createContext(irCtx, mirCtx, allocator);
+
+		jx_ir_module_t* irMod = jx_ir_getModule(irCtx, 0);
+		if (irMod) {
+			jx_mirgen_moduleGen(mirGenCtx, irMod);
+		}
+
+		jx_mirgen_destroyContext(mirGenCtx);
+
+		jx_x64_context_t* jitCtx = jx_x64_createContext(allocator);
+		jx64_setCodeHeap(jitCtx, codeHeap);
+		jx_x64gen_context_t* jitgenCtx = jx_x64gen_createContext(jitCtx, mirCtx, getExternalSymbolCallback, NULL, allocator);
+
+		if (jx_x64gen_codeGen(jitgenCtx)) {
+			uint32_t execBufSize = 0;
+			const uint8_t* execBuf = jx64_getBuffer(jitCtx, &execBufSize);
+
+			typedef int32_t(*pfnMain)(void);
+			jx_x64_symbol_t* symMain = jx64_symbolGetByName(jitCtx, "main");
+			if (symMain) {
+				pfnMain mainFunc = (pfnMain)((uint8_t*)execBuf + jx64_labelGetOffset(jitCtx, symMain->m_Label));
+				int32_t ret = mainFunc();
+				if (ret == 0) {
+					passed = true;
+					JX_SYS_LOG_DEBUG(NULL, "PASS\n", sourceFile);
 				} else {
-					JX_SYS_LOG_ERROR(NULL, "main() not found!\n", sourceFile);
+					JX_SYS_LOG_ERROR(NULL, "FAIL\n", sourceFile);
 				}
 			} else {
-				++numFailed;
-				JX_SYS_LOG_ERROR(NULL, "Codegen failed. Unresolved external symbol?\n");
+				JX_SYS_LOG_ERROR(NULL, "main() not found!\n", sourceFile);
 			}
-
-			jx_x64gen_destroyContext(jitgenCtx);
-			jx_x64_destroyContext(jitCtx);
-			jx_mir_destroyContext(mirCtx);
-			jx_ir_destroyContext(irCtx);
 		} else {
-			++numFailed;
-			JX_SYS_LOG_ERROR(NULL, "Compilation failed.\n", sourceFile);
+			JX_SYS_LOG_ERROR(NULL, "Codegen failed. Unresolved external symbol?\n");
 		}
-		jx_cc_destroyContext(ctx);
+
+		jx_x64gen_destroyContext(jitgenCtx);
+		jx_x64_destroyContext(jitCtx);
+		jx_mir_destroyContext(mirCtx);
+		jx_ir_destroyContext(irCtx);
+	} else {
+		JX_SYS_LOG_ERROR(NULL, "Compilation failed.\n", sourceFile);
 	}
+	jx_cc_destroyContext(ctx);
 
-	JX_SYS_LOG_INFO(NULL, "Total: %u\n", totalTests);
-	JX_SYS_LOG_INFO(NULL, "Pass : %u\n", numPass);
-	JX_SYS_LOG_INFO(NULL, "Fail : %u\n", numFailed);
-	JX_SYS_LOG_INFO(NULL, "Skip : %u\n", numSkipped);
+	return passed;
 }
 
 static void runSingleFileCompile(jx_allocator_i* allocator)
@@ -233,8 +386,37 @@ static void runSingleFileCompile(jx_allocator_i* allocator)
 				TracyCZoneN(x64gen, "x64 Gen", 1);
 				jx_x64_context_t* jitCtx = jx_x64_createContext(allocator);
 				jx_x64gen_context_t* jitgenCtx = jx_x64gen_createContext(jitCtx, mirCtx, getExternalSymbolCallback, NULL, allocator);
-				if (jx_x64gen_codeGen(jitgenCtx)) {
+				bool codeGenRes = jx_x64gen_emitCode(jitgenCtx);
+#if 0
+				if (codeGenRes) {
+					// NOTE: The object file should be linked against code which uses the Win64 calling convention
+					// (e.g. functions declared with __attribute__((ms_abi)) on Linux).
+					uint32_t objSize = 0;
+					uint8_t* obj = jx64_emitELFObject(jitCtx, allocator, &objSize);
+					if (obj) {
+						jx_os_file_t* objFile = jx_os_fileOpenWrite(JX_FILE_BASE_DIR_USERDATA, "output.o");
+						if (objFile) {
+							jx_os_fileWrite(objFile, obj, objSize);
+							jx_os_fileClose(objFile);
+						} else {
+							JX_SYS_LOG_ERROR(NULL, "Failed to open output.o for writing.\n");
+						}
+						JX_FREE(allocator, obj);
+					}
+				}
+#endif
+				codeGenRes = codeGenRes && jx64_finalize(jitCtx, getExternalSymbolCallback, NULL);
+				if (codeGenRes) {
 					TracyCZoneEnd(x64gen);
+
+#if 0
+					sb = jx_strbuf_create(allocator);
+					jx64_print(jitCtx, sb);
+					jx_strbuf_nullTerminate(sb);
+					JX_SYS_LOG_INFO(NULL, "%s", jx_strbuf_getString(sb, NULL));
+					jx_strbuf_destroy(sb);
+#endif
+
 					uint32_t bufferSize = 0;
 					const uint8_t* buffer = jx64_getBuffer(jitCtx, &bufferSize);
 
@@ -405,6 +587,796 @@ end:
 #include <time.h>
 #include <Windows.h>
 
+// Compiles the same file twice, sharing a code cache between the two compilations. The second
+// compilation reuses the machine code of all functions which haven't changed in between.
+static void runIncrementalCompileDemo(jx_allocator_i* allocator)
+{
+	const char* sourceFile = "test/stb_truetype_test.c";
+
+	jx_x64_code_cache_t* codeCache = jx64_codeCacheCreate(allocator);
+	if (!codeCache) {
+		return;
+	}
+
+	for (uint32_t iPass = 0; iPass < 2; ++iPass) {
+		const int64_t tStart = jx_os_timeNow();
+
+		jx_cc_context_t* ctx = jx_cc_createContext(allocator, logger_api->m_SystemLogger);
+		jx_cc_addIncludePath(ctx, JX_FILE_BASE_DIR_INSTALL, "include");
+		jx_cc_addIncludePath(ctx, JX_FILE_BASE_DIR_INSTALL, "include/winapi");
+
+		jx_cc_translation_unit_t* tu = jx_cc_compileFile(ctx, JX_FILE_BASE_DIR_INSTALL, sourceFile);
+		if (!tu || tu->m_NumErrors != 0) {
+			JX_SYS_LOG_INFO(NULL, "Failed to compile \"%s\"\n", sourceFile);
+			jx_cc_destroyContext(ctx);
+			break;
+		}
+
+		// NOTE: The fingerprints of cached functions include the IR and MIR pipelines so both
+		// contexts must be configured before checking the cache.
+		jx_ir_context_t* irCtx = jx_ir_createContext(allocator);
+		jx_mir_context_t* mirCtx = jx_mir_createContext(allocator);
+
+		uint32_t numFuncs = 0;
+		uint32_t numCachedFuncs = 0;
+		for (jx_cc_object_t* global = tu->m_Globals; global; global = global->m_Next) {
+			const bool isLiveDefinition = true
+				&& (global->m_Flags & JCC_OBJECT_FLAGS_IS_FUNCTION_Msk) != 0
+				&& (global->m_Flags & JCC_OBJECT_FLAGS_IS_DEFINITION_Msk) != 0
+				&& (global->m_Flags & JCC_OBJECT_FLAGS_IS_LIVE_Msk) != 0
+				;
+			if (isLiveDefinition) {
+				++numFuncs;
+				const uint64_t irFingerprint = jx_ir_funcGetFingerprint(irCtx, global->m_Name, global->m_Fingerprint);
+				const uint64_t fingerprint = jx_mir_funcGetFingerprint(mirCtx, global->m_Name, irFingerprint);
+				numCachedFuncs += jx64_codeCacheContains(codeCache, global->m_Name, fingerprint) ? 1 : 0;
+			}
+		}
+
+		func_cache_t funcCache = {
+			.m_CodeCache = codeCache,
+			.m_MIRCtx = mirCtx,
+		};
+
+		jx_irgen_context_t* genCtx = jx_irgen_createContext(irCtx, allocator);
+		jx_irgen_setFuncCacheCallback(genCtx, isFuncCachedCallback, &funcCache);
+		const bool irGenerated = jx_irgen_moduleGen(genCtx, sourceFile, tu);
+		jx_irgen_destroyContext(genCtx);
+
+		if (irGenerated) {
+			jx_mirgen_context_t* mirGenCtx = jx_mirgen_createContext(irCtx, mirCtx, allocator);
+			jx_ir_module_t* irMod = jx_ir_getModule(irCtx, 0);
+			if (irMod) {
+				jx_mirgen_moduleGen(mirGenCtx, irMod);
+			}
+			jx_mirgen_destroyContext(mirGenCtx);
+
+			jx_x64_context_t* jitCtx = jx_x64_createContext(allocator);
+			jx64_setCodeCache(jitCtx, codeCache);
+			jx_x64gen_context_t* jitgenCtx = jx_x64gen_createContext(jitCtx, mirCtx, getExternalSymbolCallback, NULL, allocator);
+			if (jx_x64gen_codeGen(jitgenCtx)) {
+				const int64_t tEnd = jx_os_timeNow();
+				JX_SYS_LOG_INFO(NULL, "Pass %u: %u/%u functions reused, %.3f ms\n", iPass, numCachedFuncs, numFuncs, jx_os_timeConvertTo(tEnd - tStart, JX_TIME_UNITS_MS));
+			} else {
+				JX_SYS_LOG_ERROR(NULL, "Codegen failed. Unresolved external symbol?\n");
+			}
+
+			jx_x64gen_destroyContext(jitgenCtx);
+			jx_x64_destroyContext(jitCtx);
+		} else {
+			JX_SYS_LOG_ERROR(NULL, "Failed to generate module IR\n");
+		}
+
+		jx_mir_destroyContext(mirCtx);
+		jx_ir_destroyContext(irCtx);
+		jx_cc_destroyContext(ctx);
+	}
+
+	jx64_codeCacheDestroy(codeCache);
+}
+
+// Round-trips every instruction form the x64 encoder supports through the disassembler.
+static bool runDisasmSelfCheck(jx_allocator_i* allocator)
+{
+	jx_string_buffer_t* sb = jx_strbuf_create(allocator);
+	const bool passed = jx64_disasmSelfCheck(allocator, sb);
+	jx_strbuf_nullTerminate(sb);
+	if (passed) {
+		JX_SYS_LOG_INFO(NULL, "%s", jx_strbuf_getString(sb, NULL));
+	} else {
+		JX_SYS_LOG_ERROR(NULL, "%s", jx_strbuf_getString(sb, NULL));
+	}
+	jx_strbuf_destroy(sb);
+
+	return passed;
+}
+
+#define BENCH_NUM_WARMUP_RUNS  10
+#define BENCH_NUM_SAMPLES      31
+#define BENCH_RUNS_PER_SAMPLE  10
+
+// JIT-compiles the test kernels and times their main() against the same sources built with the
+// host compilers. Reference builds are loaded as DLLs so both are timed in-process the same way.
+// Results are written to bench/results.json (user data dir).
+static void runBenchmarks(jx_allocator_i* allocator)
+{
+	static const char* kKernels[] = {
+		"sieve",
+		"compute",
+		"nested_loops",
+		"factorial",
+		"math",
+		"floats",
+		"aliasing",
+		"basic_block_placement",
+	};
+
+	// NOTE: printf is redirected to a stub in order to measure the kernel and not the console.
+	// main is explicitly exported because clang (MSVC target) doesn't export anything by default.
+	static const bench_ref_compiler_t kRefCompilers[] = {
+		{ .m_Name = "gcc -O0",   .m_Command = "gcc",   .m_Flags = "-O0" },
+		{ .m_Name = "gcc -O2",   .m_Command = "gcc",   .m_Flags = "-O2" },
+		{ .m_Name = "clang -O0", .m_Command = "clang", .m_Flags = "-O0" },
+		{ .m_Name = "clang -O2", .m_Command = "clang", .m_Flags = "-O2" },
+	};
+
+	jx_os_fsCreateDirectory(JX_FILE_BASE_DIR_USERDATA, "bench");
+
+	{
+		static const char kPrintfStub[] = "int jx_bench_printf(const char* fmt, ...) { (void)fmt; return 0; }\n";
+		jx_os_file_t* stubFile = jx_os_fileOpenWrite(JX_FILE_BASE_DIR_USERDATA, "bench/printf_stub.c");
+		if (!stubFile) {
+			JX_SYS_LOG_ERROR(NULL, "Failed to create printf stub\n");
+			return;
+		}
+		jx_os_fileWrite(stubFile, kPrintfStub, (uint32_t)jx_strlen(kPrintfStub));
+		jx_os_fileClose(stubFile);
+	}
+
+	jx_string_buffer_t* report = jx_strbuf_create(allocator);
+	jx_strbuf_printf(report, "{\n");
+	jx_strbuf_printf(report, "\t\"warmupRuns\": %u,\n", BENCH_NUM_WARMUP_RUNS);
+	jx_strbuf_printf(report, "\t\"samples\": %u,\n", BENCH_NUM_SAMPLES);
+	jx_strbuf_printf(report, "\t\"runsPerSample\": %u,\n", BENCH_RUNS_PER_SAMPLE);
+	jx_strbuf_printf(report, "\t\"kernels\": [\n");
+
+	const uint32_t numKernels = JX_COUNTOF(kKernels);
+	for (uint32_t iKernel = 0; iKernel < numKernels; ++iKernel) {
+		const char* kernelName = kKernels[iKernel];
+
+		char sourceFile[256];
+		jx_snprintf(sourceFile, JX_COUNTOF(sourceFile), "test/%s.c", kernelName);
+
+		jx_strbuf_printf(report, "\t\t{\n");
+		jx_strbuf_printf(report, "\t\t\t\"name\": \"%s\",\n", kernelName);
+		jx_strbuf_printf(report, "\t\t\t\"results\": [\n");
+
+		bench_result_t jitRes;
+		benchJITKernel(allocator, sourceFile, &jitRes);
+		benchReportResult(report, "jitcc", &jitRes, false);
+
+		JX_SYS_LOG_INFO(NULL, "%-24s %-10s median %10.3f us, min %10.3f us, %6u bytes\n", kernelName, "jitcc", jitRes.m_MedianTime_us, jitRes.m_MinTime_us, jitRes.m_CodeSize);
+
+		const uint32_t numRefCompilers = JX_COUNTOF(kRefCompilers);
+		for (uint32_t iCompiler = 0; iCompiler < numRefCompilers; ++iCompiler) {
+			const bench_ref_compiler_t* compiler = &kRefCompilers[iCompiler];
+
+			bench_result_t refRes;
+			benchRefKernel(allocator, compiler, kernelName, &refRes);
+			benchReportResult(report, compiler->m_Name, &refRes, iCompiler == numRefCompilers - 1);
+
+			if (refRes.m_Valid) {
+				JX_SYS_LOG_INFO(NULL, "%-24s %-10s median %10.3f us, min %10.3f us, %6u bytes (%.2fx)\n", kernelName, compiler->m_Name, refRes.m_MedianTime_us, refRes.m_MinTime_us, refRes.m_CodeSize, jitRes.m_Valid && refRes.m_MedianTime_us > 0.0 ? jitRes.m_MedianTime_us / refRes.m_MedianTime_us : 0.0);
+			} else {
+				JX_SYS_LOG_WARNING(NULL, "%-24s %-10s FAILED\n", kernelName, compiler->m_Name);
+			}
+		}
+
+		jx_strbuf_printf(report, "\t\t\t]\n");
+		jx_strbuf_printf(report, "\t\t}%s\n", iKernel == numKernels - 1 ? "" : ",");
+	}
+
+	jx_strbuf_printf(report, "\t]\n");
+	jx_strbuf_printf(report, "}\n");
+
+	uint32_t reportLen = 0;
+	const char* reportStr = jx_strbuf_getString(report, &reportLen);
+	jx_os_file_t* reportFile = jx_os_fileOpenWrite(JX_FILE_BASE_DIR_USERDATA, "bench/results.json");
+	if (reportFile) {
+		jx_os_fileWrite(reportFile, reportStr, reportLen);
+		jx_os_fileClose(reportFile);
+	} else {
+		JX_SYS_LOG_ERROR(NULL, "Failed to write benchmark results\n");
+	}
+
+	jx_strbuf_destroy(report);
+}
+
+static bool benchJITKernel(jx_allocator_i* allocator, const char* sourceFile, bench_result_t* res)
+{
+	jx_memset(res, 0, sizeof(bench_result_t));
+
+	jx_cc_context_t* ctx = jx_cc_createContext(allocator, logger_api->m_SystemLogger);
+	jx_cc_addIncludePath(ctx, JX_FILE_BASE_DIR_INSTALL, "include");
+
+	jx_cc_translation_unit_t* tu = jx_cc_compileFile(ctx, JX_FILE_BASE_DIR_INSTALL, sourceFile);
+	if (!tu || tu->m_NumErrors != 0) {
+		JX_SYS_LOG_ERROR(NULL, "Failed to compile \"%s\"\n", sourceFile);
+		jx_cc_destroyContext(ctx);
+		return false;
+	}
+
+	jx_ir_context_t* irCtx = jx_ir_createContext(allocator);
+	jx_irgen_context_t* genCtx = jx_irgen_createContext(irCtx, allocator);
+	const bool irGenerated = jx_irgen_moduleGen(genCtx, sourceFile, tu);
+	jx_irgen_destroyContext(genCtx);
+
+	if (irGenerated) {
+		jx_mir_context_t* mirCtx = jx_mir_createContext(allocator);
+		jx_mirgen_context_t* mirGenCtx = jx_mirgen_createContext(irCtx, mirCtx, allocator);
+		jx_ir_module_t* irMod = jx_ir_getModule(irCtx, 0);
+		if (irMod) {
+			jx_mirgen_moduleGen(mirGenCtx, irMod);
+		}
+		jx_mirgen_destroyContext(mirGenCtx);
+
+		jx_x64_context_t* jitCtx = jx_x64_createContext(allocator);
+		jx_x64gen_context_t* jitgenCtx = jx_x64gen_createContext(jitCtx, mirCtx, getBenchExternalSymbolCallback, NULL, allocator);
+
+		// NOTE: The size of the code is measured before finalization in order to exclude import stubs.
+		bool codeGenRes = jx_x64gen_emitCode(jitgenCtx);
+		if (codeGenRes) {
+			res->m_CodeSize = jx64_sectionGetSize(jitCtx, JX64_SECTION_TEXT);
+		}
+		codeGenRes = codeGenRes && jx64_finalize(jitCtx, getBenchExternalSymbolCallback, NULL);
+
+		if (codeGenRes) {
+			uint32_t bufferSize = 0;
+			const uint8_t* buffer = jx64_getBuffer(jitCtx, &bufferSize);
+
+			jx_x64_symbol_t* symMain = jx64_symbolGetByName(jitCtx, "main");
+			if (symMain) {
+				pfnBenchMain mainFunc = (pfnBenchMain)((uint8_t*)buffer + jx64_labelGetOffset(jitCtx, symMain->m_Label));
+				benchMeasure(mainFunc, res);
+			} else {
+				JX_SYS_LOG_ERROR(NULL, "main() not found!\n");
+			}
+		} else {
+			JX_SYS_LOG_ERROR(NULL, "Codegen failed. Unresolved external symbol?\n");
+		}
+
+		jx_x64gen_destroyContext(jitgenCtx);
+		jx_x64_destroyContext(jitCtx);
+		jx_mir_destroyContext(mirCtx);
+	} else {
+		JX_SYS_LOG_ERROR(NULL, "Failed to generate module IR\n");
+	}
+
+	jx_ir_destroyContext(irCtx);
+	jx_cc_destroyContext(ctx);
+
+	return res->m_Valid;
+}
+
+static bool benchRefKernel(jx_allocator_i* allocator, const bench_ref_compiler_t* compiler, const char* kernelName, bench_result_t* res)
+{
+	jx_memset(res, 0, sizeof(bench_result_t));
+
+	char installDir[512];
+	char userDataDir[512];
+	jx_os_fsGetBaseDir(JX_FILE_BASE_DIR_INSTALL, installDir, JX_COUNTOF(installDir));
+	jx_os_fsGetBaseDir(JX_FILE_BASE_DIR_USERDATA, userDataDir, JX_COUNTOF(userDataDir));
+
+	char outputName[128];
+	jx_snprintf(outputName, JX_COUNTOF(outputName), "bench/%s_%s%s", kernelName, compiler->m_Command, compiler->m_Flags);
+
+	// Compile to an object file first in order to measure the size of the kernel's code without
+	// the runtime, and link the object into a DLL.
+	char cmd[2048];
+	jx_snprintf(cmd, JX_COUNTOF(cmd), "%s %s -c -Dprintf=jx_bench_printf \"-Dmain=__declspec(dllexport) main\" -D_NO_CRT_STDIO_INLINE -D__USE_MINGW_ANSI_STDIO=0 -o \"%s/%s.obj\" \"%s/test/%s.c\""
+		, compiler->m_Command
+		, compiler->m_Flags
+		, userDataDir
+		, outputName
+		, installDir
+		, kernelName
+	);
+	if (system(cmd) != 0) {
+		return false;
+	}
+
+	jx_snprintf(cmd, JX_COUNTOF(cmd), "%s -shared -o \"%s/%s.dll\" \"%s/%s.obj\" \"%s/bench/printf_stub.c\""
+		, compiler->m_Command
+		, userDataDir
+		, outputName
+		, userDataDir
+		, outputName
+		, userDataDir
+	);
+	if (system(cmd) != 0) {
+		return false;
+	}
+
+	char objFile[256];
+	jx_snprintf(objFile, JX_COUNTOF(objFile), "%s.obj", outputName);
+	res->m_CodeSize = benchGetCOFFCodeSize(allocator, JX_FILE_BASE_DIR_USERDATA, objFile);
+
+	char dllFile[256];
+	jx_snprintf(dllFile, JX_COUNTOF(dllFile), "%s.dll", outputName);
+	jx_os_module_t* lib = jx_os_moduleOpen(JX_FILE_BASE_DIR_USERDATA, dllFile);
+	if (!lib) {
+		return false;
+	}
+
+	pfnBenchMain mainFunc = (pfnBenchMain)jx_os_moduleGetSymbolAddr(lib, "main");
+	if (mainFunc) {
+		benchMeasure(mainFunc, res);
+	}
+
+	jx_os_moduleClose(lib);
+
+	return res->m_Valid;
+}
+
+static void benchMeasure(pfnBenchMain mainFunc, bench_result_t* res)
+{
+	for (uint32_t iRun = 0; iRun < BENCH_NUM_WARMUP_RUNS; ++iRun) {
+		res->m_ReturnValue = mainFunc();
+	}
+
+	int64_t samples[BENCH_NUM_SAMPLES];
+	for (uint32_t iSample = 0; iSample < BENCH_NUM_SAMPLES; ++iSample) {
+		const int64_t tStart = jx_os_timeNow();
+		for (uint32_t iRun = 0; iRun < BENCH_RUNS_PER_SAMPLE; ++iRun) {
+			res->m_ReturnValue |= mainFunc();
+		}
+		samples[iSample] = jx_os_timeSince(tStart);
+	}
+
+	jx_quickSort(samples, BENCH_NUM_SAMPLES, sizeof(int64_t), benchCompareTimes, NULL);
+
+	// NOTE: All kernels return 0 on success. Timings of kernels which produced the wrong 
+	// result are meaningless.
+	res->m_MinTime_us = jx_os_timeConvertTo(samples[0], JX_TIME_UNITS_US) / (double)BENCH_RUNS_PER_SAMPLE;
+	res->m_MedianTime_us = jx_os_timeConvertTo(samples[BENCH_NUM_SAMPLES / 2], JX_TIME_UNITS_US) / (double)BENCH_RUNS_PER_SAMPLE;
+	res->m_Valid = res->m_ReturnValue == 0;
+}
+
+// Total size of all code sections (.text*) of a COFF object file.
+static uint32_t benchGetCOFFCodeSize(jx_allocator_i* allocator, jx_file_base_dir baseDir, const char* relPath)
+{
+	uint64_t fileSize = 0;
+	uint8_t* fileData = (uint8_t*)jx_os_fsReadFile(baseDir, relPath, allocator, false, &fileSize);
+	if (!fileData) {
+		return 0;
+	}
+
+	uint32_t codeSize = 0;
+	if (fileSize >= sizeof(IMAGE_FILE_HEADER)) {
+		const IMAGE_FILE_HEADER* fileHeader = (const IMAGE_FILE_HEADER*)fileData;
+		const uint64_t sectionTableOffset = sizeof(IMAGE_FILE_HEADER) + fileHeader->SizeOfOptionalHeader;
+		const uint32_t numSections = fileHeader->NumberOfSections;
+		if (sectionTableOffset + numSections * sizeof(IMAGE_SECTION_HEADER) <= fileSize) {
+			const IMAGE_SECTION_HEADER* sections = (const IMAGE_SECTION_HEADER*)(fileData + sectionTableOffset);
+			for (uint32_t iSection = 0; iSection < numSections; ++iSection) {
+				const IMAGE_SECTION_HEADER* section = &sections[iSection];
+				if ((section->Characteristics & IMAGE_SCN_CNT_CODE) != 0) {
+					codeSize += section->SizeOfRawData;
+				}
+			}
+		}
+	}
+
+	JX_FREE(allocator, fileData);
+
+	return codeSize;
+}
+
+static void benchReportResult(jx_string_buffer_t* report, const char* compilerName, const bench_result_t* res, bool isLast)
+{
+	jx_strbuf_printf(report, "\t\t\t\t{ \"compiler\": \"%s\", ", compilerName);
+	if (res->m_Valid) {
+		jx_strbuf_printf(report, "\"status\": \"ok\", \"codeSize\": %u, \"medianTime_us\": %.4f, \"minTime_us\": %.4f }"
+			, res->m_CodeSize
+			, res->m_MedianTime_us
+			, res->m_MinTime_us
+		);
+	} else {
+		jx_strbuf_printf(report, "\"status\": \"failed\" }");
+	}
+	jx_strbuf_printf(report, "%s\n", isLast ? "" : ",");
+}
+
+static int32_t benchCompareTimes(const void* a, const void* b, void* userData)
+{
+	const int64_t timeA = *(const int64_t*)a;
+	const int64_t timeB = *(const int64_t*)b;
+	return timeA < timeB
+		? -1
+		: (timeA > timeB ? 1 : 0)
+		;
+}
+
+static int benchPrintfStub(const char* fmt, ...)
+{
+	JX_UNUSED(fmt);
+	return 0;
+}
+
+static void* getBenchExternalSymbolCallback(const char* symName, void* userData)
+{
+	if (!jx_strcmp(symName, "printf")) {
+		return (void*)benchPrintfStub;
+	}
+
+	return getExternalSymbolCallback(symName, userData);
+}
+
+// Compiles the c-testsuite, sqlite3 and the stb tests and attributes the wall time, the number
+// of allocations and the peak memory to each compilation stage (frontend stages, IR/MIR passes,
+// codegen). Results are written to bench/compile_time.json (user data dir).
+static void runCompileTimeBenchmark(jx_allocator_i* allocator)
+{
+	static const char* kSQLiteFiles[] = {
+		"test/sqlite3/sqlite3.c",
+	};
+
+	static const char* kSTBFiles[] = {
+		"test/stb_image_write_test.c",
+		"test/stb_sprintf_test.c",
+		"test/stb_truetype_test.c",
+	};
+
+	ctbench_context_t* ctx = (ctbench_context_t*)JX_ALLOC(allocator, sizeof(ctbench_context_t));
+	if (!ctx) {
+		return;
+	}
+
+	jx_memset(ctx, 0, sizeof(ctbench_context_t));
+	ctx->m_Allocator.m_Inst = (jx_allocator_o*)ctx;
+	ctx->m_Allocator.realloc = ctbenchRealloc;
+	ctx->m_ParentAllocator = allocator;
+
+	jx_string_buffer_t* report = jx_strbuf_create(allocator);
+	jx_strbuf_printf(report, "{\n");
+	jx_strbuf_printf(report, "\t\"suites\": [\n");
+
+	// c-testsuite
+	{
+		ctbenchReset(ctx);
+
+		uint32_t numFailed = 0;
+		const int64_t tStart = jx_os_timeNow();
+		for (uint32_t iTest = 1; iTest <= 220; ++iTest) {
+			char sourceFile[256];
+			jx_snprintf(sourceFile, JX_COUNTOF(sourceFile), "test/c-testsuite/%05d.c", iTest);
+			numFailed += ctbenchCompileFile(ctx, sourceFile) ? 0 : 1;
+		}
+		ctbenchReportSuite(ctx, report, "c-testsuite", 220, numFailed, jx_os_timeSince(tStart), false);
+	}
+
+	// sqlite3
+	{
+		ctbenchReset(ctx);
+
+		uint32_t numFailed = 0;
+		const int64_t tStart = jx_os_timeNow();
+		for (uint32_t iFile = 0; iFile < JX_COUNTOF(kSQLiteFiles); ++iFile) {
+			numFailed += ctbenchCompileFile(ctx, kSQLiteFiles[iFile]) ? 0 : 1;
+		}
+		ctbenchReportSuite(ctx, report, "sqlite3", JX_COUNTOF(kSQLiteFiles), numFailed, jx_os_timeSince(tStart), false);
+	}
+
+	// stb
+	{
+		ctbenchReset(ctx);
+
+		uint32_t numFailed = 0;
+		const int64_t tStart = jx_os_timeNow();
+		for (uint32_t iFile = 0; iFile < JX_COUNTOF(kSTBFiles); ++iFile) {
+			numFailed += ctbenchCompileFile(ctx, kSTBFiles[iFile]) ? 0 : 1;
+		}
+		ctbenchReportSuite(ctx, report, "stb", JX_COUNTOF(kSTBFiles), numFailed, jx_os_timeSince(tStart), true);
+	}
+
+	jx_strbuf_printf(report, "\t]\n");
+	jx_strbuf_printf(report, "}\n");
+
+	jx_os_fsCreateDirectory(JX_FILE_BASE_DIR_USERDATA, "bench");
+
+	uint32_t reportLen = 0;
+	const char* reportStr = jx_strbuf_getString(report, &reportLen);
+	jx_os_file_t* reportFile = jx_os_fileOpenWrite(JX_FILE_BASE_DIR_USERDATA, "bench/compile_time.json");
+	if (reportFile) {
+		jx_os_fileWrite(reportFile, reportStr, reportLen);
+		jx_os_fileClose(reportFile);
+	} else {
+		JX_SYS_LOG_ERROR(NULL, "Failed to write compile time benchmark results\n");
+	}
+
+	jx_strbuf_destroy(report);
+
+	if (ctx->m_CurBytes != 0) {
+		JX_SYS_LOG_WARNING(NULL, "%llu bytes still allocated after compilation\n", ctx->m_CurBytes);
+	}
+
+	JX_FREE(allocator, ctx);
+}
+
+static bool ctbenchCompileFile(ctbench_context_t* ctx, const char* sourceFile)
+{
+	jx_allocator_i* allocator = &ctx->m_Allocator;
+
+	bool res = false;
+
+	ctbenchStageBegin(ctx, "phase", "frontend");
+	jx_cc_context_t* ccCtx = jx_cc_createContext(allocator, logger_api->m_SystemLogger);
+	jx_cc_addIncludePath(ccCtx, JX_FILE_BASE_DIR_INSTALL, "include");
+	jx_cc_addIncludePath(ccCtx, JX_FILE_BASE_DIR_INSTALL, "include/winapi");
+	jx_cc_setStageCallback(ccCtx, ctbenchFrontendStageCallback, ctx);
+
+	jx_cc_translation_unit_t* tu = jx_cc_compileFile(ccCtx, JX_FILE_BASE_DIR_INSTALL, sourceFile);
+	ctbenchStageEnd(ctx);
+	if (!tu || tu->m_NumErrors != 0) {
+		jx_cc_destroyContext(ccCtx);
+		return false;
+	}
+
+	jx_ir_context_t* irCtx = jx_ir_createContext(allocator);
+	jx_ir_setPassCallback(irCtx, ctbenchIRPassCallback, ctx);
+
+	ctbenchStageBegin(ctx, "phase", "irgen");
+	jx_irgen_context_t* genCtx = jx_irgen_createContext(irCtx, allocator);
+	const bool irGenerated = jx_irgen_moduleGen(genCtx, sourceFile, tu);
+	jx_irgen_destroyContext(genCtx);
+	ctbenchStageEnd(ctx);
+
+	if (irGenerated) {
+		jx_mir_context_t* mirCtx = jx_mir_createContext(allocator);
+		jx_mir_setPassCallback(mirCtx, ctbenchMIRPassCallback, ctx);
+
+		ctbenchStageBegin(ctx, "phase", "mirgen");
+		jx_mirgen_context_t* mirGenCtx = jx_mirgen_createContext(irCtx, mirCtx, allocator);
+		jx_ir_module_t* irMod = jx_ir_getModule(irCtx, 0);
+		if (irMod) {
+			jx_mirgen_moduleGen(mirGenCtx, irMod);
+		}
+		jx_mirgen_destroyContext(mirGenCtx);
+		ctbenchStageEnd(ctx);
+
+		jx_x64_context_t* jitCtx = jx_x64_createContext(allocator);
+		jx_x64gen_context_t* jitgenCtx = jx_x64gen_createContext(jitCtx, mirCtx, ctbenchExternalSymbolCallback, NULL, allocator);
+
+		ctbenchStageBegin(ctx, "phase", "codegen");
+		res = jx_x64gen_emitCode(jitgenCtx);
+		ctbenchStageEnd(ctx);
+
+		if (res) {
+			ctbenchStageBegin(ctx, "phase", "finalize");
+			res = jx64_finalize(jitCtx, ctbenchExternalSymbolCallback, NULL);
+			ctbenchStageEnd(ctx);
+		}
+
+		jx_x64gen_destroyContext(jitgenCtx);
+		jx_x64_destroyContext(jitCtx);
+		jx_mir_destroyContext(mirCtx);
+	}
+
+	jx_ir_destroyContext(irCtx);
+	jx_cc_destroyContext(ccCtx);
+
+	return res;
+}
+
+static void ctbenchReset(ctbench_context_t* ctx)
+{
+	JX_CHECK(ctx->m_StackSize == 0, "Unbalanced stages");
+	jx_memset(ctx->m_Stages, 0, sizeof(ctx->m_Stages));
+	ctx->m_NumStages = 0;
+	ctx->m_NumAllocs = 0;
+	ctx->m_PeakBytes = ctx->m_CurBytes;
+}
+
+static void ctbenchStageBegin(ctbench_context_t* ctx, const char* group, const char* name)
+{
+	ctbench_stage_t* stage = NULL;
+	for (uint32_t iStage = 0; iStage < ctx->m_NumStages; ++iStage) {
+		ctbench_stage_t* s = &ctx->m_Stages[iStage];
+		if (!jx_strcmp(s->m_Group, group) && !jx_strcmp(s->m_Name, name)) {
+			stage = s;
+			break;
+		}
+	}
+
+	if (!stage) {
+		JX_CHECK(ctx->m_NumStages < CTBENCH_MAX_STAGES, "Too many stages");
+		stage = &ctx->m_Stages[ctx->m_NumStages++];
+		stage->m_Group = group;
+		stage->m_Name = name;
+	}
+
+	JX_CHECK(ctx->m_StackSize < CTBENCH_MAX_DEPTH, "Stages nested too deep");
+	ctbench_frame_t* frame = &ctx->m_Stack[ctx->m_StackSize++];
+	frame->m_Stage = stage;
+	frame->m_ChildTime = 0;
+	frame->m_StartNumAllocs = ctx->m_NumAllocs;
+	frame->m_StartBytes = ctx->m_CurBytes;
+	frame->m_PeakBytes = ctx->m_CurBytes;
+	frame->m_StartTime = jx_os_timeNow();
+}
+
+static void ctbenchStageEnd(ctbench_context_t* ctx)
+{
+	const int64_t tEnd = jx_os_timeNow();
+
+	JX_CHECK(ctx->m_StackSize != 0, "Unbalanced stages");
+	ctbench_frame_t* frame = &ctx->m_Stack[--ctx->m_StackSize];
+	ctbench_stage_t* stage = frame->m_Stage;
+
+	const int64_t duration = jx_os_timeDiff(tEnd, frame->m_StartTime);
+	stage->m_Time += duration;
+	stage->m_SelfTime += duration - frame->m_ChildTime;
+	stage->m_NumCalls++;
+	stage->m_NumAllocs += ctx->m_NumAllocs - frame->m_StartNumAllocs;
+
+	const uint64_t peakBytes = frame->m_PeakBytes - frame->m_StartBytes;
+	stage->m_PeakBytes = stage->m_PeakBytes > peakBytes
+		? stage->m_PeakBytes
+		: peakBytes
+		;
+
+	if (ctx->m_StackSize != 0) {
+		ctx->m_Stack[ctx->m_StackSize - 1].m_ChildTime += duration;
+	}
+}
+
+static void ctbenchReportSuite(ctbench_context_t* ctx, jx_string_buffer_t* report, const char* suiteName, uint32_t numFiles, uint32_t numFailed, int64_t totalTime, bool isLast)
+{
+	const double totalTime_ms = jx_os_timeConvertTo(totalTime, JX_TIME_UNITS_MS);
+
+	JX_SYS_LOG_INFO(NULL, "%s: %u files (%u failed), %.3f ms, %llu allocations, %llu KB peak\n"
+		, suiteName
+		, numFiles
+		, numFailed
+		, totalTime_ms
+		, ctx->m_NumAllocs
+		, ctx->m_PeakBytes >> 10
+	);
+
+	jx_strbuf_printf(report, "\t\t{\n");
+	jx_strbuf_printf(report, "\t\t\t\"name\": \"%s\",\n", suiteName);
+	jx_strbuf_printf(report, "\t\t\t\"files\": %u,\n", numFiles);
+	jx_strbuf_printf(report, "\t\t\t\"failed\": %u,\n", numFailed);
+	jx_strbuf_printf(report, "\t\t\t\"time_ms\": %.4f,\n", totalTime_ms);
+	jx_strbuf_printf(report, "\t\t\t\"allocs\": %llu,\n", ctx->m_NumAllocs);
+	jx_strbuf_printf(report, "\t\t\t\"peakBytes\": %llu,\n", ctx->m_PeakBytes);
+	jx_strbuf_printf(report, "\t\t\t\"stages\": [\n");
+
+	const uint32_t numStages = ctx->m_NumStages;
+	for (uint32_t iStage = 0; iStage < numStages; ++iStage) {
+		const ctbench_stage_t* stage = &ctx->m_Stages[iStage];
+		const double time_ms = jx_os_timeConvertTo(stage->m_Time, JX_TIME_UNITS_MS);
+		const double selfTime_ms = jx_os_timeConvertTo(stage->m_SelfTime, JX_TIME_UNITS_MS);
+
+		JX_SYS_LOG_INFO(NULL, "  %-8s %-28s %10.3f ms (self %10.3f ms), %8llu calls, %10llu allocs, %8llu KB peak\n"
+			, stage->m_Group
+			, stage->m_Name
+			, time_ms
+			, selfTime_ms
+			, stage->m_NumCalls
+			, stage->m_NumAllocs
+			, stage->m_PeakBytes >> 10
+		);
+
+		jx_strbuf_printf(report, "\t\t\t\t{ \"group\": \"%s\", \"name\": \"%s\", \"time_ms\": %.4f, \"selfTime_ms\": %.4f, \"calls\": %llu, \"allocs\": %llu, \"peakBytes\": %llu }%s\n"
+			, stage->m_Group
+			, stage->m_Name
+			, time_ms
+			, selfTime_ms
+			, stage->m_NumCalls
+			, stage->m_NumAllocs
+			, stage->m_PeakBytes
+			, iStage == numStages - 1 ? "" : ","
+		);
+	}
+
+	jx_strbuf_printf(report, "\t\t\t]\n");
+	jx_strbuf_printf(report, "\t\t}%s\n", isLast ? "" : ",");
+}
+
+// NOTE: Every block is prefixed by a header holding its size in order to track the amount of
+// live memory. The header is as large as the alignment to keep the returned pointer aligned.
+static void* ctbenchRealloc(jx_allocator_o* inst, void* ptr, uint64_t sz, uint64_t align, const char* file, uint32_t line)
+{
+	ctbench_context_t* ctx = (ctbench_context_t*)inst;
+	jx_allocator_i* parent = ctx->m_ParentAllocator;
+
+	const uint64_t headerSize = align > 16 ? align : 16;
+
+	uint8_t* oldBlock = NULL;
+	uint64_t oldSize = 0;
+	if (ptr) {
+		oldBlock = (uint8_t*)ptr - headerSize;
+		oldSize = ((uint64_t*)ptr)[-1];
+	}
+
+	if (sz == 0) {
+		if (oldBlock) {
+			ctx->m_CurBytes -= oldSize;
+			parent->realloc(parent->m_Inst, oldBlock, 0, align, file, line);
+		}
+		return NULL;
+	}
+
+	uint8_t* newBlock = (uint8_t*)parent->realloc(parent->m_Inst, oldBlock, sz + headerSize, align, file, line);
+	if (!newBlock) {
+		return NULL;
+	}
+
+	uint8_t* newPtr = newBlock + headerSize;
+	((uint64_t*)newPtr)[-1] = sz;
+
+	ctx->m_NumAllocs++;
+	ctx->m_CurBytes = ctx->m_CurBytes - oldSize + sz;
+	if (ctx->m_CurBytes > ctx->m_PeakBytes) {
+		ctx->m_PeakBytes = ctx->m_CurBytes;
+	}
+
+	const uint32_t stackSize = ctx->m_StackSize;
+	for (uint32_t iFrame = 0; iFrame < stackSize; ++iFrame) {
+		ctbench_frame_t* frame = &ctx->m_Stack[iFrame];
+		if (ctx->m_CurBytes > frame->m_PeakBytes) {
+			frame->m_PeakBytes = ctx->m_CurBytes;
+		}
+	}
+
+	return newPtr;
+}
+
+static void ctbenchFrontendStageCallback(const char* stageName, bool isEnd, void* userData)
+{
+	ctbench_context_t* ctx = (ctbench_context_t*)userData;
+	if (isEnd) {
+		ctbenchStageEnd(ctx);
+	} else {
+		ctbenchStageBegin(ctx, "cc", stageName);
+	}
+}
+
+static void ctbenchIRPassCallback(const char* passName, bool isEnd, void* userData)
+{
+	ctbench_context_t* ctx = (ctbench_context_t*)userData;
+	if (isEnd) {
+		ctbenchStageEnd(ctx);
+	} else {
+		ctbenchStageBegin(ctx, "jir", passName);
+	}
+}
+
+static void ctbenchMIRPassCallback(const char* passName, bool isEnd, void* userData)
+{
+	ctbench_context_t* ctx = (ctbench_context_t*)userData;
+	if (isEnd) {
+		ctbenchStageEnd(ctx);
+	} else {
+		ctbenchStageBegin(ctx, "jmir", passName);
+	}
+}
+
+// NOTE: The generated code is never executed so all external symbols can resolve to the same
+// dummy address.
+static void* ctbenchExternalSymbolCallback(const char* symName, void* userData)
+{
+	static uint64_t s_DummySymbol = 0;
+	return &s_DummySymbol;
+}
+
+static bool isFuncCachedCallback(const char* funcName, uint64_t fingerprint, void* userData)
+{
+	func_cache_t* funcCache = (func_cache_t*)userData;
+	return jx64_codeCacheContains(funcCache->m_CodeCache, funcName, jx_mir_funcGetFingerprint(funcCache->m_MIRCtx, funcName, fingerprint));
+}
+
 static void* getExternalSymbolCallback(const char* symName, void* userData)
 {
 	if (userData) {